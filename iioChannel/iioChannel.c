@@ -0,0 +1,396 @@
+//--------------------------------------------------------------------------------------------------
+/** @file iioChannel.c
+ *
+ * Classification of IIO channels: channel id parser and per-type metadata table.
+ *
+ * Type names are looked up through a minimal perfect hash: the FNV-1a hash of the name is
+ * multiplied by TYPE_HASH_MULTIPLIER and the top TYPE_HASH_BITS bits select a slot. The multiplier
+ * was searched offline so that every name of ChannelTypes[] lands in a distinct slot; the slot
+ * table is filled (and the absence of collision checked) when the component starts.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "iioChannel.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bits of the type hash, i.e. log2 of the number of slots.
+ */
+//--------------------------------------------------------------------------------------------------
+#define     TYPE_HASH_BITS                  6
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Multiplier making the type hash collision free for the names of ChannelTypes[]. Must be
+ * searched again if a type is added.
+ */
+//--------------------------------------------------------------------------------------------------
+#define     TYPE_HASH_MULTIPLIER            0x29e2dU
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Metadata of the channel types, indexed by iioChannel_Type_t.
+ *
+ * Units are the ones of the value after application of scale and offset.
+ */
+//--------------------------------------------------------------------------------------------------
+static const iioChannel_Metadata_t ChannelTypes[] =
+{
+    // Type name                  Unit of measurement             Period  Vector  Processed
+    { "voltage",                  "millivolts",                   10,     false,  false },
+    { "current",                  "milliamps",                    10,     false,  false },
+    { "power",                    "milliwatts",                   10,     false,  false },
+    { "accel",                    "m/s^2",                        1,      true,   false },
+    { "anglvel",                  "radians per second",           1,      true,   false },
+    { "magn",                     "Gauss",                        1,      true,   false },
+    { "illuminance",              "lux",                          10,     false,  true  },
+    { "intensity",                "",                             10,     false,  false },
+    { "proximity",                "meters",                       10,     false,  false },
+    { "temp",                     "milli degree celcius",         60,     false,  true  },
+    { "incli",                    "degrees",                      1,      true,   false },
+    { "rot",                      "degrees",                      1,      false,  true  },
+    { "angl",                     "radians",                      1,      false,  false },
+    { "timestamp",                "nanoseconds",                  0,      false,  false },
+    { "capacitance",              "nanofarads",                   10,     false,  false },
+    { "altvoltage",               "millivolts",                   10,     false,  false },
+    { "cct",                      "kelvin",                       10,     false,  true  },
+    { "pressure",                 "kilo pascals",                 60,     false,  true  },
+    { "humidityrelative",         "milli percent",                60,     false,  true  },
+    { "activity",                 "percent",                      10,     false,  true  },
+    { "steps",                    "",                             10,     false,  true  },
+    { "energy",                   "joules",                       60,     false,  true  },
+    { "distance",                 "meters",                       10,     false,  false },
+    { "velocity",                 "m/s",                          10,     false,  false },
+    { "concentration",            "percent",                      60,     false,  false },
+    { "resistance",               "ohms",                         10,     false,  false },
+    { "ph",                       "pH",                           60,     false,  false },
+    { "uvindex",                  "",                             60,     false,  false },
+    { "electricalconductivity",   "siemens per meter",            60,     false,  false },
+    { "count",                    "",                             10,     false,  false },
+    { "index",                    "",                             10,     false,  false },
+    { "gravity",                  "m/s^2",                        1,      true,   false },
+    { "positionrelative",         "milli percent",                10,     false,  false },
+    { "phase",                    "radians",                      10,     false,  false },
+    { "massconcentration",        "micrograms per cubic meter",   60,     false,  true  },
+    { "",                         "",                             60,     false,  false }
+};
+
+LE_STATIC_ASSERT(NUM_ARRAY_MEMBERS(ChannelTypes) == IIOCHANNEL_TYPE_UNKNOWN + 1,
+                 "ChannelTypes[] must match iioChannel_Type_t");
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Perfect hash slots: type + 1 of the name hashing to the slot, 0 if the slot is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t TypeSlots[1 << TYPE_HASH_BITS];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash a type name to its slot
+ *
+ * @return:
+ *      Slot index
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t HashTypeName
+(
+    const char* namePtr,                ///< [IN] Type name
+    size_t nameLen                      ///< [IN] Number of bytes of the name
+)
+{
+    uint32_t hash = 2166136261U;
+    size_t i;
+
+    for (i = 0; i < nameLen; i++)
+    {
+        hash ^= (uint8_t)namePtr[i];
+        hash *= 16777619U;
+    }
+
+    return (hash * TYPE_HASH_MULTIPLIER) >> (32 - TYPE_HASH_BITS);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look up a channel type by name
+ *
+ * @return:
+ *      Channel type, IIOCHANNEL_TYPE_UNKNOWN if not found
+ */
+//--------------------------------------------------------------------------------------------------
+static iioChannel_Type_t LookUpType
+(
+    const char* namePtr,                ///< [IN] Type name
+    size_t nameLen                      ///< [IN] Number of bytes of the name
+)
+{
+    uint8_t slot = TypeSlots[HashTypeName(namePtr, nameLen)];
+
+    if (slot == 0)
+    {
+        return IIOCHANNEL_TYPE_UNKNOWN;
+    }
+
+    const char* candidatePtr = ChannelTypes[slot - 1].name;
+
+    if ((strncmp(candidatePtr, namePtr, nameLen) != 0) || (candidatePtr[nameLen] != '\0'))
+    {
+        return IIOCHANNEL_TYPE_UNKNOWN;
+    }
+
+    return (iioChannel_Type_t)(slot - 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the decimal index following a type name
+ *
+ * @return:
+ *      Index, -1 if there are no digits at the current position
+ */
+//--------------------------------------------------------------------------------------------------
+static int ParseIndex
+(
+    const char** cursorPtr              ///< [INOUT] Parse position
+)
+{
+    const char* cursor = *cursorPtr;
+    int index = -1;
+
+    while ((*cursor >= '0') && (*cursor <= '9'))
+    {
+        index = ((index < 0) ? 0 : (index * 10)) + (*cursor - '0');
+        cursor++;
+    }
+
+    *cursorPtr = cursor;
+    return index;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the length of the type name at the current position
+ *
+ * @return:
+ *      Number of lower case letters at the current position
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetTypeNameLength
+(
+    const char* cursor                  ///< [IN] Parse position
+)
+{
+    size_t len = 0;
+
+    while ((cursor[len] >= 'a') && (cursor[len] <= 'z'))
+    {
+        len++;
+    }
+
+    return len;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a channel id.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the channel type is not known (the id is still parsed)
+ *      - LE_FORMAT_ERROR if the id is not a valid IIO channel id
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t iioChannel_Parse
+(
+    const char* idPtr,                  ///< [IN]  Channel id as returned by iio_channel_get_id()
+    bool isOutput,                      ///< [IN]  Is the channel an output?
+    iioChannel_Id_t* resultPtr          ///< [OUT] Parsed channel id
+)
+{
+    if ((idPtr == NULL) || (resultPtr == NULL))
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    memset(resultPtr, 0, sizeof(iioChannel_Id_t));
+    resultPtr->isOutput = isOutput;
+    resultPtr->index2 = -1;
+
+    // <type>[<index>][-<type><index>][_<modifier>]
+    const char* cursor = idPtr;
+    size_t nameLen = GetTypeNameLength(cursor);
+
+    if (nameLen == 0)
+    {
+        LE_DEBUG("'%s' does not start with a channel type", idPtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    resultPtr->type = LookUpType(cursor, nameLen);
+    resultPtr->metaPtr = &ChannelTypes[resultPtr->type];
+    cursor += nameLen;
+
+    resultPtr->index = ParseIndex(&cursor);
+
+    if (*cursor == '-')
+    {
+        cursor++;
+        size_t secondLen = GetTypeNameLength(cursor);
+
+        if ((secondLen != nameLen) || (strncmp(cursor, idPtr, nameLen) != 0))
+        {
+            LE_DEBUG("'%s' is not a differential channel of a single type", idPtr);
+            return LE_FORMAT_ERROR;
+        }
+
+        cursor += secondLen;
+        resultPtr->index2 = ParseIndex(&cursor);
+
+        if ((resultPtr->index < 0) || (resultPtr->index2 < 0))
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        resultPtr->isDifferential = true;
+    }
+
+    if (*cursor == '_')
+    {
+        cursor++;
+
+        if (LE_OK != le_utf8_Copy(resultPtr->modifierName,
+                                  cursor,
+                                  sizeof(resultPtr->modifierName),
+                                  NULL))
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        if (strcmp(cursor, "x") == 0)
+        {
+            resultPtr->modifier = IIOCHANNEL_MOD_X;
+        }
+        else if (strcmp(cursor, "y") == 0)
+        {
+            resultPtr->modifier = IIOCHANNEL_MOD_Y;
+        }
+        else if (strcmp(cursor, "z") == 0)
+        {
+            resultPtr->modifier = IIOCHANNEL_MOD_Z;
+        }
+        else
+        {
+            resultPtr->modifier = IIOCHANNEL_MOD_OTHER;
+        }
+    }
+    else if (*cursor != '\0')
+    {
+        LE_DEBUG("Unexpected '%c' in channel id '%s'", *cursor, idPtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    return (resultPtr->type == IIOCHANNEL_TYPE_UNKNOWN) ? LE_NOT_FOUND : LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look up the metadata of a channel type by name.
+ *
+ * @return:
+ *      Metadata of the type, or the metadata of the unknown type if the name is not known.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED const iioChannel_Metadata_t* iioChannel_GetMetadata
+(
+    const char* namePtr,                ///< [IN] Type name (need not be null terminated)
+    size_t nameLen                      ///< [IN] Number of bytes of the type name
+)
+{
+    return &ChannelTypes[LookUpType(namePtr, nameLen)];
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the metadata of a channel type.
+ *
+ * @return:
+ *      Metadata of the type.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED const iioChannel_Metadata_t* iioChannel_GetTypeMetadata
+(
+    iioChannel_Type_t type              ///< [IN] Channel type
+)
+{
+    if ((type < 0) || (type > IIOCHANNEL_TYPE_UNKNOWN))
+    {
+        type = IIOCHANNEL_TYPE_UNKNOWN;
+    }
+
+    return &ChannelTypes[type];
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the key of the vector group a channel belongs to.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the channel is not part of a vector
+ *      - LE_OVERFLOW if the buffer is too small
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t iioChannel_GetGroupKey
+(
+    const iioChannel_Id_t* idPtr,       ///< [IN]  Parsed channel id
+    char* bufferPtr,                    ///< [OUT] Group key
+    size_t bufferSize                   ///< [IN]  Buffer size
+)
+{
+    int res;
+
+    if ((!idPtr->metaPtr->isVector) ||
+        (idPtr->modifier == IIOCHANNEL_MOD_NONE) ||
+        (idPtr->modifier == IIOCHANNEL_MOD_OTHER))
+    {
+        return LE_NOT_FOUND;
+    }
+
+    if (idPtr->index >= 0)
+    {
+        res = snprintf(bufferPtr, bufferSize, "%s%d", idPtr->metaPtr->name, idPtr->index);
+    }
+    else
+    {
+        res = snprintf(bufferPtr, bufferSize, "%s", idPtr->metaPtr->name);
+    }
+
+    if ((res < 0) || (res >= bufferSize))
+    {
+        return LE_OVERFLOW;
+    }
+
+    return LE_OK;
+}
+
+COMPONENT_INIT
+{
+    int i;
+
+    // Fill the perfect hash slots.
+    for (i = 0; i < IIOCHANNEL_TYPE_UNKNOWN; i++)
+    {
+        uint32_t slot = HashTypeName(ChannelTypes[i].name, strlen(ChannelTypes[i].name));
+
+        LE_FATAL_IF(TypeSlots[slot] != 0,
+                    "IIO type '%s' collides with '%s', search a new TYPE_HASH_MULTIPLIER",
+                    ChannelTypes[i].name,
+                    ChannelTypes[TypeSlots[slot] - 1].name);
+
+        TypeSlots[slot] = i + 1;
+    }
+}
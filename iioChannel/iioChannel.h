@@ -0,0 +1,188 @@
+//--------------------------------------------------------------------------------------------------
+/** @file iioChannel.h
+ *
+ * Classification of IIO channels. Parses a channel id as exposed by libiio (e.g. "accel_x",
+ * "voltage0", "voltage0-voltage1") into its type, index, modifier and direction, and provides
+ * per-type metadata (unit, default period, vector grouping, processed or raw value).
+ *
+ * Refer IIO documentation: https://www.kernel.org/doc/Documentation/ABI/testing/sysfs-bus-iio
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_IIO_CHANNEL_INCLUDE_GUARD
+#define LEGATO_IIO_CHANNEL_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of a channel modifier name (including the null terminator)
+ */
+//--------------------------------------------------------------------------------------------------
+#define IIOCHANNEL_MAX_MODIFIER_LEN     32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of a vector group key (including the null terminator)
+ */
+//--------------------------------------------------------------------------------------------------
+#define IIOCHANNEL_MAX_GROUP_KEY_LEN    48
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Channel types, in the order of the kernel's enum iio_chan_type.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    IIOCHANNEL_TYPE_VOLTAGE,
+    IIOCHANNEL_TYPE_CURRENT,
+    IIOCHANNEL_TYPE_POWER,
+    IIOCHANNEL_TYPE_ACCEL,
+    IIOCHANNEL_TYPE_ANGLVEL,
+    IIOCHANNEL_TYPE_MAGN,
+    IIOCHANNEL_TYPE_LIGHT,
+    IIOCHANNEL_TYPE_INTENSITY,
+    IIOCHANNEL_TYPE_PROXIMITY,
+    IIOCHANNEL_TYPE_TEMP,
+    IIOCHANNEL_TYPE_INCLI,
+    IIOCHANNEL_TYPE_ROT,
+    IIOCHANNEL_TYPE_ANGL,
+    IIOCHANNEL_TYPE_TIMESTAMP,
+    IIOCHANNEL_TYPE_CAPACITANCE,
+    IIOCHANNEL_TYPE_ALTVOLTAGE,
+    IIOCHANNEL_TYPE_CCT,
+    IIOCHANNEL_TYPE_PRESSURE,
+    IIOCHANNEL_TYPE_HUMIDITYRELATIVE,
+    IIOCHANNEL_TYPE_ACTIVITY,
+    IIOCHANNEL_TYPE_STEPS,
+    IIOCHANNEL_TYPE_ENERGY,
+    IIOCHANNEL_TYPE_DISTANCE,
+    IIOCHANNEL_TYPE_VELOCITY,
+    IIOCHANNEL_TYPE_CONCENTRATION,
+    IIOCHANNEL_TYPE_RESISTANCE,
+    IIOCHANNEL_TYPE_PH,
+    IIOCHANNEL_TYPE_UVINDEX,
+    IIOCHANNEL_TYPE_ELECTRICALCONDUCTIVITY,
+    IIOCHANNEL_TYPE_COUNT,
+    IIOCHANNEL_TYPE_INDEX,
+    IIOCHANNEL_TYPE_GRAVITY,
+    IIOCHANNEL_TYPE_POSITIONRELATIVE,
+    IIOCHANNEL_TYPE_PHASE,
+    IIOCHANNEL_TYPE_MASSCONCENTRATION,
+    IIOCHANNEL_TYPE_UNKNOWN
+}
+iioChannel_Type_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Channel modifiers. Only the axis modifiers are enumerated, all others are reported as
+ * IIOCHANNEL_MOD_OTHER with their name kept in iioChannel_Id_t.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    IIOCHANNEL_MOD_NONE,
+    IIOCHANNEL_MOD_X,
+    IIOCHANNEL_MOD_Y,
+    IIOCHANNEL_MOD_Z,
+    IIOCHANNEL_MOD_OTHER
+}
+iioChannel_Modifier_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Metadata attached to a channel type
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* name;                   ///< Type name as defined in iio
+    const char* unit;                   ///< Unit of measurement after scale and offset
+    uint32_t defaultPeriod;             ///< Default sampling period in seconds (0: not sampled)
+    bool isVector;                      ///< Are x/y/z channels of this type grouped as a vector?
+    bool isProcessed;                   ///< Do drivers usually expose a processed "input" value?
+}
+iioChannel_Metadata_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parsed channel id
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    iioChannel_Type_t type;                             ///< Channel type
+    int index;                                          ///< Channel index, -1 if not indexed
+    bool isDifferential;                                ///< Is this a differential channel?
+    int index2;                                         ///< Second index of a differential channel
+    iioChannel_Modifier_t modifier;                     ///< Channel modifier
+    char modifierName[IIOCHANNEL_MAX_MODIFIER_LEN];     ///< Modifier as found in the id
+    bool isOutput;                                      ///< Is this an output channel?
+    const iioChannel_Metadata_t* metaPtr;               ///< Metadata of the channel type
+}
+iioChannel_Id_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a channel id.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the channel type is not known (the id is still parsed)
+ *      - LE_FORMAT_ERROR if the id is not a valid IIO channel id
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t iioChannel_Parse
+(
+    const char* idPtr,                  ///< [IN]  Channel id as returned by iio_channel_get_id()
+    bool isOutput,                      ///< [IN]  Is the channel an output?
+    iioChannel_Id_t* resultPtr          ///< [OUT] Parsed channel id
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look up the metadata of a channel type by name.
+ *
+ * @return:
+ *      Metadata of the type, or the metadata of the unknown type if the name is not known.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED const iioChannel_Metadata_t* iioChannel_GetMetadata
+(
+    const char* namePtr,                ///< [IN] Type name (need not be null terminated)
+    size_t nameLen                      ///< [IN] Number of bytes of the type name
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the metadata of a channel type.
+ *
+ * @return:
+ *      Metadata of the type.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED const iioChannel_Metadata_t* iioChannel_GetTypeMetadata
+(
+    iioChannel_Type_t type              ///< [IN] Channel type
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the key of the vector group a channel belongs to (e.g. "accel" for "accel_x" or "magn1"
+ * for "magn1_z"). Channels of the same device sharing a key are the axes of one vector.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the channel is not part of a vector
+ *      - LE_OVERFLOW if the buffer is too small
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t iioChannel_GetGroupKey
+(
+    const iioChannel_Id_t* idPtr,       ///< [IN]  Parsed channel id
+    char* bufferPtr,                    ///< [OUT] Group key
+    size_t bufferSize                   ///< [IN]  Buffer size
+);
+
+#endif /* LEGATO_IIO_CHANNEL_INCLUDE_GUARD */
@@ -14,7 +14,9 @@
 #include <lwm2mcore/device.h>
 #include <lwm2mcore/location.h>
 #include "interfaces.h"
+#include "json.h"
 #include "sensorFw.h"
+#include "track.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -32,6 +34,14 @@
 #define WAKEUP_GPIO_NUM    38
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default maximum deviation in meters between the published track and the received fixes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACK_DEFAULT_TOLERANCE_M    10.0
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * lwm2mcore function prototype to read a string
@@ -57,6 +67,25 @@ typedef struct
 dmHandlers_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Position track built from the GNSS position updates
+ */
+//--------------------------------------------------------------------------------------------------
+static track_t PositionTrack;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sampling of the position track: it is timed by the plugin, so that the GNSS engine only runs
+ * while the track is enabled
+ */
+//--------------------------------------------------------------------------------------------------
+static void* TrackHandlerPtr;
+static le_timer_Ref_t TrackTimer;
+static bool IsGnssStarted;                      ///< Was the engine started by the plugin?
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get JSON document describing the sensor/actuator.
@@ -81,6 +110,7 @@ static char* GetJsonDocument
             sizeof(ReadStringBuffer),
             "{"
             "\"name\" : \"%s\","
+            "\"plugin\" : \"dm\","
             "\"path\" : \"%s\","
             "\"readOnce\" : %s,"
             "\"unit\" : \"%s\""
@@ -726,6 +756,219 @@ static le_result_t GetLocationTimeStamp
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler for GNSS position updates. Adds the fix to the position track.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PositionHandler
+(
+    le_gnss_SampleRef_t positionSampleRef,              ///< [IN] Position sample
+    void* contextPtr                                    ///< [IN] context
+)
+{
+    int32_t latitude, longitude, hAccuracy, altitude, vAccuracy;
+    uint64_t epochTime;
+
+    if ((le_gnss_GetLocation(positionSampleRef, &latitude, &longitude, &hAccuracy) == LE_OK) &&
+        (le_gnss_GetEpochTime(positionSampleRef, &epochTime) == LE_OK))
+    {
+        track_Point_t point;
+
+        point.timestamp = epochTime / 1000.0;
+        point.latitude = latitude / 1000000.0;
+        point.longitude = longitude / 1000000.0;
+        point.altitude = 0;
+
+        if (le_gnss_GetAltitude(positionSampleRef, &altitude, &vAccuracy) == LE_OK)
+        {
+            point.altitude = altitude / 1000.0;
+        }
+
+        track_AddPoint(&PositionTrack, &point);
+    }
+
+    le_gnss_ReleaseSampleRef(positionSampleRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enable and start the GNSS engine, so that the position handler receives fixes. The engine may
+ * already be running for another application.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartGnss
+(
+    void
+)
+{
+    le_result_t result = le_gnss_Enable();
+
+    if ((result != LE_OK) && (result != LE_DUPLICATE))
+    {
+        LE_WARN("Unable to enable GNSS (%s), no position track", LE_RESULT_TXT(result));
+        return;
+    }
+
+    result = le_gnss_Start();
+
+    if (result == LE_OK)
+    {
+        IsGnssStarted = true;
+    }
+    else if (result != LE_DUPLICATE)
+    {
+        LE_WARN("Unable to start GNSS (%s), no position track", LE_RESULT_TXT(result));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop the GNSS engine if the plugin started it, and drop the fixes not published yet
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopGnss
+(
+    void
+)
+{
+    if (IsGnssStarted)
+    {
+        le_result_t result = le_gnss_Stop();
+
+        if ((result != LE_OK) && (result != LE_DUPLICATE))
+        {
+            LE_WARN("Unable to stop GNSS (%s)", LE_RESULT_TXT(result));
+        }
+
+        IsGnssStarted = false;
+    }
+
+    track_Init(&PositionTrack, PositionTrack.tolerance);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a segment of the position track
+ */
+//--------------------------------------------------------------------------------------------------
+static void TrackTimerHandler
+(
+    le_timer_Ref_t timerRef                             ///< [IN] Track timer
+)
+{
+    sensorFw_PushSample(TrackHandlerPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Follow the sampling period of the position track: the GNSS engine runs while the track is
+ * enabled, and is stopped with it (period of 0)
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetTrackPeriod
+(
+    double period,                                      ///< [IN] Period in seconds, 0 if disabled
+    void* contextPtr                                    ///< [IN] context
+)
+{
+    le_timer_Stop(TrackTimer);
+
+    if (period <= 0)
+    {
+        LE_INFO("Position track disabled");
+        StopGnss();
+        return;
+    }
+
+    LE_INFO("Position track sampled every %lf s", period);
+
+    if (!IsGnssStarted)
+    {
+        StartGnss();
+    }
+
+    le_timer_SetMsInterval(TrackTimer, (uint32_t)((period * 1000) + 0.5));
+    le_timer_Start(TrackTimer);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the segment of the position track since the last sample
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNAVAILABLE if no position was received since the last sample
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetTrack
+(
+    char* trackPtr,                                     ///< [OUT] Track segment in JSON format
+    size_t* lengthPtr,                                  ///< [INOUT] length
+    void* contextPtr                                    ///< [IN] context
+)
+{
+    le_result_t result = track_Serialize(&PositionTrack, trackPtr, *lengthPtr);
+
+    if (result == LE_OVERFLOW)
+    {
+        LE_ERROR("Track segment does not fit in %zu bytes", *lengthPtr);
+        return LE_FAULT;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read/Write the position track configuration in JSON format
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ConfigTrack
+(
+    char* jsonStringPtr,                                ///< [INOUT] JSON configuration
+    size_t* lengthPtr,                                  ///< [INOUT] length
+    void* contextPtr                                    ///< [IN] context
+)
+{
+    char extractedData[32];
+    json_DataType_t extractedType;
+
+    // Process incoming configuration data.
+    if ((json_Extract(extractedData,
+                      sizeof(extractedData),
+                      jsonStringPtr,
+                      "tolerance",
+                      &extractedType) == LE_OK) &&
+        (extractedType == JSON_TYPE_NUMBER) &&
+        (json_ConvertToNumber(extractedData) > 0))
+    {
+        PositionTrack.tolerance = json_ConvertToNumber(extractedData);
+        LE_INFO("Track tolerance set to %lf m", PositionTrack.tolerance);
+    }
+
+    int res = snprintf(jsonStringPtr, *lengthPtr, "{\"tolerance\":%lf}", PositionTrack.tolerance);
+
+    if ((res < 0) || (res >= *lengthPtr))
+    {
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Read Get Boot Reason
@@ -796,6 +1039,7 @@ static const dmHandlers_t DmHandlers[] =
     {"position/hSpeed",        false,       "m/s",     NULL,     SF_CB_NUMERIC,       GetHorizontalSpeed},
     {"position/vSpeed",        false,       "m/s",     NULL,     SF_CB_NUMERIC,       GetVerticalSpeed},
     {"position/timeStamp",     false,       "s",       NULL,     SF_CB_NUMERIC,       GetLocationTimeStamp},
+    {"position/track",         false,       "",        ConfigTrack, SF_CB_JSON,       GetTrack},
     {"ulpm/bootReason",        true,        "",        NULL,     SF_CB_STRING,        GetBootReason}
 };
 
@@ -805,12 +1049,31 @@ COMPONENT_INIT
     int i;
     le_result_t result;
     sensorfwCallbacks_t pluginCb;
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+    le_clk_Time_t slowest = { 0, 0 };
+    const char* slowestPathPtr = "";
 
     LE_INFO("Start DM plugin");
 
+    // Build the position track from every fix rather than from periodic samples. The engine is
+    // started once the track is enabled.
+    track_Init(&PositionTrack, TRACK_DEFAULT_TOLERANCE_M);
+    le_gnss_AddPositionHandler(PositionHandler, NULL);
+    TrackTimer = le_timer_Create("dmTrack");
+    le_timer_SetRepeat(TrackTimer, 0);
+    le_timer_SetHandler(TrackTimer, TrackTimerHandler);
+
     for (i = 0; i < NUM_ARRAY_MEMBERS(DmHandlers); i++)
     {
         memset(&pluginCb, 0, sizeof(sensorfwCallbacks_t));
+        pluginCb.configCb = DmHandlers[i].readConfig;
+
+        bool isTrack = (DmHandlers[i].sampleFunction == (void*)GetTrack);
+
+        if (isTrack)
+        {
+            pluginCb.periodCb = SetTrackPeriod;
+        }
 
         LE_INFO("Register %s", DmHandlers[i].path);
         jsonDocPtr = GetJsonDocument("",
@@ -837,15 +1100,33 @@ COMPONENT_INIT
                 break;
         }
 
+        // Registration reads the first sample, so it includes the modem calls.
+        le_clk_Time_t registrationStart = le_clk_GetRelativeTime();
+
         result = sensorFw_RegisterCallback(jsonDocPtr,
                                            DmHandlers[i].type,
                                            &pluginCb,
                                            NULL,
-                                           NULL);
+                                           isTrack ? &TrackHandlerPtr : NULL);
 
         if (result != LE_OK)
         {
             LE_ERROR("Registering sensor callback failed");
         }
+
+        le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), registrationStart);
+
+        if (le_clk_GreaterThan(elapsed, slowest))
+        {
+            slowest = elapsed;
+            slowestPathPtr = DmHandlers[i].path;
+        }
     }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    LE_INFO("Registered %zu DM sensors in %ld.%03ld s, slowest %s in %ld.%03ld s",
+            NUM_ARRAY_MEMBERS(DmHandlers),
+            (long)elapsed.sec, (long)(elapsed.usec / 1000),
+            slowestPathPtr, (long)slowest.sec, (long)(slowest.usec / 1000));
 }
@@ -0,0 +1,253 @@
+//--------------------------------------------------------------------------------------------------
+/** @file track.c
+ *
+ * Fixed-size position track with streaming (opening window) simplification.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <inttypes.h>
+#include <math.h>
+#include "track.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mean radius of the earth in meters
+ */
+//--------------------------------------------------------------------------------------------------
+#define     EARTH_RADIUS_M                  6371008.8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Degrees to radians
+ */
+//--------------------------------------------------------------------------------------------------
+#define     DEG_TO_RAD                      (M_PI / 180.0)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Distance in meters from a fix to the segment between two other fixes. Uses a local
+ * equirectangular projection, accurate enough over the length of a track segment.
+ *
+ * @return:
+ *      Distance in meters
+ */
+//--------------------------------------------------------------------------------------------------
+static double DistanceToSegment
+(
+    const track_Point_t* pointPtr,      ///< [IN] Fix
+    const track_Point_t* startPtr,      ///< [IN] Start of the segment
+    const track_Point_t* endPtr         ///< [IN] End of the segment
+)
+{
+    double scaleX = cos(startPtr->latitude * DEG_TO_RAD) * DEG_TO_RAD * EARTH_RADIUS_M;
+    double scaleY = DEG_TO_RAD * EARTH_RADIUS_M;
+
+    double px = (pointPtr->longitude - startPtr->longitude) * scaleX;
+    double py = (pointPtr->latitude - startPtr->latitude) * scaleY;
+    double ex = (endPtr->longitude - startPtr->longitude) * scaleX;
+    double ey = (endPtr->latitude - startPtr->latitude) * scaleY;
+
+    double lengthSquared = (ex * ex) + (ey * ey);
+    double t = 0;
+
+    if (lengthSquared > 0)
+    {
+        t = ((px * ex) + (py * ey)) / lengthSquared;
+        t = (t < 0) ? 0 : ((t > 1) ? 1 : t);
+    }
+
+    double dx = px - (t * ex);
+    double dy = py - (t * ey);
+
+    return sqrt((dx * dx) + (dy * dy));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Keep a fix as a vertex of the track
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddVertex
+(
+    track_t* trackPtr,                  ///< [INOUT] Track
+    const track_Point_t* pointPtr       ///< [IN] Fix
+)
+{
+    if (trackPtr->vertexCount == TRACK_MAX_VERTICES)
+    {
+        // Not published in time: drop the oldest vertex.
+        memmove(&trackPtr->vertices[0],
+                &trackPtr->vertices[1],
+                (TRACK_MAX_VERTICES - 1) * sizeof(track_Point_t));
+        trackPtr->vertexCount--;
+        trackPtr->droppedCount++;
+    }
+
+    trackPtr->vertices[trackPtr->vertexCount++] = *pointPtr;
+    trackPtr->anchor = *pointPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize a track
+ */
+//--------------------------------------------------------------------------------------------------
+void track_Init
+(
+    track_t* trackPtr,                  ///< [OUT] Track
+    double tolerance                    ///< [IN]  Maximum deviation in meters
+)
+{
+    memset(trackPtr, 0, sizeof(track_t));
+    trackPtr->tolerance = tolerance;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a fix to the track
+ */
+//--------------------------------------------------------------------------------------------------
+void track_AddPoint
+(
+    track_t* trackPtr,                  ///< [INOUT] Track
+    const track_Point_t* pointPtr       ///< [IN] Fix
+)
+{
+    size_t i;
+
+    trackPtr->hasNewFix = true;
+
+    if (!trackPtr->hasAnchor)
+    {
+        trackPtr->hasAnchor = true;
+        AddVertex(trackPtr, pointPtr);
+        return;
+    }
+
+    // Does the line from the last vertex to this fix still pass close to all fixes in between?
+    for (i = 0; i < trackPtr->windowCount; i++)
+    {
+        if (DistanceToSegment(&trackPtr->window[i], &trackPtr->anchor, pointPtr) >
+            trackPtr->tolerance)
+        {
+            break;
+        }
+    }
+
+    if ((i < trackPtr->windowCount) || (trackPtr->windowCount == TRACK_WINDOW_SIZE))
+    {
+        // The previous fix ends the straight segment.
+        AddVertex(trackPtr, &trackPtr->window[trackPtr->windowCount - 1]);
+        trackPtr->windowCount = 0;
+    }
+
+    trackPtr->window[trackPtr->windowCount++] = *pointPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a fix to a JSON segment
+ *
+ * @return:
+ *      Number of bytes written, or a negative value on error
+ */
+//--------------------------------------------------------------------------------------------------
+static int FormatPoint
+(
+    char* bufferPtr,                    ///< [OUT] Buffer
+    size_t bufferSize,                  ///< [IN]  Buffer size
+    const track_Point_t* pointPtr,      ///< [IN]  Fix
+    double t0                           ///< [IN]  Time origin of the segment
+)
+{
+    return snprintf(bufferPtr,
+                    bufferSize,
+                    "[%.1f,%.6f,%.6f,%.1f]",
+                    pointPtr->timestamp - t0,
+                    pointPtr->latitude,
+                    pointPtr->longitude,
+                    pointPtr->altitude);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Serialize the vertices added since the last call, followed by the latest fix, and clear them.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNAVAILABLE if no fix was received since the last call
+ *      - LE_OVERFLOW if the buffer is too small
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t track_Serialize
+(
+    track_t* trackPtr,                  ///< [INOUT] Track
+    char* bufferPtr,                    ///< [OUT] JSON segment
+    size_t bufferSize                   ///< [IN]  Buffer size
+)
+{
+    const track_Point_t* lastPtr;
+    size_t used = 0;
+    size_t i;
+    int res;
+
+    if (!trackPtr->hasNewFix)
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    lastPtr = (trackPtr->windowCount > 0) ? &trackPtr->window[trackPtr->windowCount - 1]
+                                          : &trackPtr->anchor;
+
+    double t0 = (trackPtr->vertexCount > 0) ? trackPtr->vertices[0].timestamp
+                                            : lastPtr->timestamp;
+
+    res = snprintf(bufferPtr, bufferSize, "{\"t0\":%.1f,\"pts\":[", t0);
+
+    for (i = 0; (res >= 0) && (used + res < bufferSize) && (i < trackPtr->vertexCount); i++)
+    {
+        used += res;
+        res = FormatPoint(bufferPtr + used, bufferSize - used, &trackPtr->vertices[i], t0);
+
+        if ((res >= 0) && (used + res < bufferSize) && (i + 1 < trackPtr->vertexCount))
+        {
+            bufferPtr[used + res] = ',';
+            res++;
+        }
+    }
+
+    if ((res >= 0) && (used + res < bufferSize))
+    {
+        used += res;
+        res = snprintf(bufferPtr + used, bufferSize - used, "],\"last\":");
+    }
+
+    if ((res >= 0) && (used + res < bufferSize))
+    {
+        used += res;
+        res = FormatPoint(bufferPtr + used, bufferSize - used, lastPtr, t0);
+    }
+
+    if ((res >= 0) && (used + res < bufferSize))
+    {
+        used += res;
+        res = snprintf(bufferPtr + used,
+                       bufferSize - used,
+                       ",\"dropped\":%" PRIu32 "}",
+                       trackPtr->droppedCount);
+    }
+
+    if ((res < 0) || (used + res >= bufferSize))
+    {
+        return LE_OVERFLOW;
+    }
+
+    trackPtr->vertexCount = 0;
+    trackPtr->droppedCount = 0;
+    trackPtr->hasNewFix = false;
+
+    return LE_OK;
+}
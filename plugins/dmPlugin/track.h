@@ -0,0 +1,106 @@
+//--------------------------------------------------------------------------------------------------
+/** @file track.h
+ *
+ * Fixed-size position track with streaming simplification. Incoming fixes are reduced on the fly
+ * with the opening window algorithm (a streaming form of Douglas-Peucker): a fix is kept as a
+ * vertex of the track only when the straight line from the previous vertex no longer passes
+ * within the tolerance of all the fixes received in between.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_DM_TRACK_INCLUDE_GUARD
+#define LEGATO_DM_TRACK_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of vertices kept until the track is published
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACK_MAX_VERTICES              64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of fixes between two vertices
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACK_WINDOW_SIZE               32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Position fix
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double timestamp;                   ///< Time of the fix in seconds since the Epoch
+    double latitude;                    ///< Latitude in degrees
+    double longitude;                   ///< Longitude in degrees
+    double altitude;                    ///< Altitude in meters
+}
+track_Point_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Track state
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double tolerance;                               ///< Maximum deviation in meters
+    bool hasAnchor;                                 ///< Has a first fix been received?
+    track_Point_t anchor;                           ///< Last vertex
+    size_t windowCount;                             ///< Number of fixes since the last vertex
+    track_Point_t window[TRACK_WINDOW_SIZE];        ///< Fixes since the last vertex
+    size_t vertexCount;                             ///< Number of vertices not published yet
+    track_Point_t vertices[TRACK_MAX_VERTICES];     ///< Vertices not published yet
+    uint32_t droppedCount;                          ///< Vertices dropped because of overflow
+    bool hasNewFix;                                 ///< Has a fix been received since publishing?
+}
+track_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize a track
+ */
+//--------------------------------------------------------------------------------------------------
+void track_Init
+(
+    track_t* trackPtr,                  ///< [OUT] Track
+    double tolerance                    ///< [IN]  Maximum deviation in meters
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a fix to the track
+ */
+//--------------------------------------------------------------------------------------------------
+void track_AddPoint
+(
+    track_t* trackPtr,                  ///< [INOUT] Track
+    const track_Point_t* pointPtr       ///< [IN] Fix
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Serialize the vertices added since the last call, followed by the latest fix, and clear them.
+ *
+ * The segment is formatted as
+ *  {"t0": <epoch>, "pts": [[dt, lat, lon, alt], ...], "last": [dt, lat, lon, alt], "dropped": n}
+ * with dt relative to t0.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNAVAILABLE if no fix was received since the last call
+ *      - LE_OVERFLOW if the buffer is too small
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t track_Serialize
+(
+    track_t* trackPtr,                  ///< [INOUT] Track
+    char* bufferPtr,                    ///< [OUT] JSON segment
+    size_t bufferSize                   ///< [IN]  Buffer size
+);
+
+#endif /* LEGATO_DM_TRACK_INCLUDE_GUARD */
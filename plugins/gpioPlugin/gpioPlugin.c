@@ -0,0 +1,679 @@
+//--------------------------------------------------------------------------------------------------
+/** @file gpioPlugin.c
+ *
+ * Digital inputs wired to GPIOs: door contacts, alarms, pulse counters.
+ *
+ * Each configured line is requested as an input with edge detection through the GPIO character
+ * device (uAPI v2), with the debounce done by the kernel. The line events are read when the line
+ * request becomes readable, so nothing is polled, and the samples carry the kernel timestamp of
+ * the edge. A line is either:
+ *  - an input, a boolean sensor gpio/<name> pushed on every edge with the new state;
+ *  - a counter of pulses, a numeric sensor gpio/<name>/count pushed with the total count of edges,
+ *    and gpio/<name>/rate with the pulse rate in Hz derived from the interval between pulses. The
+ *    rate drops to 0 when no pulse came for rateIdle seconds (or twice the last interval).
+ * Edges lost because the event buffer of the kernel overflowed are still counted, from the
+ * sequence numbers of the events.
+ *
+ * The plugin is disabled unless gpioPlugin/enable is set in the configuration tree of the app.
+ * Lines are configured under gpioPlugin/lines/<name>/:
+ *  - chip          (string) GPIO chip, name or path of the character device (default gpiochip0)
+ *  - offset        (int)    offset of the line on the chip (required)
+ *  - type          (string) input or counter (default input)
+ *  - edge          (string) both, rising or falling (default both for an input, rising for a
+ *                           counter)
+ *  - activeLow     (bool)   the line is active when low (default false)
+ *  - bias          (string) pull-up, pull-down or disabled (default as is)
+ *  - debounceUs    (int)    debounce period in microseconds (default 0, none)
+ *  - rateIdle      (float)  seconds without pulse before the rate is 0 (default 60)
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <inttypes.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include "interfaces.h"
+#include "sensorFw.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Node of the configuration tree of the plugin
+ */
+//--------------------------------------------------------------------------------------------------
+#define CONFIG_NODE                 "gpioPlugin"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of lines and length of their name
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_LINES                   32
+#define MAX_NAME_LEN                32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Events buffered by the kernel for a line, and read at once
+ */
+//--------------------------------------------------------------------------------------------------
+#define EVENT_BUFFER_SIZE           64
+#define EVENT_READ_COUNT            16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default time without pulse after which the rate of a counter is 0, in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_RATE_IDLE           60
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Realtime event timestamps came with Linux 5.11, older kernels reject the flag
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME
+#define GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME  _BITULL(11)
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Type of a line
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    LINE_INPUT,                         ///< Boolean state
+    LINE_COUNTER                        ///< Pulse count and rate
+}
+lineType_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sensor of a line
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct gpioLine gpioLine_t;
+
+typedef struct
+{
+    gpioLine_t* linePtr;                ///< Line
+    void* handlerPtr;                   ///< Sensor handler
+    bool isEnabled;                     ///< Is the sensor sampled?
+}
+gpioSensor_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Line
+ */
+//--------------------------------------------------------------------------------------------------
+struct gpioLine
+{
+    char name[MAX_NAME_LEN];            ///< Name of the line
+    lineType_t type;                    ///< Type of the line
+    int fd;                             ///< Line request
+    bool isMonotonic;                   ///< Are the event timestamps on the monotonic clock?
+    le_fdMonitor_Ref_t monitorRef;      ///< Monitor of the line request
+    uint32_t lastLineSeqno;             ///< Sequence number of the last event
+    double count;                       ///< Edges counted
+    double rate;                        ///< Pulse rate in Hz
+    double rateIdle;                    ///< Seconds without pulse before the rate is 0
+    uint64_t lastPulseNs;               ///< Timestamp of the last pulse (0 if none)
+    le_timer_Ref_t idleTimer;           ///< Timer dropping the rate to 0
+    gpioSensor_t state;                 ///< State of an input
+    gpioSensor_t counter;               ///< Count of a counter
+    gpioSensor_t rateSensor;            ///< Rate of a counter
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Lines
+ */
+//--------------------------------------------------------------------------------------------------
+static gpioLine_t Lines[MAX_LINES];
+static uint32_t LineCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert the timestamp of an event to a sample timestamp, in seconds since the Epoch
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetEventTime
+(
+    const gpioLine_t* linePtr,          ///< [IN] Line
+    uint64_t timestampNs                ///< [IN] Timestamp of the event
+)
+{
+    if (linePtr->isMonotonic)
+    {
+        // Kernels without realtime event timestamps: shift by the current offset of the clocks.
+        struct timespec realtime;
+        struct timespec monotonic;
+
+        clock_gettime(CLOCK_REALTIME, &realtime);
+        clock_gettime(CLOCK_MONOTONIC, &monotonic);
+
+        return (double)timestampNs / 1000000000.0 +
+               (double)(realtime.tv_sec - monotonic.tv_sec) +
+               (double)(realtime.tv_nsec - monotonic.tv_nsec) / 1000000000.0;
+    }
+
+    return (double)timestampNs / 1000000000.0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push the rate of a counter
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushRate
+(
+    gpioLine_t* linePtr,                ///< [IN] Line
+    double timestamp                    ///< [IN] Time of the sample (0 = now)
+)
+{
+    if (linePtr->rateSensor.isEnabled)
+    {
+        sensorFw_PushNumeric(linePtr->rateSensor.handlerPtr, timestamp, linePtr->rate);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * No pulse came in time, the rate of a counter is 0
+ */
+//--------------------------------------------------------------------------------------------------
+static void IdleHandler
+(
+    le_timer_Ref_t timerRef             ///< [IN] Idle timer
+)
+{
+    gpioLine_t* linePtr = le_timer_GetContextPtr(timerRef);
+
+    linePtr->rate = 0;
+    PushRate(linePtr, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the pulses of a batch of events of a counter, and derive the rate
+ */
+//--------------------------------------------------------------------------------------------------
+static void CountPulses
+(
+    gpioLine_t* linePtr,                ///< [IN] Line
+    const struct gpio_v2_line_event* eventsPtr, ///< [IN] Events, in order
+    size_t eventCount                   ///< [IN] Number of events
+)
+{
+    const struct gpio_v2_line_event* lastPtr = &eventsPtr[eventCount - 1];
+    uint32_t pulseCount = lastPtr->line_seqno - linePtr->lastLineSeqno;
+    double timestamp = GetEventTime(linePtr, lastPtr->timestamp_ns);
+
+    linePtr->count += pulseCount;
+
+    if (linePtr->counter.isEnabled)
+    {
+        sensorFw_PushNumeric(linePtr->counter.handlerPtr, timestamp, linePtr->count);
+    }
+
+    // The rate needs the time of a previous pulse.
+    if ((linePtr->lastPulseNs != 0) && (lastPtr->timestamp_ns > linePtr->lastPulseNs))
+    {
+        double interval = (lastPtr->timestamp_ns - linePtr->lastPulseNs) / 1000000000.0;
+        double idle = (2 * interval / pulseCount > linePtr->rateIdle) ?
+                      (2 * interval / pulseCount) : linePtr->rateIdle;
+
+        linePtr->rate = pulseCount / interval;
+        PushRate(linePtr, timestamp);
+
+        le_timer_SetMsInterval(linePtr->idleTimer, (uint32_t)(idle * 1000));
+        le_timer_Restart(linePtr->idleTimer);
+    }
+
+    linePtr->lastPulseNs = lastPtr->timestamp_ns;
+    linePtr->lastLineSeqno = lastPtr->line_seqno;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the events of a line and push its samples
+ */
+//--------------------------------------------------------------------------------------------------
+static void LineHandler
+(
+    int fd,                             ///< [IN] Line request
+    short events                        ///< [IN] Events of the file descriptor
+)
+{
+    gpioLine_t* linePtr = le_fdMonitor_GetContextPtr();
+    struct gpio_v2_line_event lineEvents[EVENT_READ_COUNT];
+    ssize_t size;
+    size_t eventCount;
+    size_t i;
+
+    if (events & (POLLERR | POLLHUP))
+    {
+        LE_ERROR("Line %s is gone", linePtr->name);
+        le_fdMonitor_Delete(linePtr->monitorRef);
+        close(linePtr->fd);
+        linePtr->fd = -1;
+        return;
+    }
+
+    size = read(fd, lineEvents, sizeof(lineEvents));
+
+    if (size < (ssize_t)sizeof(lineEvents[0]))
+    {
+        if ((size < 0) && (errno != EAGAIN) && (errno != EINTR))
+        {
+            LE_ERROR("Error reading the events of line %s: %m", linePtr->name);
+        }
+        return;
+    }
+
+    eventCount = size / sizeof(lineEvents[0]);
+
+    if (linePtr->type == LINE_COUNTER)
+    {
+        CountPulses(linePtr, lineEvents, eventCount);
+    }
+    else
+    {
+        for (i = 0; i < eventCount; i++)
+        {
+            if (lineEvents[i].line_seqno != linePtr->lastLineSeqno + 1)
+            {
+                LE_WARN("%" PRIu32 " events of line %s lost",
+                        lineEvents[i].line_seqno - linePtr->lastLineSeqno - 1, linePtr->name);
+            }
+
+            linePtr->lastLineSeqno = lineEvents[i].line_seqno;
+
+            if (linePtr->state.isEnabled)
+            {
+                sensorFw_PushBoolean(linePtr->state.handlerPtr,
+                                     GetEventTime(linePtr, lineEvents[i].timestamp_ns),
+                                     lineEvents[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE);
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample the state of an input, for its first sample
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleState
+(
+    bool* valuePtr,                     ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Sensor
+)
+{
+    const gpioLine_t* linePtr = ((gpioSensor_t*)contextPtr)->linePtr;
+    struct gpio_v2_line_values values = { .bits = 0, .mask = 1 };
+
+    if ((linePtr->fd < 0) || (ioctl(linePtr->fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) != 0))
+    {
+        return LE_FAULT;
+    }
+
+    *valuePtr = ((values.bits & 1) != 0);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample the count of a counter, for its first sample
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleCount
+(
+    double* valuePtr,                   ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Sensor
+)
+{
+    *valuePtr = ((gpioSensor_t*)contextPtr)->linePtr->count;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample the rate of a counter, for its first sample
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleRate
+(
+    double* valuePtr,                   ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Sensor
+)
+{
+    *valuePtr = ((gpioSensor_t*)contextPtr)->linePtr->rate;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enable or disable a sensor. Its samples are timed by the edges, whatever the period.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetPeriod
+(
+    double period,                      ///< [IN] Sampling period, 0 if disabled
+    void* contextPtr                    ///< [IN] Sensor
+)
+{
+    ((gpioSensor_t*)contextPtr)->isEnabled = (period > 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register a sensor of a line
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t RegisterSensor
+(
+    gpioSensor_t* sensorPtr,            ///< [IN] Sensor
+    gpioLine_t* linePtr,                ///< [IN] Line
+    const char* pathPtr,                ///< [IN] Path of the sensor
+    const char* unitPtr,                ///< [IN] Unit
+    sensorfwDataType_t type,            ///< [IN] Data type
+    sensorfwCallbacks_t* callbacksPtr   ///< [IN] Callbacks
+)
+{
+    char jsonDoc[256];
+
+    snprintf(jsonDoc,
+             sizeof(jsonDoc),
+             "{"
+             "\"name\" : \"%s\","
+             "\"plugin\" : \"gpio\","
+             "\"path\" : \"%s\","
+             "\"readOnce\" : false,"
+             "\"period\" : 1,"
+             "\"unit\" : \"%s\""
+             "}",
+             pathPtr,
+             pathPtr,
+             unitPtr);
+
+    sensorPtr->linePtr = linePtr;
+    sensorPtr->isEnabled = true;
+    callbacksPtr->periodCb = SetPeriod;
+
+    if (sensorFw_RegisterCallback(jsonDoc, type, callbacksPtr, sensorPtr,
+                                  &sensorPtr->handlerPtr) != LE_OK)
+    {
+        LE_ERROR("Error registering %s", pathPtr);
+        sensorPtr->isEnabled = false;
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Request a line as an input with edge detection
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the chip does not exist
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t RequestLine
+(
+    gpioLine_t* linePtr,                ///< [INOUT] Line
+    const char* chipPtr,                ///< [IN]    Chip
+    uint32_t offset,                    ///< [IN]    Offset of the line
+    uint64_t flags,                     ///< [IN]    Flags of the line
+    uint32_t debounceUs                 ///< [IN]    Debounce period
+)
+{
+    char chipPath[64];
+    struct gpio_v2_line_request request;
+    int chipFd;
+    int result;
+
+    snprintf(chipPath, sizeof(chipPath), "%s%s", (chipPtr[0] == '/') ? "" : "/dev/", chipPtr);
+
+    chipFd = open(chipPath, O_RDONLY | O_CLOEXEC);
+
+    if (chipFd < 0)
+    {
+        LE_ERROR("Cannot open %s: %m", chipPath);
+        return LE_NOT_FOUND;
+    }
+
+    memset(&request, 0, sizeof(request));
+    request.offsets[0] = offset;
+    request.num_lines = 1;
+    request.event_buffer_size = EVENT_BUFFER_SIZE;
+    request.config.flags = flags | GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME;
+    snprintf(request.consumer, sizeof(request.consumer), "sensorFw-%s", linePtr->name);
+
+    if (debounceUs > 0)
+    {
+        request.config.num_attrs = 1;
+        request.config.attrs[0].mask = 1;
+        request.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+        request.config.attrs[0].attr.debounce_period_us = debounceUs;
+    }
+
+    result = ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &request);
+
+    // Older kernels only timestamp on the monotonic clock.
+    if ((result != 0) && (errno == EINVAL))
+    {
+        request.config.flags = flags;
+        result = ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &request);
+        linePtr->isMonotonic = true;
+    }
+
+    close(chipFd);
+
+    if (result != 0)
+    {
+        LE_ERROR("Cannot request line %" PRIu32 " of %s: %m", offset, chipPath);
+        return LE_FAULT;
+    }
+
+    linePtr->fd = request.fd;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the configuration of a line and set it up
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_BAD_PARAMETER if the configuration is not valid
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AddLine
+(
+    le_cfg_IteratorRef_t iteratorRef,   ///< [IN] Node of the line
+    gpioLine_t* linePtr                 ///< [OUT] Line
+)
+{
+    char chip[32];
+    char type[16];
+    char edge[16];
+    char bias[16];
+    char path[MAX_NAME_LEN + 16];
+    sensorfwCallbacks_t pluginCb;
+    uint64_t flags = GPIO_V2_LINE_FLAG_INPUT;
+    int offset;
+
+    memset(linePtr, 0, sizeof(*linePtr));
+    linePtr->fd = -1;
+
+    if ((le_cfg_GetNodeName(iteratorRef, "", linePtr->name, sizeof(linePtr->name)) != LE_OK) ||
+        (le_cfg_GetString(iteratorRef, "chip", chip, sizeof(chip), "gpiochip0") != LE_OK) ||
+        (le_cfg_GetString(iteratorRef, "type", type, sizeof(type), "input") != LE_OK) ||
+        (le_cfg_GetString(iteratorRef, "edge", edge, sizeof(edge), "") != LE_OK) ||
+        (le_cfg_GetString(iteratorRef, "bias", bias, sizeof(bias), "") != LE_OK))
+    {
+        LE_ERROR("Configuration of a line too long");
+        return LE_BAD_PARAMETER;
+    }
+
+    offset = le_cfg_GetInt(iteratorRef, "offset", -1);
+
+    if (offset < 0)
+    {
+        LE_ERROR("No offset for line %s", linePtr->name);
+        return LE_BAD_PARAMETER;
+    }
+
+    if (strcmp(type, "counter") == 0)
+    {
+        linePtr->type = LINE_COUNTER;
+    }
+    else if (strcmp(type, "input") == 0)
+    {
+        linePtr->type = LINE_INPUT;
+    }
+    else
+    {
+        LE_ERROR("Unknown type '%s' of line %s", type, linePtr->name);
+        return LE_BAD_PARAMETER;
+    }
+
+    if (edge[0] == '\0')
+    {
+        le_utf8_Copy(edge, (linePtr->type == LINE_COUNTER) ? "rising" : "both", sizeof(edge), NULL);
+    }
+
+    flags |= (strcmp(edge, "rising") == 0) ? GPIO_V2_LINE_FLAG_EDGE_RISING :
+             (strcmp(edge, "falling") == 0) ? GPIO_V2_LINE_FLAG_EDGE_FALLING :
+             (GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING);
+
+    flags |= (strcmp(bias, "pull-up") == 0) ? GPIO_V2_LINE_FLAG_BIAS_PULL_UP :
+             (strcmp(bias, "pull-down") == 0) ? GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN :
+             (strcmp(bias, "disabled") == 0) ? GPIO_V2_LINE_FLAG_BIAS_DISABLED :
+             0;
+
+    if (le_cfg_GetBool(iteratorRef, "activeLow", false))
+    {
+        flags |= GPIO_V2_LINE_FLAG_ACTIVE_LOW;
+    }
+
+    linePtr->rateIdle = le_cfg_GetFloat(iteratorRef, "rateIdle", DEFAULT_RATE_IDLE);
+
+    if (linePtr->rateIdle <= 0)
+    {
+        linePtr->rateIdle = DEFAULT_RATE_IDLE;
+    }
+
+    if (RequestLine(linePtr, chip, offset, flags, le_cfg_GetInt(iteratorRef, "debounceUs", 0))
+        != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    memset(&pluginCb, 0, sizeof(pluginCb));
+
+    if (linePtr->type == LINE_INPUT)
+    {
+        snprintf(path, sizeof(path), "gpio/%s", linePtr->name);
+        pluginCb.sample.boolCb = SampleState;
+
+        if (RegisterSensor(&linePtr->state, linePtr, path, "", SF_CB_BOOLEAN, &pluginCb) != LE_OK)
+        {
+            close(linePtr->fd);
+            linePtr->fd = -1;
+            return LE_FAULT;
+        }
+    }
+    else
+    {
+        linePtr->idleTimer = le_timer_Create(linePtr->name);
+        le_timer_SetHandler(linePtr->idleTimer, IdleHandler);
+        le_timer_SetContextPtr(linePtr->idleTimer, linePtr);
+
+        snprintf(path, sizeof(path), "gpio/%s/count", linePtr->name);
+        pluginCb.sample.numericCb = SampleCount;
+
+        if (RegisterSensor(&linePtr->counter, linePtr, path, "", SF_CB_NUMERIC, &pluginCb) != LE_OK)
+        {
+            // The line is reused for the next one in the configuration, release all of it.
+            le_timer_Delete(linePtr->idleTimer);
+            linePtr->idleTimer = NULL;
+            close(linePtr->fd);
+            linePtr->fd = -1;
+            return LE_FAULT;
+        }
+
+        // The count is the main sensor of a counter, the rate is derived from it.
+        snprintf(path, sizeof(path), "gpio/%s/rate", linePtr->name);
+        pluginCb.sample.numericCb = SampleRate;
+        RegisterSensor(&linePtr->rateSensor, linePtr, path, "Hz", SF_CB_NUMERIC, &pluginCb);
+    }
+
+    linePtr->monitorRef = le_fdMonitor_Create(linePtr->name, linePtr->fd, LineHandler, POLLIN);
+    le_fdMonitor_SetContextPtr(linePtr->monitorRef, linePtr);
+
+    LE_INFO("Line %s: offset %d of %s, %s on %s edges%s", linePtr->name, offset, chip, type, edge,
+            linePtr->isMonotonic ? ", monotonic timestamps" : "");
+
+    return LE_OK;
+}
+
+COMPONENT_INIT
+{
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(CONFIG_NODE);
+
+    if (!le_cfg_GetBool(iteratorRef, "enable", false))
+    {
+        LE_INFO("GPIO plugin disabled");
+        le_cfg_CancelTxn(iteratorRef);
+        return;
+    }
+
+    LE_INFO("Start GPIO plugin");
+
+    le_cfg_GoToNode(iteratorRef, "lines");
+
+    if (le_cfg_GoToFirstChild(iteratorRef) != LE_OK)
+    {
+        LE_WARN("No GPIO line configured");
+        le_cfg_CancelTxn(iteratorRef);
+        return;
+    }
+
+    do
+    {
+        if (LineCount >= MAX_LINES)
+        {
+            LE_ERROR("Too many GPIO lines, at most %d", MAX_LINES);
+            break;
+        }
+
+        if (AddLine(iteratorRef, &Lines[LineCount]) == LE_OK)
+        {
+            LineCount++;
+        }
+    }
+    while (le_cfg_GoToNextSibling(iteratorRef) == LE_OK);
+
+    le_cfg_CancelTxn(iteratorRef);
+
+    LE_INFO("%" PRIu32 " GPIO lines monitored", LineCount);
+}
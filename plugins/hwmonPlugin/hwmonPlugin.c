@@ -0,0 +1,824 @@
+//--------------------------------------------------------------------------------------------------
+/** @file hwmonPlugin.c
+ *
+ * Temperatures, voltages, currents, power, energy, humidity and fan speeds of the chips exposed
+ * by the Linux hwmon class (/sys/class/hwmon), for boards without IIO drivers for them.
+ *
+ * The chips and their <type><index>_input attributes are discovered at startup. The attributes
+ * are classified like IIO channels of the same kind (iioChannel), which gives their unit and
+ * default period; values are scaled to the IIO unit where hwmon uses another one. Every attribute
+ * is opened once and read with a single pread() per sample, and all the channels of a chip are
+ * read in the same tick of a timer of the chip. A chip is registered either as one JSON sensor
+ * hwmon/<chip> holding all its channels (grouped, the default):
+ *
+ *  {"core_0":45000,"core_1":47000,"fan1":1200}
+ *
+ * or as one numeric sensor per channel, hwmon/<chip>/<channel>. Channels are named by their label
+ * attribute when the driver provides one, by the attribute name otherwise.
+ *
+ * Configuration (sensorFw:/hwmonPlugin/...):
+ *  - enable        (bool)   discover and register the chips (default false)
+ *  - grouped       (bool)   one sensor per chip rather than per channel (default true)
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <inttypes.h>
+#include <ctype.h>
+#include <dirent.h>
+#include "interfaces.h"
+#include "sensorFw.h"
+#include "iioChannel.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory of the hwmon chips
+ */
+//--------------------------------------------------------------------------------------------------
+#define HWMON_CLASS_DIR             "/sys/class/hwmon"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of chips, of channels per chip and length of their names
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_CHIPS                   16
+#define MAX_CHANNELS                64
+#define MAX_NAME_LEN                32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of an attribute value
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_VALUE_LEN               32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Kind of hwmon channel, with the IIO channel type giving its unit and period, and the factor
+ * from the hwmon unit to the IIO unit
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* prefixPtr;              ///< Prefix of the attributes in hwmon
+    const char* iioTypePtr;             ///< IIO channel type
+    double scale;                       ///< Factor from the hwmon unit to the IIO unit
+    const char* unitPtr;                ///< Unit if there is no such IIO type (NULL otherwise)
+}
+channelKind_t;
+
+static const channelKind_t ChannelKinds[] =
+{
+    // hwmon        IIO type                Scale       Unit
+    { "temp",       "temp",                 1,          NULL    },  // millidegree Celsius
+    { "in",         "voltage",              1,          NULL    },  // millivolts
+    { "curr",       "current",              1,          NULL    },  // milliamps
+    { "power",      "power",                0.001,      NULL    },  // microwatts
+    { "energy",     "energy",               0.000001,   NULL    },  // microjoules
+    { "humidity",   "humidityrelative",     1,          NULL    },  // milli percent
+    { "fan",        "",                     1,          "RPM"   }
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Chip
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct hwmonChip hwmonChip_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Channel of a chip
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    hwmonChip_t* chipPtr;               ///< Chip
+    char name[MAX_NAME_LEN];            ///< Name of the channel
+    int fd;                             ///< Input attribute, open for the life of the plugin
+    double scale;                       ///< Factor from the hwmon unit to the unit of the sensor
+    const char* unitPtr;                ///< Unit of the sensor
+    uint32_t defaultPeriod;             ///< Default sampling period in seconds
+    void* handlerPtr;                   ///< Sensor handler, when not grouped
+    double period;                      ///< Sampling period, 0 if disabled
+    double nextDue;                     ///< Relative time of the next sample
+}
+hwmonChannel_t;
+
+struct hwmonChip
+{
+    char name[MAX_NAME_LEN];            ///< Name of the chip
+    hwmonChannel_t channels[MAX_CHANNELS];  ///< Channels
+    int channelCount;                   ///< Number of channels
+    void* handlerPtr;                   ///< Sensor handler, when grouped
+    double period;                      ///< Sampling period when grouped, 0 if disabled
+    double tickPeriod;                  ///< Period of the timer, 0 if stopped
+    le_timer_Ref_t timer;               ///< Timer of the ticks
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Chips
+ */
+//--------------------------------------------------------------------------------------------------
+static hwmonChip_t Chips[MAX_CHIPS];
+static int ChipCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Are the channels of a chip registered as one sensor?
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsGrouped = true;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetTime
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return (double)now.sec + ((double)now.usec / 1000000.0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the value of a channel
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if the attribute cannot be read (e.g. the sensor is not connected)
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadChannel
+(
+    const hwmonChannel_t* channelPtr,   ///< [IN]  Channel
+    double* valuePtr                    ///< [OUT] Value in the unit of the sensor
+)
+{
+    char buffer[MAX_VALUE_LEN];
+    char* endPtr;
+
+    // sysfs renders the attribute again on every read from offset 0.
+    ssize_t size = pread(channelPtr->fd, buffer, sizeof(buffer) - 1, 0);
+
+    if (size <= 0)
+    {
+        return LE_FAULT;
+    }
+
+    buffer[size] = '\0';
+
+    double value = strtod(buffer, &endPtr);
+
+    if (endPtr == buffer)
+    {
+        return LE_FAULT;
+    }
+
+    *valuePtr = value * channelPtr->scale;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample all the channels of a chip, grouped in a JSON document
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleChip
+(
+    char* valuePtr,                     ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Chip
+)
+{
+    const hwmonChip_t* chipPtr = contextPtr;
+    size_t size = *lengthPtr;
+    size_t length = 1;
+    double value;
+    int i;
+
+    valuePtr[0] = '{';
+
+    for (i = 0; i < chipPtr->channelCount; i++)
+    {
+        const hwmonChannel_t* channelPtr = &chipPtr->channels[i];
+
+        // Channels that cannot be read, e.g. sensors not connected, are left out.
+        if (ReadChannel(channelPtr, &value) != LE_OK)
+        {
+            continue;
+        }
+
+        int res = snprintf(valuePtr + length, size - length, "%s\"%s\":%.15g",
+                           (length > 1) ? "," : "", channelPtr->name, value);
+
+        if ((res < 0) || ((size_t)res >= size - length))
+        {
+            LE_ERROR("Too many channels in chip %s", chipPtr->name);
+            return LE_FAULT;
+        }
+
+        length += res;
+    }
+
+    if (length + 2 > size)
+    {
+        return LE_FAULT;
+    }
+
+    valuePtr[length++] = '}';
+    valuePtr[length] = '\0';
+    *lengthPtr = length;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample a channel
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleChannel
+(
+    double* valuePtr,                   ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Channel
+)
+{
+    return ReadChannel(contextPtr, valuePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample the channels of a chip that are due, in one tick
+ */
+//--------------------------------------------------------------------------------------------------
+static void ChipTick
+(
+    le_timer_Ref_t timerRef             ///< [IN] Timer of the chip
+)
+{
+    hwmonChip_t* chipPtr = le_timer_GetContextPtr(timerRef);
+    double now = GetTime();
+    int i;
+
+    if (IsGrouped)
+    {
+        sensorFw_PushSample(chipPtr->handlerPtr);
+        return;
+    }
+
+    for (i = 0; i < chipPtr->channelCount; i++)
+    {
+        hwmonChannel_t* channelPtr = &chipPtr->channels[i];
+
+        // Half a tick early is due, so that channels at the period of the tick never slip.
+        if ((channelPtr->period <= 0) || (channelPtr->nextDue > now + chipPtr->tickPeriod / 2))
+        {
+            continue;
+        }
+
+        channelPtr->nextDue += channelPtr->period;
+
+        if (channelPtr->nextDue < now)
+        {
+            channelPtr->nextDue = now + channelPtr->period;
+        }
+
+        sensorFw_PushSample(channelPtr->handlerPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the timer of a chip at the shortest period of its sensors
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateTick
+(
+    hwmonChip_t* chipPtr                ///< [IN] Chip
+)
+{
+    double period = 0;
+    int i;
+
+    if (IsGrouped)
+    {
+        period = chipPtr->period;
+    }
+    else
+    {
+        for (i = 0; i < chipPtr->channelCount; i++)
+        {
+            double channelPeriod = chipPtr->channels[i].period;
+
+            if ((channelPeriod > 0) && ((period == 0) || (channelPeriod < period)))
+            {
+                period = channelPeriod;
+            }
+        }
+    }
+
+    if (period == chipPtr->tickPeriod)
+    {
+        return;
+    }
+
+    chipPtr->tickPeriod = period;
+    le_timer_Stop(chipPtr->timer);
+
+    if (period > 0)
+    {
+        le_timer_SetMsInterval(chipPtr->timer, (uint32_t)(period * 1000));
+        le_timer_Start(chipPtr->timer);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the sampling period of a chip, when grouped
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetChipPeriod
+(
+    double period,                      ///< [IN] Sampling period, 0 if disabled
+    void* contextPtr                    ///< [IN] Chip
+)
+{
+    hwmonChip_t* chipPtr = contextPtr;
+
+    chipPtr->period = period;
+    UpdateTick(chipPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the sampling period of a channel
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetChannelPeriod
+(
+    double period,                      ///< [IN] Sampling period, 0 if disabled
+    void* contextPtr                    ///< [IN] Channel
+)
+{
+    hwmonChannel_t* channelPtr = contextPtr;
+
+    channelPtr->period = period;
+    channelPtr->nextDue = GetTime() + period;
+    UpdateTick(channelPtr->chipPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register a sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t RegisterSensor
+(
+    const char* pathPtr,                ///< [IN]  Path of the sensor
+    const char* unitPtr,                ///< [IN]  Unit
+    uint32_t period,                    ///< [IN]  Default sampling period in seconds
+    sensorfwDataType_t type,            ///< [IN]  Data type
+    sensorfwCallbacks_t* callbacksPtr,  ///< [IN]  Callbacks
+    void* contextPtr,                   ///< [IN]  Chip or channel
+    void** handlerPtrPtr                ///< [OUT] Sensor handler
+)
+{
+    char jsonDoc[256];
+
+    snprintf(jsonDoc,
+             sizeof(jsonDoc),
+             "{"
+             "\"name\" : \"%s\","
+             "\"plugin\" : \"hwmon\","
+             "\"path\" : \"%s\","
+             "\"readOnce\" : false,"
+             "\"period\" : %" PRIu32 ","
+             "\"unit\" : \"%s\""
+             "}",
+             pathPtr,
+             pathPtr,
+             period,
+             unitPtr);
+
+    if (sensorFw_RegisterCallback(jsonDoc, type, callbacksPtr, contextPtr, handlerPtrPtr) != LE_OK)
+    {
+        LE_ERROR("Error registering %s", pathPtr);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a short attribute of a chip, without the trailing new line
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the attribute does not exist
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadAttribute
+(
+    const char* dirPtr,                 ///< [IN]  Directory of the chip
+    const char* namePtr,                ///< [IN]  Name of the attribute
+    char* bufferPtr,                    ///< [OUT] Value
+    size_t bufferSize                   ///< [IN]  Buffer size
+)
+{
+    char path[PATH_MAX];
+
+    snprintf(path, sizeof(path), "%s/%s", dirPtr, namePtr);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    ssize_t size = read(fd, bufferPtr, bufferSize - 1);
+
+    close(fd);
+
+    if (size <= 0)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    bufferPtr[size] = '\0';
+    bufferPtr[strcspn(bufferPtr, "\n")] = '\0';
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make a name usable in a resource path and as a JSON member: lower case, anything else than
+ * letters, digits, '-' and '_' replaced with '_'
+ */
+//--------------------------------------------------------------------------------------------------
+static void CleanName
+(
+    char* namePtr                       ///< [INOUT] Name
+)
+{
+    for (; *namePtr != '\0'; namePtr++)
+    {
+        *namePtr = isalnum((unsigned char)*namePtr) ? tolower((unsigned char)*namePtr) :
+                   ((*namePtr == '-') ? '-' : '_');
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a channel of a chip, if the attribute is the input of a known kind of channel
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddChannel
+(
+    hwmonChip_t* chipPtr,               ///< [INOUT] Chip
+    const char* dirPtr,                 ///< [IN]    Directory of the chip
+    const char* attrPtr                 ///< [IN]    Name of the attribute
+)
+{
+    char base[MAX_NAME_LEN];
+    char label[MAX_NAME_LEN];
+    char path[PATH_MAX];
+    const char* suffixPtr = strstr(attrPtr, "_input");
+    size_t baseLen;
+    int i;
+
+    if ((suffixPtr == NULL) || (strcmp(suffixPtr, "_input") != 0) ||
+        ((baseLen = suffixPtr - attrPtr) >= sizeof(base)))
+    {
+        return;
+    }
+
+    memcpy(base, attrPtr, baseLen);
+    base[baseLen] = '\0';
+
+    // <prefix><index>, e.g. temp1 or in0.
+    const channelKind_t* kindPtr = NULL;
+    size_t prefixLen = strspn(base, "abcdefghijklmnopqrstuvwxyz");
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(ChannelKinds); i++)
+    {
+        if ((strlen(ChannelKinds[i].prefixPtr) == prefixLen) &&
+            (strncmp(ChannelKinds[i].prefixPtr, base, prefixLen) == 0) &&
+            isdigit((unsigned char)base[prefixLen]))
+        {
+            kindPtr = &ChannelKinds[i];
+            break;
+        }
+    }
+
+    if (kindPtr == NULL)
+    {
+        return;
+    }
+
+    if (chipPtr->channelCount >= MAX_CHANNELS)
+    {
+        LE_WARN("Too many channels in chip %s, %s left out", chipPtr->name, base);
+        return;
+    }
+
+    hwmonChannel_t* channelPtr = &chipPtr->channels[chipPtr->channelCount];
+
+    snprintf(path, sizeof(path), "%s/%s", dirPtr, attrPtr);
+    channelPtr->fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (channelPtr->fd < 0)
+    {
+        LE_WARN("Cannot open %s: %m", path);
+        return;
+    }
+
+    const iioChannel_Metadata_t* metaPtr = iioChannel_GetMetadata(kindPtr->iioTypePtr,
+                                                                 strlen(kindPtr->iioTypePtr));
+
+    channelPtr->chipPtr = chipPtr;
+    channelPtr->scale = kindPtr->scale;
+    channelPtr->unitPtr = (kindPtr->unitPtr != NULL) ? kindPtr->unitPtr : metaPtr->unit;
+    channelPtr->defaultPeriod = metaPtr->defaultPeriod;
+
+    // Named by its label if it has one that is not already taken, e.g. "Core 0" -> core_0.
+    snprintf(label, sizeof(label), "%s_label", base);
+    le_utf8_Copy(channelPtr->name, base, sizeof(channelPtr->name), NULL);
+
+    if (ReadAttribute(dirPtr, label, label, sizeof(label)) == LE_OK)
+    {
+        CleanName(label);
+
+        for (i = 0; i < chipPtr->channelCount; i++)
+        {
+            if (strcmp(chipPtr->channels[i].name, label) == 0)
+            {
+                break;
+            }
+        }
+
+        if ((i == chipPtr->channelCount) && (label[0] != '\0'))
+        {
+            le_utf8_Copy(channelPtr->name, label, sizeof(channelPtr->name), NULL);
+        }
+    }
+
+    chipPtr->channelCount++;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare the names of two channels
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareChannels
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    return strcmp(((const hwmonChannel_t*)aPtr)->name, ((const hwmonChannel_t*)bPtr)->name);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the input attribute of a channel, which is then never read
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseChannel
+(
+    hwmonChannel_t* channelPtr          ///< [IN] Channel
+)
+{
+    if (channelPtr->fd >= 0)
+    {
+        close(channelPtr->fd);
+        channelPtr->fd = -1;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register the sensors of a chip. Channels whose sensor cannot be registered are closed, and so
+ * is the whole chip if none can.
+ *
+ * @return:
+ *      - LE_OK if at least one sensor is registered
+ *      - LE_FAULT otherwise
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t RegisterChip
+(
+    hwmonChip_t* chipPtr                ///< [IN] Chip
+)
+{
+    char path[2 * MAX_NAME_LEN + 16];
+    sensorfwCallbacks_t pluginCb;
+    uint32_t period = 0;
+    int registeredCount = 0;
+    int i;
+
+    chipPtr->timer = le_timer_Create(chipPtr->name);
+    le_timer_SetRepeat(chipPtr->timer, 0);
+    le_timer_SetHandler(chipPtr->timer, ChipTick);
+    le_timer_SetContextPtr(chipPtr->timer, chipPtr);
+
+    memset(&pluginCb, 0, sizeof(pluginCb));
+
+    if (IsGrouped)
+    {
+        // The chip is sampled as often as its fastest channel would be.
+        for (i = 0; i < chipPtr->channelCount; i++)
+        {
+            uint32_t channelPeriod = chipPtr->channels[i].defaultPeriod;
+
+            if ((channelPeriod > 0) && ((period == 0) || (channelPeriod < period)))
+            {
+                period = channelPeriod;
+            }
+        }
+
+        snprintf(path, sizeof(path), "hwmon/%s", chipPtr->name);
+        pluginCb.sample.jsonCb = SampleChip;
+        pluginCb.periodCb = SetChipPeriod;
+
+        if (RegisterSensor(path, "", (period > 0) ? period : 60, SF_CB_JSON, &pluginCb, chipPtr,
+                           &chipPtr->handlerPtr) == LE_OK)
+        {
+            return LE_OK;
+        }
+
+        for (i = 0; i < chipPtr->channelCount; i++)
+        {
+            CloseChannel(&chipPtr->channels[i]);
+        }
+
+        le_timer_Delete(chipPtr->timer);
+        chipPtr->timer = NULL;
+        return LE_FAULT;
+    }
+
+    pluginCb.sample.numericCb = SampleChannel;
+    pluginCb.periodCb = SetChannelPeriod;
+
+    for (i = 0; i < chipPtr->channelCount; i++)
+    {
+        hwmonChannel_t* channelPtr = &chipPtr->channels[i];
+
+        snprintf(path, sizeof(path), "hwmon/%s/%s", chipPtr->name, channelPtr->name);
+
+        if (RegisterSensor(path, channelPtr->unitPtr,
+                           (channelPtr->defaultPeriod > 0) ? channelPtr->defaultPeriod : 60,
+                           SF_CB_NUMERIC, &pluginCb, channelPtr, &channelPtr->handlerPtr) != LE_OK)
+        {
+            // Its period stays 0, so the ticks of the chip skip it.
+            CloseChannel(channelPtr);
+            continue;
+        }
+
+        registeredCount++;
+    }
+
+    if (registeredCount == 0)
+    {
+        le_timer_Delete(chipPtr->timer);
+        chipPtr->timer = NULL;
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Discover a chip and its channels
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddChip
+(
+    const char* entryPtr                ///< [IN] Name of the chip directory, e.g. hwmon0
+)
+{
+    char dir[PATH_MAX];
+    char name[MAX_NAME_LEN];
+    struct dirent* attrPtr;
+    int i;
+
+    if (ChipCount >= MAX_CHIPS)
+    {
+        LE_WARN("Too many hwmon chips, %s left out", entryPtr);
+        return;
+    }
+
+    snprintf(dir, sizeof(dir), "%s/%s", HWMON_CLASS_DIR, entryPtr);
+
+    if (ReadAttribute(dir, "name", name, sizeof(name)) != LE_OK)
+    {
+        return;
+    }
+
+    CleanName(name);
+
+    hwmonChip_t* chipPtr = &Chips[ChipCount];
+
+    memset(chipPtr, 0, sizeof(*chipPtr));
+    le_utf8_Copy(chipPtr->name, name, sizeof(chipPtr->name), NULL);
+
+    // Several chips of the same driver are told apart by their hwmon index.
+    for (i = 0; i < ChipCount; i++)
+    {
+        if (strcmp(Chips[i].name, name) == 0)
+        {
+            snprintf(chipPtr->name, sizeof(chipPtr->name), "%.20s-%s",
+                     name, entryPtr + strlen("hwmon"));
+            break;
+        }
+    }
+
+    DIR* dirPtr = opendir(dir);
+
+    if (dirPtr == NULL)
+    {
+        return;
+    }
+
+    while ((attrPtr = readdir(dirPtr)) != NULL)
+    {
+        AddChannel(chipPtr, dir, attrPtr->d_name);
+    }
+
+    closedir(dirPtr);
+
+    if (chipPtr->channelCount == 0)
+    {
+        LE_DEBUG("No channel in hwmon chip %s", chipPtr->name);
+        return;
+    }
+
+    LE_INFO("hwmon chip %s: %d channels", chipPtr->name, chipPtr->channelCount);
+
+    // Directory order is arbitrary, keep the channels in the same order on every start.
+    qsort(chipPtr->channels, chipPtr->channelCount, sizeof(hwmonChannel_t), CompareChannels);
+
+    // The slot of a chip without any sensor is used by the next one.
+    if (RegisterChip(chipPtr) == LE_OK)
+    {
+        ChipCount++;
+    }
+}
+
+COMPONENT_INIT
+{
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn("hwmonPlugin");
+    bool isEnabled = le_cfg_GetBool(iteratorRef, "enable", false);
+    struct dirent* entryPtr;
+
+    IsGrouped = le_cfg_GetBool(iteratorRef, "grouped", true);
+    le_cfg_CancelTxn(iteratorRef);
+
+    if (!isEnabled)
+    {
+        LE_INFO("hwmon plugin disabled");
+        return;
+    }
+
+    LE_INFO("Start hwmon plugin");
+
+    DIR* dirPtr = opendir(HWMON_CLASS_DIR);
+
+    if (dirPtr == NULL)
+    {
+        LE_WARN("No hwmon class: %m");
+        return;
+    }
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        if (strncmp(entryPtr->d_name, "hwmon", strlen("hwmon")) == 0)
+        {
+            AddChip(entryPtr->d_name);
+        }
+    }
+
+    closedir(dirPtr);
+
+    LE_INFO("%d hwmon chips registered", ChipCount);
+}
@@ -13,22 +13,20 @@
 #include "stdio.h"
 #include "string.h"
 #include "stdlib.h"
+#include "interfaces.h"
 #include "sensorFw.h"
+#include "config.h"
+#include "iioChannel.h"
+#include "imuFusion.h"
+#include "iioTrigger.h"
 #include "jansson.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Default unit of measurement for sensor value.
+ * Periodic sensor pool size, no more sensors than the framework can register
  */
 //--------------------------------------------------------------------------------------------------
-#define     DEFAULT_MEAS_UNIT               ""
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Periodic sensor pool size
- */
-//--------------------------------------------------------------------------------------------------
-#define     SENSOR_CONTEXT_POOL_SIZE        100
+#define     SENSOR_CONTEXT_POOL_SIZE        SENSOR_HANDLER_POOL_SIZE
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -56,17 +54,97 @@
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Structure that defines the standard unit of measurement for different IIO sensors.
- *
- * Refer IIO documentation: https://www.kernel.org/doc/Documentation/ABI/testing/sysfs-bus-iio
+ * Default rate at which the orientation filter of an IMU is updated
  */
 //--------------------------------------------------------------------------------------------------
-typedef struct
-{
-    const char *measurementName;         ///< Sensor name as defined in iio
-    const char *standardUnit;            ///< Unit of measurement as defined in iio
-}
-iioUnits_t;
+#define     FUSION_DEFAULT_RATE_HZ          50
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum rate at which the orientation filter of an IMU can be updated
+ */
+//--------------------------------------------------------------------------------------------------
+#define     FUSION_MAX_RATE_HZ              400
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default gain of the orientation filter
+ */
+//--------------------------------------------------------------------------------------------------
+#define     FUSION_DEFAULT_BETA             0.1
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default period at which the orientation is published
+ */
+//--------------------------------------------------------------------------------------------------
+#define     FUSION_PUBLISH_PERIOD_SEC       1
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timeout of the operations on the local context
+ */
+//--------------------------------------------------------------------------------------------------
+#define     LOCAL_TIMEOUT_MS                5000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Node of the configuration tree listing the remote iiod contexts, and default timeout of the
+ * operations on a remote context
+ */
+//--------------------------------------------------------------------------------------------------
+#define     REMOTES_CONFIG_NODE             "iioPlugin/remotes"
+#define     REMOTE_DEFAULT_TIMEOUT_MS       2000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of remote contexts, and of channels registered per remote context
+ */
+//--------------------------------------------------------------------------------------------------
+#define     REMOTE_MAX_COUNT                8
+#define     REMOTE_MAX_CHANNELS             128
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remote iiod context
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct iioRemote iioRemote_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Node of the configuration tree listing the sampling groups captured on a trigger, and default
+ * number of samples per buffer
+ */
+//--------------------------------------------------------------------------------------------------
+#define     CAPTURE_CONFIG_NODE             "iioPlugin/triggers"
+#define     CAPTURE_DEFAULT_SAMPLES         8
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of sampling groups, and of devices and channels per group
+ */
+//--------------------------------------------------------------------------------------------------
+#define     CAPTURE_MAX_GROUPS              4
+#define     CAPTURE_MAX_DEVICES             4
+#define     CAPTURE_MAX_CHANNELS            32
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sampling group, devices captured on one trigger
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct iioCaptureGroup iioCaptureGroup_t;
 
 
 //--------------------------------------------------------------------------------------------------
@@ -78,47 +156,138 @@ typedef struct
 {
     struct iio_device* device;
     const struct iio_channel* chan;
+    iioChannel_Id_t id;                 ///< Parsed channel id
+    iioRemote_t* remotePtr;             ///< Remote context of the channel (NULL if local)
+    void* handlerPtr;                   ///< Sensor handler in the framework
+    bool isDue;                         ///< Is a sample of the remote channel pending?
+    iioCaptureGroup_t* groupPtr;        ///< Sampling group capturing the channel (NULL if polled)
+    double period;                      ///< Period of the captured samples (0 = disabled), read
+                                        ///< atomically by the capture thread
+    double lastCaptureTime;             ///< Time of the last captured sample pushed
+    double scale;                       ///< Scale of the captured samples
+    double offset;                      ///< Offset of the captured samples
 }
 iioSensorContext_t;
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Error type
+ * Remote iiod context. Its channels are read by a thread of their own, so that the network round
+ * trips never hold the event loop. The channels due in a tick are queued and read in one batch,
+ * with all their attributes fetched in a single request per channel.
+ */
+//--------------------------------------------------------------------------------------------------
+struct iioRemote
+{
+    char name[32];                                      ///< Name, prefix of the sensor paths
+    struct iio_context* ctx;                            ///< Context
+    le_thread_Ref_t thread;                             ///< Thread reading the channels
+    le_mutex_Ref_t mutex;                               ///< Protects the due channels
+    iioSensorContext_t* due[REMOTE_MAX_CHANNELS];       ///< Channels due, not read yet
+    uint32_t dueCount;                                  ///< Number of channels due
+    uint32_t channelCount;                              ///< Channels registered
+};
+
+static iioRemote_t Remotes[REMOTE_MAX_COUNT];
+static int RemoteCount;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Inputs of the orientation filter
  */
 //--------------------------------------------------------------------------------------------------
 typedef enum
 {
-    ATTRIBUTE_FOUND,
-    ATTRIBUTE_NOT_FOUND,
-    ATTRIBUTE_FAULT
+    FUSION_ACCEL,
+    FUSION_ANGLVEL,
+    FUSION_MAGN,
+    FUSION_INPUT_COUNT
 }
-attrErrorType_t;
+fusionInput_t;
+
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Context of the orientation sensor derived from the IMU channels of a device. The filter of a
+ * device of a sampling group is updated by the capture thread from the scans of the group, and
+ * the one of a polled device by a timer reading the channels.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct iioFusionContext
+{
+    struct iio_device* device;
+    const struct iio_channel* chan[FUSION_INPUT_COUNT][3];  ///< x, y and z channels of each input
+    bool isProcessed[FUSION_INPUT_COUNT][3];                ///< Is the input attribute polled?
+    double scale[FUSION_INPUT_COUNT][3];                    ///< Scales of the raw values
+    double offset[FUSION_INPUT_COUNT][3];                   ///< Offsets of the raw values
+    bool hasMagn;                                           ///< Are the magn channels available?
+    iioCaptureGroup_t* groupPtr;                            ///< Sampling group (NULL if polled)
+    le_mutex_Ref_t mutex;                                   ///< Protects the filter state
+    imuFusion_State_t filter;                               ///< Orientation filter
+    double rate;                                            ///< Filter update rate in Hz, read
+                                                            ///< atomically by the capture thread
+    le_timer_Ref_t timer;                                   ///< Filter update timer (if polled)
+    double lastUpdateTime;                                  ///< Time of the inputs of the last
+                                                            ///< filter update, in seconds
+    bool isStarted;                                         ///< Has the filter been updated yet?
+}
+iioFusionContext_t;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * List of sensors and their standard unit of measurement.
+ * Sampling group. The devices of the group are captured in buffers on a trigger of their own, by
+ * a thread that pushes the samples of their channels to the framework. The trigger runs at the
+ * frequency set in the configuration, or else at the rate of the fastest channel or orientation
+ * filter, and the samples of slower ones are decimated.
  */
 //--------------------------------------------------------------------------------------------------
-iioUnits_t IioStandardUnit[] =
+struct iioCaptureGroup
 {
-    // Sensor Name                  // Unit of measurement
-    { "temp",                       "milli degree celcius"                  },
-    { "pressure",                   "kilo pascals"                          },
-    { "anglvel",                    "radians per second"                    },
-    { "voltage",                    "millivolts"                            },
-    { "current",                    "milliamps"                             },
-    { "power",                      "milliwatts"                            },
-    { "capacitance",                "nanofarads"                            },
-    { "positionrelative",           "milli percent"                         },
-    { "magn",                       "Gauss"                                 },
-    { "accel",                      "m/s^2"                                 },
-    { "incli",                      "degrees"                               },
-    { "humidity",                   "milli percent"                         },
-    { "proximity",                  "meters"                                }
+    char name[32];                                      ///< Name of the group
+    iioTrigger_t trigger;                               ///< Trigger of the group
+    char deviceNames[CAPTURE_MAX_DEVICES][32];          ///< Names of the devices captured
+    uint32_t deviceCount;                               ///< Number of devices captured
+    struct iio_device* devices[CAPTURE_MAX_DEVICES];    ///< Devices, once the context is created
+    const struct iio_channel* timestamps[CAPTURE_MAX_DEVICES]; ///< Timestamp channels (or NULL)
+    iioFusionContext_t* fusions[CAPTURE_MAX_DEVICES];   ///< Orientation sensors (or NULL)
+    uint32_t fusionCount;                               ///< Number of orientation sensors
+    iioSensorContext_t* channels[CAPTURE_MAX_CHANNELS]; ///< Channels captured
+    uint32_t channelCount;                              ///< Number of channels captured
+    double frequency;                                   ///< Configured frequency (0 = periods)
+    uint32_t samples;                                   ///< Samples per buffer
+    le_thread_Ref_t thread;                             ///< Thread capturing the buffers
+    uint32_t droppedCount;                              ///< Samples the framework could not stage
 };
 
+static iioCaptureGroup_t CaptureGroups[CAPTURE_MAX_GROUPS];
+static int CaptureGroupCount;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of iio sensor contexts
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t SensorContextPool = NULL;
+
+LE_MEM_DEFINE_STATIC_POOL(SensorContextPool, SENSOR_CONTEXT_POOL_SIZE, sizeof(iioSensorContext_t));
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Error type
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    ATTRIBUTE_FOUND,
+    ATTRIBUTE_NOT_FOUND,
+    ATTRIBUTE_FAULT
+}
+attrErrorType_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get JSON document describing the sensor/actuator.
@@ -136,7 +305,8 @@ static le_result_t CreateJsonDocument
     const char* name,                   ///< [IN] Sensor name
     const char* path,                   ///< [IN] Relative path of sensor in dataHub
     bool isReadOnce,                    ///< [IN] Is sensor read once only?
-    const char* unit                    ///< [IN] Measurement unit
+    const char* unit,                   ///< [IN] Measurement unit
+    uint32_t period                     ///< [IN] Default sampling period in seconds
 )
 {
     char* isReadOnceString = isReadOnce? "true" : "false";
@@ -145,14 +315,18 @@ static le_result_t CreateJsonDocument
                        bufferSize,
                        "{"
                        "\"name\" : \"%s\","
+                       "\"plugin\" : \"iio\","
                        "\"path\" : \"%s\","
                        "\"readOnce\" : %s,"
-                       "\"unit\" : \"%s\""
+                       "\"unit\" : \"%s\","
+                       "\"period\" : %u,"
+                       "\"delta\" : true"
                        "}",
                        name,
                        path,
                        isReadOnceString,
-                       unit);
+                       unit,
+                       period);
 
     if (res < 0)
     {
@@ -209,201 +383,539 @@ static attrErrorType_t GetAttribute
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the unit of measurement
- *
- * @return:
- *         Unit of measurement if name is identified, else returns "".
+ * Apply to the trigger of a sampling group the configured frequency, or else the rate of its
+ * fastest channel or orientation filter. Runs on the main thread.
  */
 //--------------------------------------------------------------------------------------------------
-static const char* GetIiounit
+static void UpdateCaptureFrequency
 (
-    char* measNamePtr                        ///< The thing we are measuring
+    iioCaptureGroup_t* groupPtr                         ///< [IN] Sampling group
 )
 {
-    int i;
+    double frequency = groupPtr->frequency;
+    uint32_t i;
+
+    // Not started yet, applied when the trigger is assigned.
+    if (groupPtr->trigger.device == NULL)
+    {
+        return;
+    }
 
-    for (i = 0; i < (sizeof(IioStandardUnit) / sizeof((IioStandardUnit)[0])); i++)
+    if (frequency <= 0)
     {
-        if (strstr(measNamePtr, IioStandardUnit[i].measurementName) != NULL)
+        for (i = 0; i < groupPtr->channelCount; i++)
+        {
+            double period = groupPtr->channels[i]->period;
+
+            if ((period > 0) && ((1 / period) > frequency))
+            {
+                frequency = 1 / period;
+            }
+        }
+
+        for (i = 0; i < groupPtr->deviceCount; i++)
         {
-            return (char*)IioStandardUnit[i].standardUnit;
+            if ((groupPtr->fusions[i] != NULL) && (groupPtr->fusions[i]->rate > frequency))
+            {
+                frequency = groupPtr->fusions[i]->rate;
+            }
         }
     }
 
-    return (char*)DEFAULT_MEAS_UNIT;
+    iioTrigger_SetFrequency(&groupPtr->trigger, frequency);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Write the IIO attribute
+ * Called by the framework with the sampling period of a captured channel, 0 if it is disabled
  */
 //--------------------------------------------------------------------------------------------------
-static void UpdateIioConfig
+static void SetCapturePeriod
 (
-    json_t* incomingJsonData,
-    char* attrPtr,
-    const struct iio_channel* chan
+    double period,                                      ///< [IN] Period in seconds
+    void* contextPtr                                    ///< [IN] Context of the sensor
 )
 {
-    char writeVal[MAX_ATTR_LENGTH];
-    char readVal[MAX_ATTR_LENGTH];
+    iioSensorContext_t* sensorCtxtPtr = (iioSensorContext_t*)contextPtr;
 
-    if (json_is_number(incomingJsonData))
+    // Read by the capture thread.
+    __atomic_store(&sensorCtxtPtr->period, &period, __ATOMIC_RELAXED);
+    UpdateCaptureFrequency(sensorCtxtPtr->groupPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert a sample of a buffer to an integer in host order
+ *
+ * @return:
+ *      - Raw value
+ */
+//--------------------------------------------------------------------------------------------------
+static int64_t ConvertRaw
+(
+    const struct iio_channel* chan,                     ///< [IN] IIO Channel
+    const void* samplePtr                               ///< [IN] Sample in the buffer
+)
+{
+    const struct iio_data_format* formatPtr = iio_channel_get_data_format(chan);
+    uint8_t data[8];
+
+    iio_channel_convert(chan, data, samplePtr);
+
+    // Sign extended by the conversion.
+    switch (formatPtr->length / 8)
     {
-        double configValue = json_number_value(incomingJsonData);
-        snprintf(writeVal, sizeof(writeVal), "%f", configValue);
+        case 1:
+            return formatPtr->is_signed ? *(int8_t*)data : *(uint8_t*)data;
 
-        iio_channel_attr_read(chan, attrPtr, readVal, sizeof(readVal));
+        case 2:
+        {
+            uint16_t value;
+            memcpy(&value, data, sizeof(value));
+            return formatPtr->is_signed ? (int16_t)value : value;
+        }
 
-        if (strncmp(readVal, writeVal, sizeof(readVal)) != 0)
+        case 4:
         {
-            LE_INFO("Update %s value from %s to %s", attrPtr, readVal, writeVal);
+            uint32_t value;
+            memcpy(&value, data, sizeof(value));
+            return formatPtr->is_signed ? (int32_t)value : value;
+        }
 
-            // ToDo: updating attributes result in crash.
-            // iio_channel_attr_write(chan, attrPtr, writeVal);
+        default:
+        {
+            int64_t value;
+            memcpy(&value, data, sizeof(value));
+            return value;
         }
     }
-    else
-    {
-        LE_ERROR("JSON config data is not a number");
-    }
 }
 
+
 //--------------------------------------------------------------------------------------------------
 /**
- * Process incoming JSON string (Config write operation from server)
+ * Push the samples of the channels of a device captured in a buffer. Runs on the capture thread.
  */
 //--------------------------------------------------------------------------------------------------
-static void ProcessIncomingConfig
+static void PushCapturedSamples
 (
-    const char* jsonStringPtr,
-    char* attrPtr,
-    const struct iio_channel* chan
+    iioCaptureGroup_t* groupPtr,                        ///< [IN] Sampling group
+    uint32_t deviceIndex,                               ///< [IN] Index of the device
+    struct iio_buffer* bufferPtr,                       ///< [IN] Buffer just refilled
+    double refillTime                                   ///< [IN] Time of the refill
 )
 {
-    int i;
-
-    // load incoming json string and update the value
-    if (jsonStringPtr != NULL)
+    const struct iio_channel* timestampChan = groupPtr->timestamps[deviceIndex];
+    ptrdiff_t step = iio_buffer_step(bufferPtr);
+    uint8_t* endPtr = iio_buffer_end(bufferPtr);
+    double frequency = iioTrigger_GetFrequency(&groupPtr->trigger);
+    double interval = (frequency > 0) ? (1 / frequency) : 0;
+    uint32_t droppedCount = 0;
+    uint32_t i;
+
+    for (i = 0; i < groupPtr->channelCount; i++)
     {
-        json_t* jsonRootPtr = json_loads(jsonStringPtr, 0, NULL);
+        iioSensorContext_t* sensorCtxtPtr = groupPtr->channels[i];
+        double period;
+        uint8_t* samplePtr;
+        uint8_t* timestampPtr;
+        size_t count;
+        size_t n = 0;
+
+        // Set by the framework on the main thread.
+        __atomic_load(&sensorCtxtPtr->period, &period, __ATOMIC_RELAXED);
+
+        if ((sensorCtxtPtr->device != groupPtr->devices[deviceIndex]) || (period <= 0))
+        {
+            continue;
+        }
 
-        if (jsonRootPtr != NULL)
+        samplePtr = iio_buffer_first(bufferPtr, sensorCtxtPtr->chan);
+        timestampPtr = (timestampChan != NULL) ? iio_buffer_first(bufferPtr, timestampChan) : NULL;
+        count = (endPtr - samplePtr) / step;
+
+        for (; samplePtr < endPtr; samplePtr += step, n++)
         {
-            json_t* incomingAttr = json_object_get(jsonRootPtr, attrPtr);
+            double time;
 
-            if (incomingAttr == NULL)
+            // Without timestamp channel, the samples are spread back from the refill.
+            if (timestampPtr != NULL)
+            {
+                time = (double)ConvertRaw(timestampChan, timestampPtr) / 1000000000.0;
+                timestampPtr += step;
+            }
+            else
             {
-                return;
+                time = refillTime - ((count - 1 - n) * interval);
             }
 
-            if(!json_is_array(incomingAttr))
+            // Decimate to the period of the channel, within half a trigger interval.
+            if ((time >= sensorCtxtPtr->lastCaptureTime) &&
+                ((time - sensorCtxtPtr->lastCaptureTime) < (period - (interval / 2))))
             {
-                UpdateIioConfig(incomingAttr, attrPtr, chan);
+                continue;
             }
-            else
+
+            sensorCtxtPtr->lastCaptureTime = time;
+
+            double value = ((double)ConvertRaw(sensorCtxtPtr->chan, samplePtr) +
+                            sensorCtxtPtr->offset) * sensorCtxtPtr->scale;
+
+            if (sensorFw_PushNumeric(sensorCtxtPtr->handlerPtr, time, value) != LE_OK)
             {
-                for(i = 0; i < json_array_size(incomingAttr); i++)
-                {
-                    json_t* incomingJsonData = json_array_get(incomingAttr, i);
-                    UpdateIioConfig(incomingJsonData, attrPtr, chan);
-                }
+                droppedCount++;
             }
         }
     }
+
+    if (droppedCount > 0)
+    {
+        groupPtr->droppedCount += droppedCount;
+        LE_WARN("%" PRIu32 " samples of %s dropped (%" PRIu32 " in total)",
+                droppedCount, groupPtr->name, groupPtr->droppedCount);
+    }
 }
 
+
 //--------------------------------------------------------------------------------------------------
 /**
- * Find the attribute and add it to the JSON object
- *
- * @return:
- *         - LE_OK if attribute found
- *         - LE_NOT_FOUND if attribute not found
+ * Update the orientation filter of a device with the scans of a buffer, one scan per update at
+ * the rate of the filter. The axes of a scan are sampled on the same trigger, so that each update
+ * gets a coherent set of readings. Runs on the capture thread.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddAttrToJson
+static void UpdateCapturedFusion
 (
-    const struct iio_channel* chan,
-    json_t* jsonObj,
-    char* attrPtr,
-    const char* incomingConfigPtr
+    iioCaptureGroup_t* groupPtr,                        ///< [IN] Sampling group
+    uint32_t deviceIndex,                               ///< [IN] Index of the device
+    struct iio_buffer* bufferPtr,                       ///< [IN] Buffer just refilled
+    double refillTime                                   ///< [IN] Time of the refill
 )
 {
-    char attrVal[MAX_JSON_SIZE];
-    char* tokenPtr;
-    char* savePtr;
-    json_t* arr;
-    double readValue;
-
-    if(iio_channel_find_attr(chan, attrPtr))
+    iioFusionContext_t* fusionCtxtPtr = groupPtr->fusions[deviceIndex];
+    const struct iio_channel* timestampChan = groupPtr->timestamps[deviceIndex];
+    ptrdiff_t step = iio_buffer_step(bufferPtr);
+    uint8_t* endPtr = iio_buffer_end(bufferPtr);
+    double frequency = iioTrigger_GetFrequency(&groupPtr->trigger);
+    double interval = (frequency > 0) ? (1 / frequency) : 0;
+    fusionInput_t inputCount = fusionCtxtPtr->hasMagn ? FUSION_INPUT_COUNT : FUSION_MAGN;
+    uint8_t* samplePtrs[FUSION_INPUT_COUNT][3];
+    double vectors[FUSION_INPUT_COUNT][3];
+    double rate;
+    fusionInput_t input;
+    int axis;
+
+    // Set by the framework on the main thread.
+    __atomic_load(&fusionCtxtPtr->rate, &rate, __ATOMIC_RELAXED);
+
+    for (input = 0; input < inputCount; input++)
     {
-        iio_channel_attr_read(chan, attrPtr, attrVal, sizeof(attrVal));
+        for (axis = 0; axis < 3; axis++)
+        {
+            samplePtrs[input][axis] = iio_buffer_first(bufferPtr, fusionCtxtPtr->chan[input][axis]);
+        }
+    }
 
-        tokenPtr = strtok_r(attrVal , " ", &savePtr);
+    uint8_t* timestampPtr = (timestampChan != NULL) ? iio_buffer_first(bufferPtr, timestampChan)
+                                                    : NULL;
+    size_t count = (endPtr - samplePtrs[FUSION_ANGLVEL][0]) / step;
+    size_t n;
 
-        if (tokenPtr == NULL)
-        {
-            readValue = strtod(attrVal, NULL);
+    le_mutex_Lock(fusionCtxtPtr->mutex);
 
-            json_object_set_new(jsonObj, attrPtr, json_real(readValue));
+    for (n = 0; n < count; n++)
+    {
+        size_t position = n * step;
+        double time;
+        double dt = 1 / rate;
 
-            // Process incoming configuration data.
-            ProcessIncomingConfig(incomingConfigPtr, attrPtr, chan);
+        // Without timestamp channel, the scans are spread back from the refill.
+        if (timestampPtr != NULL)
+        {
+            time = (double)ConvertRaw(timestampChan, timestampPtr + position) / 1000000000.0;
         }
         else
         {
-            arr = json_array();
+            time = refillTime - ((count - 1 - n) * interval);
+        }
 
-            while(tokenPtr)
+        // Decimate to the rate of the filter, within half a trigger interval.
+        if (fusionCtxtPtr->isStarted && (time >= fusionCtxtPtr->lastUpdateTime))
+        {
+            if ((time - fusionCtxtPtr->lastUpdateTime) < (dt - (interval / 2)))
             {
-                readValue = strtod(tokenPtr, NULL);
-                json_array_append_new(arr, json_real(readValue));
-                tokenPtr = strtok_r(NULL , " ", &savePtr);
-
-                // Process incoming configuration data.
-                ProcessIncomingConfig(incomingConfigPtr, attrPtr, chan);
+                continue;
             }
 
-            // Add array to json object
-            json_object_set_new(jsonObj, attrPtr, arr);
+            dt = time - fusionCtxtPtr->lastUpdateTime;
         }
-    }
-    else
-    {
-        return LE_NOT_FOUND;
+
+        for (input = 0; input < inputCount; input++)
+        {
+            for (axis = 0; axis < 3; axis++)
+            {
+                int64_t raw = ConvertRaw(fusionCtxtPtr->chan[input][axis],
+                                         samplePtrs[input][axis] + position);
+
+                vectors[input][axis] = (raw + fusionCtxtPtr->offset[input][axis]) *
+                                       fusionCtxtPtr->scale[input][axis];
+            }
+        }
+
+        imuFusion_Update(&fusionCtxtPtr->filter, vectors[FUSION_ANGLVEL], vectors[FUSION_ACCEL],
+                         fusionCtxtPtr->hasMagn ? vectors[FUSION_MAGN] : NULL, dt);
+
+        fusionCtxtPtr->lastUpdateTime = time;
+        fusionCtxtPtr->isStarted = true;
     }
 
-    return LE_OK;
+    le_mutex_Unlock(fusionCtxtPtr->mutex);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Read/Write iio configuration in JSON format
- *
- * @return:
- *      - LE_OK on success
- *      - LE_FAULT on any other error
+ * Thread capturing the buffers of a sampling group
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ConfigIioSensor
+static void* CaptureThreadMain
 (
-    char* jsonStringPtr,                                  ///< [INOUT] JSON configuration
-    size_t* lengthPtr,                                    ///< [INOUT] length
-    void *contextPtr                                      ///< [IN] Context of the sensor
+    void* contextPtr                                    ///< [IN] Sampling group
 )
-//--------------------------------------------------------------------------------------------------
 {
-    const char* deviceName;
-    iioSensorContext_t* sensorCtxtPtr = (iioSensorContext_t*)(contextPtr);
+    iioCaptureGroup_t* groupPtr = (iioCaptureGroup_t*)contextPtr;
+    struct iio_buffer* buffers[CAPTURE_MAX_DEVICES];
+    uint32_t i;
 
-    json_t* sensorConfigObj = json_object();
-
-    if (jsonStringPtr == NULL)
+    for (i = 0; i < groupPtr->deviceCount; i++)
     {
-        LE_ERROR("Buffer pointer is NULL");
+        buffers[i] = NULL;
+
+        if (groupPtr->devices[i] != NULL)
+        {
+            buffers[i] = iio_device_create_buffer(groupPtr->devices[i], groupPtr->samples, false);
+
+            if (buffers[i] == NULL)
+            {
+                LE_ERROR("Failed to create the buffer of %s: %m", groupPtr->deviceNames[i]);
+            }
+        }
+    }
+
+    // The devices share the trigger, so each refill waits about as long as the first one.
+    for (;;)
+    {
+        bool isCapturing = false;
+
+        for (i = 0; i < groupPtr->deviceCount; i++)
+        {
+            if (buffers[i] == NULL)
+            {
+                continue;
+            }
+
+            isCapturing = true;
+
+            ssize_t result = iio_buffer_refill(buffers[i]);
+
+            // Times out while the trigger is stopped.
+            if (result == -ETIMEDOUT)
+            {
+                continue;
+            }
+
+            if (result < 0)
+            {
+                LE_ERROR("Failed to capture %s: %s", groupPtr->deviceNames[i], strerror(-result));
+                sleep(1);
+                continue;
+            }
+
+            le_clk_Time_t now = le_clk_GetAbsoluteTime();
+            double refillTime = now.sec + (now.usec / 1000000.0);
+
+            PushCapturedSamples(groupPtr, i, buffers[i], refillTime);
+
+            if (groupPtr->fusions[i] != NULL)
+            {
+                UpdateCapturedFusion(groupPtr, i, buffers[i], refillTime);
+            }
+        }
+
+        if (!isCapturing)
+        {
+            LE_ERROR("Nothing to capture in %s", groupPtr->name);
+            return NULL;
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the IIO attribute
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateIioConfig
+(
+    json_t* incomingJsonData,
+    char* attrPtr,
+    const struct iio_channel* chan
+)
+{
+    char writeVal[MAX_ATTR_LENGTH];
+    char readVal[MAX_ATTR_LENGTH];
+
+    if (json_is_number(incomingJsonData))
+    {
+        double configValue = json_number_value(incomingJsonData);
+        snprintf(writeVal, sizeof(writeVal), "%f", configValue);
+
+        iio_channel_attr_read(chan, attrPtr, readVal, sizeof(readVal));
+
+        if (strncmp(readVal, writeVal, sizeof(readVal)) != 0)
+        {
+            LE_INFO("Update %s value from %s to %s", attrPtr, readVal, writeVal);
+
+            // ToDo: updating attributes result in crash.
+            // iio_channel_attr_write(chan, attrPtr, writeVal);
+        }
+    }
+    else
+    {
+        LE_ERROR("JSON config data is not a number");
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Process incoming JSON configuration (Config write operation from server)
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProcessIncomingConfig
+(
+    json_t* incomingConfigPtr,
+    char* attrPtr,
+    const struct iio_channel* chan
+)
+{
+    int i;
+
+    if (incomingConfigPtr == NULL)
+    {
+        return;
+    }
+
+    json_t* incomingAttr = json_object_get(incomingConfigPtr, attrPtr);
+
+    if (incomingAttr == NULL)
+    {
+        return;
+    }
+
+    if(!json_is_array(incomingAttr))
+    {
+        UpdateIioConfig(incomingAttr, attrPtr, chan);
+    }
+    else
+    {
+        for(i = 0; i < json_array_size(incomingAttr); i++)
+        {
+            json_t* incomingJsonData = json_array_get(incomingAttr, i);
+            UpdateIioConfig(incomingJsonData, attrPtr, chan);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the attribute and add it to the JSON object
+ *
+ * @return:
+ *         - LE_OK if attribute found
+ *         - LE_NOT_FOUND if attribute not found
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AddAttrToJson
+(
+    const struct iio_channel* chan,
+    json_t* jsonObj,
+    char* attrPtr,
+    json_t* incomingConfigPtr
+)
+{
+    char attrVal[MAX_JSON_SIZE];
+    char* tokenPtr;
+    char* savePtr;
+    json_t* arr;
+    double readValue;
+
+    if(iio_channel_find_attr(chan, attrPtr))
+    {
+        iio_channel_attr_read(chan, attrPtr, attrVal, sizeof(attrVal));
+
+        tokenPtr = strtok_r(attrVal , " ", &savePtr);
+
+        if (tokenPtr == NULL)
+        {
+            readValue = strtod(attrVal, NULL);
+
+            json_object_set_new(jsonObj, attrPtr, json_real(readValue));
+        }
+        else
+        {
+            arr = json_array();
+
+            while(tokenPtr)
+            {
+                readValue = strtod(tokenPtr, NULL);
+                json_array_append_new(arr, json_real(readValue));
+                tokenPtr = strtok_r(NULL , " ", &savePtr);
+            }
+
+            // Add array to json object
+            json_object_set_new(jsonObj, attrPtr, arr);
+        }
+
+        // Process incoming configuration data.
+        ProcessIncomingConfig(incomingConfigPtr, attrPtr, chan);
+    }
+    else
+    {
+        return LE_NOT_FOUND;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read/Write iio configuration in JSON format
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ConfigIioSensor
+(
+    char* jsonStringPtr,                                  ///< [INOUT] JSON configuration
+    size_t* lengthPtr,                                    ///< [INOUT] length
+    void *contextPtr                                      ///< [IN] Context of the sensor
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* deviceName;
+    iioSensorContext_t* sensorCtxtPtr = (iioSensorContext_t*)(contextPtr);
+
+    if (jsonStringPtr == NULL)
+    {
+        LE_ERROR("Buffer pointer is NULL");
         return LE_FAULT;
     }
 
@@ -426,11 +938,16 @@ static le_result_t ConfigIioSensor
     const char* channelName = (char*)iio_channel_get_id(sensorCtxtPtr->chan);
     LE_INFO("Config '%s/%s'", deviceName, channelName);
 
+    // Parse the incoming configuration once for all the attributes (NULL if there is none).
+    json_t* incomingConfigPtr = json_loads(jsonStringPtr, 0, NULL);
+    json_t* sensorConfigObj = json_object();
+
     // Add sampling frequency
     if (iio_channel_find_attr(sensorCtxtPtr->chan, "sampling_frequency_available"))
     {
         LE_INFO("Adjust sampling frequency");
-        AddAttrToJson(sensorCtxtPtr->chan, sensorConfigObj, "sampling_frequency", jsonStringPtr);
+        AddAttrToJson(sensorCtxtPtr->chan, sensorConfigObj, "sampling_frequency",
+                      incomingConfigPtr);
     }
     else
     {
@@ -441,7 +958,7 @@ static le_result_t ConfigIioSensor
     if (iio_channel_find_attr(sensorCtxtPtr->chan, "scale_available"))
     {
         LE_INFO("Adjust scale");
-        AddAttrToJson(sensorCtxtPtr->chan, sensorConfigObj, "scale", jsonStringPtr);
+        AddAttrToJson(sensorCtxtPtr->chan, sensorConfigObj, "scale", incomingConfigPtr);
     }
     else
     {
@@ -457,10 +974,37 @@ static le_result_t ConfigIioSensor
     // Add oversampling ratio available (Read only)
     AddAttrToJson(sensorCtxtPtr->chan, sensorConfigObj, "oversampling_ratio_available", NULL);
 
+    // Frequency of the trigger of a captured channel, 0 to follow the periods of the channels.
+    if (sensorCtxtPtr->groupPtr != NULL)
+    {
+        iioCaptureGroup_t* groupPtr = sensorCtxtPtr->groupPtr;
+        json_t* frequencyPtr = json_object_get(incomingConfigPtr, "trigger_frequency");
+
+        if (json_is_number(frequencyPtr) && (json_number_value(frequencyPtr) >= 0))
+        {
+            groupPtr->frequency = json_number_value(frequencyPtr);
+            UpdateCaptureFrequency(groupPtr);
+        }
+
+        json_object_set_new(sensorConfigObj, "trigger", json_string(groupPtr->trigger.name));
+        json_object_set_new(sensorConfigObj, "trigger_frequency", json_real(groupPtr->frequency));
+    }
+
+    if (incomingConfigPtr != NULL)
+    {
+        json_decref(incomingConfigPtr);
+    }
+
     // convert to a json string
     char* str = json_dumps(sensorConfigObj, REAL_PRECISION);
     json_decref(sensorConfigObj);
 
+    if (str == NULL)
+    {
+        LE_ERROR("Error formatting configuration of '%s/%s'", deviceName, channelName);
+        return LE_FAULT;
+    }
+
     le_utf8_Copy(jsonStringPtr, str, *lengthPtr, NULL);
     free(str);
     return LE_OK;
@@ -469,45 +1013,22 @@ static le_result_t ConfigIioSensor
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Sample iio sensor
+ * Read the value of a channel, scaled according to its scale and offset.
  *
  * @return:
  *      - LE_OK on success
  *      - LE_FAULT on any other error
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t SampleIioSensor
+static le_result_t ReadChannel
 (
-    double* readValuePtr,                               ///< [OUT] Sampled value
-    size_t* lengthPtr,                                  ///< [INOUT] length
-    void *contextPtr                                    ///< [IN] Context of the sensor
+    const struct iio_channel* chan,                     ///< [IN]  IIO Channel
+    double* readValuePtr                                ///< [OUT] Value
 )
-//--------------------------------------------------------------------------------------------------
 {
     double inputValue;
-    const char* deviceName;
-
-    iioSensorContext_t* sensorCtxtPtr = (iioSensorContext_t*)(contextPtr);
-
-    if (sensorCtxtPtr == NULL)
-    {
-        LE_ERROR("Sensor context empty");
-        return LE_FAULT;
-    }
-    else
-    {
-        deviceName = iio_device_get_name(sensorCtxtPtr->device);
-    }
-
-    if ((deviceName == NULL) || (sensorCtxtPtr->chan == NULL))
-    {
-        LE_ERROR("Device name or channel name is empty");
-        return LE_FAULT;
-    }
 
-    const char* channelName = (char*)iio_channel_get_id(sensorCtxtPtr->chan);
-
-    attrErrorType_t result = GetAttribute(sensorCtxtPtr->chan, "input", &inputValue);
+    attrErrorType_t result = GetAttribute(chan, "input", &inputValue);
 
     // Sensor can be sampled only if "input" or "raw" value is available.
     if(result == ATTRIBUTE_FOUND)
@@ -520,165 +1041,1370 @@ static le_result_t SampleIioSensor
         // scale it accordingly.
         // ToDo: Test this with other sensor types. What about
         // calibration data?
-        double raw, offset, scale, finalValue;
+        double raw;
+        double offset = 0;
+        double scale = 1;
 
         // Check if raw value is available.
-        GetAttribute(sensorCtxtPtr->chan, "raw", &raw);
-        GetAttribute(sensorCtxtPtr->chan, "offset", &offset);
-        GetAttribute(sensorCtxtPtr->chan, "scale", &scale);
+        if (GetAttribute(chan, "raw", &raw) != ATTRIBUTE_FOUND)
+        {
+            return LE_FAULT;
+        }
 
-        finalValue = (raw * scale) + (offset * scale);
+        GetAttribute(chan, "offset", &offset);
+        GetAttribute(chan, "scale", &scale);
 
-        *readValuePtr = finalValue;
+        *readValuePtr = (raw * scale) + (offset * scale);
     }
 
-    LE_INFO("Sample value of '%s/%s' is %lf", deviceName, channelName, *readValuePtr);
     return LE_OK;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Init IIO plugin
+ * Attributes of a channel read in one request
  */
 //--------------------------------------------------------------------------------------------------
-static void IioPluginInit
+typedef struct
+{
+    bool hasInput;                                      ///< Is the processed value available?
+    bool hasRaw;                                        ///< Is the raw value available?
+    double input;                                       ///< Processed value
+    double raw;                                         ///< Raw value
+    double scale;                                       ///< Scale of the raw value
+    double offset;                                      ///< Offset of the raw value
+}
+channelAttrs_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Keep the attributes needed to compute the value of a channel
+ *
+ * @return:
+ *      - 0 to continue with the next attribute
+ */
+//--------------------------------------------------------------------------------------------------
+static int StoreChannelAttr
 (
-    void
+    struct iio_channel* chan,                           ///< [IN] IIO Channel
+    const char* attrName,                               ///< [IN] Attribute name
+    const char* valuePtr,                               ///< [IN] Value
+    size_t length,                                      ///< [IN] Length of the value
+    void* contextPtr                                    ///< [IN] Attributes read
 )
 {
-    unsigned int i;
-    char resourcePath[256];
-    struct iio_device *device;
-    char* channelName;
-    unsigned int j;
-    const struct iio_channel *chan;
-    const char* deviceName;
-    double inputValue;
-    char jsonDoc[MAX_JSON_SIZE];
-    le_result_t res;
-
-    struct iio_context *localCtx = iio_create_local_context();
+    channelAttrs_t* attrsPtr = (channelAttrs_t*)contextPtr;
+    char attrVal[MAX_ATTR_LENGTH];
 
-    if (localCtx == NULL)
+    if (length >= sizeof(attrVal))
     {
-        LE_ERROR("Failed to create iio local context");
+        length = sizeof(attrVal) - 1;
+    }
+
+    memcpy(attrVal, valuePtr, length);
+    attrVal[length] = '\0';
+
+    if (strcmp(attrName, "input") == 0)
+    {
+        attrsPtr->input = atof(attrVal);
+        attrsPtr->hasInput = true;
+    }
+    else if (strcmp(attrName, "raw") == 0)
+    {
+        attrsPtr->raw = atof(attrVal);
+        attrsPtr->hasRaw = true;
+    }
+    else if (strcmp(attrName, "scale") == 0)
+    {
+        attrsPtr->scale = atof(attrVal);
+    }
+    else if (strcmp(attrName, "offset") == 0)
+    {
+        attrsPtr->offset = atof(attrVal);
+    }
+
+    return 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the value of a channel of a remote context, with all its attributes fetched in a single
+ * round trip rather than one per attribute.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadRemoteChannel
+(
+    const struct iio_channel* chan,                     ///< [IN]  IIO Channel
+    double* readValuePtr                                ///< [OUT] Value
+)
+{
+    channelAttrs_t attrs;
+
+    memset(&attrs, 0, sizeof(attrs));
+    attrs.scale = 1;
+
+    if (iio_channel_attr_read_all((struct iio_channel*)chan, StoreChannelAttr, &attrs) != 0)
+    {
+        return LE_FAULT;
+    }
+
+    if (attrs.hasInput)
+    {
+        *readValuePtr = attrs.input;
+    }
+    else if (attrs.hasRaw)
+    {
+        *readValuePtr = (attrs.raw * attrs.scale) + (attrs.offset * attrs.scale);
+    }
+    else
+    {
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the channels due of a remote context. Runs on the thread of the remote context.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadDueChannels
+(
+    void* param1Ptr,                                    ///< [IN] Remote context
+    void* param2Ptr                                     ///< [IN] Unused
+)
+{
+    iioRemote_t* remotePtr = (iioRemote_t*)param1Ptr;
+    iioSensorContext_t* batch[REMOTE_MAX_CHANNELS];
+    uint32_t count;
+    uint32_t i;
+
+    le_mutex_Lock(remotePtr->mutex);
+
+    count = remotePtr->dueCount;
+    memcpy(batch, remotePtr->due, count * sizeof(batch[0]));
+    remotePtr->dueCount = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        batch[i]->isDue = false;
+    }
+
+    le_mutex_Unlock(remotePtr->mutex);
+
+    // The sample callbacks run on this thread and the samples are staged to the framework.
+    for (i = 0; i < count; i++)
+    {
+        sensorFw_PushSample(batch[i]->handlerPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a channel of a remote context to be read by the thread of the context
+ */
+//--------------------------------------------------------------------------------------------------
+static void ScheduleRemoteRead
+(
+    iioSensorContext_t* sensorCtxtPtr                   ///< [IN] Context of the sensor
+)
+{
+    iioRemote_t* remotePtr = sensorCtxtPtr->remotePtr;
+
+    le_mutex_Lock(remotePtr->mutex);
+
+    // A channel still due from the previous tick is read once.
+    if (!sensorCtxtPtr->isDue && (remotePtr->dueCount < REMOTE_MAX_CHANNELS))
+    {
+        sensorCtxtPtr->isDue = true;
+        remotePtr->due[remotePtr->dueCount++] = sensorCtxtPtr;
+
+        // Channels due in the same tick are read by the same batch.
+        if (remotePtr->dueCount == 1)
+        {
+            le_event_QueueFunctionToThread(remotePtr->thread, ReadDueChannels, remotePtr, NULL);
+        }
+    }
+
+    le_mutex_Unlock(remotePtr->mutex);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread reading the channels of a remote context
+ */
+//--------------------------------------------------------------------------------------------------
+static void* RemoteThreadMain
+(
+    void* contextPtr                                    ///< [IN] Remote context
+)
+{
+    le_event_RunLoop();
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample iio sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleIioSensor
+(
+    double* readValuePtr,                               ///< [OUT] Sampled value
+    size_t* lengthPtr,                                  ///< [INOUT] length
+    void *contextPtr                                    ///< [IN] Context of the sensor
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* deviceName;
+
+    iioSensorContext_t* sensorCtxtPtr = (iioSensorContext_t*)(contextPtr);
+
+    if (sensorCtxtPtr == NULL)
+    {
+        LE_ERROR("Sensor context empty");
+        return LE_FAULT;
+    }
+    else
+    {
+        deviceName = iio_device_get_name(sensorCtxtPtr->device);
+    }
+
+    if ((deviceName == NULL) || (sensorCtxtPtr->chan == NULL))
+    {
+        LE_ERROR("Device name or channel name is empty");
+        return LE_FAULT;
+    }
+
+    const char* channelName = (char*)iio_channel_get_id(sensorCtxtPtr->chan);
+
+    if (sensorCtxtPtr->remotePtr != NULL)
+    {
+        // Sampled by the framework timer: read by the thread of the remote context instead.
+        if (le_thread_GetCurrent() != sensorCtxtPtr->remotePtr->thread)
+        {
+            ScheduleRemoteRead(sensorCtxtPtr);
+            return LE_UNAVAILABLE;
+        }
+
+        if (ReadRemoteChannel(sensorCtxtPtr->chan, readValuePtr) != LE_OK)
+        {
+            LE_ERROR("Error reading '%s/%s/%s'",
+                     sensorCtxtPtr->remotePtr->name, deviceName, channelName);
+            return LE_FAULT;
+        }
+    }
+    else if (ReadChannel(sensorCtxtPtr->chan, readValuePtr) != LE_OK)
+    {
+        LE_ERROR("Error reading '%s/%s'", deviceName, channelName);
+        return LE_FAULT;
+    }
+
+    LE_INFO("Sample value of '%s/%s' is %lf", deviceName, channelName, *readValuePtr);
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the x, y and z channels of one input of the orientation filter: one attribute per axis,
+ * the raw values being scaled with the scales and offsets read at registration.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadFusionInput
+(
+    iioFusionContext_t* fusionCtxtPtr,                  ///< [IN]  Orientation sensor context
+    fusionInput_t input,                                ///< [IN]  Input to read
+    double vector[3]                                    ///< [OUT] Scaled values
+)
+{
+    int axis;
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        const struct iio_channel* chan = fusionCtxtPtr->chan[input][axis];
+        double raw;
+
+        if (fusionCtxtPtr->isProcessed[input][axis])
+        {
+            if (GetAttribute(chan, "input", &vector[axis]) != ATTRIBUTE_FOUND)
+            {
+                return LE_FAULT;
+            }
+        }
+        else if (GetAttribute(chan, "raw", &raw) == ATTRIBUTE_FOUND)
+        {
+            vector[axis] = (raw + fusionCtxtPtr->offset[input][axis]) *
+                           fusionCtxtPtr->scale[input][axis];
+        }
+        else
+        {
+            return LE_FAULT;
+        }
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the scales and offsets of the IMU channels, to convert their raw values without reading
+ * them again at each update. The attributes of the channels are not written by the plugin.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadFusionScales
+(
+    iioFusionContext_t* fusionCtxtPtr                   ///< [INOUT] Orientation sensor context
+)
+{
+    fusionInput_t input;
+    int axis;
+
+    for (input = 0; input < FUSION_INPUT_COUNT; input++)
+    {
+        for (axis = 0; axis < 3; axis++)
+        {
+            const struct iio_channel* chan = fusionCtxtPtr->chan[input][axis];
+
+            fusionCtxtPtr->scale[input][axis] = 1;
+            fusionCtxtPtr->offset[input][axis] = 0;
+
+            if (chan == NULL)
+            {
+                continue;
+            }
+
+            fusionCtxtPtr->isProcessed[input][axis] = iio_channel_find_attr(chan, "input") != NULL;
+            GetAttribute(chan, "scale", &fusionCtxtPtr->scale[input][axis]);
+            GetAttribute(chan, "offset", &fusionCtxtPtr->offset[input][axis]);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the update rate of the orientation filter. The filter of a captured device follows the
+ * trigger of its group. Otherwise the interval of the timer is set in microseconds: in
+ * milliseconds, rates such as 400 Hz would be rounded to another one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetFusionRate
+(
+    iioFusionContext_t* fusionCtxtPtr,                  ///< [IN] Orientation sensor context
+    double rate                                         ///< [IN] Update rate in Hz
+)
+{
+    __atomic_store(&fusionCtxtPtr->rate, &rate, __ATOMIC_RELAXED);
+
+    if (fusionCtxtPtr->groupPtr != NULL)
+    {
+        UpdateCaptureFrequency(fusionCtxtPtr->groupPtr);
+        return;
+    }
+
+    uint64_t intervalUs = (uint64_t)((1000000.0 / rate) + 0.5);
+    le_clk_Time_t interval;
+
+    interval.sec = intervalUs / 1000000;
+    interval.usec = intervalUs % 1000000;
+
+    le_timer_SetInterval(fusionCtxtPtr->timer, interval);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update the orientation filter of a polled device with the current IMU readings. The axes are
+ * read one after another and not sampled together: the readings of an update may straddle a
+ * sample of the IMU, which only the scans of a sampling group avoid.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateFusion
+(
+    le_timer_Ref_t timerRef                             ///< [IN] Filter update timer
+)
+{
+    iioFusionContext_t* fusionCtxtPtr = (iioFusionContext_t*)le_timer_GetContextPtr(timerRef);
+    double accel[3], gyro[3], magn[3];
+    double dt = 1.0 / fusionCtxtPtr->rate;
+
+    if ((ReadFusionInput(fusionCtxtPtr, FUSION_ANGLVEL, gyro) != LE_OK) ||
+        (ReadFusionInput(fusionCtxtPtr, FUSION_ACCEL, accel) != LE_OK))
+    {
+        LE_DEBUG("Skip orientation update of '%s'", iio_device_get_name(fusionCtxtPtr->device));
         return;
     }
 
-    if (iio_context_set_timeout(localCtx, 5000) != 0)
+    bool hasMagn = fusionCtxtPtr->hasMagn &&
+                   (ReadFusionInput(fusionCtxtPtr, FUSION_MAGN, magn) == LE_OK);
+
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+    double time = now.sec + (now.usec / 1000000.0);
+
+    le_mutex_Lock(fusionCtxtPtr->mutex);
+
+    if (fusionCtxtPtr->isStarted)
+    {
+        dt = time - fusionCtxtPtr->lastUpdateTime;
+    }
+
+    fusionCtxtPtr->lastUpdateTime = time;
+    fusionCtxtPtr->isStarted = true;
+
+    imuFusion_Update(&fusionCtxtPtr->filter, gyro, accel, hasMagn ? magn : NULL, dt);
+
+    le_mutex_Unlock(fusionCtxtPtr->mutex);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample the orientation sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNAVAILABLE if the filter has not been updated yet
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleOrientation
+(
+    char* jsonStringPtr,                                ///< [OUT] Orientation in JSON format
+    size_t* lengthPtr,                                  ///< [INOUT] length
+    void *contextPtr                                    ///< [IN] Context of the sensor
+)
+{
+    iioFusionContext_t* fusionCtxtPtr = (iioFusionContext_t*)(contextPtr);
+    double q[4];
+    double roll, pitch, yaw;
+
+    if (fusionCtxtPtr == NULL)
+    {
+        LE_ERROR("Sensor context empty");
+        return LE_FAULT;
+    }
+
+    le_mutex_Lock(fusionCtxtPtr->mutex);
+
+    if (!fusionCtxtPtr->isStarted)
+    {
+        le_mutex_Unlock(fusionCtxtPtr->mutex);
+        return LE_UNAVAILABLE;
+    }
+
+    memcpy(q, fusionCtxtPtr->filter.q, sizeof(q));
+    imuFusion_GetEuler(&fusionCtxtPtr->filter, &roll, &pitch, &yaw);
+
+    le_mutex_Unlock(fusionCtxtPtr->mutex);
+
+    int res = snprintf(jsonStringPtr,
+                       *lengthPtr,
+                       "{\"q\":[%.6f,%.6f,%.6f,%.6f],\"euler\":[%.3f,%.3f,%.3f]}",
+                       q[0], q[1], q[2], q[3],
+                       roll, pitch, yaw);
+
+    if ((res < 0) || (res >= *lengthPtr))
+    {
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read/Write the orientation filter configuration in JSON format
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ConfigOrientation
+(
+    char* jsonStringPtr,                                ///< [INOUT] JSON configuration
+    size_t* lengthPtr,                                  ///< [INOUT] length
+    void *contextPtr                                    ///< [IN] Context of the sensor
+)
+{
+    iioFusionContext_t* fusionCtxtPtr = (iioFusionContext_t*)(contextPtr);
+
+    if ((jsonStringPtr == NULL) || (fusionCtxtPtr == NULL))
+    {
+        LE_ERROR("Buffer pointer or sensor context is NULL");
+        return LE_FAULT;
+    }
+
+    // Process incoming configuration data.
+    json_t* jsonRootPtr = json_loads(jsonStringPtr, 0, NULL);
+
+    if (jsonRootPtr != NULL)
+    {
+        json_t* ratePtr = json_object_get(jsonRootPtr, "rate");
+        json_t* betaPtr = json_object_get(jsonRootPtr, "beta");
+
+        if (json_is_number(ratePtr))
+        {
+            double rate = json_number_value(ratePtr);
+
+            if ((rate > 0) && (rate <= FUSION_MAX_RATE_HZ) && (rate != fusionCtxtPtr->rate))
+            {
+                LE_INFO("Update orientation filter rate from %lf to %lf Hz",
+                        fusionCtxtPtr->rate, rate);
+
+                if (fusionCtxtPtr->timer != NULL)
+                {
+                    le_timer_Stop(fusionCtxtPtr->timer);
+                    SetFusionRate(fusionCtxtPtr, rate);
+                    le_timer_Start(fusionCtxtPtr->timer);
+                }
+                else
+                {
+                    SetFusionRate(fusionCtxtPtr, rate);
+                }
+            }
+        }
+
+        if (json_is_number(betaPtr) && (json_number_value(betaPtr) >= 0))
+        {
+            le_mutex_Lock(fusionCtxtPtr->mutex);
+            fusionCtxtPtr->filter.beta = json_number_value(betaPtr);
+            le_mutex_Unlock(fusionCtxtPtr->mutex);
+        }
+
+        json_decref(jsonRootPtr);
+    }
+
+    int res = snprintf(jsonStringPtr,
+                       *lengthPtr,
+                       "{\"rate\":%lf,\"beta\":%lf,\"magn\":%s}",
+                       fusionCtxtPtr->rate,
+                       fusionCtxtPtr->filter.beta,
+                       fusionCtxtPtr->hasMagn ? "true" : "false");
+
+    if ((res < 0) || (res >= *lengthPtr))
+    {
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a channel that is an axis of one of the orientation filter inputs
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddFusionInput
+(
+    iioFusionContext_t* fusionCtxtPtr,                  ///< [INOUT] Orientation sensor candidate
+    const iioChannel_Id_t* channelIdPtr,                ///< [IN] Parsed channel id
+    const struct iio_channel* chan                      ///< [IN] IIO Channel
+)
+{
+    fusionInput_t input;
+    int axis;
+
+    // Only the first vector of each type is used.
+    if ((channelIdPtr->isOutput) || (channelIdPtr->index > 0))
+    {
+        return;
+    }
+
+    switch (channelIdPtr->type)
+    {
+        case IIOCHANNEL_TYPE_ACCEL:   input = FUSION_ACCEL;   break;
+        case IIOCHANNEL_TYPE_ANGLVEL: input = FUSION_ANGLVEL; break;
+        case IIOCHANNEL_TYPE_MAGN:    input = FUSION_MAGN;    break;
+        default:
+            return;
+    }
+
+    switch (channelIdPtr->modifier)
+    {
+        case IIOCHANNEL_MOD_X: axis = 0; break;
+        case IIOCHANNEL_MOD_Y: axis = 1; break;
+        case IIOCHANNEL_MOD_Z: axis = 2; break;
+        default:
+            return;
+    }
+
+    fusionCtxtPtr->chan[input][axis] = chan;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if all axes of an orientation filter input were found, as scan elements if the device is
+ * captured
+ *
+ * @return:
+ *      - true if the x, y and z channels are available
+ *      - false otherwise
+ */
+//--------------------------------------------------------------------------------------------------
+static bool HasFusionInput
+(
+    const iioFusionContext_t* fusionCtxtPtr,            ///< [IN] Orientation sensor candidate
+    fusionInput_t input,                                ///< [IN] Input
+    bool isCaptured                                     ///< [IN] Is the device captured?
+)
+{
+    int axis;
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        const struct iio_channel* chan = fusionCtxtPtr->chan[input][axis];
+
+        if ((chan == NULL) || (isCaptured && !iio_channel_is_scan_element(chan)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register an orientation sensor for a device exposing accel and anglvel vectors
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the device is not an IMU
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t RegisterFusionSensor
+(
+    const iioFusionContext_t* candidatePtr,             ///< [IN] Orientation sensor candidate
+    iioCaptureGroup_t* groupPtr                         ///< [IN] Sampling group (NULL if polled)
+)
+{
+    char resourcePath[256];
+    char jsonDoc[MAX_JSON_SIZE];
+    sensorfwCallbacks_t fusionCb;
+    bool isCaptured = (groupPtr != NULL);
+    uint32_t deviceIndex = 0;
+
+    if (!HasFusionInput(candidatePtr, FUSION_ACCEL, isCaptured) ||
+        !HasFusionInput(candidatePtr, FUSION_ANGLVEL, isCaptured))
+    {
+        return LE_NOT_FOUND;
+    }
+
+    const char* deviceName = iio_device_get_name(candidatePtr->device);
+    snprintf(resourcePath, sizeof(resourcePath), "%s/orientation", deviceName);
+
+    while (isCaptured && (strcmp(groupPtr->deviceNames[deviceIndex], deviceName) != 0))
+    {
+        deviceIndex++;
+    }
+
+    iioFusionContext_t* fusionCtxtPtr = malloc(sizeof(iioFusionContext_t));
+    LE_ASSERT(fusionCtxtPtr != NULL);
+    *fusionCtxtPtr = *candidatePtr;
+
+    fusionCtxtPtr->hasMagn = HasFusionInput(candidatePtr, FUSION_MAGN, isCaptured);
+    fusionCtxtPtr->isStarted = false;
+    fusionCtxtPtr->mutex = le_mutex_CreateNonRecursive(resourcePath);
+    imuFusion_Init(&fusionCtxtPtr->filter, FUSION_DEFAULT_BETA);
+    LoadFusionScales(fusionCtxtPtr);
+
+    // The filter is updated at its own rate, the orientation is published at the sensor period.
+    // The filter of a captured device is updated with the scans of its group, once started.
+    if (isCaptured)
+    {
+        fusionCtxtPtr->groupPtr = groupPtr;
+        fusionCtxtPtr->rate = FUSION_DEFAULT_RATE_HZ;
+    }
+    else
+    {
+        fusionCtxtPtr->timer = le_timer_Create(resourcePath);
+        SetFusionRate(fusionCtxtPtr, FUSION_DEFAULT_RATE_HZ);
+        le_timer_SetRepeat(fusionCtxtPtr->timer, 0);
+        le_timer_SetContextPtr(fusionCtxtPtr->timer, fusionCtxtPtr);
+        le_timer_SetHandler(fusionCtxtPtr->timer, UpdateFusion);
+
+        // Prime the filter so that the first sample is available at registration.
+        UpdateFusion(fusionCtxtPtr->timer);
+        le_timer_Start(fusionCtxtPtr->timer);
+    }
+
+    LE_INFO("Register the sensor %s (%s magn)",
+            resourcePath, fusionCtxtPtr->hasMagn ? "with" : "without");
+
+    memset(&fusionCb, 0, sizeof(fusionCb));
+    fusionCb.configCb = ConfigOrientation;
+    fusionCb.sample.jsonCb = SampleOrientation;
+
+    if ((CreateJsonDocument(jsonDoc,
+                            sizeof(jsonDoc),
+                            resourcePath,
+                            resourcePath,
+                            false,
+                            "",
+                            FUSION_PUBLISH_PERIOD_SEC) != LE_OK) ||
+        (sensorFw_RegisterCallback(jsonDoc, SF_CB_JSON, &fusionCb, fusionCtxtPtr, NULL) != LE_OK))
+    {
+        LE_ERROR("Error registering orientation sensor %s", resourcePath);
+
+        if (fusionCtxtPtr->timer != NULL)
+        {
+            le_timer_Delete(fusionCtxtPtr->timer);
+        }
+
+        le_mutex_Delete(fusionCtxtPtr->mutex);
+        free(fusionCtxtPtr);
+        return LE_FAULT;
+    }
+
+    if (isCaptured)
+    {
+        groupPtr->fusions[deviceIndex] = fusionCtxtPtr;
+        groupPtr->fusionCount++;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the sampling group capturing a device
+ *
+ * @return:
+ *      - Sampling group, NULL if the device is polled
+ */
+//--------------------------------------------------------------------------------------------------
+static iioCaptureGroup_t* FindCaptureGroup
+(
+    const char* deviceName                              ///< [IN] Name of the device
+)
+{
+    int i;
+    uint32_t j;
+
+    for (i = 0; (i < CaptureGroupCount) && (deviceName != NULL); i++)
+    {
+        for (j = 0; j < CaptureGroups[i].deviceCount; j++)
+        {
+            if (strcmp(CaptureGroups[i].deviceNames[j], deviceName) == 0)
+            {
+                return &CaptureGroups[i];
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the sampling groups from the configuration tree and create their triggers. Runs before the
+ * local context is created, so that it lists the triggers.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadCaptureGroups
+(
+    void
+)
+{
+    char type[16];
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(CAPTURE_CONFIG_NODE);
+
+    if (le_cfg_GoToFirstChild(iteratorRef) != LE_OK)
+    {
+        le_cfg_CancelTxn(iteratorRef);
+        return;
+    }
+
+    do
+    {
+        if (CaptureGroupCount >= CAPTURE_MAX_GROUPS)
+        {
+            LE_ERROR("Too many sampling groups, at most %d", CAPTURE_MAX_GROUPS);
+            break;
+        }
+
+        iioCaptureGroup_t* groupPtr = &CaptureGroups[CaptureGroupCount];
+
+        memset(groupPtr, 0, sizeof(iioCaptureGroup_t));
+        le_cfg_GetNodeName(iteratorRef, "", groupPtr->name, sizeof(groupPtr->name));
+        le_cfg_GetString(iteratorRef, "type", type, sizeof(type), "hrtimer");
+        groupPtr->frequency = le_cfg_GetFloat(iteratorRef, "frequency", 0);
+        groupPtr->samples = le_cfg_GetInt(iteratorRef, "samples", CAPTURE_DEFAULT_SAMPLES);
+
+        if (groupPtr->samples == 0)
+        {
+            groupPtr->samples = CAPTURE_DEFAULT_SAMPLES;
+        }
+
+        le_cfg_GoToNode(iteratorRef, "devices");
+
+        if (le_cfg_GoToFirstChild(iteratorRef) == LE_OK)
+        {
+            do
+            {
+                char* namePtr = groupPtr->deviceNames[groupPtr->deviceCount];
+
+                if (groupPtr->deviceCount >= CAPTURE_MAX_DEVICES)
+                {
+                    LE_ERROR("Too many devices in %s, at most %d", groupPtr->name,
+                             CAPTURE_MAX_DEVICES);
+                    break;
+                }
+
+                if ((le_cfg_GetString(iteratorRef, "", namePtr, sizeof(groupPtr->deviceNames[0]),
+                                      "") == LE_OK) && (namePtr[0] != '\0'))
+                {
+                    groupPtr->deviceCount++;
+                }
+            }
+            while (le_cfg_GoToNextSibling(iteratorRef) == LE_OK);
+
+            le_cfg_GoToParent(iteratorRef);
+        }
+
+        le_cfg_GoToParent(iteratorRef);
+
+        if (groupPtr->deviceCount == 0)
+        {
+            LE_ERROR("Skip sampling group %s without device", groupPtr->name);
+            continue;
+        }
+
+        // The devices of a group without trigger are polled.
+        if (iioTrigger_Create(&groupPtr->trigger,
+                              (strcmp(type, "sysfs") == 0) ? IIOTRIGGER_SYSFS : IIOTRIGGER_HRTIMER,
+                              groupPtr->name,
+                              CaptureGroupCount) != LE_OK)
+        {
+            LE_ERROR("Skip sampling group %s without trigger", groupPtr->name);
+            continue;
+        }
+
+        CaptureGroupCount++;
+    }
+    while (le_cfg_GoToNextSibling(iteratorRef) == LE_OK);
+
+    le_cfg_CancelTxn(iteratorRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Assign their trigger to the devices of the sampling groups, enable their captured channels and
+ * start capturing
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartCaptureGroups
+(
+    struct iio_context* ctx                             ///< [IN] Local context
+)
+{
+    char threadName[64];
+    int i;
+    uint32_t j;
+    uint32_t k;
+
+    for (i = 0; i < CaptureGroupCount; i++)
     {
-        LE_ERROR("Failed to set timeout");
-        return;
+        iioCaptureGroup_t* groupPtr = &CaptureGroups[i];
+
+        if ((groupPtr->channelCount == 0) && (groupPtr->fusionCount == 0))
+        {
+            continue;
+        }
+
+        for (j = 0; j < groupPtr->deviceCount; j++)
+        {
+            struct iio_device* device = iio_context_find_device(ctx, groupPtr->deviceNames[j]);
+
+            if ((device == NULL) || (iioTrigger_Assign(&groupPtr->trigger, ctx, device) != LE_OK))
+            {
+                continue;
+            }
+
+            groupPtr->devices[j] = device;
+
+            for (k = 0; k < groupPtr->channelCount; k++)
+            {
+                if (groupPtr->channels[k]->device == device)
+                {
+                    iio_channel_enable((struct iio_channel*)groupPtr->channels[k]->chan);
+                }
+            }
+
+            // Inputs of the orientation filter, whether their channels are sensors or not.
+            iioFusionContext_t* fusionCtxtPtr = groupPtr->fusions[j];
+
+            if (fusionCtxtPtr != NULL)
+            {
+                fusionInput_t input;
+                int axis;
+
+                for (input = 0; input < FUSION_INPUT_COUNT; input++)
+                {
+                    for (axis = 0; axis < 3; axis++)
+                    {
+                        struct iio_channel* chan =
+                            (struct iio_channel*)fusionCtxtPtr->chan[input][axis];
+
+                        if ((input != FUSION_MAGN) || fusionCtxtPtr->hasMagn)
+                        {
+                            iio_channel_enable(chan);
+                        }
+                    }
+                }
+            }
+
+            // Timestamps taken by the kernel when the trigger fires.
+            struct iio_channel* timestampChan = iio_device_find_channel(device, "timestamp", false);
+
+            if ((timestampChan != NULL) && iio_channel_is_scan_element(timestampChan))
+            {
+                iio_channel_enable(timestampChan);
+                groupPtr->timestamps[j] = timestampChan;
+            }
+        }
+
+        if (groupPtr->trigger.device == NULL)
+        {
+            LE_ERROR("Sampling group %s not captured", groupPtr->name);
+            continue;
+        }
+
+        UpdateCaptureFrequency(groupPtr);
+
+        snprintf(threadName, sizeof(threadName), "capture/%.*s",
+                 (int)sizeof(groupPtr->name), groupPtr->name);
+        groupPtr->thread = le_thread_Create(threadName, CaptureThreadMain, groupPtr);
+        le_thread_Start(groupPtr->thread);
+
+        LE_INFO("Capture %" PRIu32 " channels of %s on %s", groupPtr->channelCount,
+                groupPtr->name, groupPtr->trigger.name);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register a numeric sensor for an input channel
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NO_MEMORY if no more sensor context is available
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t RegisterChannel
+(
+    struct iio_device* device,                          ///< [IN] Device of the channel
+    const struct iio_channel* chan,                     ///< [IN] Channel
+    const iioChannel_Id_t* channelIdPtr,                ///< [IN] Parsed channel id
+    const char* resourcePath,                           ///< [IN] Path of the sensor
+    iioRemote_t* remotePtr,                             ///< [IN] Remote context (NULL if local)
+    iioCaptureGroup_t* groupPtr,                        ///< [IN] Sampling group (NULL if polled)
+    sensorfwCallbacks_t* pluginCbPtr                    ///< [IN] Callbacks
+)
+{
+    char jsonDoc[MAX_JSON_SIZE];
+    sensorfwCallbacks_t capturedCb;
+
+    if ((remotePtr != NULL) && (remotePtr->channelCount >= REMOTE_MAX_CHANNELS))
+    {
+        LE_ERROR("Too many channels on remote context %s", remotePtr->name);
+        return LE_NO_MEMORY;
+    }
+
+    // Set context that will be passed to periodic sample function.
+    iioSensorContext_t* sensorCtxtPtr = le_mem_TryAlloc(SensorContextPool);
+
+    if (sensorCtxtPtr == NULL)
+    {
+        LE_ERROR("No more sensor context for %s", resourcePath);
+        return LE_NO_MEMORY;
+    }
+
+    memset(sensorCtxtPtr, 0, sizeof(iioSensorContext_t));
+    sensorCtxtPtr->device = device;
+    sensorCtxtPtr->chan = chan;
+    sensorCtxtPtr->id = *channelIdPtr;
+    sensorCtxtPtr->remotePtr = remotePtr;
+
+    // Captured channels are timed by the trigger of their group, which follows their period.
+    if (groupPtr != NULL)
+    {
+        capturedCb = *pluginCbPtr;
+        capturedCb.periodCb = SetCapturePeriod;
+        pluginCbPtr = &capturedCb;
+
+        sensorCtxtPtr->groupPtr = groupPtr;
+        sensorCtxtPtr->scale = 1;
+        GetAttribute(chan, "scale", &sensorCtxtPtr->scale);
+        GetAttribute(chan, "offset", &sensorCtxtPtr->offset);
+        groupPtr->channels[groupPtr->channelCount++] = sensorCtxtPtr;
+    }
+
+    LE_INFO("Register the sensor %s", resourcePath);
+
+    // Format information relating to sensor in JSON format
+    if ((CreateJsonDocument(jsonDoc,
+                            sizeof(jsonDoc),
+                            resourcePath,
+                            resourcePath,
+                            false,
+                            channelIdPtr->metaPtr->unit,
+                            channelIdPtr->metaPtr->defaultPeriod) != LE_OK) ||
+        (sensorFw_RegisterCallback(jsonDoc,
+                                   SF_CB_NUMERIC,
+                                   pluginCbPtr,
+                                   sensorCtxtPtr,
+                                   &sensorCtxtPtr->handlerPtr) != LE_OK))
+    {
+        LE_ERROR("Error registering callback of %s", resourcePath);
+
+        if (groupPtr != NULL)
+        {
+            groupPtr->channelCount--;
+        }
+
+        le_mem_Release(sensorCtxtPtr);
+        return LE_FAULT;
+    }
+
+    if (remotePtr != NULL)
+    {
+        remotePtr->channelCount++;
     }
 
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register the sensors of the devices of a context
+ *
+ * @return:
+ *      - Number of sensors registered
+ */
+//--------------------------------------------------------------------------------------------------
+static int RegisterContextSensors
+(
+    struct iio_context* ctx,                            ///< [IN] Context
+    iioRemote_t* remotePtr                              ///< [IN] Remote context (NULL if local)
+)
+{
+    unsigned int i;
+    char resourcePath[256];
+    struct iio_device *device;
+    char* channelName;
+    unsigned int j;
+    const struct iio_channel *chan;
+    const char* deviceName;
+    double inputValue;
+    int registeredCount = 0;
+
     // Initialize the callbacks
     sensorfwCallbacks_t pluginCb;
 
+    memset(&pluginCb, 0, sizeof(pluginCb));
     pluginCb.configCb = ConfigIioSensor;
     pluginCb.sample.numericCb = SampleIioSensor;
 
-    for (i = 0, device = iio_context_get_device(localCtx, i);
+    for (i = 0, device = iio_context_get_device(ctx, i);
          device != NULL;
-         ++i, device = iio_context_get_device(localCtx, i))
+         ++i, device = iio_context_get_device(ctx, i))
     {
 
         deviceName = iio_device_get_name(device);
 
-        // ToDo: Document unit of measurement.
+        iioFusionContext_t fusionCandidate;
+        memset(&fusionCandidate, 0, sizeof(fusionCandidate));
+        fusionCandidate.device = device;
+
+        // Triggers are only managed for local devices.
+        iioCaptureGroup_t* groupPtr = (remotePtr == NULL) ? FindCaptureGroup(deviceName) : NULL;
+
         for (j = 0, chan = iio_device_get_channel(device, j);
              chan != NULL;
              ++j, chan = iio_device_get_channel(device, j))
         {
             channelName = (char*)iio_channel_get_id(chan);
-            snprintf(resourcePath, sizeof(resourcePath), "%s/%s", deviceName, channelName);
 
-            // Create a resource to read sensor sample
-            if (iio_channel_is_output(chan))
+            // Sensors of a remote context are named after the context.
+            if (remotePtr != NULL)
             {
-                strncat(resourcePath, "/value", sizeof(resourcePath) - strlen(resourcePath) - 1);
-                LE_ERROR("Registering output - TO BE IMPLEMENTED");
+                snprintf(resourcePath, sizeof(resourcePath), "%s/%s/%s",
+                         remotePtr->name, deviceName, channelName);
             }
             else
             {
-                attrErrorType_t attrErr = GetAttribute(chan, "input", &inputValue);
+                snprintf(resourcePath, sizeof(resourcePath), "%s/%s", deviceName, channelName);
+            }
 
-                // Set context that will be passed to periodic sample function.
-                iioSensorContext_t* sensorCtxtPtr = malloc(sizeof(iioSensorContext_t));
-                memset(sensorCtxtPtr, 0, sizeof(iioSensorContext_t));
+            iioChannel_Id_t channelId;
 
-                sensorCtxtPtr->device = device;
-                sensorCtxtPtr->chan = chan;
+            if (iioChannel_Parse(channelName, iio_channel_is_output(chan), &channelId)
+                == LE_FORMAT_ERROR)
+            {
+                LE_WARN("Skip channel '%s' with unexpected id", resourcePath);
+                continue;
+            }
 
-                // create numeric input named "value" and push sample data.
-                if(attrErr == ATTRIBUTE_FOUND)
-                {
-                    // Register the sensor
-                    LE_INFO("Register the sensor %s", resourcePath);
-
-                    // Format information relating to sensor in JSON format
-                    res = CreateJsonDocument((char*)&jsonDoc,
-                                             sizeof(jsonDoc),
-                                             (const char*)&resourcePath,
-                                             (const char*)&resourcePath,
-                                             false,
-                                             GetIiounit(channelName));
-
-                    if (res != LE_OK)
-                    {
-                        LE_ERROR("Error registering callback");
-                        return;
-                    }
+            AddFusionInput(&fusionCandidate, &channelId, chan);
 
-                    attrErr = sensorFw_RegisterCallback((char*)&jsonDoc,
-                                                       SF_CB_NUMERIC,
-                                                       &pluginCb,
-                                                       (void*)sensorCtxtPtr,
-                                                       NULL);
-               }
-                else if (attrErr == ATTRIBUTE_NOT_FOUND)
-                {
-                    double raw;
+            // Channels such as the timestamp are only meaningful in buffered captures.
+            if (channelId.metaPtr->defaultPeriod == 0)
+            {
+                LE_DEBUG("Skip channel '%s' of type '%s'", resourcePath, channelId.metaPtr->name);
+                continue;
+            }
 
-                    // Check if raw value is available.
-                    attrErr = GetAttribute(chan, "raw", &raw);
+            // Create a resource to read sensor sample
+            if (iio_channel_is_output(chan))
+            {
+                strncat(resourcePath, "/value", sizeof(resourcePath) - strlen(resourcePath) - 1);
+                LE_ERROR("Registering output - TO BE IMPLEMENTED");
+                continue;
+            }
 
-                    if (attrErr == ATTRIBUTE_FOUND)
-                    {
-                        LE_INFO("Register the sensor %s", resourcePath);
+            attrErrorType_t attrErr = GetAttribute(chan, "input", &inputValue);
 
-                        // Format information relating to sensor in JSON format
-                        res = CreateJsonDocument((char*)&jsonDoc,
-                                                 sizeof(jsonDoc),
-                                                 (const char*)&resourcePath,
-                                                 (const char*)&resourcePath,
-                                                 false,
-                                                 GetIiounit(channelName));
+            // Check if raw value is available.
+            if (attrErr == ATTRIBUTE_NOT_FOUND)
+            {
+                attrErr = GetAttribute(chan, "raw", &inputValue);
 
-                        if (res != LE_OK)
-                        {
-                            LE_ERROR("Error registering callback");
-                            return;
-                        }
+                if (attrErr != ATTRIBUTE_FOUND)
+                {
+                    LE_ERROR("Error reading raw value of sensor");
+                    continue;
+                }
+            }
+            else if (attrErr != ATTRIBUTE_FOUND)
+            {
+                LE_ERROR("Error reading input value of sensor");
+                continue;
+            }
 
-                        attrErr = sensorFw_RegisterCallback((char*)&jsonDoc,
-                                                           SF_CB_NUMERIC,
-                                                           &pluginCb,
-                                                           (void*)sensorCtxtPtr,
-                                                           NULL);
-                    }
-                    else
-                    {
-                        LE_ERROR("Error reading raw value of sensor");
-                    }
+            // Only the scan elements of a device can be captured, its other channels are polled.
+            iioCaptureGroup_t* chanGroupPtr = NULL;
+
+            if ((groupPtr != NULL) && iio_channel_is_scan_element(chan))
+            {
+                if (groupPtr->channelCount < CAPTURE_MAX_CHANNELS)
+                {
+                    chanGroupPtr = groupPtr;
                 }
                 else
                 {
-                    LE_ERROR("Error reading input value of sensor");
+                    LE_WARN("Too many channels in %s, %s is polled", groupPtr->name, resourcePath);
                 }
             }
+
+            // create numeric input named "value" and push sample data.
+            if (RegisterChannel(device,
+                                chan,
+                                &channelId,
+                                resourcePath,
+                                remotePtr,
+                                chanGroupPtr,
+                                &pluginCb) == LE_OK)
+            {
+                registeredCount++;
+            }
+        }
+
+        // Derive an orientation sensor from the IMU channels of the device. The filter reads its
+        // inputs on the event loop or gets the scans of the sampling group, so it is only run on
+        // local devices.
+        if ((remotePtr == NULL) &&
+            (RegisterFusionSensor(&fusionCandidate, groupPtr) == LE_OK))
+        {
+            registeredCount++;
+        }
+    }
+
+    return registeredCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Connect to a remote iiod and register its sensors
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddRemote
+(
+    const char* name,                                   ///< [IN] Name of the remote context
+    const char* uri,                                    ///< [IN] URI of iiod, e.g. "ip:10.0.0.2"
+    int timeoutMs                                       ///< [IN] Timeout of the operations
+)
+{
+    char threadName[64];
+    iioRemote_t* remotePtr = &Remotes[RemoteCount];
+
+    memset(remotePtr, 0, sizeof(iioRemote_t));
+    le_utf8_Copy(remotePtr->name, name, sizeof(remotePtr->name), NULL);
+
+    remotePtr->ctx = iio_create_context_from_uri(uri);
+
+    if (remotePtr->ctx == NULL)
+    {
+        LE_ERROR("Failed to create iio context %s from '%s'", name, uri);
+        return;
+    }
+
+    if (iio_context_set_timeout(remotePtr->ctx, timeoutMs) != 0)
+    {
+        LE_ERROR("Failed to set timeout of %s", name);
+        iio_context_destroy(remotePtr->ctx);
+        return;
+    }
+
+    // The thread is running before the channels are registered, so that the first samples can be
+    // queued to it.
+    snprintf(threadName, sizeof(threadName), "iio/%s", name);
+    remotePtr->mutex = le_mutex_CreateNonRecursive(threadName);
+    remotePtr->thread = le_thread_Create(threadName, RemoteThreadMain, remotePtr);
+    le_thread_SetJoinable(remotePtr->thread);
+    le_thread_Start(remotePtr->thread);
+
+    if (RegisterContextSensors(remotePtr->ctx, remotePtr) == 0)
+    {
+        // Nothing was queued to the thread without a sensor: it is stopped before the slot of the
+        // context is reused.
+        LE_INFO("No iio sensor registered on %s", name);
+        le_thread_Cancel(remotePtr->thread);
+        le_thread_Join(remotePtr->thread, NULL);
+        le_mutex_Delete(remotePtr->mutex);
+        iio_context_destroy(remotePtr->ctx);
+        remotePtr->thread = NULL;
+        remotePtr->mutex = NULL;
+        remotePtr->ctx = NULL;
+        return;
+    }
+
+    LE_INFO("Remote iio context %s at '%s': %" PRIu32 " channels",
+            name, uri, remotePtr->channelCount);
+
+    RemoteCount++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register the sensors of the remote iiod contexts listed in the configuration tree
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadRemotes
+(
+    void
+)
+{
+    char name[32];
+    char uri[256];
+    int timeoutMs;
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(REMOTES_CONFIG_NODE);
+
+    if (le_cfg_GoToFirstChild(iteratorRef) != LE_OK)
+    {
+        le_cfg_CancelTxn(iteratorRef);
+        return;
+    }
+
+    do
+    {
+        if (RemoteCount >= REMOTE_MAX_COUNT)
+        {
+            LE_ERROR("Too many remote iio contexts, at most %d", REMOTE_MAX_COUNT);
+            break;
         }
+
+        if ((le_cfg_GetNodeName(iteratorRef, "", name, sizeof(name)) != LE_OK) ||
+            (le_cfg_GetString(iteratorRef, "uri", uri, sizeof(uri), "") != LE_OK) ||
+            (uri[0] == '\0'))
+        {
+            LE_ERROR("Skip remote iio context without uri");
+            continue;
+        }
+
+        timeoutMs = le_cfg_GetInt(iteratorRef, "timeout", REMOTE_DEFAULT_TIMEOUT_MS);
+
+        AddRemote(name, uri, timeoutMs);
+    }
+    while (le_cfg_GoToNextSibling(iteratorRef) == LE_OK);
+
+    le_cfg_CancelTxn(iteratorRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Init IIO plugin
+ */
+//--------------------------------------------------------------------------------------------------
+static void IioPluginInit
+(
+    void
+)
+{
+    // The triggers must exist when the local context lists the devices.
+    LoadCaptureGroups();
+
+    struct iio_context *localCtx = iio_create_local_context();
+
+    if (localCtx == NULL)
+    {
+        LE_ERROR("Failed to create iio local context");
+    }
+    else if (iio_context_set_timeout(localCtx, LOCAL_TIMEOUT_MS) != 0)
+    {
+        LE_ERROR("Failed to set timeout");
+        iio_context_destroy(localCtx);
+    }
+    // Registered sensors keep pointers into the context for the lifetime of the process.
+    else if (RegisterContextSensors(localCtx, NULL) == 0)
+    {
+        LE_INFO("No iio sensor registered");
+        iio_context_destroy(localCtx);
+    }
+    else
+    {
+        StartCaptureGroups(localCtx);
     }
+
+    LoadRemotes();
 }
 
 
@@ -686,5 +2412,9 @@ COMPONENT_INIT
 {
     LE_INFO("Start iio plugin");
 
+    SensorContextPool = le_mem_InitStaticPool(SensorContextPool,
+                                              SENSOR_CONTEXT_POOL_SIZE,
+                                              sizeof(iioSensorContext_t));
+
     IioPluginInit();
 }
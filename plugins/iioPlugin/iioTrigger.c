@@ -0,0 +1,285 @@
+//--------------------------------------------------------------------------------------------------
+/** @file iioTrigger.c
+ *
+ * Creation and control of the IIO triggers timing buffered captures. Refer to the kernel
+ * documentation of the IIO configfs support (Documentation/iio/iio_configfs.txt) and of the sysfs
+ * trigger (Documentation/ABI/testing/sysfs-bus-iio-trigger-sysfs).
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <sys/stat.h>
+#include "iioTrigger.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory of the hrtimer triggers in configfs
+ */
+//--------------------------------------------------------------------------------------------------
+#define     HRTIMER_CONFIGFS_DIR            "/sys/kernel/config/iio/triggers/hrtimer"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * File adding a sysfs trigger
+ */
+//--------------------------------------------------------------------------------------------------
+#define     SYSFS_ADD_TRIGGER_PATH          "/sys/bus/iio/devices/iio_sysfs_trigger/add_trigger"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * First id of the sysfs triggers created by the plugin, above the ones usually created by hand
+ */
+//--------------------------------------------------------------------------------------------------
+#define     SYSFS_TRIGGER_BASE_ID           100
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create an hrtimer trigger
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNSUPPORTED if configfs or the hrtimer trigger is not available
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CreateHrtimer
+(
+    iioTrigger_t* triggerPtr,           ///< [INOUT] Trigger
+    const char* groupName               ///< [IN]    Name of the sampling group
+)
+{
+    char path[sizeof(HRTIMER_CONFIGFS_DIR) + IIOTRIGGER_MAX_NAME_LEN + 1];
+
+    snprintf(triggerPtr->name, sizeof(triggerPtr->name), "sensorfw-%s", groupName);
+    snprintf(path, sizeof(path), "%s/%s", HRTIMER_CONFIGFS_DIR, triggerPtr->name);
+
+    // Left by a previous run.
+    if ((mkdir(path, 0755) != 0) && (errno != EEXIST))
+    {
+        if (errno == ENOENT)
+        {
+            LE_ERROR("%s not available, is iio-trig-hrtimer loaded and configfs mounted?",
+                     HRTIMER_CONFIGFS_DIR);
+            return LE_UNSUPPORTED;
+        }
+
+        LE_ERROR("Failed to create %s: %m", path);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a sysfs trigger
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNSUPPORTED if the sysfs trigger is not available
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CreateSysfs
+(
+    iioTrigger_t* triggerPtr,           ///< [INOUT] Trigger
+    uint32_t index                      ///< [IN]    Index of the sampling group
+)
+{
+    uint32_t id = SYSFS_TRIGGER_BASE_ID + index;
+    FILE* filePtr = fopen(SYSFS_ADD_TRIGGER_PATH, "w");
+
+    snprintf(triggerPtr->name, sizeof(triggerPtr->name), "sysfstrig%" PRIu32, id);
+
+    if (filePtr == NULL)
+    {
+        LE_ERROR("%s not available, is iio-trig-sysfs loaded?", SYSFS_ADD_TRIGGER_PATH);
+        return LE_UNSUPPORTED;
+    }
+
+    // The write fails if the trigger was left by a previous run, which is fine.
+    fprintf(filePtr, "%" PRIu32, id);
+    fclose(filePtr);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fire a sysfs trigger
+ */
+//--------------------------------------------------------------------------------------------------
+static void FireSysfs
+(
+    le_timer_Ref_t timerRef             ///< [IN] Timer of the trigger
+)
+{
+    iioTrigger_t* triggerPtr = le_timer_GetContextPtr(timerRef);
+
+    if (iio_device_attr_write(triggerPtr->device, "trigger_now", "1") < 0)
+    {
+        LE_WARN("Failed to fire %s", triggerPtr->name);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a trigger in the kernel. It is kept when sensord exits and reused when it starts again.
+ * Triggers must be created before the iio context, which lists the devices when it is created.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNSUPPORTED if the kernel has no support for this kind of trigger
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t iioTrigger_Create
+(
+    iioTrigger_t* triggerPtr,           ///< [OUT] Trigger
+    iioTrigger_Type_t type,             ///< [IN]  Kind of trigger
+    const char* groupName,              ///< [IN]  Name of the sampling group the trigger times
+    uint32_t index                      ///< [IN]  Index of the sampling group
+)
+{
+    memset(triggerPtr, 0, sizeof(iioTrigger_t));
+    triggerPtr->type = type;
+
+    if (type == IIOTRIGGER_SYSFS)
+    {
+        return CreateSysfs(triggerPtr, index);
+    }
+
+    return CreateHrtimer(triggerPtr, groupName);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the device of the trigger in a context and assign the trigger to a device
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the trigger is not in the context
+ *      - LE_FAULT if the device does not accept the trigger
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t iioTrigger_Assign
+(
+    iioTrigger_t* triggerPtr,           ///< [INOUT] Trigger
+    struct iio_context* ctx,            ///< [IN]    Context of the device
+    struct iio_device* device           ///< [IN]    Device sampled on the trigger
+)
+{
+    if (triggerPtr->device == NULL)
+    {
+        triggerPtr->device = iio_context_find_device(ctx, triggerPtr->name);
+
+        if ((triggerPtr->device == NULL) || !iio_device_is_trigger(triggerPtr->device))
+        {
+            LE_ERROR("Trigger %s not found", triggerPtr->name);
+            triggerPtr->device = NULL;
+            return LE_NOT_FOUND;
+        }
+    }
+
+    if (iio_device_set_trigger(device, triggerPtr->device) != 0)
+    {
+        LE_ERROR("Failed to assign %s to %s", triggerPtr->name, iio_device_get_name(device));
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the frequency of the trigger. Runs on the main thread.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if the frequency could not be set
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t iioTrigger_SetFrequency
+(
+    iioTrigger_t* triggerPtr,           ///< [INOUT] Trigger
+    double frequency                    ///< [IN]    Frequency in Hz, 0 to stop a sysfs trigger
+)
+{
+    char value[32];
+
+    if (triggerPtr->device == NULL)
+    {
+        return LE_FAULT;
+    }
+
+    if (frequency == triggerPtr->frequency)
+    {
+        return LE_OK;
+    }
+
+    if (triggerPtr->type == IIOTRIGGER_HRTIMER)
+    {
+        // The kernel timer cannot be stopped, it runs at its last frequency.
+        if (frequency <= 0)
+        {
+            return LE_OK;
+        }
+
+        // Older kernels only accept an integer frequency.
+        snprintf(value, sizeof(value), "%lu",
+                 (frequency < 1) ? 1UL : (unsigned long)(frequency + 0.5));
+
+        if (iio_device_attr_write(triggerPtr->device, "sampling_frequency", value) < 0)
+        {
+            LE_ERROR("Failed to set the frequency of %s to %s Hz", triggerPtr->name, value);
+            return LE_FAULT;
+        }
+    }
+    else
+    {
+        if (triggerPtr->timer == NULL)
+        {
+            triggerPtr->timer = le_timer_Create(triggerPtr->name);
+            le_timer_SetRepeat(triggerPtr->timer, 0);
+            le_timer_SetContextPtr(triggerPtr->timer, triggerPtr);
+            le_timer_SetHandler(triggerPtr->timer, FireSysfs);
+        }
+
+        le_timer_Stop(triggerPtr->timer);
+
+        if (frequency > 0)
+        {
+            uint32_t intervalMs = (uint32_t)(1000 / frequency);
+
+            le_timer_SetMsInterval(triggerPtr->timer, (intervalMs > 0) ? intervalMs : 1);
+            le_timer_Start(triggerPtr->timer);
+        }
+    }
+
+    LE_INFO("Trigger %s at %lf Hz", triggerPtr->name, frequency);
+    __atomic_store(&triggerPtr->frequency, &frequency, __ATOMIC_RELAXED);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the frequency of the trigger. Can be called from any thread, e.g. the capture thread.
+ *
+ * @return:
+ *      - Frequency in Hz, 0 if stopped
+ */
+//--------------------------------------------------------------------------------------------------
+double iioTrigger_GetFrequency
+(
+    const iioTrigger_t* triggerPtr      ///< [IN] Trigger
+)
+{
+    double frequency;
+
+    __atomic_load(&triggerPtr->frequency, &frequency, __ATOMIC_RELAXED);
+
+    return frequency;
+}
@@ -0,0 +1,115 @@
+//--------------------------------------------------------------------------------------------------
+/** @file iioTrigger.h
+ *
+ * IIO triggers created by the plugin to time buffered captures: hrtimer triggers, created through
+ * configfs and fired by the kernel, or sysfs triggers, fired by a timer of the plugin on kernels
+ * without hrtimer triggers.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_IIO_TRIGGER_INCLUDE_GUARD
+#define LEGATO_IIO_TRIGGER_INCLUDE_GUARD
+
+#include "iio.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of the name of a trigger
+ */
+//--------------------------------------------------------------------------------------------------
+#define IIOTRIGGER_MAX_NAME_LEN         64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Kind of trigger
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    IIOTRIGGER_HRTIMER,                 ///< High resolution timer trigger (configfs)
+    IIOTRIGGER_SYSFS                    ///< Software fired trigger (iio_sysfs_trigger)
+}
+iioTrigger_Type_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trigger
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    iioTrigger_Type_t type;             ///< Kind of trigger
+    char name[IIOTRIGGER_MAX_NAME_LEN]; ///< Name of the trigger device
+    struct iio_device* device;          ///< Trigger device, once the context is created
+    le_timer_Ref_t timer;               ///< Timer firing a sysfs trigger
+    double frequency;                   ///< Frequency in Hz (0 = stopped), atomic
+}
+iioTrigger_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a trigger in the kernel. It is kept when sensord exits and reused when it starts again.
+ * Triggers must be created before the iio context, which lists the devices when it is created.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNSUPPORTED if the kernel has no support for this kind of trigger
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t iioTrigger_Create
+(
+    iioTrigger_t* triggerPtr,           ///< [OUT] Trigger
+    iioTrigger_Type_t type,             ///< [IN]  Kind of trigger
+    const char* groupName,              ///< [IN]  Name of the sampling group the trigger times
+    uint32_t index                      ///< [IN]  Index of the sampling group
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the device of the trigger in a context and assign the trigger to a device
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the trigger is not in the context
+ *      - LE_FAULT if the device does not accept the trigger
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t iioTrigger_Assign
+(
+    iioTrigger_t* triggerPtr,           ///< [INOUT] Trigger
+    struct iio_context* ctx,            ///< [IN]    Context of the device
+    struct iio_device* device           ///< [IN]    Device sampled on the trigger
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the frequency of the trigger. Runs on the main thread.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if the frequency could not be set
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t iioTrigger_SetFrequency
+(
+    iioTrigger_t* triggerPtr,           ///< [INOUT] Trigger
+    double frequency                    ///< [IN]    Frequency in Hz, 0 to stop a sysfs trigger
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the frequency of the trigger. Can be called from any thread, e.g. the capture thread.
+ *
+ * @return:
+ *      - Frequency in Hz, 0 if stopped
+ */
+//--------------------------------------------------------------------------------------------------
+double iioTrigger_GetFrequency
+(
+    const iioTrigger_t* triggerPtr      ///< [IN] Trigger
+);
+
+#endif /* LEGATO_IIO_TRIGGER_INCLUDE_GUARD */
@@ -0,0 +1,247 @@
+//--------------------------------------------------------------------------------------------------
+/** @file imuFusion.c
+ *
+ * Madgwick orientation filter. Refer to S. Madgwick, "An efficient orientation filter for inertial
+ * and inertial/magnetic sensor arrays", 2010.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <math.h>
+#include "imuFusion.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Radians to degrees
+ */
+//--------------------------------------------------------------------------------------------------
+#define     RAD_TO_DEG                      (180.0 / M_PI)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Normalize a vector in place
+ *
+ * @return:
+ *      - true on success
+ *      - false if the vector is null
+ */
+//--------------------------------------------------------------------------------------------------
+static bool Normalize
+(
+    double* vectorPtr,                  ///< [INOUT] Vector
+    int size                            ///< [IN] Number of components
+)
+{
+    double norm = 0;
+    int i;
+
+    for (i = 0; i < size; i++)
+    {
+        norm += vectorPtr[i] * vectorPtr[i];
+    }
+
+    if (norm == 0)
+    {
+        return false;
+    }
+
+    norm = 1.0 / sqrt(norm);
+
+    for (i = 0; i < size; i++)
+    {
+        vectorPtr[i] *= norm;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the gradient step using the accelerometer only
+ */
+//--------------------------------------------------------------------------------------------------
+static void GradientImu
+(
+    const double q[4],                  ///< [IN]  Orientation
+    const double a[3],                  ///< [IN]  Normalized acceleration
+    double s[4]                         ///< [OUT] Gradient
+)
+{
+    double q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    double q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+    s[0] = 4.0 * q0 * q2q2 + 2.0 * q2 * a[0] + 4.0 * q0 * q1q1 - 2.0 * q1 * a[1];
+    s[1] = 4.0 * q1 * q3q3 - 2.0 * q3 * a[0] + 4.0 * q0q0 * q1 - 2.0 * q0 * a[1] - 4.0 * q1
+           + 8.0 * q1 * q1q1 + 8.0 * q1 * q2q2 + 4.0 * q1 * a[2];
+    s[2] = 4.0 * q0q0 * q2 + 2.0 * q0 * a[0] + 4.0 * q2 * q3q3 - 2.0 * q3 * a[1] - 4.0 * q2
+           + 8.0 * q2 * q1q1 + 8.0 * q2 * q2q2 + 4.0 * q2 * a[2];
+    s[3] = 4.0 * q1q1 * q3 - 2.0 * q1 * a[0] + 4.0 * q2q2 * q3 - 2.0 * q2 * a[1];
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the gradient step using the accelerometer and the magnetometer
+ */
+//--------------------------------------------------------------------------------------------------
+static void GradientMarg
+(
+    const double q[4],                  ///< [IN]  Orientation
+    const double a[3],                  ///< [IN]  Normalized acceleration
+    const double m[3],                  ///< [IN]  Normalized magnetic field
+    double s[4]                         ///< [OUT] Gradient
+)
+{
+    double q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    double q0q0 = q0 * q0, q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+    double q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3;
+    double q2q2 = q2 * q2, q2q3 = q2 * q3, q3q3 = q3 * q3;
+
+    // Reference direction of the earth's magnetic field
+    double hx = m[0] * q0q0 - 2.0 * q0 * m[1] * q3 + 2.0 * q0 * m[2] * q2 + m[0] * q1q1
+                + 2.0 * q1 * m[1] * q2 + 2.0 * q1 * m[2] * q3 - m[0] * q2q2 - m[0] * q3q3;
+    double hy = 2.0 * q0 * m[0] * q3 + m[1] * q0q0 - 2.0 * q0 * m[2] * q1 + 2.0 * q1 * m[0] * q2
+                - m[1] * q1q1 + m[1] * q2q2 + 2.0 * q2 * m[2] * q3 - m[1] * q3q3;
+    double bx2 = sqrt(hx * hx + hy * hy);
+    double bz2 = -2.0 * q0 * m[0] * q2 + 2.0 * q0 * m[1] * q1 + m[2] * q0q0 + 2.0 * q1 * m[0] * q3
+                 - m[2] * q1q1 + 2.0 * q2 * m[1] * q3 - m[2] * q2q2 + m[2] * q3q3;
+    double bx4 = 2.0 * bx2;
+    double bz4 = 2.0 * bz2;
+
+    // Objective function terms
+    double fa0 = 2.0 * q1q3 - 2.0 * q0q2 - a[0];
+    double fa1 = 2.0 * q0q1 + 2.0 * q2q3 - a[1];
+    double fa2 = 1.0 - 2.0 * q1q1 - 2.0 * q2q2 - a[2];
+    double fm0 = bx2 * (0.5 - q2q2 - q3q3) + bz2 * (q1q3 - q0q2) - m[0];
+    double fm1 = bx2 * (q1q2 - q0q3) + bz2 * (q0q1 + q2q3) - m[1];
+    double fm2 = bx2 * (q0q2 + q1q3) + bz2 * (0.5 - q1q1 - q2q2) - m[2];
+
+    s[0] = -2.0 * q2 * fa0 + 2.0 * q1 * fa1 - bz2 * q2 * fm0
+           + (-bx2 * q3 + bz2 * q1) * fm1 + bx2 * q2 * fm2;
+    s[1] = 2.0 * q3 * fa0 + 2.0 * q0 * fa1 - 4.0 * q1 * fa2 + bz2 * q3 * fm0
+           + (bx2 * q2 + bz2 * q0) * fm1 + (bx2 * q3 - bz4 * q1) * fm2;
+    s[2] = -2.0 * q0 * fa0 + 2.0 * q3 * fa1 - 4.0 * q2 * fa2 + (-bx4 * q2 - bz2 * q0) * fm0
+           + (bx2 * q1 + bz2 * q3) * fm1 + (bx2 * q0 - bz4 * q2) * fm2;
+    s[3] = 2.0 * q1 * fa0 + 2.0 * q2 * fa1 + (-bx4 * q3 + bz2 * q1) * fm0
+           + (-bx2 * q0 + bz2 * q2) * fm1 + bx2 * q1 * fm2;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reset the filter to the identity orientation
+ */
+//--------------------------------------------------------------------------------------------------
+void imuFusion_Init
+(
+    imuFusion_State_t* statePtr,        ///< [OUT] Filter state
+    double beta                         ///< [IN]  Filter gain
+)
+{
+    statePtr->q[0] = 1.0;
+    statePtr->q[1] = 0.0;
+    statePtr->q[2] = 0.0;
+    statePtr->q[3] = 0.0;
+    statePtr->beta = beta;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update the orientation with one set of coherent readings
+ */
+//--------------------------------------------------------------------------------------------------
+void imuFusion_Update
+(
+    imuFusion_State_t* statePtr,        ///< [INOUT] Filter state
+    const double gyro[3],               ///< [IN] Angular velocity in radians per second
+    const double accel[3],              ///< [IN] Acceleration (any unit)
+    const double* magnPtr,              ///< [IN] Magnetic field (any unit), NULL if not available
+    double dt                           ///< [IN] Time since the previous update in seconds
+)
+{
+    double* q = statePtr->q;
+    double a[3] = { accel[0], accel[1], accel[2] };
+    double m[3];
+    double s[4];
+    double qDot[4];
+    int i;
+
+    // Rate of change of the quaternion from the gyroscope
+    qDot[0] = 0.5 * (-q[1] * gyro[0] - q[2] * gyro[1] - q[3] * gyro[2]);
+    qDot[1] = 0.5 * (q[0] * gyro[0] + q[2] * gyro[2] - q[3] * gyro[1]);
+    qDot[2] = 0.5 * (q[0] * gyro[1] - q[1] * gyro[2] + q[3] * gyro[0]);
+    qDot[3] = 0.5 * (q[0] * gyro[2] + q[1] * gyro[1] - q[2] * gyro[0]);
+
+    // Feedback from the accelerometer (and magnetometer) only if the readings are valid
+    if (Normalize(a, 3))
+    {
+        bool hasMagn = false;
+
+        if (magnPtr != NULL)
+        {
+            m[0] = magnPtr[0];
+            m[1] = magnPtr[1];
+            m[2] = magnPtr[2];
+            hasMagn = Normalize(m, 3);
+        }
+
+        if (hasMagn)
+        {
+            GradientMarg(q, a, m, s);
+        }
+        else
+        {
+            GradientImu(q, a, s);
+        }
+
+        if (Normalize(s, 4))
+        {
+            for (i = 0; i < 4; i++)
+            {
+                qDot[i] -= statePtr->beta * s[i];
+            }
+        }
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        q[i] += qDot[i] * dt;
+    }
+
+    if (!Normalize(q, 4))
+    {
+        imuFusion_Init(statePtr, statePtr->beta);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the orientation as Euler angles
+ */
+//--------------------------------------------------------------------------------------------------
+void imuFusion_GetEuler
+(
+    const imuFusion_State_t* statePtr,  ///< [IN]  Filter state
+    double* rollPtr,                    ///< [OUT] Roll in degrees
+    double* pitchPtr,                   ///< [OUT] Pitch in degrees
+    double* yawPtr                      ///< [OUT] Yaw in degrees
+)
+{
+    const double* q = statePtr->q;
+    double sinPitch = 2.0 * (q[0] * q[2] - q[3] * q[1]);
+
+    if (sinPitch > 1.0)
+    {
+        sinPitch = 1.0;
+    }
+    else if (sinPitch < -1.0)
+    {
+        sinPitch = -1.0;
+    }
+
+    *rollPtr = atan2(2.0 * (q[0] * q[1] + q[2] * q[3]),
+                     1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2])) * RAD_TO_DEG;
+    *pitchPtr = asin(sinPitch) * RAD_TO_DEG;
+    *yawPtr = atan2(2.0 * (q[0] * q[3] + q[1] * q[2]),
+                    1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3])) * RAD_TO_DEG;
+}
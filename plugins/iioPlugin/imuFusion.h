@@ -0,0 +1,64 @@
+//--------------------------------------------------------------------------------------------------
+/** @file imuFusion.h
+ *
+ * Orientation estimation from IMU channels (Madgwick gradient descent filter). The filter state
+ * has a fixed size and updates do not allocate memory.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_IIO_IMU_FUSION_INCLUDE_GUARD
+#define LEGATO_IIO_IMU_FUSION_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of the orientation filter
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double q[4];                        ///< Orientation quaternion (w, x, y, z)
+    double beta;                        ///< Filter gain
+}
+imuFusion_State_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reset the filter to the identity orientation
+ */
+//--------------------------------------------------------------------------------------------------
+void imuFusion_Init
+(
+    imuFusion_State_t* statePtr,        ///< [OUT] Filter state
+    double beta                         ///< [IN]  Filter gain
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update the orientation with one set of coherent readings
+ */
+//--------------------------------------------------------------------------------------------------
+void imuFusion_Update
+(
+    imuFusion_State_t* statePtr,        ///< [INOUT] Filter state
+    const double gyro[3],               ///< [IN] Angular velocity in radians per second
+    const double accel[3],              ///< [IN] Acceleration (any unit)
+    const double* magnPtr,              ///< [IN] Magnetic field (any unit), NULL if not available
+    double dt                           ///< [IN] Time since the previous update in seconds
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the orientation as Euler angles
+ */
+//--------------------------------------------------------------------------------------------------
+void imuFusion_GetEuler
+(
+    const imuFusion_State_t* statePtr,  ///< [IN]  Filter state
+    double* rollPtr,                    ///< [OUT] Roll in degrees
+    double* pitchPtr,                   ///< [OUT] Pitch in degrees
+    double* yawPtr                      ///< [OUT] Yaw in degrees
+);
+
+#endif /* LEGATO_IIO_IMU_FUSION_INCLUDE_GUARD */
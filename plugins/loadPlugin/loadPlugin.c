@@ -0,0 +1,612 @@
+//--------------------------------------------------------------------------------------------------
+/** @file loadPlugin.c
+ *
+ * Synthetic load generator used to measure how many samples per second a target can sustain
+ * through the sensor framework and the Data Hub.
+ *
+ * The plugin is disabled unless loadPlugin/enable is set in the configuration tree of the app.
+ * It then registers the configured number of sensors of each data type under "load/", whose
+ * callbacks spend a configurable time busy and return values following a pattern. In ramp mode
+ * only a part of the sensors are active at first (the others return no sample); more are
+ * activated at every step until callbacks are late or samples are missing, and the highest rate
+ * sustained is published in "load/capacity".
+ *
+ * Configuration (sensorFw:/loadPlugin/...):
+ *  - enable        (bool)   register the sensors (default false)
+ *  - numeric, boolean, string, json (int) number of sensors of each type (default 10, 0, 0, 0)
+ *  - period        (float)  sampling period in seconds (default 1)
+ *  - costUs        (int)    time spent in each callback in microseconds (default 0)
+ *  - pattern       (string) constant, ramp, sine or random (default sine)
+ *  - stringSize    (int)    bytes of string samples (default 32)
+ *  - ramp          (bool)   ramp the load to find the capacity (default false)
+ *  - rampStep      (int)    sensors activated at each step (default 10)
+ *  - stepDuration  (int)    duration of a step in seconds (default 10)
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <inttypes.h>
+#include <math.h>
+#include "interfaces.h"
+#include "sensorFw.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of synthetic sensors
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_SENSORS                 1000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of a string sample
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_STRING_SIZE             1024
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A step fails if more callbacks than this share are late, or if fewer samples than this share of
+ * the offered rate are pushed. A callback is late if it runs half a period after it was due.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_LATE_RATIO              0.01
+#define MIN_ACHIEVED_RATIO          0.95
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value pattern of the samples
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    PATTERN_CONSTANT,
+    PATTERN_RAMP,
+    PATTERN_SINE,
+    PATTERN_RANDOM
+}
+pattern_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Synthetic sensor
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t index;                     ///< Activation order of the sensor
+    uint32_t seq;                       ///< Number of samples produced
+    double lastCallTime;                ///< Time of the previous callback (0 if none)
+}
+loadSensor_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Configuration
+ */
+//--------------------------------------------------------------------------------------------------
+static struct
+{
+    uint32_t counts[4];                 ///< Sensors per type, indexed by sensorfwDataType_t
+    double period;                      ///< Sampling period in seconds
+    uint32_t costUs;                    ///< Time spent in each callback
+    pattern_t pattern;                  ///< Value pattern
+    uint32_t stringSize;                ///< Bytes of string samples
+    bool isRamp;                        ///< Ramp the load?
+    uint32_t rampStep;                  ///< Sensors activated at each step
+    uint32_t stepDuration;              ///< Duration of a step in seconds
+}
+Config;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Synthetic sensors and number of them active
+ */
+//--------------------------------------------------------------------------------------------------
+static loadSensor_t Sensors[MAX_SENSORS];
+static uint32_t SensorCount;
+static uint32_t ActiveCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of the capacity measurement
+ */
+//--------------------------------------------------------------------------------------------------
+static struct
+{
+    bool isDone;                        ///< Is the measurement complete?
+    bool isSaturated;                   ///< Did the target fail to sustain the load?
+    uint32_t stepCallbacks;             ///< Callbacks of active sensors during the step
+    uint32_t stepLate;                  ///< Late callbacks during the step
+    uint32_t stepSamples;               ///< Samples produced during the step
+    double stepStart;                   ///< Start time of the step
+    double offeredRate;                 ///< Samples per second requested in the last step
+    double achievedRate;                ///< Samples per second produced in the last step
+    double lateRatio;                   ///< Share of late callbacks in the last step
+    double maxRate;                     ///< Highest rate sustained
+    uint32_t maxActiveCount;            ///< Active sensors at the highest rate sustained
+}
+Capacity;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetTime
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return (double)now.sec + ((double)now.usec / 1000000.0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Account a callback and spend the configured time in it
+ *
+ * @return:
+ *      - LE_OK if the sensor must produce a sample
+ *      - LE_UNAVAILABLE if the sensor is not active
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t StartSample
+(
+    loadSensor_t* sensorPtr             ///< [IN] Sensor
+)
+{
+    double now = GetTime();
+    double lastCallTime = sensorPtr->lastCallTime;
+
+    sensorPtr->lastCallTime = now;
+
+    if (sensorPtr->index >= ActiveCount)
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    Capacity.stepCallbacks++;
+
+    if ((lastCallTime > 0) && (now - lastCallTime > 1.5 * Config.period))
+    {
+        Capacity.stepLate++;
+    }
+
+    while ((GetTime() - now) * 1000000.0 < Config.costUs)
+    {
+    }
+
+    Capacity.stepSamples++;
+    sensorPtr->seq++;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the next value of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetValue
+(
+    const loadSensor_t* sensorPtr       ///< [IN] Sensor
+)
+{
+    switch (Config.pattern)
+    {
+        case PATTERN_CONSTANT:
+            return sensorPtr->index;
+
+        case PATTERN_RAMP:
+            return sensorPtr->seq;
+
+        case PATTERN_RANDOM:
+            return (double)rand() / RAND_MAX;
+
+        case PATTERN_SINE:
+        default:
+            return sin(2 * M_PI * (sensorPtr->seq + sensorPtr->index) / 60.0);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample a synthetic numeric sensor
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleNumeric
+(
+    double* valuePtr,                   ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Sensor
+)
+{
+    le_result_t result = StartSample(contextPtr);
+
+    if (result == LE_OK)
+    {
+        *valuePtr = GetValue(contextPtr);
+    }
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample a synthetic boolean sensor
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleBoolean
+(
+    bool* valuePtr,                     ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Sensor
+)
+{
+    le_result_t result = StartSample(contextPtr);
+
+    if (result == LE_OK)
+    {
+        *valuePtr = (GetValue(contextPtr) > 0.5);
+    }
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample a synthetic string sensor: the sequence number padded to the configured size
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleString
+(
+    char* valuePtr,                     ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Sensor
+)
+{
+    const loadSensor_t* sensorPtr = contextPtr;
+    le_result_t result = StartSample(contextPtr);
+    size_t size = Config.stringSize;
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    if (size >= *lengthPtr)
+    {
+        size = *lengthPtr - 1;
+    }
+
+    int len = snprintf(valuePtr, size + 1, "%" PRIu32 ":", sensorPtr->seq);
+
+    if ((len >= 0) && ((size_t)len < size))
+    {
+        memset(valuePtr + len, 'x', size - len);
+    }
+
+    valuePtr[size] = '\0';
+    *lengthPtr = size;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample a synthetic JSON sensor
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleJson
+(
+    char* valuePtr,                     ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Sensor
+)
+{
+    const loadSensor_t* sensorPtr = contextPtr;
+    le_result_t result = StartSample(contextPtr);
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    *lengthPtr = snprintf(valuePtr, *lengthPtr, "{\"seq\":%" PRIu32 ",\"value\":%g}",
+                          sensorPtr->seq, GetValue(sensorPtr));
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Publish the state of the capacity measurement
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetCapacity
+(
+    char* valuePtr,                     ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Not used
+)
+{
+    *lengthPtr = snprintf(valuePtr, *lengthPtr,
+                          "{\"state\":\"%s\",\"saturated\":%s,\"active\":%" PRIu32 ","
+                          "\"sensors\":%" PRIu32 ",\"costUs\":%" PRIu32 ","
+                          "\"offeredRate\":%.1f,\"achievedRate\":%.1f,\"lateRatio\":%.4f,"
+                          "\"maxRate\":%.1f,\"maxActive\":%" PRIu32 "}",
+                          Capacity.isDone ? "done" : (Config.isRamp ? "ramping" : "steady"),
+                          Capacity.isSaturated ? "true" : "false",
+                          ActiveCount,
+                          SensorCount,
+                          Config.costUs,
+                          Capacity.offeredRate,
+                          Capacity.achievedRate,
+                          Capacity.lateRatio,
+                          Capacity.maxRate,
+                          Capacity.maxActiveCount);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End a step: keep the rate if it was sustained, then activate more sensors or stop
+ */
+//--------------------------------------------------------------------------------------------------
+static void StepHandler
+(
+    le_timer_Ref_t timerRef             ///< [IN] Step timer
+)
+{
+    double now = GetTime();
+    double duration = now - Capacity.stepStart;
+
+    if (duration <= 0)
+    {
+        return;
+    }
+
+    Capacity.offeredRate = ActiveCount / Config.period;
+    Capacity.achievedRate = Capacity.stepSamples / duration;
+    Capacity.lateRatio = (Capacity.stepCallbacks > 0) ?
+                         ((double)Capacity.stepLate / Capacity.stepCallbacks) : 0;
+
+    bool isSustained = (Capacity.lateRatio <= MAX_LATE_RATIO) &&
+                       (Capacity.achievedRate >= MIN_ACHIEVED_RATIO * Capacity.offeredRate);
+
+    LE_INFO("Load step: %" PRIu32 " sensors, %.1f/s offered, %.1f/s achieved, %.2f%% late",
+            ActiveCount, Capacity.offeredRate, Capacity.achievedRate, Capacity.lateRatio * 100);
+
+    Capacity.stepStart = now;
+    Capacity.stepCallbacks = 0;
+    Capacity.stepLate = 0;
+    Capacity.stepSamples = 0;
+
+    if (!Config.isRamp || Capacity.isDone)
+    {
+        return;
+    }
+
+    if (isSustained && (Capacity.achievedRate > Capacity.maxRate))
+    {
+        Capacity.maxRate = Capacity.achievedRate;
+        Capacity.maxActiveCount = ActiveCount;
+    }
+
+    if (!isSustained || (ActiveCount >= SensorCount))
+    {
+        Capacity.isDone = true;
+        Capacity.isSaturated = !isSustained;
+
+        // Stay at the highest load sustained.
+        ActiveCount = Capacity.maxActiveCount;
+
+        LE_INFO("Capacity: %.1f samples/s with %" PRIu32 " sensors%s",
+                Capacity.maxRate, Capacity.maxActiveCount,
+                Capacity.isSaturated ? "" : " (not saturated, register more sensors)");
+        return;
+    }
+
+    ActiveCount += Config.rampStep;
+
+    if (ActiveCount > SensorCount)
+    {
+        ActiveCount = SensorCount;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the configuration
+ *
+ * @return:
+ *      - true if the plugin is enabled
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadConfig
+(
+    void
+)
+{
+    char pattern[16];
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn("loadPlugin");
+    bool isEnabled = le_cfg_GetBool(iteratorRef, "enable", false);
+
+    Config.counts[SF_CB_NUMERIC] = le_cfg_GetInt(iteratorRef, "numeric", 10);
+    Config.counts[SF_CB_BOOLEAN] = le_cfg_GetInt(iteratorRef, "boolean", 0);
+    Config.counts[SF_CB_STRING] = le_cfg_GetInt(iteratorRef, "string", 0);
+    Config.counts[SF_CB_JSON] = le_cfg_GetInt(iteratorRef, "json", 0);
+    Config.period = le_cfg_GetFloat(iteratorRef, "period", 1);
+    Config.costUs = le_cfg_GetInt(iteratorRef, "costUs", 0);
+    Config.stringSize = le_cfg_GetInt(iteratorRef, "stringSize", 32);
+    Config.isRamp = le_cfg_GetBool(iteratorRef, "ramp", false);
+    Config.rampStep = le_cfg_GetInt(iteratorRef, "rampStep", 10);
+    Config.stepDuration = le_cfg_GetInt(iteratorRef, "stepDuration", 10);
+
+    if (le_cfg_GetString(iteratorRef, "pattern", pattern, sizeof(pattern), "sine") != LE_OK)
+    {
+        pattern[0] = '\0';
+    }
+
+    le_cfg_CancelTxn(iteratorRef);
+
+    Config.pattern = (strcmp(pattern, "constant") == 0) ? PATTERN_CONSTANT :
+                     (strcmp(pattern, "ramp") == 0) ? PATTERN_RAMP :
+                     (strcmp(pattern, "random") == 0) ? PATTERN_RANDOM :
+                     PATTERN_SINE;
+
+    if (Config.period <= 0)
+    {
+        Config.period = 1;
+    }
+
+    if (Config.stringSize >= MAX_STRING_SIZE)
+    {
+        Config.stringSize = MAX_STRING_SIZE - 1;
+    }
+
+    if (Config.rampStep == 0)
+    {
+        Config.rampStep = 1;
+    }
+
+    if (Config.stepDuration == 0)
+    {
+        Config.stepDuration = 1;
+    }
+
+    return isEnabled;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register a sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t RegisterSensor
+(
+    const char* pathPtr,                ///< [IN] Path of the sensor
+    double period,                      ///< [IN] Sampling period
+    sensorfwDataType_t type,            ///< [IN] Data type
+    sensorfwCallbacks_t* callbacksPtr,  ///< [IN] Callbacks
+    void* contextPtr                    ///< [IN] Sensor
+)
+{
+    char jsonDoc[256];
+
+    snprintf(jsonDoc,
+             sizeof(jsonDoc),
+             "{"
+             "\"name\" : \"%s\","
+             "\"plugin\" : \"load\","
+             "\"path\" : \"%s\","
+             "\"readOnce\" : false,"
+             "\"period\" : %g,"
+             "\"unit\" : \"\""
+             "}",
+             pathPtr,
+             pathPtr,
+             period);
+
+    return sensorFw_RegisterCallback(jsonDoc, type, callbacksPtr, contextPtr, NULL);
+}
+
+COMPONENT_INIT
+{
+    static const char* TypeNames[] = { "numeric", "string", "boolean", "json" };
+    uint32_t registered[NUM_ARRAY_MEMBERS(TypeNames)] = { 0 };
+    sensorfwCallbacks_t pluginCb;
+    char path[64];
+    bool isRegistering = true;
+    int type;
+
+    LE_STATIC_ASSERT(SF_CB_NUMERIC == 0 && SF_CB_STRING == 1 && SF_CB_BOOLEAN == 2 &&
+                     SF_CB_JSON == 3, "Unexpected sensorfwDataType_t values");
+
+    if (!ReadConfig())
+    {
+        LE_INFO("Load plugin disabled");
+        return;
+    }
+
+    LE_INFO("Start load plugin");
+
+    // Interleave the types so that the ramp activates all of them evenly.
+    while (isRegistering)
+    {
+        isRegistering = false;
+
+        for (type = 0; type < NUM_ARRAY_MEMBERS(TypeNames); type++)
+        {
+            if ((registered[type] >= Config.counts[type]) || (SensorCount >= MAX_SENSORS))
+            {
+                continue;
+            }
+
+            loadSensor_t* sensorPtr = &Sensors[SensorCount];
+
+            memset(&pluginCb, 0, sizeof(pluginCb));
+
+            switch (type)
+            {
+                case SF_CB_NUMERIC:
+                    pluginCb.sample.numericCb = SampleNumeric;
+                    break;
+                case SF_CB_BOOLEAN:
+                    pluginCb.sample.boolCb = SampleBoolean;
+                    break;
+                case SF_CB_STRING:
+                    pluginCb.sample.stringCb = SampleString;
+                    break;
+                case SF_CB_JSON:
+                    pluginCb.sample.jsonCb = SampleJson;
+                    break;
+            }
+
+            snprintf(path, sizeof(path), "load/%s/%" PRIu32, TypeNames[type], registered[type]);
+            registered[type]++;
+
+            sensorPtr->index = SensorCount;
+
+            if (RegisterSensor(path, Config.period, type, &pluginCb, sensorPtr) != LE_OK)
+            {
+                LE_ERROR("Registering %s failed", path);
+                continue;
+            }
+
+            SensorCount++;
+            isRegistering = true;
+        }
+    }
+
+    ActiveCount = Config.isRamp ? Config.rampStep : SensorCount;
+
+    if (ActiveCount > SensorCount)
+    {
+        ActiveCount = SensorCount;
+    }
+
+    LE_INFO("%" PRIu32 " synthetic sensors, %" PRIu32 " active", SensorCount, ActiveCount);
+
+    // The capacity is published at the end of each step.
+    memset(&pluginCb, 0, sizeof(pluginCb));
+    pluginCb.sample.jsonCb = GetCapacity;
+    RegisterSensor("load/capacity", Config.stepDuration, SF_CB_JSON, &pluginCb, NULL);
+
+    Capacity.stepStart = GetTime();
+
+    le_timer_Ref_t timerRef = le_timer_Create("loadStep");
+    le_timer_SetMsInterval(timerRef, Config.stepDuration * 1000);
+    le_timer_SetRepeat(timerRef, 0);
+    le_timer_SetHandler(timerRef, StepHandler);
+    le_timer_Start(timerRef);
+}
@@ -0,0 +1,1817 @@
+//--------------------------------------------------------------------------------------------------
+/** @file modbusPlugin.c
+ *
+ * Meters and controllers read over Modbus TCP or Modbus RTU, from a register map in the
+ * configuration tree.
+ *
+ * Every register of the map is a sensor modbus/<slave>/<name>: numeric for holding and input
+ * registers, decoded from one or two 16-bit words and scaled, boolean for coils and discrete
+ * inputs. A slave is polled in cycles, at the shortest period of its sensors. Each cycle reads
+ * the registers that are due with as few requests as possible: registers of the same table are
+ * coalesced into one block read as long as the block stays within the limit of the protocol (125
+ * registers, 2000 bits) and the hole between two registers is at most maxGap addresses. Over TCP,
+ * up to pipeline requests are sent without waiting for the previous responses, which are matched
+ * by their transaction identifier; over RTU the bus allows a single request at a time, separated
+ * by the silent interval of 3.5 characters. The time taken by a cycle without failure, from its
+ * start to its last response, is published in modbus/<slave>/cycle, in milliseconds.
+ *
+ * A slave that does not answer within timeoutMs is disconnected (TCP) or skipped (RTU) until its
+ * next cycle. Exception responses are logged and the registers of the block are left out of the
+ * cycle.
+ *
+ * The plugin is disabled unless modbusPlugin/enable is set in the configuration tree of the app.
+ * Slaves are configured under modbusPlugin/slaves/<slave>/:
+ *  - host          (string) address of a Modbus TCP slave or gateway, resolved once at startup
+ *  - port          (int)    TCP port (default 502)
+ *  - device        (string) serial port of a Modbus RTU bus, e.g. /dev/ttyUSB0, instead of host
+ *  - baud          (int)    baud rate of the serial port (default 9600)
+ *  - parity        (string) none, even or odd (default even)
+ *  - stopBits      (int)    1 or 2 (default 1)
+ *  - unitId        (int)    unit identifier of the slave (default 1)
+ *  - period        (float)  default sampling period of the registers in seconds (default 10)
+ *  - timeoutMs     (int)    time allowed for a response (default 1000)
+ *  - maxGap        (int)    addresses not in the map read to join two blocks (default 0)
+ *  - maxBlock      (int)    registers or bits read by a request at most (default and limit of the
+ *                           protocol, 1 reads every register by itself)
+ *  - pipeline      (int)    requests in flight over TCP (default 4, 1 for slaves that cannot
+ *                           queue requests)
+ * and its registers under modbusPlugin/slaves/<slave>/registers/<name>/:
+ *  - table         (string) holding, input, coil or discrete (default holding)
+ *  - address       (int)    address of the register, from 0 (required)
+ *  - type          (string) u16, s16, u32, s32 or f32 (default u16), for holding and input
+ *  - wordSwap      (bool)   the low word of 32-bit values comes first (default false)
+ *  - scale         (float)  factor applied to the raw value (default 1)
+ *  - offset        (float)  added to the scaled value (default 0)
+ *  - unit          (string) unit of the sensor
+ *  - period        (float)  sampling period in seconds (default period of the slave)
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <inttypes.h>
+#include <netdb.h>
+#include <termios.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "interfaces.h"
+#include "sensorFw.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Node of the configuration tree of the plugin
+ */
+//--------------------------------------------------------------------------------------------------
+#define CONFIG_NODE                 "modbusPlugin"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of slaves, of registers per slave and length of their names
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_SLAVES                  8
+#define MAX_REGISTERS               128
+#define MAX_NAME_LEN                32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of requests in flight over TCP
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_PIPELINE                16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Limits of the protocol: registers and bits read by one request, size of a frame
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_READ_REGISTERS          125
+#define MAX_READ_BITS               2000
+#define MAX_ADU_SIZE                260
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the header of a Modbus TCP frame (MBAP), including the unit identifier
+ */
+//--------------------------------------------------------------------------------------------------
+#define MBAP_SIZE                   7
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Defaults of the configuration of a slave
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_PORT                502
+#define DEFAULT_BAUD                9600
+#define DEFAULT_PERIOD              10
+#define DEFAULT_TIMEOUT_MS          1000
+#define DEFAULT_PIPELINE            4
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function codes of the reads, one per table
+ */
+//--------------------------------------------------------------------------------------------------
+#define FC_READ_COILS               0x01
+#define FC_READ_DISCRETE_INPUTS     0x02
+#define FC_READ_HOLDING_REGISTERS   0x03
+#define FC_READ_INPUT_REGISTERS     0x04
+#define FC_EXCEPTION                0x80
+
+static const struct
+{
+    const char* namePtr;                ///< Name of the table in the configuration
+    uint8_t function;                   ///< Function code reading it
+}
+Tables[] =
+{
+    { "holding",    FC_READ_HOLDING_REGISTERS   },
+    { "input",      FC_READ_INPUT_REGISTERS     },
+    { "coil",       FC_READ_COILS               },
+    { "discrete",   FC_READ_DISCRETE_INPUTS     }
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Types of values
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    VALUE_BIT,                          ///< Coil or discrete input
+    VALUE_U16,
+    VALUE_S16,
+    VALUE_U32,
+    VALUE_S32,
+    VALUE_F32
+}
+valueType_t;
+
+static const struct
+{
+    const char* namePtr;                ///< Name of the type in the configuration
+    valueType_t type;                   ///< Type
+    uint16_t count;                     ///< Number of registers
+}
+ValueTypes[] =
+{
+    { "u16",        VALUE_U16,          1 },
+    { "s16",        VALUE_S16,          1 },
+    { "u32",        VALUE_U32,          2 },
+    { "s32",        VALUE_S32,          2 },
+    { "f32",        VALUE_F32,          2 }
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Slave
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct modbusSlave modbusSlave_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register of the map of a slave
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    modbusSlave_t* slavePtr;            ///< Slave
+    char name[MAX_NAME_LEN];            ///< Name of the register
+    uint8_t function;                   ///< Function code reading its table
+    uint16_t address;                   ///< Address of the register
+    uint16_t count;                     ///< Number of registers or bits
+    valueType_t type;                   ///< Type of the value
+    bool isWordSwapped;                 ///< Low word first for 32-bit values
+    double scale;                       ///< Factor applied to the raw value
+    double offset;                      ///< Added to the scaled value
+    char unit[MAX_NAME_LEN];            ///< Unit of the sensor
+    double defaultPeriod;               ///< Default sampling period in seconds
+    void* handlerPtr;                   ///< Sensor handler
+    double period;                      ///< Sampling period, 0 if disabled
+    double nextDue;                     ///< Relative time of the next sample
+    bool isDue;                         ///< To be read in the current cycle
+    bool hasValue;                      ///< A value was read
+    double value;                       ///< Last value read
+}
+modbusRegister_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Request in flight: a block of registers read at once
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint16_t transactionId;             ///< Transaction identifier (TCP)
+    uint8_t function;                   ///< Function code
+    uint16_t address;                   ///< First address of the block
+    uint16_t count;                     ///< Number of registers or bits of the block
+    int first;                          ///< First register of the map in the block
+    int last;                           ///< Last register of the map in the block
+}
+modbusRequest_t;
+
+struct modbusSlave
+{
+    char name[MAX_NAME_LEN];            ///< Name of the slave
+    bool isSerial;                      ///< Modbus RTU rather than Modbus TCP
+    char host[64];                      ///< Address of the slave (TCP)
+    char port[8];                       ///< TCP port
+    struct sockaddr_storage address;    ///< Resolved address and port (TCP)
+    socklen_t addressLen;               ///< Size of the address
+    char device[64];                    ///< Serial port (RTU)
+    uint32_t baud;                      ///< Baud rate (RTU)
+    char parity;                        ///< 'N', 'E' or 'O' (RTU)
+    int stopBits;                       ///< Stop bits (RTU)
+    uint8_t unitId;                     ///< Unit identifier
+    uint32_t timeoutMs;                 ///< Time allowed for a response
+    uint32_t frameGapMs;                ///< Silent interval between two frames (RTU)
+    uint16_t maxGap;                    ///< Addresses not in the map read to join two blocks
+    uint16_t maxBlock;                  ///< Registers or bits read by a request at most
+    int pipeline;                       ///< Requests in flight at most
+    modbusRegister_t registers[MAX_REGISTERS]; ///< Map, by table and address
+    int registerCount;                  ///< Number of registers
+    void* cycleHandlerPtr;              ///< Handler of the cycle time sensor
+    bool isCycleEnabled;                ///< Cycle time sensor enabled
+    double cycleMs;                     ///< Time of the last cycle
+    int fd;                             ///< Socket or serial port, -1 if closed
+    le_fdMonitor_Ref_t monitorRef;      ///< Monitor of the socket or serial port
+    bool isConnecting;                  ///< TCP connection in progress
+    le_timer_Ref_t tickTimer;           ///< Timer of the cycles
+    le_timer_Ref_t timeoutTimer;        ///< Timer of the responses
+    le_timer_Ref_t gapTimer;            ///< Timer of the silent interval (RTU)
+    double tickPeriod;                  ///< Period of the cycles, 0 if stopped
+    bool isPolling;                     ///< A cycle is in progress
+    double cycleStart;                  ///< Relative time of the first request of the cycle
+    int nextRegister;                   ///< Next register of the map to be requested
+    uint32_t requestCount;              ///< Requests of the cycle
+    uint32_t failureCount;              ///< Failed requests of the cycle
+    modbusRequest_t inFlight[MAX_PIPELINE]; ///< Requests in flight
+    int inFlightCount;                  ///< Number of requests in flight
+    uint16_t nextTransactionId;         ///< Transaction identifier of the next request
+    uint8_t rxBuffer[2 * MAX_ADU_SIZE]; ///< Bytes received, not yet parsed
+    size_t rxLength;                    ///< Number of bytes received
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Slaves
+ */
+//--------------------------------------------------------------------------------------------------
+static modbusSlave_t Slaves[MAX_SLAVES];
+static int SlaveCount;
+
+static void FillPipeline(modbusSlave_t* slavePtr);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetTime
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return (double)now.sec + ((double)now.usec / 1000000.0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a big endian 16-bit word
+ */
+//--------------------------------------------------------------------------------------------------
+static uint16_t GetWord
+(
+    const uint8_t* bytesPtr             ///< [IN] Word
+)
+{
+    return (uint16_t)((bytesPtr[0] << 8) | bytesPtr[1]);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a big endian 16-bit word
+ */
+//--------------------------------------------------------------------------------------------------
+static void PutWord
+(
+    uint8_t* bytesPtr,                  ///< [OUT] Word
+    uint16_t word                       ///< [IN]  Value
+)
+{
+    bytesPtr[0] = word >> 8;
+    bytesPtr[1] = word & 0xFF;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the CRC of a Modbus RTU frame
+ *
+ * @return:
+ *      - CRC, sent low byte first
+ */
+//--------------------------------------------------------------------------------------------------
+static uint16_t ComputeCrc
+(
+    const uint8_t* bytesPtr,            ///< [IN] Frame
+    size_t length                       ///< [IN] Length of the frame, without the CRC
+)
+{
+    uint16_t crc = 0xFFFF;
+    size_t i;
+    int bit;
+
+    for (i = 0; i < length; i++)
+    {
+        crc ^= bytesPtr[i];
+
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+        }
+    }
+
+    return crc;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of data bytes of the response to a request
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetDataSize
+(
+    const modbusRequest_t* requestPtr   ///< [IN] Request
+)
+{
+    if ((requestPtr->function == FC_READ_COILS) ||
+        (requestPtr->function == FC_READ_DISCRETE_INPUTS))
+    {
+        return (requestPtr->count + 7) / 8;
+    }
+
+    return requestPtr->count * 2;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode the value of a register from the data of a response
+ */
+//--------------------------------------------------------------------------------------------------
+static double DecodeValue
+(
+    const modbusRegister_t* registerPtr,    ///< [IN] Register
+    const uint8_t* dataPtr,             ///< [IN] Data of the response
+    uint16_t index                      ///< [IN] Index of the register or bit in the data
+)
+{
+    uint32_t raw;
+    float real;
+
+    if (registerPtr->type == VALUE_BIT)
+    {
+        return (dataPtr[index / 8] >> (index % 8)) & 1;
+    }
+
+    dataPtr += index * 2;
+
+    switch (registerPtr->type)
+    {
+        case VALUE_U16:
+            return GetWord(dataPtr);
+
+        case VALUE_S16:
+            return (int16_t)GetWord(dataPtr);
+
+        default:
+            break;
+    }
+
+    raw = registerPtr->isWordSwapped ?
+          (((uint32_t)GetWord(dataPtr + 2) << 16) | GetWord(dataPtr)) :
+          (((uint32_t)GetWord(dataPtr) << 16) | GetWord(dataPtr + 2));
+
+    switch (registerPtr->type)
+    {
+        case VALUE_S32:
+            return (int32_t)raw;
+
+        case VALUE_F32:
+            memcpy(&real, &raw, sizeof(real));
+            return real;
+
+        default:
+            return raw;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode and push the registers of the map read by a request
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushRegisters
+(
+    modbusSlave_t* slavePtr,            ///< [IN] Slave
+    const modbusRequest_t* requestPtr,  ///< [IN] Request
+    const uint8_t* dataPtr              ///< [IN] Data of the response
+)
+{
+    int i;
+
+    for (i = requestPtr->first; i <= requestPtr->last; i++)
+    {
+        modbusRegister_t* registerPtr = &slavePtr->registers[i];
+
+        if (!registerPtr->isDue)
+        {
+            continue;
+        }
+
+        registerPtr->isDue = false;
+        registerPtr->hasValue = true;
+
+        double raw = DecodeValue(registerPtr, dataPtr, registerPtr->address - requestPtr->address);
+
+        if (registerPtr->type == VALUE_BIT)
+        {
+            registerPtr->value = raw;
+            sensorFw_PushBoolean(registerPtr->handlerPtr, 0, raw != 0);
+        }
+        else
+        {
+            registerPtr->value = raw * registerPtr->scale + registerPtr->offset;
+            sensorFw_PushNumeric(registerPtr->handlerPtr, 0, registerPtr->value);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the response to a request and push its registers
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleResponse
+(
+    modbusSlave_t* slavePtr,            ///< [IN] Slave
+    const modbusRequest_t* requestPtr,  ///< [IN] Request
+    const uint8_t* pduPtr,              ///< [IN] Response, from the function code
+    size_t pduLength                    ///< [IN] Length of the response
+)
+{
+    size_t dataSize = GetDataSize(requestPtr);
+
+    if ((pduLength >= 2) && (pduPtr[0] == (requestPtr->function | FC_EXCEPTION)))
+    {
+        LE_WARN("Slave %s: exception %u reading %u at %u", slavePtr->name, pduPtr[1],
+                requestPtr->count, requestPtr->address);
+        slavePtr->failureCount++;
+        return;
+    }
+
+    if ((pduLength < 2 + dataSize) || (pduPtr[0] != requestPtr->function) ||
+        (pduPtr[1] != dataSize))
+    {
+        LE_WARN("Slave %s: bad response reading %u at %u", slavePtr->name, requestPtr->count,
+                requestPtr->address);
+        slavePtr->failureCount++;
+        return;
+    }
+
+    PushRegisters(slavePtr, requestPtr, pduPtr + 2);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a request from the requests in flight
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveRequest
+(
+    modbusSlave_t* slavePtr,            ///< [IN] Slave
+    int index                           ///< [IN] Index of the request
+)
+{
+    slavePtr->inFlight[index] = slavePtr->inFlight[--slavePtr->inFlightCount];
+
+    if (slavePtr->inFlightCount == 0)
+    {
+        le_timer_Stop(slavePtr->timeoutTimer);
+    }
+    else
+    {
+        // The responses came in time so far, give the next one its own time.
+        le_timer_Restart(slavePtr->timeoutTimer);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End the cycle of a slave, and publish its time
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndCycle
+(
+    modbusSlave_t* slavePtr             ///< [IN] Slave
+)
+{
+    int i;
+
+    slavePtr->isPolling = false;
+
+    for (i = 0; i < slavePtr->registerCount; i++)
+    {
+        slavePtr->registers[i].isDue = false;
+    }
+
+    if (slavePtr->failureCount > 0)
+    {
+        LE_DEBUG("Slave %s: cycle incomplete, %" PRIu32 " failures in %" PRIu32 " requests",
+                 slavePtr->name, slavePtr->failureCount, slavePtr->requestCount);
+        return;
+    }
+
+    slavePtr->cycleMs = (GetTime() - slavePtr->cycleStart) * 1000;
+
+    LE_DEBUG("Slave %s: cycle of %" PRIu32 " requests in %.1f ms", slavePtr->name,
+             slavePtr->requestCount, slavePtr->cycleMs);
+
+    if (slavePtr->isCycleEnabled)
+    {
+        sensorFw_PushNumeric(slavePtr->cycleHandlerPtr, 0, slavePtr->cycleMs);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the connection to a slave. The cycle in progress is abandoned, the connection is opened
+ * again by the next one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Disconnect
+(
+    modbusSlave_t* slavePtr             ///< [IN] Slave
+)
+{
+    if (slavePtr->fd < 0)
+    {
+        return;
+    }
+
+    le_fdMonitor_Delete(slavePtr->monitorRef);
+    close(slavePtr->fd);
+
+    slavePtr->fd = -1;
+    slavePtr->isConnecting = false;
+
+    // The requests in flight are lost, and the cycle is not complete even without any.
+    slavePtr->failureCount += (slavePtr->inFlightCount > 0) ? slavePtr->inFlightCount : 1;
+    slavePtr->inFlightCount = 0;
+    slavePtr->rxLength = 0;
+    le_timer_Stop(slavePtr->timeoutTimer);
+    le_timer_Stop(slavePtr->gapTimer);
+
+    if (slavePtr->isPolling)
+    {
+        EndCycle(slavePtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the Modbus TCP frames received
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if the stream cannot be parsed, the connection must be closed
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseTcp
+(
+    modbusSlave_t* slavePtr             ///< [IN] Slave
+)
+{
+    const uint8_t* framePtr = slavePtr->rxBuffer;
+    size_t length = slavePtr->rxLength;
+    int i;
+
+    while (length >= MBAP_SIZE)
+    {
+        // Length of the unit identifier and PDU.
+        uint16_t frameLength = GetWord(framePtr + 4);
+
+        if ((GetWord(framePtr + 2) != 0) || (frameLength < 2) ||
+            (frameLength > MAX_ADU_SIZE - MBAP_SIZE + 1))
+        {
+            LE_WARN("Slave %s: bad frame", slavePtr->name);
+            return LE_FAULT;
+        }
+
+        if (length < (size_t)(6 + frameLength))
+        {
+            break;
+        }
+
+        uint16_t transactionId = GetWord(framePtr);
+
+        // Responses to requests that timed out are ignored.
+        for (i = 0; i < slavePtr->inFlightCount; i++)
+        {
+            if (slavePtr->inFlight[i].transactionId == transactionId)
+            {
+                modbusRequest_t request = slavePtr->inFlight[i];
+
+                RemoveRequest(slavePtr, i);
+                HandleResponse(slavePtr, &request, framePtr + MBAP_SIZE, frameLength - 1);
+                break;
+            }
+        }
+
+        framePtr += 6 + frameLength;
+        length -= 6 + frameLength;
+    }
+
+    memmove(slavePtr->rxBuffer, framePtr, length);
+    slavePtr->rxLength = length;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the Modbus RTU frame received
+ *
+ * @return:
+ *      - LE_OK if the frame is complete, and handled
+ *      - LE_UNAVAILABLE if more bytes are expected
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseRtu
+(
+    modbusSlave_t* slavePtr             ///< [IN] Slave
+)
+{
+    const uint8_t* framePtr = slavePtr->rxBuffer;
+    size_t length = slavePtr->rxLength;
+    size_t frameLength;
+
+    // Late responses, to requests that timed out, are dropped.
+    if (slavePtr->inFlightCount == 0)
+    {
+        slavePtr->rxLength = 0;
+        return LE_UNAVAILABLE;
+    }
+
+    if (length < 3)
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    // Unit, function, then an exception code or a byte count and the data, and the CRC.
+    frameLength = (framePtr[1] & FC_EXCEPTION) ? 5 : (size_t)(3 + framePtr[2] + 2);
+
+    if (length < frameLength)
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    modbusRequest_t request = slavePtr->inFlight[0];
+
+    RemoveRequest(slavePtr, 0);
+
+    if ((framePtr[0] != slavePtr->unitId) ||
+        (ComputeCrc(framePtr, frameLength - 2) !=
+         (framePtr[frameLength - 2] | (framePtr[frameLength - 1] << 8))))
+    {
+        LE_WARN("Slave %s: bad frame", slavePtr->name);
+        slavePtr->failureCount++;
+    }
+    else
+    {
+        HandleResponse(slavePtr, &request, framePtr + 1, frameLength - 3);
+    }
+
+    // Anything after the frame is noise: there is a single request at a time on the bus.
+    slavePtr->rxLength = 0;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Complete the connection to a TCP slave
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if the connection failed
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CompleteConnection
+(
+    modbusSlave_t* slavePtr             ///< [IN] Slave
+)
+{
+    int error = 0;
+    socklen_t size = sizeof(error);
+
+    if ((getsockopt(slavePtr->fd, SOL_SOCKET, SO_ERROR, &error, &size) != 0) || (error != 0))
+    {
+        LE_WARN("Slave %s: cannot connect to %s:%s: %s", slavePtr->name, slavePtr->host,
+                slavePtr->port, strerror(error));
+        return LE_FAULT;
+    }
+
+    LE_INFO("Slave %s: connected to %s:%s", slavePtr->name, slavePtr->host, slavePtr->port);
+
+    slavePtr->isConnecting = false;
+    le_timer_Stop(slavePtr->timeoutTimer);
+    le_fdMonitor_Disable(slavePtr->monitorRef, POLLOUT);
+    le_fdMonitor_Enable(slavePtr->monitorRef, POLLIN);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle events on the connection to a slave
+ */
+//--------------------------------------------------------------------------------------------------
+static void ConnectionHandler
+(
+    int fd,                             ///< [IN] Socket or serial port
+    short events                        ///< [IN] Events
+)
+{
+    modbusSlave_t* slavePtr = le_fdMonitor_GetContextPtr();
+    int one = 1;
+
+    if (slavePtr->isConnecting)
+    {
+        if (CompleteConnection(slavePtr) != LE_OK)
+        {
+            Disconnect(slavePtr);
+            return;
+        }
+
+        FillPipeline(slavePtr);
+        return;
+    }
+
+    if (events & POLLIN)
+    {
+        ssize_t size = read(fd, slavePtr->rxBuffer + slavePtr->rxLength,
+                            sizeof(slavePtr->rxBuffer) - slavePtr->rxLength);
+
+        if ((size < 0) && ((errno == EAGAIN) || (errno == EINTR)))
+        {
+            return;
+        }
+
+        if (size <= 0)
+        {
+            LE_WARN("Slave %s: connection lost", slavePtr->name);
+            Disconnect(slavePtr);
+            return;
+        }
+
+        slavePtr->rxLength += size;
+
+        if (slavePtr->isSerial)
+        {
+            if (ParseRtu(slavePtr) == LE_OK)
+            {
+                // Silent interval before the next request on the bus.
+                le_timer_Start(slavePtr->gapTimer);
+            }
+            else if (slavePtr->rxLength == sizeof(slavePtr->rxBuffer))
+            {
+                slavePtr->rxLength = 0;
+            }
+
+            return;
+        }
+
+        // Acknowledge at once: a slave with Nagle's algorithm holds its next pipelined response
+        // until the previous one is acknowledged, which the delayed ACK would postpone by 40 ms.
+        setsockopt(fd, IPPROTO_TCP, TCP_QUICKACK, &one, sizeof(one));
+
+        if (ParseTcp(slavePtr) != LE_OK)
+        {
+            Disconnect(slavePtr);
+            return;
+        }
+
+        FillPipeline(slavePtr);
+        return;
+    }
+
+    if (events & (POLLHUP | POLLERR | POLLRDHUP))
+    {
+        LE_WARN("Slave %s: connection lost", slavePtr->name);
+        Disconnect(slavePtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resolve the address of a TCP slave. The lookup may block, so it is only done when the slave is
+ * added rather than on every connection.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if the host cannot be resolved
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ResolveHost
+(
+    modbusSlave_t* slavePtr             ///< [IN] Slave
+)
+{
+    struct addrinfo hints;
+    struct addrinfo* addrPtr;
+    int result;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV;
+
+    result = getaddrinfo(slavePtr->host, slavePtr->port, &hints, &addrPtr);
+
+    if (result != 0)
+    {
+        LE_ERROR("Slave %s: cannot resolve %s: %s", slavePtr->name, slavePtr->host,
+                 gai_strerror(result));
+        return LE_FAULT;
+    }
+
+    memcpy(&slavePtr->address, addrPtr->ai_addr, addrPtr->ai_addrlen);
+    slavePtr->addressLen = addrPtr->ai_addrlen;
+    freeaddrinfo(addrPtr);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start the connection to a TCP slave
+ *
+ * @return:
+ *      - LE_OK on success, the connection is completed when the socket is writable
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ConnectTcp
+(
+    modbusSlave_t* slavePtr             ///< [IN] Slave
+)
+{
+    int one = 1;
+    int fd = socket(slavePtr->address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (fd < 0)
+    {
+        LE_ERROR("Slave %s: cannot create socket: %m", slavePtr->name);
+        return LE_FAULT;
+    }
+
+    // Requests are small and latency bound, do not hold them back.
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    if ((connect(fd, (struct sockaddr*)&slavePtr->address, slavePtr->addressLen) != 0) &&
+        (errno != EINPROGRESS))
+    {
+        LE_WARN("Slave %s: cannot connect to %s:%s: %m", slavePtr->name, slavePtr->host,
+                slavePtr->port);
+        close(fd);
+        return LE_FAULT;
+    }
+
+    slavePtr->fd = fd;
+    slavePtr->isConnecting = true;
+    slavePtr->monitorRef = le_fdMonitor_Create(slavePtr->name, fd, ConnectionHandler, POLLOUT);
+    le_fdMonitor_SetContextPtr(slavePtr->monitorRef, slavePtr);
+
+    // A slave that does not accept the connection is handled as one that does not answer.
+    le_timer_Start(slavePtr->timeoutTimer);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the termios constant of a baud rate
+ *
+ * @return:
+ *      - Constant of the baud rate, B0 if not supported
+ */
+//--------------------------------------------------------------------------------------------------
+static speed_t GetSpeed
+(
+    uint32_t baud                       ///< [IN] Baud rate
+)
+{
+    switch (baud)
+    {
+        case 1200:      return B1200;
+        case 2400:      return B2400;
+        case 4800:      return B4800;
+        case 9600:      return B9600;
+        case 19200:     return B19200;
+        case 38400:     return B38400;
+        case 57600:     return B57600;
+        case 115200:    return B115200;
+        case 230400:    return B230400;
+        default:        return B0;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open the serial port of a RTU slave
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t OpenSerial
+(
+    modbusSlave_t* slavePtr             ///< [IN] Slave
+)
+{
+    struct termios tty;
+    int fd = open(slavePtr->device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        LE_WARN("Slave %s: cannot open %s: %m", slavePtr->name, slavePtr->device);
+        return LE_FAULT;
+    }
+
+    if (tcgetattr(fd, &tty) != 0)
+    {
+        LE_ERROR("Slave %s: %s is not a serial port: %m", slavePtr->name, slavePtr->device);
+        close(fd);
+        return LE_FAULT;
+    }
+
+    cfmakeraw(&tty);
+    cfsetispeed(&tty, GetSpeed(slavePtr->baud));
+    cfsetospeed(&tty, GetSpeed(slavePtr->baud));
+
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cflag &= ~(PARENB | PARODD | CSTOPB);
+    tty.c_cflag |= (slavePtr->parity == 'E') ? PARENB :
+                   (slavePtr->parity == 'O') ? (PARENB | PARODD) :
+                   0;
+    tty.c_cflag |= (slavePtr->stopBits == 2) ? CSTOPB : 0;
+
+    if (tcsetattr(fd, TCSANOW, &tty) != 0)
+    {
+        LE_ERROR("Slave %s: cannot configure %s: %m", slavePtr->name, slavePtr->device);
+        close(fd);
+        return LE_FAULT;
+    }
+
+    tcflush(fd, TCIOFLUSH);
+
+    slavePtr->fd = fd;
+    slavePtr->monitorRef = le_fdMonitor_Create(slavePtr->name, fd, ConnectionHandler, POLLIN);
+    le_fdMonitor_SetContextPtr(slavePtr->monitorRef, slavePtr);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the next block of the cycle: the next register due and the following ones that can be
+ * read by the same request
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if no register is left to be read in the cycle
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t NextBlock
+(
+    modbusSlave_t* slavePtr,            ///< [IN]  Slave
+    modbusRequest_t* requestPtr         ///< [OUT] Request of the block
+)
+{
+    const modbusRegister_t* registersPtr = slavePtr->registers;
+    int i = slavePtr->nextRegister;
+
+    while ((i < slavePtr->registerCount) && !registersPtr[i].isDue)
+    {
+        i++;
+    }
+
+    if (i == slavePtr->registerCount)
+    {
+        slavePtr->nextRegister = i;
+        return LE_NOT_FOUND;
+    }
+
+    uint8_t function = registersPtr[i].function;
+    uint32_t limit = ((function == FC_READ_COILS) || (function == FC_READ_DISCRETE_INPUTS)) ?
+                     MAX_READ_BITS : MAX_READ_REGISTERS;
+    uint32_t start = registersPtr[i].address;
+    uint32_t end = start + registersPtr[i].count;
+
+    if (slavePtr->maxBlock < limit)
+    {
+        limit = slavePtr->maxBlock;
+    }
+
+    requestPtr->function = function;
+    requestPtr->first = i;
+    requestPtr->last = i;
+
+    // The map is sorted by table and address: extend the block while the next register due is in
+    // the same table, close enough and the block not too long.
+    for (i++; i < slavePtr->registerCount; i++)
+    {
+        const modbusRegister_t* registerPtr = &registersPtr[i];
+        uint32_t registerEnd = registerPtr->address + registerPtr->count;
+
+        if (!registerPtr->isDue)
+        {
+            continue;
+        }
+
+        if ((registerPtr->function != function) ||
+            (registerPtr->address > end + slavePtr->maxGap) ||
+            (((registerEnd > end) ? registerEnd : end) - start > limit))
+        {
+            break;
+        }
+
+        if (registerEnd > end)
+        {
+            end = registerEnd;
+        }
+
+        requestPtr->last = i;
+    }
+
+    requestPtr->address = start;
+    requestPtr->count = end - start;
+    slavePtr->nextRegister = requestPtr->last + 1;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a request
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if the request could not be written, the connection must be closed
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SendRequest
+(
+    modbusSlave_t* slavePtr,            ///< [IN] Slave
+    modbusRequest_t* requestPtr         ///< [IN] Request
+)
+{
+    uint8_t frame[MBAP_SIZE + 5];
+    uint8_t* pduPtr;
+    size_t length;
+
+    if (slavePtr->isSerial)
+    {
+        frame[0] = slavePtr->unitId;
+        pduPtr = &frame[1];
+    }
+    else
+    {
+        requestPtr->transactionId = slavePtr->nextTransactionId++;
+        PutWord(&frame[0], requestPtr->transactionId);
+        PutWord(&frame[2], 0);
+        PutWord(&frame[4], 6);
+        frame[6] = slavePtr->unitId;
+        pduPtr = &frame[MBAP_SIZE];
+    }
+
+    pduPtr[0] = requestPtr->function;
+    PutWord(&pduPtr[1], requestPtr->address);
+    PutWord(&pduPtr[3], requestPtr->count);
+    length = pduPtr + 5 - frame;
+
+    if (slavePtr->isSerial)
+    {
+        uint16_t crc = ComputeCrc(frame, length);
+
+        frame[length++] = crc & 0xFF;
+        frame[length++] = crc >> 8;
+    }
+
+    // A request is far smaller than the socket or serial buffers.
+    if (write(slavePtr->fd, frame, length) != (ssize_t)length)
+    {
+        LE_WARN("Slave %s: cannot send request: %m", slavePtr->name);
+        return LE_FAULT;
+    }
+
+    slavePtr->requestCount++;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send the requests of the cycle as long as the pipeline allows, and end the cycle after the
+ * last response
+ */
+//--------------------------------------------------------------------------------------------------
+static void FillPipeline
+(
+    modbusSlave_t* slavePtr             ///< [IN] Slave
+)
+{
+    int pipeline = slavePtr->isSerial ? 1 : slavePtr->pipeline;
+
+    if (!slavePtr->isPolling || slavePtr->isConnecting)
+    {
+        return;
+    }
+
+    while (slavePtr->inFlightCount < pipeline)
+    {
+        modbusRequest_t* requestPtr = &slavePtr->inFlight[slavePtr->inFlightCount];
+
+        if (NextBlock(slavePtr, requestPtr) != LE_OK)
+        {
+            break;
+        }
+
+        if (SendRequest(slavePtr, requestPtr) != LE_OK)
+        {
+            Disconnect(slavePtr);
+            return;
+        }
+
+        if (slavePtr->inFlightCount++ == 0)
+        {
+            le_timer_Start(slavePtr->timeoutTimer);
+        }
+    }
+
+    if (slavePtr->inFlightCount == 0)
+    {
+        EndCycle(slavePtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * No response in time
+ */
+//--------------------------------------------------------------------------------------------------
+static void TimeoutHandler
+(
+    le_timer_Ref_t timerRef             ///< [IN] Timer of the responses
+)
+{
+    modbusSlave_t* slavePtr = le_timer_GetContextPtr(timerRef);
+
+    LE_WARN("Slave %s: no response in %" PRIu32 " ms", slavePtr->name, slavePtr->timeoutMs);
+
+    // On a bus, the next request can go; over TCP, a late response would desynchronize the
+    // pipeline, start again on a new connection at the next cycle.
+    if (slavePtr->isSerial && (slavePtr->inFlightCount > 0))
+    {
+        slavePtr->failureCount++;
+        slavePtr->inFlightCount = 0;
+        slavePtr->rxLength = 0;
+        FillPipeline(slavePtr);
+        return;
+    }
+
+    Disconnect(slavePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Silent interval after a frame on the bus is over
+ */
+//--------------------------------------------------------------------------------------------------
+static void GapHandler
+(
+    le_timer_Ref_t timerRef             ///< [IN] Timer of the silent interval
+)
+{
+    FillPipeline(le_timer_GetContextPtr(timerRef));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a cycle of a slave with the registers that are due
+ */
+//--------------------------------------------------------------------------------------------------
+static void SlaveTick
+(
+    le_timer_Ref_t timerRef             ///< [IN] Timer of the cycles
+)
+{
+    modbusSlave_t* slavePtr = le_timer_GetContextPtr(timerRef);
+    double now = GetTime();
+    bool isDue = false;
+    int i;
+
+    if (slavePtr->isPolling)
+    {
+        LE_DEBUG("Slave %s: cycle overrun", slavePtr->name);
+        return;
+    }
+
+    for (i = 0; i < slavePtr->registerCount; i++)
+    {
+        modbusRegister_t* registerPtr = &slavePtr->registers[i];
+
+        // Half a tick early is due, so that registers at the period of the tick never slip.
+        if ((registerPtr->period <= 0) ||
+            (registerPtr->nextDue > now + slavePtr->tickPeriod / 2))
+        {
+            continue;
+        }
+
+        registerPtr->nextDue += registerPtr->period;
+
+        if (registerPtr->nextDue < now)
+        {
+            registerPtr->nextDue = now + registerPtr->period;
+        }
+
+        registerPtr->isDue = true;
+        isDue = true;
+    }
+
+    if (!isDue)
+    {
+        return;
+    }
+
+    slavePtr->isPolling = true;
+    slavePtr->cycleStart = now;
+    slavePtr->nextRegister = 0;
+    slavePtr->requestCount = 0;
+    slavePtr->failureCount = 0;
+
+    if (slavePtr->fd < 0)
+    {
+        if ((slavePtr->isSerial ? OpenSerial(slavePtr) : ConnectTcp(slavePtr)) != LE_OK)
+        {
+            slavePtr->failureCount++;
+            EndCycle(slavePtr);
+            return;
+        }
+    }
+
+    FillPipeline(slavePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the timer of a slave at the shortest period of its registers
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateTick
+(
+    modbusSlave_t* slavePtr             ///< [IN] Slave
+)
+{
+    double period = 0;
+    int i;
+
+    for (i = 0; i < slavePtr->registerCount; i++)
+    {
+        double registerPeriod = slavePtr->registers[i].period;
+
+        if ((registerPeriod > 0) && ((period == 0) || (registerPeriod < period)))
+        {
+            period = registerPeriod;
+        }
+    }
+
+    if (period == slavePtr->tickPeriod)
+    {
+        return;
+    }
+
+    slavePtr->tickPeriod = period;
+    le_timer_Stop(slavePtr->tickTimer);
+
+    if (period > 0)
+    {
+        le_timer_SetMsInterval(slavePtr->tickTimer, (uint32_t)(period * 1000));
+        le_timer_Start(slavePtr->tickTimer);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Give the last value of a numeric register, for its first sample
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleNumeric
+(
+    double* valuePtr,                   ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Register
+)
+{
+    const modbusRegister_t* registerPtr = contextPtr;
+
+    if (!registerPtr->hasValue)
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    *valuePtr = registerPtr->value;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Give the last value of a coil or discrete input, for its first sample
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleBoolean
+(
+    bool* valuePtr,                     ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Register
+)
+{
+    const modbusRegister_t* registerPtr = contextPtr;
+
+    if (!registerPtr->hasValue)
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    *valuePtr = (registerPtr->value != 0);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Give the time of the last cycle, for its first sample
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleCycle
+(
+    double* valuePtr,                   ///< [OUT] Value
+    size_t* lengthPtr,                  ///< [INOUT] length
+    void* contextPtr                    ///< [IN] Slave
+)
+{
+    const modbusSlave_t* slavePtr = contextPtr;
+
+    if (slavePtr->cycleMs <= 0)
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    *valuePtr = slavePtr->cycleMs;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the sampling period of a register
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetRegisterPeriod
+(
+    double period,                      ///< [IN] Sampling period, 0 if disabled
+    void* contextPtr                    ///< [IN] Register
+)
+{
+    modbusRegister_t* registerPtr = contextPtr;
+
+    registerPtr->period = period;
+    registerPtr->nextDue = GetTime();
+    UpdateTick(registerPtr->slavePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enable or disable the cycle time sensor. It is pushed at the end of every cycle.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetCyclePeriod
+(
+    double period,                      ///< [IN] Sampling period, 0 if disabled
+    void* contextPtr                    ///< [IN] Slave
+)
+{
+    ((modbusSlave_t*)contextPtr)->isCycleEnabled = (period > 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register a sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t RegisterSensor
+(
+    const char* pathPtr,                ///< [IN]  Path of the sensor
+    const char* unitPtr,                ///< [IN]  Unit
+    double period,                      ///< [IN]  Default sampling period in seconds
+    sensorfwDataType_t type,            ///< [IN]  Data type
+    sensorfwCallbacks_t* callbacksPtr,  ///< [IN]  Callbacks
+    void* contextPtr,                   ///< [IN]  Register or slave
+    void** handlerPtrPtr                ///< [OUT] Sensor handler
+)
+{
+    char jsonDoc[256];
+
+    snprintf(jsonDoc,
+             sizeof(jsonDoc),
+             "{"
+             "\"name\" : \"%s\","
+             "\"plugin\" : \"modbus\","
+             "\"path\" : \"%s\","
+             "\"readOnce\" : false,"
+             "\"period\" : %g,"
+             "\"unit\" : \"%s\""
+             "}",
+             pathPtr,
+             pathPtr,
+             period,
+             unitPtr);
+
+    if (sensorFw_RegisterCallback(jsonDoc, type, callbacksPtr, contextPtr, handlerPtrPtr) != LE_OK)
+    {
+        LE_ERROR("Error registering %s", pathPtr);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the configuration of a register
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_BAD_PARAMETER if the configuration is not valid
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AddRegister
+(
+    le_cfg_IteratorRef_t iteratorRef,   ///< [IN]  Node of the register
+    modbusSlave_t* slavePtr,            ///< [IN]  Slave
+    double defaultPeriod,               ///< [IN]  Default sampling period of the slave
+    modbusRegister_t* registerPtr       ///< [OUT] Register
+)
+{
+    char table[16];
+    char type[16];
+    int address;
+    int i;
+
+    memset(registerPtr, 0, sizeof(*registerPtr));
+    registerPtr->slavePtr = slavePtr;
+
+    if ((le_cfg_GetNodeName(iteratorRef, "", registerPtr->name, sizeof(registerPtr->name))
+         != LE_OK) ||
+        (le_cfg_GetString(iteratorRef, "table", table, sizeof(table), "holding") != LE_OK) ||
+        (le_cfg_GetString(iteratorRef, "type", type, sizeof(type), "u16") != LE_OK) ||
+        (le_cfg_GetString(iteratorRef, "unit", registerPtr->unit, sizeof(registerPtr->unit), "")
+         != LE_OK))
+    {
+        LE_ERROR("Slave %s: configuration of a register too long", slavePtr->name);
+        return LE_BAD_PARAMETER;
+    }
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(Tables); i++)
+    {
+        if (strcmp(Tables[i].namePtr, table) == 0)
+        {
+            registerPtr->function = Tables[i].function;
+            break;
+        }
+    }
+
+    if (registerPtr->function == 0)
+    {
+        LE_ERROR("Slave %s: unknown table '%s' of register %s", slavePtr->name, table,
+                 registerPtr->name);
+        return LE_BAD_PARAMETER;
+    }
+
+    if ((registerPtr->function == FC_READ_COILS) ||
+        (registerPtr->function == FC_READ_DISCRETE_INPUTS))
+    {
+        registerPtr->type = VALUE_BIT;
+        registerPtr->count = 1;
+    }
+    else
+    {
+        for (i = 0; i < NUM_ARRAY_MEMBERS(ValueTypes); i++)
+        {
+            if (strcmp(ValueTypes[i].namePtr, type) == 0)
+            {
+                registerPtr->type = ValueTypes[i].type;
+                registerPtr->count = ValueTypes[i].count;
+                break;
+            }
+        }
+
+        if (registerPtr->count == 0)
+        {
+            LE_ERROR("Slave %s: unknown type '%s' of register %s", slavePtr->name, type,
+                     registerPtr->name);
+            return LE_BAD_PARAMETER;
+        }
+    }
+
+    address = le_cfg_GetInt(iteratorRef, "address", -1);
+
+    if ((address < 0) || (address + registerPtr->count > 0x10000))
+    {
+        LE_ERROR("Slave %s: bad address of register %s", slavePtr->name, registerPtr->name);
+        return LE_BAD_PARAMETER;
+    }
+
+    registerPtr->address = address;
+    registerPtr->isWordSwapped = le_cfg_GetBool(iteratorRef, "wordSwap", false);
+    registerPtr->scale = le_cfg_GetFloat(iteratorRef, "scale", 1);
+    registerPtr->offset = le_cfg_GetFloat(iteratorRef, "offset", 0);
+    registerPtr->defaultPeriod = le_cfg_GetFloat(iteratorRef, "period", defaultPeriod);
+
+    if (registerPtr->defaultPeriod <= 0)
+    {
+        registerPtr->defaultPeriod = defaultPeriod;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare two registers by table and address, the order in which they are coalesced
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareRegisters
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    const modbusRegister_t* aRegisterPtr = aPtr;
+    const modbusRegister_t* bRegisterPtr = bPtr;
+
+    if (aRegisterPtr->function != bRegisterPtr->function)
+    {
+        return aRegisterPtr->function - bRegisterPtr->function;
+    }
+
+    return aRegisterPtr->address - bRegisterPtr->address;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the configuration of a slave and register its sensors
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_BAD_PARAMETER if the configuration is not valid
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AddSlave
+(
+    le_cfg_IteratorRef_t iteratorRef,   ///< [IN]  Node of the slave
+    modbusSlave_t* slavePtr             ///< [OUT] Slave
+)
+{
+    char parity[8];
+    char path[2 * MAX_NAME_LEN + 16];
+    sensorfwCallbacks_t pluginCb;
+    int i;
+
+    memset(slavePtr, 0, sizeof(*slavePtr));
+    slavePtr->fd = -1;
+
+    if ((le_cfg_GetNodeName(iteratorRef, "", slavePtr->name, sizeof(slavePtr->name)) != LE_OK) ||
+        (le_cfg_GetString(iteratorRef, "host", slavePtr->host, sizeof(slavePtr->host), "")
+         != LE_OK) ||
+        (le_cfg_GetString(iteratorRef, "device", slavePtr->device, sizeof(slavePtr->device), "")
+         != LE_OK) ||
+        (le_cfg_GetString(iteratorRef, "parity", parity, sizeof(parity), "even") != LE_OK))
+    {
+        LE_ERROR("Configuration of a slave too long");
+        return LE_BAD_PARAMETER;
+    }
+
+    slavePtr->isSerial = (slavePtr->device[0] != '\0');
+
+    if (!slavePtr->isSerial && (slavePtr->host[0] == '\0'))
+    {
+        LE_ERROR("Slave %s: no host nor device", slavePtr->name);
+        return LE_BAD_PARAMETER;
+    }
+
+    snprintf(slavePtr->port, sizeof(slavePtr->port), "%d",
+             le_cfg_GetInt(iteratorRef, "port", DEFAULT_PORT));
+
+    if (!slavePtr->isSerial && (ResolveHost(slavePtr) != LE_OK))
+    {
+        return LE_FAULT;
+    }
+
+    slavePtr->baud = le_cfg_GetInt(iteratorRef, "baud", DEFAULT_BAUD);
+
+    if (slavePtr->isSerial && (GetSpeed(slavePtr->baud) == B0))
+    {
+        LE_ERROR("Slave %s: unsupported baud rate %" PRIu32, slavePtr->name, slavePtr->baud);
+        return LE_BAD_PARAMETER;
+    }
+
+    slavePtr->parity = (strcmp(parity, "none") == 0) ? 'N' : (strcmp(parity, "odd") == 0) ? 'O' :
+                       'E';
+    slavePtr->stopBits = le_cfg_GetInt(iteratorRef, "stopBits", 1);
+    slavePtr->unitId = le_cfg_GetInt(iteratorRef, "unitId", 1);
+    slavePtr->timeoutMs = le_cfg_GetInt(iteratorRef, "timeoutMs", DEFAULT_TIMEOUT_MS);
+    slavePtr->maxGap = le_cfg_GetInt(iteratorRef, "maxGap", 0);
+    slavePtr->maxBlock = le_cfg_GetInt(iteratorRef, "maxBlock", MAX_READ_BITS);
+    slavePtr->pipeline = le_cfg_GetInt(iteratorRef, "pipeline", DEFAULT_PIPELINE);
+
+    if ((slavePtr->timeoutMs == 0) || (slavePtr->maxBlock == 0))
+    {
+        LE_ERROR("Slave %s: timeoutMs and maxBlock must be positive", slavePtr->name);
+        return LE_BAD_PARAMETER;
+    }
+
+    if ((slavePtr->pipeline < 1) || (slavePtr->pipeline > MAX_PIPELINE))
+    {
+        slavePtr->pipeline = (slavePtr->pipeline < 1) ? 1 : MAX_PIPELINE;
+    }
+
+    // 3.5 characters of 11 bits, fixed to 1.75 ms above 19200 baud.
+    slavePtr->frameGapMs = (slavePtr->baud > 19200) ? 2 : (38500 + slavePtr->baud - 1) /
+                                                          slavePtr->baud;
+
+    double period = le_cfg_GetFloat(iteratorRef, "period", DEFAULT_PERIOD);
+
+    if (period <= 0)
+    {
+        period = DEFAULT_PERIOD;
+    }
+
+    le_cfg_GoToNode(iteratorRef, "registers");
+
+    if (le_cfg_GoToFirstChild(iteratorRef) != LE_OK)
+    {
+        LE_WARN("Slave %s: no register configured", slavePtr->name);
+        le_cfg_GoToParent(iteratorRef);
+        return LE_BAD_PARAMETER;
+    }
+
+    do
+    {
+        if (slavePtr->registerCount >= MAX_REGISTERS)
+        {
+            LE_ERROR("Slave %s: too many registers, at most %d", slavePtr->name, MAX_REGISTERS);
+            break;
+        }
+
+        if (AddRegister(iteratorRef, slavePtr, period,
+                        &slavePtr->registers[slavePtr->registerCount]) == LE_OK)
+        {
+            slavePtr->registerCount++;
+        }
+    }
+    while (le_cfg_GoToNextSibling(iteratorRef) == LE_OK);
+
+    le_cfg_GoToParent(iteratorRef);
+    le_cfg_GoToParent(iteratorRef);
+
+    // Sorted before registration, the registers are the context of their sensors.
+    qsort(slavePtr->registers, slavePtr->registerCount, sizeof(modbusRegister_t),
+          CompareRegisters);
+
+    slavePtr->tickTimer = le_timer_Create(slavePtr->name);
+    le_timer_SetRepeat(slavePtr->tickTimer, 0);
+    le_timer_SetHandler(slavePtr->tickTimer, SlaveTick);
+    le_timer_SetContextPtr(slavePtr->tickTimer, slavePtr);
+
+    slavePtr->timeoutTimer = le_timer_Create(slavePtr->name);
+    le_timer_SetMsInterval(slavePtr->timeoutTimer, slavePtr->timeoutMs);
+    le_timer_SetHandler(slavePtr->timeoutTimer, TimeoutHandler);
+    le_timer_SetContextPtr(slavePtr->timeoutTimer, slavePtr);
+
+    slavePtr->gapTimer = le_timer_Create(slavePtr->name);
+    le_timer_SetMsInterval(slavePtr->gapTimer, slavePtr->frameGapMs);
+    le_timer_SetHandler(slavePtr->gapTimer, GapHandler);
+    le_timer_SetContextPtr(slavePtr->gapTimer, slavePtr);
+
+    for (i = 0; i < slavePtr->registerCount; i++)
+    {
+        modbusRegister_t* registerPtr = &slavePtr->registers[i];
+        bool isBit = (registerPtr->type == VALUE_BIT);
+
+        memset(&pluginCb, 0, sizeof(pluginCb));
+        pluginCb.periodCb = SetRegisterPeriod;
+
+        if (isBit)
+        {
+            pluginCb.sample.boolCb = SampleBoolean;
+        }
+        else
+        {
+            pluginCb.sample.numericCb = SampleNumeric;
+        }
+
+        snprintf(path, sizeof(path), "modbus/%s/%s", slavePtr->name, registerPtr->name);
+
+        RegisterSensor(path, registerPtr->unit, registerPtr->defaultPeriod,
+                       isBit ? SF_CB_BOOLEAN : SF_CB_NUMERIC, &pluginCb, registerPtr,
+                       &registerPtr->handlerPtr);
+    }
+
+    memset(&pluginCb, 0, sizeof(pluginCb));
+    pluginCb.sample.numericCb = SampleCycle;
+    pluginCb.periodCb = SetCyclePeriod;
+    snprintf(path, sizeof(path), "modbus/%s/cycle", slavePtr->name);
+
+    RegisterSensor(path, "ms", period, SF_CB_NUMERIC, &pluginCb, slavePtr,
+                   &slavePtr->cycleHandlerPtr);
+
+    if (slavePtr->isSerial)
+    {
+        LE_INFO("Slave %s: unit %u on %s at %" PRIu32 " baud, %d registers", slavePtr->name,
+                slavePtr->unitId, slavePtr->device, slavePtr->baud, slavePtr->registerCount);
+    }
+    else
+    {
+        LE_INFO("Slave %s: unit %u at %s:%s, %d registers, %d requests in flight",
+                slavePtr->name, slavePtr->unitId, slavePtr->host, slavePtr->port,
+                slavePtr->registerCount, slavePtr->pipeline);
+    }
+
+    return LE_OK;
+}
+
+COMPONENT_INIT
+{
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(CONFIG_NODE);
+
+    if (!le_cfg_GetBool(iteratorRef, "enable", false))
+    {
+        LE_INFO("Modbus plugin disabled");
+        le_cfg_CancelTxn(iteratorRef);
+        return;
+    }
+
+    LE_INFO("Start Modbus plugin");
+
+    le_cfg_GoToNode(iteratorRef, "slaves");
+
+    if (le_cfg_GoToFirstChild(iteratorRef) != LE_OK)
+    {
+        LE_WARN("No Modbus slave configured");
+        le_cfg_CancelTxn(iteratorRef);
+        return;
+    }
+
+    do
+    {
+        if (SlaveCount >= MAX_SLAVES)
+        {
+            LE_ERROR("Too many Modbus slaves, at most %d", MAX_SLAVES);
+            break;
+        }
+
+        if (AddSlave(iteratorRef, &Slaves[SlaveCount]) == LE_OK)
+        {
+            SlaveCount++;
+        }
+    }
+    while (le_cfg_GoToNextSibling(iteratorRef) == LE_OK);
+
+    le_cfg_CancelTxn(iteratorRef);
+
+    LE_INFO("%d Modbus slaves polled", SlaveCount);
+}
@@ -0,0 +1,374 @@
+//--------------------------------------------------------------------------------------------------
+/** @file budget.c
+ *
+ * Per-plugin resource accounting and budget enforcement.
+ *
+ * Counters are cumulative and updated with relaxed atomics, since callbacks can run on plugin
+ * threads. The period scale is only written by the window evaluation, on the main thread, but is
+ * stored and read atomically as well so that it can be read from any thread.
+ *
+ * Every SENSOR_BUDGET_WINDOW seconds the usage over the elapsed window is compared with the budget
+ * of each plugin: the period scale is multiplied so that the plugin would use BUDGET_TARGET of its
+ * budget, when it is over budget or when it uses less than half of it while being throttled.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "budget.h"
+#include "config.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Node of the configuration tree under which the budgets are read
+ */
+//--------------------------------------------------------------------------------------------------
+#define     BUDGET_ROOT_NODE                "budgets"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Share of the budget targeted when the period scale is adjusted
+ */
+//--------------------------------------------------------------------------------------------------
+#define     BUDGET_TARGET                   0.8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Accounting of a plugin
+ */
+//--------------------------------------------------------------------------------------------------
+struct budget_Plugin
+{
+    char name[32];                              ///< Name of the plugin
+    uint64_t busyTimeUs;                        ///< Time spent in callbacks and pushes
+    uint32_t pushCount;                         ///< Number of pushes
+    int64_t memoryBytes;                        ///< Memory held by the framework for the plugin
+    uint64_t windowBusyTimeUs;                  ///< busyTimeUs at the start of the window
+    uint32_t windowPushCount;                   ///< pushCount at the start of the window
+    double cpuPercent;                          ///< Usage over the last window
+    double sampleRate;                          ///< Pushes per second over the last window
+    double cpuBudget;                           ///< Percent of one CPU (0 if none)
+    double rateBudget;                          ///< Pushes per second (0 if none)
+    double periodScale;                         ///< Factor applied to sensor periods
+    uint32_t throttleCount;                     ///< Number of windows the scale was increased
+};
+
+static budget_Plugin_t Plugins[SENSOR_BUDGET_PLUGIN_COUNT];
+static int PluginCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called when a period scale changes, and start of the current window
+ */
+//--------------------------------------------------------------------------------------------------
+static budget_ScaleFunc_t ScaleFunc;
+static le_clk_Time_t WindowStart;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the budget of a plugin from the configuration tree
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadBudget
+(
+    budget_Plugin_t* pluginPtr                  ///< [IN] Plugin
+)
+{
+    char nodePath[sizeof(BUDGET_ROOT_NODE) + sizeof(pluginPtr->name) + 1];
+
+    snprintf(nodePath, sizeof(nodePath), "%s/%s", BUDGET_ROOT_NODE, pluginPtr->name);
+
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(nodePath);
+
+    pluginPtr->cpuBudget = le_cfg_GetFloat(iteratorRef, "cpu", 0);
+    pluginPtr->rateBudget = le_cfg_GetFloat(iteratorRef, "rate", 0);
+
+    le_cfg_CancelTxn(iteratorRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the new period scale of a plugin from its usage over the last window
+ *
+ * @return:
+ *      - New period scale
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetNewScale
+(
+    const budget_Plugin_t* pluginPtr            ///< [IN] Plugin
+)
+{
+    double ratio = 0;
+
+    if ((pluginPtr->cpuBudget <= 0) && (pluginPtr->rateBudget <= 0))
+    {
+        return 1;
+    }
+
+    if (pluginPtr->cpuBudget > 0)
+    {
+        ratio = pluginPtr->cpuPercent / pluginPtr->cpuBudget;
+    }
+
+    if ((pluginPtr->rateBudget > 0) && (pluginPtr->sampleRate / pluginPtr->rateBudget > ratio))
+    {
+        ratio = pluginPtr->sampleRate / pluginPtr->rateBudget;
+    }
+
+    // Within budget, and not throttled more than needed.
+    if ((ratio <= 1) && ((ratio >= 0.5) || (pluginPtr->periodScale == 1)))
+    {
+        return pluginPtr->periodScale;
+    }
+
+    double scale = pluginPtr->periodScale * ratio / BUDGET_TARGET;
+
+    if (scale < 1)
+    {
+        scale = 1;
+    }
+    else if (scale > SENSOR_BUDGET_MAX_SCALE)
+    {
+        scale = SENSOR_BUDGET_MAX_SCALE;
+    }
+
+    return scale;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Evaluate the usage of every plugin over the last window and adjust the period scales
+ */
+//--------------------------------------------------------------------------------------------------
+static void WindowHandler
+(
+    le_timer_Ref_t timerRef                     ///< [IN] Window timer
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+    le_clk_Time_t elapsed = le_clk_Sub(now, WindowStart);
+    double windowSec = (double)elapsed.sec + ((double)elapsed.usec / 1000000.0);
+    int i;
+
+    WindowStart = now;
+
+    if (windowSec <= 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < PluginCount; i++)
+    {
+        budget_Plugin_t* pluginPtr = &Plugins[i];
+        uint64_t busyTimeUs = __atomic_load_n(&pluginPtr->busyTimeUs, __ATOMIC_RELAXED);
+        uint32_t pushCount = __atomic_load_n(&pluginPtr->pushCount, __ATOMIC_RELAXED);
+
+        pluginPtr->cpuPercent = (busyTimeUs - pluginPtr->windowBusyTimeUs) / (windowSec * 10000.0);
+        pluginPtr->sampleRate = (pushCount - pluginPtr->windowPushCount) / windowSec;
+        pluginPtr->windowBusyTimeUs = busyTimeUs;
+        pluginPtr->windowPushCount = pushCount;
+
+        // Budgets can be changed at runtime.
+        ReadBudget(pluginPtr);
+
+        double scale = GetNewScale(pluginPtr);
+        double periodScale = budget_GetPeriodScale(pluginPtr);
+
+        if (scale == periodScale)
+        {
+            continue;
+        }
+
+        if (scale > periodScale)
+        {
+            LE_WARN("Plugin %s over budget (%.2f%% CPU, %.1f samples/s), periods x%.2f",
+                    pluginPtr->name, pluginPtr->cpuPercent, pluginPtr->sampleRate, scale);
+            pluginPtr->throttleCount++;
+        }
+        else
+        {
+            LE_INFO("Plugin %s periods x%.2f", pluginPtr->name, scale);
+        }
+
+        __atomic_store(&pluginPtr->periodScale, &scale, __ATOMIC_RELAXED);
+        ScaleFunc(pluginPtr, scale);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start evaluating the budgets every SENSOR_BUDGET_WINDOW seconds
+ */
+//--------------------------------------------------------------------------------------------------
+void budget_Init
+(
+    budget_ScaleFunc_t scaleFunc                ///< [IN] Called when a period scale changes
+)
+{
+    ScaleFunc = scaleFunc;
+    WindowStart = le_clk_GetRelativeTime();
+
+    le_timer_Ref_t timerRef = le_timer_Create("sensorBudget");
+    le_timer_SetMsInterval(timerRef, SENSOR_BUDGET_WINDOW * 1000);
+    le_timer_SetRepeat(timerRef, 0);
+    le_timer_SetHandler(timerRef, WindowHandler);
+    le_timer_Start(timerRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the accounting of a plugin, creating it on first use
+ *
+ * @return:
+ *      - Accounting of the plugin, NULL if too many plugins are accounted
+ */
+//--------------------------------------------------------------------------------------------------
+budget_Plugin_t* budget_GetPlugin
+(
+    const char* namePtr                         ///< [IN] Name of the plugin ("" if unknown)
+)
+{
+    int i;
+
+    if (namePtr[0] == '\0')
+    {
+        namePtr = "unknown";
+    }
+
+    for (i = 0; i < PluginCount; i++)
+    {
+        if (strcmp(Plugins[i].name, namePtr) == 0)
+        {
+            return &Plugins[i];
+        }
+    }
+
+    if (PluginCount >= SENSOR_BUDGET_PLUGIN_COUNT)
+    {
+        LE_WARN("Too many plugins, %s not accounted", namePtr);
+        return NULL;
+    }
+
+    budget_Plugin_t* pluginPtr = &Plugins[PluginCount];
+
+    memset(pluginPtr, 0, sizeof(*pluginPtr));
+    le_utf8_Copy(pluginPtr->name, namePtr, sizeof(pluginPtr->name), NULL);
+    pluginPtr->periodScale = 1;
+    ReadBudget(pluginPtr);
+
+    PluginCount++;
+
+    return pluginPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the factor applied to the periods of the sensors of a plugin. Can be called from any thread.
+ *
+ * @return:
+ *      - Factor, 1 if the plugin is within budget or not accounted
+ */
+//--------------------------------------------------------------------------------------------------
+double budget_GetPeriodScale
+(
+    const budget_Plugin_t* pluginPtr            ///< [IN] Plugin (or NULL)
+)
+{
+    double periodScale = 1;
+
+    if (pluginPtr != NULL)
+    {
+        __atomic_load(&pluginPtr->periodScale, &periodScale, __ATOMIC_RELAXED);
+    }
+
+    return periodScale;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Account the time spent in a sample callback. Can be called from any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void budget_RecordCallback
+(
+    budget_Plugin_t* pluginPtr,                 ///< [IN] Plugin (or NULL)
+    uint32_t elapsedUs                          ///< [IN] Time spent
+)
+{
+    if (pluginPtr != NULL)
+    {
+        __atomic_fetch_add(&pluginPtr->busyTimeUs, elapsedUs, __ATOMIC_RELAXED);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Account a push to the Data Hub. Can be called from any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void budget_RecordPush
+(
+    budget_Plugin_t* pluginPtr,                 ///< [IN] Plugin (or NULL)
+    uint32_t elapsedUs                          ///< [IN] Time spent
+)
+{
+    if (pluginPtr != NULL)
+    {
+        __atomic_fetch_add(&pluginPtr->busyTimeUs, elapsedUs, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&pluginPtr->pushCount, 1, __ATOMIC_RELAXED);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Account memory allocated (positive) or released (negative) on behalf of a plugin. Can be called
+ * from any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void budget_AddMemory
+(
+    budget_Plugin_t* pluginPtr,                 ///< [IN] Plugin (or NULL)
+    ssize_t bytes                               ///< [IN] Bytes
+)
+{
+    if (pluginPtr != NULL)
+    {
+        __atomic_fetch_add(&pluginPtr->memoryBytes, bytes, __ATOMIC_RELAXED);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Provide the budget state of the plugin at an index to the metrics endpoint
+ *
+ * @return:
+ *      - true if the plugin exists
+ */
+//--------------------------------------------------------------------------------------------------
+bool budget_GetMetrics
+(
+    uint32_t index,                             ///< [IN]  Index of the plugin
+    metrics_Budget_t* budgetPtr                 ///< [OUT] Budget state
+)
+{
+    if (index >= PluginCount)
+    {
+        return false;
+    }
+
+    const budget_Plugin_t* pluginPtr = &Plugins[index];
+
+    budgetPtr->pluginPtr = pluginPtr->name;
+    budgetPtr->cpuPercent = pluginPtr->cpuPercent;
+    budgetPtr->cpuBudget = pluginPtr->cpuBudget;
+    budgetPtr->sampleRate = pluginPtr->sampleRate;
+    budgetPtr->rateBudget = pluginPtr->rateBudget;
+    budgetPtr->memoryBytes = __atomic_load_n(&pluginPtr->memoryBytes, __ATOMIC_RELAXED);
+    budgetPtr->periodScale = budget_GetPeriodScale(pluginPtr);
+    budgetPtr->throttleCount = pluginPtr->throttleCount;
+
+    return true;
+}
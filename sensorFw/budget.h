@@ -0,0 +1,120 @@
+//--------------------------------------------------------------------------------------------------
+/** @file budget.h
+ *
+ * Per-plugin accounting of the time spent in sample callbacks and pushes, of the number of pushes
+ * and of the memory held by the framework, with optional budgets read from the configuration tree
+ * under budgets/<plugin name>/. A plugin over budget has the periods of its sensors stretched
+ * until it fits, and relaxed again once it uses less than half of it.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_BUDGET_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_BUDGET_INCLUDE_GUARD
+
+#include "metrics.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Accounting of a plugin
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct budget_Plugin budget_Plugin_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called when the period scale of a plugin changes
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*budget_ScaleFunc_t)
+(
+    budget_Plugin_t* pluginPtr,                 ///< [IN] Plugin
+    double periodScale                          ///< [IN] New factor applied to sensor periods
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start evaluating the budgets every SENSOR_BUDGET_WINDOW seconds
+ */
+//--------------------------------------------------------------------------------------------------
+void budget_Init
+(
+    budget_ScaleFunc_t scaleFunc                ///< [IN] Called when a period scale changes
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the accounting of a plugin, creating it on first use
+ *
+ * @return:
+ *      - Accounting of the plugin, NULL if too many plugins are accounted
+ */
+//--------------------------------------------------------------------------------------------------
+budget_Plugin_t* budget_GetPlugin
+(
+    const char* namePtr                         ///< [IN] Name of the plugin ("" if unknown)
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the factor applied to the periods of the sensors of a plugin. Can be called from any thread.
+ *
+ * @return:
+ *      - Factor, 1 if the plugin is within budget or not accounted
+ */
+//--------------------------------------------------------------------------------------------------
+double budget_GetPeriodScale
+(
+    const budget_Plugin_t* pluginPtr            ///< [IN] Plugin (or NULL)
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Account the time spent in a sample callback. Can be called from any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void budget_RecordCallback
+(
+    budget_Plugin_t* pluginPtr,                 ///< [IN] Plugin (or NULL)
+    uint32_t elapsedUs                          ///< [IN] Time spent
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Account a push to the Data Hub. Can be called from any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void budget_RecordPush
+(
+    budget_Plugin_t* pluginPtr,                 ///< [IN] Plugin (or NULL)
+    uint32_t elapsedUs                          ///< [IN] Time spent
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Account memory allocated (positive) or released (negative) on behalf of a plugin. Can be called
+ * from any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void budget_AddMemory
+(
+    budget_Plugin_t* pluginPtr,                 ///< [IN] Plugin (or NULL)
+    ssize_t bytes                               ///< [IN] Bytes
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Provide the budget state of the plugin at an index to the metrics endpoint
+ *
+ * @return:
+ *      - true if the plugin exists
+ */
+//--------------------------------------------------------------------------------------------------
+bool budget_GetMetrics
+(
+    uint32_t index,                             ///< [IN]  Index of the plugin
+    metrics_Budget_t* budgetPtr                 ///< [OUT] Budget state
+);
+
+#endif /* LEGATO_SENSOR_FW_BUDGET_INCLUDE_GUARD */
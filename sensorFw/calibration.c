@@ -0,0 +1,474 @@
+//--------------------------------------------------------------------------------------------------
+/** @file calibration.c
+ *
+ * Per-sensor calibration of numeric samples, and of the numbers of JSON samples. Calibrations are
+ * applied to blocks of samples so that the inner loops run over contiguous arrays without branches.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <ctype.h>
+#include <math.h>
+#include "interfaces.h"
+#include "calibration.h"
+#include "json.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of samples processed at once by the polynomial stage
+ */
+//--------------------------------------------------------------------------------------------------
+#define     CALIBRATION_BLOCK_SIZE          16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of an extraction spec
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_SPEC_LEN                    32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read an array of numbers from a JSON document
+ *
+ * @return:
+ *      - LE_OK on success (including when the array is missing, count is then 0)
+ *      - LE_FORMAT_ERROR if an element is not a number
+ *      - LE_OVERFLOW if the array has more than maxCount elements
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadNumberArray
+(
+    const char* jsonStringPtr,          ///< [IN]  JSON document
+    const char* memberPtr,              ///< [IN]  Name of the array member
+    double* arrayPtr,                   ///< [OUT] Values
+    size_t maxCount,                    ///< [IN]  Maximum number of values
+    size_t* countPtr                    ///< [OUT] Number of values read
+)
+{
+    char spec[MAX_SPEC_LEN];
+    char extractedData[64];
+    json_DataType_t extractedType;
+    size_t i;
+
+    for (i = 0; ; i++)
+    {
+        snprintf(spec, sizeof(spec), "%s[%zu]", memberPtr, i);
+
+        if (json_Extract(extractedData,
+                         sizeof(extractedData),
+                         jsonStringPtr,
+                         spec,
+                         &extractedType) != LE_OK)
+        {
+            break;
+        }
+
+        if (extractedType != JSON_TYPE_NUMBER)
+        {
+            LE_ERROR("'%s' is not a number", spec);
+            return LE_FORMAT_ERROR;
+        }
+
+        if (i >= maxCount)
+        {
+            LE_ERROR("Too many elements in '%s' (max %zu)", memberPtr, maxCount);
+            return LE_OVERFLOW;
+        }
+
+        arrayPtr[i] = json_ConvertToNumber(extractedData);
+    }
+
+    *countPtr = i;
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a calibration descriptor.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FORMAT_ERROR if the descriptor is not valid
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t calibration_Parse
+(
+    const char* jsonStringPtr,          ///< [IN]  Calibration descriptor in JSON format
+    calibration_t* calibrationPtr       ///< [OUT] Parsed descriptor
+)
+{
+    char extractedData[IO_MAX_RESOURCE_PATH_LEN];
+    json_DataType_t extractedType;
+    size_t i;
+
+    memset(calibrationPtr, 0, sizeof(calibration_t));
+
+    if ((json_Extract(extractedData,
+                      sizeof(extractedData),
+                      jsonStringPtr,
+                      "type",
+                      &extractedType) != LE_OK) ||
+        (extractedType != JSON_TYPE_STRING))
+    {
+        LE_ERROR("Calibration type missing");
+        return LE_FORMAT_ERROR;
+    }
+
+    if (strcmp(extractedData, "none") == 0)
+    {
+        calibrationPtr->type = CALIBRATION_NONE;
+        return LE_OK;
+    }
+    else if (strcmp(extractedData, "polynomial") == 0)
+    {
+        calibrationPtr->type = CALIBRATION_POLYNOMIAL;
+    }
+    else if ((strcmp(extractedData, "piecewise") == 0) || (strcmp(extractedData, "twoPoint") == 0))
+    {
+        calibrationPtr->type = CALIBRATION_PIECEWISE;
+    }
+    else if (strcmp(extractedData, "tempComp") == 0)
+    {
+        calibrationPtr->type = CALIBRATION_TEMP_COMP;
+    }
+    else
+    {
+        LE_ERROR("Unknown calibration type '%s'", extractedData);
+        return LE_FORMAT_ERROR;
+    }
+
+    if (ReadNumberArray(jsonStringPtr,
+                        "coeffs",
+                        calibrationPtr->coeffs,
+                        CALIBRATION_MAX_COEFFS,
+                        &calibrationPtr->coeffCount) != LE_OK)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    if (calibrationPtr->type == CALIBRATION_PIECEWISE)
+    {
+        size_t yCount;
+
+        if ((ReadNumberArray(jsonStringPtr,
+                             "x",
+                             calibrationPtr->x,
+                             CALIBRATION_MAX_POINTS,
+                             &calibrationPtr->pointCount) != LE_OK) ||
+            (ReadNumberArray(jsonStringPtr,
+                             "y",
+                             calibrationPtr->y,
+                             CALIBRATION_MAX_POINTS,
+                             &yCount) != LE_OK))
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        if ((calibrationPtr->pointCount < 2) || (calibrationPtr->pointCount != yCount))
+        {
+            LE_ERROR("Piecewise calibration needs at least 2 (x, y) points");
+            return LE_FORMAT_ERROR;
+        }
+
+        for (i = 1; i < calibrationPtr->pointCount; i++)
+        {
+            if (calibrationPtr->x[i] <= calibrationPtr->x[i - 1])
+            {
+                LE_ERROR("Piecewise calibration points must be sorted by ascending x");
+                return LE_FORMAT_ERROR;
+            }
+        }
+    }
+    else if (calibrationPtr->type == CALIBRATION_TEMP_COMP)
+    {
+        if ((json_Extract(calibrationPtr->refPath,
+                          sizeof(calibrationPtr->refPath),
+                          jsonStringPtr,
+                          "ref",
+                          &extractedType) != LE_OK) ||
+            (extractedType != JSON_TYPE_STRING))
+        {
+            LE_ERROR("Temperature compensation needs a reference sensor path");
+            return LE_FORMAT_ERROR;
+        }
+
+        if (json_Extract(extractedData,
+                         sizeof(extractedData),
+                         jsonStringPtr,
+                         "tRef",
+                         &extractedType) == LE_OK)
+        {
+            calibrationPtr->tRef = json_ConvertToNumber(extractedData);
+        }
+
+        if (ReadNumberArray(jsonStringPtr,
+                            "tCoeffs",
+                            calibrationPtr->tCoeffs,
+                            CALIBRATION_MAX_COEFFS,
+                            &calibrationPtr->tCoeffCount) != LE_OK)
+        {
+            return LE_FORMAT_ERROR;
+        }
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Evaluate a polynomial in place (Horner's scheme over blocks of samples)
+ */
+//--------------------------------------------------------------------------------------------------
+static void ApplyPolynomial
+(
+    const double* coeffsPtr,            ///< [IN] Coefficients, lowest order first
+    size_t coeffCount,                  ///< [IN] Number of coefficients (0: identity)
+    double* valuesPtr,                  ///< [INOUT] Samples
+    size_t count                        ///< [IN] Number of samples
+)
+{
+    double acc[CALIBRATION_BLOCK_SIZE];
+    size_t start, i, k, n;
+
+    if (coeffCount == 0)
+    {
+        return;
+    }
+
+    for (start = 0; start < count; start += CALIBRATION_BLOCK_SIZE)
+    {
+        double* x = valuesPtr + start;
+        n = count - start;
+
+        if (n > CALIBRATION_BLOCK_SIZE)
+        {
+            n = CALIBRATION_BLOCK_SIZE;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            acc[i] = coeffsPtr[coeffCount - 1];
+        }
+
+        for (k = coeffCount - 1; k-- > 0; )
+        {
+            for (i = 0; i < n; i++)
+            {
+                acc[i] = (acc[i] * x[i]) + coeffsPtr[k];
+            }
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            x[i] = acc[i];
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Interpolate in place between calibration points, extrapolating from the end segments
+ */
+//--------------------------------------------------------------------------------------------------
+static void ApplyPiecewise
+(
+    const calibration_t* calibrationPtr,    ///< [IN] Calibration descriptor
+    double* valuesPtr,                      ///< [INOUT] Samples
+    size_t count                            ///< [IN] Number of samples
+)
+{
+    const double* x = calibrationPtr->x;
+    const double* y = calibrationPtr->y;
+    size_t last = calibrationPtr->pointCount - 1;
+    size_t i, seg;
+
+    for (i = 0; i < count; i++)
+    {
+        double v = valuesPtr[i];
+
+        for (seg = 0; (seg < last - 1) && (v > x[seg + 1]); seg++)
+        {
+        }
+
+        valuesPtr[i] = y[seg] + ((v - x[seg]) * (y[seg + 1] - y[seg]) / (x[seg + 1] - x[seg]));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Apply a calibration in place to a block of samples
+ */
+//--------------------------------------------------------------------------------------------------
+void calibration_Apply
+(
+    const calibration_t* calibrationPtr,    ///< [IN] Calibration descriptor
+    double temperature,                     ///< [IN] Reference temperature (NAN if not available)
+    double* valuesPtr,                      ///< [INOUT] Samples
+    size_t count                            ///< [IN] Number of samples
+)
+{
+    size_t i;
+
+    switch (calibrationPtr->type)
+    {
+        case CALIBRATION_POLYNOMIAL:
+            ApplyPolynomial(calibrationPtr->coeffs, calibrationPtr->coeffCount, valuesPtr, count);
+            break;
+
+        case CALIBRATION_PIECEWISE:
+            ApplyPiecewise(calibrationPtr, valuesPtr, count);
+            break;
+
+        case CALIBRATION_TEMP_COMP:
+            ApplyPolynomial(calibrationPtr->coeffs, calibrationPtr->coeffCount, valuesPtr, count);
+
+            if (!isnan(temperature))
+            {
+                // The correction only depends on the temperature, compute it once per block.
+                double delta = temperature - calibrationPtr->tRef;
+                double power = delta;
+                double correction = 0;
+
+                for (i = 0; i < calibrationPtr->tCoeffCount; i++)
+                {
+                    correction += calibrationPtr->tCoeffs[i] * power;
+                    power *= delta;
+                }
+
+                for (i = 0; i < count; i++)
+                {
+                    valuesPtr[i] += correction;
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Apply a calibration to every number of a JSON sample. The numbers are gathered in a block so
+ * that they are calibrated at once, then written back in place of the original ones.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the sample has too many numbers or the output buffer is too small
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t calibration_ApplyJson
+(
+    const calibration_t* calibrationPtr,    ///< [IN]  Calibration descriptor
+    double temperature,                     ///< [IN]  Reference temperature (NAN if not available)
+    const char* docPtr,                     ///< [IN]  JSON sample
+    char* outPtr,                           ///< [OUT] Calibrated JSON sample
+    size_t outSize                          ///< [IN]  Buffer size
+)
+{
+    double values[CALIBRATION_MAX_JSON_VALUES];
+    const char* startPtr[CALIBRATION_MAX_JSON_VALUES];
+    const char* endPtr[CALIBRATION_MAX_JSON_VALUES];
+    const char* cursorPtr = docPtr;
+    bool isInString = false;
+    size_t count = 0;
+    size_t used = 0;
+    size_t i;
+    int length;
+
+    // Find the numbers, skipping member names and string values.
+    while (*cursorPtr != '\0')
+    {
+        if (isInString)
+        {
+            if ((*cursorPtr == '\\') && (cursorPtr[1] != '\0'))
+            {
+                cursorPtr++;
+            }
+            else if (*cursorPtr == '"')
+            {
+                isInString = false;
+            }
+
+            cursorPtr++;
+        }
+        else if (*cursorPtr == '"')
+        {
+            isInString = true;
+            cursorPtr++;
+        }
+        else if ((*cursorPtr == '-') || isdigit((unsigned char)*cursorPtr))
+        {
+            char* numberEndPtr;
+
+            if (count >= CALIBRATION_MAX_JSON_VALUES)
+            {
+                return LE_OVERFLOW;
+            }
+
+            values[count] = strtod(cursorPtr, &numberEndPtr);
+
+            if (numberEndPtr == cursorPtr)
+            {
+                cursorPtr++;
+                continue;
+            }
+
+            startPtr[count] = cursorPtr;
+            endPtr[count] = numberEndPtr;
+            count++;
+            cursorPtr = numberEndPtr;
+        }
+        else
+        {
+            cursorPtr++;
+        }
+    }
+
+    calibration_Apply(calibrationPtr, temperature, values, count);
+
+    // Copy the document, replacing the numbers.
+    cursorPtr = docPtr;
+
+    for (i = 0; i <= count; i++)
+    {
+        size_t copyLength = ((i < count) ? startPtr[i] : (docPtr + strlen(docPtr))) - cursorPtr;
+
+        if (used + copyLength >= outSize)
+        {
+            return LE_OVERFLOW;
+        }
+
+        memcpy(outPtr + used, cursorPtr, copyLength);
+        used += copyLength;
+
+        if (i == count)
+        {
+            break;
+        }
+
+        // JSON has no representation for NaN nor infinity.
+        if (isfinite(values[i]))
+        {
+            length = snprintf(outPtr + used, outSize - used, "%.10g", values[i]);
+        }
+        else
+        {
+            length = snprintf(outPtr + used, outSize - used, "null");
+        }
+
+        if ((length < 0) || ((size_t)length >= outSize - used))
+        {
+            return LE_OVERFLOW;
+        }
+
+        used += length;
+        cursorPtr = endPtr[i];
+    }
+
+    outPtr[used] = '\0';
+    return LE_OK;
+}
@@ -0,0 +1,122 @@
+//--------------------------------------------------------------------------------------------------
+/** @file calibration.h
+ *
+ * Per-sensor calibration of numeric samples: polynomial, piecewise-linear (including two-point)
+ * and temperature-compensated from another sensor.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_CALIBRATION_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_CALIBRATION_INCLUDE_GUARD
+
+#include "interfaces.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of polynomial coefficients
+ */
+//--------------------------------------------------------------------------------------------------
+#define CALIBRATION_MAX_COEFFS          8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of points of a piecewise-linear calibration
+ */
+//--------------------------------------------------------------------------------------------------
+#define CALIBRATION_MAX_POINTS          16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of numbers calibrated in a JSON sample
+ */
+//--------------------------------------------------------------------------------------------------
+#define CALIBRATION_MAX_JSON_VALUES     64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Calibration types
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    CALIBRATION_NONE,
+    CALIBRATION_POLYNOMIAL,         ///< value = sum(coeffs[i] * raw^i)
+    CALIBRATION_PIECEWISE,          ///< Linear interpolation between (x[i], y[i]) points
+    CALIBRATION_TEMP_COMP           ///< Polynomial + sum(tCoeffs[i] * (T - tRef)^(i+1))
+}
+calibration_Type_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Calibration descriptor
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    calibration_Type_t type;                        ///< Calibration type
+    size_t coeffCount;                              ///< Number of polynomial coefficients
+    double coeffs[CALIBRATION_MAX_COEFFS];          ///< Polynomial coefficients, lowest order first
+    size_t pointCount;                              ///< Number of piecewise-linear points
+    double x[CALIBRATION_MAX_POINTS];               ///< Uncalibrated values, ascending
+    double y[CALIBRATION_MAX_POINTS];               ///< Calibrated values
+    char refPath[IO_MAX_RESOURCE_PATH_LEN];         ///< Path of the temperature sensor
+    double tRef;                                    ///< Reference temperature
+    size_t tCoeffCount;                             ///< Number of temperature coefficients
+    double tCoeffs[CALIBRATION_MAX_COEFFS];         ///< Temperature coefficients, first order first
+}
+calibration_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a calibration descriptor, e.g.
+ *  {"type": "polynomial", "coeffs": [0.5, 1.02]}
+ *  {"type": "twoPoint", "x": [102, 3890], "y": [0, 100]}
+ *  {"type": "piecewise", "x": [0, 10, 20], "y": [0.1, 10.4, 19.8]}
+ *  {"type": "tempComp", "coeffs": [0, 1], "ref": "bmp280/temp", "tRef": 25000, "tCoeffs": [1e-4]}
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FORMAT_ERROR if the descriptor is not valid
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t calibration_Parse
+(
+    const char* jsonStringPtr,          ///< [IN]  Calibration descriptor in JSON format
+    calibration_t* calibrationPtr       ///< [OUT] Parsed descriptor
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Apply a calibration in place to a block of samples
+ */
+//--------------------------------------------------------------------------------------------------
+void calibration_Apply
+(
+    const calibration_t* calibrationPtr,    ///< [IN] Calibration descriptor
+    double temperature,                     ///< [IN] Reference temperature (NAN if not available)
+    double* valuesPtr,                      ///< [INOUT] Samples
+    size_t count                            ///< [IN] Number of samples
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Apply a calibration to every number of a JSON sample, e.g. the axes of {"x": 1, "y": 2, "z": 3}
+ * or the elements of an array. Member names and other values are copied as is.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the sample has too many numbers or the output buffer is too small
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t calibration_ApplyJson
+(
+    const calibration_t* calibrationPtr,    ///< [IN]  Calibration descriptor
+    double temperature,                     ///< [IN]  Reference temperature (NAN if not available)
+    const char* docPtr,                     ///< [IN]  JSON sample
+    char* outPtr,                           ///< [OUT] Calibrated JSON sample
+    size_t outSize                          ///< [IN]  Buffer size
+);
+
+#endif /* LEGATO_SENSOR_FW_CALIBRATION_INCLUDE_GUARD */
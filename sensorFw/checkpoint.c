@@ -0,0 +1,341 @@
+//--------------------------------------------------------------------------------------------------
+/** @file checkpoint.c
+ *
+ * Runtime state of the registered sensors in a memory mapped file on tmpfs.
+ *
+ * The file holds a header followed by SENSOR_HANDLER_POOL_SIZE fixed-size entries. An entry is
+ * written under a sequence count that is odd while the write is in progress, so an entry torn by
+ * a crash is recognized and discarded on the next start.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "checkpoint.h"
+#include "config.h"
+
+#if LE_CONFIG_LINUX
+#include <sys/mman.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Magic number and layout version of the checkpoint file
+ */
+//--------------------------------------------------------------------------------------------------
+#define     CHECKPOINT_MAGIC                0x4b434653  // "SFCK"
+#define     CHECKPOINT_VERSION              1
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header of the checkpoint file
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t magic;                             ///< CHECKPOINT_MAGIC
+    uint32_t version;                           ///< CHECKPOINT_VERSION
+    uint32_t entrySize;                         ///< sizeof(checkpoint_Entry_t)
+    uint32_t entryCount;                        ///< Number of entries
+}
+header_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Layout of the checkpoint file
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    header_t header;
+    checkpoint_Entry_t entries[SENSOR_HANDLER_POOL_SIZE];
+}
+checkpointFile_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mapped checkpoint file (NULL if not available)
+ */
+//--------------------------------------------------------------------------------------------------
+static checkpointFile_t* CheckpointPtr = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Entries attached by this run
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsAttached[SENSOR_HANDLER_POOL_SIZE];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checkpoint entries, by sensor path
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t EntryMap = NULL;
+
+LE_HASHMAP_DEFINE_STATIC(EntryMap, SENSOR_HANDLER_POOL_SIZE);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map the checkpoint file
+ *
+ * @return:
+ *      - Mapped file, NULL on error
+ */
+//--------------------------------------------------------------------------------------------------
+static checkpointFile_t* MapFile
+(
+    void
+)
+{
+#if LE_CONFIG_LINUX
+    int fd = open(SENSOR_CHECKPOINT_PATH, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+
+    if (fd < 0)
+    {
+        LE_WARN("Cannot open %s: %m", SENSOR_CHECKPOINT_PATH);
+        return NULL;
+    }
+
+    if (ftruncate(fd, sizeof(checkpointFile_t)) != 0)
+    {
+        LE_WARN("Cannot size %s: %m", SENSOR_CHECKPOINT_PATH);
+        close(fd);
+        return NULL;
+    }
+
+    void* mapPtr = mmap(NULL, sizeof(checkpointFile_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mapPtr == MAP_FAILED)
+    {
+        LE_WARN("Cannot map %s: %m", SENSOR_CHECKPOINT_PATH);
+        return NULL;
+    }
+
+    return mapPtr;
+#else
+    return NULL;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find an entry for a new sensor: a free one, or else one left by a sensor of the previous run
+ * that is not registered anymore.
+ *
+ * @return:
+ *      - Entry, NULL if all entries are attached
+ */
+//--------------------------------------------------------------------------------------------------
+static checkpoint_Entry_t* FindFreeEntry
+(
+    void
+)
+{
+    int i;
+
+    for (i = 0; i < SENSOR_HANDLER_POOL_SIZE; i++)
+    {
+        if (!IsAttached[i] && (CheckpointPtr->entries[i].path[0] == '\0'))
+        {
+            return &CheckpointPtr->entries[i];
+        }
+    }
+
+    for (i = 0; i < SENSOR_HANDLER_POOL_SIZE; i++)
+    {
+        if (!IsAttached[i])
+        {
+            return &CheckpointPtr->entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map the checkpoint file, creating it if it does not exist or is not valid
+ *
+ * @return:
+ *      - LE_OK if the state of the previous run is available
+ *      - LE_NOT_FOUND if the checkpoint was (re)created empty
+ *      - LE_UNSUPPORTED if checkpointing is not available, state is not kept
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t checkpoint_Init
+(
+    void
+)
+{
+    int i;
+
+    CheckpointPtr = MapFile();
+
+    if (CheckpointPtr == NULL)
+    {
+        return LE_UNSUPPORTED;
+    }
+
+    EntryMap = le_hashmap_InitStatic(EntryMap,
+                                     SENSOR_HANDLER_POOL_SIZE,
+                                     le_hashmap_HashString,
+                                     le_hashmap_EqualsString);
+
+    header_t* headerPtr = &CheckpointPtr->header;
+
+    if ((headerPtr->magic != CHECKPOINT_MAGIC) ||
+        (headerPtr->version != CHECKPOINT_VERSION) ||
+        (headerPtr->entrySize != sizeof(checkpoint_Entry_t)) ||
+        (headerPtr->entryCount != SENSOR_HANDLER_POOL_SIZE))
+    {
+        LE_INFO("No valid checkpoint, starting cold");
+
+        memset(CheckpointPtr, 0, sizeof(checkpointFile_t));
+        headerPtr->magic = CHECKPOINT_MAGIC;
+        headerPtr->version = CHECKPOINT_VERSION;
+        headerPtr->entrySize = sizeof(checkpoint_Entry_t);
+        headerPtr->entryCount = SENSOR_HANDLER_POOL_SIZE;
+
+        return LE_NOT_FOUND;
+    }
+
+    for (i = 0; i < SENSOR_HANDLER_POOL_SIZE; i++)
+    {
+        checkpoint_Entry_t* entryPtr = &CheckpointPtr->entries[i];
+
+        entryPtr->path[sizeof(entryPtr->path) - 1] = '\0';
+
+        if (entryPtr->path[0] != '\0')
+        {
+            le_hashmap_Put(EntryMap, entryPtr->path, entryPtr);
+        }
+    }
+
+    LE_INFO("Checkpoint of the previous run found");
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the checkpoint entry of a sensor, reusing the entry of the previous run if any. A sensor
+ * registered again gets the entry it already has.
+ *
+ * @return:
+ *      - Entry of the sensor, NULL if checkpointing is not available or the checkpoint is full
+ */
+//--------------------------------------------------------------------------------------------------
+checkpoint_Entry_t* checkpoint_Attach
+(
+    const char* pathPtr,                ///< [IN]  Path of the sensor
+    int32_t type,                       ///< [IN]  Data type of the sensor
+    bool* isWarmPtr                     ///< [OUT] Was a valid state of the previous run found?
+)
+{
+    checkpoint_Entry_t* entryPtr;
+
+    *isWarmPtr = false;
+
+    if (CheckpointPtr == NULL)
+    {
+        return NULL;
+    }
+
+    entryPtr = le_hashmap_Get(EntryMap, pathPtr);
+
+    if (entryPtr != NULL)
+    {
+        bool wasAttached = IsAttached[entryPtr - CheckpointPtr->entries];
+
+        IsAttached[entryPtr - CheckpointPtr->entries] = true;
+
+        // A torn write or a type change invalidates the state of the previous run. A sensor
+        // registered again by this run keeps its entry, its state is not of the previous run.
+        if ((entryPtr->type == type) && ((entryPtr->seq & 1) == 0))
+        {
+            *isWarmPtr = !wasAttached && (entryPtr->lastSampleTime > 0);
+            return entryPtr;
+        }
+    }
+    else
+    {
+        entryPtr = FindFreeEntry();
+
+        if (entryPtr == NULL)
+        {
+            LE_WARN("Checkpoint full, state of %s is not kept", pathPtr);
+            return NULL;
+        }
+
+        IsAttached[entryPtr - CheckpointPtr->entries] = true;
+    }
+
+    // The path of the entry is the key in the map, remove it before overwriting it.
+    if (entryPtr->path[0] != '\0')
+    {
+        le_hashmap_Remove(EntryMap, entryPtr->path);
+    }
+
+    memset(entryPtr, 0, sizeof(*entryPtr));
+    le_utf8_Copy(entryPtr->path, pathPtr, sizeof(entryPtr->path), NULL);
+    entryPtr->type = type;
+
+    le_hashmap_Put(EntryMap, entryPtr->path, entryPtr);
+
+    return entryPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a published sample. Must be called from the sensor framework thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void checkpoint_RecordSample
+(
+    checkpoint_Entry_t* entryPtr,       ///< [IN] Entry of the sensor (may be NULL)
+    double timestamp,                   ///< [IN] Time of the sample
+    const double* valuePtr              ///< [IN] Numeric value (NULL if not numeric or boolean)
+)
+{
+    if (entryPtr == NULL)
+    {
+        return;
+    }
+
+    __atomic_add_fetch(&entryPtr->seq, 1, __ATOMIC_RELEASE);
+
+    if (valuePtr != NULL)
+    {
+        entryPtr->value = *valuePtr;
+        entryPtr->hasValue = true;
+    }
+
+    entryPtr->lastSampleTime = timestamp;
+    entryPtr->sampleCount++;
+    __atomic_store_n(&entryPtr->consecutiveFailures, 0, __ATOMIC_RELAXED);
+
+    __atomic_add_fetch(&entryPtr->seq, 1, __ATOMIC_RELEASE);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a failed sample. May be called from any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void checkpoint_RecordFailure
+(
+    checkpoint_Entry_t* entryPtr        ///< [IN] Entry of the sensor (may be NULL)
+)
+{
+    if (entryPtr == NULL)
+    {
+        return;
+    }
+
+    __atomic_add_fetch(&entryPtr->failureCount, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&entryPtr->consecutiveFailures, 1, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,89 @@
+//--------------------------------------------------------------------------------------------------
+/** @file checkpoint.h
+ *
+ * Runtime state of the registered sensors, kept in a memory mapped file on tmpfs so that it
+ * survives a restart of sensord (but not a reboot). Entries are updated in place on every sample,
+ * so nothing needs to be saved when the process exits or crashes.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_CHECKPOINT_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_CHECKPOINT_INCLUDE_GUARD
+
+#include "interfaces.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checkpointed state of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];    ///< Path of the sensor ("" if the entry is free)
+    int32_t type;                               ///< Data type of the sensor
+    uint32_t seq;                               ///< Odd while the entry is being written
+    bool hasValue;                              ///< Is value valid?
+    double value;                               ///< Last published numeric or boolean sample
+    double lastSampleTime;                      ///< Time of the last published sample (0 if none)
+    uint32_t sampleCount;                       ///< Number of published samples
+    uint32_t failureCount;                      ///< Number of failed samples
+    uint32_t consecutiveFailures;               ///< Number of failed samples since the last success
+}
+checkpoint_Entry_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map the checkpoint file, creating it if it does not exist or is not valid
+ *
+ * @return:
+ *      - LE_OK if the state of the previous run is available
+ *      - LE_NOT_FOUND if the checkpoint was (re)created empty
+ *      - LE_UNSUPPORTED if checkpointing is not available, state is not kept
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t checkpoint_Init
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the checkpoint entry of a sensor, reusing the entry of the previous run if any. A sensor
+ * registered again gets the entry it already has.
+ *
+ * @return:
+ *      - Entry of the sensor, NULL if checkpointing is not available or the checkpoint is full
+ */
+//--------------------------------------------------------------------------------------------------
+checkpoint_Entry_t* checkpoint_Attach
+(
+    const char* pathPtr,                ///< [IN]  Path of the sensor
+    int32_t type,                       ///< [IN]  Data type of the sensor
+    bool* isWarmPtr                     ///< [OUT] Was a valid state of the previous run found?
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a published sample. Must be called from the sensor framework thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void checkpoint_RecordSample
+(
+    checkpoint_Entry_t* entryPtr,       ///< [IN] Entry of the sensor (may be NULL)
+    double timestamp,                   ///< [IN] Time of the sample
+    const double* valuePtr              ///< [IN] Numeric value (NULL if not numeric or boolean)
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a failed sample. May be called from any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void checkpoint_RecordFailure
+(
+    checkpoint_Entry_t* entryPtr        ///< [IN] Entry of the sensor (may be NULL)
+);
+
+#endif /* LEGATO_SENSOR_FW_CHECKPOINT_INCLUDE_GUARD */
@@ -13,8 +13,94 @@
 
 #if LE_CONFIG_REDUCE_FOOTPRINT
 #define SENSOR_HANDLER_POOL_SIZE (100)
+#define SENSOR_CALIBRATION_POOL_SIZE (20)
+#define SENSOR_PUSH_RING_COUNT (4)
+#define SENSOR_PUSH_RING_SIZE (64)
+#define SENSOR_PUSH_STRING_COUNT (2)
+#define SENSOR_BUDGET_PLUGIN_COUNT (8)
+#define SENSOR_INFERENCE_MODEL_COUNT (2)
+#define SENSOR_INFERENCE_ARENA_SIZE (8192)
+#define SENSOR_DELTA_POOL_SIZE (16)
+#define SENSOR_SNAPSHOT_MAX_LEN (8192)
 #else
 #define SENSOR_HANDLER_POOL_SIZE (1000)
+#define SENSOR_CALIBRATION_POOL_SIZE (200)
+#define SENSOR_PUSH_RING_COUNT (8)
+#define SENSOR_PUSH_RING_SIZE (256)
+#define SENSOR_PUSH_STRING_COUNT (8)
+#define SENSOR_BUDGET_PLUGIN_COUNT (32)
+#define SENSOR_INFERENCE_MODEL_COUNT (8)
+#define SENSOR_INFERENCE_ARENA_SIZE (65536)
+#define SENSOR_DELTA_POOL_SIZE (128)
+#define SENSOR_SNAPSHOT_MAX_LEN (49152)
+#endif
+
+// A staging ring holds at most SENSOR_PUSH_STRING_COUNT string or JSON samples of up to
+// SENSOR_PUSH_STRING_LEN bytes, copied to a slab of the ring.
+#define SENSOR_PUSH_STRING_LEN (1024)
+
+// Plugin budgets are evaluated over windows of this many seconds. A plugin over budget has the
+// periods of its sensors multiplied by at most SENSOR_BUDGET_MAX_SCALE.
+#define SENSOR_BUDGET_WINDOW (10)
+#define SENSOR_BUDGET_MAX_SCALE (16)
+
+// The pressure of the system is checked every SENSOR_PRESSURE_CHECK_PERIOD seconds, and only
+// lowered one level at a time, SENSOR_PRESSURE_HOLD_TIME seconds after its last change.
+#define SENSOR_PRESSURE_CHECK_PERIOD (5)
+#define SENSOR_PRESSURE_HOLD_TIME (30)
+
+// The heap is sampled every SENSOR_HEAP_SAMPLE_PERIOD seconds and its growth is fitted over the
+// last SENSOR_HEAP_SAMPLE_COUNT samples.
+#define SENSOR_HEAP_SAMPLE_PERIOD (60)
+#define SENSOR_HEAP_SAMPLE_COUNT (60)
+
+// Inference models are loaded into a static arena of SENSOR_INFERENCE_ARENA_SIZE bytes. A model
+// has at most SENSOR_INFERENCE_MAX_INPUTS input sensors, SENSOR_INFERENCE_MAX_FEATURES features and
+// SENSOR_INFERENCE_MAX_CLASSES classes, and its hidden layers at most SENSOR_INFERENCE_MAX_WIDTH
+// neurons.
+#define SENSOR_INFERENCE_MAX_INPUTS (8)
+#define SENSOR_INFERENCE_MAX_FEATURES (48)
+#define SENSOR_INFERENCE_MAX_CLASSES (16)
+#define SENSOR_INFERENCE_MAX_WIDTH (64)
+
+// JSON resources published as merge patches get a full document every
+// SENSOR_DELTA_KEYFRAME_INTERVAL pushes, unless the sensor sets its own interval.
+#define SENSOR_DELTA_KEYFRAME_INTERVAL (16)
+
+// Numeric sensors are rolled up into at most SENSOR_ROLLUP_MAX_TIERS tiers, by default one minute
+// kept for a week and one hour kept for a year. A tier is stored in SENSOR_ROLLUP_SEGMENT_COUNT
+// segments, indexed every SENSOR_ROLLUP_INDEX_STRIDE records. A query scans at most
+// SENSOR_ROLLUP_QUERY_SCAN_COUNT records per call.
+#define SENSOR_ROLLUP_MAX_TIERS (4)
+#define SENSOR_ROLLUP_SEGMENT_COUNT (8)
+#define SENSOR_ROLLUP_INDEX_STRIDE (64)
+#if LE_CONFIG_REDUCE_FOOTPRINT
+#define SENSOR_ROLLUP_QUERY_SCAN_COUNT (2048)
+#else
+#define SENSOR_ROLLUP_QUERY_SCAN_COUNT (16384)
+#endif
+#define SENSOR_ROLLUP_DEFAULT_PERIOD_1 (60)
+#define SENSOR_ROLLUP_DEFAULT_RETENTION_1 (7 * 24 * 3600)
+#define SENSOR_ROLLUP_DEFAULT_PERIOD_2 (3600)
+#define SENSOR_ROLLUP_DEFAULT_RETENTION_2 (365 * 24 * 3600)
+#define SENSOR_ROLLUP_DIR "/data/sensorFw/rollup"
+
+// A sensor takes at most SENSOR_SNAPSHOT_MEMBER_LEN bytes of the snapshot document, which is at
+// most SENSOR_SNAPSHOT_MAX_LEN bytes (the Data Hub takes JSON values of up to 50000 bytes).
+#define SENSOR_SNAPSHOT_MEMBER_LEN (128)
+
+// Traced samples wait for their ack from the upstream sink in a ring of SENSOR_TRACE_PENDING_COUNT
+// entries, a trace not acknowledged before its entry is reused only reports the local stages.
+#define SENSOR_TRACE_PENDING_COUNT (64)
+
+// Runtime state kept across restarts of sensord. Must be on tmpfs so that it is lost on reboot.
+#ifndef SENSOR_CHECKPOINT_PATH
+#define SENSOR_CHECKPOINT_PATH "/tmp/sensorFw.state"
+#endif
+
+// Unix socket serving the metrics in the Prometheus text format.
+#ifndef SENSOR_METRICS_SOCKET_PATH
+#define SENSOR_METRICS_SOCKET_PATH "/tmp/sensorFw.metrics"
 #endif
 
 #endif /* end SENSOR_FW_CONFIG_H_INCLUDE_GUARD */
@@ -0,0 +1,562 @@
+//--------------------------------------------------------------------------------------------------
+/** @file delta.c
+ *
+ * JSON merge patch (RFC 7386) generation. The documents are scanned in place without building a
+ * tree: members are compared by their text, members of nested objects are compared recursively and
+ * any other value that changed (including arrays) is copied to the patch as a whole.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "delta.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of members of an object, and nesting depth of the objects compared
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_MEMBERS                     32
+#define MAX_DEPTH                       4
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Member of an object, as spans of the document
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* keyPtr;                         ///< Key, with its quotes
+    size_t keyLen;                              ///< Length of the key
+    const char* valuePtr;                       ///< Value
+    size_t valueLen;                            ///< Length of the value
+}
+member_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Patch being written
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char* bufPtr;                               ///< Buffer
+    size_t size;                                ///< Buffer size
+    size_t length;                              ///< Bytes written
+    bool isOverflow;                            ///< Did the patch not fit?
+}
+writer_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skip white spaces
+ *
+ * @return:
+ *      - First character that is not a white space
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* SkipSpaces
+(
+    const char* ptr                             ///< [IN] Position in the document
+)
+{
+    while ((*ptr == ' ') || (*ptr == '\t') || (*ptr == '\n') || (*ptr == '\r'))
+    {
+        ptr++;
+    }
+
+    return ptr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skip a string
+ *
+ * @return:
+ *      - Character following the closing quote, NULL if the string is not terminated
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* SkipString
+(
+    const char* ptr                             ///< [IN] Opening quote
+)
+{
+    for (ptr++; *ptr != '"'; ptr++)
+    {
+        if (*ptr == '\0')
+        {
+            return NULL;
+        }
+
+        if ((*ptr == '\\') && (*(++ptr) == '\0'))
+        {
+            return NULL;
+        }
+    }
+
+    return ptr + 1;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skip a value
+ *
+ * @return:
+ *      - Character following the value, NULL if the value is not valid
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* SkipValue
+(
+    const char* ptr                             ///< [IN] First character of the value
+)
+{
+    int depth = 0;
+
+    if (*ptr == '"')
+    {
+        return SkipString(ptr);
+    }
+
+    if ((*ptr != '{') && (*ptr != '['))
+    {
+        // Number or literal.
+        const char* startPtr = ptr;
+
+        while ((*ptr != '\0') && (strchr(",}] \t\n\r", *ptr) == NULL))
+        {
+            ptr++;
+        }
+
+        return (ptr == startPtr) ? NULL : ptr;
+    }
+
+    do
+    {
+        switch (*ptr)
+        {
+            case '\0':
+                return NULL;
+
+            case '"':
+                ptr = SkipString(ptr);
+
+                if (ptr == NULL)
+                {
+                    return NULL;
+                }
+                continue;
+
+            case '{':
+            case '[':
+                depth++;
+                break;
+
+            case '}':
+            case ']':
+                depth--;
+                break;
+
+            default:
+                break;
+        }
+
+        ptr++;
+    }
+    while (depth > 0);
+
+    return ptr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Split an object into its members
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNSUPPORTED if the value is not an object or has too many members
+ *      - LE_FORMAT_ERROR if the object is not valid
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseObject
+(
+    const char* ptr,                            ///< [IN]  Object
+    member_t* membersPtr,                       ///< [OUT] Members
+    size_t* countPtr                            ///< [OUT] Number of members
+)
+{
+    *countPtr = 0;
+    ptr = SkipSpaces(ptr);
+
+    if (*ptr != '{')
+    {
+        return LE_UNSUPPORTED;
+    }
+
+    ptr = SkipSpaces(ptr + 1);
+
+    if (*ptr == '}')
+    {
+        return LE_OK;
+    }
+
+    for (;;)
+    {
+        member_t* memberPtr = &membersPtr[*countPtr];
+        const char* endPtr;
+
+        if (*countPtr >= MAX_MEMBERS)
+        {
+            return LE_UNSUPPORTED;
+        }
+
+        if ((*ptr != '"') || ((endPtr = SkipString(ptr)) == NULL))
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        memberPtr->keyPtr = ptr;
+        memberPtr->keyLen = endPtr - ptr;
+
+        ptr = SkipSpaces(endPtr);
+
+        if (*ptr != ':')
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        ptr = SkipSpaces(ptr + 1);
+        endPtr = SkipValue(ptr);
+
+        if (endPtr == NULL)
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        memberPtr->valuePtr = ptr;
+        memberPtr->valueLen = endPtr - ptr;
+        (*countPtr)++;
+
+        ptr = SkipSpaces(endPtr);
+
+        if (*ptr == '}')
+        {
+            return LE_OK;
+        }
+
+        if (*ptr != ',')
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        ptr = SkipSpaces(ptr + 1);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if an object, or an object nested in it, has a member set to null, which a merge patch
+ * cannot carry
+ *
+ * @return:
+ *      - true if a member is null, or the nesting is too deep to tell
+ */
+//--------------------------------------------------------------------------------------------------
+static bool HasNullMember
+(
+    const member_t* membersPtr,                 ///< [IN] Members of the object
+    size_t count,                               ///< [IN] Number of members
+    int depth                                   ///< [IN] Nesting depth of the object
+)
+{
+    member_t nested[MAX_MEMBERS];
+    size_t nestedCount;
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        const member_t* memberPtr = &membersPtr[i];
+
+        if ((memberPtr->valueLen == 4) && (strncmp(memberPtr->valuePtr, "null", 4) == 0))
+        {
+            return true;
+        }
+
+        if ((*memberPtr->valuePtr == '{') &&
+            ((depth >= MAX_DEPTH) ||
+             (ParseObject(memberPtr->valuePtr, nested, &nestedCount) != LE_OK) ||
+             HasNullMember(nested, nestedCount, depth + 1)))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append text to the patch
+ */
+//--------------------------------------------------------------------------------------------------
+static void Append
+(
+    writer_t* writerPtr,                        ///< [INOUT] Patch
+    const char* textPtr,                        ///< [IN]    Text
+    size_t length                               ///< [IN]    Length of the text
+)
+{
+    if (writerPtr->length + length >= writerPtr->size)
+    {
+        writerPtr->isOverflow = true;
+        return;
+    }
+
+    memcpy(writerPtr->bufPtr + writerPtr->length, textPtr, length);
+    writerPtr->length += length;
+    writerPtr->bufPtr[writerPtr->length] = '\0';
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a member to the patch
+ */
+//--------------------------------------------------------------------------------------------------
+static void AppendMember
+(
+    writer_t* writerPtr,                        ///< [INOUT] Patch
+    bool* isFirstPtr,                           ///< [INOUT] Is it the first member of the object?
+    const member_t* keyPtr,                     ///< [IN]    Member holding the key
+    const char* valuePtr,                       ///< [IN]    Value
+    size_t valueLen                             ///< [IN]    Length of the value
+)
+{
+    if (!*isFirstPtr)
+    {
+        Append(writerPtr, ",", 1);
+    }
+
+    *isFirstPtr = false;
+    Append(writerPtr, keyPtr->keyPtr, keyPtr->keyLen);
+    Append(writerPtr, ":", 1);
+    Append(writerPtr, valuePtr, valueLen);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a member by key
+ *
+ * @return:
+ *      - Member, NULL if not found
+ */
+//--------------------------------------------------------------------------------------------------
+static const member_t* FindMember
+(
+    const member_t* membersPtr,                 ///< [IN] Members of the object
+    size_t count,                               ///< [IN] Number of members
+    const member_t* keyPtr                      ///< [IN] Member holding the key
+)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if ((membersPtr[i].keyLen == keyPtr->keyLen) &&
+            (memcmp(membersPtr[i].keyPtr, keyPtr->keyPtr, keyPtr->keyLen) == 0))
+        {
+            return &membersPtr[i];
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the merge patch between two objects
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNSUPPORTED if the objects are too large or nested too deep
+ *      - LE_FORMAT_ERROR if an object is not valid
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t DiffObjects
+(
+    writer_t* writerPtr,                        ///< [INOUT] Patch
+    const char* prevPtr,                        ///< [IN]    Previous object
+    const char* nextPtr,                        ///< [IN]    New object
+    int depth                                   ///< [IN]    Nesting depth of the objects
+)
+{
+    member_t prev[MAX_MEMBERS];
+    member_t next[MAX_MEMBERS];
+    size_t prevCount;
+    size_t nextCount;
+    bool isFirst = true;
+    le_result_t result;
+    size_t i;
+
+    if (depth > MAX_DEPTH)
+    {
+        return LE_UNSUPPORTED;
+    }
+
+    result = ParseObject(prevPtr, prev, &prevCount);
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    result = ParseObject(nextPtr, next, &nextCount);
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    Append(writerPtr, "{", 1);
+
+    for (i = 0; i < nextCount; i++)
+    {
+        const member_t* prevMemberPtr = FindMember(prev, prevCount, &next[i]);
+
+        if ((prevMemberPtr != NULL) &&
+            (prevMemberPtr->valueLen == next[i].valueLen) &&
+            (memcmp(prevMemberPtr->valuePtr, next[i].valuePtr, next[i].valueLen) == 0))
+        {
+            continue;
+        }
+
+        // Nested objects are patched member by member.
+        if ((prevMemberPtr != NULL) &&
+            (*prevMemberPtr->valuePtr == '{') && (*next[i].valuePtr == '{'))
+        {
+            char nestedPatch[DELTA_MAX_DOC_LEN];
+            writer_t nested = { nestedPatch, sizeof(nestedPatch), 0, false };
+
+            result = DiffObjects(&nested, prevMemberPtr->valuePtr, next[i].valuePtr, depth + 1);
+
+            if (result != LE_OK)
+            {
+                return result;
+            }
+
+            writerPtr->isOverflow |= nested.isOverflow;
+
+            // Only the formatting changed.
+            if (!nested.isOverflow && (strcmp(nestedPatch, "{}") != 0))
+            {
+                AppendMember(writerPtr, &isFirst, &next[i], nestedPatch, nested.length);
+            }
+            continue;
+        }
+
+        AppendMember(writerPtr, &isFirst, &next[i], next[i].valuePtr, next[i].valueLen);
+    }
+
+    // Removed members.
+    for (i = 0; i < prevCount; i++)
+    {
+        if (FindMember(next, nextCount, &prev[i]) == NULL)
+        {
+            AppendMember(writerPtr, &isFirst, &prev[i], "null", 4);
+        }
+    }
+
+    Append(writerPtr, "}", 1);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the merge patch turning a JSON object into another one
+ *
+ * @return:
+ *      - LE_OK on success, "{}" if the documents are the same
+ *      - LE_UNSUPPORTED if a document is not an object, or the new one has a member set to null
+ *      - LE_OVERFLOW if the patch does not fit in the buffer
+ *      - LE_FORMAT_ERROR if a document is not valid JSON
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t delta_MergePatch
+(
+    const char* prevPtr,                        ///< [IN]  Previous document
+    const char* nextPtr,                        ///< [IN]  New document
+    char* patchPtr,                             ///< [OUT] Merge patch
+    size_t patchSize                            ///< [IN]  Buffer size
+)
+{
+    member_t next[MAX_MEMBERS];
+    size_t nextCount;
+    writer_t writer = { patchPtr, patchSize, 0, false };
+    le_result_t result;
+
+    if (patchSize == 0)
+    {
+        return LE_OVERFLOW;
+    }
+
+    patchPtr[0] = '\0';
+
+    // Null removes a member when the patch is applied.
+    result = ParseObject(nextPtr, next, &nextCount);
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    if (HasNullMember(next, nextCount, 0))
+    {
+        return LE_UNSUPPORTED;
+    }
+
+    result = DiffObjects(&writer, prevPtr, nextPtr, 0);
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    return writer.isOverflow ? LE_OVERFLOW : LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a new document of a resource
+ *
+ * @return:
+ *      - true if the patch was written to the buffer and is to be published instead of the document
+ *      - false if the document is a keyframe, to be published in full
+ */
+//--------------------------------------------------------------------------------------------------
+bool delta_Encode
+(
+    delta_t* deltaPtr,                          ///< [INOUT] Encoder
+    const char* docPtr,                         ///< [IN]    New document
+    uint32_t keyframeInterval,                  ///< [IN]    Pushes per keyframe
+    char* patchPtr,                             ///< [OUT]   Merge patch
+    size_t patchSize                            ///< [IN]    Buffer size
+)
+{
+    // A patch no shorter than the document saves nothing.
+    if ((deltaPtr->pushCount > 0) &&
+        (deltaPtr->pushCount < keyframeInterval) &&
+        (delta_MergePatch(deltaPtr->lastDoc, docPtr, patchPtr, patchSize) == LE_OK) &&
+        (strlen(patchPtr) < strlen(docPtr)))
+    {
+        deltaPtr->pushCount++;
+    }
+    else
+    {
+        deltaPtr->pushCount = 1;
+        patchPtr = NULL;
+    }
+
+    le_utf8_Copy(deltaPtr->lastDoc, docPtr, sizeof(deltaPtr->lastDoc), NULL);
+
+    return (patchPtr != NULL);
+}
@@ -0,0 +1,72 @@
+//--------------------------------------------------------------------------------------------------
+/** @file delta.h
+ *
+ * Delta encoding of JSON documents published repeatedly, such as JSON samples and sensor
+ * configurations. A document is published as a JSON merge patch (RFC 7386) against the previous
+ * one, with the full document, the keyframe, published every few pushes and whenever it cannot be
+ * expressed as a merge patch (not an object, or a member set to null).
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_DELTA_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_DELTA_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of a document, including the terminating null character
+ */
+//--------------------------------------------------------------------------------------------------
+#define DELTA_MAX_DOC_LEN               1024
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delta encoder of a resource
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t pushCount;                             ///< Pushes since the last keyframe (0 = none)
+    char lastDoc[DELTA_MAX_DOC_LEN];                ///< Last document published
+}
+delta_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the merge patch turning a JSON object into another one
+ *
+ * @return:
+ *      - LE_OK on success, "{}" if the documents are the same
+ *      - LE_UNSUPPORTED if a document is not an object, or the new one has a member set to null
+ *      - LE_OVERFLOW if the patch does not fit in the buffer
+ *      - LE_FORMAT_ERROR if a document is not valid JSON
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t delta_MergePatch
+(
+    const char* prevPtr,                        ///< [IN]  Previous document
+    const char* nextPtr,                        ///< [IN]  New document
+    char* patchPtr,                             ///< [OUT] Merge patch
+    size_t patchSize                            ///< [IN]  Buffer size
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a new document of a resource
+ *
+ * @return:
+ *      - true if the patch was written to the buffer and is to be published instead of the document
+ *      - false if the document is a keyframe, to be published in full
+ */
+//--------------------------------------------------------------------------------------------------
+bool delta_Encode
+(
+    delta_t* deltaPtr,                          ///< [INOUT] Encoder
+    const char* docPtr,                         ///< [IN]    New document
+    uint32_t keyframeInterval,                  ///< [IN]    Pushes per keyframe
+    char* patchPtr,                             ///< [OUT]   Merge patch
+    size_t patchSize                            ///< [IN]    Buffer size
+);
+
+#endif /* LEGATO_SENSOR_FW_DELTA_INCLUDE_GUARD */
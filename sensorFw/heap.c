@@ -0,0 +1,212 @@
+//--------------------------------------------------------------------------------------------------
+/** @file heap.c
+ *
+ * Memory usage tracking of sensord.
+ *
+ * The heap in use is sampled periodically into a ring, and its growth is the least squares slope
+ * of the samples in the ring. Heap figures come from mallinfo2() (or mallinfo() on older glibc);
+ * the resident set size comes from /proc/self/statm.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "heap.h"
+#include "config.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample of the heap in use
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double time;                                ///< Relative time in seconds
+    double usedBytes;                           ///< Heap in use
+}
+sample_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ring of the last samples
+ */
+//--------------------------------------------------------------------------------------------------
+static sample_t Samples[SENSOR_HEAP_SAMPLE_COUNT];
+static uint32_t SampleCount;
+static uint32_t NextSample;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the heap usage
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadHeap
+(
+    heap_Stats_t* statsPtr                      ///< [OUT] Memory usage
+)
+{
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+
+    statsPtr->heapUsedBytes = info.uordblks + info.hblkhd;
+    statsPtr->heapFreeBytes = info.fordblks;
+    statsPtr->fragmentation = (info.arena > 0) ? ((double)info.fordblks / info.arena) : 0;
+#elif defined(__GLIBC__)
+    struct mallinfo info = mallinfo();
+
+    // mallinfo() counters are int, read them as unsigned so that they wrap at 4 GB rather than 2.
+    statsPtr->heapUsedBytes = (unsigned int)info.uordblks + (unsigned int)info.hblkhd;
+    statsPtr->heapFreeBytes = (unsigned int)info.fordblks;
+    statsPtr->fragmentation = (info.arena != 0) ?
+                              ((double)(unsigned int)info.fordblks / (unsigned int)info.arena) : 0;
+#else
+    statsPtr->heapUsedBytes = 0;
+    statsPtr->heapFreeBytes = 0;
+    statsPtr->fragmentation = 0;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the resident set size
+ *
+ * @return:
+ *      - Resident set size in bytes, 0 if not available
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t ReadRss
+(
+    void
+)
+{
+    unsigned long size;
+    unsigned long resident;
+    uint64_t rss = 0;
+    FILE* filePtr = fopen("/proc/self/statm", "r");
+
+    if (filePtr == NULL)
+    {
+        return 0;
+    }
+
+    if (fscanf(filePtr, "%lu %lu", &size, &resident) == 2)
+    {
+        rss = (uint64_t)resident * sysconf(_SC_PAGESIZE);
+    }
+
+    fclose(filePtr);
+
+    return rss;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fit the growth of the heap over the samples in the ring
+ *
+ * @return:
+ *      - Growth in bytes per second, 0 if there are not enough samples
+ */
+//--------------------------------------------------------------------------------------------------
+static double FitGrowth
+(
+    void
+)
+{
+    double meanTime = 0;
+    double meanUsed = 0;
+    double covariance = 0;
+    double variance = 0;
+    uint32_t i;
+
+    if (SampleCount < 2)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < SampleCount; i++)
+    {
+        meanTime += Samples[i].time;
+        meanUsed += Samples[i].usedBytes;
+    }
+
+    meanTime /= SampleCount;
+    meanUsed /= SampleCount;
+
+    for (i = 0; i < SampleCount; i++)
+    {
+        double dt = Samples[i].time - meanTime;
+
+        covariance += dt * (Samples[i].usedBytes - meanUsed);
+        variance += dt * dt;
+    }
+
+    return (variance > 0) ? (covariance / variance) : 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample the heap in use
+ */
+//--------------------------------------------------------------------------------------------------
+static void SampleHandler
+(
+    le_timer_Ref_t timerRef                     ///< [IN] Sampling timer
+)
+{
+    heap_Stats_t stats;
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    ReadHeap(&stats);
+
+    Samples[NextSample].time = (double)now.sec + ((double)now.usec / 1000000.0);
+    Samples[NextSample].usedBytes = stats.heapUsedBytes;
+
+    NextSample = (NextSample + 1) % SENSOR_HEAP_SAMPLE_COUNT;
+
+    if (SampleCount < SENSOR_HEAP_SAMPLE_COUNT)
+    {
+        SampleCount++;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start sampling the memory usage every SENSOR_HEAP_SAMPLE_PERIOD seconds
+ */
+//--------------------------------------------------------------------------------------------------
+void heap_Init
+(
+    void
+)
+{
+    le_timer_Ref_t timerRef = le_timer_Create("heapSample");
+
+    le_timer_SetMsInterval(timerRef, SENSOR_HEAP_SAMPLE_PERIOD * 1000);
+    le_timer_SetRepeat(timerRef, 0);
+    le_timer_SetHandler(timerRef, SampleHandler);
+    le_timer_Start(timerRef);
+
+    SampleHandler(timerRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current memory usage and the growth rate of the heap
+ */
+//--------------------------------------------------------------------------------------------------
+void heap_GetStats
+(
+    heap_Stats_t* statsPtr                      ///< [OUT] Memory usage
+)
+{
+    ReadHeap(statsPtr);
+
+    statsPtr->rssBytes = ReadRss();
+    statsPtr->growthPerHour = FitGrowth() * 3600;
+    statsPtr->sampleCount = SampleCount;
+}
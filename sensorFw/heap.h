@@ -0,0 +1,51 @@
+//--------------------------------------------------------------------------------------------------
+/** @file heap.h
+ *
+ * Tracking of the memory of sensord over long runs: resident set size, heap in use and free, and
+ * the growth rate of the heap fitted over the last SENSOR_HEAP_SAMPLE_COUNT samples, so that
+ * leaks and fragmentation show up long before the process runs out of memory.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_HEAP_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_HEAP_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory usage of the process
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t rssBytes;                          ///< Resident set size
+    uint64_t heapUsedBytes;                     ///< Heap allocated, including mmap'd blocks
+    uint64_t heapFreeBytes;                     ///< Heap free but not returned to the system
+    double fragmentation;                       ///< Share of the heap arena that is free
+    double growthPerHour;                       ///< Heap growth in bytes per hour
+    uint32_t sampleCount;                       ///< Samples the growth is fitted on
+}
+heap_Stats_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start sampling the memory usage every SENSOR_HEAP_SAMPLE_PERIOD seconds
+ */
+//--------------------------------------------------------------------------------------------------
+void heap_Init
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current memory usage and the growth rate of the heap
+ */
+//--------------------------------------------------------------------------------------------------
+void heap_GetStats
+(
+    heap_Stats_t* statsPtr                      ///< [OUT] Memory usage
+);
+
+#endif /* LEGATO_SENSOR_FW_HEAP_INCLUDE_GUARD */
@@ -0,0 +1,1193 @@
+//--------------------------------------------------------------------------------------------------
+/** @file inference.c
+ *
+ * Inference stage of the sensor framework.
+ *
+ * The windows only keep running aggregates of their inputs, and the models are loaded into a
+ * static arena at startup, so that neither the windows nor the inference allocate memory.
+ * Inference runs on the main thread when the first input of a model completes its window.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <math.h>
+#include "interfaces.h"
+#include "inference.h"
+#include "config.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Node of the configuration tree under which the models are read
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MODELS_ROOT_NODE                "models"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Defaults of the model configuration
+ */
+//--------------------------------------------------------------------------------------------------
+#define     DEFAULT_WINDOW                  32
+#define     DEFAULT_FEATURES                "mean,std,min,max"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of a model name, of a class label and of a configuration string
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_NAME_LEN                    32
+#define     MAX_LABEL_LEN                   16
+#define     MAX_CONFIG_LEN                  256
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of layers of an MLP, and size of the activation buffers
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_LAYERS                      4
+#define     MAX_ACTIVATIONS                 ((SENSOR_INFERENCE_MAX_FEATURES > \
+                                              SENSOR_INFERENCE_MAX_WIDTH) ? \
+                                             SENSOR_INFERENCE_MAX_FEATURES : \
+                                             SENSOR_INFERENCE_MAX_WIDTH)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Model file format
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MODEL_MAGIC                     "SFM1"
+#define     MODEL_TYPE_FOREST               1
+#define     MODEL_TYPE_MLP                  2
+#define     LEAF_FEATURE                    255
+#define     Q15_ONE                         32767.0
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Features computed over a window
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    FEATURE_MEAN,
+    FEATURE_STD,
+    FEATURE_MIN,
+    FEATURE_MAX,
+    FEATURE_RMS,
+    FEATURE_RANGE,
+    FEATURE_COUNT
+}
+feature_t;
+
+static const char* const FeatureNames[FEATURE_COUNT] =
+{
+    "mean", "std", "min", "max", "rms", "range"
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Running aggregates of an input over the current window
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t count;                             ///< Samples
+    double mean;                                ///< Mean of the samples
+    double m2;                                  ///< Sum of the squared deviations from the mean
+    double sumSq;                               ///< Sum of the squared samples
+    double min;                                 ///< Smallest sample
+    double max;                                 ///< Largest sample
+}
+window_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Node of a decision tree
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t feature;                            ///< Feature compared, LEAF_FEATURE for a leaf
+    uint8_t classIndex;                         ///< Class of a leaf
+    int16_t threshold;                          ///< Quantized threshold, confidence of a leaf
+    uint16_t left;                              ///< Node if the feature is <= threshold
+    uint16_t right;                             ///< Node otherwise
+}
+node_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Layer of an MLP
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint16_t inputCount;                        ///< Inputs
+    uint16_t outputCount;                       ///< Outputs
+    float weightScale;                          ///< Scale of the quantized weights
+    const int8_t* weightsPtr;                   ///< outputCount x inputCount weights
+    const float* biasPtr;                       ///< outputCount biases
+}
+layer_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Model
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char name[MAX_NAME_LEN];                    ///< Name of the model
+    char outputPath[IO_MAX_RESOURCE_PATH_LEN + 1]; ///< Resource the predictions are pushed to
+    uint8_t type;                               ///< MODEL_TYPE_FOREST or MODEL_TYPE_MLP
+    uint8_t inputCount;                         ///< Sensors the features are computed on
+    uint8_t featureCount;                       ///< Size of the feature vector
+    uint8_t classCount;                         ///< Classes predicted
+    uint8_t selectedCount;                      ///< Features computed per input
+    uint8_t selected[FEATURE_COUNT];            ///< Features computed per input, in order
+    char labels[SENSOR_INFERENCE_MAX_CLASSES][MAX_LABEL_LEN]; ///< Names of the classes
+    uint32_t windowSize;                        ///< Samples of the first input per window
+    window_t windows[SENSOR_INFERENCE_MAX_INPUTS]; ///< Current window of each input
+    const float* offsetsPtr;                    ///< Offset of each feature
+    const float* scalesPtr;                     ///< Scale of each feature
+    uint16_t treeCount;                         ///< Trees of a forest
+    uint16_t nodeCount;                         ///< Nodes of all the trees
+    const uint16_t* rootsPtr;                   ///< Root node of each tree
+    const node_t* nodesPtr;                     ///< Nodes
+    uint8_t layerCount;                         ///< Layers of an MLP
+    layer_t layers[MAX_LAYERS];                 ///< Layers
+    uint64_t inferenceCount;                    ///< Inferences run
+    uint64_t skippedCount;                      ///< Windows with an input without samples
+    uint64_t inferenceTimeUs;                   ///< Total time spent in inference
+    uint32_t latencyBuckets[METRICS_LATENCY_BUCKET_COUNT]; ///< Inferences per latency bucket
+    int lastClass;                              ///< Last class predicted (-1 if none)
+    double lastConfidence;                      ///< Confidence of the last prediction
+}
+model_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Input of a model. Inputs of different models fed by the same sensor are chained.
+ */
+//--------------------------------------------------------------------------------------------------
+struct inference_Input
+{
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];    ///< Path of the sensor
+    model_t* modelPtr;                          ///< Model
+    uint8_t index;                              ///< Index of the input in the model
+    inference_Input_t* nextPtr;                 ///< Next input fed by the same sensor
+};
+
+static model_t Models[SENSOR_INFERENCE_MODEL_COUNT];
+static int ModelCount;
+
+static inference_Input_t Inputs[SENSOR_INFERENCE_MODEL_COUNT * SENSOR_INFERENCE_MAX_INPUTS];
+static int InputCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Arena the model parameters are loaded into
+ */
+//--------------------------------------------------------------------------------------------------
+static union
+{
+    double align;
+    uint8_t bytes[SENSOR_INFERENCE_ARENA_SIZE];
+}
+Arena;
+
+static size_t ArenaUsed;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate from the arena
+ *
+ * @return:
+ *      - Memory, NULL if the arena is full
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ArenaAlloc
+(
+    size_t size                                 ///< [IN] Bytes
+)
+{
+    size = (size + sizeof(double) - 1) & ~(sizeof(double) - 1);
+
+    if (size > sizeof(Arena.bytes) - ArenaUsed)
+    {
+        return NULL;
+    }
+
+    void* ptr = &Arena.bytes[ArenaUsed];
+    ArenaUsed += size;
+
+    return ptr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read little-endian values from a model file
+ *
+ * @return:
+ *      - true on success
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadU8
+(
+    FILE* filePtr,                              ///< [IN]  Model file
+    uint8_t* valuePtr                           ///< [OUT] Value
+)
+{
+    return fread(valuePtr, 1, 1, filePtr) == 1;
+}
+
+static bool ReadU16
+(
+    FILE* filePtr,                              ///< [IN]  Model file
+    uint16_t* valuePtr                          ///< [OUT] Value
+)
+{
+    uint8_t bytes[2];
+
+    if (fread(bytes, 1, sizeof(bytes), filePtr) != sizeof(bytes))
+    {
+        return false;
+    }
+
+    *valuePtr = (uint16_t)(bytes[0] | (bytes[1] << 8));
+    return true;
+}
+
+static bool ReadF32
+(
+    FILE* filePtr,                              ///< [IN]  Model file
+    float* valuePtr                             ///< [OUT] Value
+)
+{
+    uint8_t bytes[4];
+
+    if (fread(bytes, 1, sizeof(bytes), filePtr) != sizeof(bytes))
+    {
+        return false;
+    }
+
+    uint32_t bits = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+                    ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+
+    LE_STATIC_ASSERT(sizeof(float) == sizeof(bits), "float is not 32 bits");
+    memcpy(valuePtr, &bits, sizeof(bits));
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the trees of a forest
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NO_MEMORY if the arena is full
+ *      - LE_FAULT if the file is malformed
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t LoadForest
+(
+    FILE* filePtr,                              ///< [IN]    Model file
+    model_t* modelPtr                           ///< [INOUT] Model
+)
+{
+    uint16_t i;
+
+    if (!ReadU16(filePtr, &modelPtr->treeCount) || !ReadU16(filePtr, &modelPtr->nodeCount) ||
+        (modelPtr->treeCount == 0) || (modelPtr->nodeCount == 0))
+    {
+        return LE_FAULT;
+    }
+
+    uint16_t* rootsPtr = ArenaAlloc(modelPtr->treeCount * sizeof(uint16_t));
+    node_t* nodesPtr = ArenaAlloc(modelPtr->nodeCount * sizeof(node_t));
+
+    if ((rootsPtr == NULL) || (nodesPtr == NULL))
+    {
+        return LE_NO_MEMORY;
+    }
+
+    for (i = 0; i < modelPtr->treeCount; i++)
+    {
+        if (!ReadU16(filePtr, &rootsPtr[i]) || (rootsPtr[i] >= modelPtr->nodeCount))
+        {
+            return LE_FAULT;
+        }
+    }
+
+    for (i = 0; i < modelPtr->nodeCount; i++)
+    {
+        node_t* nodePtr = &nodesPtr[i];
+        uint16_t threshold;
+
+        if (!ReadU8(filePtr, &nodePtr->feature) || !ReadU8(filePtr, &nodePtr->classIndex) ||
+            !ReadU16(filePtr, &threshold) || !ReadU16(filePtr, &nodePtr->left) ||
+            !ReadU16(filePtr, &nodePtr->right))
+        {
+            return LE_FAULT;
+        }
+
+        nodePtr->threshold = (int16_t)threshold;
+
+        if (nodePtr->feature == LEAF_FEATURE)
+        {
+            if (nodePtr->classIndex >= modelPtr->classCount)
+            {
+                return LE_FAULT;
+            }
+        }
+        // Children after their parent guarantee that every walk ends on a leaf.
+        else if ((nodePtr->feature >= modelPtr->featureCount) ||
+                 (nodePtr->left <= i) || (nodePtr->left >= modelPtr->nodeCount) ||
+                 (nodePtr->right <= i) || (nodePtr->right >= modelPtr->nodeCount))
+        {
+            return LE_FAULT;
+        }
+    }
+
+    modelPtr->rootsPtr = rootsPtr;
+    modelPtr->nodesPtr = nodesPtr;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the layers of an MLP
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NO_MEMORY if the arena is full
+ *      - LE_FAULT if the file is malformed
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t LoadMlp
+(
+    FILE* filePtr,                              ///< [IN]    Model file
+    model_t* modelPtr                           ///< [INOUT] Model
+)
+{
+    uint16_t expectedInputs = modelPtr->featureCount;
+    uint8_t i;
+    uint16_t j;
+
+    if (!ReadU8(filePtr, &modelPtr->layerCount) ||
+        (modelPtr->layerCount == 0) || (modelPtr->layerCount > MAX_LAYERS))
+    {
+        return LE_FAULT;
+    }
+
+    for (i = 0; i < modelPtr->layerCount; i++)
+    {
+        layer_t* layerPtr = &modelPtr->layers[i];
+        bool isOutput = (i == modelPtr->layerCount - 1);
+
+        if (!ReadU16(filePtr, &layerPtr->inputCount) || !ReadU16(filePtr, &layerPtr->outputCount) ||
+            !ReadF32(filePtr, &layerPtr->weightScale) ||
+            (layerPtr->inputCount != expectedInputs) || (layerPtr->outputCount == 0) ||
+            (layerPtr->outputCount > SENSOR_INFERENCE_MAX_WIDTH) ||
+            (isOutput && (layerPtr->outputCount != modelPtr->classCount)))
+        {
+            return LE_FAULT;
+        }
+
+        size_t weightCount = (size_t)layerPtr->inputCount * layerPtr->outputCount;
+        int8_t* weightsPtr = ArenaAlloc(weightCount);
+        float* biasPtr = ArenaAlloc(layerPtr->outputCount * sizeof(float));
+
+        if ((weightsPtr == NULL) || (biasPtr == NULL))
+        {
+            return LE_NO_MEMORY;
+        }
+
+        if (fread(weightsPtr, 1, weightCount, filePtr) != weightCount)
+        {
+            return LE_FAULT;
+        }
+
+        for (j = 0; j < layerPtr->outputCount; j++)
+        {
+            if (!ReadF32(filePtr, &biasPtr[j]))
+            {
+                return LE_FAULT;
+            }
+        }
+
+        layerPtr->weightsPtr = weightsPtr;
+        layerPtr->biasPtr = biasPtr;
+        expectedInputs = layerPtr->outputCount;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a model file
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NO_MEMORY if the arena is full
+ *      - LE_FAULT if the file is malformed or does not match the configuration
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadModelFile
+(
+    FILE* filePtr,                              ///< [IN]    Model file
+    model_t* modelPtr                           ///< [INOUT] Model
+)
+{
+    char magic[sizeof(MODEL_MAGIC) - 1];
+    uint8_t featureCount;
+    uint8_t reserved;
+    uint8_t i;
+
+    if ((fread(magic, 1, sizeof(magic), filePtr) != sizeof(magic)) ||
+        (memcmp(magic, MODEL_MAGIC, sizeof(magic)) != 0) ||
+        !ReadU8(filePtr, &modelPtr->type) || !ReadU8(filePtr, &featureCount) ||
+        !ReadU8(filePtr, &modelPtr->classCount) || !ReadU8(filePtr, &reserved))
+    {
+        return LE_FAULT;
+    }
+
+    if ((featureCount != modelPtr->featureCount) || (modelPtr->classCount == 0) ||
+        (modelPtr->classCount > SENSOR_INFERENCE_MAX_CLASSES))
+    {
+        LE_ERROR("Model %s: %u features and %u classes, %u features configured",
+                 modelPtr->name, featureCount, modelPtr->classCount, modelPtr->featureCount);
+        return LE_FAULT;
+    }
+
+    float* offsetsPtr = ArenaAlloc(featureCount * sizeof(float));
+    float* scalesPtr = ArenaAlloc(featureCount * sizeof(float));
+
+    if ((offsetsPtr == NULL) || (scalesPtr == NULL))
+    {
+        return LE_NO_MEMORY;
+    }
+
+    for (i = 0; i < featureCount; i++)
+    {
+        if (!ReadF32(filePtr, &offsetsPtr[i]) || !ReadF32(filePtr, &scalesPtr[i]))
+        {
+            return LE_FAULT;
+        }
+    }
+
+    modelPtr->offsetsPtr = offsetsPtr;
+    modelPtr->scalesPtr = scalesPtr;
+
+    switch (modelPtr->type)
+    {
+        case MODEL_TYPE_FOREST:
+            return LoadForest(filePtr, modelPtr);
+
+        case MODEL_TYPE_MLP:
+            return LoadMlp(filePtr, modelPtr);
+
+        default:
+            return LE_FAULT;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load a model file into the arena
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the file cannot be opened
+ *      - LE_NO_MEMORY if the arena is full
+ *      - LE_FAULT if the file is malformed or does not match the configuration
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t LoadModelFile
+(
+    const char* fileNamePtr,                    ///< [IN]    Model file
+    model_t* modelPtr                           ///< [INOUT] Model
+)
+{
+    size_t arenaMark = ArenaUsed;
+    FILE* filePtr = fopen(fileNamePtr, "rb");
+
+    if (filePtr == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    le_result_t result = ReadModelFile(filePtr, modelPtr);
+
+    fclose(filePtr);
+
+    if (result != LE_OK)
+    {
+        ArenaUsed = arenaMark;
+    }
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the comma separated list of features computed per input
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if a feature is unknown
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseFeatures
+(
+    char* listPtr,                              ///< [IN]  List of feature names
+    model_t* modelPtr                           ///< [OUT] Model
+)
+{
+    char* savePtr = NULL;
+    char* namePtr;
+
+    modelPtr->selectedCount = 0;
+
+    for (namePtr = strtok_r(listPtr, ", ", &savePtr);
+         namePtr != NULL;
+         namePtr = strtok_r(NULL, ", ", &savePtr))
+    {
+        int feature;
+
+        for (feature = 0; feature < FEATURE_COUNT; feature++)
+        {
+            if (strcmp(namePtr, FeatureNames[feature]) == 0)
+            {
+                break;
+            }
+        }
+
+        if ((feature == FEATURE_COUNT) || (modelPtr->selectedCount >= FEATURE_COUNT))
+        {
+            LE_ERROR("Model %s: unknown feature %s", modelPtr->name, namePtr);
+            return LE_FAULT;
+        }
+
+        modelPtr->selected[modelPtr->selectedCount++] = feature;
+    }
+
+    return (modelPtr->selectedCount > 0) ? LE_OK : LE_FAULT;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the comma separated list of class labels. Classes without a label are named after their
+ * index.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ParseLabels
+(
+    char* listPtr,                              ///< [IN]  List of labels
+    model_t* modelPtr                           ///< [OUT] Model
+)
+{
+    char* savePtr = NULL;
+    char* labelPtr = strtok_r(listPtr, ",", &savePtr);
+    int i;
+
+    for (i = 0; i < SENSOR_INFERENCE_MAX_CLASSES; i++)
+    {
+        char* charPtr;
+
+        if (labelPtr != NULL)
+        {
+            le_utf8_Copy(modelPtr->labels[i], labelPtr, MAX_LABEL_LEN, NULL);
+            labelPtr = strtok_r(NULL, ",", &savePtr);
+        }
+        else
+        {
+            snprintf(modelPtr->labels[i], MAX_LABEL_LEN, "%d", i);
+        }
+
+        // Labels are published in JSON strings.
+        for (charPtr = modelPtr->labels[i]; *charPtr != '\0'; charPtr++)
+        {
+            if ((*charPtr == '"') || (*charPtr == '\\') || ((unsigned char)*charPtr < ' '))
+            {
+                *charPtr = '_';
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add an input to a model, chained with the inputs of other models fed by the same sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if there are too many inputs
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AddInput
+(
+    model_t* modelPtr,                          ///< [IN] Model
+    const char* pathPtr                         ///< [IN] Path of the sensor
+)
+{
+    int i;
+
+    if ((modelPtr->inputCount >= SENSOR_INFERENCE_MAX_INPUTS) ||
+        (InputCount >= NUM_ARRAY_MEMBERS(Inputs)))
+    {
+        return LE_OVERFLOW;
+    }
+
+    inference_Input_t* inputPtr = &Inputs[InputCount];
+
+    le_utf8_Copy(inputPtr->path, pathPtr, sizeof(inputPtr->path), NULL);
+    inputPtr->modelPtr = modelPtr;
+    inputPtr->index = modelPtr->inputCount;
+    inputPtr->nextPtr = NULL;
+
+    for (i = 0; i < InputCount; i++)
+    {
+        if ((strcmp(Inputs[i].path, pathPtr) == 0) && (Inputs[i].nextPtr == NULL))
+        {
+            Inputs[i].nextPtr = inputPtr;
+            break;
+        }
+    }
+
+    InputCount++;
+    modelPtr->inputCount++;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the configuration of a model and add its inputs
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadModelConfig
+(
+    le_cfg_IteratorRef_t iteratorRef,           ///< [IN]    Node of the model
+    model_t* modelPtr,                          ///< [INOUT] Model
+    char* fileNamePtr,                          ///< [OUT]   Model file
+    size_t fileNameSize                         ///< [IN]    Buffer size
+)
+{
+    char string[MAX_CONFIG_LEN];
+
+    modelPtr->windowSize = le_cfg_GetInt(iteratorRef, "window", DEFAULT_WINDOW);
+
+    le_cfg_GetString(iteratorRef, "features", string, sizeof(string), DEFAULT_FEATURES);
+
+    if ((modelPtr->windowSize == 0) || (ParseFeatures(string, modelPtr) != LE_OK))
+    {
+        return LE_FAULT;
+    }
+
+    le_cfg_GetString(iteratorRef, "labels", string, sizeof(string), "");
+    ParseLabels(string, modelPtr);
+
+    snprintf(string, sizeof(string), "inference/%s", modelPtr->name);
+    le_cfg_GetString(iteratorRef, "output", modelPtr->outputPath, sizeof(modelPtr->outputPath),
+                     string);
+
+    if ((le_cfg_GetString(iteratorRef, "file", fileNamePtr, fileNameSize, "") != LE_OK) ||
+        (fileNamePtr[0] == '\0'))
+    {
+        LE_ERROR("Model %s: no file", modelPtr->name);
+        return LE_FAULT;
+    }
+
+    le_cfg_GoToNode(iteratorRef, "inputs");
+
+    if (le_cfg_GoToFirstChild(iteratorRef) == LE_OK)
+    {
+        do
+        {
+            if ((le_cfg_GetString(iteratorRef, "", string, sizeof(string), "") == LE_OK) &&
+                (string[0] != '\0') && (AddInput(modelPtr, string) != LE_OK))
+            {
+                LE_ERROR("Model %s: too many inputs", modelPtr->name);
+                return LE_FAULT;
+            }
+        }
+        while (le_cfg_GoToNextSibling(iteratorRef) == LE_OK);
+    }
+
+    if (modelPtr->inputCount == 0)
+    {
+        LE_ERROR("Model %s: no input", modelPtr->name);
+        return LE_FAULT;
+    }
+
+    if (modelPtr->inputCount * modelPtr->selectedCount > SENSOR_INFERENCE_MAX_FEATURES)
+    {
+        LE_ERROR("Model %s: too many features", modelPtr->name);
+        return LE_FAULT;
+    }
+
+    modelPtr->featureCount = modelPtr->inputCount * modelPtr->selectedCount;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the inputs added from an index on
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveInputs
+(
+    int firstIndex                              ///< [IN] Index of the first input removed
+)
+{
+    int i;
+
+    for (i = 0; i < firstIndex; i++)
+    {
+        if ((Inputs[i].nextPtr != NULL) && (Inputs[i].nextPtr >= &Inputs[firstIndex]))
+        {
+            Inputs[i].nextPtr = NULL;
+        }
+    }
+
+    InputCount = firstIndex;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load a model from the configuration tree
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t LoadModel
+(
+    const char* namePtr,                        ///< [IN] Name of the model
+    model_t* modelPtr                           ///< [IN] Model
+)
+{
+    char nodePath[sizeof(MODELS_ROOT_NODE) + MAX_NAME_LEN + 1];
+    char fileName[MAX_CONFIG_LEN];
+    int inputMark = InputCount;
+
+    memset(modelPtr, 0, sizeof(*modelPtr));
+    le_utf8_Copy(modelPtr->name, namePtr, sizeof(modelPtr->name), NULL);
+    modelPtr->lastClass = -1;
+
+    snprintf(nodePath, sizeof(nodePath), "%s/%s", MODELS_ROOT_NODE, modelPtr->name);
+
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(nodePath);
+    le_result_t result = ReadModelConfig(iteratorRef, modelPtr, fileName, sizeof(fileName));
+    le_cfg_CancelTxn(iteratorRef);
+
+    if (result != LE_OK)
+    {
+        RemoveInputs(inputMark);
+        return LE_FAULT;
+    }
+
+    result = LoadModelFile(fileName, modelPtr);
+
+    if (result != LE_OK)
+    {
+        LE_ERROR("Model %s: cannot load %s (%s)", modelPtr->name, fileName, LE_RESULT_TXT(result));
+        RemoveInputs(inputMark);
+        return LE_FAULT;
+    }
+
+    result = io_CreateInput(modelPtr->outputPath, IO_DATA_TYPE_JSON, "");
+
+    if ((result != LE_OK) && (result != LE_DUPLICATE))
+    {
+        LE_ERROR("Model %s: cannot create %s", modelPtr->name, modelPtr->outputPath);
+        RemoveInputs(inputMark);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a feature of a window
+ *
+ * @return:
+ *      - Value of the feature
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetFeature
+(
+    const window_t* windowPtr,                  ///< [IN] Window (not empty)
+    feature_t feature                           ///< [IN] Feature
+)
+{
+    switch (feature)
+    {
+        case FEATURE_MEAN:  return windowPtr->mean;
+        case FEATURE_STD:   return sqrt(windowPtr->m2 / windowPtr->count);
+        case FEATURE_MIN:   return windowPtr->min;
+        case FEATURE_MAX:   return windowPtr->max;
+        case FEATURE_RMS:   return sqrt(windowPtr->sumSq / windowPtr->count);
+        default:            return windowPtr->max - windowPtr->min;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a forest on a feature vector
+ *
+ * @return:
+ *      - Class predicted
+ */
+//--------------------------------------------------------------------------------------------------
+static int PredictForest
+(
+    const model_t* modelPtr,                    ///< [IN]  Model
+    const double* featuresPtr,                  ///< [IN]  Feature vector
+    double* confidencePtr                       ///< [OUT] Confidence of the prediction
+)
+{
+    int16_t quantized[SENSOR_INFERENCE_MAX_FEATURES];
+    double scores[SENSOR_INFERENCE_MAX_CLASSES] = {0};
+    int best = 0;
+    int i;
+
+    for (i = 0; i < modelPtr->featureCount; i++)
+    {
+        double value = round((featuresPtr[i] - modelPtr->offsetsPtr[i]) * modelPtr->scalesPtr[i]);
+
+        quantized[i] = (value <= INT16_MIN) ? INT16_MIN :
+                       (value >= INT16_MAX) ? INT16_MAX : (int16_t)value;
+    }
+
+    for (i = 0; i < modelPtr->treeCount; i++)
+    {
+        const node_t* nodePtr = &modelPtr->nodesPtr[modelPtr->rootsPtr[i]];
+
+        while (nodePtr->feature != LEAF_FEATURE)
+        {
+            nodePtr = &modelPtr->nodesPtr[(quantized[nodePtr->feature] <= nodePtr->threshold) ?
+                                          nodePtr->left : nodePtr->right];
+        }
+
+        if (nodePtr->threshold > 0)
+        {
+            scores[nodePtr->classIndex] += nodePtr->threshold / Q15_ONE;
+        }
+    }
+
+    for (i = 1; i < modelPtr->classCount; i++)
+    {
+        if (scores[i] > scores[best])
+        {
+            best = i;
+        }
+    }
+
+    *confidencePtr = scores[best] / modelPtr->treeCount;
+    return best;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run an MLP on a feature vector
+ *
+ * @return:
+ *      - Class predicted
+ */
+//--------------------------------------------------------------------------------------------------
+static int PredictMlp
+(
+    const model_t* modelPtr,                    ///< [IN]  Model
+    const double* featuresPtr,                  ///< [IN]  Feature vector
+    double* confidencePtr                       ///< [OUT] Confidence of the prediction
+)
+{
+    float buffers[2][MAX_ACTIVATIONS];
+    float* inPtr = buffers[0];
+    float* outPtr = buffers[1];
+    int best = 0;
+    int i;
+    int j;
+    int layer;
+
+    for (i = 0; i < modelPtr->featureCount; i++)
+    {
+        inPtr[i] = (featuresPtr[i] - modelPtr->offsetsPtr[i]) * modelPtr->scalesPtr[i];
+    }
+
+    for (layer = 0; layer < modelPtr->layerCount; layer++)
+    {
+        const layer_t* layerPtr = &modelPtr->layers[layer];
+        const int8_t* weightsPtr = layerPtr->weightsPtr;
+        bool isOutput = (layer == modelPtr->layerCount - 1);
+
+        for (j = 0; j < layerPtr->outputCount; j++)
+        {
+            float sum = 0;
+
+            for (i = 0; i < layerPtr->inputCount; i++)
+            {
+                sum += *weightsPtr++ * inPtr[i];
+            }
+
+            sum = sum * layerPtr->weightScale + layerPtr->biasPtr[j];
+            outPtr[j] = (isOutput || (sum > 0)) ? sum : 0;
+        }
+
+        float* swapPtr = inPtr;
+        inPtr = outPtr;
+        outPtr = swapPtr;
+    }
+
+    // Softmax of the output layer, now in inPtr.
+    double sum = 0;
+
+    for (i = 1; i < modelPtr->classCount; i++)
+    {
+        if (inPtr[i] > inPtr[best])
+        {
+            best = i;
+        }
+    }
+
+    for (i = 0; i < modelPtr->classCount; i++)
+    {
+        sum += exp(inPtr[i] - inPtr[best]);
+    }
+
+    *confidencePtr = 1 / sum;
+    return best;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a model on its complete windows, publish the prediction and start new windows
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunModel
+(
+    model_t* modelPtr,                          ///< [IN] Model
+    double timestamp                            ///< [IN] Timestamp of the last sample
+)
+{
+    double features[SENSOR_INFERENCE_MAX_FEATURES];
+    double confidence;
+    int classIndex;
+    int i;
+    int j;
+    int n = 0;
+
+    for (i = 0; i < modelPtr->inputCount; i++)
+    {
+        if (modelPtr->windows[i].count == 0)
+        {
+            modelPtr->skippedCount++;
+            memset(modelPtr->windows, 0, sizeof(modelPtr->windows));
+            return;
+        }
+
+        for (j = 0; j < modelPtr->selectedCount; j++)
+        {
+            features[n++] = GetFeature(&modelPtr->windows[i], modelPtr->selected[j]);
+        }
+    }
+
+    memset(modelPtr->windows, 0, sizeof(modelPtr->windows));
+
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+
+    if (modelPtr->type == MODEL_TYPE_FOREST)
+    {
+        classIndex = PredictForest(modelPtr, features, &confidence);
+    }
+    else
+    {
+        classIndex = PredictMlp(modelPtr, features, &confidence);
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+    uint32_t elapsedUs = (uint32_t)(elapsed.sec * 1000000 + elapsed.usec);
+
+    modelPtr->inferenceCount++;
+    modelPtr->inferenceTimeUs += elapsedUs;
+    metrics_RecordLatency(modelPtr->latencyBuckets, elapsedUs);
+    modelPtr->lastClass = classIndex;
+    modelPtr->lastConfidence = confidence;
+
+    char json[64 + MAX_LABEL_LEN];
+
+    snprintf(json, sizeof(json), "{\"class\":\"%s\",\"index\":%d,\"confidence\":%.3f}",
+             modelPtr->labels[classIndex], classIndex, confidence);
+    io_PushJson(modelPtr->outputPath, timestamp, json);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the models from the configuration tree
+ */
+//--------------------------------------------------------------------------------------------------
+void inference_Init
+(
+    void
+)
+{
+    char names[SENSOR_INFERENCE_MODEL_COUNT][MAX_NAME_LEN];
+    int nameCount = 0;
+    int i;
+
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(MODELS_ROOT_NODE);
+
+    if (le_cfg_GoToFirstChild(iteratorRef) == LE_OK)
+    {
+        do
+        {
+            if (nameCount >= SENSOR_INFERENCE_MODEL_COUNT)
+            {
+                LE_WARN("Too many models, only %d loaded", SENSOR_INFERENCE_MODEL_COUNT);
+                break;
+            }
+
+            if (le_cfg_GetNodeName(iteratorRef, "", names[nameCount], MAX_NAME_LEN) == LE_OK)
+            {
+                nameCount++;
+            }
+        }
+        while (le_cfg_GoToNextSibling(iteratorRef) == LE_OK);
+    }
+
+    le_cfg_CancelTxn(iteratorRef);
+
+    for (i = 0; i < nameCount; i++)
+    {
+        model_t* modelPtr = &Models[ModelCount];
+
+        if (LoadModel(names[i], modelPtr) == LE_OK)
+        {
+            LE_INFO("Model %s loaded: %u inputs, %u features, %u classes, output %s",
+                    modelPtr->name, modelPtr->inputCount, modelPtr->featureCount,
+                    modelPtr->classCount, modelPtr->outputPath);
+            ModelCount++;
+        }
+    }
+
+    if (ModelCount > 0)
+    {
+        LE_INFO("%d models use %zu of %d bytes", ModelCount, ArenaUsed,
+                SENSOR_INFERENCE_ARENA_SIZE);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the models input a sensor feeds
+ *
+ * @return:
+ *      - Input, NULL if the sensor is not an input of any model
+ */
+//--------------------------------------------------------------------------------------------------
+inference_Input_t* inference_GetInput
+(
+    const char* pathPtr                         ///< [IN] Path of the sensor
+)
+{
+    int i;
+
+    // The first input with the path is the head of its chain.
+    for (i = 0; i < InputCount; i++)
+    {
+        if (strcmp(Inputs[i].path, pathPtr) == 0)
+        {
+            return &Inputs[i];
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a numeric sample to the windows of the models it feeds, and run the models whose window is
+ * complete. Runs on the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void inference_AddSample
+(
+    inference_Input_t* inputPtr,                ///< [IN] Input (or NULL)
+    double timestamp,                           ///< [IN] Timestamp of the sample
+    double value                                ///< [IN] Calibrated value
+)
+{
+    for (; inputPtr != NULL; inputPtr = inputPtr->nextPtr)
+    {
+        model_t* modelPtr = inputPtr->modelPtr;
+        window_t* windowPtr = &modelPtr->windows[inputPtr->index];
+
+        // Welford's update keeps the variance accurate over long windows.
+        windowPtr->count++;
+
+        double delta = value - windowPtr->mean;
+
+        windowPtr->mean += delta / windowPtr->count;
+        windowPtr->m2 += delta * (value - windowPtr->mean);
+        windowPtr->sumSq += value * value;
+
+        if ((windowPtr->count == 1) || (value < windowPtr->min))
+        {
+            windowPtr->min = value;
+        }
+
+        if ((windowPtr->count == 1) || (value > windowPtr->max))
+        {
+            windowPtr->max = value;
+        }
+
+        if ((inputPtr->index == 0) && (windowPtr->count >= modelPtr->windowSize))
+        {
+            RunModel(modelPtr, timestamp);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Provide the state of the model at an index to the metrics endpoint
+ *
+ * @return:
+ *      - true if the model exists
+ */
+//--------------------------------------------------------------------------------------------------
+bool inference_GetMetrics
+(
+    uint32_t index,                             ///< [IN]  Index of the model
+    metrics_Model_t* modelPtr                   ///< [OUT] Model state
+)
+{
+    if (index >= ModelCount)
+    {
+        return false;
+    }
+
+    const model_t* statePtr = &Models[index];
+
+    modelPtr->namePtr = statePtr->name;
+    modelPtr->inferenceCount = statePtr->inferenceCount;
+    modelPtr->skippedCount = statePtr->skippedCount;
+    modelPtr->inferenceTimeUs = statePtr->inferenceTimeUs;
+    modelPtr->latencyBucketsPtr = statePtr->latencyBuckets;
+    modelPtr->lastClass = statePtr->lastClass;
+    modelPtr->lastConfidence = statePtr->lastConfidence;
+
+    return true;
+}
@@ -0,0 +1,99 @@
+//--------------------------------------------------------------------------------------------------
+/** @file inference.h
+ *
+ * Classification of windows of numeric samples with small quantized models (decision trees,
+ * forests and MLPs) preloaded at startup. Models are configured in the configuration tree under
+ * models/<model name>/:
+ *
+ *  - file      (string) model file, see below
+ *  - inputs/   (list)   paths of the numeric sensors the features are computed on
+ *  - features  (string) comma separated features computed per input, in this order:
+ *                       mean, std, min, max, rms, range (default "mean,std,min,max")
+ *  - window    (int)    samples of the first input per window (default 32)
+ *  - labels    (string) comma separated class names (default "0,1,...")
+ *  - output    (string) path of the JSON resource published (default "inference/<model name>")
+ *
+ * The feature vector holds the selected features of the first input, then of the second one, etc.
+ * At the end of each window the predicted class and its confidence are pushed to the output.
+ *
+ * Model files are little-endian:
+ *
+ *  - header:   "SFM1", uint8 type (1 = tree/forest, 2 = MLP), uint8 feature count,
+ *              uint8 class count, uint8 reserved
+ *  - features: per feature, float32 offset and float32 scale; a feature x is used as
+ *              (x - offset) * scale, rounded to int16 for trees
+ *  - forest:   uint16 tree count, uint16 node count, uint16 root node of each tree, then per node
+ *              uint8 feature (255 for a leaf), uint8 class, int16 threshold, uint16 left node,
+ *              uint16 right node. Internal nodes go left when the feature is <= threshold; their
+ *              children must come after them. The threshold of a leaf is its confidence in Q15.
+ *  - MLP:      uint8 layer count, then per layer uint16 inputs, uint16 outputs, float32 weight
+ *              scale, int8 weights (output-major) and float32 biases. Hidden layers use ReLU and
+ *              the output layer softmax.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_INFERENCE_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_INFERENCE_INCLUDE_GUARD
+
+#include "metrics.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Input of one or more models
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct inference_Input inference_Input_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the models from the configuration tree
+ */
+//--------------------------------------------------------------------------------------------------
+void inference_Init
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the models input a sensor feeds
+ *
+ * @return:
+ *      - Input, NULL if the sensor is not an input of any model
+ */
+//--------------------------------------------------------------------------------------------------
+inference_Input_t* inference_GetInput
+(
+    const char* pathPtr                         ///< [IN] Path of the sensor
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a numeric sample to the windows of the models it feeds, and run the models whose window is
+ * complete. Runs on the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void inference_AddSample
+(
+    inference_Input_t* inputPtr,                ///< [IN] Input (or NULL)
+    double timestamp,                           ///< [IN] Timestamp of the sample
+    double value                                ///< [IN] Calibrated value
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Provide the state of the model at an index to the metrics endpoint
+ *
+ * @return:
+ *      - true if the model exists
+ */
+//--------------------------------------------------------------------------------------------------
+bool inference_GetMetrics
+(
+    uint32_t index,                             ///< [IN]  Index of the model
+    metrics_Model_t* modelPtr                   ///< [OUT] Model state
+);
+
+#endif /* LEGATO_SENSOR_FW_INFERENCE_INCLUDE_GUARD */
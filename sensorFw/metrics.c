@@ -0,0 +1,974 @@
+//--------------------------------------------------------------------------------------------------
+/** @file metrics.c
+ *
+ * Prometheus text exposition of the sensor framework metrics on a Unix domain socket.
+ *
+ * Clients are served from the event loop with non-blocking sockets. Once the request is received,
+ * the response is rendered one metric line (or one histogram) at a time into a small buffer that
+ * is refilled only when the socket has accepted its previous content. Framework-wide values and
+ * per-plugin aggregates are snapshot when the response starts; per-sensor values are read as
+ * they are rendered.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <inttypes.h>
+#include "metrics.h"
+#include "config.h"
+
+#if LE_CONFIG_LINUX
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of clients served at the same time. The oldest one is dropped to make room.
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_CLIENTS                     4
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of plugins aggregated, others are reported as "other"
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_PLUGINS                     16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the output buffer of a client, and room kept free before rendering the next item
+ */
+//--------------------------------------------------------------------------------------------------
+#define     OUTPUT_BUFFER_SIZE              8192
+#define     MAX_ITEM_SIZE                   4608
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of a label value before escaping
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_LABEL_LEN                   128
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of a request
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_REQUEST_SIZE                512
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Upper bounds of the callback latency buckets in microseconds, the last bucket is +Inf
+ */
+//--------------------------------------------------------------------------------------------------
+static const uint32_t LatencyBoundsUs[METRICS_LATENCY_BUCKET_COUNT - 1] =
+{
+    10, 100, 1000, 10000, 100000, 1000000, 10000000
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scope of a metric family
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    SCOPE_GLOBAL,
+    SCOPE_POOL,
+    SCOPE_PLUGIN,
+    SCOPE_BUDGET,
+    SCOPE_MODEL,
+    SCOPE_STAGE,
+    SCOPE_SENSOR
+}
+scope_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value reported by a metric family
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    FIELD_REGISTERED,
+    FIELD_QUEUE_DEPTH,
+    FIELD_DROPPED,
+    FIELD_RSS,
+    FIELD_HEAP_USED,
+    FIELD_HEAP_FREE,
+    FIELD_HEAP_FRAGMENTATION,
+    FIELD_HEAP_GROWTH,
+    FIELD_PRESSURE_LEVEL,
+    FIELD_PRESSURE_TRANSITIONS,
+    FIELD_POOL_USED,
+    FIELD_POOL_SIZE,
+    FIELD_SENSORS,
+    FIELD_READS,
+    FIELD_PUSHES,
+    FIELD_FAILURES,
+    FIELD_BYTES,
+    FIELD_CALLBACK_SECONDS,
+    FIELD_PUSH_SECONDS,
+    FIELD_LATENCY,
+    FIELD_LATENESS,
+    FIELD_CPU_PERCENT,
+    FIELD_CPU_BUDGET,
+    FIELD_SAMPLE_RATE,
+    FIELD_RATE_BUDGET,
+    FIELD_MEMORY,
+    FIELD_PERIOD_SCALE,
+    FIELD_THROTTLED,
+    FIELD_INFERENCES,
+    FIELD_SKIPPED,
+    FIELD_CLASS,
+    FIELD_CONFIDENCE
+}
+field_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Metric family
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* namePtr;                        ///< Metric name
+    const char* typePtr;                        ///< counter, gauge or histogram
+    const char* helpPtr;                        ///< Description
+    scope_t scope;                              ///< One value, or one per pool/plugin/sensor
+    field_t field;                              ///< Value reported
+}
+family_t;
+
+static const family_t Families[] =
+{
+    {"sensorfw_registered_sensors", "gauge", "Sensors registered to the framework",
+     SCOPE_GLOBAL, FIELD_REGISTERED},
+    {"sensorfw_queue_depth", "gauge", "Samples staged by plugin threads, not pushed yet",
+     SCOPE_GLOBAL, FIELD_QUEUE_DEPTH},
+    {"sensorfw_queue_dropped_total", "counter", "Samples dropped because a staging ring was full",
+     SCOPE_GLOBAL, FIELD_DROPPED},
+    {"sensorfw_resident_bytes", "gauge", "Resident set size of sensord",
+     SCOPE_GLOBAL, FIELD_RSS},
+    {"sensorfw_heap_used_bytes", "gauge", "Heap allocated by sensord",
+     SCOPE_GLOBAL, FIELD_HEAP_USED},
+    {"sensorfw_heap_free_bytes", "gauge", "Heap free but not returned to the system",
+     SCOPE_GLOBAL, FIELD_HEAP_FREE},
+    {"sensorfw_heap_fragmentation_ratio", "gauge", "Share of the heap arena that is free",
+     SCOPE_GLOBAL, FIELD_HEAP_FRAGMENTATION},
+    {"sensorfw_heap_growth_bytes_per_hour", "gauge", "Heap growth fitted over the last hour",
+     SCOPE_GLOBAL, FIELD_HEAP_GROWTH},
+    {"sensorfw_pressure_level", "gauge", "Pressure level of the system, 0 (none) to 3 (critical)",
+     SCOPE_GLOBAL, FIELD_PRESSURE_LEVEL},
+    {"sensorfw_pressure_transitions_total", "counter", "Changes of the pressure level",
+     SCOPE_GLOBAL, FIELD_PRESSURE_TRANSITIONS},
+    {"sensorfw_pool_used_blocks", "gauge", "Blocks in use in a memory pool",
+     SCOPE_POOL, FIELD_POOL_USED},
+    {"sensorfw_pool_size_blocks", "gauge", "Blocks of a memory pool",
+     SCOPE_POOL, FIELD_POOL_SIZE},
+    {"sensorfw_plugin_sensors", "gauge", "Sensors registered by a plugin",
+     SCOPE_PLUGIN, FIELD_SENSORS},
+    {"sensorfw_plugin_samples_total", "counter", "Samples read from the sensors of a plugin",
+     SCOPE_PLUGIN, FIELD_READS},
+    {"sensorfw_plugin_pushes_total", "counter", "Samples of a plugin pushed to the Data Hub",
+     SCOPE_PLUGIN, FIELD_PUSHES},
+    {"sensorfw_plugin_failures_total", "counter", "Failed sample callbacks of a plugin",
+     SCOPE_PLUGIN, FIELD_FAILURES},
+    {"sensorfw_plugin_callback_seconds_total", "counter", "Time spent in the callbacks of a plugin",
+     SCOPE_PLUGIN, FIELD_CALLBACK_SECONDS},
+    {"sensorfw_plugin_cpu_percent", "gauge", "CPU used by a plugin over the last budget window",
+     SCOPE_BUDGET, FIELD_CPU_PERCENT},
+    {"sensorfw_plugin_cpu_budget_percent", "gauge", "CPU budget of a plugin",
+     SCOPE_BUDGET, FIELD_CPU_BUDGET},
+    {"sensorfw_plugin_sample_rate", "gauge", "Pushes per second of a plugin over the last window",
+     SCOPE_BUDGET, FIELD_SAMPLE_RATE},
+    {"sensorfw_plugin_sample_rate_budget", "gauge", "Push rate budget of a plugin",
+     SCOPE_BUDGET, FIELD_RATE_BUDGET},
+    {"sensorfw_plugin_memory_bytes", "gauge", "Memory held by the framework for a plugin",
+     SCOPE_BUDGET, FIELD_MEMORY},
+    {"sensorfw_plugin_period_scale", "gauge", "Factor applied to the periods of a plugin's sensors",
+     SCOPE_BUDGET, FIELD_PERIOD_SCALE},
+    {"sensorfw_plugin_throttled_total", "counter", "Times the periods of a plugin were stretched",
+     SCOPE_BUDGET, FIELD_THROTTLED},
+    {"sensorfw_inferences_total", "counter", "Inferences run by a model",
+     SCOPE_MODEL, FIELD_INFERENCES},
+    {"sensorfw_inference_skipped_total", "counter", "Windows with an input without samples",
+     SCOPE_MODEL, FIELD_SKIPPED},
+    {"sensorfw_inference_class", "gauge", "Last class predicted by a model",
+     SCOPE_MODEL, FIELD_CLASS},
+    {"sensorfw_inference_confidence", "gauge", "Confidence of the last prediction of a model",
+     SCOPE_MODEL, FIELD_CONFIDENCE},
+    {"sensorfw_inference_seconds", "histogram", "Latency of the inferences of a model",
+     SCOPE_MODEL, FIELD_LATENCY},
+    {"sensorfw_trace_stage_seconds", "histogram", "Latency of a stage of the traced samples",
+     SCOPE_STAGE, FIELD_LATENCY},
+    {"sensorfw_samples_total", "counter", "Samples read from a sensor",
+     SCOPE_SENSOR, FIELD_READS},
+    {"sensorfw_pushes_total", "counter", "Samples of a sensor pushed to the Data Hub",
+     SCOPE_SENSOR, FIELD_PUSHES},
+    {"sensorfw_failures_total", "counter", "Failed sample callbacks of a sensor",
+     SCOPE_SENSOR, FIELD_FAILURES},
+    {"sensorfw_push_bytes_total", "counter", "Bytes of sample data of a sensor pushed",
+     SCOPE_SENSOR, FIELD_BYTES},
+    {"sensorfw_push_seconds_total", "counter", "Time spent pushing the samples of a sensor",
+     SCOPE_SENSOR, FIELD_PUSH_SECONDS},
+    {"sensorfw_callback_seconds", "histogram", "Latency of the sample callback of a sensor",
+     SCOPE_SENSOR, FIELD_LATENCY},
+    {"sensorfw_sample_lateness_seconds", "histogram",
+     "Delay of the periodic samples of a sensor past their due time", SCOPE_SENSOR, FIELD_LATENESS}
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Aggregated metrics of a plugin
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char name[32];                              ///< Name of the plugin
+    uint32_t sensorCount;                       ///< Registered sensors
+    uint64_t readCount;                         ///< Samples read
+    uint64_t pushCount;                         ///< Samples pushed
+    uint64_t failureCount;                      ///< Failed callbacks
+    uint64_t callbackTimeUs;                    ///< Time spent in the callbacks
+}
+plugin_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Connected client
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int fd;                                     ///< Socket (-1 if the slot is free)
+    le_fdMonitor_Ref_t monitorRef;              ///< Monitor of the socket
+    le_clk_Time_t connectTime;                  ///< Relative time of the connection
+    char request[MAX_REQUEST_SIZE];             ///< Request received so far
+    size_t requestLen;                          ///< Bytes of request
+    bool isResponding;                          ///< Is the response being written?
+    size_t family;                              ///< Family being rendered
+    uint32_t item;                              ///< Item of the family being rendered
+    metrics_Global_t global;                    ///< Framework-wide metrics snapshot
+    plugin_t plugins[MAX_PLUGINS];              ///< Per-plugin aggregates snapshot
+    int pluginCount;                            ///< Number of plugins
+    char output[OUTPUT_BUFFER_SIZE];            ///< Rendered output not written yet
+    size_t outputLen;                           ///< Bytes rendered
+    size_t outputPos;                           ///< Bytes written
+}
+client_t;
+
+static client_t Clients[MAX_CLIENTS];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Providers of the metrics
+ */
+//--------------------------------------------------------------------------------------------------
+static metrics_GetSensorFunc_t GetSensor;
+static metrics_GetGlobalFunc_t GetGlobal;
+static metrics_GetBudgetFunc_t GetBudget;
+static metrics_GetModelFunc_t GetModel;
+static metrics_GetStageFunc_t GetStage;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append formatted text to the output of a client
+ */
+//--------------------------------------------------------------------------------------------------
+static void Append
+(
+    client_t* clientPtr,                        ///< [IN] Client
+    const char* formatPtr,                      ///< [IN] printf format
+    ...
+)
+{
+    va_list args;
+    size_t room = sizeof(clientPtr->output) - clientPtr->outputLen;
+
+    va_start(args, formatPtr);
+    int res = vsnprintf(clientPtr->output + clientPtr->outputLen, room, formatPtr, args);
+    va_end(args);
+
+    if (res > 0)
+    {
+        clientPtr->outputLen += ((size_t)res < room) ? (size_t)res : (room - 1);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Escape a label value
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* EscapeLabel
+(
+    const char* valuePtr,                       ///< [IN]  Label value
+    char* bufferPtr,                            ///< [OUT] Escaped value
+    size_t bufferSize                           ///< [IN]  Buffer size
+)
+{
+    size_t len = 0;
+
+    for (; (*valuePtr != '\0') && (len + 2 < bufferSize); valuePtr++)
+    {
+        if ((*valuePtr == '\\') || (*valuePtr == '"'))
+        {
+            bufferPtr[len++] = '\\';
+            bufferPtr[len++] = *valuePtr;
+        }
+        else if (*valuePtr == '\n')
+        {
+            bufferPtr[len++] = '\\';
+            bufferPtr[len++] = 'n';
+        }
+        else
+        {
+            bufferPtr[len++] = *valuePtr;
+        }
+    }
+
+    bufferPtr[len] = '\0';
+    return bufferPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Aggregate the per-sensor metrics by plugin
+ */
+//--------------------------------------------------------------------------------------------------
+static void AggregatePlugins
+(
+    client_t* clientPtr                         ///< [IN] Client
+)
+{
+    metrics_Sensor_t sensor;
+    uint32_t index;
+    int i;
+
+    clientPtr->pluginCount = 0;
+
+    for (index = 0; GetSensor(index, &sensor); index++)
+    {
+        const char* namePtr = (sensor.pluginPtr[0] != '\0') ? sensor.pluginPtr : "unknown";
+        plugin_t* pluginPtr = NULL;
+
+        for (i = 0; (i < clientPtr->pluginCount) && (pluginPtr == NULL); i++)
+        {
+            if (strcmp(clientPtr->plugins[i].name, namePtr) == 0)
+            {
+                pluginPtr = &clientPtr->plugins[i];
+            }
+        }
+
+        if ((pluginPtr == NULL) && (clientPtr->pluginCount < MAX_PLUGINS))
+        {
+            pluginPtr = &clientPtr->plugins[clientPtr->pluginCount++];
+            memset(pluginPtr, 0, sizeof(*pluginPtr));
+            le_utf8_Copy(pluginPtr->name,
+                         (clientPtr->pluginCount < MAX_PLUGINS) ? namePtr : "other",
+                         sizeof(pluginPtr->name),
+                         NULL);
+        }
+        else if (pluginPtr == NULL)
+        {
+            pluginPtr = &clientPtr->plugins[MAX_PLUGINS - 1];
+        }
+
+        pluginPtr->sensorCount++;
+        pluginPtr->readCount += sensor.readCount;
+        pluginPtr->pushCount += sensor.pushCount;
+        pluginPtr->failureCount += sensor.failureCount;
+        pluginPtr->callbackTimeUs += sensor.callbackTimeUs;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Render a latency histogram
+ */
+//--------------------------------------------------------------------------------------------------
+static void RenderHistogram
+(
+    client_t* clientPtr,                        ///< [IN] Client
+    const char* namePtr,                        ///< [IN] Metric name
+    const char* labelsPtr,                      ///< [IN] Labels of the sensor or model
+    const uint32_t* bucketsPtr,                 ///< [IN] Counts per bucket (not cumulative)
+    uint64_t sumUs                              ///< [IN] Sum of the observations
+)
+{
+    uint64_t cumulative = 0;
+    int i;
+
+    for (i = 0; i < METRICS_LATENCY_BUCKET_COUNT; i++)
+    {
+        cumulative += __atomic_load_n(&bucketsPtr[i], __ATOMIC_RELAXED);
+
+        if (i < METRICS_LATENCY_BUCKET_COUNT - 1)
+        {
+            Append(clientPtr, "%s_bucket{%s,le=\"%g\"} %" PRIu64 "\n",
+                   namePtr, labelsPtr, LatencyBoundsUs[i] / 1000000.0, cumulative);
+        }
+        else
+        {
+            Append(clientPtr, "%s_bucket{%s,le=\"+Inf\"} %" PRIu64 "\n",
+                   namePtr, labelsPtr, cumulative);
+        }
+    }
+
+    Append(clientPtr, "%s_sum{%s} %.6f\n", namePtr, labelsPtr, sumUs / 1000000.0);
+    Append(clientPtr, "%s_count{%s} %" PRIu64 "\n", namePtr, labelsPtr, cumulative);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Render the next item of the response
+ *
+ * @return:
+ *      - false when the response is complete
+ */
+//--------------------------------------------------------------------------------------------------
+static bool RenderNext
+(
+    client_t* clientPtr                         ///< [IN] Client
+)
+{
+    char escaped[2][2 * MAX_LABEL_LEN + 1];
+    char labels[sizeof(escaped) + 32];
+    metrics_Sensor_t sensor;
+    metrics_Budget_t budget;
+    metrics_Model_t model;
+    metrics_Stage_t stage;
+
+    if (clientPtr->family >= NUM_ARRAY_MEMBERS(Families))
+    {
+        return false;
+    }
+
+    const family_t* familyPtr = &Families[clientPtr->family];
+    const metrics_Global_t* globalPtr = &clientPtr->global;
+
+    if (clientPtr->item == 0)
+    {
+        Append(clientPtr, "# HELP %s %s\n# TYPE %s %s\n",
+               familyPtr->namePtr, familyPtr->helpPtr, familyPtr->namePtr, familyPtr->typePtr);
+    }
+
+    switch (familyPtr->scope)
+    {
+        case SCOPE_GLOBAL:
+        {
+            double value;
+
+            switch (familyPtr->field)
+            {
+                case FIELD_REGISTERED:          value = globalPtr->registeredCount;     break;
+                case FIELD_QUEUE_DEPTH:         value = globalPtr->queueDepth;          break;
+                case FIELD_DROPPED:             value = globalPtr->droppedCount;        break;
+                case FIELD_RSS:                 value = globalPtr->rssBytes;            break;
+                case FIELD_HEAP_USED:           value = globalPtr->heapUsedBytes;       break;
+                case FIELD_HEAP_FREE:           value = globalPtr->heapFreeBytes;       break;
+                case FIELD_HEAP_FRAGMENTATION:  value = globalPtr->heapFragmentation;   break;
+                case FIELD_PRESSURE_LEVEL:      value = globalPtr->pressureLevel;       break;
+                case FIELD_PRESSURE_TRANSITIONS: value = globalPtr->pressureTransitionCount; break;
+                default:                        value = globalPtr->heapGrowthPerHour;   break;
+            }
+
+            Append(clientPtr, "%s %.15g\n", familyPtr->namePtr, value);
+            clientPtr->family++;
+            clientPtr->item = 0;
+            return true;
+        }
+
+        case SCOPE_POOL:
+            if (clientPtr->item < globalPtr->poolCount)
+            {
+                const metrics_Pool_t* poolPtr = &globalPtr->pools[clientPtr->item];
+
+                Append(clientPtr, "%s{pool=\"%s\"} %" PRIu32 "\n",
+                       familyPtr->namePtr,
+                       poolPtr->namePtr,
+                       (familyPtr->field == FIELD_POOL_USED) ? poolPtr->used : poolPtr->size);
+                clientPtr->item++;
+                return true;
+            }
+            break;
+
+        case SCOPE_PLUGIN:
+            if (clientPtr->item < clientPtr->pluginCount)
+            {
+                const plugin_t* pluginPtr = &clientPtr->plugins[clientPtr->item];
+
+                snprintf(labels, sizeof(labels), "plugin=\"%s\"",
+                         EscapeLabel(pluginPtr->name, escaped[0], sizeof(escaped[0])));
+
+                if (familyPtr->field == FIELD_CALLBACK_SECONDS)
+                {
+                    Append(clientPtr, "%s{%s} %.6f\n", familyPtr->namePtr, labels,
+                           pluginPtr->callbackTimeUs / 1000000.0);
+                }
+                else
+                {
+                    uint64_t value = (familyPtr->field == FIELD_SENSORS) ? pluginPtr->sensorCount :
+                                     (familyPtr->field == FIELD_READS) ? pluginPtr->readCount :
+                                     (familyPtr->field == FIELD_PUSHES) ? pluginPtr->pushCount :
+                                     pluginPtr->failureCount;
+
+                    Append(clientPtr, "%s{%s} %" PRIu64 "\n", familyPtr->namePtr, labels, value);
+                }
+
+                clientPtr->item++;
+                return true;
+            }
+            break;
+
+        case SCOPE_BUDGET:
+            if (GetBudget(clientPtr->item, &budget))
+            {
+                snprintf(labels, sizeof(labels), "plugin=\"%s\"",
+                         EscapeLabel(budget.pluginPtr, escaped[0], sizeof(escaped[0])));
+
+                switch (familyPtr->field)
+                {
+                    case FIELD_MEMORY:
+                        Append(clientPtr, "%s{%s} %" PRId64 "\n", familyPtr->namePtr, labels,
+                               budget.memoryBytes);
+                        break;
+
+                    case FIELD_THROTTLED:
+                        Append(clientPtr, "%s{%s} %" PRIu32 "\n", familyPtr->namePtr, labels,
+                               budget.throttleCount);
+                        break;
+
+                    default:
+                    {
+                        double value = (familyPtr->field == FIELD_CPU_PERCENT) ? budget.cpuPercent :
+                                       (familyPtr->field == FIELD_CPU_BUDGET) ? budget.cpuBudget :
+                                       (familyPtr->field == FIELD_SAMPLE_RATE) ? budget.sampleRate :
+                                       (familyPtr->field == FIELD_RATE_BUDGET) ? budget.rateBudget :
+                                       budget.periodScale;
+
+                        // Budgets that are not configured are not reported.
+                        if (((familyPtr->field == FIELD_CPU_BUDGET) ||
+                             (familyPtr->field == FIELD_RATE_BUDGET)) && (value <= 0))
+                        {
+                            break;
+                        }
+
+                        Append(clientPtr, "%s{%s} %g\n", familyPtr->namePtr, labels, value);
+                        break;
+                    }
+                }
+
+                clientPtr->item++;
+                return true;
+            }
+            break;
+
+        case SCOPE_MODEL:
+            if (GetModel(clientPtr->item, &model))
+            {
+                snprintf(labels, sizeof(labels), "model=\"%s\"",
+                         EscapeLabel(model.namePtr, escaped[0], sizeof(escaped[0])));
+
+                switch (familyPtr->field)
+                {
+                    case FIELD_LATENCY:
+                        RenderHistogram(clientPtr, familyPtr->namePtr, labels,
+                                        model.latencyBucketsPtr, model.inferenceTimeUs);
+                        break;
+
+                    case FIELD_CLASS:
+                    case FIELD_CONFIDENCE:
+                        // Nothing to report before the first prediction.
+                        if (model.lastClass < 0)
+                        {
+                            break;
+                        }
+
+                        Append(clientPtr, "%s{%s} %g\n", familyPtr->namePtr, labels,
+                               (familyPtr->field == FIELD_CLASS) ? (double)model.lastClass :
+                                                                   model.lastConfidence);
+                        break;
+
+                    default:
+                        Append(clientPtr, "%s{%s} %" PRIu64 "\n", familyPtr->namePtr, labels,
+                               (familyPtr->field == FIELD_INFERENCES) ? model.inferenceCount :
+                                                                        model.skippedCount);
+                        break;
+                }
+
+                clientPtr->item++;
+                return true;
+            }
+            break;
+
+        case SCOPE_STAGE:
+            if (GetStage(clientPtr->item, &stage))
+            {
+                snprintf(labels, sizeof(labels), "stage=\"%s\"", stage.namePtr);
+                RenderHistogram(clientPtr, familyPtr->namePtr, labels,
+                                stage.latencyBucketsPtr, stage.totalUs);
+                clientPtr->item++;
+                return true;
+            }
+            break;
+
+        case SCOPE_SENSOR:
+            if (GetSensor(clientPtr->item, &sensor))
+            {
+                snprintf(labels, sizeof(labels), "sensor=\"%s\",plugin=\"%s\"",
+                         EscapeLabel(sensor.pathPtr, escaped[0], sizeof(escaped[0])),
+                         EscapeLabel((sensor.pluginPtr[0] != '\0') ? sensor.pluginPtr : "unknown",
+                                     escaped[1],
+                                     sizeof(escaped[1])));
+
+                switch (familyPtr->field)
+                {
+                    case FIELD_LATENCY:
+                        RenderHistogram(clientPtr, familyPtr->namePtr, labels,
+                                        sensor.latencyBucketsPtr, sensor.callbackTimeUs);
+                        break;
+
+                    case FIELD_LATENESS:
+                        RenderHistogram(clientPtr, familyPtr->namePtr, labels,
+                                        sensor.latenessBucketsPtr, sensor.latenessTimeUs);
+                        break;
+
+                    case FIELD_PUSH_SECONDS:
+                        Append(clientPtr, "%s{%s} %.6f\n", familyPtr->namePtr, labels,
+                               sensor.pushTimeUs / 1000000.0);
+                        break;
+
+                    default:
+                    {
+                        uint64_t value =
+                            (familyPtr->field == FIELD_READS) ? sensor.readCount :
+                            (familyPtr->field == FIELD_PUSHES) ? sensor.pushCount :
+                            (familyPtr->field == FIELD_FAILURES) ? sensor.failureCount :
+                            sensor.bytesPushed;
+
+                        Append(clientPtr, "%s{%s} %" PRIu64 "\n", familyPtr->namePtr, labels,
+                               value);
+                        break;
+                    }
+                }
+
+                clientPtr->item++;
+                return true;
+            }
+            break;
+    }
+
+    // All the items of the family were rendered.
+    clientPtr->family++;
+    clientPtr->item = 0;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Disconnect a client
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseClient
+(
+    client_t* clientPtr                         ///< [IN] Client
+)
+{
+    le_fdMonitor_Delete(clientPtr->monitorRef);
+    close(clientPtr->fd);
+    clientPtr->fd = -1;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start the response once the request is received
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartResponse
+(
+    client_t* clientPtr                         ///< [IN] Client
+)
+{
+    clientPtr->isResponding = true;
+    clientPtr->family = 0;
+    clientPtr->item = 0;
+    clientPtr->outputLen = 0;
+    clientPtr->outputPos = 0;
+
+    memset(&clientPtr->global, 0, sizeof(clientPtr->global));
+    GetGlobal(&clientPtr->global);
+    AggregatePlugins(clientPtr);
+
+    // Answer HTTP requests (e.g. curl --unix-socket) with a header, anything else with the text.
+    if (strncmp(clientPtr->request, "GET ", 4) == 0)
+    {
+        Append(clientPtr, "HTTP/1.0 200 OK\r\n"
+                          "Content-Type: text/plain; version=0.0.4\r\n"
+                          "Connection: close\r\n\r\n");
+    }
+
+    le_fdMonitor_Disable(clientPtr->monitorRef, POLLIN);
+    le_fdMonitor_Enable(clientPtr->monitorRef, POLLOUT);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write as much of the response as the socket accepts
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteResponse
+(
+    client_t* clientPtr                         ///< [IN] Client
+)
+{
+    for (;;)
+    {
+        if (clientPtr->outputPos == clientPtr->outputLen)
+        {
+            clientPtr->outputLen = 0;
+            clientPtr->outputPos = 0;
+
+            while ((clientPtr->outputLen + MAX_ITEM_SIZE < sizeof(clientPtr->output)) &&
+                   RenderNext(clientPtr))
+            {
+            }
+
+            if (clientPtr->outputLen == 0)
+            {
+                CloseClient(clientPtr);
+                return;
+            }
+        }
+
+        ssize_t written = send(clientPtr->fd,
+                               clientPtr->output + clientPtr->outputPos,
+                               clientPtr->outputLen - clientPtr->outputPos,
+                               MSG_NOSIGNAL);
+
+        if (written < 0)
+        {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+            {
+                CloseClient(clientPtr);
+            }
+            return;
+        }
+
+        clientPtr->outputPos += written;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the request of a client
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadRequest
+(
+    client_t* clientPtr                         ///< [IN] Client
+)
+{
+    size_t room = sizeof(clientPtr->request) - 1 - clientPtr->requestLen;
+    ssize_t len = recv(clientPtr->fd, clientPtr->request + clientPtr->requestLen, room, 0);
+
+    if (len < 0)
+    {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+        {
+            CloseClient(clientPtr);
+        }
+        return;
+    }
+
+    clientPtr->requestLen += len;
+    clientPtr->request[clientPtr->requestLen] = '\0';
+
+    // Respond at the end of the request headers, or when the client is done sending.
+    if ((len == 0) || ((size_t)len == room) ||
+        (strstr(clientPtr->request, "\r\n\r\n") != NULL) ||
+        (strstr(clientPtr->request, "\n\n") != NULL))
+    {
+        StartResponse(clientPtr);
+        WriteResponse(clientPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle events on a client socket
+ */
+//--------------------------------------------------------------------------------------------------
+static void ClientHandler
+(
+    int fd,                                     ///< [IN] Socket
+    short events                                ///< [IN] Events
+)
+{
+    client_t* clientPtr = le_fdMonitor_GetContextPtr();
+
+    if (!clientPtr->isResponding && (events & POLLIN))
+    {
+        ReadRequest(clientPtr);
+    }
+    else if (clientPtr->isResponding && (events & POLLOUT))
+    {
+        WriteResponse(clientPtr);
+    }
+    else if (events & (POLLERR | POLLHUP | POLLRDHUP))
+    {
+        CloseClient(clientPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a free client slot, dropping the oldest client if none is free
+ */
+//--------------------------------------------------------------------------------------------------
+static client_t* GetClientSlot
+(
+    void
+)
+{
+    client_t* oldestPtr = &Clients[0];
+    int i;
+
+    for (i = 0; i < MAX_CLIENTS; i++)
+    {
+        if (Clients[i].fd < 0)
+        {
+            return &Clients[i];
+        }
+
+        if (le_clk_Compare(oldestPtr->connectTime, Clients[i].connectTime) > 0)
+        {
+            oldestPtr = &Clients[i];
+        }
+    }
+
+    LE_WARN("Too many metrics clients, dropping the oldest one");
+    CloseClient(oldestPtr);
+
+    return oldestPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Accept a new client
+ */
+//--------------------------------------------------------------------------------------------------
+static void AcceptHandler
+(
+    int fd,                                     ///< [IN] Listening socket
+    short events                                ///< [IN] Events
+)
+{
+#if LE_CONFIG_LINUX
+    int clientFd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+    if (clientFd < 0)
+    {
+        return;
+    }
+
+    client_t* clientPtr = GetClientSlot();
+
+    clientPtr->fd = clientFd;
+    clientPtr->connectTime = le_clk_GetRelativeTime();
+    clientPtr->requestLen = 0;
+    clientPtr->request[0] = '\0';
+    clientPtr->isResponding = false;
+    clientPtr->monitorRef = le_fdMonitor_Create("metricsClient", clientFd, ClientHandler, POLLIN);
+    le_fdMonitor_SetContextPtr(clientPtr->monitorRef, clientPtr);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start serving the metrics on the Unix socket SENSOR_METRICS_SOCKET_PATH
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNSUPPORTED if Unix sockets are not available
+ *      - LE_FAULT if the socket cannot be created
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t metrics_Init
+(
+    metrics_GetSensorFunc_t getSensorFunc,      ///< [IN] Provider of the per-sensor metrics
+    metrics_GetGlobalFunc_t getGlobalFunc,      ///< [IN] Provider of the framework-wide metrics
+    metrics_GetBudgetFunc_t getBudgetFunc,      ///< [IN] Provider of the per-plugin budget state
+    metrics_GetModelFunc_t getModelFunc,        ///< [IN] Provider of the inference model state
+    metrics_GetStageFunc_t getStageFunc         ///< [IN] Provider of the trace stage latencies
+)
+{
+#if LE_CONFIG_LINUX
+    struct sockaddr_un addr;
+    int i;
+
+    GetSensor = getSensorFunc;
+    GetGlobal = getGlobalFunc;
+    GetBudget = getBudgetFunc;
+    GetModel = getModelFunc;
+    GetStage = getStageFunc;
+
+    for (i = 0; i < MAX_CLIENTS; i++)
+    {
+        Clients[i].fd = -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (fd < 0)
+    {
+        LE_ERROR("Cannot create metrics socket: %m");
+        return LE_FAULT;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    le_utf8_Copy(addr.sun_path, SENSOR_METRICS_SOCKET_PATH, sizeof(addr.sun_path), NULL);
+    unlink(addr.sun_path);
+
+    if ((bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) || (listen(fd, MAX_CLIENTS) != 0))
+    {
+        LE_ERROR("Cannot listen on %s: %m", SENSOR_METRICS_SOCKET_PATH);
+        close(fd);
+        return LE_FAULT;
+    }
+
+    le_fdMonitor_Create("metrics", fd, AcceptHandler, POLLIN);
+    LE_INFO("Serving metrics on %s", SENSOR_METRICS_SOCKET_PATH);
+
+    return LE_OK;
+#else
+    return LE_UNSUPPORTED;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count a callback in a latency histogram. May be called from any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void metrics_RecordLatency
+(
+    uint32_t* bucketsPtr,                       ///< [INOUT] METRICS_LATENCY_BUCKET_COUNT buckets
+    uint32_t latencyUs                          ///< [IN]    Latency of the callback
+)
+{
+    int i = 0;
+
+    while ((i < METRICS_LATENCY_BUCKET_COUNT - 1) && (latencyUs > LatencyBoundsUs[i]))
+    {
+        i++;
+    }
+
+    __atomic_add_fetch(&bucketsPtr[i], 1, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,229 @@
+//--------------------------------------------------------------------------------------------------
+/** @file metrics.h
+ *
+ * Metrics of the sensor framework served in the Prometheus text exposition format on a Unix
+ * domain socket. The response is rendered and written in small chunks from the event loop as the
+ * socket drains, so a slow or stuck client never delays sampling.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_METRICS_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_METRICS_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of buckets of the callback latency histogram, including the +Inf bucket
+ */
+//--------------------------------------------------------------------------------------------------
+#define     METRICS_LATENCY_BUCKET_COUNT        8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of memory pools reported
+ */
+//--------------------------------------------------------------------------------------------------
+#define     METRICS_MAX_POOLS                   4
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Metrics of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* pathPtr;                        ///< Path of the sensor
+    const char* pluginPtr;                      ///< Name of the plugin ("" if unknown)
+    uint32_t readCount;                         ///< Samples read from the plugin
+    uint32_t pushCount;                         ///< Samples pushed to datahub
+    uint32_t failureCount;                      ///< Failed callbacks
+    uint64_t callbackTimeUs;                    ///< Total time spent in the sample callback
+    uint64_t pushTimeUs;                        ///< Total time spent pushing
+    uint64_t bytesPushed;                       ///< Bytes of sample data pushed
+    const uint32_t* latencyBucketsPtr;          ///< Callbacks per latency bucket (not cumulative)
+    uint64_t latenessTimeUs;                    ///< Total delay of the periodic samples
+    const uint32_t* latenessBucketsPtr;         ///< Samples per lateness bucket (not cumulative)
+}
+metrics_Sensor_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Usage of a memory pool
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* namePtr;                        ///< Name of the pool
+    uint32_t used;                              ///< Blocks in use
+    uint32_t size;                              ///< Total number of blocks
+}
+metrics_Pool_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Framework-wide metrics
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t registeredCount;                   ///< Registered sensors
+    uint32_t queueDepth;                        ///< Samples staged by plugin threads
+    uint32_t droppedCount;                      ///< Staged samples dropped
+    uint64_t rssBytes;                          ///< Resident set size of the process
+    uint64_t heapUsedBytes;                     ///< Heap allocated
+    uint64_t heapFreeBytes;                     ///< Heap free but not returned to the system
+    double heapFragmentation;                   ///< Share of the heap arena that is free
+    double heapGrowthPerHour;                   ///< Fitted heap growth in bytes per hour
+    uint32_t pressureLevel;                     ///< Pressure level (0 none to 3 critical)
+    uint32_t pressureTransitionCount;           ///< Pressure level changes
+    int poolCount;                              ///< Number of pools
+    metrics_Pool_t pools[METRICS_MAX_POOLS];    ///< Memory pools
+}
+metrics_Global_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Budget state of a plugin
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* pluginPtr;                      ///< Name of the plugin
+    double cpuPercent;                          ///< CPU usage over the last budget window
+    double cpuBudget;                           ///< CPU budget in percent (0 if none)
+    double sampleRate;                          ///< Pushes per second over the last budget window
+    double rateBudget;                          ///< Push rate budget (0 if none)
+    int64_t memoryBytes;                        ///< Memory held by the framework for the plugin
+    double periodScale;                         ///< Factor applied to the periods of its sensors
+    uint32_t throttleCount;                     ///< Number of times the periods were stretched
+}
+metrics_Budget_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of an inference model
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* namePtr;                        ///< Name of the model
+    uint64_t inferenceCount;                    ///< Inferences run
+    uint64_t skippedCount;                      ///< Windows skipped for lack of samples
+    uint64_t inferenceTimeUs;                   ///< Total time spent in inference
+    const uint32_t* latencyBucketsPtr;          ///< Inferences per latency bucket (not cumulative)
+    int lastClass;                              ///< Last class predicted (-1 if none)
+    double lastConfidence;                      ///< Confidence of the last prediction
+}
+metrics_Model_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Latency distribution of a stage of the traced samples
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* namePtr;                        ///< Name of the stage
+    uint64_t totalUs;                           ///< Total latency of the stage
+    const uint32_t* latencyBucketsPtr;          ///< Samples per latency bucket (not cumulative)
+}
+metrics_Stage_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function providing the metrics of the sensor at an index
+ *
+ * @return:
+ *      - true if the sensor exists
+ */
+//--------------------------------------------------------------------------------------------------
+typedef bool (*metrics_GetSensorFunc_t)
+(
+    uint32_t index,                             ///< [IN]  Index of the sensor
+    metrics_Sensor_t* sensorPtr                 ///< [OUT] Metrics
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function providing the framework-wide metrics
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*metrics_GetGlobalFunc_t)
+(
+    metrics_Global_t* globalPtr                 ///< [OUT] Metrics
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function providing the budget state of the plugin at an index
+ *
+ * @return:
+ *      - true if the plugin exists
+ */
+//--------------------------------------------------------------------------------------------------
+typedef bool (*metrics_GetBudgetFunc_t)
+(
+    uint32_t index,                             ///< [IN]  Index of the plugin
+    metrics_Budget_t* budgetPtr                 ///< [OUT] Budget state
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function providing the state of the inference model at an index
+ *
+ * @return:
+ *      - true if the model exists
+ */
+//--------------------------------------------------------------------------------------------------
+typedef bool (*metrics_GetModelFunc_t)
+(
+    uint32_t index,                             ///< [IN]  Index of the model
+    metrics_Model_t* modelPtr                   ///< [OUT] Model state
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function providing the latency distribution of the trace stage at an index
+ *
+ * @return:
+ *      - true if the stage exists
+ */
+//--------------------------------------------------------------------------------------------------
+typedef bool (*metrics_GetStageFunc_t)
+(
+    uint32_t index,                             ///< [IN]  Index of the stage
+    metrics_Stage_t* stagePtr                   ///< [OUT] Latency distribution
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start serving the metrics on the Unix socket SENSOR_METRICS_SOCKET_PATH
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNSUPPORTED if Unix sockets are not available
+ *      - LE_FAULT if the socket cannot be created
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t metrics_Init
+(
+    metrics_GetSensorFunc_t getSensorFunc,      ///< [IN] Provider of the per-sensor metrics
+    metrics_GetGlobalFunc_t getGlobalFunc,      ///< [IN] Provider of the framework-wide metrics
+    metrics_GetBudgetFunc_t getBudgetFunc,      ///< [IN] Provider of the per-plugin budget state
+    metrics_GetModelFunc_t getModelFunc,        ///< [IN] Provider of the inference model state
+    metrics_GetStageFunc_t getStageFunc         ///< [IN] Provider of the trace stage latencies
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count a callback in a latency histogram. May be called from any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void metrics_RecordLatency
+(
+    uint32_t* bucketsPtr,                       ///< [INOUT] METRICS_LATENCY_BUCKET_COUNT buckets
+    uint32_t latencyUs                          ///< [IN]    Latency of the callback
+);
+
+#endif /* LEGATO_SENSOR_FW_METRICS_INCLUDE_GUARD */
@@ -0,0 +1,559 @@
+//--------------------------------------------------------------------------------------------------
+/** @file pressure.c
+ *
+ * Pressure-aware throttling of the sensors.
+ *
+ * A PSI trigger is set on each /proc/pressure/ file, so that a burst of stall raises the level as
+ * soon as it happens rather than at the next check. Every SENSOR_PRESSURE_CHECK_PERIOD seconds the
+ * 10 s "some" average of each file and the last temperature are compared with the thresholds. A
+ * source only goes down a level once it is below the threshold by a hysteresis margin, and the
+ * level of the system only goes down one level at a time, SENSOR_PRESSURE_HOLD_TIME seconds after
+ * its last change, so that the sensors are restored gradually and do not flap.
+ *
+ * Level changes are logged, counted in the metrics and pushed to the pressure/state resource.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <math.h>
+#include "interfaces.h"
+#include "pressure.h"
+#include "config.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Node of the configuration tree under which the thresholds are read
+ */
+//--------------------------------------------------------------------------------------------------
+#define     PRESSURE_ROOT_NODE              "pressure"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resource the level changes are pushed to
+ */
+//--------------------------------------------------------------------------------------------------
+#define     PRESSURE_STATE_PATH             "pressure/state"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default sensor of the temperature of the device (published by the DM plugin)
+ */
+//--------------------------------------------------------------------------------------------------
+#define     DEFAULT_TEMPERATURE_PATH        "device/temperature"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * PSI trigger: 150 ms of stall of some tasks within a 2 s window. The window is a multiple of 2 s
+ * so that the trigger is also accepted from unprivileged processes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define     PSI_TRIGGER                     "some 150000 2000000"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Names of the levels, as reported
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* const LevelNames[PRESSURE_LEVEL_COUNT] =
+{
+    "none", "moderate", "severe", "critical"
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Factor applied to the periods, per level and priority
+ */
+//--------------------------------------------------------------------------------------------------
+static const double PeriodScales[PRESSURE_LEVEL_COUNT][PRESSURE_PRIORITY_COUNT] =
+{
+    //  low     normal  high
+    {   1,      1,      1   },      // none
+    {   4,      1,      1   },      // moderate
+    {   16,     4,      1   },      // severe
+    {   64,     16,     1   },      // critical
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Source of pressure
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* namePtr;                        ///< Name of the source
+    const char* filePtr;                        ///< PSI file, NULL for the temperature
+    double thresholds[PRESSURE_LEVEL_COUNT];    ///< Threshold of each level above none
+    double hysteresis;                          ///< Margin below a threshold to leave its level
+    double value;                               ///< Last reading, NAN if none
+    int fd;                                     ///< Open PSI file, -1 if none
+    pressure_Level_t level;                     ///< Level of the source
+    bool isTriggered;                           ///< Has the stall trigger fired since the check?
+}
+source_t;
+
+static source_t Sources[] =
+{
+    { "cpu",            "/proc/pressure/cpu",       { 0, 25, 50, 75 },  5,  NAN, -1 },
+    { "io",             "/proc/pressure/io",        { 0, 20, 40, 60 },  5,  NAN, -1 },
+    { "memory",         "/proc/pressure/memory",    { 0, 10, 20, 40 },  5,  NAN, -1 },
+    { "temperature",    NULL,                       { 0, 75, 85, 95 },  3,  NAN, -1 },
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Temperature source, and path of its sensor
+ */
+//--------------------------------------------------------------------------------------------------
+static source_t* const TemperatureSourcePtr = &Sources[NUM_ARRAY_MEMBERS(Sources) - 1];
+static char TemperaturePath[IO_MAX_RESOURCE_PATH_LEN];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Current level of the system, when it last changed and number of changes
+ */
+//--------------------------------------------------------------------------------------------------
+static pressure_Level_t Level;
+static le_clk_Time_t LevelChangeTime;
+static uint32_t TransitionCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Is throttling enabled, and function called when the level changes
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsEnabled;
+static pressure_LevelFunc_t LevelFunc;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the 10 s average of the stall of some tasks from a PSI file
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadStall
+(
+    source_t* sourcePtr                         ///< [IN] Source
+)
+{
+#if LE_CONFIG_LINUX
+    char buffer[256];
+    double avg10;
+    ssize_t len;
+
+    if (sourcePtr->fd < 0)
+    {
+        return;
+    }
+
+    len = pread(sourcePtr->fd, buffer, sizeof(buffer) - 1, 0);
+
+    if (len <= 0)
+    {
+        return;
+    }
+
+    buffer[len] = '\0';
+
+    if (sscanf(buffer, "some avg10=%lf", &avg10) == 1)
+    {
+        sourcePtr->value = avg10;
+    }
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the level of a source from its last reading
+ *
+ * @return:
+ *      - Level of the source
+ */
+//--------------------------------------------------------------------------------------------------
+static pressure_Level_t GetSourceLevel
+(
+    const source_t* sourcePtr                   ///< [IN] Source
+)
+{
+    pressure_Level_t level = PRESSURE_LEVEL_NONE;
+    int i;
+
+    if (!isnan(sourcePtr->value))
+    {
+        for (i = PRESSURE_LEVEL_MODERATE; i < PRESSURE_LEVEL_COUNT; i++)
+        {
+            if (sourcePtr->value >= sourcePtr->thresholds[i])
+            {
+                level = i;
+            }
+        }
+
+        // Stay at the current level until clearly below its threshold.
+        if ((level < sourcePtr->level) &&
+            (sourcePtr->value > sourcePtr->thresholds[sourcePtr->level] - sourcePtr->hysteresis))
+        {
+            level = sourcePtr->level;
+        }
+    }
+
+    if (sourcePtr->isTriggered && (level < PRESSURE_LEVEL_MODERATE))
+    {
+        level = PRESSURE_LEVEL_MODERATE;
+    }
+
+    return level;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push the pressure level and the readings of the sources to the pressure/state resource
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportState
+(
+    const source_t* causePtr                    ///< [IN] Source with the highest level (or NULL)
+)
+{
+    char state[256];
+    size_t pos;
+    size_t i;
+
+    pos = snprintf(state, sizeof(state), "{\"level\":\"%s\",\"cause\":\"%s\"",
+                   LevelNames[Level], (causePtr != NULL) ? causePtr->namePtr : "");
+
+    for (i = 0; (i < NUM_ARRAY_MEMBERS(Sources)) && (pos < sizeof(state)); i++)
+    {
+        if (isnan(Sources[i].value))
+        {
+            pos += snprintf(&state[pos], sizeof(state) - pos, ",\"%s\":null", Sources[i].namePtr);
+        }
+        else
+        {
+            pos += snprintf(&state[pos], sizeof(state) - pos, ",\"%s\":%.2f",
+                            Sources[i].namePtr, Sources[i].value);
+        }
+    }
+
+    if (pos + 2 <= sizeof(state))
+    {
+        memcpy(&state[pos], "}", 2);
+        io_PushJson(PRESSURE_STATE_PATH, IO_NOW, state);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare the sources with their thresholds and change the level of the system if needed
+ */
+//--------------------------------------------------------------------------------------------------
+static void Evaluate
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+    pressure_Level_t level = PRESSURE_LEVEL_NONE;
+    const source_t* causePtr = NULL;
+    size_t i;
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(Sources); i++)
+    {
+        Sources[i].level = GetSourceLevel(&Sources[i]);
+
+        if (Sources[i].level > level)
+        {
+            level = Sources[i].level;
+            causePtr = &Sources[i];
+        }
+    }
+
+    if (level == Level)
+    {
+        return;
+    }
+
+    // Go up at once, but down one level at a time once the level has held for a while.
+    if (level < Level)
+    {
+        if (le_clk_Sub(now, LevelChangeTime).sec < SENSOR_PRESSURE_HOLD_TIME)
+        {
+            return;
+        }
+
+        level = Level - 1;
+    }
+
+    if (level > Level)
+    {
+        LE_WARN("Pressure %s (%s %.2f), throttling sensors",
+                LevelNames[level], causePtr->namePtr, causePtr->value);
+    }
+    else
+    {
+        LE_INFO("Pressure %s", LevelNames[level]);
+    }
+
+    Level = level;
+    LevelChangeTime = now;
+    TransitionCount++;
+
+    ReportState(causePtr);
+    LevelFunc(Level);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the PSI files and evaluate the pressure
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckHandler
+(
+    le_timer_Ref_t timerRef                     ///< [IN] Check timer
+)
+{
+    size_t i;
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(Sources); i++)
+    {
+        ReadStall(&Sources[i]);
+    }
+
+    Evaluate();
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(Sources); i++)
+    {
+        Sources[i].isTriggered = false;
+    }
+}
+
+#if LE_CONFIG_LINUX
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when a PSI trigger fires
+ */
+//--------------------------------------------------------------------------------------------------
+static void TriggerHandler
+(
+    int fd,                                     ///< [IN] PSI file
+    short events                                ///< [IN] Events
+)
+{
+    source_t* sourcePtr = le_fdMonitor_GetContextPtr();
+
+    if (events & POLLERR)
+    {
+        LE_WARN("Stall trigger on %s failed, checking periodically only", sourcePtr->filePtr);
+        le_fdMonitor_Delete(le_fdMonitor_GetMonitor());
+        return;
+    }
+
+    if (events & POLLPRI)
+    {
+        sourcePtr->isTriggered = true;
+        ReadStall(sourcePtr);
+        Evaluate();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a PSI file and set a stall trigger on it
+ */
+//--------------------------------------------------------------------------------------------------
+static void OpenStall
+(
+    source_t* sourcePtr                         ///< [IN] Source
+)
+{
+    sourcePtr->fd = open(sourcePtr->filePtr, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+
+    if (sourcePtr->fd < 0)
+    {
+        LE_INFO("No pressure stall information in %s", sourcePtr->filePtr);
+        return;
+    }
+
+    if (write(sourcePtr->fd, PSI_TRIGGER, sizeof(PSI_TRIGGER)) < 0)
+    {
+        LE_INFO("Cannot set a stall trigger on %s: %m", sourcePtr->filePtr);
+        return;
+    }
+
+    le_fdMonitor_Ref_t monitorRef = le_fdMonitor_Create(sourcePtr->namePtr,
+                                                        sourcePtr->fd,
+                                                        TriggerHandler,
+                                                        POLLPRI);
+
+    le_fdMonitor_SetContextPtr(monitorRef, sourcePtr);
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the thresholds of a source from the configuration tree
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadThresholds
+(
+    le_cfg_IteratorRef_t iteratorRef,           ///< [IN] Node of the pressure configuration
+    source_t* sourcePtr                         ///< [IN] Source
+)
+{
+    char nodePath[32];
+    int i;
+
+    for (i = PRESSURE_LEVEL_MODERATE; i < PRESSURE_LEVEL_COUNT; i++)
+    {
+        snprintf(nodePath, sizeof(nodePath), "%s/%s", sourcePtr->namePtr, LevelNames[i]);
+        sourcePtr->thresholds[i] = le_cfg_GetFloat(iteratorRef, nodePath,
+                                                   sourcePtr->thresholds[i]);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the thresholds, set the stall triggers and start monitoring the pressure
+ */
+//--------------------------------------------------------------------------------------------------
+void pressure_Init
+(
+    pressure_LevelFunc_t levelFunc              ///< [IN] Called when the pressure level changes
+)
+{
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(PRESSURE_ROOT_NODE);
+    le_result_t result;
+    size_t i;
+
+    LevelFunc = levelFunc;
+    IsEnabled = le_cfg_GetBool(iteratorRef, "enable", true);
+
+    le_cfg_GetString(iteratorRef, "temperature/path", TemperaturePath, sizeof(TemperaturePath),
+                     DEFAULT_TEMPERATURE_PATH);
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(Sources); i++)
+    {
+        ReadThresholds(iteratorRef, &Sources[i]);
+    }
+
+    le_cfg_CancelTxn(iteratorRef);
+
+    if (!IsEnabled)
+    {
+        return;
+    }
+
+    result = io_CreateInput(PRESSURE_STATE_PATH, IO_DATA_TYPE_JSON, "");
+    LE_ASSERT((result == LE_OK) || (result == LE_DUPLICATE));
+
+#if LE_CONFIG_LINUX
+    for (i = 0; i < NUM_ARRAY_MEMBERS(Sources); i++)
+    {
+        if (Sources[i].filePtr != NULL)
+        {
+            OpenStall(&Sources[i]);
+        }
+    }
+#endif
+
+    le_timer_Ref_t timerRef = le_timer_Create("pressureCheck");
+
+    le_timer_SetMsInterval(timerRef, SENSOR_PRESSURE_CHECK_PERIOD * 1000);
+    le_timer_SetRepeat(timerRef, 0);
+    le_timer_SetHandler(timerRef, CheckHandler);
+    le_timer_Start(timerRef);
+
+    LevelChangeTime = le_clk_GetRelativeTime();
+    ReportState(NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the priority of a sensor descriptor
+ *
+ * @return:
+ *      - LE_OK if successful
+ *      - LE_BAD_PARAMETER if the priority is not "low", "normal" or "high"
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pressure_ParsePriority
+(
+    const char* namePtr,                        ///< [IN]  Priority
+    pressure_Priority_t* priorityPtr            ///< [OUT] Parsed priority
+)
+{
+    if (strcmp(namePtr, "low") == 0)
+    {
+        *priorityPtr = PRESSURE_PRIORITY_LOW;
+    }
+    else if (strcmp(namePtr, "normal") == 0)
+    {
+        *priorityPtr = PRESSURE_PRIORITY_NORMAL;
+    }
+    else if (strcmp(namePtr, "high") == 0)
+    {
+        *priorityPtr = PRESSURE_PRIORITY_HIGH;
+    }
+    else
+    {
+        return LE_BAD_PARAMETER;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the factor applied to the periods of the sensors of a priority at the current level
+ *
+ * @return:
+ *      - Period scale, 1 if not throttled
+ */
+//--------------------------------------------------------------------------------------------------
+double pressure_GetPeriodScale
+(
+    pressure_Priority_t priority                ///< [IN] Priority of the sensor
+)
+{
+    return PeriodScales[Level][priority];
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Is a sensor the source of the temperature of the device?
+ */
+//--------------------------------------------------------------------------------------------------
+bool pressure_IsTemperatureSensor
+(
+    const char* pathPtr                         ///< [IN] Path of the sensor
+)
+{
+    return IsEnabled && (strcmp(pathPtr, TemperaturePath) == 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a sample of the temperature of the device. Runs on the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void pressure_RecordTemperature
+(
+    double temperature                          ///< [IN] Calibrated temperature
+)
+{
+    TemperatureSourcePtr->value = temperature;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current pressure level and the number of level changes
+ */
+//--------------------------------------------------------------------------------------------------
+void pressure_GetState
+(
+    pressure_Level_t* levelPtr,                 ///< [OUT] Current level
+    uint32_t* transitionCountPtr                ///< [OUT] Level changes since startup
+)
+{
+    *levelPtr = Level;
+    *transitionCountPtr = TransitionCount;
+}
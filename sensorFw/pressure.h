@@ -0,0 +1,135 @@
+//--------------------------------------------------------------------------------------------------
+/** @file pressure.h
+ *
+ * Throttling of the sensors when the system is under pressure. The stall of the tasks on CPU, I/O
+ * and memory is read from the Linux pressure stall information (/proc/pressure/), and the
+ * temperature of the device from a sensor of the framework. Each source is compared with three
+ * thresholds giving the pressure level; the level of the system is the highest of the sources, and
+ * the periods of the sensors are multiplied by a factor depending on the level and on their
+ * priority (see the "priority" field of the sensor descriptor). High priority sensors are never
+ * throttled. Thresholds are read from the configuration tree under pressure/:
+ *
+ *  - enable                (bool)   throttle under pressure (default true)
+ *  - cpu/, io/, memory/    moderate, severe, critical (float) "some" stall share over 10 s, in
+ *                          percent (default 25, 50, 75 for cpu, 20, 40, 60 for io and 10, 20, 40
+ *                          for memory)
+ *  - temperature/          path (string) numeric sensor of the temperature (default
+ *                          "device/temperature"), and moderate, severe, critical (float) in its
+ *                          unit (default 75, 85, 95)
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_PRESSURE_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_PRESSURE_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Priority of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    PRESSURE_PRIORITY_LOW,                      ///< Throttled first
+    PRESSURE_PRIORITY_NORMAL,                   ///< Throttled under severe pressure
+    PRESSURE_PRIORITY_HIGH,                     ///< Never throttled
+    PRESSURE_PRIORITY_COUNT
+}
+pressure_Priority_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pressure level of the system
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    PRESSURE_LEVEL_NONE,
+    PRESSURE_LEVEL_MODERATE,
+    PRESSURE_LEVEL_SEVERE,
+    PRESSURE_LEVEL_CRITICAL,
+    PRESSURE_LEVEL_COUNT
+}
+pressure_Level_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called when the pressure level changes
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*pressure_LevelFunc_t)
+(
+    pressure_Level_t level                      ///< [IN] New pressure level
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the thresholds, set the stall triggers and start monitoring the pressure
+ */
+//--------------------------------------------------------------------------------------------------
+void pressure_Init
+(
+    pressure_LevelFunc_t levelFunc              ///< [IN] Called when the pressure level changes
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the priority of a sensor descriptor
+ *
+ * @return:
+ *      - LE_OK if successful
+ *      - LE_BAD_PARAMETER if the priority is not "low", "normal" or "high"
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pressure_ParsePriority
+(
+    const char* namePtr,                        ///< [IN]  Priority
+    pressure_Priority_t* priorityPtr            ///< [OUT] Parsed priority
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the factor applied to the periods of the sensors of a priority at the current level
+ *
+ * @return:
+ *      - Period scale, 1 if not throttled
+ */
+//--------------------------------------------------------------------------------------------------
+double pressure_GetPeriodScale
+(
+    pressure_Priority_t priority                ///< [IN] Priority of the sensor
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Is a sensor the source of the temperature of the device?
+ */
+//--------------------------------------------------------------------------------------------------
+bool pressure_IsTemperatureSensor
+(
+    const char* pathPtr                         ///< [IN] Path of the sensor
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a sample of the temperature of the device. Runs on the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void pressure_RecordTemperature
+(
+    double temperature                          ///< [IN] Calibrated temperature
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current pressure level and the number of level changes
+ */
+//--------------------------------------------------------------------------------------------------
+void pressure_GetState
+(
+    pressure_Level_t* levelPtr,                 ///< [OUT] Current level
+    uint32_t* transitionCountPtr                ///< [OUT] Level changes since startup
+);
+
+#endif /* LEGATO_SENSOR_FW_PRESSURE_INCLUDE_GUARD */
@@ -0,0 +1,377 @@
+//--------------------------------------------------------------------------------------------------
+/** @file pushQueue.c
+ *
+ * Per-thread lock-free staging rings for samples pushed from plugin threads.
+ *
+ * A producing thread claims a free ring the first time it stages a sample and keeps it until it
+ * exits. Producers only write the head of their ring and the consumer only writes the tail, so no
+ * lock is taken on either side. A single drain is queued to the consumer thread per batch: the
+ * producer that finds the DrainPending flag cleared queues it, and the drain clears the flag
+ * before reading the rings so that a sample staged during the drain queues another one.
+ *
+ * String samples are copied to the slab of the ring, at the entry indexed by their slot. A string
+ * is only staged while fewer than SENSOR_PUSH_STRING_COUNT samples are pending, so the entries of
+ * the strings in flight never overlap and the slab needs no allocation nor lock.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <inttypes.h>
+#include "pushQueue.h"
+#include "config.h"
+
+LE_STATIC_ASSERT((SENSOR_PUSH_RING_SIZE & (SENSOR_PUSH_RING_SIZE - 1)) == 0,
+                 "SENSOR_PUSH_RING_SIZE must be a power of 2");
+
+LE_STATIC_ASSERT((SENSOR_PUSH_STRING_COUNT & (SENSOR_PUSH_STRING_COUNT - 1)) == 0,
+                 "SENSOR_PUSH_STRING_COUNT must be a power of 2");
+
+LE_STATIC_ASSERT(SENSOR_PUSH_STRING_COUNT <= SENSOR_PUSH_RING_SIZE,
+                 "SENSOR_PUSH_STRING_COUNT larger than the ring");
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Owner of a ring whose thread exited, to be released once the ring is empty
+ */
+//--------------------------------------------------------------------------------------------------
+#define     RING_RETIRED                    ((le_thread_Ref_t)(uintptr_t)-1)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Staging ring of a producing thread
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_thread_Ref_t owner;                                  ///< Producing thread (NULL if free)
+    uint32_t head;                                          ///< Next slot written by the producer
+    uint32_t tail;                                          ///< Next slot read by the consumer
+    uint32_t droppedCount;                                  ///< Samples dropped on a full ring
+    pushQueue_Sample_t slots[SENSOR_PUSH_RING_SIZE];        ///< Staged samples
+    char strings[SENSOR_PUSH_STRING_COUNT][SENSOR_PUSH_STRING_LEN]; ///< Staged strings, by slot
+}
+ring_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Staging rings
+ */
+//--------------------------------------------------------------------------------------------------
+static ring_t Rings[SENSOR_PUSH_RING_COUNT];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread draining the rings
+ */
+//--------------------------------------------------------------------------------------------------
+static le_thread_Ref_t DrainThread;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called for every drained sample
+ */
+//--------------------------------------------------------------------------------------------------
+static pushQueue_DrainFunc_t DrainFunc;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Is a drain queued to the drain thread?
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DrainPending;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of dropped samples last reported
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t ReportedDroppedCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drain all the rings. Runs on the drain thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DrainRings
+(
+    void* param1Ptr,                    ///< [IN] not used
+    void* param2Ptr                     ///< [IN] not used
+)
+{
+    int i;
+
+    __atomic_store_n(&DrainPending, false, __ATOMIC_SEQ_CST);
+
+    for (i = 0; i < SENSOR_PUSH_RING_COUNT; i++)
+    {
+        ring_t* ringPtr = &Rings[i];
+        le_thread_Ref_t owner = __atomic_load_n(&ringPtr->owner, __ATOMIC_ACQUIRE);
+
+        if (owner == NULL)
+        {
+            continue;
+        }
+
+        uint32_t tail = ringPtr->tail;
+        uint32_t head = __atomic_load_n(&ringPtr->head, __ATOMIC_SEQ_CST);
+
+        while (tail != head)
+        {
+            DrainFunc(&ringPtr->slots[tail & (SENSOR_PUSH_RING_SIZE - 1)]);
+            tail++;
+        }
+
+        __atomic_store_n(&ringPtr->tail, tail, __ATOMIC_RELEASE);
+
+        // The thread is gone so nothing can be staged after the head read above.
+        if (owner == RING_RETIRED)
+        {
+            ringPtr->head = 0;
+            ringPtr->tail = 0;
+            __atomic_store_n(&ringPtr->owner, NULL, __ATOMIC_RELEASE);
+        }
+    }
+
+    uint32_t droppedCount = pushQueue_GetDroppedCount();
+
+    if (droppedCount != ReportedDroppedCount)
+    {
+        LE_WARN("%" PRIu32 " staged samples dropped, rings full",
+                droppedCount - ReportedDroppedCount);
+        ReportedDroppedCount = droppedCount;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a drain to the drain thread unless one is already pending
+ */
+//--------------------------------------------------------------------------------------------------
+static void RequestDrain
+(
+    void
+)
+{
+    if (!__atomic_exchange_n(&DrainPending, true, __ATOMIC_SEQ_CST))
+    {
+        le_event_QueueFunctionToThread(DrainThread, DrainRings, NULL, NULL);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when a producing thread exits. Hands its ring back once drained.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RetireRing
+(
+    void* contextPtr                    ///< [IN] Ring of the exiting thread
+)
+{
+    ring_t* ringPtr = (ring_t*)contextPtr;
+
+    __atomic_store_n(&ringPtr->owner, RING_RETIRED, __ATOMIC_RELEASE);
+    RequestDrain();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the ring of the calling thread, claiming a free one if needed
+ *
+ * @return:
+ *      - Ring of the calling thread, NULL if none is available
+ */
+//--------------------------------------------------------------------------------------------------
+static ring_t* GetRing
+(
+    void
+)
+{
+    le_thread_Ref_t self = le_thread_GetCurrent();
+    int i;
+
+    for (i = 0; i < SENSOR_PUSH_RING_COUNT; i++)
+    {
+        if (__atomic_load_n(&Rings[i].owner, __ATOMIC_ACQUIRE) == self)
+        {
+            return &Rings[i];
+        }
+    }
+
+    for (i = 0; i < SENSOR_PUSH_RING_COUNT; i++)
+    {
+        le_thread_Ref_t expected = NULL;
+
+        if (__atomic_compare_exchange_n(&Rings[i].owner, &expected, self, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            le_thread_AddDestructor(RetireRing, &Rings[i]);
+            return &Rings[i];
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the staging rings. Samples are drained on the calling thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushQueue_Init
+(
+    pushQueue_DrainFunc_t drainFunc     ///< [IN] Function called for every staged sample
+)
+{
+    memset(Rings, 0, sizeof(Rings));
+    DrainFunc = drainFunc;
+    DrainThread = le_thread_GetCurrent();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the calling thread is the one draining the rings
+ */
+//--------------------------------------------------------------------------------------------------
+bool pushQueue_IsDrainThread
+(
+    void
+)
+{
+    return (le_thread_GetCurrent() == DrainThread);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stage a sample in the ring of the calling thread
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the ring of the calling thread is full, the sample is dropped
+ *      - LE_NO_MEMORY if all the rings are owned by other threads
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Put
+(
+    const pushQueue_Sample_t* samplePtr,    ///< [IN] Sample to stage
+    bool isString                           ///< [IN] Copy the string of the sample to the slab?
+)
+{
+    ring_t* ringPtr = GetRing();
+
+    if (ringPtr == NULL)
+    {
+        return LE_NO_MEMORY;
+    }
+
+    uint32_t head = ringPtr->head;
+    uint32_t tail = __atomic_load_n(&ringPtr->tail, __ATOMIC_ACQUIRE);
+    uint32_t capacity = isString ? SENSOR_PUSH_STRING_COUNT : SENSOR_PUSH_RING_SIZE;
+
+    if ((head - tail) >= capacity)
+    {
+        __atomic_add_fetch(&ringPtr->droppedCount, 1, __ATOMIC_RELAXED);
+        RequestDrain();
+        return LE_OVERFLOW;
+    }
+
+    pushQueue_Sample_t* slotPtr = &ringPtr->slots[head & (SENSOR_PUSH_RING_SIZE - 1)];
+
+    *slotPtr = *samplePtr;
+
+    if (isString)
+    {
+        char* stringPtr = ringPtr->strings[head & (SENSOR_PUSH_STRING_COUNT - 1)];
+
+        le_utf8_Copy(stringPtr, samplePtr->value.stringPtr, SENSOR_PUSH_STRING_LEN, NULL);
+        slotPtr->value.stringPtr = stringPtr;
+    }
+
+    __atomic_store_n(&ringPtr->head, head + 1, __ATOMIC_SEQ_CST);
+
+    RequestDrain();
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stage a sample from the calling thread. Never blocks.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the ring of the calling thread is full, the sample is dropped
+ *      - LE_NO_MEMORY if all the rings are owned by other threads
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pushQueue_Put
+(
+    const pushQueue_Sample_t* samplePtr ///< [IN] Sample to stage
+)
+{
+    return Put(samplePtr, false);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stage a string or JSON sample from the calling thread. The string is copied to the slab of the
+ * ring and stays valid until the drain function returns. Never blocks.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the ring of the calling thread is full, the sample is dropped
+ *      - LE_NO_MEMORY if all the rings are owned by other threads
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pushQueue_PutString
+(
+    const pushQueue_Sample_t* samplePtr ///< [IN] Sample to stage, string is copied
+)
+{
+    return Put(samplePtr, true);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples dropped because a ring was full
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t pushQueue_GetDroppedCount
+(
+    void
+)
+{
+    uint32_t droppedCount = 0;
+    int i;
+
+    for (i = 0; i < SENSOR_PUSH_RING_COUNT; i++)
+    {
+        droppedCount += __atomic_load_n(&Rings[i].droppedCount, __ATOMIC_RELAXED);
+    }
+
+    return droppedCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples staged and not drained yet
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t pushQueue_GetDepth
+(
+    void
+)
+{
+    uint32_t depth = 0;
+    int i;
+
+    for (i = 0; i < SENSOR_PUSH_RING_COUNT; i++)
+    {
+        depth += __atomic_load_n(&Rings[i].head, __ATOMIC_ACQUIRE) -
+                 __atomic_load_n(&Rings[i].tail, __ATOMIC_ACQUIRE);
+    }
+
+    return depth;
+}
@@ -0,0 +1,120 @@
+//--------------------------------------------------------------------------------------------------
+/** @file pushQueue.h
+ *
+ * Staging of samples produced by plugin threads. Each producing thread owns a lock-free
+ * single-producer/single-consumer ring, and the rings are drained in batches on the thread that
+ * called pushQueue_Init (the thread that owns the Data Hub sessions). String samples are copied to
+ * a slab pre-allocated with the ring.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_PUSH_QUEUE_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_PUSH_QUEUE_INCLUDE_GUARD
+
+#include "trace.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Staged sample
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    void* handlerPtr;                   ///< Sensor handler
+    double timestamp;                   ///< Time at which the sample was taken
+    int type;                           ///< Data type of the sample
+    trace_Tag_t trace;                  ///< Latency trace of the sample
+    union
+    {
+        bool boolean;                   ///< Boolean sample
+        double numeric;                 ///< Numeric sample
+        char* stringPtr;                ///< String or JSON sample
+    }
+    value;
+}
+pushQueue_Sample_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called on the draining thread for every staged sample, in production order per thread
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*pushQueue_DrainFunc_t)
+(
+    const pushQueue_Sample_t* samplePtr ///< [IN] Staged sample
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the staging rings. Samples are drained on the calling thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushQueue_Init
+(
+    pushQueue_DrainFunc_t drainFunc     ///< [IN] Function called for every staged sample
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the calling thread is the one draining the rings
+ */
+//--------------------------------------------------------------------------------------------------
+bool pushQueue_IsDrainThread
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stage a sample from the calling thread. Never blocks.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the ring of the calling thread is full, the sample is dropped
+ *      - LE_NO_MEMORY if all the rings are owned by other threads
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pushQueue_Put
+(
+    const pushQueue_Sample_t* samplePtr ///< [IN] Sample to stage
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stage a string or JSON sample from the calling thread. The string is copied to the slab of the
+ * ring and stays valid until the drain function returns. Never blocks.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the ring of the calling thread is full, the sample is dropped
+ *      - LE_NO_MEMORY if all the rings are owned by other threads
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pushQueue_PutString
+(
+    const pushQueue_Sample_t* samplePtr ///< [IN] Sample to stage, string is copied
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples dropped because a ring was full
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t pushQueue_GetDroppedCount
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples staged and not drained yet
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t pushQueue_GetDepth
+(
+    void
+);
+
+#endif /* LEGATO_SENSOR_FW_PUSH_QUEUE_INCLUDE_GUARD */
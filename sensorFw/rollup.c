@@ -0,0 +1,1280 @@
+//--------------------------------------------------------------------------------------------------
+/** @file rollup.c
+ *
+ * Retention-tiered rollups of the numeric sensors.
+ *
+ * Samples are aggregated in memory into the current bucket of the finest tier. When a bucket ends,
+ * on a timer aligned on the wall clock, the buckets of all the series of the tier are written as
+ * one batch appended to the current segment of the tier, and folded into the current buckets of
+ * the next tier, so that a coarser tier is computed from the finer one rather than from the
+ * samples. Files are never rewritten: a segment torn by a crash is cut back to its last complete
+ * record when it is reopened, and segments past the retention of the tier are removed whole.
+ *
+ * Range queries binary search the index of each segment in the range for the first bucket, then
+ * scan the records from there on, filtering on the hash of the sensor path.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <math.h>
+#include "interfaces.h"
+#include "rollup.h"
+#include "config.h"
+
+#if LE_CONFIG_LINUX
+#include <dirent.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Node of the configuration tree under which the rollups are configured
+ */
+//--------------------------------------------------------------------------------------------------
+#define     ROLLUP_ROOT_NODE                "rollup"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of a file path
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_PATH_LEN                    128
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of the directory of a tier, leaving room in a file path for the name of
+ * a segment file
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_TIER_DIR_LEN                (MAX_PATH_LEN - (sizeof("/4294967295.idx") - 1))
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of segments of a tier listed by a query (segments left over by a change of the
+ * retention are counted too)
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_SEGMENTS                    (4 * SENSOR_ROLLUP_SEGMENT_COUNT)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of records read at once by a query
+ */
+//--------------------------------------------------------------------------------------------------
+#define     READ_CHUNK_COUNT                64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * File of the rollup directory assigning a key to each sensor path
+ */
+//--------------------------------------------------------------------------------------------------
+#define     SERIES_FILE                     "series"
+
+// A query always gets past the bucket it starts at: the index entry before it is at most a stride
+// and a batch of records away, and a bucket holds at most a batch.
+LE_STATIC_ASSERT(SENSOR_ROLLUP_QUERY_SCAN_COUNT >
+                 SENSOR_ROLLUP_INDEX_STRIDE + 2 * SENSOR_HANDLER_POOL_SIZE,
+                 "Rollup query scan too short");
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record of a segment file
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t time;                              ///< Start of the bucket, seconds since the epoch
+    uint32_t key;                               ///< Key of the sensor path
+    float min;                                  ///< Smallest sample
+    float max;                                  ///< Largest sample
+    float mean;                                 ///< Mean of the samples
+    uint32_t count;                             ///< Number of samples
+}
+record_t;
+
+LE_STATIC_ASSERT(sizeof(record_t) == 24, "Segment records must be 24 bytes");
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Entry of a segment index
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t time;                              ///< Bucket of the first record at this offset
+    uint32_t offset;                            ///< Offset of the record in the .dat file
+}
+indexEntry_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Entry of the series file
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t key;                               ///< Key of the records of the sensor
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];    ///< Path of the sensor
+}
+seriesEntry_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Current bucket of a series in a tier
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double min;
+    double max;
+    double sum;
+    uint32_t count;
+}
+bucket_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rollups of one sensor
+ */
+//--------------------------------------------------------------------------------------------------
+struct rollup_Series
+{
+    uint32_t key;                               ///< Key of the records, unique to the path
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];    ///< Path of the sensor
+    bucket_t buckets[SENSOR_ROLLUP_MAX_TIERS];  ///< Current bucket in each tier
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tier of rollups
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t period;                            ///< Duration of a bucket, seconds
+    uint32_t retention;                         ///< Time the buckets are kept, seconds
+    uint32_t segmentSpan;                       ///< Time covered by a segment, seconds
+    uint32_t nextFlush;                         ///< End of the current bucket
+    uint32_t segmentStart;                      ///< Start of the open segment
+    int dataFd;                                 ///< Open segment, -1 if none
+    int indexFd;                                ///< Index of the open segment, -1 if none
+    uint32_t dataSize;                          ///< Bytes of complete records in the segment
+    uint32_t unindexedCount;                    ///< Records since the last index entry
+    char dir[MAX_TIER_DIR_LEN];                 ///< Directory of the segments
+}
+tier_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tiers, from the finest, and series
+ */
+//--------------------------------------------------------------------------------------------------
+static tier_t Tiers[SENSOR_ROLLUP_MAX_TIERS];
+static uint32_t TierCount;
+static rollup_Series_t Series[SENSOR_HANDLER_POOL_SIZE];
+static uint32_t SeriesCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Series file, open for appending, -1 if none
+ */
+//--------------------------------------------------------------------------------------------------
+static int SeriesFd = -1;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records of a tier written in one batch
+ */
+//--------------------------------------------------------------------------------------------------
+static record_t Batch[SENSOR_HANDLER_POOL_SIZE];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer ending the buckets
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t FlushTimer;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash a sensor path (FNV-1a)
+ *
+ * @return:
+ *      - Hash
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t HashPath
+(
+    const char* pathPtr                         ///< [IN] Path of the sensor
+)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*pathPtr != '\0')
+    {
+        hash ^= (uint8_t)*pathPtr++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reset a bucket
+ */
+//--------------------------------------------------------------------------------------------------
+static void ResetBucket
+(
+    bucket_t* bucketPtr                         ///< [OUT] Bucket
+)
+{
+    bucketPtr->min = 0;
+    bucketPtr->max = 0;
+    bucketPtr->sum = 0;
+    bucketPtr->count = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the series of a sensor path
+ *
+ * @return:
+ *      - Series, NULL if the path has none
+ */
+//--------------------------------------------------------------------------------------------------
+static rollup_Series_t* FindSeries
+(
+    const char* pathPtr                         ///< [IN] Path of the sensor
+)
+{
+    uint32_t i;
+
+    for (i = 0; i < SeriesCount; i++)
+    {
+        if (strcmp(Series[i].path, pathPtr) == 0)
+        {
+            return &Series[i];
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a key is taken by a series
+ *
+ * @return:
+ *      - true if a series has the key
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsKeyTaken
+(
+    uint32_t key                                ///< [IN] Key
+)
+{
+    uint32_t i;
+
+    for (i = 0; i < SeriesCount; i++)
+    {
+        if (Series[i].key == key)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a series with empty buckets
+ *
+ * @return:
+ *      - Series
+ */
+//--------------------------------------------------------------------------------------------------
+static rollup_Series_t* AddSeries
+(
+    const seriesEntry_t* entryPtr               ///< [IN] Key and path of the series
+)
+{
+    rollup_Series_t* seriesPtr = &Series[SeriesCount++];
+    uint32_t i;
+
+    seriesPtr->key = entryPtr->key;
+    memcpy(seriesPtr->path, entryPtr->path, sizeof(seriesPtr->path));
+
+    for (i = 0; i < SENSOR_ROLLUP_MAX_TIERS; i++)
+    {
+        ResetBucket(&seriesPtr->buckets[i]);
+    }
+
+    return seriesPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert a time of a query to whole seconds since the epoch, rounding up
+ *
+ * @return:
+ *      - Seconds
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t ToSeconds
+(
+    double time                                 ///< [IN] Time, seconds since the epoch
+)
+{
+    if (time <= 0)
+    {
+        return 0;
+    }
+
+    if (time >= UINT32_MAX)
+    {
+        return UINT32_MAX;
+    }
+
+    return (uint32_t)ceil(time);
+}
+
+#if LE_CONFIG_LINUX
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the path of a file of a segment
+ */
+//--------------------------------------------------------------------------------------------------
+static void SegmentPath
+(
+    const tier_t* tierPtr,                      ///< [IN]  Tier
+    uint32_t segmentStart,                      ///< [IN]  Start of the segment
+    const char* extensionPtr,                   ///< [IN]  "dat" or "idx"
+    char* pathPtr                               ///< [OUT] Path, MAX_PATH_LEN bytes
+)
+{
+    snprintf(pathPtr, MAX_PATH_LEN, "%s/%" PRIu32 ".%s", tierPtr->dir, segmentStart, extensionPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a file of a segment for appending, and cut it back to whole entries in case the last write
+ * before a crash was torn
+ *
+ * @return:
+ *      - File descriptor, -1 on error
+ */
+//--------------------------------------------------------------------------------------------------
+static int OpenAppend
+(
+    const char* pathPtr,                        ///< [IN]  Path of the file
+    size_t entrySize,                           ///< [IN]  Size of the entries of the file
+    uint32_t* sizePtr                           ///< [OUT] Size of the whole entries
+)
+{
+    struct stat st;
+    int fd = open(pathPtr, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP);
+
+    if (fd < 0)
+    {
+        LE_WARN("Cannot open %s: %m", pathPtr);
+        return -1;
+    }
+
+    if (fstat(fd, &st) != 0)
+    {
+        LE_WARN("Cannot stat %s: %m", pathPtr);
+        close(fd);
+        return -1;
+    }
+
+    *sizePtr = st.st_size - (st.st_size % entrySize);
+
+    if ((*sizePtr != st.st_size) && (ftruncate(fd, *sizePtr) != 0))
+    {
+        LE_WARN("Cannot repair %s: %m", pathPtr);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the open segment of a tier
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseSegment
+(
+    tier_t* tierPtr                             ///< [IN] Tier
+)
+{
+    if (tierPtr->dataFd >= 0)
+    {
+        close(tierPtr->dataFd);
+        tierPtr->dataFd = -1;
+    }
+
+    if (tierPtr->indexFd >= 0)
+    {
+        close(tierPtr->indexFd);
+        tierPtr->indexFd = -1;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open the segment of a tier that starts at a given time
+ */
+//--------------------------------------------------------------------------------------------------
+static void OpenSegment
+(
+    tier_t* tierPtr,                            ///< [IN] Tier
+    uint32_t segmentStart                       ///< [IN] Start of the segment
+)
+{
+    char path[MAX_PATH_LEN];
+    uint32_t indexSize;
+
+    CloseSegment(tierPtr);
+
+    tierPtr->segmentStart = segmentStart;
+
+    SegmentPath(tierPtr, segmentStart, "dat", path);
+    tierPtr->dataFd = OpenAppend(path, sizeof(record_t), &tierPtr->dataSize);
+
+    SegmentPath(tierPtr, segmentStart, "idx", path);
+    tierPtr->indexFd = OpenAppend(path, sizeof(indexEntry_t), &indexSize);
+
+    if (tierPtr->indexFd < 0)
+    {
+        CloseSegment(tierPtr);
+    }
+
+    // The first batch written to the segment is always indexed.
+    tierPtr->unindexedCount = SENSOR_ROLLUP_INDEX_STRIDE;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the series of the previous runs, so that their keys stay the same and their records can
+ * still be queried, and open the series file for the new ones
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadSeries
+(
+    const char* dirPtr                          ///< [IN] Directory of the tiers
+)
+{
+    char path[MAX_PATH_LEN];
+    seriesEntry_t entry;
+    uint32_t size;
+    int fd;
+
+    snprintf(path, sizeof(path), "%s/%s", dirPtr, SERIES_FILE);
+
+    SeriesFd = OpenAppend(path, sizeof(seriesEntry_t), &size);
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return;
+    }
+
+    while ((SeriesCount < SENSOR_HANDLER_POOL_SIZE) &&
+           (read(fd, &entry, sizeof(entry)) == sizeof(entry)))
+    {
+        entry.path[sizeof(entry.path) - 1] = '\0';
+
+        if ((FindSeries(entry.path) == NULL) && !IsKeyTaken(entry.key))
+        {
+            AddSeries(&entry);
+        }
+    }
+
+    close(fd);
+
+    LE_INFO("%" PRIu32 " rollup series", SeriesCount);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * List the segments of a tier that overlap a time range
+ *
+ * @return:
+ *      - Number of segments, their starts are in increasing order
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t ListSegments
+(
+    const tier_t* tierPtr,                      ///< [IN]  Tier
+    uint32_t start,                             ///< [IN]  Start of the range
+    uint32_t end,                               ///< [IN]  End of the range (excluded)
+    uint32_t* startsPtr                         ///< [OUT] Starts of the segments, MAX_SEGMENTS
+)
+{
+    size_t count = 0;
+    struct dirent* entryPtr;
+    DIR* dirPtr = opendir(tierPtr->dir);
+
+    if (dirPtr == NULL)
+    {
+        return 0;
+    }
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        char* endPtr;
+        unsigned long segmentStart = strtoul(entryPtr->d_name, &endPtr, 10);
+
+        if ((endPtr == entryPtr->d_name) || (strcmp(endPtr, ".dat") != 0) ||
+            (segmentStart >= end) || ((uint64_t)segmentStart + tierPtr->segmentSpan <= start))
+        {
+            continue;
+        }
+
+        if (count >= MAX_SEGMENTS)
+        {
+            LE_WARN("Too many segments in %s", tierPtr->dir);
+            break;
+        }
+
+        // Insertion sort, there are only a few segments.
+        size_t i = count++;
+
+        while ((i > 0) && (startsPtr[i - 1] > segmentStart))
+        {
+            startsPtr[i] = startsPtr[i - 1];
+            i--;
+        }
+
+        startsPtr[i] = segmentStart;
+    }
+
+    closedir(dirPtr);
+
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the segments of a tier past its retention
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveExpiredSegments
+(
+    const tier_t* tierPtr,                      ///< [IN] Tier
+    uint32_t now                                ///< [IN] Current bucket
+)
+{
+    uint32_t starts[MAX_SEGMENTS];
+    char path[MAX_PATH_LEN];
+    size_t count;
+    size_t i;
+
+    if (now < tierPtr->retention)
+    {
+        return;
+    }
+
+    count = ListSegments(tierPtr, 0, now - tierPtr->retention, starts);
+
+    for (i = 0; i < count; i++)
+    {
+        if ((uint64_t)starts[i] + tierPtr->segmentSpan > now - tierPtr->retention)
+        {
+            continue;
+        }
+
+        LE_DEBUG("Removing segment %" PRIu32 " of %s", starts[i], tierPtr->dir);
+
+        SegmentPath(tierPtr, starts[i], "dat", path);
+        unlink(path);
+        SegmentPath(tierPtr, starts[i], "idx", path);
+        unlink(path);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a batch of records of the same bucket to a tier
+ */
+//--------------------------------------------------------------------------------------------------
+static void AppendBatch
+(
+    tier_t* tierPtr,                            ///< [IN] Tier
+    uint32_t bucketTime,                        ///< [IN] Start of the bucket
+    const record_t* recordsPtr,                 ///< [IN] Records
+    uint32_t count                              ///< [IN] Number of records
+)
+{
+    size_t size = count * sizeof(record_t);
+    uint32_t segmentStart = bucketTime - (bucketTime % tierPtr->segmentSpan);
+
+    if ((tierPtr->dataFd < 0) || (segmentStart != tierPtr->segmentStart))
+    {
+        OpenSegment(tierPtr, segmentStart);
+        RemoveExpiredSegments(tierPtr, bucketTime);
+    }
+
+    if (tierPtr->dataFd < 0)
+    {
+        return;
+    }
+
+    // An index entry is a lower bound on the times of the records from its offset on, so it is
+    // written first: if the records are then lost, it still points to the records that follow.
+    if (tierPtr->unindexedCount >= SENSOR_ROLLUP_INDEX_STRIDE)
+    {
+        indexEntry_t entry = { .time = bucketTime, .offset = tierPtr->dataSize };
+
+        if (write(tierPtr->indexFd, &entry, sizeof(entry)) == sizeof(entry))
+        {
+            tierPtr->unindexedCount = 0;
+        }
+    }
+
+    if (write(tierPtr->dataFd, recordsPtr, size) != (ssize_t)size)
+    {
+        LE_WARN("Cannot append %" PRIu32 " records to %s: %m", count, tierPtr->dir);
+
+        if (ftruncate(tierPtr->dataFd, tierPtr->dataSize) != 0)
+        {
+            CloseSegment(tierPtr);
+        }
+        return;
+    }
+
+    tierPtr->dataSize += size;
+    tierPtr->unindexedCount += count;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find where to start reading the records of a segment for a time
+ *
+ * @return:
+ *      - Offset of the last indexed bucket not after the time, 0 if there is none
+ */
+//--------------------------------------------------------------------------------------------------
+static off_t FindOffset
+(
+    const tier_t* tierPtr,                      ///< [IN] Tier
+    uint32_t segmentStart,                      ///< [IN] Start of the segment
+    uint32_t time                               ///< [IN] Time
+)
+{
+    char path[MAX_PATH_LEN];
+    struct stat st;
+    indexEntry_t entry;
+    off_t offset = 0;
+    size_t low = 0;
+    size_t high;
+    int fd;
+
+    SegmentPath(tierPtr, segmentStart, "idx", path);
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return 0;
+    }
+
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return 0;
+    }
+
+    high = st.st_size / sizeof(indexEntry_t);
+
+    // Find the last entry whose time is not after the time.
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if (pread(fd, &entry, sizeof(entry), middle * sizeof(entry)) != sizeof(entry))
+        {
+            break;
+        }
+
+        if (entry.time <= time)
+        {
+            offset = entry.offset;
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    close(fd);
+
+    return offset;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the records of a sensor in a segment
+ *
+ * @return:
+ *      - LE_OK if the segment was read up to the end of the range
+ *      - LE_OVERFLOW if the records array is full or the scan count is used up, the next query
+ *        starts at *nextPtr
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadSegment
+(
+    const tier_t* tierPtr,                      ///< [IN]     Tier
+    uint32_t segmentStart,                      ///< [IN]     Start of the segment
+    uint32_t key,                               ///< [IN]     Key of the sensor
+    uint32_t start,                             ///< [IN]     Start of the range
+    uint32_t end,                               ///< [IN]     End of the range (excluded)
+    rollup_Record_t* recordsPtr,                ///< [OUT]    Records
+    size_t maxCount,                            ///< [IN]     Size of the array
+    size_t* countPtr,                           ///< [IN/OUT] Records read
+    size_t* scanCountPtr,                       ///< [IN/OUT] Records left to scan
+    double* nextPtr                             ///< [OUT]    Start of the next query
+)
+{
+    static record_t chunk[READ_CHUNK_COUNT];
+    char path[MAX_PATH_LEN];
+    off_t offset = FindOffset(tierPtr, segmentStart, start);
+    le_result_t result = LE_OK;
+    ssize_t bytes;
+    int fd;
+
+    SegmentPath(tierPtr, segmentStart, "dat", path);
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return LE_OK;
+    }
+
+    while ((bytes = pread(fd, chunk, sizeof(chunk), offset)) >= (ssize_t)sizeof(record_t))
+    {
+        size_t i;
+
+        offset += bytes - (bytes % sizeof(record_t));
+
+        for (i = 0; i < bytes / sizeof(record_t); i++)
+        {
+            const record_t* recordPtr = &chunk[i];
+
+            if (recordPtr->time >= end)
+            {
+                goto done;
+            }
+
+            if ((*scanCountPtr == 0) ||
+                ((recordPtr->key == key) && (recordPtr->time >= start) && (*countPtr >= maxCount)))
+            {
+                // Resume at this record, or after its bucket if the sensor's record of the bucket
+                // was already read.
+                *nextPtr = recordPtr->time;
+
+                if ((*countPtr > 0) && (recordsPtr[*countPtr - 1].time >= recordPtr->time))
+                {
+                    *nextPtr += tierPtr->period;
+                }
+
+                result = LE_OVERFLOW;
+                goto done;
+            }
+
+            (*scanCountPtr)--;
+
+            if ((recordPtr->key != key) || (recordPtr->time < start))
+            {
+                continue;
+            }
+
+            recordsPtr[*countPtr].time = recordPtr->time;
+            recordsPtr[*countPtr].min = recordPtr->min;
+            recordsPtr[*countPtr].max = recordPtr->max;
+            recordsPtr[*countPtr].mean = recordPtr->mean;
+            recordsPtr[*countPtr].count = recordPtr->count;
+            (*countPtr)++;
+        }
+    }
+
+done:
+    close(fd);
+
+    return result;
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the buckets of all the series in a tier, and fold them into the next tier
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushTier
+(
+    uint32_t tierIndex,                         ///< [IN] Index of the tier
+    uint32_t bucketTime                         ///< [IN] Start of the bucket
+)
+{
+    uint32_t count = 0;
+    uint32_t i;
+
+    for (i = 0; i < SeriesCount; i++)
+    {
+        bucket_t* bucketPtr = &Series[i].buckets[tierIndex];
+
+        if (bucketPtr->count == 0)
+        {
+            continue;
+        }
+
+        Batch[count].time = bucketTime;
+        Batch[count].key = Series[i].key;
+        Batch[count].min = bucketPtr->min;
+        Batch[count].max = bucketPtr->max;
+        Batch[count].mean = bucketPtr->sum / bucketPtr->count;
+        Batch[count].count = bucketPtr->count;
+        count++;
+
+        if (tierIndex + 1 < TierCount)
+        {
+            bucket_t* nextPtr = &Series[i].buckets[tierIndex + 1];
+
+            if ((nextPtr->count == 0) || (bucketPtr->min < nextPtr->min))
+            {
+                nextPtr->min = bucketPtr->min;
+            }
+
+            if ((nextPtr->count == 0) || (bucketPtr->max > nextPtr->max))
+            {
+                nextPtr->max = bucketPtr->max;
+            }
+
+            nextPtr->sum += bucketPtr->sum;
+            nextPtr->count += bucketPtr->count;
+        }
+
+        ResetBucket(bucketPtr);
+    }
+
+#if LE_CONFIG_LINUX
+    if (count > 0)
+    {
+        AppendBatch(&Tiers[tierIndex], bucketTime, Batch, count);
+    }
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End the buckets that are due, finest tier first, and restart the timer for the next one
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushHandler
+(
+    le_timer_Ref_t timerRef                     ///< [IN] Flush timer
+)
+{
+    le_clk_Time_t now = le_clk_GetAbsoluteTime();
+    uint32_t nowSec = now.sec;
+    uint32_t nextFlush = UINT32_MAX;
+    uint32_t i;
+
+    for (i = 0; i < TierCount; i++)
+    {
+        tier_t* tierPtr = &Tiers[i];
+        uint32_t bucketEnd = nowSec - (nowSec % tierPtr->period) + tierPtr->period;
+
+        if (nowSec >= tierPtr->nextFlush)
+        {
+            FlushTier(i, tierPtr->nextFlush - tierPtr->period);
+            tierPtr->nextFlush = bucketEnd;
+        }
+        else if (tierPtr->nextFlush > bucketEnd)
+        {
+            // The clock went back, keep the bucket going until the new end.
+            tierPtr->nextFlush = bucketEnd;
+        }
+
+        if (tierPtr->nextFlush < nextFlush)
+        {
+            nextFlush = tierPtr->nextFlush;
+        }
+    }
+
+    le_timer_SetMsInterval(timerRef,
+                           (uint32_t)(nextFlush - nowSec) * 1000 - (now.usec / 1000) + 1);
+    le_timer_Start(timerRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the tiers from the configuration tree
+ *
+ * @return:
+ *      - true if rollups are enabled and at least one tier is valid
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadConfig
+(
+    char* dirPtr,                               ///< [OUT] Directory of the tiers
+    size_t dirSize                              ///< [IN]  Size of the directory buffer
+)
+{
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(ROLLUP_ROOT_NODE);
+
+    if (!le_cfg_GetBool(iteratorRef, "enable", false))
+    {
+        le_cfg_CancelTxn(iteratorRef);
+        return false;
+    }
+
+    le_cfg_GetString(iteratorRef, "dir", dirPtr, dirSize, SENSOR_ROLLUP_DIR);
+
+    le_cfg_GoToNode(iteratorRef, "tiers");
+
+    if (le_cfg_GoToFirstChild(iteratorRef) == LE_OK)
+    {
+        do
+        {
+            int period = le_cfg_GetInt(iteratorRef, "period", 0);
+            int retention = le_cfg_GetInt(iteratorRef, "retention", 0);
+
+            if (TierCount >= SENSOR_ROLLUP_MAX_TIERS)
+            {
+                LE_WARN("Too many rollup tiers, only %d used", SENSOR_ROLLUP_MAX_TIERS);
+                break;
+            }
+
+            if ((period <= 0) || (retention < period) ||
+                ((TierCount > 0) && ((period % Tiers[TierCount - 1].period) != 0)))
+            {
+                LE_WARN("Invalid rollup tier: period %d, retention %d", period, retention);
+                continue;
+            }
+
+            Tiers[TierCount].period = period;
+            Tiers[TierCount].retention = retention;
+            TierCount++;
+        }
+        while (le_cfg_GoToNextSibling(iteratorRef) == LE_OK);
+    }
+
+    le_cfg_CancelTxn(iteratorRef);
+
+    if (TierCount == 0)
+    {
+        Tiers[0].period = SENSOR_ROLLUP_DEFAULT_PERIOD_1;
+        Tiers[0].retention = SENSOR_ROLLUP_DEFAULT_RETENTION_1;
+        Tiers[1].period = SENSOR_ROLLUP_DEFAULT_PERIOD_2;
+        Tiers[1].retention = SENSOR_ROLLUP_DEFAULT_RETENTION_2;
+        TierCount = 2;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the tiers from the configuration tree, open their current segments and start the timer
+ * flushing the buckets
+ */
+//--------------------------------------------------------------------------------------------------
+void rollup_Init
+(
+    void
+)
+{
+#if LE_CONFIG_LINUX
+    char dir[MAX_PATH_LEN - 32];
+    uint32_t now = le_clk_GetAbsoluteTime().sec;
+    uint32_t i;
+
+    if (!ReadConfig(dir, sizeof(dir)))
+    {
+        return;
+    }
+
+    for (i = 0; i < TierCount; i++)
+    {
+        tier_t* tierPtr = &Tiers[i];
+        uint32_t segmentSpan = tierPtr->retention / SENSOR_ROLLUP_SEGMENT_COUNT;
+
+        // Segments hold whole buckets.
+        tierPtr->segmentSpan = (segmentSpan < tierPtr->period) ?
+                               tierPtr->period :
+                               (segmentSpan - (segmentSpan % tierPtr->period));
+        tierPtr->nextFlush = now - (now % tierPtr->period) + tierPtr->period;
+        tierPtr->dataFd = -1;
+        tierPtr->indexFd = -1;
+
+        snprintf(tierPtr->dir, sizeof(tierPtr->dir), "%s/%" PRIu32, dir, tierPtr->period);
+
+        if (le_dir_MakePath(tierPtr->dir, S_IRWXU | S_IRGRP | S_IXGRP) != LE_OK)
+        {
+            LE_ERROR("Cannot create %s, rollups disabled", tierPtr->dir);
+            TierCount = 0;
+            return;
+        }
+
+        LE_INFO("Rollup tier %s: %" PRIu32 " s buckets kept %" PRIu32 " s",
+                tierPtr->dir, tierPtr->period, tierPtr->retention);
+    }
+
+    LoadSeries(dir);
+
+    FlushTimer = le_timer_Create("rollupFlush");
+    le_timer_SetRepeat(FlushTimer, 1);
+    le_timer_SetHandler(FlushTimer, FlushHandler);
+
+    FlushHandler(FlushTimer);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the rollups of a sensor
+ *
+ * @return:
+ *      - Series, NULL if rollups are disabled or there are too many series
+ */
+//--------------------------------------------------------------------------------------------------
+rollup_Series_t* rollup_GetSeries
+(
+    const char* pathPtr                         ///< [IN] Path of the sensor
+)
+{
+    rollup_Series_t* seriesPtr;
+    seriesEntry_t entry;
+
+    if (TierCount == 0)
+    {
+        return NULL;
+    }
+
+    // A sensor registered again, in this run or a previous one, keeps its series.
+    seriesPtr = FindSeries(pathPtr);
+
+    if (seriesPtr != NULL)
+    {
+        return seriesPtr;
+    }
+
+    if (SeriesCount >= SENSOR_HANDLER_POOL_SIZE)
+    {
+        LE_WARN("Too many series, %s not rolled up", pathPtr);
+        return NULL;
+    }
+
+    memset(&entry, 0, sizeof(entry));
+
+    if (le_utf8_Copy(entry.path, pathPtr, sizeof(entry.path), NULL) != LE_OK)
+    {
+        LE_WARN("Path too long, %s not rolled up", pathPtr);
+        return NULL;
+    }
+
+    // Paths whose hashes collide get distinct keys, the first free one after the hash.
+    entry.key = HashPath(pathPtr);
+
+    while (IsKeyTaken(entry.key))
+    {
+        entry.key++;
+    }
+
+#if LE_CONFIG_LINUX
+    // The key must be on disk before any record, or it could go to another path after a restart.
+    if ((SeriesFd < 0) || (write(SeriesFd, &entry, sizeof(entry)) != sizeof(entry)))
+    {
+        LE_WARN("Cannot record the series of %s, not rolled up", pathPtr);
+        return NULL;
+    }
+#endif
+
+    return AddSeries(&entry);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a numeric sample to the current bucket of the finest tier. Runs on the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void rollup_AddSample
+(
+    rollup_Series_t* seriesPtr,                 ///< [IN] Series (or NULL)
+    double value                                ///< [IN] Calibrated value
+)
+{
+    bucket_t* bucketPtr;
+
+    if ((seriesPtr == NULL) || isnan(value))
+    {
+        return;
+    }
+
+    bucketPtr = &seriesPtr->buckets[0];
+
+    if ((bucketPtr->count == 0) || (value < bucketPtr->min))
+    {
+        bucketPtr->min = value;
+    }
+
+    if ((bucketPtr->count == 0) || (value > bucketPtr->max))
+    {
+        bucketPtr->max = value;
+    }
+
+    bucketPtr->sum += value;
+    bucketPtr->count++;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the records of a sensor in a time range from the coarsest tier whose period is not longer
+ * than the requested resolution
+ *
+ * @return:
+ *      - LE_OK if all the records in the range were read
+ *      - LE_OVERFLOW if there are more records than recordCount or more than
+ *        SENSOR_ROLLUP_QUERY_SCAN_COUNT records to scan, read the next ones from *nextPtr
+ *      - LE_UNSUPPORTED if the resolution is finer than the finest tier
+ *      - LE_NOT_FOUND if rollups are disabled
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t rollup_Query
+(
+    const char* pathPtr,                        ///< [IN]     Path of the sensor
+    double start,                               ///< [IN]     Start of the range, seconds
+    double end,                                 ///< [IN]     End of the range (excluded)
+    double resolution,                          ///< [IN]     Coarsest acceptable period, seconds
+    double* periodPtr,                          ///< [OUT]    Period of the tier read
+    double* nextPtr,                            ///< [OUT]    Start of the next query
+    rollup_Record_t* recordsPtr,                ///< [OUT]    Records, in time order
+    size_t* recordCountPtr                      ///< [IN/OUT] Size of the array, records read
+)
+{
+    size_t maxCount = *recordCountPtr;
+    int tierIndex;
+
+    *recordCountPtr = 0;
+    *periodPtr = 0;
+    *nextPtr = end;
+
+    if (TierCount == 0)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    for (tierIndex = TierCount - 1; tierIndex >= 0; tierIndex--)
+    {
+        if (Tiers[tierIndex].period <= resolution)
+        {
+            break;
+        }
+    }
+
+    if (tierIndex < 0)
+    {
+        return LE_UNSUPPORTED;
+    }
+
+    *periodPtr = Tiers[tierIndex].period;
+
+#if LE_CONFIG_LINUX
+    const tier_t* tierPtr = &Tiers[tierIndex];
+    const rollup_Series_t* seriesPtr = FindSeries(pathPtr);
+    uint32_t startSec = ToSeconds(start);
+    uint32_t endSec = ToSeconds(end);
+    uint32_t starts[MAX_SEGMENTS];
+    size_t scanCount = SENSOR_ROLLUP_QUERY_SCAN_COUNT;
+    size_t count;
+    size_t i;
+
+    if (seriesPtr == NULL)
+    {
+        return LE_OK;
+    }
+
+    count = ListSegments(tierPtr, startSec, endSec, starts);
+
+    // Queries run on the main thread, so each one scans a bounded number of records.
+    for (i = 0; i < count; i++)
+    {
+        if (ReadSegment(tierPtr, starts[i], seriesPtr->key, startSec, endSec,
+                        recordsPtr, maxCount, recordCountPtr, &scanCount, nextPtr) == LE_OVERFLOW)
+        {
+            return LE_OVERFLOW;
+        }
+    }
+#endif
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the rollups of a sensor in a time range (sensorHistory API)
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t sensorHistory_Query
+(
+    const char* pathPtr,
+    double start,
+    double end,
+    double resolution,
+    double* periodPtr,
+    double* nextPtr,
+    double* timePtr,
+    size_t* timeSizePtr,
+    double* minPtr,
+    size_t* minSizePtr,
+    double* maxPtr,
+    size_t* maxSizePtr,
+    double* meanPtr,
+    size_t* meanSizePtr,
+    uint32_t* countPtr,
+    size_t* countSizePtr
+)
+{
+    static rollup_Record_t records[SENSORHISTORY_MAX_RECORDS];
+    size_t* sizePtrs[] = { timeSizePtr, minSizePtr, maxSizePtr, meanSizePtr, countSizePtr };
+    size_t recordCount = SENSORHISTORY_MAX_RECORDS;
+    le_result_t result;
+    size_t i;
+
+    // Fill no more records than the smallest of the arrays holds.
+    for (i = 0; i < NUM_ARRAY_MEMBERS(sizePtrs); i++)
+    {
+        if (*sizePtrs[i] < recordCount)
+        {
+            recordCount = *sizePtrs[i];
+        }
+    }
+
+    result = rollup_Query(pathPtr, start, end, resolution, periodPtr, nextPtr,
+                          records, &recordCount);
+
+    for (i = 0; i < recordCount; i++)
+    {
+        timePtr[i] = records[i].time;
+        minPtr[i] = records[i].min;
+        maxPtr[i] = records[i].max;
+        meanPtr[i] = records[i].mean;
+        countPtr[i] = records[i].count;
+    }
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(sizePtrs); i++)
+    {
+        *sizePtrs[i] = recordCount;
+    }
+
+    return result;
+}
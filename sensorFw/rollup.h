@@ -0,0 +1,116 @@
+//--------------------------------------------------------------------------------------------------
+/** @file rollup.h
+ *
+ * Long term history of the numeric sensors. Every numeric sensor is rolled up into tiers of
+ * decreasing resolution (by default one minute kept for a week and one hour kept for a year), the
+ * raw samples being kept by the Data Hub. Rollups are enabled and configured in the configuration
+ * tree under rollup/:
+ *
+ *  - enable    (bool)   roll up the numeric sensors (default false)
+ *  - dir       (string) directory of the tiers (default SENSOR_ROLLUP_DIR)
+ *  - tiers/    (list)   per tier, from the finest: period (int, seconds) and retention (int,
+ *                       seconds). The period of a tier must be a multiple of the previous one.
+ *
+ * Each tier is a directory of segment files named after the time of their first bucket. A segment
+ * covers 1/SENSOR_ROLLUP_SEGMENT_COUNT of the retention of the tier and is only ever appended to;
+ * retention removes whole segments. Records are in the byte order of the device:
+ *
+ *  - <start>.dat:  uint32 bucket time, uint32 key of the sensor, float32 min, float32 max,
+ *                  float32 mean, uint32 sample count
+ *  - <start>.idx:  uint32 bucket time, uint32 byte offset in the .dat file, one entry every
+ *                  SENSOR_ROLLUP_INDEX_STRIDE records or more, at the start of a bucket
+ *
+ * The key of a sensor is the FNV-1a hash of its path, or the next free value if another path has
+ * that key. Keys are kept in the series file of the rollup directory: uint32 key, then the path
+ * padded with nulls to IO_MAX_RESOURCE_PATH_LEN + 1 bytes.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_ROLLUP_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_ROLLUP_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rollups of one sensor
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct rollup_Series rollup_Series_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Aggregate of the samples of a sensor over one bucket of a tier
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double time;                                ///< Start of the bucket, seconds since the epoch
+    double min;                                 ///< Smallest sample
+    double max;                                 ///< Largest sample
+    double mean;                                ///< Mean of the samples
+    uint32_t count;                             ///< Number of samples
+}
+rollup_Record_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the tiers from the configuration tree, open their current segments and start the timer
+ * flushing the buckets
+ */
+//--------------------------------------------------------------------------------------------------
+void rollup_Init
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the rollups of a sensor
+ *
+ * @return:
+ *      - Series, NULL if rollups are disabled or there are too many series
+ */
+//--------------------------------------------------------------------------------------------------
+rollup_Series_t* rollup_GetSeries
+(
+    const char* pathPtr                         ///< [IN] Path of the sensor
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a numeric sample to the current bucket of the finest tier. Runs on the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void rollup_AddSample
+(
+    rollup_Series_t* seriesPtr,                 ///< [IN] Series (or NULL)
+    double value                                ///< [IN] Calibrated value
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the records of a sensor in a time range from the coarsest tier whose period is not longer
+ * than the requested resolution
+ *
+ * @return:
+ *      - LE_OK if all the records in the range were read
+ *      - LE_OVERFLOW if there are more records than recordCount or more than
+ *        SENSOR_ROLLUP_QUERY_SCAN_COUNT records to scan, read the next ones from *nextPtr
+ *      - LE_UNSUPPORTED if the resolution is finer than the finest tier
+ *      - LE_NOT_FOUND if rollups are disabled
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t rollup_Query
+(
+    const char* pathPtr,                        ///< [IN]     Path of the sensor
+    double start,                               ///< [IN]     Start of the range, seconds
+    double end,                                 ///< [IN]     End of the range (excluded)
+    double resolution,                          ///< [IN]     Coarsest acceptable period, seconds
+    double* periodPtr,                          ///< [OUT]    Period of the tier read
+    double* nextPtr,                            ///< [OUT]    Start of the next query
+    rollup_Record_t* recordsPtr,                ///< [OUT]    Records, in time order
+    size_t* recordCountPtr                      ///< [IN/OUT] Size of the array, records read
+);
+
+#endif /* LEGATO_SENSOR_FW_ROLLUP_INCLUDE_GUARD */
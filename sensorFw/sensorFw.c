@@ -9,9 +9,23 @@
 //--------------------------------------------------------------------------------------------------
 
 #include "legato.h"
+#include <math.h>
 #include "interfaces.h"
 #include "sensorFw.h"
 #include "config.h"
+#include "calibration.h"
+#include "store.h"
+#include "pushQueue.h"
+#include "checkpoint.h"
+#include "metrics.h"
+#include "budget.h"
+#include "heap.h"
+#include "inference.h"
+#include "delta.h"
+#include "rollup.h"
+#include "snapshot.h"
+#include "pressure.h"
+#include "trace.h"
 
 #define dhubIO_DataType_t io_DataType_t
 
@@ -25,6 +39,20 @@
 //--------------------------------------------------------------------------------------------------
 #define     DEFAULT_SAMPLING_PERIOD_SEC          60
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Root of the absolute Data Hub paths of the resources created by sensorFw
+ */
+//--------------------------------------------------------------------------------------------------
+#define     APP_RESOURCE_ROOT                    "/app/sensorFw"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * History depth or backup period requested with the per-type default
+ */
+//--------------------------------------------------------------------------------------------------
+#define     HISTORY_DEFAULT                      (-1)
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Maximum number of bytes for a sensor resource name
@@ -51,12 +79,42 @@ typedef struct
     char name[MAX_RESOURCE_NAME_LEN];            ///< Name of the sensor
     char path[IO_MAX_RESOURCE_PATH_LEN];         ///< Path name provided by plugin
     bool isReadOnce;                             ///< is sensor to be sampled only once?
+    double period;                               ///< Default sampling period in seconds
     char unit[IO_MAX_UNITS_NAME_LEN];            ///< Measurement unit
+    char plugin[SENSORSTATS_MAX_PLUGIN_NAME_LEN + 1]; ///< Name of the plugin
+    int32_t historyDepth;                        ///< Samples buffered by datahub (0 = none)
+    int32_t backupPeriod;                        ///< Flash backup period of the buffer in seconds
     dhubIO_DataType_t type;                      ///< data type of entry in datahub
     psensor_Ref_t sensorRef;                     ///< Reference for the periodic sensor
+    uint32_t deltaKeyframes;                     ///< Pushes per full JSON document (0 = no patch)
+    pressure_Priority_t priority;                ///< Priority when the system is under pressure
 }
 sensorInfo_t;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runtime statistics of a sensor, exposed through the sensorStats API. The statistics of the sample
+ * callback are updated by the thread reading the sample, with atomic operations.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_clk_Time_t registrationTime;              ///< Relative time of the registration
+    uint32_t readCount;                          ///< Number of samples read from the plugin
+    uint32_t sampleCount;                        ///< Number of samples pushed
+    uint32_t failureCount;                       ///< Number of failed callbacks
+    uint64_t callbackTimeUs;                     ///< Total time spent in the sample callback
+    uint32_t callbackMaxUs;                      ///< Longest sample callback
+    uint64_t pushTimeUs;                         ///< Total time spent pushing to datahub
+    uint32_t pushMaxUs;                          ///< Longest push
+    uint64_t bytesPushed;                        ///< Bytes of sample data pushed
+    uint32_t latencyBuckets[METRICS_LATENCY_BUCKET_COUNT]; ///< Callbacks per latency bucket
+    le_clk_Time_t lastTickTime;                  ///< Relative time of the last periodic sample
+    uint64_t latenessTimeUs;                     ///< Total delay of periodic samples
+    uint32_t latenessBuckets[METRICS_LATENCY_BUCKET_COUNT]; ///< Periodic samples per delay bucket
+}
+sensorStats_t;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sensor handler
@@ -67,10 +125,46 @@ typedef struct
     sensorInfo_t info;                           ///< Information about the registered sensor
     sensorfwCallbacks_t callbacks;               ///< Callbacks implemented by the plugin
     void* pluginContextPtr;                      ///< Context passed by plugin
+    calibration_t* calibrationPtr;               ///< Calibration of numeric samples (or NULL)
+    bool hasLastNumeric;                         ///< Has a numeric sample been published yet?
+    double lastNumeric;                          ///< Last published numeric sample
+    checkpoint_Entry_t* checkpointPtr;           ///< State kept across restarts (or NULL)
+    bool isEnabled;                              ///< Is the periodic sensor enabled?
+    double appliedPeriod;                        ///< Period pushed to datahub, stretched by budget
+                                                 ///< and pressure
+    budget_Plugin_t* budgetPtr;                  ///< Accounting of the plugin (or NULL)
+    inference_Input_t* inferencePtr;             ///< Models fed by the sensor (or NULL)
+    rollup_Series_t* rollupPtr;                  ///< Rollups of the sensor (or NULL)
+    snapshot_Entry_t* snapshotPtr;               ///< Entry in the snapshot (or NULL)
+    bool isTemperatureSource;                    ///< Is the sensor the device temperature?
+    delta_t* valueDeltaPtr;                      ///< Patches of the JSON samples (or NULL)
+    delta_t* configDeltaPtr;                     ///< Patches of the configuration (or NULL)
+    sensorStats_t stats;                         ///< Runtime statistics
 }
 sensorHandler_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default history of a sensor, per data type
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    dhubIO_DataType_t type;                      ///< data type of entry in datahub
+    uint32_t depth;                              ///< Samples buffered by datahub
+    uint32_t backupPeriod;                       ///< Flash backup period in seconds (0 = none)
+}
+historyDefault_t;
+
+static const historyDefault_t HistoryDefaults[] =
+{
+    {IO_DATA_TYPE_BOOLEAN,     256,    3600},
+    {IO_DATA_TYPE_NUMERIC,     256,    3600},
+    {IO_DATA_TYPE_STRING,      16,     0},
+    {IO_DATA_TYPE_JSON,        16,     0}
+};
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Pool of registered sensors
@@ -87,6 +181,46 @@ static le_mem_PoolRef_t SensorHandlerPool = NULL;
 LE_MEM_DEFINE_STATIC_POOL(SensorHandlerPool,
     SENSOR_HANDLER_POOL_SIZE, sizeof(sensorHandler_t));
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of calibration descriptors
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t CalibrationPool = NULL;
+
+LE_MEM_DEFINE_STATIC_POOL(CalibrationPool,
+    SENSOR_CALIBRATION_POOL_SIZE, sizeof(calibration_t));
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of delta encoders of JSON resources
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t DeltaPool = NULL;
+
+LE_MEM_DEFINE_STATIC_POOL(DeltaPool,
+    SENSOR_DELTA_POOL_SIZE, sizeof(delta_t));
+
+LE_STATIC_ASSERT(DELTA_MAX_DOC_LEN >= MAX_RES_STRING_LEN, "Delta encoder too small for a sample");
+
+LE_STATIC_ASSERT(SENSOR_PUSH_STRING_LEN >= MAX_RES_STRING_LEN, "Staging slab too small");
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Registered sensors, by path
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t SensorPathMap = NULL;
+
+LE_HASHMAP_DEFINE_STATIC(SensorPathMap, SENSOR_HANDLER_POOL_SIZE);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Registered sensors, by sensor id
+ */
+//--------------------------------------------------------------------------------------------------
+static sensorHandler_t* SensorList[SENSOR_HANDLER_POOL_SIZE];
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Count for the number of sensors registered to the framework
@@ -96,187 +230,726 @@ static int RegisteredSensorCount;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Samples data and pushes the sample to datahub
+ * Get the temperature a calibration is compensated with
+ *
+ * @return:
+ *      - Last value of the reference sensor, NAN if not available or not compensated
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetCalibrationTemperature
+(
+    const calibration_t* calibrationPtr          ///< [IN] Calibration descriptor
+)
+{
+    if (calibrationPtr->type == CALIBRATION_TEMP_COMP)
+    {
+        const sensorHandler_t* refPtr = le_hashmap_Get(SensorPathMap, calibrationPtr->refPath);
+
+        if ((refPtr != NULL) && refPtr->hasLastNumeric)
+        {
+            return refPtr->lastNumeric;
+        }
+    }
+
+    return NAN;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Calibrate numeric samples of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+static void ApplyCalibration
+(
+    sensorHandler_t* handlerPtr,                 ///< [IN] Handler to the registered sensor
+    double* valuesPtr,                           ///< [INOUT] Samples
+    size_t count                                 ///< [IN] Number of samples
+)
+{
+    const calibration_t* calibrationPtr = handlerPtr->calibrationPtr;
+
+    if (calibrationPtr == NULL)
+    {
+        return;
+    }
+
+    calibration_Apply(calibrationPtr, GetCalibrationTemperature(calibrationPtr), valuesPtr, count);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Calibrate every number of a JSON sample, e.g. the axes of a multi-channel sensor
+ *
+ * @return:
+ *      - Calibrated sample, or the sample itself if it has no calibration or cannot be calibrated
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* ApplyJsonCalibration
+(
+    sensorHandler_t* handlerPtr,                 ///< [IN]  Handler to the registered sensor
+    const char* docPtr,                          ///< [IN]  Sample
+    char* bufferPtr,                             ///< [OUT] Buffer for the calibrated sample
+    size_t bufferSize                            ///< [IN]  Buffer size
+)
+{
+    const calibration_t* calibrationPtr = handlerPtr->calibrationPtr;
+
+    if (calibrationPtr == NULL)
+    {
+        return docPtr;
+    }
+
+    if (calibration_ApplyJson(calibrationPtr,
+                              GetCalibrationTemperature(calibrationPtr),
+                              docPtr,
+                              bufferPtr,
+                              bufferSize) != LE_OK)
+    {
+        LE_WARN("Sample of %s too large to be calibrated", handlerPtr->info.path);
+        return docPtr;
+    }
+
+    return bufferPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set, replace or remove the calibration of a numeric or JSON sensor
  *
  * @return:
  *      - LE_OK on success
- *      - LE_FAULT on any other error
+ *      - LE_FORMAT_ERROR if the calibration descriptor is not valid
+ *      - LE_NO_MEMORY if no more calibration can be allocated
+ *      - LE_OVERFLOW if the descriptor is too long to be stored
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t PushData
+static le_result_t SetCalibration
 (
-    sensorHandler_t* handlerPtr                  ///< [IN] Handler to the registered sensor
+    sensorHandler_t* handlerPtr,                 ///< [IN] Handler to the registered sensor
+    const char* jsonStringPtr,                   ///< [IN] Calibration descriptor, NULL to remove
+    bool isPersistent                            ///< [IN] Store the descriptor?
 )
 {
+    calibration_t calibration;
+    bool isAllocated = false;
     le_result_t result;
 
-    pfBool readBoolValue;
-    pfNumeric readNumericValue;
-    pfString readStringValue;
+    if ((handlerPtr->info.type != IO_DATA_TYPE_NUMERIC) &&
+        (handlerPtr->info.type != IO_DATA_TYPE_JSON))
+    {
+        LE_ERROR("%s is not numeric nor JSON, calibration ignored", handlerPtr->info.path);
+        return LE_FORMAT_ERROR;
+    }
 
-    bool boolSample;
-    double numericSample;
-    char sampleString[MAX_RES_STRING_LEN];
-    size_t length;
+    if (jsonStringPtr == NULL)
+    {
+        calibration.type = CALIBRATION_NONE;
+    }
+    else if (calibration_Parse(jsonStringPtr, &calibration) != LE_OK)
+    {
+        LE_ERROR("Invalid calibration for %s: %s", handlerPtr->info.path, jsonStringPtr);
+        return LE_FORMAT_ERROR;
+    }
 
-    switch(handlerPtr->info.type)
+    if (calibration.type == CALIBRATION_NONE)
     {
-        case IO_DATA_TYPE_BOOLEAN:
-            readBoolValue = (pfBool)(handlerPtr->callbacks.sample.boolCb);
-            length = sizeof(bool);
-            result = readBoolValue(&boolSample, &length, handlerPtr->pluginContextPtr);
+        if (handlerPtr->calibrationPtr != NULL)
+        {
+            le_mem_Release(handlerPtr->calibrationPtr);
+            handlerPtr->calibrationPtr = NULL;
+            budget_AddMemory(handlerPtr->budgetPtr, -(ssize_t)sizeof(calibration_t));
+        }
 
-            if (result == LE_OK)
-            {
-                if (handlerPtr->info.isReadOnce)
-                {
-                    io_PushBoolean(handlerPtr->info.path, IO_NOW, boolSample);
-                }
-                else
-                {
-                    psensor_PushBoolean(handlerPtr->info.sensorRef, IO_NOW, boolSample);
-                }
-            }
-            else
-            {
-                LE_ERROR("Error sampling sensor");
-                return LE_FAULT;
-            }
-            break;
+        if (isPersistent)
+        {
+            store_Delete(handlerPtr->info.path, "calibration");
+        }
 
-        case IO_DATA_TYPE_NUMERIC:
-            readNumericValue = (pfNumeric)(handlerPtr->callbacks.sample.numericCb);
-            length = sizeof(numericSample);
-            result = readNumericValue(&numericSample, &length, handlerPtr->pluginContextPtr);
+        LE_INFO("Calibration of %s removed", handlerPtr->info.path);
+        return LE_OK;
+    }
 
-            if (result == LE_OK)
-            {
-                if (handlerPtr->info.isReadOnce)
-                {
-                    io_PushNumeric(handlerPtr->info.path, IO_NOW, numericSample);
-                }
-                else
-                {
-                    psensor_PushNumeric(handlerPtr->info.sensorRef, IO_NOW, numericSample);
-                }
-            }
-            else
-            {
-                LE_ERROR("Error sampling sensor");
-                return LE_FAULT;
-            }
-            break;
+    if (handlerPtr->calibrationPtr == NULL)
+    {
+        handlerPtr->calibrationPtr = le_mem_TryAlloc(CalibrationPool);
 
-        case IO_DATA_TYPE_STRING:
-            readStringValue = (pfString)(handlerPtr->callbacks.sample.stringCb);
-            length = sizeof(sampleString);
-            result = readStringValue(sampleString, &length, handlerPtr->pluginContextPtr);
+        if (handlerPtr->calibrationPtr == NULL)
+        {
+            LE_ERROR("No more calibration available for %s", handlerPtr->info.path);
+            return LE_NO_MEMORY;
+        }
 
-            if (result == LE_OK)
-            {
-                if (handlerPtr->info.isReadOnce)
-                {
-                    io_PushString(handlerPtr->info.path, IO_NOW, sampleString);
-                }
-                else
-                {
-                    psensor_PushString(handlerPtr->info.sensorRef, IO_NOW, sampleString);
-                }
-            }
-            else
-            {
-                LE_ERROR("Error sampling sensor");
-                return LE_FAULT;
-            }
-            break;
+        budget_AddMemory(handlerPtr->budgetPtr, sizeof(calibration_t));
+        isAllocated = true;
+    }
 
-        case IO_DATA_TYPE_JSON:
-            readStringValue = (pfJSON)(handlerPtr->callbacks.sample.jsonCb);
-            length = sizeof(sampleString);
-            result = readStringValue(sampleString,  &length, handlerPtr->pluginContextPtr);
+    if (isPersistent)
+    {
+        result = store_SetString(handlerPtr->info.path, "calibration", jsonStringPtr);
 
-            if (result == LE_OK)
-            {
-                if (handlerPtr->info.isReadOnce)
-                {
-                    io_PushJson(handlerPtr->info.path, IO_NOW, sampleString);
-                }
-                else
-                {
-                    psensor_PushJson(handlerPtr->info.sensorRef, IO_NOW, sampleString);
-                }
-            }
-            else
+        // Keep the calibration in use consistent with the one applied after a restart.
+        if (result != LE_OK)
+        {
+            LE_ERROR("Calibration of %s could not be stored", handlerPtr->info.path);
+
+            if (isAllocated)
             {
-                LE_ERROR("Error sampling sensor");
-                return LE_FAULT;
+                le_mem_Release(handlerPtr->calibrationPtr);
+                handlerPtr->calibrationPtr = NULL;
+                budget_AddMemory(handlerPtr->budgetPtr, -(ssize_t)sizeof(calibration_t));
             }
-            break;
-        default:
-            LE_ERROR("Error reading value");
-            break;
+
+            return result;
+        }
     }
 
+    *handlerPtr->calibrationPtr = calibration;
+
+    LE_INFO("Calibration of %s set to %s", handlerPtr->info.path, jsonStringPtr);
     return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Pushes the sensor configuration to Datahub
+ * Process the "calibration" member of an incoming configuration
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProcessCalibrationConfig
+(
+    sensorHandler_t* handlerPtr,                 ///< [IN] Handler to the registered sensor
+    const char* jsonStringPtr                    ///< [IN] Incoming JSON config
+)
+{
+    char calibrationString[MAX_RES_STRING_LEN];
+    json_DataType_t extractedType;
+
+    if (json_Extract(calibrationString,
+                     sizeof(calibrationString),
+                     jsonStringPtr,
+                     "calibration",
+                     &extractedType) != LE_OK)
+    {
+        return;
+    }
+
+    if (extractedType == JSON_TYPE_OBJECT)
+    {
+        SetCalibration(handlerPtr, calibrationString, true);
+    }
+    else if (extractedType == JSON_TYPE_NULL)
+    {
+        SetCalibration(handlerPtr, NULL, true);
+    }
+    else
+    {
+        LE_ERROR("Calibration of %s must be an object or null", handlerPtr->info.path);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time as a datahub timestamp
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetTimestamp
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetAbsoluteTime();
+
+    return (double)now.sec + ((double)now.usec / 1000000.0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time elapsed since a relative time, in microseconds
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t GetElapsedUs
+(
+    le_clk_Time_t start                          ///< [IN] Relative time
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    return (uint32_t)(elapsed.sec * 1000000 + elapsed.usec);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a sample from the plugin. Runs on the thread that requested the sample.
  *
  * @return:
  *      - LE_OK on success
+ *      - LE_UNAVAILABLE if the plugin had no new sample
  *      - LE_FAULT on any other error
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t PushConfig
+static le_result_t ReadSample
 (
-    sensorHandler_t* handlerPtr                  ///< [IN] Handler to the registered sensor
+    sensorHandler_t* handlerPtr,                 ///< [IN]  Handler to the registered sensor
+    pushQueue_Sample_t* samplePtr,               ///< [OUT] Sample
+    char* stringPtr,                             ///< [OUT] Buffer for string and JSON samples
+    size_t stringSize                            ///< [IN]  Buffer size
 )
 {
     le_result_t result;
+    size_t length;
 
-    pfString readStringValue;
-    char sampleString[MAX_RES_STRING_LEN];
-    size_t length = sizeof(sampleString);
+    sensorStats_t* statsPtr = &handlerPtr->stats;
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+    uint32_t elapsedUs;
 
-    LE_INFO("Read config of %s", handlerPtr->info.name);
+    samplePtr->handlerPtr = handlerPtr;
+    samplePtr->type = handlerPtr->info.type;
+    trace_Begin(&samplePtr->trace);
 
-    readStringValue = (pfString)(handlerPtr->callbacks.configCb);
-    result = readStringValue(sampleString, &length, handlerPtr->pluginContextPtr);
+    switch(handlerPtr->info.type)
+    {
+        case IO_DATA_TYPE_BOOLEAN:
+            length = sizeof(bool);
+            result = handlerPtr->callbacks.sample.boolCb(&samplePtr->value.boolean,
+                                                         &length,
+                                                         handlerPtr->pluginContextPtr);
+            break;
 
-    char resourcePath[IO_MAX_RESOURCE_PATH_LEN + MAX_RESOURCE_NAME_LEN];
-    snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, "config");
+        case IO_DATA_TYPE_NUMERIC:
+            length = sizeof(double);
+            result = handlerPtr->callbacks.sample.numericCb(&samplePtr->value.numeric,
+                                                            &length,
+                                                            handlerPtr->pluginContextPtr);
+            break;
 
-    if (result == LE_OK)
-    {
-        LE_INFO("set %s to %s", resourcePath, sampleString);
-        io_PushJson(resourcePath, IO_NOW, sampleString);
+        case IO_DATA_TYPE_STRING:
+            length = stringSize;
+            samplePtr->value.stringPtr = stringPtr;
+            result = handlerPtr->callbacks.sample.stringCb(stringPtr,
+                                                           &length,
+                                                           handlerPtr->pluginContextPtr);
+            break;
+
+        case IO_DATA_TYPE_JSON:
+            length = stringSize;
+            samplePtr->value.stringPtr = stringPtr;
+            result = handlerPtr->callbacks.sample.jsonCb(stringPtr,
+                                                         &length,
+                                                         handlerPtr->pluginContextPtr);
+            break;
 
+        default:
+            LE_ERROR("Error reading value");
+            return LE_FAULT;
     }
-    else
+
+    trace_EndRead(&samplePtr->trace);
+
+    elapsedUs = GetElapsedUs(start);
+    __atomic_add_fetch(&statsPtr->callbackTimeUs, elapsedUs, __ATOMIC_RELAXED);
+    metrics_RecordLatency(statsPtr->latencyBuckets, elapsedUs);
+    budget_RecordCallback(handlerPtr->budgetPtr, elapsedUs);
+
+    uint32_t maxUs = __atomic_load_n(&statsPtr->callbackMaxUs, __ATOMIC_RELAXED);
+
+    while ((elapsedUs > maxUs) &&
+           !__atomic_compare_exchange_n(&statsPtr->callbackMaxUs, &maxUs, elapsedUs, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
     {
-        LE_ERROR("Error reading sensor configuration");
+    }
+
+    if ((result != LE_OK) && (result != LE_UNAVAILABLE))
+    {
+        LE_ERROR("Error sampling sensor");
+        __atomic_add_fetch(&statsPtr->failureCount, 1, __ATOMIC_RELAXED);
+        checkpoint_RecordFailure(handlerPtr->checkpointPtr);
         return LE_FAULT;
     }
 
-    return LE_OK;
+    if (result == LE_OK)
+    {
+        __atomic_add_fetch(&statsPtr->readCount, 1, __ATOMIC_RELAXED);
+    }
+
+    return result;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Callback when an update is received from the Data Hub for the "config"
+ * Encode a JSON document of a sensor published as merge patches
+ *
+ * @return:
+ *      - true if the patch is to be published instead of the document
+ *      - false if the document is to be published in full
  */
 //--------------------------------------------------------------------------------------------------
-static void ConfigUpdateHandler
+static bool EncodeDelta
 (
-    double timestamp,                           ///< timestamp
-    const char* jsonStringPtr,                  ///< incoming JSON config
-    void* contextPtr                            ///< not used
+    sensorHandler_t* handlerPtr,                 ///< [IN]    Handler to the registered sensor
+    delta_t** deltaPtrPtr,                       ///< [INOUT] Encoder of the resource
+    const char* docPtr,                          ///< [IN]    Document
+    char* patchPtr,                              ///< [OUT]   Patch
+    size_t patchSize                             ///< [IN]    Buffer size
 )
-//--------------------------------------------------------------------------------------------------
 {
-    LE_INFO("Received update to 'config' : (timestamped %lf)"
+    if (handlerPtr->info.deltaKeyframes == 0)
+    {
+        return false;
+    }
+
+    if (*deltaPtrPtr == NULL)
+    {
+        *deltaPtrPtr = le_mem_TryAlloc(DeltaPool);
+
+        if (*deltaPtrPtr == NULL)
+        {
+            LE_WARN("No more delta encoder, %s is published in full", handlerPtr->info.path);
+            handlerPtr->info.deltaKeyframes = 0;
+            return false;
+        }
+
+        memset(*deltaPtrPtr, 0, sizeof(delta_t));
+        budget_AddMemory(handlerPtr->budgetPtr, sizeof(delta_t));
+    }
+
+    return delta_Encode(*deltaPtrPtr, docPtr, handlerPtr->info.deltaKeyframes, patchPtr, patchSize);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pushes a sample to datahub. Runs on the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PublishSample
+(
+    const pushQueue_Sample_t* samplePtr          ///< [IN] Sample
+)
+{
+    sensorHandler_t* handlerPtr = samplePtr->handlerPtr;
+    sensorStats_t* statsPtr = &handlerPtr->stats;
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+    uint32_t elapsedUs;
+    size_t bytes = sizeof(double);
+    double numericSample;
+    const double* checkpointValuePtr = NULL;
+    char inputPath[IO_MAX_RESOURCE_PATH_LEN + MAX_RESOURCE_NAME_LEN];
+    const char* inputPathPtr = handlerPtr->info.path;
+    char patch[MAX_RES_STRING_LEN];
+    char calibrated[MAX_RES_STRING_LEN];
+    const char* jsonPtr;
+    double timestamp = (samplePtr->timestamp == IO_NOW) ? GetTimestamp() : samplePtr->timestamp;
+
+    // Sensors timed by their plugin publish in the "value" input, like periodic sensors.
+    if (!handlerPtr->info.isReadOnce && (handlerPtr->info.sensorRef == NULL))
+    {
+        snprintf(inputPath, sizeof(inputPath), "%s/%s", handlerPtr->info.path, "value");
+        inputPathPtr = inputPath;
+    }
+
+    switch(samplePtr->type)
+    {
+        case IO_DATA_TYPE_BOOLEAN:
+            bytes = sizeof(bool);
+            numericSample = samplePtr->value.boolean;
+            checkpointValuePtr = &numericSample;
+            snapshot_UpdateNumeric(handlerPtr->snapshotPtr, timestamp, numericSample, true);
+
+            if (handlerPtr->info.sensorRef == NULL)
+            {
+                io_PushBoolean(inputPathPtr,
+                               samplePtr->timestamp,
+                               samplePtr->value.boolean);
+            }
+            else
+            {
+                psensor_PushBoolean(handlerPtr->info.sensorRef,
+                                    samplePtr->timestamp,
+                                    samplePtr->value.boolean);
+            }
+            break;
+
+        case IO_DATA_TYPE_NUMERIC:
+            numericSample = samplePtr->value.numeric;
+            ApplyCalibration(handlerPtr, &numericSample, 1);
+            handlerPtr->lastNumeric = numericSample;
+            handlerPtr->hasLastNumeric = true;
+            checkpointValuePtr = &numericSample;
+            inference_AddSample(handlerPtr->inferencePtr, samplePtr->timestamp, numericSample);
+            rollup_AddSample(handlerPtr->rollupPtr, numericSample);
+            snapshot_UpdateNumeric(handlerPtr->snapshotPtr, timestamp, numericSample, false);
+
+            if (handlerPtr->isTemperatureSource)
+            {
+                pressure_RecordTemperature(numericSample);
+            }
+
+            if (handlerPtr->info.sensorRef == NULL)
+            {
+                io_PushNumeric(inputPathPtr, samplePtr->timestamp, numericSample);
+            }
+            else
+            {
+                psensor_PushNumeric(handlerPtr->info.sensorRef,
+                                    samplePtr->timestamp,
+                                    numericSample);
+            }
+            break;
+
+        case IO_DATA_TYPE_STRING:
+            bytes = strlen(samplePtr->value.stringPtr);
+            snapshot_UpdateString(handlerPtr->snapshotPtr, timestamp,
+                                  samplePtr->value.stringPtr, false);
+
+            if (handlerPtr->info.sensorRef == NULL)
+            {
+                io_PushString(inputPathPtr,
+                              samplePtr->timestamp,
+                              samplePtr->value.stringPtr);
+            }
+            else
+            {
+                psensor_PushString(handlerPtr->info.sensorRef,
+                                   samplePtr->timestamp,
+                                   samplePtr->value.stringPtr);
+            }
+            break;
+
+        case IO_DATA_TYPE_JSON:
+            jsonPtr = ApplyJsonCalibration(handlerPtr,
+                                           samplePtr->value.stringPtr,
+                                           calibrated,
+                                           sizeof(calibrated));
+            bytes = strlen(jsonPtr);
+            snapshot_UpdateString(handlerPtr->snapshotPtr, timestamp, jsonPtr, true);
+
+            if (!handlerPtr->info.isReadOnce &&
+                EncodeDelta(handlerPtr,
+                            &handlerPtr->valueDeltaPtr,
+                            jsonPtr,
+                            patch,
+                            sizeof(patch)))
+            {
+                snprintf(inputPath, sizeof(inputPath), "%s/%s",
+                         handlerPtr->info.path, "valuePatch");
+                io_PushJson(inputPath, samplePtr->timestamp, patch);
+                bytes = strlen(patch);
+            }
+            else if (handlerPtr->info.sensorRef == NULL)
+            {
+                io_PushJson(inputPathPtr, samplePtr->timestamp, jsonPtr);
+            }
+            else
+            {
+                psensor_PushJson(handlerPtr->info.sensorRef, samplePtr->timestamp, jsonPtr);
+            }
+            break;
+
+        default:
+            LE_ERROR("Error pushing value");
+            return;
+    }
+
+    elapsedUs = GetElapsedUs(start);
+    statsPtr->pushTimeUs += elapsedUs;
+
+    if (elapsedUs > statsPtr->pushMaxUs)
+    {
+        statsPtr->pushMaxUs = elapsedUs;
+    }
+
+    statsPtr->sampleCount++;
+    statsPtr->bytesPushed += bytes;
+    budget_RecordPush(handlerPtr->budgetPtr, elapsedUs);
+
+    checkpoint_RecordSample(handlerPtr->checkpointPtr, timestamp, checkpointValuePtr);
+
+    if (samplePtr->trace.id != 0)
+    {
+        trace_EndPush(&samplePtr->trace, handlerPtr->info.path, timestamp, start, elapsedUs);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stages a sample taken on a plugin thread, to be pushed by the main thread
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the staging ring of the calling thread is full
+ *      - LE_NO_MEMORY if no staging ring is available
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t StageSample
+(
+    pushQueue_Sample_t* samplePtr                ///< [IN] Sample, string is copied
+)
+{
+    if (samplePtr->timestamp == IO_NOW)
+    {
+        samplePtr->timestamp = GetTimestamp();
+    }
+
+    if ((samplePtr->type == IO_DATA_TYPE_STRING) || (samplePtr->type == IO_DATA_TYPE_JSON))
+    {
+        return pushQueue_PutString(samplePtr);
+    }
+
+    return pushQueue_Put(samplePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Samples data and pushes the sample to datahub. When called from a plugin thread the sample is
+ * staged and pushed by the main thread.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNAVAILABLE if the plugin had no new sample, nothing is pushed
+ *      - LE_OVERFLOW or LE_NO_MEMORY if the sample could not be staged
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t PushData
+(
+    sensorHandler_t* handlerPtr                  ///< [IN] Handler to the registered sensor
+)
+{
+    le_result_t result;
+    pushQueue_Sample_t sample;
+    char sampleString[MAX_RES_STRING_LEN] = "";
+
+    result = ReadSample(handlerPtr, &sample, sampleString, sizeof(sampleString));
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    sample.timestamp = IO_NOW;
+
+    // Traced samples are timestamped with their capture, for the sinks to measure the latency.
+    if (sample.trace.id != 0)
+    {
+        sample.timestamp = GetTimestamp() - sample.trace.readUs / 1000000.0;
+    }
+
+    if (!pushQueue_IsDrainThread())
+    {
+        return StageSample(&sample);
+    }
+
+    PublishSample(&sample);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pushes a sample provided by the plugin to datahub, from any thread
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_BAD_PARAMETER if the sensor is not of that type
+ *      - LE_OVERFLOW or LE_NO_MEMORY if the sample could not be staged
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t PushValue
+(
+    pushQueue_Sample_t* samplePtr                ///< [IN] Sample
+)
+{
+    sensorHandler_t* handlerPtr = samplePtr->handlerPtr;
+
+    if (handlerPtr == NULL)
+    {
+        LE_ERROR("Sensor handler is NULL");
+        return LE_BAD_PARAMETER;
+    }
+
+    if (handlerPtr->info.type != samplePtr->type)
+    {
+        LE_ERROR("Wrong data type pushed to %s", handlerPtr->info.path);
+        return LE_BAD_PARAMETER;
+    }
+
+    if (trace_Begin(&samplePtr->trace) && (samplePtr->timestamp == IO_NOW))
+    {
+        samplePtr->timestamp = GetTimestamp();
+    }
+
+    if (!pushQueue_IsDrainThread())
+    {
+        return StageSample(samplePtr);
+    }
+
+    PublishSample(samplePtr);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pushes the sensor configuration to Datahub
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t PushConfig
+(
+    sensorHandler_t* handlerPtr                  ///< [IN] Handler to the registered sensor
+)
+{
+    le_result_t result;
+
+    pfString readStringValue;
+    char sampleString[MAX_RES_STRING_LEN] = "";
+    char patch[MAX_RES_STRING_LEN];
+    size_t length = sizeof(sampleString);
+
+    LE_INFO("Read config of %s", handlerPtr->info.name);
+
+    readStringValue = (pfString)(handlerPtr->callbacks.configCb);
+    result = readStringValue(sampleString, &length, handlerPtr->pluginContextPtr);
+
+    char resourcePath[IO_MAX_RESOURCE_PATH_LEN + MAX_RESOURCE_NAME_LEN];
+    snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, "config");
+
+    if (result != LE_OK)
+    {
+        LE_ERROR("Error reading sensor configuration");
+        return LE_FAULT;
+    }
+
+    if (EncodeDelta(handlerPtr, &handlerPtr->configDeltaPtr, sampleString, patch, sizeof(patch)))
+    {
+        snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, "configPatch");
+        LE_INFO("patch %s with %s", resourcePath, patch);
+        io_PushJson(resourcePath, IO_NOW, patch);
+    }
+    else
+    {
+        LE_INFO("set %s to %s", resourcePath, sampleString);
+        io_PushJson(resourcePath, IO_NOW, sampleString);
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback when an update is received from the Data Hub for the "config"
+ */
+//--------------------------------------------------------------------------------------------------
+static void ConfigUpdateHandler
+(
+    double timestamp,                           ///< timestamp
+    const char* jsonStringPtr,                  ///< incoming JSON config
+    void* contextPtr                            ///< not used
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_INFO("Received update to 'config' : (timestamped %lf)"
             "value = %s", timestamp, jsonStringPtr);
 
     // Use the context and call appropriate callback function
@@ -288,35 +961,387 @@ static void ConfigUpdateHandler
         return;
     }
 
+    // Ignore the keyframe pushed by PushConfig().
+    if ((handlerPtr->configDeltaPtr != NULL) &&
+        (strcmp(jsonStringPtr, handlerPtr->configDeltaPtr->lastDoc) == 0))
+    {
+        return;
+    }
+
     LE_INFO("Config %s", handlerPtr->info.name);
 
+    // Settings handled by the framework
+    ProcessCalibrationConfig(handlerPtr, jsonStringPtr);
+
+    if (handlerPtr->callbacks.configCb == NULL)
+    {
+        return;
+    }
+
     size_t configSize = strlen(jsonStringPtr);
     handlerPtr->callbacks.configCb((char*)jsonStringPtr,
                                    &configSize,
                                    handlerPtr->pluginContextPtr);
+
+    // Applied again at registration after a restart.
+    store_SetString(handlerPtr->info.path, "config", jsonStringPtr);
+
+    // Publish what changed in the resulting configuration.
+    if (handlerPtr->info.deltaKeyframes > 0)
+    {
+        PushConfig(handlerPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tell a plugin timing a sensor itself the period to sample it at, 0 if it is disabled
+ */
+//--------------------------------------------------------------------------------------------------
+static void NotifyPeriod
+(
+    sensorHandler_t* handlerPtr                  ///< [IN] handler
+)
+{
+    if (handlerPtr->callbacks.periodCb != NULL)
+    {
+        handlerPtr->callbacks.periodCb(handlerPtr->isEnabled ? handlerPtr->appliedPeriod : 0,
+                                       handlerPtr->pluginContextPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push the period of a periodic sensor to datahub, stretched if its plugin is over budget or if
+ * the system is under pressure
+ */
+//--------------------------------------------------------------------------------------------------
+static void ApplyPeriod
+(
+    sensorHandler_t* handlerPtr                  ///< [IN] handler
+)
+{
+    char resourcePath[IO_MAX_RESOURCE_PATH_LEN + MAX_RESOURCE_NAME_LEN];
+    double period = handlerPtr->info.period *
+                    budget_GetPeriodScale(handlerPtr->budgetPtr) *
+                    pressure_GetPeriodScale(handlerPtr->info.priority);
+
+    if (handlerPtr->info.isReadOnce || (period == handlerPtr->appliedPeriod))
+    {
+        return;
+    }
+
+    handlerPtr->appliedPeriod = period;
+
+    snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, "period");
+    io_PushNumeric(resourcePath, IO_NOW, period);
+
+    NotifyPeriod(handlerPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when the period scale of a plugin changes
+ */
+//--------------------------------------------------------------------------------------------------
+static void PeriodScaleHandler
+(
+    budget_Plugin_t* pluginPtr,                 ///< [IN] Plugin
+    double periodScale                          ///< [IN] New factor applied to sensor periods
+)
+{
+    int i;
+
+    for (i = 0; i < RegisteredSensorCount; i++)
+    {
+        if (SensorList[i]->budgetPtr == pluginPtr)
+        {
+            ApplyPeriod(SensorList[i]);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when the pressure level of the system changes
+ */
+//--------------------------------------------------------------------------------------------------
+static void PressureLevelHandler
+(
+    pressure_Level_t level                      ///< [IN] New pressure level
+)
+{
+    int i;
+
+    for (i = 0; i < RegisteredSensorCount; i++)
+    {
+        ApplyPeriod(SensorList[i]);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback when an update is received from the Data Hub for the "period"
+ */
+//--------------------------------------------------------------------------------------------------
+static void PeriodUpdateHandler
+(
+    double timestamp,                           ///< timestamp
+    double period,                              ///< new period
+    void* contextPtr                            ///< sensor handler
+)
+{
+    sensorHandler_t* handlerPtr = (sensorHandler_t*)contextPtr;
+
+    // Ignore the period pushed by ApplyPeriod().
+    if ((period <= 0) || (period == handlerPtr->appliedPeriod))
+    {
+        return;
+    }
+
+    handlerPtr->info.period = period;
+    store_SetNumber(handlerPtr->info.path, "period", period);
+
+    // Keep the plugin within its budget, and tell it the new period if it times the sensor.
+    ApplyPeriod(handlerPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback when an update is received from the Data Hub for the "enable"
+ */
+//--------------------------------------------------------------------------------------------------
+static void EnableUpdateHandler
+(
+    double timestamp,                           ///< timestamp
+    bool isEnabled,                             ///< new state
+    void* contextPtr                            ///< sensor handler
+)
+{
+    sensorHandler_t* handlerPtr = (sensorHandler_t*)contextPtr;
+
+    if (isEnabled == handlerPtr->isEnabled)
+    {
+        return;
+    }
+
+    handlerPtr->isEnabled = isEnabled;
+    store_SetBoolean(handlerPtr->info.path, "enable", isEnabled);
+
+    NotifyPeriod(handlerPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Account how late a periodic sample is against the period since the previous one. Anything that
+ * holds the event loop, such as a slow modem call in another sensor's callback, shows up here.
+ * Gaps longer than two periods (sensor disabled, period changed) are not counted.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RecordLateness
+(
+    sensorHandler_t* handlerPtr                  ///< [IN] Handler to the registered sensor
+)
+{
+    sensorStats_t* statsPtr = &handlerPtr->stats;
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+    le_clk_Time_t last = statsPtr->lastTickTime;
+
+    statsPtr->lastTickTime = now;
+
+    if (((last.sec == 0) && (last.usec == 0)) || (handlerPtr->appliedPeriod <= 0))
+    {
+        return;
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(now, last);
+    double lateness = (double)elapsed.sec + ((double)elapsed.usec / 1000000.0) -
+                      handlerPtr->appliedPeriod;
+
+    if (lateness >= handlerPtr->appliedPeriod)
+    {
+        return;
+    }
+
+    uint32_t latenessUs = (lateness > 0) ? (uint32_t)(lateness * 1000000) : 0;
+
+    statsPtr->latenessTimeUs += latenessUs;
+    metrics_RecordLatency(statsPtr->latenessBuckets, latenessUs);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function called by the periodicSensor component when it's time to sample
+ */
+//--------------------------------------------------------------------------------------------------
+static void SampleSensor
+(
+    psensor_Ref_t sensorRef,            ///< [IN] Periodic sensor reference
+    void *contextPtr                    ///< [IN] Sensor context
+)
+{
+    // Use the context and call appropriate callback function
+    sensorHandler_t* handlerPtr = (sensorHandler_t*)contextPtr;
+
+    if (handlerPtr == NULL)
+    {
+        LE_ERROR("Sensor context empty");
+        return;
+    }
+
+    RecordLateness(handlerPtr);
+    PushData(handlerPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Provisions the datahub buffer and its flash backup for the value of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProvisionHistory
+(
+    sensorHandler_t* handlerPtr                  ///< [IN] handler
+)
+{
+    const historyDefault_t* defaultPtr = NULL;
+    char resourcePath[IO_MAX_RESOURCE_PATH_LEN + sizeof(APP_RESOURCE_ROOT) + MAX_RESOURCE_NAME_LEN];
+    int32_t depth = handlerPtr->info.historyDepth;
+    int32_t backupPeriod = handlerPtr->info.backupPeriod;
+    int i;
+
+    if (depth == 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(HistoryDefaults); i++)
+    {
+        if (HistoryDefaults[i].type == handlerPtr->info.type)
+        {
+            defaultPtr = &HistoryDefaults[i];
+        }
+    }
+
+    if (defaultPtr == NULL)
+    {
+        return;
+    }
+
+    if (depth == HISTORY_DEFAULT)
+    {
+        depth = defaultPtr->depth;
+    }
+
+    if (backupPeriod == HISTORY_DEFAULT)
+    {
+        backupPeriod = defaultPtr->backupPeriod;
+    }
+
+    // Periodic sensors publish their samples in the "value" input.
+    snprintf(resourcePath, sizeof(resourcePath), "%s/%s%s",
+             APP_RESOURCE_ROOT,
+             handlerPtr->info.path,
+             handlerPtr->info.isReadOnce ? "" : "/value");
+
+    LE_INFO("History of %s: %d samples, backup every %d s", resourcePath, depth, backupPeriod);
+
+    admin_SetBufferMaxCount(resourcePath, depth);
+    admin_SetBufferBackupPeriod(resourcePath, backupPeriod);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enable or disable a periodic sensor
+ */
+//--------------------------------------------------------------------------------------------------
+static void EnableSensor
+(
+    sensorHandler_t* handlerPtr                  ///< [IN] handler
+)
+{
+    char resourcePath[IO_MAX_RESOURCE_PATH_LEN + MAX_RESOURCE_NAME_LEN];
+
+    snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, "enable");
+    io_PushBoolean(resourcePath, IO_NOW, handlerPtr->isEnabled);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when the first sample of a warm restarted sensor is due. Samples it and enables it, so
+ * that it keeps the phase of the previous run.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PhaseTimerHandler
+(
+    le_timer_Ref_t timerRef                      ///< [IN] Timer
+)
+{
+    sensorHandler_t* handlerPtr = le_timer_GetContextPtr(timerRef);
+
+    le_timer_Delete(timerRef);
+
+    // Disabled while waiting.
+    if (!handlerPtr->isEnabled)
+    {
+        return;
+    }
+
+    PushData(handlerPtr);
+    EnableSensor(handlerPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the delay until the next sample of a sensor after a warm restart
+ *
+ * @return:
+ *      - Delay in seconds, 0 if the sensor must be sampled now
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetResumeDelay
+(
+    sensorHandler_t* handlerPtr                  ///< [IN] handler
+)
+{
+    double delay = handlerPtr->checkpointPtr->lastSampleTime + handlerPtr->appliedPeriod -
+                   GetTimestamp();
+
+    // A sample is overdue, or the clock was changed.
+    if ((delay <= 0) || (delay > handlerPtr->appliedPeriod))
+    {
+        return 0;
+    }
+
+    return delay;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Function called by the periodicSensor component when it's time to sample
+ * Creates the resources of a sensor timed by its plugin: the "value" input, and the "period" and
+ * "enable" outputs, as the periodicSensor component does.
  */
 //--------------------------------------------------------------------------------------------------
-static void SampleSensor
+static void CreateTimedEntry
 (
-    psensor_Ref_t sensorRef,            ///< [IN] Periodic sensor reference
-    void *contextPtr                    ///< [IN] Sensor context
+    sensorHandler_t* handlerPtr                  ///< [IN] handler
 )
 {
-    // Use the context and call appropriate callback function
-    sensorHandler_t* handlerPtr = (sensorHandler_t*)contextPtr;
+    char resourcePath[IO_MAX_RESOURCE_PATH_LEN + MAX_RESOURCE_NAME_LEN];
+    le_result_t result;
 
-    if (handlerPtr == NULL)
-    {
-        LE_ERROR("Sensor context empty");
-        return;
-    }
+    handlerPtr->info.sensorRef = NULL;
 
-    PushData(handlerPtr);
+    snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, "value");
+    result = io_CreateInput(resourcePath, handlerPtr->info.type, handlerPtr->info.unit);
+    LE_ASSERT((result == LE_OK) || (result == LE_DUPLICATE));
+
+    snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, "period");
+    result = io_CreateOutput(resourcePath, IO_DATA_TYPE_NUMERIC, "s");
+    LE_ASSERT((result == LE_OK) || (result == LE_DUPLICATE));
+
+    snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, "enable");
+    result = io_CreateOutput(resourcePath, IO_DATA_TYPE_BOOLEAN, "");
+    LE_ASSERT((result == LE_OK) || (result == LE_DUPLICATE));
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -326,7 +1351,8 @@ static void SampleSensor
 //--------------------------------------------------------------------------------------------------
 static void AddDataHubEntry
 (
-    sensorHandler_t* handlerPtr                  ///< [IN] handler
+    sensorHandler_t* handlerPtr,                 ///< [IN] handler
+    bool isWarm                                  ///< [IN] Was the previous state restored?
 )
 {
     le_result_t result;
@@ -342,35 +1368,108 @@ static void AddDataHubEntry
                                 handlerPtr->info.unit);
 
         LE_ASSERT((result == LE_OK) || (result == LE_DUPLICATE));
+
+        ProvisionHistory(handlerPtr);
+
+        // The value pushed by the previous run is still in datahub.
+        if (isWarm && (result == LE_DUPLICATE))
+        {
+            LE_INFO("%s restored, not sampled again", handlerPtr->info.path);
+            return;
+        }
     }
     else
     {
-        // Create a periodic sensor
-        LE_INFO("Creating a periodic sensor %s", handlerPtr->info.path);
+        if (handlerPtr->callbacks.periodCb != NULL)
+        {
+            // The plugin times the samples: same resources as a periodic sensor, without its timer.
+            LE_INFO("Creating a sensor %s timed by its plugin", handlerPtr->info.path);
+            CreateTimedEntry(handlerPtr);
+        }
+        else
+        {
+            // Create a periodic sensor
+            LE_INFO("Creating a periodic sensor %s", handlerPtr->info.path);
+
+            handlerPtr->info.sensorRef = psensor_Create(handlerPtr->info.path,
+                                                        handlerPtr->info.type,
+                                                        handlerPtr->info.unit,
+                                                        SampleSensor,
+                                                        (void*)handlerPtr);
 
-        handlerPtr->info.sensorRef = psensor_Create(handlerPtr->info.path,
-                                                    handlerPtr->info.type,
-                                                    handlerPtr->info.unit,
-                                                    SampleSensor,
-                                                    (void*)handlerPtr);
+            LE_ASSERT(handlerPtr->info.sensorRef != NULL);
+        }
 
-        LE_ASSERT(handlerPtr->info.sensorRef != NULL);
+        ProvisionHistory(handlerPtr);
 
         char resourcePath[IO_MAX_RESOURCE_PATH_LEN + MAX_RESOURCE_NAME_LEN];
 
-        // enable periodic sensor
-        snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, "enable");
-        io_PushBoolean(resourcePath, IO_NOW, true);
+        // Settings stored by a previous run take precedence over the defaults.
+        store_GetNumber(handlerPtr->info.path, "period", &handlerPtr->info.period);
+
+        handlerPtr->isEnabled = true;
+        store_GetBoolean(handlerPtr->info.path, "enable", &handlerPtr->isEnabled);
+
+        // set the period
+        handlerPtr->appliedPeriod = 0;
+        ApplyPeriod(handlerPtr);
 
-        // set the default period
         snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, "period");
-        io_PushNumeric(resourcePath, IO_NOW, DEFAULT_SAMPLING_PERIOD_SEC);
+        io_AddNumericPushHandler(resourcePath, PeriodUpdateHandler, handlerPtr);
+
+        snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, "enable");
+        io_AddBooleanPushHandler(resourcePath, EnableUpdateHandler, handlerPtr);
+
+        if (!handlerPtr->isEnabled)
+        {
+            LE_INFO("%s is disabled", handlerPtr->info.path);
+            EnableSensor(handlerPtr);
+            return;
+        }
+
+        // After a restart, resume on the schedule of the previous run instead of sampling now.
+        double delay = (isWarm && (handlerPtr->info.sensorRef != NULL)) ?
+                       GetResumeDelay(handlerPtr) : 0;
+
+        if (delay > 0)
+        {
+            le_timer_Ref_t timerRef = le_timer_Create(handlerPtr->info.path);
+
+            LE_INFO("Resume %s in %lf s", handlerPtr->info.path, delay);
+            le_timer_SetMsInterval(timerRef, (uint32_t)(delay * 1000));
+            le_timer_SetContextPtr(timerRef, handlerPtr);
+            le_timer_SetHandler(timerRef, PhaseTimerHandler);
+            le_timer_Start(timerRef);
+            return;
+        }
+
+        // enable periodic sensor
+        EnableSensor(handlerPtr);
     }
 
     // sample once now
     PushData(handlerPtr);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an input carrying the merge patches of a JSON resource of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+static void CreatePatchInput
+(
+    sensorHandler_t* handlerPtr,                 ///< [IN] handler
+    const char* namePtr                          ///< [IN] Name of the input
+)
+{
+    char resourcePath[IO_MAX_RESOURCE_PATH_LEN + MAX_RESOURCE_NAME_LEN];
+    le_result_t result;
+
+    snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, namePtr);
+    result = io_CreateInput(resourcePath, IO_DATA_TYPE_JSON, "");
+    LE_ASSERT((result == LE_OK) || (result == LE_DUPLICATE));
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Parses the json document and fills up the sensor info.
@@ -449,6 +1548,123 @@ static le_result_t ParseSensorInfo
         sensorInfoPtr->isReadOnce = false;
     }
 
+    // Read default sampling period
+    result = json_Extract(extractedData,
+                          sizeof(extractedData),
+                          jsonStringPtr,
+                          "period",
+                          &extractedType);
+
+    // period is optional and default to DEFAULT_SAMPLING_PERIOD_SEC if not available.
+    sensorInfoPtr->period = DEFAULT_SAMPLING_PERIOD_SEC;
+
+    if ((result == LE_OK) && (extractedType == JSON_TYPE_NUMBER))
+    {
+        double period = json_ConvertToNumber(extractedData);
+
+        if (period > 0)
+        {
+            sensorInfoPtr->period = period;
+        }
+    }
+
+    // Read the history depth: a number of samples, or true for the default of the data type.
+    result = json_Extract(extractedData,
+                          sizeof(extractedData),
+                          jsonStringPtr,
+                          "history",
+                          &extractedType);
+
+    // history is optional and disabled if not available.
+    sensorInfoPtr->historyDepth = 0;
+
+    if ((result == LE_OK) && (extractedType == JSON_TYPE_NUMBER))
+    {
+        double depth = json_ConvertToNumber(extractedData);
+
+        if ((depth >= 0) && (depth <= INT32_MAX))
+        {
+            sensorInfoPtr->historyDepth = (int32_t)depth;
+        }
+    }
+    else if ((result == LE_OK) && (extractedType == JSON_TYPE_BOOLEAN) &&
+             json_ConvertToBoolean(extractedData))
+    {
+        sensorInfoPtr->historyDepth = HISTORY_DEFAULT;
+    }
+
+    // Read the flash backup period of the history
+    result = json_Extract(extractedData,
+                          sizeof(extractedData),
+                          jsonStringPtr,
+                          "backupPeriod",
+                          &extractedType);
+
+    // backupPeriod is optional and defaults to the default of the data type.
+    sensorInfoPtr->backupPeriod = HISTORY_DEFAULT;
+
+    if ((result == LE_OK) && (extractedType == JSON_TYPE_NUMBER))
+    {
+        double backupPeriod = json_ConvertToNumber(extractedData);
+
+        if ((backupPeriod >= 0) && (backupPeriod <= INT32_MAX))
+        {
+            sensorInfoPtr->backupPeriod = (int32_t)backupPeriod;
+        }
+    }
+
+    // Read the keyframe interval of the JSON resources published as merge patches
+    result = json_Extract(extractedData,
+                          sizeof(extractedData),
+                          jsonStringPtr,
+                          "delta",
+                          &extractedType);
+
+    // delta is optional and disabled if not available.
+    sensorInfoPtr->deltaKeyframes = 0;
+
+    if ((result == LE_OK) && (extractedType == JSON_TYPE_NUMBER))
+    {
+        double keyframes = json_ConvertToNumber(extractedData);
+
+        if ((keyframes >= 1) && (keyframes <= UINT32_MAX))
+        {
+            sensorInfoPtr->deltaKeyframes = (uint32_t)keyframes;
+        }
+    }
+    else if ((result == LE_OK) && (extractedType == JSON_TYPE_BOOLEAN) &&
+             json_ConvertToBoolean(extractedData))
+    {
+        sensorInfoPtr->deltaKeyframes = SENSOR_DELTA_KEYFRAME_INTERVAL;
+    }
+
+    // Read the priority of the sensor when the system is under pressure, "normal" by default.
+    sensorInfoPtr->priority = PRESSURE_PRIORITY_NORMAL;
+
+    if ((json_Extract(extractedData,
+                      sizeof(extractedData),
+                      jsonStringPtr,
+                      "priority",
+                      &extractedType) == LE_OK) &&
+        (extractedType == JSON_TYPE_STRING) &&
+        (pressure_ParsePriority(extractedData, &sensorInfoPtr->priority) != LE_OK))
+    {
+        LE_WARN("Invalid priority %s", extractedData);
+    }
+
+    // Read the name of the plugin, optional and only used for statistics.
+    sensorInfoPtr->plugin[0] = '\0';
+
+    if ((json_Extract(extractedData,
+                      sizeof(extractedData),
+                      jsonStringPtr,
+                      "plugin",
+                      &extractedType) == LE_OK) &&
+        (extractedType == JSON_TYPE_STRING))
+    {
+        le_utf8_Copy(sensorInfoPtr->plugin, extractedData, sizeof(sensorInfoPtr->plugin), NULL);
+    }
+
     // Read sensor unit of measurement
     result = json_Extract(extractedData,
                           sizeof(extractedData),
@@ -472,22 +1688,26 @@ static le_result_t ParseSensorInfo
     LE_DEBUG("path = %s", sensorInfoPtr->path);
     LE_DEBUG("unit = %s", sensorInfoPtr->unit);
     LE_DEBUG("isReadOnce = %d", sensorInfoPtr->isReadOnce);
+    LE_DEBUG("period = %lf", sensorInfoPtr->period);
+    LE_DEBUG("history = %d, backup = %d", sensorInfoPtr->historyDepth, sensorInfoPtr->backupPeriod);
 
     return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Sample a sensor and push the data
+ * Sample a sensor and push the data. May be called from any thread.
  *
  * @return:
  *      - LE_OK on success
+ *      - LE_UNAVAILABLE if the plugin had no new sample
+ *      - LE_OVERFLOW or LE_NO_MEMORY if the sample could not be staged
  *      - LE_FAULT on any other error
  */
 //--------------------------------------------------------------------------------------------------
 LE_SHARED le_result_t sensorFw_PushSample
 (
-    void* handlerPtr                          ///< [OUT] Sensor handler
+    void* handlerPtr                          ///< [IN] Sensor handler
 )
 {
     if (handlerPtr == NULL)
@@ -499,12 +1719,67 @@ LE_SHARED le_result_t sensorFw_PushSample
     return PushData((sensorHandler_t*)handlerPtr);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a numeric value of a sensor. May be called from any thread.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_BAD_PARAMETER if the sensor is not numeric
+ *      - LE_OVERFLOW or LE_NO_MEMORY if the sample could not be staged
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t sensorFw_PushNumeric
+(
+    void* handlerPtr,                         ///< [IN] Sensor handler
+    double timestamp,                         ///< [IN] Time of the sample (0 = now)
+    double value                              ///< [IN] Value
+)
+{
+    pushQueue_Sample_t sample;
+
+    sample.handlerPtr = handlerPtr;
+    sample.timestamp = timestamp;
+    sample.type = IO_DATA_TYPE_NUMERIC;
+    sample.value.numeric = value;
+
+    return PushValue(&sample);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a boolean value of a sensor. May be called from any thread.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_BAD_PARAMETER if the sensor is not boolean
+ *      - LE_OVERFLOW or LE_NO_MEMORY if the sample could not be staged
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t sensorFw_PushBoolean
+(
+    void* handlerPtr,                         ///< [IN] Sensor handler
+    double timestamp,                         ///< [IN] Time of the sample (0 = now)
+    bool value                                ///< [IN] Value
+)
+{
+    pushQueue_Sample_t sample;
+
+    sample.handlerPtr = handlerPtr;
+    sample.timestamp = timestamp;
+    sample.type = IO_DATA_TYPE_BOOLEAN;
+    sample.value.boolean = value;
+
+    return PushValue(&sample);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Register a callback function to the sensor framework
  *
  * @return:
  *      - LE_OK on success
+ *      - LE_NO_MEMORY if SENSOR_HANDLER_POOL_SIZE sensors are already registered
  *      - LE_FAULT on any other error
  */
 //--------------------------------------------------------------------------------------------------
@@ -514,12 +1789,19 @@ LE_SHARED le_result_t sensorFw_RegisterCallback
     sensorfwDataType_t type,                  ///< [IN] Data type returned by the callback
     sensorfwCallbacks_t* cbPtr,               ///< [IN] Callbacks to operate the sensor described in info
     void* contextPtr,                         ///< [IN] Context passed by plugin
-    void* returnHandler                       ///< [OUT] Sensor handler (not used)
+    void** handlerPtrPtr                      ///< [OUT] Sensor handler (optional)
 )
 {
     le_result_t result;
     LE_INFO("Register a sensor");
 
+    // The sensor list and the path map are sized for the handler pool, which must not grow.
+    if (RegisteredSensorCount == SENSOR_HANDLER_POOL_SIZE)
+    {
+        LE_ERROR("Too many sensors, at most %d", SENSOR_HANDLER_POOL_SIZE);
+        return LE_NO_MEMORY;
+    }
+
     sensorHandler_t* handlerPtr = le_mem_ForceAlloc(SensorHandlerPool);
 
     // Save sensor information provided by the plugin
@@ -533,9 +1815,25 @@ LE_SHARED le_result_t sensorFw_RegisterCallback
     // Register callback funtions
     handlerPtr->info.sensorId = RegisteredSensorCount;
     handlerPtr->callbacks.configCb = cbPtr->configCb;
+    handlerPtr->callbacks.periodCb = cbPtr->periodCb;
 
     // Save plugin context
     handlerPtr->pluginContextPtr = contextPtr;
+    handlerPtr->calibrationPtr = NULL;
+    handlerPtr->hasLastNumeric = false;
+    handlerPtr->isEnabled = true;
+    memset(&handlerPtr->stats, 0, sizeof(handlerPtr->stats));
+    handlerPtr->stats.registrationTime = le_clk_GetRelativeTime();
+
+    // Resources used by the sensor are accounted to its plugin.
+    handlerPtr->budgetPtr = budget_GetPlugin(handlerPtr->info.plugin);
+    budget_AddMemory(handlerPtr->budgetPtr, sizeof(sensorHandler_t));
+
+    handlerPtr->inferencePtr = inference_GetInput(handlerPtr->info.path);
+    handlerPtr->rollupPtr = NULL;
+    handlerPtr->isTemperatureSource = false;
+    handlerPtr->valueDeltaPtr = NULL;
+    handlerPtr->configDeltaPtr = NULL;
 
     // Add an entry to data hub.
     switch (type)
@@ -543,6 +1841,8 @@ LE_SHARED le_result_t sensorFw_RegisterCallback
         case SF_CB_NUMERIC:
             handlerPtr->info.type = IO_DATA_TYPE_NUMERIC;
             handlerPtr->callbacks.sample.numericCb = cbPtr->sample.numericCb;
+            handlerPtr->rollupPtr = rollup_GetSeries(handlerPtr->info.path);
+            handlerPtr->isTemperatureSource = pressure_IsTemperatureSensor(handlerPtr->info.path);
             break;
 
         case SF_CB_BOOLEAN:
@@ -562,15 +1862,66 @@ LE_SHARED le_result_t sensorFw_RegisterCallback
 
         default:
             LE_ERROR("Invalid data type for callback");
+            budget_AddMemory(handlerPtr->budgetPtr, -(ssize_t)sizeof(sensorHandler_t));
+            le_mem_Release(handlerPtr);
             return LE_FAULT;
     }
 
+    le_hashmap_Put(SensorPathMap, handlerPtr->info.path, handlerPtr);
+    handlerPtr->snapshotPtr = snapshot_AddSensor(handlerPtr->info.path);
+
+    // Restore the state of the previous run, if sensord was restarted.
+    bool isWarm;
+
+    handlerPtr->checkpointPtr = checkpoint_Attach(handlerPtr->info.path,
+                                                  handlerPtr->info.type,
+                                                  &isWarm);
+
+    if (isWarm && handlerPtr->checkpointPtr->hasValue &&
+        (handlerPtr->info.type == IO_DATA_TYPE_NUMERIC))
+    {
+        handlerPtr->lastNumeric = handlerPtr->checkpointPtr->value;
+        handlerPtr->hasLastNumeric = true;
+    }
+
+    // Restore the calibration and the plugin configuration before the first sample.
+    char settingString[MAX_RES_STRING_LEN];
+    size_t settingLength;
+
+    if (((handlerPtr->info.type == IO_DATA_TYPE_NUMERIC) ||
+         (handlerPtr->info.type == IO_DATA_TYPE_JSON)) &&
+        (store_GetString(handlerPtr->info.path,
+                         "calibration",
+                         settingString,
+                         sizeof(settingString)) == LE_OK))
+    {
+        SetCalibration(handlerPtr, settingString, false);
+    }
+
+    if ((handlerPtr->callbacks.configCb != NULL) &&
+        (store_GetString(handlerPtr->info.path,
+                         "config",
+                         settingString,
+                         sizeof(settingString)) == LE_OK))
+    {
+        LE_INFO("Restore config of %s: %s", handlerPtr->info.path, settingString);
+        settingLength = sizeof(settingString);
+        handlerPtr->callbacks.configCb(settingString, &settingLength, contextPtr);
+    }
+
+    if (handlerPtrPtr != NULL)
+    {
+        *handlerPtrPtr = handlerPtr;
+    }
+
     // Create a resource in datahub.
-    AddDataHubEntry(handlerPtr);
+    SensorList[RegisteredSensorCount] = handlerPtr;
+    AddDataHubEntry(handlerPtr, isWarm);
     RegisteredSensorCount++;
 
-    // Create a standard json config field for this sensor.
-    if ((!handlerPtr->info.isReadOnce) && (cbPtr->configCb != NULL))
+    // Create a standard json config field for this sensor. It carries the settings handled by
+    // the framework (e.g. calibration) as well as the plugin configuration.
+    if (!handlerPtr->info.isReadOnce)
     {
         char resourcePath[IO_MAX_RESOURCE_PATH_LEN + MAX_RESOURCE_NAME_LEN];
         snprintf(resourcePath, sizeof(resourcePath), "%s/%s", handlerPtr->info.path, "config");
@@ -583,8 +1934,22 @@ LE_SHARED le_result_t sensorFw_RegisterCallback
 
         LE_ASSERT((result == LE_OK) || (result == LE_DUPLICATE));
 
+        // Merge patches of the configuration, and of the samples of a JSON sensor.
+        if (handlerPtr->info.deltaKeyframes > 0)
+        {
+            CreatePatchInput(handlerPtr, "configPatch");
+
+            if (handlerPtr->info.type == IO_DATA_TYPE_JSON)
+            {
+                CreatePatchInput(handlerPtr, "valuePatch");
+            }
+        }
+
         // Read Initial configuration and push to datahub
-        PushConfig(handlerPtr);
+        if (cbPtr->configCb != NULL)
+        {
+            PushConfig(handlerPtr);
+        }
 
         // Register for notification when datahub updates the config
         io_AddJsonPushHandler(resourcePath, ConfigUpdateHandler, handlerPtr);
@@ -593,6 +1958,196 @@ LE_SHARED le_result_t sensorFw_RegisterCallback
     return LE_OK;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of registered sensors
+ *
+ * @return Number of sensors. Sensors are indexed from 0 to this number - 1.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t sensorStats_GetCount
+(
+    void
+)
+{
+    return RegisteredSensorCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the description of a registered sensor
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_OUT_OF_RANGE if there is no sensor at this index.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t sensorStats_GetInfo
+(
+    uint32_t index,                             ///< [IN]  Index of the sensor
+    char* pathPtr,                              ///< [OUT] Path of the sensor
+    size_t pathSize,                            ///< [IN]  Buffer size
+    char* pluginPtr,                            ///< [OUT] Name of the plugin
+    size_t pluginSize,                          ///< [IN]  Buffer size
+    double* periodPtr,                          ///< [OUT] Sampling period in seconds
+    bool* enabledPtr                            ///< [OUT] Is the sensor sampled?
+)
+{
+    if (index >= RegisteredSensorCount)
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    const sensorHandler_t* handlerPtr = SensorList[index];
+
+    le_utf8_Copy(pathPtr, handlerPtr->info.path, pathSize, NULL);
+    le_utf8_Copy(pluginPtr, handlerPtr->info.plugin, pluginSize, NULL);
+    *periodPtr = handlerPtr->info.isReadOnce ? 0 : handlerPtr->info.period;
+    *enabledPtr = handlerPtr->info.isReadOnce ? false : handlerPtr->isEnabled;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the statistics of a registered sensor
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_OUT_OF_RANGE if there is no sensor at this index.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t sensorStats_GetStats
+(
+    uint32_t index,                             ///< [IN]  Index of the sensor
+    double* agePtr,                             ///< [OUT] Seconds since registration
+    uint32_t* sampleCountPtr,                   ///< [OUT] Number of samples pushed
+    uint32_t* failureCountPtr,                  ///< [OUT] Number of failed callbacks
+    uint64_t* callbackTimeUsPtr,                ///< [OUT] Total time in the sample callback
+    uint32_t* callbackMaxUsPtr,                 ///< [OUT] Longest sample callback
+    uint64_t* pushTimeUsPtr,                    ///< [OUT] Total time pushing to datahub
+    uint32_t* pushMaxUsPtr,                     ///< [OUT] Longest push
+    uint64_t* bytesPushedPtr                    ///< [OUT] Bytes of sample data pushed
+)
+{
+    if (index >= RegisteredSensorCount)
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    const sensorStats_t* statsPtr = &SensorList[index]->stats;
+    le_clk_Time_t age = le_clk_Sub(le_clk_GetRelativeTime(), statsPtr->registrationTime);
+
+    *agePtr = (double)age.sec + ((double)age.usec / 1000000.0);
+    *sampleCountPtr = statsPtr->sampleCount;
+    *failureCountPtr = __atomic_load_n(&statsPtr->failureCount, __ATOMIC_RELAXED);
+    *callbackTimeUsPtr = __atomic_load_n(&statsPtr->callbackTimeUs, __ATOMIC_RELAXED);
+    *callbackMaxUsPtr = __atomic_load_n(&statsPtr->callbackMaxUs, __ATOMIC_RELAXED);
+    *pushTimeUsPtr = statsPtr->pushTimeUs;
+    *pushMaxUsPtr = statsPtr->pushMaxUs;
+    *bytesPushedPtr = statsPtr->bytesPushed;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Provide the metrics of the sensor at an index to the metrics endpoint
+ *
+ * @return:
+ *      - true if the sensor exists
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetMetricsSensor
+(
+    uint32_t index,                             ///< [IN]  Index of the sensor
+    metrics_Sensor_t* sensorPtr                 ///< [OUT] Metrics
+)
+{
+    if (index >= RegisteredSensorCount)
+    {
+        return false;
+    }
+
+    const sensorHandler_t* handlerPtr = SensorList[index];
+    const sensorStats_t* statsPtr = &handlerPtr->stats;
+
+    sensorPtr->pathPtr = handlerPtr->info.path;
+    sensorPtr->pluginPtr = handlerPtr->info.plugin;
+    sensorPtr->readCount = __atomic_load_n(&statsPtr->readCount, __ATOMIC_RELAXED);
+    sensorPtr->pushCount = statsPtr->sampleCount;
+    sensorPtr->failureCount = __atomic_load_n(&statsPtr->failureCount, __ATOMIC_RELAXED);
+    sensorPtr->callbackTimeUs = __atomic_load_n(&statsPtr->callbackTimeUs, __ATOMIC_RELAXED);
+    sensorPtr->pushTimeUs = statsPtr->pushTimeUs;
+    sensorPtr->bytesPushed = statsPtr->bytesPushed;
+    sensorPtr->latencyBucketsPtr = statsPtr->latencyBuckets;
+    sensorPtr->latenessTimeUs = statsPtr->latenessTimeUs;
+    sensorPtr->latenessBucketsPtr = statsPtr->latenessBuckets;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the usage of a memory pool to the framework-wide metrics
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddPoolMetrics
+(
+    metrics_Global_t* globalPtr,                ///< [INOUT] Metrics
+    const char* namePtr,                        ///< [IN]    Name of the pool
+    le_mem_PoolRef_t pool                       ///< [IN]    Pool
+)
+{
+    le_mem_PoolStats_t poolStats;
+
+    if (globalPtr->poolCount >= METRICS_MAX_POOLS)
+    {
+        return;
+    }
+
+    le_mem_GetStats(pool, &poolStats);
+
+    metrics_Pool_t* poolPtr = &globalPtr->pools[globalPtr->poolCount++];
+    poolPtr->namePtr = namePtr;
+    poolPtr->used = poolStats.numBlocksInUse;
+    poolPtr->size = le_mem_GetObjectCount(pool);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Provide the framework-wide metrics to the metrics endpoint
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetMetricsGlobal
+(
+    metrics_Global_t* globalPtr                 ///< [OUT] Metrics
+)
+{
+    globalPtr->registeredCount = RegisteredSensorCount;
+    globalPtr->queueDepth = pushQueue_GetDepth();
+    globalPtr->droppedCount = pushQueue_GetDroppedCount();
+    globalPtr->poolCount = 0;
+
+    heap_Stats_t heapStats;
+
+    heap_GetStats(&heapStats);
+    globalPtr->rssBytes = heapStats.rssBytes;
+    globalPtr->heapUsedBytes = heapStats.heapUsedBytes;
+    globalPtr->heapFreeBytes = heapStats.heapFreeBytes;
+    globalPtr->heapFragmentation = heapStats.fragmentation;
+    globalPtr->heapGrowthPerHour = heapStats.growthPerHour;
+
+    pressure_Level_t pressureLevel;
+
+    pressure_GetState(&pressureLevel, &globalPtr->pressureTransitionCount);
+    globalPtr->pressureLevel = pressureLevel;
+
+    AddPoolMetrics(globalPtr, "sensorHandler", SensorHandlerPool);
+    AddPoolMetrics(globalPtr, "calibration", CalibrationPool);
+    AddPoolMetrics(globalPtr, "delta", DeltaPool);
+}
+
 COMPONENT_INIT
 {
     LE_INFO("Start sensor FW App");
@@ -600,4 +2155,35 @@ COMPONENT_INIT
     SensorHandlerPool = le_mem_InitStaticPool(SensorHandlerPool,
                                               SENSOR_HANDLER_POOL_SIZE,
                                               sizeof(sensorHandler_t));
+
+    CalibrationPool = le_mem_InitStaticPool(CalibrationPool,
+                                            SENSOR_CALIBRATION_POOL_SIZE,
+                                            sizeof(calibration_t));
+
+    DeltaPool = le_mem_InitStaticPool(DeltaPool,
+                                      SENSOR_DELTA_POOL_SIZE,
+                                      sizeof(delta_t));
+
+    checkpoint_Init();
+
+    // Samples pushed from plugin threads are published by this thread.
+    pushQueue_Init(PublishSample);
+
+    SensorPathMap = le_hashmap_InitStatic(SensorPathMap,
+                                          SENSOR_HANDLER_POOL_SIZE,
+                                          le_hashmap_HashString,
+                                          le_hashmap_EqualsString);
+
+    heap_Init();
+    budget_Init(PeriodScaleHandler);
+    pressure_Init(PressureLevelHandler);
+    inference_Init();
+    rollup_Init();
+    snapshot_Init();
+    trace_Init();
+    metrics_Init(GetMetricsSensor,
+                 GetMetricsGlobal,
+                 budget_GetMetrics,
+                 inference_GetMetrics,
+                 trace_GetMetrics);
 }
@@ -28,6 +28,9 @@ sensorfwDataType_t;
 //--------------------------------------------------------------------------------------------------
 /**
  * Types of callback functions provided by the plugin
+ *
+ * A sample callback returns LE_OK when the value was read, LE_UNAVAILABLE when there is nothing new
+ * to report (no sample is pushed) or LE_FAULT on error.
  */
 //--------------------------------------------------------------------------------------------------
 typedef le_result_t (*pfBool)   (bool* readBoolValue, size_t* lengthPtr, void* contextPtr);
@@ -35,6 +38,16 @@ typedef le_result_t (*pfNumeric)(double* readNumericValue, size_t* lengthPtr, vo
 typedef le_result_t (*pfString) (char* readStringValue, size_t* lengthPtr, void* contextPtr);
 typedef le_result_t (*pfJSON)   (char* readJsonValue, size_t* lengthPtr, void* contextPtr);
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback of a plugin that times the samples of a sensor itself, e.g. from a hardware trigger,
+ * instead of being polled by the framework. It is called on the main thread with the sampling
+ * period in seconds whenever it changes, and with 0 when the sensor is disabled. The plugin pushes
+ * the samples with sensorFw_Push*() and its sample callback is only used for the first sample.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*pfPeriod)(double period, void* contextPtr);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Callbacks to operate the sensor
@@ -51,6 +64,7 @@ typedef struct
         pfString    stringCb;  // Read or write a string value
         pfJSON      jsonCb;    // Read or write a JSON structure
     }sample;
+    pfPeriod    periodCb;  // Sampling period (optional), the plugin times the samples itself
 }
 sensorfwCallbacks_t;
 
@@ -60,6 +74,7 @@ sensorfwCallbacks_t;
  *
  * @return:
  *      - LE_OK on success
+ *      - LE_NO_MEMORY if SENSOR_HANDLER_POOL_SIZE sensors are already registered
  *      - LE_FAULT on any other error
  */
 //--------------------------------------------------------------------------------------------------
@@ -69,21 +84,64 @@ LE_SHARED le_result_t sensorFw_RegisterCallback
     sensorfwDataType_t type,                  ///< [IN] Data type returned by the callback
     sensorfwCallbacks_t* callbackPtr,         ///< [IN] Callbacks to operate the sensor described in info
     void* contextPtr,                         ///< [IN] Context passed by plugin
-    void* handlerPtr                          ///< [OUT] Sensor handler
+    void** handlerPtrPtr                      ///< [OUT] Sensor handler (optional)
 );
 
 //--------------------------------------------------------------------------------------------------
 /**
  * Sample a sensor and push the data
  *
+ * May be called from any thread. The sample callback runs on the calling thread; when that is not
+ * the sensor framework thread the sample is staged without blocking and pushed to the Data Hub by
+ * the sensor framework thread.
+ *
  * @return:
  *      - LE_OK on success
+ *      - LE_UNAVAILABLE if the plugin had no new sample
+ *      - LE_OVERFLOW if the staging buffer of the calling thread is full, the sample is dropped
+ *      - LE_NO_MEMORY if no staging buffer is available to the calling thread
  *      - LE_FAULT on any other error
  */
 //--------------------------------------------------------------------------------------------------
 LE_SHARED le_result_t sensorFw_PushSample
 (
-    void* handlerPtr                          ///< [OUT] Sensor handler
+    void* handlerPtr                          ///< [IN] Sensor handler
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a numeric value of a sensor, e.g. from a capture thread. May be called from any thread.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_BAD_PARAMETER if the sensor is not numeric
+ *      - LE_OVERFLOW if the staging buffer of the calling thread is full, the sample is dropped
+ *      - LE_NO_MEMORY if no staging buffer is available to the calling thread
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t sensorFw_PushNumeric
+(
+    void* handlerPtr,                         ///< [IN] Sensor handler
+    double timestamp,                         ///< [IN] Time of the sample in seconds (0 = now)
+    double value                              ///< [IN] Value
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a boolean value of a sensor, e.g. from a capture thread. May be called from any thread.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_BAD_PARAMETER if the sensor is not boolean
+ *      - LE_OVERFLOW if the staging buffer of the calling thread is full, the sample is dropped
+ *      - LE_NO_MEMORY if no staging buffer is available to the calling thread
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t sensorFw_PushBoolean
+(
+    void* handlerPtr,                         ///< [IN] Sensor handler
+    double timestamp,                         ///< [IN] Time of the sample in seconds (0 = now)
+    bool value                                ///< [IN] Value
 );
 
 #endif /* LEGATO_SENSOR_FW_COMP_INCLUDE_GUARD */
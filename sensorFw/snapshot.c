@@ -0,0 +1,443 @@
+//--------------------------------------------------------------------------------------------------
+/** @file snapshot.c
+ *
+ * Snapshot of the last sample of every registered sensor.
+ *
+ * Each sensor keeps its member of the document ("path":[timestamp,value]) already serialized, so
+ * that publishing the snapshot only copies the members into the document. String and JSON samples
+ * are serialized as they are recorded since they are copied anyway; numeric and boolean samples
+ * are only recorded, and serialized on the next publish if they are still the last sample, so that
+ * a fast sensor costs one serialization per publish rather than one per sample. Samples are all
+ * published by the main thread, so a document is a consistent cut of the state of the device.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <math.h>
+#include "interfaces.h"
+#include "snapshot.h"
+#include "config.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Node of the configuration tree under which the snapshot is configured
+ */
+//--------------------------------------------------------------------------------------------------
+#define     SNAPSHOT_ROOT_NODE              "snapshot"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resources of the snapshot
+ */
+//--------------------------------------------------------------------------------------------------
+#define     SNAPSHOT_VALUE_PATH             "snapshot/value"
+#define     SNAPSHOT_TRIGGER_PATH           "snapshot/trigger"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of a serialized number or timestamp
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_NUMBER_LEN                  32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Entry of a sensor in the snapshot
+ */
+//--------------------------------------------------------------------------------------------------
+struct snapshot_Entry
+{
+    const char* pathPtr;                        ///< Path of the sensor
+    double timestamp;                           ///< Timestamp of the numeric sample
+    double numeric;                             ///< Numeric sample not serialized yet
+    bool isBoolean;                             ///< Is the numeric sample a boolean?
+    bool isDirty;                               ///< Is the numeric sample not serialized yet?
+    size_t memberLen;                           ///< Bytes of the member, 0 if left out
+    char member[SENSOR_SNAPSHOT_MEMBER_LEN];    ///< Serialized member of the document
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Entries, in the order the sensors were registered
+ */
+//--------------------------------------------------------------------------------------------------
+static snapshot_Entry_t Entries[SENSOR_HANDLER_POOL_SIZE];
+static uint32_t EntryCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Is the snapshot maintained?
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsEnabled;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Has a sample been recorded since the last publish?
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsChanged;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Has the document been too long to hold all the sensors? Only reported once.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsTruncated;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Document being published
+ */
+//--------------------------------------------------------------------------------------------------
+static char Document[SENSOR_SNAPSHOT_MAX_LEN];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time as a datahub timestamp
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetTimestamp
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetAbsoluteTime();
+
+    return (double)now.sec + ((double)now.usec / 1000000.0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Quote a string as a JSON string
+ *
+ * @return:
+ *      - LE_OK if successful
+ *      - LE_OVERFLOW if the quoted string does not fit
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t QuoteString
+(
+    const char* stringPtr,                      ///< [IN]  String
+    char* bufferPtr,                            ///< [OUT] Quoted string
+    size_t bufferSize                           ///< [IN]  Size of the buffer
+)
+{
+    size_t pos = 0;
+
+    bufferPtr[pos++] = '"';
+
+    for (; *stringPtr != '\0'; stringPtr++)
+    {
+        unsigned char c = *stringPtr;
+
+        // Leave room for the longest escape, the closing quote and the terminator.
+        if (pos + 8 >= bufferSize)
+        {
+            return LE_OVERFLOW;
+        }
+
+        if ((c == '"') || (c == '\\'))
+        {
+            bufferPtr[pos++] = '\\';
+            bufferPtr[pos++] = c;
+        }
+        else if (c < 0x20)
+        {
+            pos += snprintf(&bufferPtr[pos], bufferSize - pos, "\\u%04x", c);
+        }
+        else
+        {
+            bufferPtr[pos++] = c;
+        }
+    }
+
+    bufferPtr[pos++] = '"';
+    bufferPtr[pos] = '\0';
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Serialize the member of an entry from its serialized value
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetMember
+(
+    snapshot_Entry_t* entryPtr,                 ///< [IN] Entry
+    double timestamp,                           ///< [IN] Timestamp of the sample
+    const char* valuePtr                        ///< [IN] Serialized value
+)
+{
+    char key[sizeof(entryPtr->member)];
+    int len;
+
+    // Sensor paths are not restricted to characters that need no escaping.
+    if (QuoteString(entryPtr->pathPtr, key, sizeof(key)) != LE_OK)
+    {
+        entryPtr->memberLen = 0;
+        return;
+    }
+
+    len = snprintf(entryPtr->member, sizeof(entryPtr->member), "%s:[%.3f,%s]",
+                   key, timestamp, valuePtr);
+
+    entryPtr->memberLen = ((len > 0) && (len < (int)sizeof(entryPtr->member))) ? len : 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Serialize the member of an entry whose last sample is numeric or boolean
+ */
+//--------------------------------------------------------------------------------------------------
+static void SerializeNumeric
+(
+    snapshot_Entry_t* entryPtr                  ///< [IN] Entry
+)
+{
+    char value[MAX_NUMBER_LEN];
+
+    if (entryPtr->isBoolean)
+    {
+        le_utf8_Copy(value, (entryPtr->numeric != 0) ? "true" : "false", sizeof(value), NULL);
+    }
+    else if (isfinite(entryPtr->numeric))
+    {
+        snprintf(value, sizeof(value), "%.10g", entryPtr->numeric);
+    }
+    else
+    {
+        le_utf8_Copy(value, "null", sizeof(value), NULL);
+    }
+
+    SetMember(entryPtr, entryPtr->timestamp, value);
+    entryPtr->isDirty = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Publish the snapshot
+ */
+//--------------------------------------------------------------------------------------------------
+static void Publish
+(
+    void
+)
+{
+    double now = GetTimestamp();
+    size_t pos = snprintf(Document, sizeof(Document), "{\"time\":%.3f,\"sensors\":{", now);
+    uint32_t leftOut = 0;
+    bool isFirst = true;
+    uint32_t i;
+
+    for (i = 0; i < EntryCount; i++)
+    {
+        snapshot_Entry_t* entryPtr = &Entries[i];
+
+        if (entryPtr->isDirty)
+        {
+            SerializeNumeric(entryPtr);
+        }
+
+        if (entryPtr->memberLen == 0)
+        {
+            continue;
+        }
+
+        // Leave room for the separator and the closing braces.
+        if (pos + entryPtr->memberLen + 4 > sizeof(Document))
+        {
+            leftOut++;
+            continue;
+        }
+
+        if (!isFirst)
+        {
+            Document[pos++] = ',';
+        }
+
+        memcpy(&Document[pos], entryPtr->member, entryPtr->memberLen);
+        pos += entryPtr->memberLen;
+        isFirst = false;
+    }
+
+    memcpy(&Document[pos], "}}", 3);
+
+    if ((leftOut > 0) && !IsTruncated)
+    {
+        LE_WARN("Snapshot too long, %" PRIu32 " sensors left out", leftOut);
+        IsTruncated = true;
+    }
+
+    io_PushJson(SNAPSHOT_VALUE_PATH, now, Document);
+    IsChanged = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Publish the snapshot on request
+ */
+//--------------------------------------------------------------------------------------------------
+static void TriggerHandler
+(
+    double timestamp,                           ///< [IN] Timestamp of the trigger
+    void* contextPtr                            ///< [IN] Not used
+)
+{
+    Publish();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Publish the snapshot periodically, if it changed
+ */
+//--------------------------------------------------------------------------------------------------
+static void PublishTimerHandler
+(
+    le_timer_Ref_t timerRef                     ///< [IN] Publish timer
+)
+{
+    if (IsChanged)
+    {
+        Publish();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the configuration, create the snapshot resources and start the publish timer
+ */
+//--------------------------------------------------------------------------------------------------
+void snapshot_Init
+(
+    void
+)
+{
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(SNAPSHOT_ROOT_NODE);
+    double period;
+    le_result_t result;
+
+    IsEnabled = le_cfg_GetBool(iteratorRef, "enable", false);
+    period = le_cfg_GetFloat(iteratorRef, "period", 0);
+
+    le_cfg_CancelTxn(iteratorRef);
+
+    if (!IsEnabled)
+    {
+        return;
+    }
+
+    result = io_CreateInput(SNAPSHOT_VALUE_PATH, IO_DATA_TYPE_JSON, "");
+    LE_ASSERT((result == LE_OK) || (result == LE_DUPLICATE));
+
+    result = io_CreateOutput(SNAPSHOT_TRIGGER_PATH, IO_DATA_TYPE_TRIGGER, "");
+    LE_ASSERT((result == LE_OK) || (result == LE_DUPLICATE));
+
+    io_AddTriggerPushHandler(SNAPSHOT_TRIGGER_PATH, TriggerHandler, NULL);
+
+    if (period > 0)
+    {
+        le_timer_Ref_t timerRef = le_timer_Create("snapshotPublish");
+
+        le_timer_SetMsInterval(timerRef, period * 1000);
+        le_timer_SetRepeat(timerRef, 0);
+        le_timer_SetHandler(timerRef, PublishTimerHandler);
+        le_timer_Start(timerRef);
+    }
+
+    LE_INFO("Snapshot published to %s, period %g s", SNAPSHOT_VALUE_PATH, period);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a sensor to the snapshot
+ *
+ * @return:
+ *      - Entry, NULL if the snapshot is disabled or full
+ */
+//--------------------------------------------------------------------------------------------------
+snapshot_Entry_t* snapshot_AddSensor
+(
+    const char* pathPtr                         ///< [IN] Path of the sensor, kept by reference
+)
+{
+    snapshot_Entry_t* entryPtr;
+
+    if (!IsEnabled || (EntryCount >= SENSOR_HANDLER_POOL_SIZE))
+    {
+        return NULL;
+    }
+
+    entryPtr = &Entries[EntryCount++];
+    entryPtr->pathPtr = pathPtr;
+    entryPtr->isDirty = false;
+    entryPtr->memberLen = 0;
+
+    return entryPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a numeric or boolean sample. It is only serialized on the next publish. Runs on the main
+ * thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void snapshot_UpdateNumeric
+(
+    snapshot_Entry_t* entryPtr,                 ///< [IN] Entry (or NULL)
+    double timestamp,                           ///< [IN] Timestamp of the sample
+    double value,                               ///< [IN] Value
+    bool isBoolean                              ///< [IN] Is the value a boolean?
+)
+{
+    if (entryPtr == NULL)
+    {
+        return;
+    }
+
+    entryPtr->timestamp = timestamp;
+    entryPtr->numeric = value;
+    entryPtr->isBoolean = isBoolean;
+    entryPtr->isDirty = true;
+    IsChanged = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a string or JSON sample. Runs on the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void snapshot_UpdateString
+(
+    snapshot_Entry_t* entryPtr,                 ///< [IN] Entry (or NULL)
+    double timestamp,                           ///< [IN] Timestamp of the sample
+    const char* valuePtr,                       ///< [IN] Value
+    bool isJson                                 ///< [IN] Is the value a JSON document?
+)
+{
+    char quoted[SENSOR_SNAPSHOT_MEMBER_LEN];
+
+    if (entryPtr == NULL)
+    {
+        return;
+    }
+
+    entryPtr->isDirty = false;
+    IsChanged = true;
+
+    if (!isJson)
+    {
+        if (QuoteString(valuePtr, quoted, sizeof(quoted)) != LE_OK)
+        {
+            entryPtr->memberLen = 0;
+            return;
+        }
+
+        valuePtr = quoted;
+    }
+
+    SetMember(entryPtr, timestamp, valuePtr);
+}
@@ -0,0 +1,83 @@
+//--------------------------------------------------------------------------------------------------
+/** @file snapshot.h
+ *
+ * Snapshot of the last sample of every registered sensor, published as a single JSON document so
+ * that a client gets the state of the device with one push rather than by following every
+ * resource. The snapshot is configured in the configuration tree under snapshot/:
+ *
+ *  - enable    (bool)   maintain the snapshot (default false)
+ *  - period    (float)  seconds between publishes, 0 to only publish on request (default 0)
+ *
+ * The document is pushed to snapshot/value when a trigger is pushed to snapshot/trigger, and every
+ * period if a sample changed since the last publish:
+ *
+ *  {"time":1700000000.123,"sensors":{"imu/temp":[1700000000.101,24.5],"gps/fix":[...,true]}}
+ *
+ * where each sensor maps to the timestamp and value of its last sample. String samples longer
+ * than SENSOR_SNAPSHOT_MEMBER_LEN and sensors past SENSOR_SNAPSHOT_MAX_LEN are left out.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_SNAPSHOT_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_SNAPSHOT_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Entry of a sensor in the snapshot
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct snapshot_Entry snapshot_Entry_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the configuration, create the snapshot resources and start the publish timer
+ */
+//--------------------------------------------------------------------------------------------------
+void snapshot_Init
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a sensor to the snapshot
+ *
+ * @return:
+ *      - Entry, NULL if the snapshot is disabled or full
+ */
+//--------------------------------------------------------------------------------------------------
+snapshot_Entry_t* snapshot_AddSensor
+(
+    const char* pathPtr                         ///< [IN] Path of the sensor, kept by reference
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a numeric or boolean sample. It is only serialized on the next publish. Runs on the main
+ * thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void snapshot_UpdateNumeric
+(
+    snapshot_Entry_t* entryPtr,                 ///< [IN] Entry (or NULL)
+    double timestamp,                           ///< [IN] Timestamp of the sample
+    double value,                               ///< [IN] Value
+    bool isBoolean                              ///< [IN] Is the value a boolean?
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a string or JSON sample. Runs on the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void snapshot_UpdateString
+(
+    snapshot_Entry_t* entryPtr,                 ///< [IN] Entry (or NULL)
+    double timestamp,                           ///< [IN] Timestamp of the sample
+    const char* valuePtr,                       ///< [IN] Value
+    bool isJson                                 ///< [IN] Is the value a JSON document?
+);
+
+#endif /* LEGATO_SENSOR_FW_SNAPSHOT_INCLUDE_GUARD */
@@ -0,0 +1,240 @@
+//--------------------------------------------------------------------------------------------------
+/** @file store.c
+ *
+ * Persistent per-sensor settings backed by the configuration tree.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "store.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Node of the configuration tree under which sensor settings are stored
+ */
+//--------------------------------------------------------------------------------------------------
+#define     STORE_ROOT_NODE                 "sensors"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of the configuration tree path of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_NODE_PATH_LEN               (IO_MAX_RESOURCE_PATH_LEN + sizeof(STORE_ROOT_NODE) + 1)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the configuration tree path of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetNodePath
+(
+    const char* sensorPathPtr,          ///< [IN]  Path of the sensor
+    char* nodePathPtr,                  ///< [OUT] Node path
+    size_t nodePathSize                 ///< [IN]  Buffer size
+)
+{
+    snprintf(nodePathPtr, nodePathSize, "%s/%s", STORE_ROOT_NODE, sensorPathPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a string setting of a sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the setting is not stored
+ *      - LE_OVERFLOW if the buffer is too small
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t store_GetString
+(
+    const char* sensorPathPtr,          ///< [IN]  Path of the sensor
+    const char* keyPtr,                 ///< [IN]  Name of the setting
+    char* bufferPtr,                    ///< [OUT] Value
+    size_t bufferSize                   ///< [IN]  Buffer size
+)
+{
+    char nodePath[MAX_NODE_PATH_LEN];
+    le_result_t result;
+
+    GetNodePath(sensorPathPtr, nodePath, sizeof(nodePath));
+
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(nodePath);
+
+    if (le_cfg_NodeExists(iteratorRef, keyPtr))
+    {
+        result = le_cfg_GetString(iteratorRef, keyPtr, bufferPtr, bufferSize, "");
+    }
+    else
+    {
+        result = LE_NOT_FOUND;
+    }
+
+    le_cfg_CancelTxn(iteratorRef);
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a string setting of a sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the value is too long to be stored
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t store_SetString
+(
+    const char* sensorPathPtr,          ///< [IN] Path of the sensor
+    const char* keyPtr,                 ///< [IN] Name of the setting
+    const char* valuePtr                ///< [IN] Value
+)
+{
+    char nodePath[MAX_NODE_PATH_LEN];
+
+    if (strlen(valuePtr) >= LE_CFG_STR_LEN_BYTES)
+    {
+        LE_ERROR("Value of '%s' for %s is too long to be stored", keyPtr, sensorPathPtr);
+        return LE_OVERFLOW;
+    }
+
+    GetNodePath(sensorPathPtr, nodePath, sizeof(nodePath));
+
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateWriteTxn(nodePath);
+    le_cfg_SetString(iteratorRef, keyPtr, valuePtr);
+    le_cfg_CommitTxn(iteratorRef);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a numeric setting of a sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the setting is not stored
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t store_GetNumber
+(
+    const char* sensorPathPtr,          ///< [IN]  Path of the sensor
+    const char* keyPtr,                 ///< [IN]  Name of the setting
+    double* valuePtr                    ///< [OUT] Value
+)
+{
+    char nodePath[MAX_NODE_PATH_LEN];
+    le_result_t result = LE_NOT_FOUND;
+
+    GetNodePath(sensorPathPtr, nodePath, sizeof(nodePath));
+
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(nodePath);
+
+    if (le_cfg_NodeExists(iteratorRef, keyPtr))
+    {
+        *valuePtr = le_cfg_GetFloat(iteratorRef, keyPtr, 0);
+        result = LE_OK;
+    }
+
+    le_cfg_CancelTxn(iteratorRef);
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a numeric setting of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+void store_SetNumber
+(
+    const char* sensorPathPtr,          ///< [IN] Path of the sensor
+    const char* keyPtr,                 ///< [IN] Name of the setting
+    double value                        ///< [IN] Value
+)
+{
+    char nodePath[MAX_NODE_PATH_LEN];
+
+    GetNodePath(sensorPathPtr, nodePath, sizeof(nodePath));
+
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateWriteTxn(nodePath);
+    le_cfg_SetFloat(iteratorRef, keyPtr, value);
+    le_cfg_CommitTxn(iteratorRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a boolean setting of a sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the setting is not stored
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t store_GetBoolean
+(
+    const char* sensorPathPtr,          ///< [IN]  Path of the sensor
+    const char* keyPtr,                 ///< [IN]  Name of the setting
+    bool* valuePtr                      ///< [OUT] Value
+)
+{
+    char nodePath[MAX_NODE_PATH_LEN];
+    le_result_t result = LE_NOT_FOUND;
+
+    GetNodePath(sensorPathPtr, nodePath, sizeof(nodePath));
+
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(nodePath);
+
+    if (le_cfg_NodeExists(iteratorRef, keyPtr))
+    {
+        *valuePtr = le_cfg_GetBool(iteratorRef, keyPtr, false);
+        result = LE_OK;
+    }
+
+    le_cfg_CancelTxn(iteratorRef);
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a boolean setting of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+void store_SetBoolean
+(
+    const char* sensorPathPtr,          ///< [IN] Path of the sensor
+    const char* keyPtr,                 ///< [IN] Name of the setting
+    bool value                          ///< [IN] Value
+)
+{
+    char nodePath[MAX_NODE_PATH_LEN];
+
+    GetNodePath(sensorPathPtr, nodePath, sizeof(nodePath));
+
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateWriteTxn(nodePath);
+    le_cfg_SetBool(iteratorRef, keyPtr, value);
+    le_cfg_CommitTxn(iteratorRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a setting of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+void store_Delete
+(
+    const char* sensorPathPtr,          ///< [IN] Path of the sensor
+    const char* keyPtr                  ///< [IN] Name of the setting
+)
+{
+    char nodePath[MAX_NODE_PATH_LEN];
+
+    GetNodePath(sensorPathPtr, nodePath, sizeof(nodePath));
+
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateWriteTxn(nodePath);
+    le_cfg_DeleteNode(iteratorRef, keyPtr);
+    le_cfg_CommitTxn(iteratorRef);
+}
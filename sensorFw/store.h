@@ -0,0 +1,115 @@
+//--------------------------------------------------------------------------------------------------
+/** @file store.h
+ *
+ * Persistent per-sensor settings, kept in the app's configuration tree under
+ * sensors/<sensor path>/<key>.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_STORE_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_STORE_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a string setting of a sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the setting is not stored
+ *      - LE_OVERFLOW if the buffer is too small
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t store_GetString
+(
+    const char* sensorPathPtr,          ///< [IN]  Path of the sensor
+    const char* keyPtr,                 ///< [IN]  Name of the setting
+    char* bufferPtr,                    ///< [OUT] Value
+    size_t bufferSize                   ///< [IN]  Buffer size
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a string setting of a sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the value is too long to be stored
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t store_SetString
+(
+    const char* sensorPathPtr,          ///< [IN] Path of the sensor
+    const char* keyPtr,                 ///< [IN] Name of the setting
+    const char* valuePtr                ///< [IN] Value
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a numeric setting of a sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the setting is not stored
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t store_GetNumber
+(
+    const char* sensorPathPtr,          ///< [IN]  Path of the sensor
+    const char* keyPtr,                 ///< [IN]  Name of the setting
+    double* valuePtr                    ///< [OUT] Value
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a numeric setting of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+void store_SetNumber
+(
+    const char* sensorPathPtr,          ///< [IN] Path of the sensor
+    const char* keyPtr,                 ///< [IN] Name of the setting
+    double value                        ///< [IN] Value
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a boolean setting of a sensor
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the setting is not stored
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t store_GetBoolean
+(
+    const char* sensorPathPtr,          ///< [IN]  Path of the sensor
+    const char* keyPtr,                 ///< [IN]  Name of the setting
+    bool* valuePtr                      ///< [OUT] Value
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a boolean setting of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+void store_SetBoolean
+(
+    const char* sensorPathPtr,          ///< [IN] Path of the sensor
+    const char* keyPtr,                 ///< [IN] Name of the setting
+    bool value                          ///< [IN] Value
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a setting of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+void store_Delete
+(
+    const char* sensorPathPtr,          ///< [IN] Path of the sensor
+    const char* keyPtr                  ///< [IN] Name of the setting
+);
+
+#endif /* LEGATO_SENSOR_FW_STORE_INCLUDE_GUARD */
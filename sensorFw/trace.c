@@ -0,0 +1,295 @@
+//--------------------------------------------------------------------------------------------------
+/** @file trace.c
+ *
+ * Latency tracing of samples.
+ *
+ * One sample in every 1/fraction is traced, counted across all sensors with a relaxed atomic so
+ * that the decision costs nothing on the samples that are not traced. The trace travels with the
+ * sample through the staging rings; the stages are timed on the relative clock, while the
+ * timestamp of a traced sample is its capture time so that the sinks downstream of the Data Hub
+ * see when it was captured. Traces pushed to the Data Hub wait for their ack in a small ring
+ * indexed by id: a trace whose slot is reused before its ack never gets an upstream latency.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "trace.h"
+#include "config.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Node of the configuration tree under which tracing is configured
+ */
+//--------------------------------------------------------------------------------------------------
+#define     TRACE_ROOT_NODE                 "trace"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resources of the traces
+ */
+//--------------------------------------------------------------------------------------------------
+#define     TRACE_SAMPLES_PATH              "trace/samples"
+#define     TRACE_ACK_PATH                  "trace/ack"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stages of a trace
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    STAGE_READ,                                 ///< Plugin callback
+    STAGE_QUEUE,                                ///< Staged from a plugin thread
+    STAGE_PUSH,                                 ///< Push to the Data Hub
+    STAGE_UPSTREAM,                             ///< Push to ack from the upstream sink
+    STAGE_TOTAL,                                ///< Capture to ack
+    STAGE_COUNT
+}
+stage_t;
+
+static const char* const StageNames[STAGE_COUNT] =
+{
+    "read", "queue", "push", "upstream", "total"
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Latency distribution of each stage
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t StageBuckets[STAGE_COUNT][METRICS_LATENCY_BUCKET_COUNT];
+static uint64_t StageTimeUs[STAGE_COUNT];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trace waiting for its ack
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t id;                                ///< Trace id, 0 if the slot is free
+    uint64_t captureUs;                         ///< Relative time of the capture
+    uint64_t pushedUs;                          ///< Relative time the push to the Data Hub ended
+}
+pending_t;
+
+static pending_t Pending[SENSOR_TRACE_PENDING_COUNT];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * One sample in Interval is traced (0 if tracing is off), counted in SampleCount
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t Interval;
+static uint32_t SampleCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert a relative time to microseconds
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t ToUs
+(
+    le_clk_Time_t time                          ///< [IN] Relative time
+)
+{
+    return (uint64_t)time.sec * 1000000 + time.usec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count a latency in the distribution of a stage
+ */
+//--------------------------------------------------------------------------------------------------
+static void RecordStage
+(
+    stage_t stage,                              ///< [IN] Stage
+    uint64_t latencyUs                          ///< [IN] Latency
+)
+{
+    uint32_t us = (latencyUs > UINT32_MAX) ? UINT32_MAX : (uint32_t)latencyUs;
+
+    metrics_RecordLatency(StageBuckets[stage], us);
+    StageTimeUs[stage] += us;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close a trace when the upstream sink acknowledges it
+ */
+//--------------------------------------------------------------------------------------------------
+static void AckHandler
+(
+    double timestamp,                           ///< [IN] Timestamp of the ack
+    double value,                               ///< [IN] Trace id
+    void* contextPtr                            ///< [IN] Not used
+)
+{
+    uint64_t nowUs = ToUs(le_clk_GetRelativeTime());
+    uint32_t id = (uint32_t)value;
+    pending_t* pendingPtr = &Pending[id % SENSOR_TRACE_PENDING_COUNT];
+
+    if ((id == 0) || (pendingPtr->id != id))
+    {
+        LE_DEBUG("Ack of unknown trace %" PRIu32, id);
+        return;
+    }
+
+    RecordStage(STAGE_UPSTREAM, nowUs - pendingPtr->pushedUs);
+    RecordStage(STAGE_TOTAL, nowUs - pendingPtr->captureUs);
+    pendingPtr->id = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the traced fraction and create the trace resources
+ */
+//--------------------------------------------------------------------------------------------------
+void trace_Init
+(
+    void
+)
+{
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(TRACE_ROOT_NODE);
+    double fraction = le_cfg_GetFloat(iteratorRef, "fraction", 0);
+    le_result_t result;
+
+    le_cfg_CancelTxn(iteratorRef);
+
+    if (fraction <= 0)
+    {
+        return;
+    }
+
+    result = io_CreateInput(TRACE_SAMPLES_PATH, IO_DATA_TYPE_JSON, "");
+    LE_ASSERT((result == LE_OK) || (result == LE_DUPLICATE));
+
+    result = io_CreateOutput(TRACE_ACK_PATH, IO_DATA_TYPE_NUMERIC, "");
+    LE_ASSERT((result == LE_OK) || (result == LE_DUPLICATE));
+
+    io_AddNumericPushHandler(TRACE_ACK_PATH, AckHandler, NULL);
+
+    Interval = (fraction >= 1) ? 1 : (uint32_t)(1 / fraction + 0.5);
+
+    LE_INFO("Tracing one sample in %" PRIu32, Interval);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decide whether to trace a sample about to be captured, and timestamp the capture. May be called
+ * from any thread.
+ *
+ * @return:
+ *      - true if the sample is traced
+ */
+//--------------------------------------------------------------------------------------------------
+bool trace_Begin
+(
+    trace_Tag_t* tagPtr                         ///< [OUT] Trace of the sample
+)
+{
+    uint32_t count;
+
+    tagPtr->id = 0;
+
+    if (Interval == 0)
+    {
+        return false;
+    }
+
+    count = __atomic_add_fetch(&SampleCount, 1, __ATOMIC_RELAXED);
+
+    if ((count % Interval) != 0)
+    {
+        return false;
+    }
+
+    // Ids start at 1 and skip 0 when wrapping, 0 being "not traced".
+    tagPtr->id = (count / Interval) ? (count / Interval) : 1;
+    tagPtr->readUs = 0;
+    tagPtr->captureUs = ToUs(le_clk_GetRelativeTime());
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the end of the capture of a sample. May be called from any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void trace_EndRead
+(
+    trace_Tag_t* tagPtr                         ///< [IN] Trace of the sample
+)
+{
+    if (tagPtr->id != 0)
+    {
+        tagPtr->readUs = ToUs(le_clk_GetRelativeTime()) - tagPtr->captureUs;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record that a traced sample was pushed to the Data Hub, and publish its trace record. Runs on the
+ * main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void trace_EndPush
+(
+    const trace_Tag_t* tagPtr,                  ///< [IN] Trace of the sample
+    const char* pathPtr,                        ///< [IN] Path of the sensor
+    double timestamp,                           ///< [IN] Timestamp of the sample
+    le_clk_Time_t pushStart,                    ///< [IN] Relative time the push started
+    uint32_t pushUs                             ///< [IN] Time spent in the push
+)
+{
+    char record[IO_MAX_RESOURCE_PATH_LEN + 128];
+    uint64_t startUs = ToUs(pushStart);
+    uint64_t readEndUs = tagPtr->captureUs + tagPtr->readUs;
+    uint64_t queueUs = (startUs > readEndUs) ? (startUs - readEndUs) : 0;
+    pending_t* pendingPtr = &Pending[tagPtr->id % SENSOR_TRACE_PENDING_COUNT];
+
+    RecordStage(STAGE_READ, tagPtr->readUs);
+    RecordStage(STAGE_QUEUE, queueUs);
+    RecordStage(STAGE_PUSH, pushUs);
+
+    pendingPtr->id = tagPtr->id;
+    pendingPtr->captureUs = tagPtr->captureUs;
+    pendingPtr->pushedUs = startUs + pushUs;
+
+    snprintf(record, sizeof(record),
+             "{\"id\":%" PRIu32 ",\"path\":\"%s\",\"capture\":%.6f,"
+             "\"read\":%" PRIu32 ",\"queue\":%" PRIu64 ",\"push\":%" PRIu32 "}",
+             tagPtr->id, pathPtr, timestamp, tagPtr->readUs, queueUs, pushUs);
+
+    io_PushJson(TRACE_SAMPLES_PATH, IO_NOW, record);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Provide the latency distribution of the stage at an index to the metrics endpoint
+ *
+ * @return:
+ *      - true if the stage exists
+ */
+//--------------------------------------------------------------------------------------------------
+bool trace_GetMetrics
+(
+    uint32_t index,                             ///< [IN]  Index of the stage
+    metrics_Stage_t* stagePtr                   ///< [OUT] Latency distribution
+)
+{
+    if ((Interval == 0) || (index >= STAGE_COUNT))
+    {
+        return false;
+    }
+
+    stagePtr->namePtr = StageNames[index];
+    stagePtr->latencyBucketsPtr = StageBuckets[index];
+    stagePtr->totalUs = StageTimeUs[index];
+
+    return true;
+}
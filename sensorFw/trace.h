@@ -0,0 +1,102 @@
+//--------------------------------------------------------------------------------------------------
+/** @file trace.h
+ *
+ * Tracing of the latency of samples, from the call to the plugin to the Data Hub and beyond. A
+ * fraction of the samples, set by trace/fraction (float, default 0) in the configuration tree, is
+ * given a trace id and timestamped with the time it was captured. When a traced sample has been
+ * pushed, a record is pushed to trace/samples:
+ *
+ *  {"id":17,"path":"imu/temp","capture":1700000000.123456,"read":35,"queue":120,"push":410}
+ *
+ * with the time in microseconds spent in the plugin callback, staged from a plugin thread and in
+ * the push to the Data Hub. A sink forwarding the samples upstream (e.g. to an MQTT broker) closes
+ * the trace by pushing the id back to trace/ack once the sample got there. The latency of each
+ * stage, including "upstream" (push to ack) and "total" (capture to ack), is collected in
+ * histograms served by the metrics endpoint.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_SENSOR_FW_TRACE_INCLUDE_GUARD
+#define LEGATO_SENSOR_FW_TRACE_INCLUDE_GUARD
+
+#include "metrics.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trace of a sample
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t id;                                ///< Trace id, 0 if the sample is not traced
+    uint32_t readUs;                            ///< Time spent in the plugin callback
+    uint64_t captureUs;                         ///< Relative time of the capture
+}
+trace_Tag_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the traced fraction and create the trace resources
+ */
+//--------------------------------------------------------------------------------------------------
+void trace_Init
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decide whether to trace a sample about to be captured, and timestamp the capture. May be called
+ * from any thread.
+ *
+ * @return:
+ *      - true if the sample is traced
+ */
+//--------------------------------------------------------------------------------------------------
+bool trace_Begin
+(
+    trace_Tag_t* tagPtr                         ///< [OUT] Trace of the sample
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the end of the capture of a sample. May be called from any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void trace_EndRead
+(
+    trace_Tag_t* tagPtr                         ///< [IN] Trace of the sample
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record that a traced sample was pushed to the Data Hub, and publish its trace record. Runs on the
+ * main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void trace_EndPush
+(
+    const trace_Tag_t* tagPtr,                  ///< [IN] Trace of the sample
+    const char* pathPtr,                        ///< [IN] Path of the sensor
+    double timestamp,                           ///< [IN] Timestamp of the sample
+    le_clk_Time_t pushStart,                    ///< [IN] Relative time the push started
+    uint32_t pushUs                             ///< [IN] Time spent in the push
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Provide the latency distribution of the stage at an index to the metrics endpoint
+ *
+ * @return:
+ *      - true if the stage exists
+ */
+//--------------------------------------------------------------------------------------------------
+bool trace_GetMetrics
+(
+    uint32_t index,                             ///< [IN]  Index of the stage
+    metrics_Stage_t* stagePtr                   ///< [OUT] Latency distribution
+);
+
+#endif /* LEGATO_SENSOR_FW_TRACE_INCLUDE_GUARD */
@@ -0,0 +1,382 @@
+//--------------------------------------------------------------------------------------------------
+/** @file hostAlloc.c
+ *
+ * Accounting of the heap allocations of the components built for the host tests.
+ *
+ * The blocks are allocated with the C library and recorded in an open addressing hash table
+ * (linear probing) mapping their address to their owner and size, so that free() finds the owner
+ * of a block whatever component releases it.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include <pthread.h>
+#include <stdio.h>
+#include "hostAlloc.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Limits
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_OWNERS                          16
+#define MIN_TABLE_SIZE                      1024    ///< Power of two
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Block recorded in the table
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uintptr_t address;                          ///< Address of the block, 0 if the slot is free
+    size_t size;                                ///< Size of the block
+    uint32_t owner;                             ///< Index of the owner
+}
+block_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Owners and blocks
+ */
+//--------------------------------------------------------------------------------------------------
+static hostAlloc_Stats_t Owners[MAX_OWNERS];
+static uint32_t OwnerCount;
+static block_t* Table;
+static size_t TableSize;
+static size_t BlockCount;
+static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the index of an owner, adding it on its first allocation
+ *
+ * @return:
+ *      - Index of the owner
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t GetOwner
+(
+    const char* ownerPtr                        ///< [IN] Name of the owner
+)
+{
+    uint32_t i;
+
+    for (i = 0; i < OwnerCount; i++)
+    {
+        if ((Owners[i].namePtr == ownerPtr) || (strcmp(Owners[i].namePtr, ownerPtr) == 0))
+        {
+            return i;
+        }
+    }
+
+    if (OwnerCount == MAX_OWNERS)
+    {
+        fprintf(stderr, "hostAlloc: too many owners, %s is not accounted\n", ownerPtr);
+        abort();
+    }
+
+    Owners[OwnerCount].namePtr = ownerPtr;
+    return OwnerCount++;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the first slot to probe for a block
+ *
+ * @return:
+ *      - Index of the slot
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t Hash
+(
+    uintptr_t address                           ///< [IN] Address of the block
+)
+{
+    uint64_t key = address;
+
+    // Mix the bits of the address: the low ones are always zero.
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+
+    return (size_t)key & (TableSize - 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the slot of a block, or the free slot it would be recorded in
+ *
+ * @return:
+ *      - Index of the slot
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t FindSlot
+(
+    uintptr_t address                           ///< [IN] Address of the block
+)
+{
+    size_t slot = Hash(address);
+
+    while ((Table[slot].address != 0) && (Table[slot].address != address))
+    {
+        slot = (slot + 1) & (TableSize - 1);
+    }
+
+    return slot;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Double the size of the table, keeping it at most half full
+ */
+//--------------------------------------------------------------------------------------------------
+static void GrowTable
+(
+    void
+)
+{
+    block_t* oldTable = Table;
+    size_t oldSize = TableSize;
+    size_t i;
+
+    TableSize = (oldSize == 0) ? MIN_TABLE_SIZE : (oldSize * 2);
+    Table = calloc(TableSize, sizeof(block_t));
+
+    if (Table == NULL)
+    {
+        fprintf(stderr, "hostAlloc: no memory for %zu blocks\n", TableSize);
+        abort();
+    }
+
+    for (i = 0; i < oldSize; i++)
+    {
+        if (oldTable[i].address != 0)
+        {
+            Table[FindSlot(oldTable[i].address)] = oldTable[i];
+        }
+    }
+
+    free(oldTable);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a block allocated for an owner. The mutex is held.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddBlock
+(
+    const char* ownerPtr,                       ///< [IN] Name of the owner
+    uintptr_t address,                          ///< [IN] Address of the block
+    size_t size                                 ///< [IN] Size of the block
+)
+{
+    if ((BlockCount + 1) * 2 > TableSize)
+    {
+        GrowTable();
+    }
+
+    block_t* blockPtr = &Table[FindSlot(address)];
+    hostAlloc_Stats_t* ownerStatsPtr = &Owners[GetOwner(ownerPtr)];
+
+    blockPtr->address = address;
+    blockPtr->size = size;
+    blockPtr->owner = ownerStatsPtr - Owners;
+    BlockCount++;
+
+    ownerStatsPtr->allocCount++;
+    ownerStatsPtr->liveBlocks++;
+    ownerStatsPtr->liveBytes += size;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Forget a block released, if it was recorded. The mutex is held.
+ *
+ * @return:
+ *      - true if the block was recorded, false if it was allocated by the C library
+ */
+//--------------------------------------------------------------------------------------------------
+static bool RemoveBlock
+(
+    uintptr_t address,                          ///< [IN]  Address of the block
+    block_t* removedPtr                         ///< [OUT] Record of the block (or NULL)
+)
+{
+    bool isFound = false;
+
+    if (TableSize > 0)
+    {
+        size_t slot = FindSlot(address);
+
+        if (Table[slot].address != 0)
+        {
+            hostAlloc_Stats_t* ownerStatsPtr = &Owners[Table[slot].owner];
+            size_t next = slot;
+
+            ownerStatsPtr->freeCount++;
+            ownerStatsPtr->liveBlocks--;
+            ownerStatsPtr->liveBytes -= Table[slot].size;
+
+            if (removedPtr != NULL)
+            {
+                *removedPtr = Table[slot];
+            }
+
+            Table[slot].address = 0;
+            BlockCount--;
+            isFound = true;
+
+            // Move back the blocks of the run that would not be found past the freed slot.
+            for (;;)
+            {
+                next = (next + 1) & (TableSize - 1);
+
+                if (Table[next].address == 0)
+                {
+                    break;
+                }
+
+                size_t home = Hash(Table[next].address);
+
+                if (((next > slot) && ((home <= slot) || (home > next))) ||
+                    ((next < slot) && ((home <= slot) && (home > next))))
+                {
+                    Table[slot] = Table[next];
+                    Table[next].address = 0;
+                    slot = next;
+                }
+            }
+        }
+    }
+
+    return isFound;
+}
+
+void* hostAlloc_Malloc
+(
+    const char* ownerPtr,
+    size_t size
+)
+{
+    pthread_mutex_lock(&Mutex);
+
+    void* ptr = malloc(size);
+
+    if (ptr != NULL)
+    {
+        AddBlock(ownerPtr, (uintptr_t)ptr, size);
+    }
+
+    pthread_mutex_unlock(&Mutex);
+
+    return ptr;
+}
+
+void* hostAlloc_Calloc
+(
+    const char* ownerPtr,
+    size_t count,
+    size_t size
+)
+{
+    pthread_mutex_lock(&Mutex);
+
+    void* ptr = calloc(count, size);
+
+    if (ptr != NULL)
+    {
+        AddBlock(ownerPtr, (uintptr_t)ptr, count * size);
+    }
+
+    pthread_mutex_unlock(&Mutex);
+
+    return ptr;
+}
+
+void* hostAlloc_Realloc
+(
+    const char* ownerPtr,
+    void* ptr,
+    size_t size
+)
+{
+    block_t oldBlock;
+
+    pthread_mutex_lock(&Mutex);
+
+    bool isRecorded = (ptr != NULL) && RemoveBlock((uintptr_t)ptr, &oldBlock);
+    void* newPtr = realloc(ptr, size);
+
+    if (newPtr != NULL)
+    {
+        AddBlock(ownerPtr, (uintptr_t)newPtr, size);
+    }
+    else if ((size > 0) && isRecorded)
+    {
+        // The block is unchanged: record it again, as if it had not been released.
+        hostAlloc_Stats_t* ownerStatsPtr = &Owners[oldBlock.owner];
+
+        AddBlock(ownerStatsPtr->namePtr, oldBlock.address, oldBlock.size);
+        ownerStatsPtr->allocCount--;
+        ownerStatsPtr->freeCount--;
+    }
+
+    pthread_mutex_unlock(&Mutex);
+
+    return newPtr;
+}
+
+char* hostAlloc_Strdup
+(
+    const char* ownerPtr,
+    const char* strPtr
+)
+{
+    size_t size = strlen(strPtr) + 1;
+    char* copyPtr = hostAlloc_Malloc(ownerPtr, size);
+
+    if (copyPtr != NULL)
+    {
+        memcpy(copyPtr, strPtr, size);
+    }
+
+    return copyPtr;
+}
+
+void hostAlloc_Free
+(
+    void* ptr
+)
+{
+    if (ptr != NULL)
+    {
+        pthread_mutex_lock(&Mutex);
+        RemoveBlock((uintptr_t)ptr, NULL);
+        free(ptr);
+        pthread_mutex_unlock(&Mutex);
+    }
+}
+
+bool hostAlloc_GetStats
+(
+    uint32_t index,
+    hostAlloc_Stats_t* statsPtr
+)
+{
+    bool isFound = false;
+
+    pthread_mutex_lock(&Mutex);
+
+    if (index < OwnerCount)
+    {
+        *statsPtr = Owners[index];
+        isFound = true;
+    }
+
+    pthread_mutex_unlock(&Mutex);
+
+    return isFound;
+}
@@ -0,0 +1,104 @@
+//--------------------------------------------------------------------------------------------------
+/** @file hostAlloc.h
+ *
+ * Accounting of the heap allocations of the components built for the host tests, so that the
+ * leaks and the allocation churn of each plugin can be told apart.
+ *
+ * The header is forced into the sources of a component with -include, with HOST_ALLOC_OWNER set
+ * to the name of the component: malloc(), calloc(), realloc(), strdup() and free() are then
+ * replaced by functions accounting the blocks to that owner. Blocks allocated by the C library
+ * itself (e.g. by asprintf()) are not accounted, and are released normally.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_ALLOC_INCLUDE_GUARD
+#define LEGATO_HOST_ALLOC_INCLUDE_GUARD
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocations of an owner
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* namePtr;                        ///< Name of the owner
+    uint64_t allocCount;                        ///< Blocks allocated, reallocations included
+    uint64_t freeCount;                         ///< Blocks released
+    uint64_t liveBlocks;                        ///< Blocks allocated and not released
+    uint64_t liveBytes;                         ///< Bytes of the blocks not released
+}
+hostAlloc_Stats_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Accounting allocation functions
+ */
+//--------------------------------------------------------------------------------------------------
+void* hostAlloc_Malloc(const char* ownerPtr, size_t size);
+void* hostAlloc_Calloc(const char* ownerPtr, size_t count, size_t size);
+void* hostAlloc_Realloc(const char* ownerPtr, void* ptr, size_t size);
+char* hostAlloc_Strdup(const char* ownerPtr, const char* strPtr);
+void hostAlloc_Free(void* ptr);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the allocations of the owner at an index, in the order the owners first allocated
+ *
+ * @return:
+ *      - true if the owner exists
+ */
+//--------------------------------------------------------------------------------------------------
+bool hostAlloc_GetStats
+(
+    uint32_t index,                             ///< [IN]  Index of the owner
+    hostAlloc_Stats_t* statsPtr                 ///< [OUT] Allocations
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replacement of the allocation functions in the sources of an owner. They are functions rather
+ * than function-like macros so that their addresses can be taken, e.g. as jansson's defaults.
+ */
+//--------------------------------------------------------------------------------------------------
+#if defined(HOST_ALLOC_OWNER)
+
+static inline void* HostAlloc_Malloc(size_t size)
+{
+    return hostAlloc_Malloc(HOST_ALLOC_OWNER, size);
+}
+
+static inline void* HostAlloc_Calloc(size_t count, size_t size)
+{
+    return hostAlloc_Calloc(HOST_ALLOC_OWNER, count, size);
+}
+
+static inline void* HostAlloc_Realloc(void* ptr, size_t size)
+{
+    return hostAlloc_Realloc(HOST_ALLOC_OWNER, ptr, size);
+}
+
+static inline char* HostAlloc_Strdup(const char* strPtr)
+{
+    return hostAlloc_Strdup(HOST_ALLOC_OWNER, strPtr);
+}
+
+#define malloc      HostAlloc_Malloc
+#define calloc      HostAlloc_Calloc
+#define realloc     HostAlloc_Realloc
+#define strdup      HostAlloc_Strdup
+#define free        hostAlloc_Free
+
+#endif /* HOST_ALLOC_OWNER */
+
+#endif /* LEGATO_HOST_ALLOC_INCLUDE_GUARD */
@@ -0,0 +1,577 @@
+//--------------------------------------------------------------------------------------------------
+/** @file dataHub.c
+ *
+ * Mock of the Data Hub for the host tests: the io and admin APIs over an in-memory set of
+ * resources. Each resource keeps its last value only. Push handlers are called from the event
+ * loop, after the push returned, as they would be over IPC.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "dataHub.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of the absolute path of a resource
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_PATH_LEN    (sizeof(DATAHUB_APP_ROOT) + IO_MAX_RESOURCE_PATH_LEN + 1)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push handler
+ */
+//--------------------------------------------------------------------------------------------------
+struct io_PushHandler
+{
+    io_DataType_t type;                         ///< Type of the values the handler takes
+    void* funcPtr;                              ///< Handler
+    void* contextPtr;                           ///< Context
+    struct io_PushHandler* nextPtr;             ///< Next handler of the resource
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resource
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char path[MAX_PATH_LEN];                    ///< Absolute path
+    io_DataType_t type;                         ///< Data type
+    bool hasNumeric;                            ///< Was a numeric value pushed?
+    double numeric;                             ///< Last numeric value
+    uint32_t pushCount;                         ///< Number of values pushed
+    struct io_PushHandler* handlersPtr;         ///< Push handlers
+}
+resource_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value being delivered to the push handlers
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    io_DataType_t type;                         ///< Data type of the value
+    double timestamp;                           ///< Time of the value
+    bool boolean;                               ///< Boolean value
+    double numeric;                             ///< Numeric value
+    char string[];                              ///< String or JSON value
+}
+push_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resources, by absolute path
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t ResourceMap;
+static uint32_t ResourceCount;
+static uint64_t PushCount;
+static uint64_t ByteCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the absolute path of a resource of the app
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetAbsolutePath
+(
+    const char* pathPtr,                        ///< [IN]  Path relative to the app
+    char* absolutePathPtr                       ///< [OUT] Absolute path, MAX_PATH_LEN bytes
+)
+{
+    snprintf(absolutePathPtr, MAX_PATH_LEN, "%s/%s", DATAHUB_APP_ROOT, pathPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a resource
+ *
+ * @return:
+ *      - Resource, NULL if it does not exist
+ */
+//--------------------------------------------------------------------------------------------------
+static resource_t* FindResource
+(
+    const char* absolutePathPtr                 ///< [IN] Absolute path
+)
+{
+    if (ResourceMap == NULL)
+    {
+        ResourceMap = le_hashmap_Create("resources", 4096,
+                                        le_hashmap_HashString, le_hashmap_EqualsString);
+    }
+
+    return le_hashmap_Get(ResourceMap, absolutePathPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a resource of the app
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_DUPLICATE if the resource exists
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CreateResource
+(
+    const char* pathPtr,                        ///< [IN] Path relative to the app
+    io_DataType_t type                          ///< [IN] Data type
+)
+{
+    char path[MAX_PATH_LEN];
+
+    GetAbsolutePath(pathPtr, path);
+
+    if (FindResource(path) != NULL)
+    {
+        return LE_DUPLICATE;
+    }
+
+    resource_t* resourcePtr = calloc(1, sizeof(resource_t));
+
+    LE_ASSERT(resourcePtr != NULL);
+
+    memcpy(resourcePtr->path, path, sizeof(path));
+    resourcePtr->type = type;
+    le_hashmap_Put(ResourceMap, resourcePtr->path, resourcePtr);
+    ResourceCount++;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call the push handlers of a resource
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeliverPush
+(
+    void* resourcePtr,                          ///< [IN] Resource
+    void* pushPtr                               ///< [IN] Value
+)
+{
+    struct io_PushHandler* handlerPtr;
+    push_t* valuePtr = pushPtr;
+
+    for (handlerPtr = ((resource_t*)resourcePtr)->handlersPtr;
+         handlerPtr != NULL;
+         handlerPtr = handlerPtr->nextPtr)
+    {
+        if (handlerPtr->type == IO_DATA_TYPE_TRIGGER)
+        {
+            ((io_TriggerPushHandlerFunc_t)handlerPtr->funcPtr)(valuePtr->timestamp,
+                                                               handlerPtr->contextPtr);
+        }
+        else if (handlerPtr->type != valuePtr->type)
+        {
+            continue;
+        }
+        else if (valuePtr->type == IO_DATA_TYPE_BOOLEAN)
+        {
+            ((io_BooleanPushHandlerFunc_t)handlerPtr->funcPtr)(valuePtr->timestamp,
+                                                               valuePtr->boolean,
+                                                               handlerPtr->contextPtr);
+        }
+        else if (valuePtr->type == IO_DATA_TYPE_NUMERIC)
+        {
+            ((io_NumericPushHandlerFunc_t)handlerPtr->funcPtr)(valuePtr->timestamp,
+                                                               valuePtr->numeric,
+                                                               handlerPtr->contextPtr);
+        }
+        else
+        {
+            ((io_JsonPushHandlerFunc_t)handlerPtr->funcPtr)(valuePtr->timestamp,
+                                                            valuePtr->string,
+                                                            handlerPtr->contextPtr);
+        }
+    }
+
+    free(valuePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a value to a resource
+ */
+//--------------------------------------------------------------------------------------------------
+static void Push
+(
+    const char* absolutePathPtr,                ///< [IN] Absolute path
+    io_DataType_t type,                         ///< [IN] Data type of the value
+    double timestamp,                           ///< [IN] Time of the value, IO_NOW for now
+    bool boolean,                               ///< [IN] Boolean value
+    double numeric,                             ///< [IN] Numeric value
+    const char* stringPtr                       ///< [IN] String or JSON value
+)
+{
+    resource_t* resourcePtr = FindResource(absolutePathPtr);
+    size_t length = (stringPtr != NULL) ? strlen(stringPtr) : 0;
+
+    if (resourcePtr == NULL)
+    {
+        LE_WARN("Push to %s, which does not exist", absolutePathPtr);
+        return;
+    }
+
+    resourcePtr->pushCount++;
+    PushCount++;
+    ByteCount += length;
+
+    if (type == IO_DATA_TYPE_NUMERIC)
+    {
+        resourcePtr->hasNumeric = true;
+        resourcePtr->numeric = numeric;
+    }
+
+    if (resourcePtr->handlersPtr == NULL)
+    {
+        return;
+    }
+
+    push_t* valuePtr = malloc(sizeof(push_t) + length + 1);
+
+    LE_ASSERT(valuePtr != NULL);
+
+    if (timestamp == IO_NOW)
+    {
+        le_clk_Time_t now = le_clk_GetAbsoluteTime();
+
+        timestamp = (double)now.sec + (now.usec / 1000000.0);
+    }
+
+    valuePtr->type = type;
+    valuePtr->timestamp = timestamp;
+    valuePtr->boolean = boolean;
+    valuePtr->numeric = numeric;
+    memcpy(valuePtr->string, (stringPtr != NULL) ? stringPtr : "", length + 1);
+
+    le_event_QueueFunction(DeliverPush, resourcePtr, valuePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a push handler to a resource
+ *
+ * @return:
+ *      - Handler, NULL if the resource does not exist
+ */
+//--------------------------------------------------------------------------------------------------
+static struct io_PushHandler* AddPushHandler
+(
+    const char* absolutePathPtr,                ///< [IN] Absolute path
+    io_DataType_t type,                         ///< [IN] Type of the values the handler takes
+    void* funcPtr,                              ///< [IN] Handler
+    void* contextPtr                            ///< [IN] Context
+)
+{
+    resource_t* resourcePtr = FindResource(absolutePathPtr);
+
+    if (resourcePtr == NULL)
+    {
+        LE_WARN("Handler on %s, which does not exist", absolutePathPtr);
+        return NULL;
+    }
+
+    struct io_PushHandler* handlerPtr = malloc(sizeof(struct io_PushHandler));
+
+    LE_ASSERT(handlerPtr != NULL);
+
+    handlerPtr->type = type;
+    handlerPtr->funcPtr = funcPtr;
+    handlerPtr->contextPtr = contextPtr;
+    handlerPtr->nextPtr = resourcePtr->handlersPtr;
+    resourcePtr->handlersPtr = handlerPtr;
+
+    return handlerPtr;
+}
+
+le_result_t io_CreateInput
+(
+    const char* path,
+    io_DataType_t dataType,
+    const char* units
+)
+{
+    LE_UNUSED(units);
+    return CreateResource(path, dataType);
+}
+
+le_result_t io_CreateOutput
+(
+    const char* path,
+    io_DataType_t dataType,
+    const char* units
+)
+{
+    LE_UNUSED(units);
+    return CreateResource(path, dataType);
+}
+
+void io_PushTrigger
+(
+    const char* path,
+    double timestamp
+)
+{
+    char absolutePath[MAX_PATH_LEN];
+
+    GetAbsolutePath(path, absolutePath);
+    Push(absolutePath, IO_DATA_TYPE_TRIGGER, timestamp, false, 0, NULL);
+}
+
+void io_PushBoolean
+(
+    const char* path,
+    double timestamp,
+    bool value
+)
+{
+    char absolutePath[MAX_PATH_LEN];
+
+    GetAbsolutePath(path, absolutePath);
+    Push(absolutePath, IO_DATA_TYPE_BOOLEAN, timestamp, value, 0, NULL);
+}
+
+void io_PushNumeric
+(
+    const char* path,
+    double timestamp,
+    double value
+)
+{
+    char absolutePath[MAX_PATH_LEN];
+
+    GetAbsolutePath(path, absolutePath);
+    Push(absolutePath, IO_DATA_TYPE_NUMERIC, timestamp, false, value, NULL);
+}
+
+void io_PushString
+(
+    const char* path,
+    double timestamp,
+    const char* value
+)
+{
+    char absolutePath[MAX_PATH_LEN];
+
+    GetAbsolutePath(path, absolutePath);
+    Push(absolutePath, IO_DATA_TYPE_STRING, timestamp, false, 0, value);
+}
+
+void io_PushJson
+(
+    const char* path,
+    double timestamp,
+    const char* value
+)
+{
+    char absolutePath[MAX_PATH_LEN];
+
+    GetAbsolutePath(path, absolutePath);
+    Push(absolutePath, IO_DATA_TYPE_JSON, timestamp, false, 0, value);
+}
+
+io_TriggerPushHandlerRef_t io_AddTriggerPushHandler
+(
+    const char* path,
+    io_TriggerPushHandlerFunc_t callbackPtr,
+    void* contextPtr
+)
+{
+    char absolutePath[MAX_PATH_LEN];
+
+    GetAbsolutePath(path, absolutePath);
+    return AddPushHandler(absolutePath, IO_DATA_TYPE_TRIGGER, callbackPtr, contextPtr);
+}
+
+io_BooleanPushHandlerRef_t io_AddBooleanPushHandler
+(
+    const char* path,
+    io_BooleanPushHandlerFunc_t callbackPtr,
+    void* contextPtr
+)
+{
+    char absolutePath[MAX_PATH_LEN];
+
+    GetAbsolutePath(path, absolutePath);
+    return AddPushHandler(absolutePath, IO_DATA_TYPE_BOOLEAN, callbackPtr, contextPtr);
+}
+
+io_NumericPushHandlerRef_t io_AddNumericPushHandler
+(
+    const char* path,
+    io_NumericPushHandlerFunc_t callbackPtr,
+    void* contextPtr
+)
+{
+    char absolutePath[MAX_PATH_LEN];
+
+    GetAbsolutePath(path, absolutePath);
+    return AddPushHandler(absolutePath, IO_DATA_TYPE_NUMERIC, callbackPtr, contextPtr);
+}
+
+io_StringPushHandlerRef_t io_AddStringPushHandler
+(
+    const char* path,
+    io_StringPushHandlerFunc_t callbackPtr,
+    void* contextPtr
+)
+{
+    char absolutePath[MAX_PATH_LEN];
+
+    GetAbsolutePath(path, absolutePath);
+    return AddPushHandler(absolutePath, IO_DATA_TYPE_STRING, callbackPtr, contextPtr);
+}
+
+io_JsonPushHandlerRef_t io_AddJsonPushHandler
+(
+    const char* path,
+    io_JsonPushHandlerFunc_t callbackPtr,
+    void* contextPtr
+)
+{
+    char absolutePath[MAX_PATH_LEN];
+
+    GetAbsolutePath(path, absolutePath);
+    return AddPushHandler(absolutePath, IO_DATA_TYPE_JSON, callbackPtr, contextPtr);
+}
+
+void admin_SetBufferMaxCount
+(
+    const char* path,
+    uint32_t count
+)
+{
+    LE_UNUSED(path);
+    LE_UNUSED(count);
+}
+
+void admin_SetBufferBackupPeriod
+(
+    const char* path,
+    uint32_t seconds
+)
+{
+    LE_UNUSED(path);
+    LE_UNUSED(seconds);
+}
+
+void admin_PushTrigger
+(
+    const char* path,
+    double timestamp
+)
+{
+    Push(path, IO_DATA_TYPE_TRIGGER, timestamp, false, 0, NULL);
+}
+
+void admin_PushBoolean
+(
+    const char* path,
+    double timestamp,
+    bool value
+)
+{
+    Push(path, IO_DATA_TYPE_BOOLEAN, timestamp, value, 0, NULL);
+}
+
+void admin_PushNumeric
+(
+    const char* path,
+    double timestamp,
+    double value
+)
+{
+    Push(path, IO_DATA_TYPE_NUMERIC, timestamp, false, value, NULL);
+}
+
+void admin_PushString
+(
+    const char* path,
+    double timestamp,
+    const char* value
+)
+{
+    Push(path, IO_DATA_TYPE_STRING, timestamp, false, 0, value);
+}
+
+void admin_PushJson
+(
+    const char* path,
+    double timestamp,
+    const char* value
+)
+{
+    Push(path, IO_DATA_TYPE_JSON, timestamp, false, 0, value);
+}
+
+admin_NumericPushHandlerRef_t admin_AddNumericPushHandler
+(
+    const char* path,
+    admin_NumericPushHandlerFunc_t callbackPtr,
+    void* contextPtr
+)
+{
+    return AddPushHandler(path, IO_DATA_TYPE_NUMERIC, callbackPtr, contextPtr);
+}
+
+admin_JsonPushHandlerRef_t admin_AddJsonPushHandler
+(
+    const char* path,
+    admin_JsonPushHandlerFunc_t callbackPtr,
+    void* contextPtr
+)
+{
+    return AddPushHandler(path, IO_DATA_TYPE_JSON, callbackPtr, contextPtr);
+}
+
+le_result_t dataHub_GetNumeric
+(
+    const char* pathPtr,
+    double* valuePtr
+)
+{
+    resource_t* resourcePtr = FindResource(pathPtr);
+
+    if (resourcePtr == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    if (!resourcePtr->hasNumeric)
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    *valuePtr = resourcePtr->numeric;
+    return LE_OK;
+}
+
+uint32_t dataHub_GetPushCount
+(
+    const char* pathPtr
+)
+{
+    resource_t* resourcePtr = FindResource(pathPtr);
+
+    return (resourcePtr != NULL) ? resourcePtr->pushCount : 0;
+}
+
+void dataHub_GetTotals
+(
+    uint32_t* resourceCountPtr,
+    uint64_t* pushCountPtr,
+    uint64_t* byteCountPtr
+)
+{
+    *resourceCountPtr = ResourceCount;
+    *pushCountPtr = PushCount;
+    *byteCountPtr = ByteCount;
+}
@@ -0,0 +1,62 @@
+//--------------------------------------------------------------------------------------------------
+/** @file dataHub.h
+ *
+ * Inspection of the mock Data Hub by the host tests. Resources are addressed by their absolute
+ * path, e.g. /app/sensorFw/<sensor>/value.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_DATAHUB_INCLUDE_GUARD
+#define LEGATO_HOST_DATAHUB_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Root of the resources created with the io API
+ */
+//--------------------------------------------------------------------------------------------------
+#define DATAHUB_APP_ROOT                    "/app/sensorFw"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the last numeric value pushed to a resource
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the resource does not exist
+ *      - LE_UNAVAILABLE if no numeric value was pushed
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t dataHub_GetNumeric
+(
+    const char* pathPtr,                        ///< [IN]  Absolute path of the resource
+    double* valuePtr                            ///< [OUT] Value
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of values pushed to a resource
+ *
+ * @return:
+ *      - Number of values, 0 if the resource does not exist
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t dataHub_GetPushCount
+(
+    const char* pathPtr                         ///< [IN] Absolute path of the resource
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the totals of the mock
+ */
+//--------------------------------------------------------------------------------------------------
+void dataHub_GetTotals
+(
+    uint32_t* resourceCountPtr,                 ///< [OUT] Number of resources
+    uint64_t* pushCountPtr,                     ///< [OUT] Number of values pushed
+    uint64_t* byteCountPtr                      ///< [OUT] Bytes of string and JSON values pushed
+);
+
+#endif /* LEGATO_HOST_DATAHUB_INCLUDE_GUARD */
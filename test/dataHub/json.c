@@ -0,0 +1,388 @@
+//--------------------------------------------------------------------------------------------------
+/** @file json.c
+ *
+ * Host stand-in for the json component: extraction of members and elements of JSON values,
+ * without building a document.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "json.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skip white space
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* SkipSpace
+(
+    const char* charPtr                         ///< [IN] Position
+)
+{
+    while ((*charPtr == ' ') || (*charPtr == '\t') || (*charPtr == '\n') || (*charPtr == '\r'))
+    {
+        charPtr++;
+    }
+
+    return charPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skip a string
+ *
+ * @return:
+ *      - Position after the closing quote, NULL if the string is malformed
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* SkipString
+(
+    const char* charPtr                         ///< [IN] Opening quote
+)
+{
+    for (charPtr++; *charPtr != '"'; charPtr++)
+    {
+        if (*charPtr == '\0')
+        {
+            return NULL;
+        }
+
+        if ((*charPtr == '\\') && (*++charPtr == '\0'))
+        {
+            return NULL;
+        }
+    }
+
+    return charPtr + 1;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skip a value
+ *
+ * @return:
+ *      - Position after the value, NULL if the value is malformed
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* SkipValue
+(
+    const char* charPtr                         ///< [IN] Start of the value
+)
+{
+    charPtr = SkipSpace(charPtr);
+
+    if (*charPtr == '"')
+    {
+        return SkipString(charPtr);
+    }
+
+    if ((*charPtr == '{') || (*charPtr == '['))
+    {
+        char closing = (*charPtr == '{') ? '}' : ']';
+
+        charPtr = SkipSpace(charPtr + 1);
+
+        if (*charPtr == closing)
+        {
+            return charPtr + 1;
+        }
+
+        for (;;)
+        {
+            if (closing == '}')
+            {
+                if (*charPtr != '"')
+                {
+                    return NULL;
+                }
+
+                charPtr = SkipString(charPtr);
+
+                if ((charPtr == NULL) || (*(charPtr = SkipSpace(charPtr)) != ':'))
+                {
+                    return NULL;
+                }
+
+                charPtr++;
+            }
+
+            charPtr = SkipValue(charPtr);
+
+            if (charPtr == NULL)
+            {
+                return NULL;
+            }
+
+            charPtr = SkipSpace(charPtr);
+
+            if (*charPtr == closing)
+            {
+                return charPtr + 1;
+            }
+
+            if (*charPtr != ',')
+            {
+                return NULL;
+            }
+
+            charPtr = SkipSpace(charPtr + 1);
+        }
+    }
+
+    const char* startPtr = charPtr;
+
+    while ((*charPtr != '\0') && (strchr(",}] \t\r\n", *charPtr) == NULL))
+    {
+        charPtr++;
+    }
+
+    return (charPtr > startPtr) ? charPtr : NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a member of an object
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the object does not have the member
+ *      - LE_FORMAT_ERROR if the value is not an object or is malformed
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FindMember
+(
+    const char** charPtrPtr,                    ///< [IN/OUT] Object, then value of the member
+    const char* namePtr,                        ///< [IN]     Name of the member
+    size_t nameLength                           ///< [IN]     Length of the name
+)
+{
+    const char* charPtr = SkipSpace(*charPtrPtr);
+
+    if (*charPtr != '{')
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    for (charPtr = SkipSpace(charPtr + 1); *charPtr == '"'; charPtr = SkipSpace(charPtr + 1))
+    {
+        const char* keyPtr = charPtr + 1;
+        const char* keyEndPtr = SkipString(charPtr);
+
+        if ((keyEndPtr == NULL) || (*(charPtr = SkipSpace(keyEndPtr)) != ':'))
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        // The closing quote ends the key.
+        if (((size_t)(keyEndPtr - keyPtr) == nameLength + 1) &&
+            (strncmp(keyPtr, namePtr, nameLength) == 0))
+        {
+            *charPtrPtr = SkipSpace(charPtr + 1);
+            return LE_OK;
+        }
+
+        charPtr = SkipValue(charPtr + 1);
+
+        if (charPtr == NULL)
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        charPtr = SkipSpace(charPtr);
+
+        if (*charPtr != ',')
+        {
+            break;
+        }
+    }
+
+    return (*charPtr == '}') ? LE_NOT_FOUND : LE_FORMAT_ERROR;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find an element of an array
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the array is shorter
+ *      - LE_FORMAT_ERROR if the value is not an array or is malformed
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FindElement
+(
+    const char** charPtrPtr,                    ///< [IN/OUT] Array, then the element
+    unsigned long index                         ///< [IN]     Index of the element
+)
+{
+    const char* charPtr = SkipSpace(*charPtrPtr);
+
+    if (*charPtr != '[')
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    charPtr = SkipSpace(charPtr + 1);
+
+    if (*charPtr == ']')
+    {
+        return LE_NOT_FOUND;
+    }
+
+    for (; index > 0; index--)
+    {
+        charPtr = SkipValue(charPtr);
+
+        if (charPtr == NULL)
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        charPtr = SkipSpace(charPtr);
+
+        if (*charPtr == ']')
+        {
+            return LE_NOT_FOUND;
+        }
+
+        if (*charPtr != ',')
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        charPtr = SkipSpace(charPtr + 1);
+    }
+
+    *charPtrPtr = charPtr;
+    return LE_OK;
+}
+
+le_result_t json_Extract
+(
+    char* resultBuffPtr,
+    size_t resultBuffSize,
+    const char* jsonValue,
+    const char* extractionSpec,
+    json_DataType_t* resultTypePtr
+)
+{
+    const char* charPtr = jsonValue;
+    const char* specPtr = extractionSpec;
+    const char* endPtr;
+    le_result_t result;
+
+    while (*specPtr != '\0')
+    {
+        if (*specPtr == '[')
+        {
+            char* indexEndPtr;
+            unsigned long index = strtoul(specPtr + 1, &indexEndPtr, 10);
+
+            if ((indexEndPtr == specPtr + 1) || (*indexEndPtr != ']'))
+            {
+                return LE_FORMAT_ERROR;
+            }
+
+            result = FindElement(&charPtr, index);
+            specPtr = indexEndPtr + 1;
+        }
+        else
+        {
+            size_t length = strcspn(specPtr, ".[");
+
+            if (length == 0)
+            {
+                return LE_FORMAT_ERROR;
+            }
+
+            result = FindMember(&charPtr, specPtr, length);
+            specPtr += length;
+        }
+
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        if (*specPtr == '.')
+        {
+            specPtr++;
+        }
+    }
+
+    charPtr = SkipSpace(charPtr);
+    endPtr = SkipValue(charPtr);
+
+    if (endPtr == NULL)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    switch (*charPtr)
+    {
+        case '"':
+            *resultTypePtr = JSON_TYPE_STRING;
+            charPtr++;
+            endPtr--;
+            break;
+
+        case '{':
+            *resultTypePtr = JSON_TYPE_OBJECT;
+            break;
+
+        case '[':
+            *resultTypePtr = JSON_TYPE_ARRAY;
+            break;
+
+        case 't':
+        case 'f':
+            *resultTypePtr = JSON_TYPE_BOOLEAN;
+            break;
+
+        case 'n':
+            *resultTypePtr = JSON_TYPE_NULL;
+            break;
+
+        default:
+            *resultTypePtr = JSON_TYPE_NUMBER;
+            break;
+    }
+
+    if ((size_t)(endPtr - charPtr) >= resultBuffSize)
+    {
+        return LE_OVERFLOW;
+    }
+
+    memcpy(resultBuffPtr, charPtr, endPtr - charPtr);
+    resultBuffPtr[endPtr - charPtr] = '\0';
+
+    return LE_OK;
+}
+
+bool json_ConvertToBoolean
+(
+    const char* jsonValue
+)
+{
+    return (strcmp(jsonValue, "true") == 0);
+}
+
+double json_ConvertToNumber
+(
+    const char* jsonValue
+)
+{
+    return strtod(jsonValue, NULL);
+}
+
+bool json_IsValid
+(
+    const char* jsonValue
+)
+{
+    const char* endPtr = SkipValue(jsonValue);
+
+    return (endPtr != NULL) && (*SkipSpace(endPtr) == '\0');
+}
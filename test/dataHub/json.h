@@ -0,0 +1,66 @@
+//--------------------------------------------------------------------------------------------------
+/** @file json.h
+ *
+ * Host stand-in for the json component of the Data Hub samples.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_JSON_INCLUDE_GUARD
+#define LEGATO_HOST_JSON_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Type of a JSON value
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    JSON_TYPE_NULL,
+    JSON_TYPE_BOOLEAN,
+    JSON_TYPE_NUMBER,
+    JSON_TYPE_STRING,
+    JSON_TYPE_OBJECT,
+    JSON_TYPE_ARRAY
+}
+json_DataType_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extract a member or an element of a JSON value. The specification is a list of member names
+ * separated by '.' and of array indexes in brackets, e.g. "a.b[2].c". Strings are extracted
+ * without their quotes, other values as they are written.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if the value does not have the member or element
+ *      - LE_FORMAT_ERROR if the value or the specification is malformed
+ *      - LE_OVERFLOW if the buffer is too small
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t json_Extract
+(
+    char* resultBuffPtr,                        ///< [OUT] Extracted value
+    size_t resultBuffSize,                      ///< [IN]  Buffer size
+    const char* jsonValue,                      ///< [IN]  JSON value
+    const char* extractionSpec,                 ///< [IN]  Member or element to extract
+    json_DataType_t* resultTypePtr              ///< [OUT] Type of the extracted value
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert extracted values
+ */
+//--------------------------------------------------------------------------------------------------
+bool json_ConvertToBoolean(const char* jsonValue);
+double json_ConvertToNumber(const char* jsonValue);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a string is a valid JSON value
+ */
+//--------------------------------------------------------------------------------------------------
+bool json_IsValid(const char* jsonValue);
+
+#endif /* LEGATO_HOST_JSON_INCLUDE_GUARD */
@@ -0,0 +1,182 @@
+//--------------------------------------------------------------------------------------------------
+/** @file periodicSensor.c
+ *
+ * Host stand-in for the periodicSensor component: a repeating timer per sensor, set by its
+ * "period" and "enable" outputs.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#define dhubIO_DataType_t io_DataType_t
+
+#include "periodicSensor.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Periodic sensor
+ */
+//--------------------------------------------------------------------------------------------------
+struct psensor
+{
+    char valuePath[IO_MAX_RESOURCE_PATH_LEN + 1];   ///< Path of the "value" input
+    le_timer_Ref_t timerRef;                        ///< Sampling timer
+    double period;                                  ///< Period in seconds, 0 if not set
+    bool isEnabled;                                 ///< Is the sensor enabled?
+    void (*sampleFunc)(psensor_Ref_t, void*);       ///< Sample function
+    void* contextPtr;                               ///< Context of the sample function
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start or stop the timer of a sensor according to its settings
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateTimer
+(
+    psensor_Ref_t ref                           ///< [IN] Sensor
+)
+{
+    le_timer_Stop(ref->timerRef);
+
+    if (ref->isEnabled && (ref->period > 0))
+    {
+        le_timer_SetMsInterval(ref->timerRef, (uint32_t)(ref->period * 1000));
+        le_timer_Start(ref->timerRef);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sampling timer expiry
+ */
+//--------------------------------------------------------------------------------------------------
+static void TimerHandler
+(
+    le_timer_Ref_t timerRef                     ///< [IN] Timer
+)
+{
+    psensor_Ref_t ref = le_timer_GetContextPtr(timerRef);
+
+    ref->sampleFunc(ref, ref->contextPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push to the "period" output
+ */
+//--------------------------------------------------------------------------------------------------
+static void PeriodHandler
+(
+    double timestamp,                           ///< [IN] Time of the value
+    double value,                               ///< [IN] Period in seconds
+    void* contextPtr                            ///< [IN] Sensor
+)
+{
+    psensor_Ref_t ref = contextPtr;
+
+    if (value != ref->period)
+    {
+        ref->period = value;
+        UpdateTimer(ref);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push to the "enable" output
+ */
+//--------------------------------------------------------------------------------------------------
+static void EnableHandler
+(
+    double timestamp,                           ///< [IN] Time of the value
+    bool value,                                 ///< [IN] Enabled?
+    void* contextPtr                            ///< [IN] Sensor
+)
+{
+    psensor_Ref_t ref = contextPtr;
+
+    if (value != ref->isEnabled)
+    {
+        ref->isEnabled = value;
+        UpdateTimer(ref);
+    }
+}
+
+psensor_Ref_t psensor_Create
+(
+    const char* name,
+    dhubIO_DataType_t dataType,
+    const char* units,
+    void (*sampleFunc)(psensor_Ref_t ref, void* contextPtr),
+    void* contextPtr
+)
+{
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];
+    psensor_Ref_t ref = calloc(1, sizeof(struct psensor));
+
+    LE_ASSERT(ref != NULL);
+
+    snprintf(ref->valuePath, sizeof(ref->valuePath), "%s/value", name);
+    io_CreateInput(ref->valuePath, dataType, units);
+
+    snprintf(path, sizeof(path), "%s/period", name);
+    io_CreateOutput(path, IO_DATA_TYPE_NUMERIC, "s");
+    io_AddNumericPushHandler(path, PeriodHandler, ref);
+
+    snprintf(path, sizeof(path), "%s/enable", name);
+    io_CreateOutput(path, IO_DATA_TYPE_BOOLEAN, "");
+    io_AddBooleanPushHandler(path, EnableHandler, ref);
+
+    ref->timerRef = le_timer_Create(name);
+    le_timer_SetRepeat(ref->timerRef, 0);
+    le_timer_SetContextPtr(ref->timerRef, ref);
+    le_timer_SetHandler(ref->timerRef, TimerHandler);
+    ref->sampleFunc = sampleFunc;
+    ref->contextPtr = contextPtr;
+
+    return ref;
+}
+
+void psensor_PushBoolean
+(
+    psensor_Ref_t ref,
+    double timestamp,
+    bool value
+)
+{
+    io_PushBoolean(ref->valuePath, timestamp, value);
+}
+
+void psensor_PushNumeric
+(
+    psensor_Ref_t ref,
+    double timestamp,
+    double value
+)
+{
+    io_PushNumeric(ref->valuePath, timestamp, value);
+}
+
+void psensor_PushString
+(
+    psensor_Ref_t ref,
+    double timestamp,
+    const char* value
+)
+{
+    io_PushString(ref->valuePath, timestamp, value);
+}
+
+void psensor_PushJson
+(
+    psensor_Ref_t ref,
+    double timestamp,
+    const char* value
+)
+{
+    io_PushJson(ref->valuePath, timestamp, value);
+}
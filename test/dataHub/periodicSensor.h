@@ -0,0 +1,41 @@
+//--------------------------------------------------------------------------------------------------
+/** @file periodicSensor.h
+ *
+ * Host stand-in for the periodicSensor component of the Data Hub samples. The includer maps
+ * dhubIO_DataType_t to the data type of its Data Hub API.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_PERIODIC_SENSOR_INCLUDE_GUARD
+#define LEGATO_HOST_PERIODIC_SENSOR_INCLUDE_GUARD
+
+typedef struct psensor* psensor_Ref_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a periodic sensor: the "value" input, the "period" and "enable" outputs under name, and
+ * a timer calling sampleFunc every period while the sensor is enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+psensor_Ref_t psensor_Create
+(
+    const char* name,
+    dhubIO_DataType_t dataType,
+    const char* units,
+    void (*sampleFunc)(psensor_Ref_t ref, void* contextPtr),
+    void* contextPtr
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a sample to the "value" input of a periodic sensor
+ */
+//--------------------------------------------------------------------------------------------------
+void psensor_PushBoolean(psensor_Ref_t ref, double timestamp, bool value);
+void psensor_PushNumeric(psensor_Ref_t ref, double timestamp, double value);
+void psensor_PushString(psensor_Ref_t ref, double timestamp, const char* value);
+void psensor_PushJson(psensor_Ref_t ref, double timestamp, const char* value);
+
+#endif /* LEGATO_HOST_PERIODIC_SENSOR_INCLUDE_GUARD */
@@ -0,0 +1,403 @@
+//--------------------------------------------------------------------------------------------------
+/** @file dmBench.c
+ *
+ * Benchmark of the dm plugin on the simulated modem, with modem calls of increasing latency and
+ * with failing calls.
+ *
+ * For each setting of the modem, the time taken by the plugin to register its sensors (which
+ * samples the read-once ones) is reported, then its sensors are sampled at a period of
+ * DM_PERIOD seconds: the time spent in their sample callbacks per period and the failed samples
+ * are reported. All the sensors share the event loop, so a slow modem call delays the other
+ * sensors: a reference sensor, sampled every second by the framework, measures that delay and
+ * the samples it misses.
+ *
+ * The sensor components initialize once per process: every setting is run in a child process.
+ * Latencies are simulated with the accelerated clock, so the run takes far less than the
+ * simulated time.
+ *
+ * Usage: dmBench [seconds]
+ *
+ *  seconds     simulated duration of the measure of each setting, 3600 by default
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <math.h>
+#include <sys/wait.h>
+#include "interfaces.h"
+#include "sensorFw.h"
+#include "config.h"
+#include "dataHub.h"
+#include "modemSim.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Settings of the runs
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_DURATION        3600            ///< Simulated seconds
+#define DM_PERIOD               60              ///< Period of the DM sensors, in seconds
+#define DM_PLUGIN_NAME          "dm"
+#define LATE_THRESHOLD          0.01            ///< Delay of a late reference sample, in seconds
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference sensor
+ */
+//--------------------------------------------------------------------------------------------------
+#define REF_PERIOD              1
+#define REF_INFO                "{\"name\":\"ref\",\"path\":\"bench/ref\",\"unit\":\"C\"," \
+                                "\"period\":1}"
+
+void _sensorFw_COMPONENT_INIT(void);
+void _dmPlugin_COMPONENT_INIT(void);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Setting of the modem
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* namePtr;                        ///< Description
+    double latency;                             ///< Minimum duration of a call, in seconds
+    double jitter;                              ///< Maximum random extra duration, in seconds
+    int failurePercent;                         ///< Percentage of the calls that fail
+}
+scenario_t;
+
+static const scenario_t Scenarios[] =
+{
+    { "immediate modem",             0,    0,    0  },
+    { "50 ms calls",                 0.05, 0,    0  },
+    { "0.5-1 s calls",               0.5,  0.5,  0  },
+    { "0.5-1 s calls, 20% failing",  0.5,  0.5,  20 }
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Statistics of the sensors of the dm plugin
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t sampleCount;                       ///< Successful samples
+    uint64_t failureCount;                      ///< Failed samples
+    uint64_t callbackTimeUs;                    ///< Time spent in the sample callbacks
+    uint32_t callbackMaxUs;                     ///< Longest sample callback
+}
+dmStats_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Samples of the reference sensor
+ */
+//--------------------------------------------------------------------------------------------------
+static struct
+{
+    double firstTime;                           ///< Time of the first sample, < 0 if none yet
+    bool isMeasuring;                           ///< Are the samples accounted?
+    uint64_t count;                             ///< Samples accounted
+    uint64_t lateCount;                         ///< Samples later than LATE_THRESHOLD
+    double delaySum;                            ///< Sum of the delays
+    double delayMax;                            ///< Longest delay
+}
+Reference = { .firstTime = -1 };
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a monotonic clock
+ *
+ * @return:
+ *      - Time in nanoseconds
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetNs
+(
+    void
+)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample callback of the reference sensor: account the delay of the sample after the expiry of
+ * its timer, which keeps the phase of the first sample
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleReference
+(
+    double* valuePtr,                           ///< [OUT] Sample
+    size_t* lengthPtr,                          ///< [IN]  Unused
+    void* contextPtr                            ///< [IN]  Unused
+)
+{
+    double now = host_GetTime();
+
+    *valuePtr = 21.5;
+
+    if (Reference.firstTime < 0)
+    {
+        Reference.firstTime = now;
+    }
+    else if (Reference.isMeasuring)
+    {
+        double elapsed = now - Reference.firstTime;
+        double delay = fmax(0, elapsed - floor(elapsed / REF_PERIOD + 1e-3) * REF_PERIOD);
+
+        Reference.count++;
+        Reference.delaySum += delay;
+        Reference.delayMax = fmax(Reference.delayMax, delay);
+
+        if (delay > LATE_THRESHOLD)
+        {
+            Reference.lateCount++;
+        }
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sum the statistics of the sensors of the dm plugin
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetDmStats
+(
+    dmStats_t* statsPtr                         ///< [OUT] Statistics
+)
+{
+    char path[SENSORSTATS_MAX_PATH_LEN + 1];
+    char plugin[SENSORSTATS_MAX_PLUGIN_NAME_LEN + 1];
+    double period, age;
+    bool isEnabled;
+    uint32_t sampleCount, failureCount, callbackMaxUs, pushMaxUs;
+    uint64_t callbackTimeUs, pushTimeUs, bytesPushed;
+    uint32_t i;
+
+    memset(statsPtr, 0, sizeof(*statsPtr));
+
+    for (i = 0; i < sensorStats_GetCount(); i++)
+    {
+        if ((sensorStats_GetInfo(i, path, sizeof(path), plugin, sizeof(plugin), &period,
+                                 &isEnabled) == LE_OK) &&
+            (strcmp(plugin, DM_PLUGIN_NAME) == 0) &&
+            (sensorStats_GetStats(i, &age, &sampleCount, &failureCount, &callbackTimeUs,
+                                  &callbackMaxUs, &pushTimeUs, &pushMaxUs,
+                                  &bytesPushed) == LE_OK))
+        {
+            statsPtr->sampleCount += sampleCount;
+            statsPtr->failureCount += failureCount;
+            statsPtr->callbackTimeUs += callbackTimeUs;
+
+            if (callbackMaxUs > statsPtr->callbackMaxUs)
+            {
+                statsPtr->callbackMaxUs = callbackMaxUs;
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the period of the periodic sensors of the dm plugin
+ *
+ * @return:
+ *      - Number of periodic sensors
+ */
+//--------------------------------------------------------------------------------------------------
+static int SetDmPeriods
+(
+    double period                               ///< [IN] Period in seconds
+)
+{
+    char path[SENSORSTATS_MAX_PATH_LEN + 1];
+    char plugin[SENSORSTATS_MAX_PLUGIN_NAME_LEN + 1];
+    char resourcePath[128];
+    double currentPeriod, value;
+    bool isEnabled;
+    int count = 0;
+    uint32_t i;
+
+    for (i = 0; i < sensorStats_GetCount(); i++)
+    {
+        if ((sensorStats_GetInfo(i, path, sizeof(path), plugin, sizeof(plugin), &currentPeriod,
+                                 &isEnabled) != LE_OK) ||
+            (strcmp(plugin, DM_PLUGIN_NAME) != 0))
+        {
+            continue;
+        }
+
+        // Read-once sensors have no period.
+        snprintf(resourcePath, sizeof(resourcePath), DATAHUB_APP_ROOT "/%s/period", path);
+
+        if (dataHub_GetNumeric(resourcePath, &value) != LE_NOT_FOUND)
+        {
+            admin_PushNumeric(resourcePath, IO_NOW, period);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the dm plugin with a setting of the modem
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchScenario
+(
+    const scenario_t* scenarioPtr,              ///< [IN] Setting of the modem
+    double duration                             ///< [IN] Simulated seconds of the measure
+)
+{
+    sensorfwCallbacks_t callbacks = { 0 };
+    dmStats_t startStats, endStats;
+
+    // The failed samples are logged as errors.
+    host_SetLogLevel(LE_LOG_CRIT);
+
+    // The pressure of the host running the benchmark must not throttle the sensors.
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateWriteTxn("pressure");
+    le_cfg_SetBool(iteratorRef, "enable", false);
+    le_cfg_CommitTxn(iteratorRef);
+
+    host_SetAccelerated(true);
+    modemSim_SetLatency(scenarioPtr->latency, scenarioPtr->jitter);
+    modemSim_SetFailurePercent(scenarioPtr->failurePercent);
+
+    _sensorFw_COMPONENT_INIT();
+
+    callbacks.sample.numericCb = SampleReference;
+    LE_ASSERT(sensorFw_RegisterCallback(REF_INFO, SF_CB_NUMERIC, &callbacks, NULL, NULL) == LE_OK);
+    host_RunFor(REF_PERIOD * 1.5);
+
+    // Registration.
+    double startTime = host_GetTime();
+    uint64_t startNs = GetNs();
+
+    _dmPlugin_COMPONENT_INIT();
+
+    double registrationTime = host_GetTime() - startTime;
+    uint64_t registrationNs = GetNs() - startNs;
+    uint64_t registrationCalls = modemSim_GetCallCount();
+
+    int periodicCount = SetDmPeriods(DM_PERIOD);
+
+    // Measure from the second period, once the first samples are taken.
+    host_RunFor(DM_PERIOD);
+
+    GetDmStats(&startStats);
+    uint64_t callCount = modemSim_GetCallCount();
+    uint64_t modemFailureCount = modemSim_GetFailureCount();
+    double busyTime = modemSim_GetBusyTime();
+
+    Reference.isMeasuring = true;
+    startTime = host_GetTime();
+    startNs = GetNs();
+
+    host_RunFor(duration);
+
+    uint64_t elapsedNs = GetNs() - startNs;
+    double elapsedTime = host_GetTime() - startTime;
+
+    Reference.isMeasuring = false;
+    GetDmStats(&endStats);
+    callCount = modemSim_GetCallCount() - callCount;
+    modemFailureCount = modemSim_GetFailureCount() - modemFailureCount;
+    busyTime = modemSim_GetBusyTime() - busyTime;
+
+    double periodCount = elapsedTime / DM_PERIOD;
+    uint64_t sampleCount = endStats.sampleCount - startStats.sampleCount;
+    uint64_t failureCount = endStats.failureCount - startStats.failureCount;
+    double callbackTime = (endStats.callbackTimeUs - startStats.callbackTimeUs) / 1e6;
+    double expectedCount = elapsedTime / REF_PERIOD;
+
+    printf("%s:\n", scenarioPtr->namePtr);
+    printf("    registration: %.3f s (%" PRIu64 " modem calls), %.2f ms on the host\n",
+           registrationTime, registrationCalls, registrationNs / 1e6);
+    printf("    %d periodic sensors at %d s: %.3f s in sample callbacks per period, "
+           "%.1f%% of the loop; longest sample %.3f s\n",
+           periodicCount, DM_PERIOD, callbackTime / periodCount,
+           100 * callbackTime / elapsedTime, endStats.callbackMaxUs / 1e6);
+    printf("    %.1f modem calls per period, %.3f s waiting for the modem; "
+           "%" PRIu64 " samples, %" PRIu64 " failed (%" PRIu64 " failed calls); "
+           "%.1f us per period on the host\n",
+           callCount / periodCount, busyTime / periodCount, sampleCount, failureCount,
+           modemFailureCount, elapsedNs / 1e3 / periodCount);
+
+    if (Reference.count == 0)
+    {
+        printf("    reference sensor: no sample\n");
+    }
+    else
+    {
+        printf("    reference sensor: delay %.1f ms mean, %.1f ms max, %.2f%% late; "
+               "%.2f%% of the samples missed\n",
+               Reference.delaySum * 1000 / Reference.count, Reference.delayMax * 1000,
+               100.0 * Reference.lateCount / Reference.count,
+               100 * fmax(0, expectedCount - Reference.count) / expectedCount);
+    }
+
+    if (modemSim_GetFixRefCount() != 0)
+    {
+        printf("    %d GNSS fixes not released\n", modemSim_GetFixRefCount());
+    }
+}
+
+int main
+(
+    int argc,
+    char** argv
+)
+{
+    double duration = (argc > 1) ? atof(argv[1]) : DEFAULT_DURATION;
+    int status = EXIT_SUCCESS;
+    int i;
+
+    if (duration < DM_PERIOD)
+    {
+        fprintf(stderr, "Usage: %s [seconds], at least %d\n", argv[0], DM_PERIOD);
+        return EXIT_FAILURE;
+    }
+
+    host_UseTempDir();
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(Scenarios); i++)
+    {
+        int childStatus;
+
+        fflush(stdout);
+
+        pid_t pid = fork();
+
+        LE_FATAL_IF(pid < 0, "fork failed: %m");
+
+        if (pid == 0)
+        {
+            // Start cold, whatever the previous setting left.
+            unlink(SENSOR_CHECKPOINT_PATH);
+
+            BenchScenario(&Scenarios[i], duration);
+            fflush(stdout);
+            _exit(EXIT_SUCCESS);
+        }
+
+        if ((waitpid(pid, &childStatus, 0) != pid) || !WIFEXITED(childStatus) ||
+            (WEXITSTATUS(childStatus) != EXIT_SUCCESS))
+        {
+            fprintf(stderr, "%s: run failed\n", Scenarios[i].namePtr);
+            status = EXIT_FAILURE;
+        }
+    }
+
+    return status;
+}
@@ -0,0 +1,293 @@
+//--------------------------------------------------------------------------------------------------
+/** @file fusionBench.c
+ *
+ * Benchmark of the IMU orientation filter of the iio plugin on the simulated IIO backend.
+ *
+ * The filter is first run alone on the readings of the simulated IMUs, with and without the
+ * magnetometer: the time per update, the heap growth while updating and the orientation error
+ * against the known motion are reported. The iio plugin is then run on the event loop with its
+ * filters updated at their maximum rate, to measure the cost of an update including the reads
+ * of the IMU channels.
+ *
+ * Usage: fusionBench [seconds]
+ *
+ *  seconds     simulated duration of each run, 600 by default
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <math.h>
+#include <malloc.h>
+#include "interfaces.h"
+#include "sensorFw.h"
+#include "dataHub.h"
+#include "imuFusion.h"
+#include "iioSim.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Settings of the runs
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_DURATION        600             ///< Simulated seconds
+#define FILTER_RATE_HZ          400             ///< Maximum update rate of the plugin
+#define FILTER_BETA             0.1             ///< Default gain of the plugin
+#define CHUNK_SIZE              4000            ///< Updates timed at once, between error checks
+#define SETTLING_TIME           10              ///< Seconds before the error is accounted
+
+void _sensorFw_COMPONENT_INIT(void);
+void _iioChannel_COMPONENT_INIT(void);
+void _iioPlugin_COMPONENT_INIT(void);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Readings of one chunk of updates
+ */
+//--------------------------------------------------------------------------------------------------
+static double Gyro[CHUNK_SIZE][3];
+static double Accel[CHUNK_SIZE][3];
+static double Magn[CHUNK_SIZE][3];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a monotonic clock
+ *
+ * @return:
+ *      - Time in nanoseconds
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetNs
+(
+    void
+)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the bytes allocated on the heap
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetHeapInUse
+(
+    void
+)
+{
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return (unsigned int)mallinfo().uordblks;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the error of an estimated orientation
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetError
+(
+    const double estimate[4],                   ///< [IN]  Estimated orientation
+    const double truth[4],                      ///< [IN]  True orientation
+    double* tiltPtr,                            ///< [OUT] Error of the vertical, in degrees
+    double* headingPtr                          ///< [OUT] Error of the heading, in degrees
+)
+{
+    double up[2][3];
+    double yaw[2];
+    const double* q[2] = { estimate, truth };
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        // Vertical of the earth frame in the frame of the IMU, and heading.
+        up[i][0] = 2 * (q[i][1] * q[i][3] - q[i][0] * q[i][2]);
+        up[i][1] = 2 * (q[i][0] * q[i][1] + q[i][2] * q[i][3]);
+        up[i][2] = q[i][0] * q[i][0] - q[i][1] * q[i][1] - q[i][2] * q[i][2] + q[i][3] * q[i][3];
+        yaw[i] = atan2(2 * (q[i][0] * q[i][3] + q[i][1] * q[i][2]),
+                       1 - 2 * (q[i][2] * q[i][2] + q[i][3] * q[i][3]));
+    }
+
+    double dot = up[0][0] * up[1][0] + up[0][1] * up[1][1] + up[0][2] * up[1][2];
+
+    *tiltPtr = acos(fmin(1, fmax(-1, dot))) * 180 / M_PI;
+    *headingPtr = fabs(remainder(yaw[0] - yaw[1], 2 * M_PI)) * 180 / M_PI;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the filter alone on the simulated readings
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchFilter
+(
+    bool hasMagn,                               ///< [IN] Is the magnetometer used?
+    double duration                             ///< [IN] Simulated seconds
+)
+{
+    imuFusion_State_t filter;
+    double dt = 1.0 / FILTER_RATE_HZ;
+    uint64_t updateCount = 0;
+    uint64_t elapsedNs = 0;
+    long heapGrowth = 0;
+    double tiltSum = 0, tiltMax = 0, headingSum = 0, headingMax = 0;
+    int checkCount = 0;
+    double time = 0;
+    int i;
+
+    imuFusion_Init(&filter, FILTER_BETA);
+
+    while (time < duration)
+    {
+        for (i = 0; i < CHUNK_SIZE; i++)
+        {
+            iioSim_GetReadings(time + (i + 1) * dt, Gyro[i], Accel[i], Magn[i]);
+        }
+
+        size_t heapBefore = GetHeapInUse();
+        uint64_t startNs = GetNs();
+
+        for (i = 0; i < CHUNK_SIZE; i++)
+        {
+            imuFusion_Update(&filter, Gyro[i], Accel[i], hasMagn ? Magn[i] : NULL, dt);
+        }
+
+        elapsedNs += GetNs() - startNs;
+        heapGrowth += (long)(GetHeapInUse() - heapBefore);
+        updateCount += CHUNK_SIZE;
+        time += CHUNK_SIZE * dt;
+
+        double truth[4], tilt, heading;
+
+        iioSim_GetOrientation(time, truth);
+        GetError(filter.q, truth, &tilt, &heading);
+
+        if (time >= SETTLING_TIME)
+        {
+            tiltSum += tilt;
+            tiltMax = fmax(tiltMax, tilt);
+            headingSum += heading;
+            headingMax = fmax(headingMax, heading);
+            checkCount++;
+        }
+    }
+
+    printf("filter %s magn: %" PRIu64 " updates, %.0f ns/update (%.2f M updates/s), "
+           "heap growth %ld bytes\n",
+           hasMagn ? "with" : "without", updateCount, (double)elapsedNs / updateCount,
+           updateCount * 1000.0 / elapsedNs, heapGrowth);
+
+    if (checkCount > 0)
+    {
+        printf("    error over %.0f s: tilt %.2f deg mean, %.2f max; heading %.2f deg mean, "
+               "%.2f max%s\n",
+               time, tiltSum / checkCount, tiltMax, headingSum / checkCount, headingMax,
+               hasMagn ? "" : " (not observable, gyro drift)");
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of filter updates of an IMU of the plugin: the reads of its x gyro channel,
+ * which are not samples of the channel itself pushed to the Data Hub
+ *
+ * @return:
+ *      - Number of updates
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetUpdateCount
+(
+    const char* deviceNamePtr                   ///< [IN] Name of the IMU
+)
+{
+    char valuePath[64];
+
+    snprintf(valuePath, sizeof(valuePath), DATAHUB_APP_ROOT "/%s/anglvel_x/value", deviceNamePtr);
+
+    return iioSim_GetReadCount(deviceNamePtr, "anglvel_x") - dataHub_GetPushCount(valuePath);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the iio plugin with its filters updated at their maximum rate
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchPlugin
+(
+    double duration                             ///< [IN] Simulated seconds
+)
+{
+    char config[64];
+
+    // The pressure of the host running the benchmark must not throttle the sensors.
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateWriteTxn("pressure");
+    le_cfg_SetBool(iteratorRef, "enable", false);
+    le_cfg_CommitTxn(iteratorRef);
+
+    host_SetAccelerated(true);
+
+    _sensorFw_COMPONENT_INIT();
+    _iioChannel_COMPONENT_INIT();
+    _iioPlugin_COMPONENT_INIT();
+
+    snprintf(config, sizeof(config), "{\"rate\":%d}", FILTER_RATE_HZ);
+    admin_PushJson(DATAHUB_APP_ROOT "/imu0/orientation/config", IO_NOW, config);
+    admin_PushJson(DATAHUB_APP_ROOT "/imu1/orientation/config", IO_NOW, config);
+    host_RunFor(1);
+
+    uint64_t updateCount = GetUpdateCount("imu0") + GetUpdateCount("imu1");
+    uint64_t attrReadCount = iioSim_GetAttrReadCount();
+    double startTime = host_GetTime();
+    uint64_t startNs = GetNs();
+
+    host_RunFor(duration);
+
+    uint64_t elapsedNs = GetNs() - startNs;
+    double elapsedTime = host_GetTime() - startTime;
+
+    updateCount = GetUpdateCount("imu0") + GetUpdateCount("imu1") - updateCount;
+    attrReadCount = iioSim_GetAttrReadCount() - attrReadCount;
+
+    if (updateCount == 0)
+    {
+        printf("plugin: no filter update\n");
+        return;
+    }
+
+    printf("plugin: %" PRIu64 " updates of 2 filters in %.0f s (%.0f Hz each), "
+           "%.1f attribute reads/update\n",
+           updateCount, elapsedTime, updateCount / elapsedTime / 2,
+           (double)attrReadCount / updateCount);
+    printf("    %.0f ns/update on the event loop, including the channel reads and the "
+           "sampling of the other sensors\n",
+           (double)elapsedNs / updateCount);
+}
+
+int main
+(
+    int argc,
+    char** argv
+)
+{
+    double duration = (argc > 1) ? atof(argv[1]) : DEFAULT_DURATION;
+
+    if (duration <= 0)
+    {
+        fprintf(stderr, "Usage: %s [seconds]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    host_UseTempDir();
+
+    BenchFilter(true, duration);
+    BenchFilter(false, duration);
+    BenchPlugin(duration);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+//--------------------------------------------------------------------------------------------------
+/** @file iio.h
+ *
+ * Host stand-in for the subset of libiio used by the iio plugin, implemented by the simulated
+ * backend of iioSim.c. The declarations follow libiio 0.18.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_IIO_INCLUDE_GUARD
+#define LEGATO_HOST_IIO_INCLUDE_GUARD
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+struct iio_context;
+struct iio_device;
+struct iio_channel;
+struct iio_buffer;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Format of the samples of a channel in a buffer
+ */
+//--------------------------------------------------------------------------------------------------
+struct iio_data_format
+{
+    unsigned int length;
+    unsigned int bits;
+    unsigned int shift;
+    bool is_signed;
+    bool is_fully_defined;
+    bool is_be;
+    bool with_scale;
+    double scale;
+    unsigned int repeat;
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Contexts
+ */
+//--------------------------------------------------------------------------------------------------
+struct iio_context* iio_create_local_context(void);
+struct iio_context* iio_create_context_from_uri(const char* uri);
+void iio_context_destroy(struct iio_context* ctx);
+int iio_context_set_timeout(struct iio_context* ctx, unsigned int timeout_ms);
+unsigned int iio_context_get_devices_count(const struct iio_context* ctx);
+struct iio_device* iio_context_get_device(const struct iio_context* ctx, unsigned int index);
+struct iio_device* iio_context_find_device(const struct iio_context* ctx, const char* name);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Devices
+ */
+//--------------------------------------------------------------------------------------------------
+const char* iio_device_get_name(const struct iio_device* dev);
+unsigned int iio_device_get_channels_count(const struct iio_device* dev);
+struct iio_channel* iio_device_get_channel(const struct iio_device* dev, unsigned int index);
+struct iio_channel* iio_device_find_channel(const struct iio_device* dev, const char* name,
+                                            bool output);
+bool iio_device_is_trigger(const struct iio_device* dev);
+int iio_device_set_trigger(const struct iio_device* dev, const struct iio_device* trigger);
+ssize_t iio_device_attr_write(const struct iio_device* dev, const char* attr, const char* src);
+struct iio_buffer* iio_device_create_buffer(const struct iio_device* dev, size_t samples_count,
+                                            bool cyclic);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Channels
+ */
+//--------------------------------------------------------------------------------------------------
+typedef int (*iio_channel_attr_cb_t)(struct iio_channel* chn, const char* attr, const char* val,
+                                     size_t len, void* d);
+
+const char* iio_channel_get_id(const struct iio_channel* chn);
+bool iio_channel_is_output(const struct iio_channel* chn);
+bool iio_channel_is_scan_element(const struct iio_channel* chn);
+const char* iio_channel_find_attr(const struct iio_channel* chn, const char* name);
+ssize_t iio_channel_attr_read(const struct iio_channel* chn, const char* attr, char* dst,
+                              size_t len);
+int iio_channel_attr_read_all(struct iio_channel* chn, iio_channel_attr_cb_t cb, void* data);
+ssize_t iio_channel_attr_write(const struct iio_channel* chn, const char* attr, const char* src);
+void iio_channel_enable(struct iio_channel* chn);
+const struct iio_data_format* iio_channel_get_data_format(const struct iio_channel* chn);
+void iio_channel_convert(const struct iio_channel* chn, void* dst, const void* src);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Buffers
+ */
+//--------------------------------------------------------------------------------------------------
+ssize_t iio_buffer_refill(struct iio_buffer* buf);
+void* iio_buffer_first(const struct iio_buffer* buf, const struct iio_channel* chn);
+void* iio_buffer_end(const struct iio_buffer* buf);
+ptrdiff_t iio_buffer_step(const struct iio_buffer* buf);
+
+#endif /* LEGATO_HOST_IIO_INCLUDE_GUARD */
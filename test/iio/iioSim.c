@@ -0,0 +1,886 @@
+//--------------------------------------------------------------------------------------------------
+/** @file iioSim.c
+ *
+ * Simulated IIO backend of the host tests, behind the libiio API.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <math.h>
+#include "iio.h"
+#include "iioSim.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Motion of the simulated IMUs: a turn around the vertical axis per minute, with roll and pitch
+ * oscillations
+ */
+//--------------------------------------------------------------------------------------------------
+#define YAW_RATE                (2 * M_PI / 60)         ///< Radians per second
+#define ROLL_AMPLITUDE          (20 * M_PI / 180)       ///< Radians
+#define ROLL_FREQUENCY          0.1                     ///< Hz
+#define PITCH_AMPLITUDE         (10 * M_PI / 180)       ///< Radians
+#define PITCH_FREQUENCY         0.07                    ///< Hz
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Environment of the simulated IMUs, in the earth frame (x to the magnetic north, z up)
+ */
+//--------------------------------------------------------------------------------------------------
+#define GRAVITY                 9.80665                 ///< m/s^2
+#define MAGN_NORTH              0.2                     ///< Gauss
+#define MAGN_UP                 (-0.4)                  ///< Gauss
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Noise of the readings (standard deviation)
+ */
+//--------------------------------------------------------------------------------------------------
+#define ACCEL_NOISE             0.03                    ///< m/s^2
+#define ANGLVEL_NOISE           0.003                   ///< Radians per second
+#define MAGN_NOISE              0.003                   ///< Gauss
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scales of the raw values of the channels, as the drivers report them
+ */
+//--------------------------------------------------------------------------------------------------
+#define ACCEL_SCALE             "0.000598"              ///< +/-2 g on 16 bits
+#define ANGLVEL_SCALE           "0.000133"              ///< +/-250 dps on 16 bits
+#define MAGN_SCALE              "0.000100"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of an attribute value
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_ATTR_LEN            64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Kinds of simulated channels
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    SIM_ACCEL,
+    SIM_ANGLVEL,
+    SIM_MAGN,
+    SIM_TEMP,
+    SIM_TIMESTAMP,
+    SIM_KIND_COUNT
+}
+simKind_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Description of the channels and devices
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* id;                                     ///< Id of the channel
+    simKind_t kind;                                     ///< Kind of channel
+    int axis;                                           ///< Axis of a vector channel
+}
+channelSpec_t;
+
+typedef struct
+{
+    const char* name;                                   ///< Name of the device
+    const channelSpec_t* channels;                      ///< Channels
+    unsigned int channelCount;                          ///< Number of channels
+}
+deviceSpec_t;
+
+static const channelSpec_t Imu0Channels[] =
+{
+    { "accel_x",   SIM_ACCEL,     0 },
+    { "accel_y",   SIM_ACCEL,     1 },
+    { "accel_z",   SIM_ACCEL,     2 },
+    { "anglvel_x", SIM_ANGLVEL,   0 },
+    { "anglvel_y", SIM_ANGLVEL,   1 },
+    { "anglvel_z", SIM_ANGLVEL,   2 },
+    { "magn_x",    SIM_MAGN,      0 },
+    { "magn_y",    SIM_MAGN,      1 },
+    { "magn_z",    SIM_MAGN,      2 },
+    { "timestamp", SIM_TIMESTAMP, 0 }
+};
+
+static const channelSpec_t Imu1Channels[] =
+{
+    { "accel_x",   SIM_ACCEL,     0 },
+    { "accel_y",   SIM_ACCEL,     1 },
+    { "accel_z",   SIM_ACCEL,     2 },
+    { "anglvel_x", SIM_ANGLVEL,   0 },
+    { "anglvel_y", SIM_ANGLVEL,   1 },
+    { "anglvel_z", SIM_ANGLVEL,   2 },
+    { "timestamp", SIM_TIMESTAMP, 0 }
+};
+
+static const channelSpec_t Temp0Channels[] =
+{
+    { "temp",      SIM_TEMP,      0 }
+};
+
+static const deviceSpec_t Devices[] =
+{
+    { "imu0",  Imu0Channels,  NUM_ARRAY_MEMBERS(Imu0Channels) },
+    { "imu1",  Imu1Channels,  NUM_ARRAY_MEMBERS(Imu1Channels) },
+    { "temp0", Temp0Channels, NUM_ARRAY_MEMBERS(Temp0Channels) }
+};
+
+#define DEVICE_COUNT            NUM_ARRAY_MEMBERS(Devices)
+#define MAX_DEVICE_CHANNELS     NUM_ARRAY_MEMBERS(Imu0Channels)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Attributes of the channels of each kind, the value attribute first
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* const AccelAttrs[] =
+{
+    "raw", "scale", "scale_available", "sampling_frequency", "sampling_frequency_available", NULL
+};
+static const char* const AnglvelAttrs[] = { "raw", "scale", "sampling_frequency", NULL };
+static const char* const MagnAttrs[] = { "raw", "scale", NULL };
+static const char* const TempAttrs[] = { "input", NULL };
+static const char* const TimestampAttrs[] = { NULL };
+
+static const char* const* const KindAttrs[SIM_KIND_COUNT] =
+{
+    AccelAttrs, AnglvelAttrs, MagnAttrs, TempAttrs, TimestampAttrs
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Format of the samples of the channels in a buffer
+ */
+//--------------------------------------------------------------------------------------------------
+static const struct iio_data_format DataFormat = { 16, 16, 0, true, true, false, false, 1, 1 };
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Channel, device and context
+ */
+//--------------------------------------------------------------------------------------------------
+struct iio_channel
+{
+    const channelSpec_t* specPtr;                       ///< Description
+    unsigned int deviceIndex;                           ///< Index of the device
+    unsigned int index;                                 ///< Index in the device
+    bool isEnabled;                                     ///< Enabled for buffered captures?
+};
+
+struct iio_device
+{
+    const deviceSpec_t* specPtr;                        ///< Description
+    struct iio_channel channels[MAX_DEVICE_CHANNELS];   ///< Channels
+};
+
+struct iio_context
+{
+    struct iio_device devices[DEVICE_COUNT];            ///< Devices
+    unsigned int timeoutMs;                             ///< Timeout of the operations
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Statistics of the backend, for all the contexts
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t ReadCounts[DEVICE_COUNT][MAX_DEVICE_CHANNELS];
+static uint64_t AttrReadCount;
+static int ContextCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of the noise generator (xorshift64*)
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t NoiseState = 0x9E3779B97F4A7C15ULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Draw a normally distributed number
+ *
+ * @return:
+ *      - Number of mean 0 and standard deviation 1
+ */
+//--------------------------------------------------------------------------------------------------
+static double DrawNormal
+(
+    void
+)
+{
+    double uniform[2];
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        NoiseState ^= NoiseState >> 12;
+        NoiseState ^= NoiseState << 25;
+        NoiseState ^= NoiseState >> 27;
+        uniform[i] = ((NoiseState * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Box-Muller transform, away from log(0).
+    return sqrt(-2 * log(1 - uniform[0])) * cos(2 * M_PI * uniform[1]);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the Euler angles of the motion and their derivatives
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetMotion
+(
+    double time,                        ///< [IN]  Relative time in seconds
+    double angles[3],                   ///< [OUT] Roll, pitch and yaw in radians
+    double rates[3]                     ///< [OUT] Their derivatives in radians per second
+)
+{
+    double rollPhase = 2 * M_PI * ROLL_FREQUENCY * time;
+    double pitchPhase = 2 * M_PI * PITCH_FREQUENCY * time;
+
+    angles[0] = ROLL_AMPLITUDE * sin(rollPhase);
+    angles[1] = PITCH_AMPLITUDE * sin(pitchPhase);
+    angles[2] = remainder(YAW_RATE * time, 2 * M_PI);
+
+    rates[0] = ROLL_AMPLITUDE * 2 * M_PI * ROLL_FREQUENCY * cos(rollPhase);
+    rates[1] = PITCH_AMPLITUDE * 2 * M_PI * PITCH_FREQUENCY * cos(pitchPhase);
+    rates[2] = YAW_RATE;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Express a vector of the earth frame in the frame of the IMU
+ */
+//--------------------------------------------------------------------------------------------------
+static void ToBodyFrame
+(
+    const double angles[3],             ///< [IN]  Roll, pitch and yaw in radians
+    const double earth[3],              ///< [IN]  Vector in the earth frame
+    double body[3]                      ///< [OUT] Vector in the frame of the IMU
+)
+{
+    double cr = cos(angles[0]), sr = sin(angles[0]);
+    double cp = cos(angles[1]), sp = sin(angles[1]);
+    double cy = cos(angles[2]), sy = sin(angles[2]);
+
+    // Inverse of the yaw, pitch then roll rotations.
+    double x1 = cy * earth[0] + sy * earth[1];
+    double y1 = -sy * earth[0] + cy * earth[1];
+    double z1 = earth[2];
+    double x2 = cp * x1 - sp * z1;
+    double z2 = sp * x1 + cp * z1;
+
+    body[0] = x2;
+    body[1] = cr * y1 + sr * z2;
+    body[2] = -sr * y1 + cr * z2;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the exact value measured by a channel at a time
+ *
+ * @return:
+ *      - Value, in the unit of the channel after scaling
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetTrueValue
+(
+    simKind_t kind,                     ///< [IN] Kind of channel
+    int axis,                           ///< [IN] Axis of a vector channel
+    double time                         ///< [IN] Relative time in seconds
+)
+{
+    static const double gravity[3] = { 0, 0, GRAVITY };
+    static const double field[3] = { MAGN_NORTH, 0, MAGN_UP };
+    double angles[3], rates[3], body[3];
+
+    GetMotion(time, angles, rates);
+
+    switch (kind)
+    {
+        case SIM_ACCEL:
+            ToBodyFrame(angles, gravity, body);
+            return body[axis];
+
+        case SIM_MAGN:
+            ToBodyFrame(angles, field, body);
+            return body[axis];
+
+        case SIM_ANGLVEL:
+        {
+            double cr = cos(angles[0]), sr = sin(angles[0]);
+            double cp = cos(angles[1]), sp = sin(angles[1]);
+
+            // Body rates of the roll, pitch and yaw rates.
+            double p = rates[0] - rates[2] * sp;
+            double q = rates[1] * cr + rates[2] * sr * cp;
+            double r = -rates[1] * sr + rates[2] * cr * cp;
+
+            return (axis == 0) ? p : ((axis == 1) ? q : r);
+        }
+
+        case SIM_TEMP:
+            // Milli degrees, with a daily cycle.
+            return 23000 + 3000 * sin(2 * M_PI * time / 86400);
+
+        default:
+            return 0;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the scale of the raw values of a channel
+ *
+ * @return:
+ *      - Scale, NULL if the values are processed
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* GetScale
+(
+    simKind_t kind                      ///< [IN] Kind of channel
+)
+{
+    switch (kind)
+    {
+        case SIM_ACCEL:     return ACCEL_SCALE;
+        case SIM_ANGLVEL:   return ANGLVEL_SCALE;
+        case SIM_MAGN:      return MAGN_SCALE;
+        default:            return NULL;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a channel as its driver would: noisy, and quantized if the channel is not processed
+ *
+ * @return:
+ *      - Raw value, or processed value
+ */
+//--------------------------------------------------------------------------------------------------
+static double Measure
+(
+    simKind_t kind,                     ///< [IN] Kind of channel
+    int axis,                           ///< [IN] Axis of a vector channel
+    double time                         ///< [IN] Relative time in seconds
+)
+{
+    double value = GetTrueValue(kind, axis, time);
+    const char* scalePtr = GetScale(kind);
+
+    switch (kind)
+    {
+        case SIM_ACCEL:     value += ACCEL_NOISE * DrawNormal();    break;
+        case SIM_ANGLVEL:   value += ANGLVEL_NOISE * DrawNormal();  break;
+        case SIM_MAGN:      value += MAGN_NOISE * DrawNormal();     break;
+        default:                                                    break;
+    }
+
+    return (scalePtr != NULL) ? round(value / atof(scalePtr)) : round(value);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current relative time
+ *
+ * @return:
+ *      - Time in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetTime
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return now.sec + (now.usec / 1000000.0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Format the value of an attribute of a channel
+ *
+ * @return:
+ *      - Length of the value, negative errno if the channel does not have the attribute
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t FormatAttr
+(
+    const struct iio_channel* chn,      ///< [IN]  Channel
+    const char* attr,                   ///< [IN]  Attribute
+    char* dst,                          ///< [OUT] Value
+    size_t len                          ///< [IN]  Size of the value buffer
+)
+{
+    simKind_t kind = chn->specPtr->kind;
+    int res;
+
+    if (iio_channel_find_attr(chn, attr) == NULL)
+    {
+        return -ENOENT;
+    }
+
+    AttrReadCount++;
+
+    if ((strcmp(attr, "raw") == 0) || (strcmp(attr, "input") == 0))
+    {
+        ReadCounts[chn->deviceIndex][chn->index]++;
+        res = snprintf(dst, len, "%.0f", Measure(kind, chn->specPtr->axis, GetTime()));
+    }
+    else if (strcmp(attr, "scale") == 0)
+    {
+        res = snprintf(dst, len, "%s", GetScale(kind));
+    }
+    else if (strcmp(attr, "scale_available") == 0)
+    {
+        res = snprintf(dst, len, "0.000598 0.001197 0.002394 0.004788");
+    }
+    else if (strcmp(attr, "sampling_frequency") == 0)
+    {
+        res = snprintf(dst, len, "100");
+    }
+    else
+    {
+        res = snprintf(dst, len, "12.5 25 50 100 200 400");
+    }
+
+    return ((res < 0) || ((size_t)res >= len)) ? -ENOMEM : res;
+}
+
+void iioSim_GetOrientation
+(
+    double time,
+    double q[4]
+)
+{
+    double angles[3], rates[3];
+
+    GetMotion(time, angles, rates);
+
+    double cr = cos(angles[0] / 2), sr = sin(angles[0] / 2);
+    double cp = cos(angles[1] / 2), sp = sin(angles[1] / 2);
+    double cy = cos(angles[2] / 2), sy = sin(angles[2] / 2);
+
+    q[0] = cr * cp * cy + sr * sp * sy;
+    q[1] = sr * cp * cy - cr * sp * sy;
+    q[2] = cr * sp * cy + sr * cp * sy;
+    q[3] = cr * cp * sy - sr * sp * cy;
+}
+
+void iioSim_GetReadings
+(
+    double time,
+    double gyro[3],
+    double accel[3],
+    double magn[3]
+)
+{
+    int axis;
+
+    for (axis = 0; axis < 3; axis++)
+    {
+        gyro[axis] = Measure(SIM_ANGLVEL, axis, time) * atof(ANGLVEL_SCALE);
+        accel[axis] = Measure(SIM_ACCEL, axis, time) * atof(ACCEL_SCALE);
+        magn[axis] = Measure(SIM_MAGN, axis, time) * atof(MAGN_SCALE);
+    }
+}
+
+uint64_t iioSim_GetReadCount
+(
+    const char* deviceNamePtr,
+    const char* channelIdPtr
+)
+{
+    unsigned int i, j;
+
+    for (i = 0; i < DEVICE_COUNT; i++)
+    {
+        if (strcmp(Devices[i].name, deviceNamePtr) != 0)
+        {
+            continue;
+        }
+
+        for (j = 0; j < Devices[i].channelCount; j++)
+        {
+            if (strcmp(Devices[i].channels[j].id, channelIdPtr) == 0)
+            {
+                return ReadCounts[i][j];
+            }
+        }
+    }
+
+    return 0;
+}
+
+uint64_t iioSim_GetAttrReadCount
+(
+    void
+)
+{
+    return AttrReadCount;
+}
+
+int iioSim_GetContextCount
+(
+    void
+)
+{
+    return ContextCount;
+}
+
+struct iio_context* iio_create_local_context
+(
+    void
+)
+{
+    struct iio_context* ctx = calloc(1, sizeof(struct iio_context));
+    unsigned int i, j;
+
+    if (ctx == NULL)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    for (i = 0; i < DEVICE_COUNT; i++)
+    {
+        ctx->devices[i].specPtr = &Devices[i];
+
+        for (j = 0; j < Devices[i].channelCount; j++)
+        {
+            ctx->devices[i].channels[j].specPtr = &Devices[i].channels[j];
+            ctx->devices[i].channels[j].deviceIndex = i;
+            ctx->devices[i].channels[j].index = j;
+        }
+    }
+
+    ContextCount++;
+    return ctx;
+}
+
+struct iio_context* iio_create_context_from_uri
+(
+    const char* uri
+)
+{
+    if (strncmp(uri, "sim:", 4) != 0)
+    {
+        errno = ENOENT;
+        return NULL;
+    }
+
+    return iio_create_local_context();
+}
+
+void iio_context_destroy
+(
+    struct iio_context* ctx
+)
+{
+    ContextCount--;
+    free(ctx);
+}
+
+int iio_context_set_timeout
+(
+    struct iio_context* ctx,
+    unsigned int timeout_ms
+)
+{
+    ctx->timeoutMs = timeout_ms;
+    return 0;
+}
+
+unsigned int iio_context_get_devices_count
+(
+    const struct iio_context* ctx
+)
+{
+    return DEVICE_COUNT;
+}
+
+struct iio_device* iio_context_get_device
+(
+    const struct iio_context* ctx,
+    unsigned int index
+)
+{
+    if (index >= DEVICE_COUNT)
+    {
+        return NULL;
+    }
+
+    return (struct iio_device*)&ctx->devices[index];
+}
+
+struct iio_device* iio_context_find_device
+(
+    const struct iio_context* ctx,
+    const char* name
+)
+{
+    unsigned int i;
+
+    for (i = 0; i < DEVICE_COUNT; i++)
+    {
+        if (strcmp(Devices[i].name, name) == 0)
+        {
+            return (struct iio_device*)&ctx->devices[i];
+        }
+    }
+
+    return NULL;
+}
+
+const char* iio_device_get_name
+(
+    const struct iio_device* dev
+)
+{
+    return dev->specPtr->name;
+}
+
+unsigned int iio_device_get_channels_count
+(
+    const struct iio_device* dev
+)
+{
+    return dev->specPtr->channelCount;
+}
+
+struct iio_channel* iio_device_get_channel
+(
+    const struct iio_device* dev,
+    unsigned int index
+)
+{
+    if (index >= dev->specPtr->channelCount)
+    {
+        return NULL;
+    }
+
+    return (struct iio_channel*)&dev->channels[index];
+}
+
+struct iio_channel* iio_device_find_channel
+(
+    const struct iio_device* dev,
+    const char* name,
+    bool output
+)
+{
+    unsigned int i;
+
+    for (i = 0; (i < dev->specPtr->channelCount) && !output; i++)
+    {
+        if (strcmp(dev->specPtr->channels[i].id, name) == 0)
+        {
+            return (struct iio_channel*)&dev->channels[i];
+        }
+    }
+
+    return NULL;
+}
+
+bool iio_device_is_trigger
+(
+    const struct iio_device* dev
+)
+{
+    return false;
+}
+
+int iio_device_set_trigger
+(
+    const struct iio_device* dev,
+    const struct iio_device* trigger
+)
+{
+    return -ENOSYS;
+}
+
+ssize_t iio_device_attr_write
+(
+    const struct iio_device* dev,
+    const char* attr,
+    const char* src
+)
+{
+    return -ENOSYS;
+}
+
+struct iio_buffer* iio_device_create_buffer
+(
+    const struct iio_device* dev,
+    size_t samples_count,
+    bool cyclic
+)
+{
+    errno = ENOSYS;
+    return NULL;
+}
+
+const char* iio_channel_get_id
+(
+    const struct iio_channel* chn
+)
+{
+    return chn->specPtr->id;
+}
+
+bool iio_channel_is_output
+(
+    const struct iio_channel* chn
+)
+{
+    return false;
+}
+
+bool iio_channel_is_scan_element
+(
+    const struct iio_channel* chn
+)
+{
+    return (chn->specPtr->kind != SIM_TEMP);
+}
+
+const char* iio_channel_find_attr
+(
+    const struct iio_channel* chn,
+    const char* name
+)
+{
+    const char* const* attrPtr;
+
+    for (attrPtr = KindAttrs[chn->specPtr->kind]; *attrPtr != NULL; attrPtr++)
+    {
+        if (strcmp(*attrPtr, name) == 0)
+        {
+            return *attrPtr;
+        }
+    }
+
+    return NULL;
+}
+
+ssize_t iio_channel_attr_read
+(
+    const struct iio_channel* chn,
+    const char* attr,
+    char* dst,
+    size_t len
+)
+{
+    ssize_t length = FormatAttr(chn, attr, dst, len);
+
+    // Counting the terminating null character, as libiio does.
+    return (length < 0) ? length : (length + 1);
+}
+
+int iio_channel_attr_read_all
+(
+    struct iio_channel* chn,
+    iio_channel_attr_cb_t cb,
+    void* data
+)
+{
+    const char* const* attrPtr;
+    char value[MAX_ATTR_LEN];
+
+    for (attrPtr = KindAttrs[chn->specPtr->kind]; *attrPtr != NULL; attrPtr++)
+    {
+        ssize_t length = FormatAttr(chn, *attrPtr, value, sizeof(value));
+
+        if (length < 0)
+        {
+            return (int)length;
+        }
+
+        int result = cb(chn, *attrPtr, value, length, data);
+
+        if (result != 0)
+        {
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+ssize_t iio_channel_attr_write
+(
+    const struct iio_channel* chn,
+    const char* attr,
+    const char* src
+)
+{
+    // The attributes of the simulated channels are read-only.
+    return (iio_channel_find_attr(chn, attr) != NULL) ? -EACCES : -ENOENT;
+}
+
+void iio_channel_enable
+(
+    struct iio_channel* chn
+)
+{
+    chn->isEnabled = true;
+}
+
+const struct iio_data_format* iio_channel_get_data_format
+(
+    const struct iio_channel* chn
+)
+{
+    return &DataFormat;
+}
+
+void iio_channel_convert
+(
+    const struct iio_channel* chn,
+    void* dst,
+    const void* src
+)
+{
+    memcpy(dst, src, DataFormat.length / 8);
+}
+
+ssize_t iio_buffer_refill
+(
+    struct iio_buffer* buf
+)
+{
+    return -ENOSYS;
+}
+
+void* iio_buffer_first
+(
+    const struct iio_buffer* buf,
+    const struct iio_channel* chn
+)
+{
+    return NULL;
+}
+
+void* iio_buffer_end
+(
+    const struct iio_buffer* buf
+)
+{
+    return NULL;
+}
+
+ptrdiff_t iio_buffer_step
+(
+    const struct iio_buffer* buf
+)
+{
+    return 0;
+}
@@ -0,0 +1,84 @@
+//--------------------------------------------------------------------------------------------------
+/** @file iioSim.h
+ *
+ * Simulated IIO backend of the host tests. Every context, local or created from a "sim:" URI,
+ * exposes the same devices:
+ *
+ *  - imu0: accel, anglvel and magn x, y and z channels (raw and scale attributes);
+ *  - imu1: accel and anglvel x, y and z channels only;
+ *  - temp0: a processed temp channel (input attribute).
+ *
+ * Both IMUs follow the same known motion: a turn around the vertical axis per minute, with roll
+ * and pitch oscillations. Their readings are derived from that motion at the time they are read,
+ * with noise, and quantized with the scale of the channel as a driver would.
+ *
+ * Buffered captures and triggers are not simulated: the devices have no trigger and buffers can
+ * not be created.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_IIO_SIM_INCLUDE_GUARD
+#define LEGATO_HOST_IIO_SIM_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the true orientation of the simulated IMUs
+ */
+//--------------------------------------------------------------------------------------------------
+void iioSim_GetOrientation
+(
+    double time,                        ///< [IN]  Relative time in seconds
+    double q[4]                         ///< [OUT] Orientation quaternion (w, x, y, z)
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the readings of the simulated IMUs at a time, scaled, noisy and quantized, as the raw
+ * attributes of the channels would give them
+ */
+//--------------------------------------------------------------------------------------------------
+void iioSim_GetReadings
+(
+    double time,                        ///< [IN]  Relative time in seconds
+    double gyro[3],                     ///< [OUT] Angular velocity in radians per second
+    double accel[3],                    ///< [OUT] Acceleration in m/s^2
+    double magn[3]                      ///< [OUT] Magnetic field in Gauss
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of values read from a channel, in all the contexts
+ *
+ * @return:
+ *      - Number of reads of the raw or input attribute
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t iioSim_GetReadCount
+(
+    const char* deviceNamePtr,          ///< [IN] Name of the device, e.g. "imu0"
+    const char* channelIdPtr            ///< [IN] Id of the channel, e.g. "anglvel_x"
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of attributes read, in all the contexts
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t iioSim_GetAttrReadCount
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of contexts created and not destroyed
+ */
+//--------------------------------------------------------------------------------------------------
+int iioSim_GetContextCount
+(
+    void
+);
+
+#endif /* LEGATO_HOST_IIO_SIM_INCLUDE_GUARD */
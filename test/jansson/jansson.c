@@ -0,0 +1,1268 @@
+//--------------------------------------------------------------------------------------------------
+/** @file jansson.c
+ *
+ * Host stand-in for the jansson library.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <math.h>
+#include "jansson.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference count of the constants, which are never freed
+ */
+//--------------------------------------------------------------------------------------------------
+#define CONSTANT_REFCOUNT       ((size_t)-1)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default number of significant digits of the encoded reals
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_PRECISION       17
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum nesting of the decoded documents
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_DEPTH               64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Values of each type
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char* key;                                  ///< Name of the member
+    json_t* value;                              ///< Value of the member
+}
+member_t;
+
+typedef struct
+{
+    json_t json;
+    member_t* members;                          ///< Members, in insertion order
+    size_t size;                                ///< Number of members
+    size_t capacity;                            ///< Number of members allocated
+}
+object_t;
+
+typedef struct
+{
+    json_t json;
+    json_t** elements;                          ///< Elements
+    size_t size;                                ///< Number of elements
+    size_t capacity;                            ///< Number of elements allocated
+}
+array_t;
+
+typedef struct
+{
+    json_t json;
+    char* value;                                ///< Value
+}
+string_t;
+
+typedef struct
+{
+    json_t json;
+    json_int_t value;                           ///< Value
+}
+integer_t;
+
+typedef struct
+{
+    json_t json;
+    double value;                               ///< Value
+}
+real_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Constants
+ */
+//--------------------------------------------------------------------------------------------------
+static json_t True = { JSON_TRUE, CONSTANT_REFCOUNT };
+static json_t False = { JSON_FALSE, CONSTANT_REFCOUNT };
+static json_t Null = { JSON_NULL, CONSTANT_REFCOUNT };
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocation functions
+ */
+//--------------------------------------------------------------------------------------------------
+static json_malloc_t MallocFn = malloc;
+static json_free_t FreeFn = free;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Output buffer of the encoder
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char* data;                                 ///< Characters, NULL after a failure
+    size_t length;                              ///< Number of characters
+    size_t capacity;                            ///< Number of bytes allocated
+}
+output_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of the decoder
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* startPtr;                       ///< Start of the document
+    const char* charPtr;                        ///< Position
+    json_error_t* errorPtr;                     ///< Error, may be NULL
+}
+input_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resize a block allocated with the allocation functions
+ *
+ * @return:
+ *      - New block, NULL if it could not be allocated (the old block is kept)
+ */
+//--------------------------------------------------------------------------------------------------
+static void* Resize
+(
+    void* blockPtr,                             ///< [IN] Block, may be NULL
+    size_t oldSize,                             ///< [IN] Size of the block
+    size_t newSize                              ///< [IN] New size
+)
+{
+    void* newBlockPtr = MallocFn(newSize);
+
+    if ((newBlockPtr != NULL) && (blockPtr != NULL))
+    {
+        memcpy(newBlockPtr, blockPtr, oldSize);
+        FreeFn(blockPtr);
+    }
+
+    return newBlockPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Duplicate a string with the allocation functions
+ *
+ * @return:
+ *      - Copy, NULL if it could not be allocated
+ */
+//--------------------------------------------------------------------------------------------------
+static char* DuplicateString
+(
+    const char* valuePtr,                       ///< [IN] String
+    size_t length                               ///< [IN] Number of characters
+)
+{
+    char* copyPtr = MallocFn(length + 1);
+
+    if (copyPtr != NULL)
+    {
+        memcpy(copyPtr, valuePtr, length);
+        copyPtr[length] = '\0';
+    }
+
+    return copyPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate a value
+ *
+ * @return:
+ *      - Value with one reference, NULL if it could not be allocated
+ */
+//--------------------------------------------------------------------------------------------------
+static json_t* CreateValue
+(
+    json_type type,                             ///< [IN] Type of the value
+    size_t size                                 ///< [IN] Size of the value
+)
+{
+    json_t* jsonPtr = MallocFn(size);
+
+    if (jsonPtr != NULL)
+    {
+        memset(jsonPtr, 0, size);
+        jsonPtr->type = type;
+        jsonPtr->refcount = 1;
+    }
+
+    return jsonPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Free a value which is not referenced anymore
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteValue
+(
+    json_t* jsonPtr                             ///< [IN] Value
+)
+{
+    size_t i;
+
+    switch (jsonPtr->type)
+    {
+        case JSON_OBJECT:
+        {
+            object_t* objectPtr = (object_t*)jsonPtr;
+
+            for (i = 0; i < objectPtr->size; i++)
+            {
+                FreeFn(objectPtr->members[i].key);
+                json_decref(objectPtr->members[i].value);
+            }
+
+            FreeFn(objectPtr->members);
+            break;
+        }
+
+        case JSON_ARRAY:
+        {
+            array_t* arrayPtr = (array_t*)jsonPtr;
+
+            for (i = 0; i < arrayPtr->size; i++)
+            {
+                json_decref(arrayPtr->elements[i]);
+            }
+
+            FreeFn(arrayPtr->elements);
+            break;
+        }
+
+        case JSON_STRING:
+            FreeFn(((string_t*)jsonPtr)->value);
+            break;
+
+        default:
+            break;
+    }
+
+    FreeFn(jsonPtr);
+}
+
+json_t* json_object
+(
+    void
+)
+{
+    return CreateValue(JSON_OBJECT, sizeof(object_t));
+}
+
+json_t* json_array
+(
+    void
+)
+{
+    return CreateValue(JSON_ARRAY, sizeof(array_t));
+}
+
+json_t* json_string
+(
+    const char* value
+)
+{
+    if (value == NULL)
+    {
+        return NULL;
+    }
+
+    string_t* stringPtr = (string_t*)CreateValue(JSON_STRING, sizeof(string_t));
+
+    if (stringPtr == NULL)
+    {
+        return NULL;
+    }
+
+    stringPtr->value = DuplicateString(value, strlen(value));
+
+    if (stringPtr->value == NULL)
+    {
+        FreeFn(stringPtr);
+        return NULL;
+    }
+
+    return &stringPtr->json;
+}
+
+json_t* json_integer
+(
+    json_int_t value
+)
+{
+    integer_t* integerPtr = (integer_t*)CreateValue(JSON_INTEGER, sizeof(integer_t));
+
+    if (integerPtr == NULL)
+    {
+        return NULL;
+    }
+
+    integerPtr->value = value;
+    return &integerPtr->json;
+}
+
+json_t* json_real
+(
+    double value
+)
+{
+    if (isnan(value) || isinf(value))
+    {
+        return NULL;
+    }
+
+    real_t* realPtr = (real_t*)CreateValue(JSON_REAL, sizeof(real_t));
+
+    if (realPtr == NULL)
+    {
+        return NULL;
+    }
+
+    realPtr->value = value;
+    return &realPtr->json;
+}
+
+json_t* json_true
+(
+    void
+)
+{
+    return &True;
+}
+
+json_t* json_false
+(
+    void
+)
+{
+    return &False;
+}
+
+json_t* json_null
+(
+    void
+)
+{
+    return &Null;
+}
+
+json_t* json_incref
+(
+    json_t* json
+)
+{
+    if ((json != NULL) && (json->refcount != CONSTANT_REFCOUNT))
+    {
+        json->refcount++;
+    }
+
+    return json;
+}
+
+void json_decref
+(
+    json_t* json
+)
+{
+    if ((json != NULL) && (json->refcount != CONSTANT_REFCOUNT) && (--json->refcount == 0))
+    {
+        DeleteValue(json);
+    }
+}
+
+const char* json_string_value
+(
+    const json_t* string
+)
+{
+    return json_is_string(string) ? ((const string_t*)string)->value : NULL;
+}
+
+json_int_t json_integer_value
+(
+    const json_t* integer
+)
+{
+    return json_is_integer(integer) ? ((const integer_t*)integer)->value : 0;
+}
+
+double json_real_value
+(
+    const json_t* real
+)
+{
+    return json_is_real(real) ? ((const real_t*)real)->value : 0;
+}
+
+double json_number_value
+(
+    const json_t* json
+)
+{
+    if (json_is_integer(json))
+    {
+        return (double)json_integer_value(json);
+    }
+
+    return json_real_value(json);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a member of an object
+ *
+ * @return:
+ *      - Member, NULL if the object does not have it
+ */
+//--------------------------------------------------------------------------------------------------
+static member_t* FindMember
+(
+    const json_t* object,                       ///< [IN] Object
+    const char* key                             ///< [IN] Name of the member
+)
+{
+    size_t i;
+
+    if (!json_is_object(object) || (key == NULL))
+    {
+        return NULL;
+    }
+
+    const object_t* objectPtr = (const object_t*)object;
+
+    for (i = 0; i < objectPtr->size; i++)
+    {
+        if (strcmp(objectPtr->members[i].key, key) == 0)
+        {
+            return &objectPtr->members[i];
+        }
+    }
+
+    return NULL;
+}
+
+size_t json_object_size
+(
+    const json_t* object
+)
+{
+    return json_is_object(object) ? ((const object_t*)object)->size : 0;
+}
+
+json_t* json_object_get
+(
+    const json_t* object,
+    const char* key
+)
+{
+    member_t* memberPtr = FindMember(object, key);
+
+    return (memberPtr != NULL) ? memberPtr->value : NULL;
+}
+
+int json_object_set_new
+(
+    json_t* object,
+    const char* key,
+    json_t* value
+)
+{
+    if (value == NULL)
+    {
+        return -1;
+    }
+
+    if (!json_is_object(object) || (key == NULL) || (object == value))
+    {
+        json_decref(value);
+        return -1;
+    }
+
+    object_t* objectPtr = (object_t*)object;
+    member_t* memberPtr = FindMember(object, key);
+
+    if (memberPtr != NULL)
+    {
+        json_decref(memberPtr->value);
+        memberPtr->value = value;
+        return 0;
+    }
+
+    if (objectPtr->size == objectPtr->capacity)
+    {
+        size_t capacity = (objectPtr->capacity > 0) ? (2 * objectPtr->capacity) : 8;
+        member_t* membersPtr = Resize(objectPtr->members,
+                                      objectPtr->capacity * sizeof(member_t),
+                                      capacity * sizeof(member_t));
+
+        if (membersPtr == NULL)
+        {
+            json_decref(value);
+            return -1;
+        }
+
+        objectPtr->members = membersPtr;
+        objectPtr->capacity = capacity;
+    }
+
+    memberPtr = &objectPtr->members[objectPtr->size];
+    memberPtr->key = DuplicateString(key, strlen(key));
+
+    if (memberPtr->key == NULL)
+    {
+        json_decref(value);
+        return -1;
+    }
+
+    memberPtr->value = value;
+    objectPtr->size++;
+
+    return 0;
+}
+
+int json_object_set
+(
+    json_t* object,
+    const char* key,
+    json_t* value
+)
+{
+    return json_object_set_new(object, key, json_incref(value));
+}
+
+int json_object_del
+(
+    json_t* object,
+    const char* key
+)
+{
+    member_t* memberPtr = FindMember(object, key);
+
+    if (memberPtr == NULL)
+    {
+        return -1;
+    }
+
+    object_t* objectPtr = (object_t*)object;
+    size_t index = memberPtr - objectPtr->members;
+
+    FreeFn(memberPtr->key);
+    json_decref(memberPtr->value);
+    memmove(memberPtr, memberPtr + 1, (objectPtr->size - index - 1) * sizeof(member_t));
+    objectPtr->size--;
+
+    return 0;
+}
+
+size_t json_array_size
+(
+    const json_t* array
+)
+{
+    return json_is_array(array) ? ((const array_t*)array)->size : 0;
+}
+
+json_t* json_array_get
+(
+    const json_t* array,
+    size_t index
+)
+{
+    if (index >= json_array_size(array))
+    {
+        return NULL;
+    }
+
+    return ((const array_t*)array)->elements[index];
+}
+
+int json_array_append_new
+(
+    json_t* array,
+    json_t* value
+)
+{
+    if (value == NULL)
+    {
+        return -1;
+    }
+
+    if (!json_is_array(array) || (array == value))
+    {
+        json_decref(value);
+        return -1;
+    }
+
+    array_t* arrayPtr = (array_t*)array;
+
+    if (arrayPtr->size == arrayPtr->capacity)
+    {
+        size_t capacity = (arrayPtr->capacity > 0) ? (2 * arrayPtr->capacity) : 8;
+        json_t** elementsPtr = Resize(arrayPtr->elements,
+                                      arrayPtr->capacity * sizeof(json_t*),
+                                      capacity * sizeof(json_t*));
+
+        if (elementsPtr == NULL)
+        {
+            json_decref(value);
+            return -1;
+        }
+
+        arrayPtr->elements = elementsPtr;
+        arrayPtr->capacity = capacity;
+    }
+
+    arrayPtr->elements[arrayPtr->size++] = value;
+    return 0;
+}
+
+int json_array_append
+(
+    json_t* array,
+    json_t* value
+)
+{
+    return json_array_append_new(array, json_incref(value));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a decoding error
+ *
+ * @return:
+ *      - NULL
+ */
+//--------------------------------------------------------------------------------------------------
+static json_t* DecodeError
+(
+    input_t* inputPtr,                          ///< [IN] Decoder
+    const char* textPtr                         ///< [IN] Description of the error
+)
+{
+    json_error_t* errorPtr = inputPtr->errorPtr;
+
+    if (errorPtr != NULL)
+    {
+        errorPtr->line = 1;
+        errorPtr->position = (int)(inputPtr->charPtr - inputPtr->startPtr);
+        errorPtr->column = errorPtr->position + 1;
+        le_utf8_Copy(errorPtr->source, "<string>", sizeof(errorPtr->source), NULL);
+        le_utf8_Copy(errorPtr->text, textPtr, sizeof(errorPtr->text), NULL);
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skip white space
+ */
+//--------------------------------------------------------------------------------------------------
+static void SkipSpace
+(
+    input_t* inputPtr                           ///< [INOUT] Decoder
+)
+{
+    while ((*inputPtr->charPtr != '\0') && (strchr(" \t\r\n", *inputPtr->charPtr) != NULL))
+    {
+        inputPtr->charPtr++;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode a string, the opening quote being at the position
+ *
+ * @return:
+ *      - String allocated with the allocation functions, NULL on error
+ */
+//--------------------------------------------------------------------------------------------------
+static char* DecodeString
+(
+    input_t* inputPtr                           ///< [INOUT] Decoder
+)
+{
+    const char* charPtr = inputPtr->charPtr + 1;
+    size_t length = 0;
+
+    // The decoded string is never longer than the encoded one.
+    char* valuePtr = MallocFn(strlen(charPtr) + 1);
+
+    if (valuePtr == NULL)
+    {
+        DecodeError(inputPtr, "out of memory");
+        return NULL;
+    }
+
+    while (*charPtr != '"')
+    {
+        if ((unsigned char)*charPtr < 0x20)
+        {
+            inputPtr->charPtr = charPtr;
+            FreeFn(valuePtr);
+            DecodeError(inputPtr, "invalid string");
+            return NULL;
+        }
+
+        if (*charPtr != '\\')
+        {
+            valuePtr[length++] = *charPtr++;
+            continue;
+        }
+
+        charPtr++;
+
+        switch (*charPtr)
+        {
+            case '"':  valuePtr[length++] = '"';  break;
+            case '\\': valuePtr[length++] = '\\'; break;
+            case '/':  valuePtr[length++] = '/';  break;
+            case 'b':  valuePtr[length++] = '\b'; break;
+            case 'f':  valuePtr[length++] = '\f'; break;
+            case 'n':  valuePtr[length++] = '\n'; break;
+            case 'r':  valuePtr[length++] = '\r'; break;
+            case 't':  valuePtr[length++] = '\t'; break;
+
+            case 'u':
+            {
+                char hex[5] = { 0 };
+                char* endPtr;
+
+                memcpy(hex, charPtr + 1, 4);
+
+                unsigned long code = strtoul(hex, &endPtr, 16);
+
+                if (endPtr != hex + 4)
+                {
+                    inputPtr->charPtr = charPtr;
+                    FreeFn(valuePtr);
+                    DecodeError(inputPtr, "invalid escape");
+                    return NULL;
+                }
+
+                // Characters of the basic multilingual plane only, in UTF-8.
+                if (code < 0x80)
+                {
+                    valuePtr[length++] = (char)code;
+                }
+                else if (code < 0x800)
+                {
+                    valuePtr[length++] = (char)(0xC0 | (code >> 6));
+                    valuePtr[length++] = (char)(0x80 | (code & 0x3F));
+                }
+                else
+                {
+                    valuePtr[length++] = (char)(0xE0 | (code >> 12));
+                    valuePtr[length++] = (char)(0x80 | ((code >> 6) & 0x3F));
+                    valuePtr[length++] = (char)(0x80 | (code & 0x3F));
+                }
+
+                charPtr += 4;
+                break;
+            }
+
+            default:
+                inputPtr->charPtr = charPtr;
+                FreeFn(valuePtr);
+                DecodeError(inputPtr, "invalid escape");
+                return NULL;
+        }
+
+        charPtr++;
+    }
+
+    valuePtr[length] = '\0';
+    inputPtr->charPtr = charPtr + 1;
+
+    return valuePtr;
+}
+
+static json_t* DecodeValue(input_t* inputPtr, int depth);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode an object or an array, the opening character being at the position
+ *
+ * @return:
+ *      - Value, NULL on error
+ */
+//--------------------------------------------------------------------------------------------------
+static json_t* DecodeContainer
+(
+    input_t* inputPtr,                          ///< [INOUT] Decoder
+    int depth                                   ///< [IN]    Nesting of the container
+)
+{
+    bool isObject = (*inputPtr->charPtr == '{');
+    char closing = isObject ? '}' : ']';
+    json_t* containerPtr = isObject ? json_object() : json_array();
+
+    if (containerPtr == NULL)
+    {
+        return DecodeError(inputPtr, "out of memory");
+    }
+
+    inputPtr->charPtr++;
+    SkipSpace(inputPtr);
+
+    if (*inputPtr->charPtr == closing)
+    {
+        inputPtr->charPtr++;
+        return containerPtr;
+    }
+
+    for (;;)
+    {
+        char* keyPtr = NULL;
+        int result;
+
+        if (isObject)
+        {
+            SkipSpace(inputPtr);
+
+            if (*inputPtr->charPtr != '"')
+            {
+                json_decref(containerPtr);
+                return DecodeError(inputPtr, "string or '}' expected");
+            }
+
+            keyPtr = DecodeString(inputPtr);
+
+            if (keyPtr == NULL)
+            {
+                json_decref(containerPtr);
+                return NULL;
+            }
+
+            SkipSpace(inputPtr);
+
+            if (*inputPtr->charPtr != ':')
+            {
+                FreeFn(keyPtr);
+                json_decref(containerPtr);
+                return DecodeError(inputPtr, "':' expected");
+            }
+
+            inputPtr->charPtr++;
+        }
+
+        json_t* valuePtr = DecodeValue(inputPtr, depth + 1);
+
+        if (valuePtr == NULL)
+        {
+            FreeFn(keyPtr);
+            json_decref(containerPtr);
+            return NULL;
+        }
+
+        if (isObject)
+        {
+            result = json_object_set_new(containerPtr, keyPtr, valuePtr);
+            FreeFn(keyPtr);
+        }
+        else
+        {
+            result = json_array_append_new(containerPtr, valuePtr);
+        }
+
+        if (result != 0)
+        {
+            json_decref(containerPtr);
+            return DecodeError(inputPtr, "out of memory");
+        }
+
+        SkipSpace(inputPtr);
+
+        if (*inputPtr->charPtr == closing)
+        {
+            inputPtr->charPtr++;
+            return containerPtr;
+        }
+
+        if (*inputPtr->charPtr != ',')
+        {
+            json_decref(containerPtr);
+            return DecodeError(inputPtr, isObject ? "',' or '}' expected" : "',' or ']' expected");
+        }
+
+        inputPtr->charPtr++;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode a value
+ *
+ * @return:
+ *      - Value, NULL on error
+ */
+//--------------------------------------------------------------------------------------------------
+static json_t* DecodeValue
+(
+    input_t* inputPtr,                          ///< [INOUT] Decoder
+    int depth                                   ///< [IN]    Nesting of the value
+)
+{
+    SkipSpace(inputPtr);
+
+    const char* charPtr = inputPtr->charPtr;
+
+    if (depth > MAX_DEPTH)
+    {
+        return DecodeError(inputPtr, "maximum parsing depth reached");
+    }
+
+    switch (*charPtr)
+    {
+        case '{':
+        case '[':
+            return DecodeContainer(inputPtr, depth);
+
+        case '"':
+        {
+            char* valuePtr = DecodeString(inputPtr);
+
+            if (valuePtr == NULL)
+            {
+                return NULL;
+            }
+
+            string_t* stringPtr = (string_t*)CreateValue(JSON_STRING, sizeof(string_t));
+
+            if (stringPtr == NULL)
+            {
+                FreeFn(valuePtr);
+                return DecodeError(inputPtr, "out of memory");
+            }
+
+            stringPtr->value = valuePtr;
+            return &stringPtr->json;
+        }
+
+        case 't':
+        case 'f':
+        case 'n':
+        {
+            static const char* words[] = { "true", "false", "null" };
+            json_t* values[] = { &True, &False, &Null };
+            size_t i;
+
+            for (i = 0; i < NUM_ARRAY_MEMBERS(words); i++)
+            {
+                if (strncmp(charPtr, words[i], strlen(words[i])) == 0)
+                {
+                    inputPtr->charPtr += strlen(words[i]);
+                    return values[i];
+                }
+            }
+
+            return DecodeError(inputPtr, "invalid token");
+        }
+
+        default:
+        {
+            size_t length = strspn(charPtr, "+-0123456789.eE");
+            char* endPtr;
+
+            if ((length == 0) || (*charPtr == '+'))
+            {
+                return DecodeError(inputPtr, "invalid token");
+            }
+
+            // Numbers without fraction nor exponent are integers.
+            if (strcspn(charPtr, ".eE") >= length)
+            {
+                errno = 0;
+                json_int_t value = strtoll(charPtr, &endPtr, 10);
+
+                if ((endPtr == charPtr + length) && (errno == 0))
+                {
+                    inputPtr->charPtr = endPtr;
+                    return json_integer(value);
+                }
+            }
+
+            double value = strtod(charPtr, &endPtr);
+
+            if (endPtr != charPtr + length)
+            {
+                return DecodeError(inputPtr, "invalid number");
+            }
+
+            inputPtr->charPtr = endPtr;
+            return json_real(value);
+        }
+    }
+}
+
+json_t* json_loads
+(
+    const char* input,
+    size_t flags,
+    json_error_t* error
+)
+{
+    input_t decoder = { input, input, error };
+
+    if (input == NULL)
+    {
+        return DecodeError(&decoder, "wrong arguments");
+    }
+
+    if (error != NULL)
+    {
+        memset(error, 0, sizeof(json_error_t));
+    }
+
+    json_t* jsonPtr = DecodeValue(&decoder, 0);
+
+    if (jsonPtr == NULL)
+    {
+        return NULL;
+    }
+
+    SkipSpace(&decoder);
+
+    if (*decoder.charPtr != '\0')
+    {
+        json_decref(jsonPtr);
+        return DecodeError(&decoder, "end of file expected");
+    }
+
+    return jsonPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append characters to the output of the encoder
+ */
+//--------------------------------------------------------------------------------------------------
+static void Append
+(
+    output_t* outputPtr,                        ///< [INOUT] Output
+    const char* charPtr,                        ///< [IN]    Characters
+    size_t length                               ///< [IN]    Number of characters
+)
+{
+    if (outputPtr->data == NULL)
+    {
+        return;
+    }
+
+    if (outputPtr->length + length + 1 > outputPtr->capacity)
+    {
+        size_t capacity = 2 * (outputPtr->length + length + 1);
+        char* dataPtr = Resize(outputPtr->data, outputPtr->capacity, capacity);
+
+        if (dataPtr == NULL)
+        {
+            FreeFn(outputPtr->data);
+            outputPtr->data = NULL;
+            return;
+        }
+
+        outputPtr->data = dataPtr;
+        outputPtr->capacity = capacity;
+    }
+
+    memcpy(outputPtr->data + outputPtr->length, charPtr, length);
+    outputPtr->length += length;
+    outputPtr->data[outputPtr->length] = '\0';
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a string
+ */
+//--------------------------------------------------------------------------------------------------
+static void EncodeString
+(
+    output_t* outputPtr,                        ///< [INOUT] Output
+    const char* valuePtr                        ///< [IN]    String
+)
+{
+    Append(outputPtr, "\"", 1);
+
+    for (; *valuePtr != '\0'; valuePtr++)
+    {
+        char escape[8];
+
+        switch (*valuePtr)
+        {
+            case '"':  Append(outputPtr, "\\\"", 2); break;
+            case '\\': Append(outputPtr, "\\\\", 2); break;
+            case '\b': Append(outputPtr, "\\b", 2);  break;
+            case '\f': Append(outputPtr, "\\f", 2);  break;
+            case '\n': Append(outputPtr, "\\n", 2);  break;
+            case '\r': Append(outputPtr, "\\r", 2);  break;
+            case '\t': Append(outputPtr, "\\t", 2);  break;
+
+            default:
+                if ((unsigned char)*valuePtr < 0x20)
+                {
+                    snprintf(escape, sizeof(escape), "\\u%04x", (unsigned char)*valuePtr);
+                    Append(outputPtr, escape, 6);
+                }
+                else
+                {
+                    Append(outputPtr, valuePtr, 1);
+                }
+                break;
+        }
+    }
+
+    Append(outputPtr, "\"", 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a value
+ */
+//--------------------------------------------------------------------------------------------------
+static void EncodeValue
+(
+    output_t* outputPtr,                        ///< [INOUT] Output
+    const json_t* jsonPtr,                      ///< [IN]    Value
+    size_t flags                                ///< [IN]    Encoding flags
+)
+{
+    const char* separator = (flags & JSON_COMPACT) ? "," : ", ";
+    const char* colon = (flags & JSON_COMPACT) ? ":" : ": ";
+    char number[64];
+    size_t i;
+
+    switch (jsonPtr->type)
+    {
+        case JSON_OBJECT:
+        {
+            const object_t* objectPtr = (const object_t*)jsonPtr;
+
+            Append(outputPtr, "{", 1);
+
+            for (i = 0; i < objectPtr->size; i++)
+            {
+                if (i > 0)
+                {
+                    Append(outputPtr, separator, strlen(separator));
+                }
+
+                EncodeString(outputPtr, objectPtr->members[i].key);
+                Append(outputPtr, colon, strlen(colon));
+                EncodeValue(outputPtr, objectPtr->members[i].value, flags);
+            }
+
+            Append(outputPtr, "}", 1);
+            break;
+        }
+
+        case JSON_ARRAY:
+        {
+            const array_t* arrayPtr = (const array_t*)jsonPtr;
+
+            Append(outputPtr, "[", 1);
+
+            for (i = 0; i < arrayPtr->size; i++)
+            {
+                if (i > 0)
+                {
+                    Append(outputPtr, separator, strlen(separator));
+                }
+
+                EncodeValue(outputPtr, arrayPtr->elements[i], flags);
+            }
+
+            Append(outputPtr, "]", 1);
+            break;
+        }
+
+        case JSON_STRING:
+            EncodeString(outputPtr, ((const string_t*)jsonPtr)->value);
+            break;
+
+        case JSON_INTEGER:
+            snprintf(number, sizeof(number), "%" JSON_INTEGER_FORMAT,
+                     ((const integer_t*)jsonPtr)->value);
+            Append(outputPtr, number, strlen(number));
+            break;
+
+        case JSON_REAL:
+        {
+            int precision = (flags >> 11) & 0x1F;
+
+            snprintf(number, sizeof(number), "%.*g",
+                     (precision > 0) ? precision : DEFAULT_PRECISION,
+                     ((const real_t*)jsonPtr)->value);
+
+            // Reals stay reals when decoded again.
+            if (strpbrk(number, ".e") == NULL)
+            {
+                le_utf8_Append(number, ".0", sizeof(number), NULL);
+            }
+
+            Append(outputPtr, number, strlen(number));
+            break;
+        }
+
+        case JSON_TRUE:
+            Append(outputPtr, "true", 4);
+            break;
+
+        case JSON_FALSE:
+            Append(outputPtr, "false", 5);
+            break;
+
+        case JSON_NULL:
+            Append(outputPtr, "null", 4);
+            break;
+    }
+}
+
+char* json_dumps
+(
+    const json_t* json,
+    size_t flags
+)
+{
+    output_t output = { NULL, 0, 64 };
+
+    if (json == NULL)
+    {
+        return NULL;
+    }
+
+    output.data = MallocFn(output.capacity);
+
+    if (output.data == NULL)
+    {
+        return NULL;
+    }
+
+    output.data[0] = '\0';
+    EncodeValue(&output, json, flags);
+
+    return output.data;
+}
+
+void json_set_alloc_funcs
+(
+    json_malloc_t malloc_fn,
+    json_free_t free_fn
+)
+{
+    MallocFn = malloc_fn;
+    FreeFn = free_fn;
+}
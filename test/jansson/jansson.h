@@ -0,0 +1,122 @@
+//--------------------------------------------------------------------------------------------------
+/** @file jansson.h
+ *
+ * Host stand-in for the subset of the jansson library used by the plugins: reference counted
+ * values, objects keeping their members in insertion order, arrays, json_loads() and json_dumps().
+ * The allocation functions can be replaced with json_set_alloc_funcs(), as in jansson, so that
+ * the host tests can account for the memory of the documents.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_JANSSON_INCLUDE_GUARD
+#define LEGATO_HOST_JANSSON_INCLUDE_GUARD
+
+#include <stddef.h>
+#include <stdbool.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Values
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    JSON_OBJECT,
+    JSON_ARRAY,
+    JSON_STRING,
+    JSON_INTEGER,
+    JSON_REAL,
+    JSON_TRUE,
+    JSON_FALSE,
+    JSON_NULL
+}
+json_type;
+
+typedef long long json_int_t;
+
+typedef struct json_t
+{
+    json_type type;
+    size_t refcount;
+}
+json_t;
+
+#define JSON_INTEGER_FORMAT                 "lld"
+
+#define json_typeof(json)                   ((json)->type)
+#define json_is_object(json)                ((json) && json_typeof(json) == JSON_OBJECT)
+#define json_is_array(json)                 ((json) && json_typeof(json) == JSON_ARRAY)
+#define json_is_string(json)                ((json) && json_typeof(json) == JSON_STRING)
+#define json_is_integer(json)               ((json) && json_typeof(json) == JSON_INTEGER)
+#define json_is_real(json)                  ((json) && json_typeof(json) == JSON_REAL)
+#define json_is_number(json)                (json_is_integer(json) || json_is_real(json))
+#define json_is_true(json)                  ((json) && json_typeof(json) == JSON_TRUE)
+#define json_is_false(json)                 ((json) && json_typeof(json) == JSON_FALSE)
+#define json_is_boolean(json)               (json_is_true(json) || json_is_false(json))
+#define json_is_null(json)                  ((json) && json_typeof(json) == JSON_NULL)
+
+json_t* json_object(void);
+json_t* json_array(void);
+json_t* json_string(const char* value);
+json_t* json_integer(json_int_t value);
+json_t* json_real(double value);
+json_t* json_true(void);
+json_t* json_false(void);
+json_t* json_null(void);
+
+json_t* json_incref(json_t* json);
+void json_decref(json_t* json);
+
+const char* json_string_value(const json_t* string);
+json_int_t json_integer_value(const json_t* integer);
+double json_real_value(const json_t* real);
+double json_number_value(const json_t* json);
+
+size_t json_object_size(const json_t* object);
+json_t* json_object_get(const json_t* object, const char* key);
+int json_object_set_new(json_t* object, const char* key, json_t* value);
+int json_object_set(json_t* object, const char* key, json_t* value);
+int json_object_del(json_t* object, const char* key);
+
+size_t json_array_size(const json_t* array);
+json_t* json_array_get(const json_t* array, size_t index);
+int json_array_append_new(json_t* array, json_t* value);
+int json_array_append(json_t* array, json_t* value);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decoding and encoding
+ */
+//--------------------------------------------------------------------------------------------------
+#define JSON_ERROR_TEXT_LENGTH              160
+#define JSON_ERROR_SOURCE_LENGTH            80
+
+typedef struct
+{
+    int line;
+    int column;
+    int position;
+    char source[JSON_ERROR_SOURCE_LENGTH];
+    char text[JSON_ERROR_TEXT_LENGTH];
+}
+json_error_t;
+
+#define JSON_COMPACT                        0x20
+#define JSON_REAL_PRECISION(n)              (((n) & 0x1F) << 11)
+
+json_t* json_loads(const char* input, size_t flags, json_error_t* error);
+char* json_dumps(const json_t* json, size_t flags);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory allocation of the values, the strings they hold and the encoded documents
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void* (*json_malloc_t)(size_t);
+typedef void (*json_free_t)(void*);
+
+void json_set_alloc_funcs(json_malloc_t malloc_fn, json_free_t free_fn);
+
+#endif /* LEGATO_HOST_JANSSON_INCLUDE_GUARD */
@@ -0,0 +1,527 @@
+//--------------------------------------------------------------------------------------------------
+/** @file cfg.c
+ *
+ * Host stand-in for the configuration tree. The tree is kept in memory as the list of its leaves,
+ * in the order they were first written, which is the order of the children of a node.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of the path of a node
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_PATH_LEN                        512
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Leaf of the tree
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char* pathPtr;                              ///< Absolute path, e.g. /sensors/a/period
+    char* valuePtr;                             ///< Value, as a string
+}
+leaf_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Iterator of a transaction
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_cfg_Iterator
+{
+    char path[MAX_PATH_LEN];                    ///< Current node
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Leaves of the tree
+ */
+//--------------------------------------------------------------------------------------------------
+static leaf_t* Leaves;
+static size_t LeafCount;
+static size_t LeafCapacity;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resolve a path relative to a node into an absolute path without empty or ".." components. A
+ * tree name ("tree:/path") is ignored, there is a single tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ResolvePath
+(
+    const char* basePtr,                        ///< [IN]  Node the path is relative to
+    const char* pathPtr,                        ///< [IN]  Path
+    char* resolvedPtr                           ///< [OUT] Absolute path, MAX_PATH_LEN bytes
+)
+{
+    char joined[2 * MAX_PATH_LEN];
+    const char* colonPtr = strstr(pathPtr, ":/");
+    char* savePtr = NULL;
+    char* namePtr;
+    size_t length = 0;
+
+    if (colonPtr != NULL)
+    {
+        pathPtr = colonPtr + 1;
+    }
+
+    snprintf(joined, sizeof(joined), "%s/%s", (pathPtr[0] == '/') ? "" : basePtr, pathPtr);
+
+    resolvedPtr[0] = '\0';
+
+    for (namePtr = strtok_r(joined, "/", &savePtr);
+         namePtr != NULL;
+         namePtr = strtok_r(NULL, "/", &savePtr))
+    {
+        if (strcmp(namePtr, ".") == 0)
+        {
+            continue;
+        }
+
+        if (strcmp(namePtr, "..") == 0)
+        {
+            char* slashPtr = strrchr(resolvedPtr, '/');
+
+            length = (slashPtr != NULL) ? (size_t)(slashPtr - resolvedPtr) : 0;
+            resolvedPtr[length] = '\0';
+            continue;
+        }
+
+        length += snprintf(resolvedPtr + length, MAX_PATH_LEN - length, "/%s", namePtr);
+        LE_FATAL_IF(length >= MAX_PATH_LEN, "Path too long: %s/%s", basePtr, pathPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a path is a node or one of its descendants
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsWithin
+(
+    const char* pathPtr,                        ///< [IN] Path
+    const char* nodePtr                         ///< [IN] Node
+)
+{
+    size_t length = strlen(nodePtr);
+
+    return (strncmp(pathPtr, nodePtr, length) == 0) &&
+           ((pathPtr[length] == '\0') || (pathPtr[length] == '/'));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a leaf
+ *
+ * @return:
+ *      - Leaf, NULL if the node is not a leaf
+ */
+//--------------------------------------------------------------------------------------------------
+static leaf_t* FindLeaf
+(
+    le_cfg_IteratorRef_t iteratorRef,           ///< [IN] Iterator
+    const char* pathPtr                         ///< [IN] Path relative to the iterator
+)
+{
+    char path[MAX_PATH_LEN];
+    size_t i;
+
+    ResolvePath(iteratorRef->path, pathPtr, path);
+
+    for (i = 0; i < LeafCount; i++)
+    {
+        if (strcmp(Leaves[i].pathPtr, path) == 0)
+        {
+            return &Leaves[i];
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a node and its descendants
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeletePath
+(
+    const char* pathPtr                         ///< [IN] Absolute path
+)
+{
+    size_t i = 0;
+
+    while (i < LeafCount)
+    {
+        if (IsWithin(Leaves[i].pathPtr, pathPtr))
+        {
+            free(Leaves[i].pathPtr);
+            free(Leaves[i].valuePtr);
+            memmove(&Leaves[i], &Leaves[i + 1], (LeafCount - i - 1) * sizeof(leaf_t));
+            LeafCount--;
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the value of a leaf, replacing a node of the same path
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetValue
+(
+    le_cfg_IteratorRef_t iteratorRef,           ///< [IN] Iterator
+    const char* pathPtr,                        ///< [IN] Path relative to the iterator
+    const char* valuePtr                        ///< [IN] Value
+)
+{
+    leaf_t* leafPtr = FindLeaf(iteratorRef, pathPtr);
+    char path[MAX_PATH_LEN];
+
+    if (leafPtr != NULL)
+    {
+        free(leafPtr->valuePtr);
+        leafPtr->valuePtr = strdup(valuePtr);
+        LE_ASSERT(leafPtr->valuePtr != NULL);
+        return;
+    }
+
+    ResolvePath(iteratorRef->path, pathPtr, path);
+    DeletePath(path);
+
+    if (LeafCount == LeafCapacity)
+    {
+        LeafCapacity = (LeafCapacity > 0) ? 2 * LeafCapacity : 64;
+        Leaves = realloc(Leaves, LeafCapacity * sizeof(leaf_t));
+        LE_ASSERT(Leaves != NULL);
+    }
+
+    Leaves[LeafCount].pathPtr = strdup(path);
+    Leaves[LeafCount].valuePtr = strdup(valuePtr);
+    LE_ASSERT((Leaves[LeafCount].pathPtr != NULL) && (Leaves[LeafCount].valuePtr != NULL));
+    LeafCount++;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the name of the child of a node that a leaf is in
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetChildName
+(
+    const char* leafPathPtr,                    ///< [IN]  Path of the leaf
+    const char* nodePtr,                        ///< [IN]  Absolute path of the node
+    char* namePtr                               ///< [OUT] Name of the child, MAX_PATH_LEN bytes
+)
+{
+    size_t length = strlen(nodePtr);
+    const char* startPtr = leafPathPtr + length + 1;
+    const char* endPtr;
+
+    if (!IsWithin(leafPathPtr, nodePtr) || (leafPathPtr[length] != '/'))
+    {
+        return false;
+    }
+
+    endPtr = strchr(startPtr, '/');
+    length = (endPtr != NULL) ? (size_t)(endPtr - startPtr) : strlen(startPtr);
+    memcpy(namePtr, startPtr, length);
+    namePtr[length] = '\0';
+
+    return true;
+}
+
+le_cfg_IteratorRef_t le_cfg_CreateReadTxn
+(
+    const char* basePath
+)
+{
+    le_cfg_IteratorRef_t iteratorRef = malloc(sizeof(*iteratorRef));
+
+    LE_ASSERT(iteratorRef != NULL);
+
+    ResolvePath("", basePath, iteratorRef->path);
+    return iteratorRef;
+}
+
+le_cfg_IteratorRef_t le_cfg_CreateWriteTxn
+(
+    const char* basePath
+)
+{
+    return le_cfg_CreateReadTxn(basePath);
+}
+
+void le_cfg_CommitTxn
+(
+    le_cfg_IteratorRef_t iteratorRef
+)
+{
+    free(iteratorRef);
+}
+
+void le_cfg_CancelTxn
+(
+    le_cfg_IteratorRef_t iteratorRef
+)
+{
+    free(iteratorRef);
+}
+
+le_result_t le_cfg_GoToNode
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* newPath
+)
+{
+    char path[MAX_PATH_LEN];
+
+    ResolvePath(iteratorRef->path, newPath, path);
+    memcpy(iteratorRef->path, path, sizeof(path));
+
+    return LE_OK;
+}
+
+le_result_t le_cfg_GoToParent
+(
+    le_cfg_IteratorRef_t iteratorRef
+)
+{
+    if (iteratorRef->path[0] == '\0')
+    {
+        return LE_NOT_FOUND;
+    }
+
+    return le_cfg_GoToNode(iteratorRef, "..");
+}
+
+le_result_t le_cfg_GoToFirstChild
+(
+    le_cfg_IteratorRef_t iteratorRef
+)
+{
+    char name[MAX_PATH_LEN];
+    size_t i;
+
+    for (i = 0; i < LeafCount; i++)
+    {
+        if (GetChildName(Leaves[i].pathPtr, iteratorRef->path, name))
+        {
+            return le_cfg_GoToNode(iteratorRef, name);
+        }
+    }
+
+    return LE_NOT_FOUND;
+}
+
+le_result_t le_cfg_GoToNextSibling
+(
+    le_cfg_IteratorRef_t iteratorRef
+)
+{
+    char parent[MAX_PATH_LEN];
+    char name[MAX_PATH_LEN];
+    const char* currentPtr;
+    bool isCurrentSeen = false;
+    size_t i;
+
+    ResolvePath(iteratorRef->path, "..", parent);
+    currentPtr = iteratorRef->path + strlen(parent) + 1;
+
+    for (i = 0; i < LeafCount; i++)
+    {
+        if (!GetChildName(Leaves[i].pathPtr, parent, name))
+        {
+            continue;
+        }
+
+        if (strcmp(name, currentPtr) == 0)
+        {
+            isCurrentSeen = true;
+            continue;
+        }
+
+        // Children are in the order of their first leaf: skip the ones seen before the current.
+        if (isCurrentSeen)
+        {
+            size_t j;
+            bool isEarlier = false;
+
+            for (j = 0; (j < i) && !isEarlier; j++)
+            {
+                char earlierName[MAX_PATH_LEN];
+
+                isEarlier = GetChildName(Leaves[j].pathPtr, parent, earlierName) &&
+                            (strcmp(earlierName, name) == 0);
+            }
+
+            if (!isEarlier)
+            {
+                memcpy(iteratorRef->path, parent, sizeof(parent));
+                return le_cfg_GoToNode(iteratorRef, name);
+            }
+        }
+    }
+
+    return LE_NOT_FOUND;
+}
+
+le_result_t le_cfg_GetNodeName
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path,
+    char* name,
+    size_t nameSize
+)
+{
+    char resolved[MAX_PATH_LEN];
+    const char* slashPtr;
+
+    ResolvePath(iteratorRef->path, path, resolved);
+    slashPtr = strrchr(resolved, '/');
+
+    return le_utf8_Copy(name, (slashPtr != NULL) ? slashPtr + 1 : "", nameSize, NULL);
+}
+
+bool le_cfg_NodeExists
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path
+)
+{
+    char resolved[MAX_PATH_LEN];
+    size_t i;
+
+    ResolvePath(iteratorRef->path, path, resolved);
+
+    for (i = 0; i < LeafCount; i++)
+    {
+        if (IsWithin(Leaves[i].pathPtr, resolved))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void le_cfg_DeleteNode
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path
+)
+{
+    char resolved[MAX_PATH_LEN];
+
+    ResolvePath(iteratorRef->path, path, resolved);
+    DeletePath(resolved);
+}
+
+le_result_t le_cfg_GetString
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path,
+    char* value,
+    size_t valueSize,
+    const char* defaultValue
+)
+{
+    leaf_t* leafPtr = FindLeaf(iteratorRef, path);
+
+    return le_utf8_Copy(value, (leafPtr != NULL) ? leafPtr->valuePtr : defaultValue, valueSize,
+                        NULL);
+}
+
+void le_cfg_SetString
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path,
+    const char* value
+)
+{
+    SetValue(iteratorRef, path, value);
+}
+
+int32_t le_cfg_GetInt
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path,
+    int32_t defaultValue
+)
+{
+    leaf_t* leafPtr = FindLeaf(iteratorRef, path);
+
+    return (leafPtr != NULL) ? (int32_t)strtol(leafPtr->valuePtr, NULL, 10) : defaultValue;
+}
+
+void le_cfg_SetInt
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path,
+    int32_t value
+)
+{
+    char string[16];
+
+    snprintf(string, sizeof(string), "%" PRId32, value);
+    SetValue(iteratorRef, path, string);
+}
+
+double le_cfg_GetFloat
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path,
+    double defaultValue
+)
+{
+    leaf_t* leafPtr = FindLeaf(iteratorRef, path);
+
+    return (leafPtr != NULL) ? strtod(leafPtr->valuePtr, NULL) : defaultValue;
+}
+
+void le_cfg_SetFloat
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path,
+    double value
+)
+{
+    char string[32];
+
+    snprintf(string, sizeof(string), "%.17g", value);
+    SetValue(iteratorRef, path, string);
+}
+
+bool le_cfg_GetBool
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path,
+    bool defaultValue
+)
+{
+    leaf_t* leafPtr = FindLeaf(iteratorRef, path);
+
+    return (leafPtr != NULL) ? (strcmp(leafPtr->valuePtr, "true") == 0) : defaultValue;
+}
+
+void le_cfg_SetBool
+(
+    le_cfg_IteratorRef_t iteratorRef,
+    const char* path,
+    bool value
+)
+{
+    SetValue(iteratorRef, path, value ? "true" : "false");
+}
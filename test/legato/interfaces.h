@@ -0,0 +1,196 @@
+//--------------------------------------------------------------------------------------------------
+/** @file interfaces.h
+ *
+ * Host stand-in for the interfaces generated from the APIs used by sensorFw and the plugins: the
+ * Data Hub (io, admin), the configuration tree (le_cfg), the modem services (le_info,
+ * le_bootReason, le_gnss) and the APIs provided by sensorFw. The services are implemented by the
+ * stand-ins of the test directory.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_INTERFACES_INCLUDE_GUARD
+#define LEGATO_HOST_INTERFACES_INCLUDE_GUARD
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Data Hub resources (io.api)
+ */
+//--------------------------------------------------------------------------------------------------
+#define IO_MAX_RESOURCE_PATH_LEN            79
+#define IO_MAX_UNITS_NAME_LEN               23
+#define IO_MAX_STRING_VALUE_LEN             50000
+#define IO_NOW                              0.0
+
+typedef enum
+{
+    IO_DATA_TYPE_TRIGGER,
+    IO_DATA_TYPE_BOOLEAN,
+    IO_DATA_TYPE_NUMERIC,
+    IO_DATA_TYPE_STRING,
+    IO_DATA_TYPE_JSON
+}
+io_DataType_t;
+
+typedef void (*io_TriggerPushHandlerFunc_t)(double timestamp, void* contextPtr);
+typedef void (*io_BooleanPushHandlerFunc_t)(double timestamp, bool value, void* contextPtr);
+typedef void (*io_NumericPushHandlerFunc_t)(double timestamp, double value, void* contextPtr);
+typedef void (*io_StringPushHandlerFunc_t)(double timestamp, const char* value, void* contextPtr);
+typedef void (*io_JsonPushHandlerFunc_t)(double timestamp, const char* value, void* contextPtr);
+
+typedef struct io_PushHandler* io_TriggerPushHandlerRef_t;
+typedef struct io_PushHandler* io_BooleanPushHandlerRef_t;
+typedef struct io_PushHandler* io_NumericPushHandlerRef_t;
+typedef struct io_PushHandler* io_StringPushHandlerRef_t;
+typedef struct io_PushHandler* io_JsonPushHandlerRef_t;
+
+le_result_t io_CreateInput(const char* path, io_DataType_t dataType, const char* units);
+le_result_t io_CreateOutput(const char* path, io_DataType_t dataType, const char* units);
+void io_PushTrigger(const char* path, double timestamp);
+void io_PushBoolean(const char* path, double timestamp, bool value);
+void io_PushNumeric(const char* path, double timestamp, double value);
+void io_PushString(const char* path, double timestamp, const char* value);
+void io_PushJson(const char* path, double timestamp, const char* value);
+io_TriggerPushHandlerRef_t io_AddTriggerPushHandler(const char* path,
+                                                    io_TriggerPushHandlerFunc_t callbackPtr,
+                                                    void* contextPtr);
+io_BooleanPushHandlerRef_t io_AddBooleanPushHandler(const char* path,
+                                                    io_BooleanPushHandlerFunc_t callbackPtr,
+                                                    void* contextPtr);
+io_NumericPushHandlerRef_t io_AddNumericPushHandler(const char* path,
+                                                    io_NumericPushHandlerFunc_t callbackPtr,
+                                                    void* contextPtr);
+io_StringPushHandlerRef_t io_AddStringPushHandler(const char* path,
+                                                  io_StringPushHandlerFunc_t callbackPtr,
+                                                  void* contextPtr);
+io_JsonPushHandlerRef_t io_AddJsonPushHandler(const char* path,
+                                              io_JsonPushHandlerFunc_t callbackPtr,
+                                              void* contextPtr);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Data Hub administration (admin.api). Paths are absolute, e.g. /app/sensorFw/<resource>.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef io_JsonPushHandlerFunc_t admin_JsonPushHandlerFunc_t;
+typedef io_NumericPushHandlerFunc_t admin_NumericPushHandlerFunc_t;
+typedef struct io_PushHandler* admin_JsonPushHandlerRef_t;
+typedef struct io_PushHandler* admin_NumericPushHandlerRef_t;
+
+void admin_SetBufferMaxCount(const char* path, uint32_t count);
+void admin_SetBufferBackupPeriod(const char* path, uint32_t seconds);
+void admin_PushTrigger(const char* path, double timestamp);
+void admin_PushBoolean(const char* path, double timestamp, bool value);
+void admin_PushNumeric(const char* path, double timestamp, double value);
+void admin_PushString(const char* path, double timestamp, const char* value);
+void admin_PushJson(const char* path, double timestamp, const char* value);
+admin_NumericPushHandlerRef_t admin_AddNumericPushHandler(const char* path,
+                                                          admin_NumericPushHandlerFunc_t handler,
+                                                          void* contextPtr);
+admin_JsonPushHandlerRef_t admin_AddJsonPushHandler(const char* path,
+                                                    admin_JsonPushHandlerFunc_t callbackPtr,
+                                                    void* contextPtr);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Configuration tree (le_cfg.api). Changes are applied immediately, transactions are not
+ * isolated.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_CFG_STR_LEN_BYTES                512
+#define LE_CFG_NAME_LEN_BYTES               128
+
+typedef struct le_cfg_Iterator* le_cfg_IteratorRef_t;
+
+le_cfg_IteratorRef_t le_cfg_CreateReadTxn(const char* basePath);
+le_cfg_IteratorRef_t le_cfg_CreateWriteTxn(const char* basePath);
+void le_cfg_CommitTxn(le_cfg_IteratorRef_t iteratorRef);
+void le_cfg_CancelTxn(le_cfg_IteratorRef_t iteratorRef);
+le_result_t le_cfg_GoToNode(le_cfg_IteratorRef_t iteratorRef, const char* newPath);
+le_result_t le_cfg_GoToParent(le_cfg_IteratorRef_t iteratorRef);
+le_result_t le_cfg_GoToFirstChild(le_cfg_IteratorRef_t iteratorRef);
+le_result_t le_cfg_GoToNextSibling(le_cfg_IteratorRef_t iteratorRef);
+le_result_t le_cfg_GetNodeName(le_cfg_IteratorRef_t iteratorRef, const char* path, char* name,
+                               size_t nameSize);
+bool le_cfg_NodeExists(le_cfg_IteratorRef_t iteratorRef, const char* path);
+void le_cfg_DeleteNode(le_cfg_IteratorRef_t iteratorRef, const char* path);
+le_result_t le_cfg_GetString(le_cfg_IteratorRef_t iteratorRef, const char* path, char* value,
+                             size_t valueSize, const char* defaultValue);
+void le_cfg_SetString(le_cfg_IteratorRef_t iteratorRef, const char* path, const char* value);
+int32_t le_cfg_GetInt(le_cfg_IteratorRef_t iteratorRef, const char* path, int32_t defaultValue);
+void le_cfg_SetInt(le_cfg_IteratorRef_t iteratorRef, const char* path, int32_t value);
+double le_cfg_GetFloat(le_cfg_IteratorRef_t iteratorRef, const char* path, double defaultValue);
+void le_cfg_SetFloat(le_cfg_IteratorRef_t iteratorRef, const char* path, double value);
+bool le_cfg_GetBool(le_cfg_IteratorRef_t iteratorRef, const char* path, bool defaultValue);
+void le_cfg_SetBool(le_cfg_IteratorRef_t iteratorRef, const char* path, bool value);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Modem services (le_info.api, le_bootReason.api, le_gnss.api), implemented by the simulated modem
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    LE_INFO_RESET_UNKNOWN,
+    LE_INFO_RESET_USER,
+    LE_INFO_RESET_HARD,
+    LE_INFO_RESET_UPDATE,
+    LE_INFO_RESET_CRASH,
+    LE_INFO_POWER_DOWN,
+    LE_INFO_VOLT_CRIT,
+    LE_INFO_TEMP_CRIT
+}
+le_info_Reset_t;
+
+le_result_t le_info_GetResetInformation(le_info_Reset_t* resetPtr, char* resetSpecificInfoStr,
+                                        size_t resetSpecificInfoStrSize);
+
+bool le_bootReason_WasTimer(void);
+bool le_bootReason_WasGpio(uint32_t gpioNum);
+bool le_bootReason_WasAdc(uint32_t adcNum);
+
+typedef struct le_gnss_Sample* le_gnss_SampleRef_t;
+typedef struct le_gnss_PositionHandler* le_gnss_PositionHandlerRef_t;
+typedef void (*le_gnss_PositionHandlerFunc_t)(le_gnss_SampleRef_t positionSampleRef,
+                                              void* contextPtr);
+
+le_result_t le_gnss_Enable(void);
+le_result_t le_gnss_Start(void);
+le_result_t le_gnss_Stop(void);
+le_gnss_PositionHandlerRef_t le_gnss_AddPositionHandler(le_gnss_PositionHandlerFunc_t handlerPtr,
+                                                        void* contextPtr);
+void le_gnss_RemovePositionHandler(le_gnss_PositionHandlerRef_t handlerRef);
+le_result_t le_gnss_GetLocation(le_gnss_SampleRef_t positionSampleRef, int32_t* latitudePtr,
+                                int32_t* longitudePtr, int32_t* hAccuracyPtr);
+le_result_t le_gnss_GetAltitude(le_gnss_SampleRef_t positionSampleRef, int32_t* altitudePtr,
+                                int32_t* vAccuracyPtr);
+le_result_t le_gnss_GetEpochTime(le_gnss_SampleRef_t positionSampleRef, uint64_t* millisecondsPtr);
+void le_gnss_ReleaseSampleRef(le_gnss_SampleRef_t positionSampleRef);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * APIs provided by sensorFw (sensorStats.api, sensorHistory.api)
+ */
+//--------------------------------------------------------------------------------------------------
+#define SENSORSTATS_MAX_PATH_LEN            79
+#define SENSORSTATS_MAX_PLUGIN_NAME_LEN     31
+#define SENSORHISTORY_MAX_PATH_LEN          79
+#define SENSORHISTORY_MAX_RECORDS           64
+
+uint32_t sensorStats_GetCount(void);
+le_result_t sensorStats_GetInfo(uint32_t index, char* pathPtr, size_t pathSize, char* pluginPtr,
+                                size_t pluginSize, double* periodPtr, bool* enabledPtr);
+le_result_t sensorStats_GetStats(uint32_t index, double* agePtr, uint32_t* sampleCountPtr,
+                                 uint32_t* failureCountPtr, uint64_t* callbackTimeUsPtr,
+                                 uint32_t* callbackMaxUsPtr, uint64_t* pushTimeUsPtr,
+                                 uint32_t* pushMaxUsPtr, uint64_t* bytesPushedPtr);
+le_result_t sensorHistory_Query(const char* pathPtr, double start, double end, double resolution,
+                                double* periodPtr, double* nextPtr, double* timePtr,
+                                size_t* timeSizePtr, double* minPtr, size_t* minSizePtr,
+                                double* maxPtr, size_t* maxSizePtr, double* meanPtr,
+                                size_t* meanSizePtr, uint32_t* countPtr, size_t* countSizePtr);
+
+#endif /* LEGATO_HOST_INTERFACES_INCLUDE_GUARD */
@@ -0,0 +1,1781 @@
+//--------------------------------------------------------------------------------------------------
+/** @file legato.c
+ *
+ * Host stand-in for the Legato framework: logging, clock, memory pools, hash maps, timers, file
+ * descriptor monitors, command line options and the event loop.
+ *
+ * The relative and absolute clocks are the ones of the system plus an offset. When the loop is
+ * accelerated and nothing is ready, the offset jumps to the expiry of the next timer rather than
+ * the loop sleeping.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <ftw.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of file descriptors monitored at once
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_FD_MONITORS                     64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of command line options
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_ARG_OPTIONS                     16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Block of a memory pool, followed by the object
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct block
+{
+    struct le_mem_Pool* poolPtr;                ///< Pool the block belongs to
+    struct block* nextPtr;                      ///< Next free block
+    size_t refCount;                            ///< Number of references, 0 if free
+    long double object[];                       ///< Object, aligned for any type
+}
+block_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory pool
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_mem_Pool
+{
+    const char* namePtr;                        ///< Name of the pool
+    size_t objSize;                             ///< Size of the objects
+    size_t count;                               ///< Number of blocks of the pool
+    char* blocksPtr;                            ///< Blocks of the pool
+    size_t blockSize;                           ///< Size of a block
+    block_t* freePtr;                           ///< First free block
+    le_mem_PoolStats_t stats;                   ///< Statistics
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Entry of a hash map
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct entry
+{
+    const void* keyPtr;                         ///< Key
+    const void* valuePtr;                       ///< Value
+    struct entry* nextPtr;                      ///< Next entry of the bucket
+}
+entry_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash map
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_hashmap
+{
+    le_hashmap_HashFunc_t hashFunc;             ///< Hash of the keys
+    le_hashmap_EqualsFunc_t equalsFunc;         ///< Comparison of the keys
+    size_t bucketCount;                         ///< Number of buckets
+    size_t size;                                ///< Number of entries
+    entry_t** bucketsPtr;                       ///< Buckets
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_timer
+{
+    char name[32];                              ///< Name of the timer
+    le_timer_ExpiryHandler_t handlerFunc;       ///< Expiry handler
+    void* contextPtr;                           ///< Context
+    double interval;                            ///< Interval in seconds
+    uint32_t repeatCount;                       ///< Number of expiries, 0 to repeat forever
+    uint32_t expiryCount;                       ///< Expiries since the start
+    bool isRunning;                             ///< Is the timer started?
+    bool isDeleted;                             ///< Was the timer deleted while expiring?
+    double expiry;                              ///< Relative time of the next expiry
+    struct le_timer* nextPtr;                   ///< Next timer
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * File descriptor monitor
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_fdMonitor
+{
+    int fd;                                     ///< Monitored file descriptor
+    short events;                               ///< Enabled events
+    le_fdMonitor_HandlerFunc_t handlerFunc;     ///< Handler
+    void* contextPtr;                           ///< Context
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function queued to the event loop
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct deferred
+{
+    le_thread_Ref_t thread;                     ///< Thread the function is queued to (or NULL)
+    le_event_DeferredFunc_t func;               ///< Function
+    void* param1Ptr;                            ///< First parameter
+    void* param2Ptr;                            ///< Second parameter
+    struct deferred* nextPtr;                   ///< Next queued function
+}
+deferred_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread created by a component
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_thread
+{
+    char name[32];                              ///< Name
+    le_thread_MainFunc_t mainFunc;              ///< Main function, not run
+    void* contextPtr;                           ///< Context of the main function
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_mutex
+{
+    pthread_mutex_t mutex;                      ///< Mutex
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command line option: an integer variable, or a flag with its callback
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* shortNamePtr;                   ///< Name after "-"
+    const char* longNamePtr;                    ///< Name after "--"
+    int* intVarPtr;                             ///< Variable set, NULL for a flag
+    le_arg_FlagCallbackFunc_t flagFunc;         ///< Callback of a flag
+}
+argOption_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of the framework
+ */
+//--------------------------------------------------------------------------------------------------
+static le_log_Level_t LogLevel = LE_LOG_WARN;
+static bool IsAccelerated;
+static double ClockOffset;
+static le_timer_Ref_t TimerList;
+static le_fdMonitor_Ref_t Monitors[MAX_FD_MONITORS];
+static le_fdMonitor_Ref_t CurrentMonitor;
+static pthread_mutex_t QueueMutex = PTHREAD_MUTEX_INITIALIZER;
+static deferred_t* QueueHeadPtr;
+static deferred_t* QueueTailPtr;
+static le_thread_Ref_t CurrentThread;
+static char TempDir[PATH_MAX];
+static pid_t TempDirOwner;
+static size_t ArgCount;
+static char** ArgValues;
+static argOption_t ArgOptions[MAX_ARG_OPTIONS];
+static int ArgOptionCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the name of a result code
+ */
+//--------------------------------------------------------------------------------------------------
+const char* le_result_ToString
+(
+    le_result_t result                          ///< [IN] Result code
+)
+{
+    static const char* names[] =
+    {
+        "LE_OK", "LE_NOT_FOUND", "LE_NOT_POSSIBLE", "LE_OUT_OF_RANGE", "LE_NO_MEMORY",
+        "LE_NOT_PERMITTED", "LE_FAULT", "LE_COMM_ERROR", "LE_TIMEOUT", "LE_OVERFLOW",
+        "LE_UNDERFLOW", "LE_WOULD_BLOCK", "LE_DEADLOCK", "LE_FORMAT_ERROR", "LE_DUPLICATE",
+        "LE_BAD_PARAMETER", "LE_CLOSED", "LE_BUSY", "LE_UNSUPPORTED", "LE_IO_ERROR",
+        "LE_NOT_IMPLEMENTED", "LE_UNAVAILABLE", "LE_TERMINATED"
+    };
+
+    if ((result > LE_OK) || (-result >= (int)NUM_ARRAY_MEMBERS(names)))
+    {
+        return "(unknown)";
+    }
+
+    return names[-result];
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Log a message to stderr
+ */
+//--------------------------------------------------------------------------------------------------
+void host_Log
+(
+    le_log_Level_t level,                       ///< [IN] Severity
+    const char* filePtr,                        ///< [IN] Source file
+    int line,                                   ///< [IN] Source line
+    const char* formatPtr,                      ///< [IN] Format of the message
+    ...
+)
+{
+    static const char levels[] = "DIWECE";
+    const char* baseNamePtr = strrchr(filePtr, '/');
+    int savedErrno = errno;
+    va_list args;
+
+    if (level < LogLevel)
+    {
+        return;
+    }
+
+    fprintf(stderr, "%c %12.3f %s:%d | ", levels[level], host_GetTime(),
+            (baseNamePtr != NULL) ? baseNamePtr + 1 : filePtr, line);
+
+    // Keep errno for %m.
+    errno = savedErrno;
+    va_start(args, formatPtr);
+    vfprintf(stderr, formatPtr, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the lowest severity of the logged messages
+ */
+//--------------------------------------------------------------------------------------------------
+void host_SetLogLevel
+(
+    le_log_Level_t level                        ///< [IN] Severity
+)
+{
+    LogLevel = level;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert a time in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+static le_clk_Time_t ToClkTime
+(
+    double time                                 ///< [IN] Time in seconds
+)
+{
+    le_clk_Time_t clkTime;
+
+    clkTime.sec = (time_t)time;
+    clkTime.usec = (long)((time - (double)clkTime.sec) * 1000000.0);
+
+    if (clkTime.usec < 0)
+    {
+        clkTime.sec--;
+        clkTime.usec += 1000000;
+    }
+
+    return clkTime;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a system clock and add the offset of the accelerated clock
+ */
+//--------------------------------------------------------------------------------------------------
+static double ReadClock
+(
+    clockid_t clockId                           ///< [IN] System clock
+)
+{
+    struct timespec ts;
+
+    clock_gettime(clockId, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9) + ClockOffset;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the relative time in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+double host_GetTime
+(
+    void
+)
+{
+    return ReadClock(CLOCK_MONOTONIC);
+}
+
+le_clk_Time_t le_clk_GetRelativeTime
+(
+    void
+)
+{
+    return ToClkTime(ReadClock(CLOCK_MONOTONIC));
+}
+
+le_clk_Time_t le_clk_GetAbsoluteTime
+(
+    void
+)
+{
+    return ToClkTime(ReadClock(CLOCK_REALTIME));
+}
+
+le_clk_Time_t le_clk_Add
+(
+    le_clk_Time_t timeA,
+    le_clk_Time_t timeB
+)
+{
+    le_clk_Time_t result = { timeA.sec + timeB.sec, timeA.usec + timeB.usec };
+
+    if (result.usec >= 1000000)
+    {
+        result.sec++;
+        result.usec -= 1000000;
+    }
+
+    return result;
+}
+
+le_clk_Time_t le_clk_Sub
+(
+    le_clk_Time_t timeA,
+    le_clk_Time_t timeB
+)
+{
+    le_clk_Time_t result = { timeA.sec - timeB.sec, timeA.usec - timeB.usec };
+
+    if (result.usec < 0)
+    {
+        result.sec--;
+        result.usec += 1000000;
+    }
+
+    return result;
+}
+
+int le_clk_Compare
+(
+    le_clk_Time_t timeA,
+    le_clk_Time_t timeB
+)
+{
+    if (timeA.sec != timeB.sec)
+    {
+        return (timeA.sec > timeB.sec) ? 1 : -1;
+    }
+
+    return (timeA.usec > timeB.usec) - (timeA.usec < timeB.usec);
+}
+
+bool le_clk_GreaterThan
+(
+    le_clk_Time_t timeA,
+    le_clk_Time_t timeB
+)
+{
+    return (le_clk_Compare(timeA, timeB) > 0);
+}
+
+le_result_t le_clk_GetUTCDateTimeString
+(
+    const char* formatSpecStrPtr,
+    char* destStrPtr,
+    size_t destSize,
+    size_t* numBytesPtr
+)
+{
+    time_t now = le_clk_GetAbsoluteTime().sec;
+    struct tm brokenDown;
+    size_t length;
+
+    gmtime_r(&now, &brokenDown);
+    length = strftime(destStrPtr, destSize, formatSpecStrPtr, &brokenDown);
+
+    if (length == 0)
+    {
+        return LE_OVERFLOW;
+    }
+
+    if (numBytesPtr != NULL)
+    {
+        *numBytesPtr = length;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a string, truncated to the destination
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the string was truncated
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_utf8_Copy
+(
+    char* destStr,
+    const char* srcStr,
+    const size_t destSize,
+    size_t* numBytesPtr
+)
+{
+    size_t length = strlen(srcStr);
+    le_result_t result = LE_OK;
+
+    if (length >= destSize)
+    {
+        length = destSize - 1;
+        result = LE_OVERFLOW;
+    }
+
+    memcpy(destStr, srcStr, length);
+    destStr[length] = '\0';
+
+    if (numBytesPtr != NULL)
+    {
+        *numBytesPtr = length;
+    }
+
+    return result;
+}
+
+le_result_t le_utf8_Append
+(
+    char* destStr,
+    const char* srcStr,
+    const size_t destSize,
+    size_t* destStrLenPtr
+)
+{
+    size_t length = strlen(destStr);
+    size_t appended;
+    le_result_t result = le_utf8_Copy(destStr + length, srcStr, destSize - length, &appended);
+
+    if (destStrLenPtr != NULL)
+    {
+        *destStrLenPtr = length + appended;
+    }
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a directory and its parents
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_dir_MakePath
+(
+    const char* pathNamePtr,
+    mode_t mode
+)
+{
+    char path[PATH_MAX];
+    char* slashPtr;
+
+    if (le_utf8_Copy(path, pathNamePtr, sizeof(path), NULL) != LE_OK)
+    {
+        return LE_OVERFLOW;
+    }
+
+    for (slashPtr = strchr(path + 1, '/'); slashPtr != NULL; slashPtr = strchr(slashPtr + 1, '/'))
+    {
+        *slashPtr = '\0';
+
+        if ((mkdir(path, mode) != 0) && (errno != EEXIST))
+        {
+            return LE_FAULT;
+        }
+
+        *slashPtr = '/';
+    }
+
+    if ((mkdir(path, mode) != 0) && (errno != EEXIST))
+    {
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory pools
+ */
+//--------------------------------------------------------------------------------------------------
+le_mem_PoolRef_t le_mem_CreateFixedPool
+(
+    const char* namePtr,
+    size_t count,
+    size_t objSize
+)
+{
+    le_mem_PoolRef_t pool = calloc(1, sizeof(*pool));
+    size_t i;
+
+    LE_ASSERT(pool != NULL);
+
+    pool->namePtr = namePtr;
+    pool->objSize = objSize;
+    pool->count = count;
+    pool->blockSize = (sizeof(block_t) + objSize + sizeof(long double) - 1) &
+                      ~(sizeof(long double) - 1);
+    pool->blocksPtr = calloc(count, pool->blockSize);
+
+    LE_ASSERT((pool->blocksPtr != NULL) || (count == 0));
+
+    for (i = count; i > 0; i--)
+    {
+        block_t* blockPtr = (block_t*)(pool->blocksPtr + (i - 1) * pool->blockSize);
+
+        blockPtr->poolPtr = pool;
+        blockPtr->nextPtr = pool->freePtr;
+        pool->freePtr = blockPtr;
+    }
+
+    pool->stats.numFree = count;
+
+    return pool;
+}
+
+static void* TakeBlock
+(
+    le_mem_PoolRef_t pool,
+    block_t* blockPtr
+)
+{
+    blockPtr->refCount = 1;
+    pool->stats.numAllocs++;
+    pool->stats.numBlocksInUse++;
+
+    if (pool->stats.numBlocksInUse > pool->stats.maxNumBlocksUsed)
+    {
+        pool->stats.maxNumBlocksUsed = pool->stats.numBlocksInUse;
+    }
+
+    return blockPtr->object;
+}
+
+void* le_mem_TryAlloc
+(
+    le_mem_PoolRef_t pool
+)
+{
+    block_t* blockPtr = pool->freePtr;
+
+    if (blockPtr == NULL)
+    {
+        return NULL;
+    }
+
+    pool->freePtr = blockPtr->nextPtr;
+    pool->stats.numFree--;
+
+    return TakeBlock(pool, blockPtr);
+}
+
+void* le_mem_ForceAlloc
+(
+    le_mem_PoolRef_t pool
+)
+{
+    void* objPtr = le_mem_TryAlloc(pool);
+
+    if (objPtr != NULL)
+    {
+        return objPtr;
+    }
+
+    // The pool is exhausted: fall back to the heap, as a pool expansion would.
+    block_t* blockPtr = calloc(1, pool->blockSize);
+
+    LE_ASSERT(blockPtr != NULL);
+    LE_WARN("Pool %s overflowed", pool->namePtr);
+
+    blockPtr->poolPtr = pool;
+    pool->stats.numOverflows++;
+
+    return TakeBlock(pool, blockPtr);
+}
+
+void* le_mem_AssertAlloc
+(
+    le_mem_PoolRef_t pool
+)
+{
+    void* objPtr = le_mem_TryAlloc(pool);
+
+    LE_FATAL_IF(objPtr == NULL, "Pool %s is exhausted", pool->namePtr);
+    return objPtr;
+}
+
+void le_mem_AddRef
+(
+    void* objPtr
+)
+{
+    CONTAINER_OF(objPtr, block_t, object)->refCount++;
+}
+
+void le_mem_Release
+(
+    void* objPtr
+)
+{
+    block_t* blockPtr = CONTAINER_OF(objPtr, block_t, object);
+    le_mem_PoolRef_t pool = blockPtr->poolPtr;
+
+    LE_ASSERT(blockPtr->refCount > 0);
+
+    if (--blockPtr->refCount > 0)
+    {
+        return;
+    }
+
+    pool->stats.numBlocksInUse--;
+
+    if (((char*)blockPtr < pool->blocksPtr) ||
+        ((char*)blockPtr >= pool->blocksPtr + pool->count * pool->blockSize))
+    {
+        free(blockPtr);
+        return;
+    }
+
+    blockPtr->nextPtr = pool->freePtr;
+    pool->freePtr = blockPtr;
+    pool->stats.numFree++;
+}
+
+void le_mem_GetStats
+(
+    le_mem_PoolRef_t pool,
+    le_mem_PoolStats_t* statsPtr
+)
+{
+    *statsPtr = pool->stats;
+}
+
+size_t le_mem_GetObjectCount
+(
+    le_mem_PoolRef_t pool
+)
+{
+    return pool->count;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash maps
+ */
+//--------------------------------------------------------------------------------------------------
+le_hashmap_Ref_t le_hashmap_Create
+(
+    const char* nameStr,
+    size_t capacity,
+    le_hashmap_HashFunc_t hashFunc,
+    le_hashmap_EqualsFunc_t equalsFunc
+)
+{
+    le_hashmap_Ref_t mapRef = calloc(1, sizeof(*mapRef));
+
+    LE_ASSERT(mapRef != NULL);
+
+    mapRef->hashFunc = hashFunc;
+    mapRef->equalsFunc = equalsFunc;
+    mapRef->bucketCount = (capacity > 0) ? capacity : 1;
+    mapRef->bucketsPtr = calloc(mapRef->bucketCount, sizeof(entry_t*));
+
+    LE_ASSERT(mapRef->bucketsPtr != NULL);
+
+    return mapRef;
+}
+
+static entry_t** FindEntry
+(
+    le_hashmap_Ref_t mapRef,
+    const void* keyPtr
+)
+{
+    entry_t** entryPtrPtr = &mapRef->bucketsPtr[mapRef->hashFunc(keyPtr) % mapRef->bucketCount];
+
+    while ((*entryPtrPtr != NULL) && !mapRef->equalsFunc((*entryPtrPtr)->keyPtr, keyPtr))
+    {
+        entryPtrPtr = &(*entryPtrPtr)->nextPtr;
+    }
+
+    return entryPtrPtr;
+}
+
+void* le_hashmap_Put
+(
+    le_hashmap_Ref_t mapRef,
+    const void* keyPtr,
+    const void* valuePtr
+)
+{
+    entry_t** entryPtrPtr = FindEntry(mapRef, keyPtr);
+
+    if (*entryPtrPtr != NULL)
+    {
+        void* oldValuePtr = (void*)(*entryPtrPtr)->valuePtr;
+
+        (*entryPtrPtr)->keyPtr = keyPtr;
+        (*entryPtrPtr)->valuePtr = valuePtr;
+        return oldValuePtr;
+    }
+
+    entry_t* entryPtr = malloc(sizeof(entry_t));
+
+    LE_ASSERT(entryPtr != NULL);
+
+    entryPtr->keyPtr = keyPtr;
+    entryPtr->valuePtr = valuePtr;
+    entryPtr->nextPtr = NULL;
+    *entryPtrPtr = entryPtr;
+    mapRef->size++;
+
+    return NULL;
+}
+
+void* le_hashmap_Get
+(
+    le_hashmap_Ref_t mapRef,
+    const void* keyPtr
+)
+{
+    entry_t* entryPtr = *FindEntry(mapRef, keyPtr);
+
+    return (entryPtr != NULL) ? (void*)entryPtr->valuePtr : NULL;
+}
+
+void* le_hashmap_Remove
+(
+    le_hashmap_Ref_t mapRef,
+    const void* keyPtr
+)
+{
+    entry_t** entryPtrPtr = FindEntry(mapRef, keyPtr);
+    entry_t* entryPtr = *entryPtrPtr;
+
+    if (entryPtr == NULL)
+    {
+        return NULL;
+    }
+
+    void* valuePtr = (void*)entryPtr->valuePtr;
+
+    *entryPtrPtr = entryPtr->nextPtr;
+    free(entryPtr);
+    mapRef->size--;
+
+    return valuePtr;
+}
+
+size_t le_hashmap_Size
+(
+    le_hashmap_Ref_t mapRef
+)
+{
+    return mapRef->size;
+}
+
+size_t le_hashmap_HashString
+(
+    const void* stringToHashPtr
+)
+{
+    const unsigned char* charPtr = stringToHashPtr;
+    size_t hash = 5381;
+
+    while (*charPtr != '\0')
+    {
+        hash = hash * 33 + *charPtr++;
+    }
+
+    return hash;
+}
+
+bool le_hashmap_EqualsString
+(
+    const void* firstStringPtr,
+    const void* secondStringPtr
+)
+{
+    return (strcmp(firstStringPtr, secondStringPtr) == 0);
+}
+
+size_t le_hashmap_HashUInt32
+(
+    const void* intToHashPtr
+)
+{
+    return *(const uint32_t*)intToHashPtr;
+}
+
+bool le_hashmap_EqualsUInt32
+(
+    const void* firstIntPtr,
+    const void* secondIntPtr
+)
+{
+    return (*(const uint32_t*)firstIntPtr == *(const uint32_t*)secondIntPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Threads
+ */
+//--------------------------------------------------------------------------------------------------
+le_thread_Ref_t le_thread_Create
+(
+    const char* name,
+    le_thread_MainFunc_t mainFunc,
+    void* contextPtr
+)
+{
+    le_thread_Ref_t thread = calloc(1, sizeof(struct le_thread));
+
+    LE_ASSERT(thread != NULL);
+
+    le_utf8_Copy(thread->name, name, sizeof(thread->name), NULL);
+    thread->mainFunc = mainFunc;
+    thread->contextPtr = contextPtr;
+
+    return thread;
+}
+
+void le_thread_SetJoinable
+(
+    le_thread_Ref_t thread
+)
+{
+    LE_UNUSED(thread);
+}
+
+void le_thread_Start
+(
+    le_thread_Ref_t thread
+)
+{
+    LE_DEBUG("Thread %s runs on the host event loop", thread->name);
+}
+
+le_result_t le_thread_Cancel
+(
+    le_thread_Ref_t thread
+)
+{
+    LE_DEBUG("Thread %s cancelled", thread->name);
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Join a thread. Nothing is left to run once it is cancelled, as it only runs the functions queued
+ * to it, and none may be queued any more.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_thread_Join
+(
+    le_thread_Ref_t thread,
+    void** resultValuePtr
+)
+{
+    if (resultValuePtr != NULL)
+    {
+        *resultValuePtr = NULL;
+    }
+
+    free(thread);
+    return LE_OK;
+}
+
+le_thread_Ref_t le_thread_GetCurrent
+(
+    void
+)
+{
+    // Created threads are current while the functions queued to them run.
+    if (CurrentThread != NULL)
+    {
+        return CurrentThread;
+    }
+
+    return (le_thread_Ref_t)(uintptr_t)pthread_self();
+}
+
+void le_thread_AddDestructor
+(
+    le_thread_Destructor_t destructor,
+    void* contextPtr
+)
+{
+    LE_UNUSED(destructor);
+    LE_UNUSED(contextPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutexes
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mutex_Ref_t CreateMutex
+(
+    int type                                    ///< [IN] Type of pthread mutex
+)
+{
+    pthread_mutexattr_t attr;
+    le_mutex_Ref_t mutexRef = malloc(sizeof(struct le_mutex));
+
+    LE_ASSERT(mutexRef != NULL);
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, type);
+    pthread_mutex_init(&mutexRef->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    return mutexRef;
+}
+
+le_mutex_Ref_t le_mutex_CreateNonRecursive
+(
+    const char* nameStr
+)
+{
+    return CreateMutex(PTHREAD_MUTEX_ERRORCHECK);
+}
+
+le_mutex_Ref_t le_mutex_CreateRecursive
+(
+    const char* nameStr
+)
+{
+    return CreateMutex(PTHREAD_MUTEX_RECURSIVE);
+}
+
+void le_mutex_Delete
+(
+    le_mutex_Ref_t mutexRef
+)
+{
+    pthread_mutex_destroy(&mutexRef->mutex);
+    free(mutexRef);
+}
+
+void le_mutex_Lock
+(
+    le_mutex_Ref_t mutexRef
+)
+{
+    LE_FATAL_IF(pthread_mutex_lock(&mutexRef->mutex) != 0, "Deadlock");
+}
+
+void le_mutex_Unlock
+(
+    le_mutex_Ref_t mutexRef
+)
+{
+    LE_FATAL_IF(pthread_mutex_unlock(&mutexRef->mutex) != 0, "Mutex not held");
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a function to the event loop. There is a single loop, whatever the thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_event_QueueFunction
+(
+    le_event_DeferredFunc_t func,
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    le_event_QueueFunctionToThread(NULL, func, param1Ptr, param2Ptr);
+}
+
+void le_event_QueueFunctionToThread
+(
+    le_thread_Ref_t thread,
+    le_event_DeferredFunc_t func,
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    deferred_t* deferredPtr = malloc(sizeof(deferred_t));
+
+    LE_ASSERT(deferredPtr != NULL);
+
+    deferredPtr->thread = thread;
+    deferredPtr->func = func;
+    deferredPtr->param1Ptr = param1Ptr;
+    deferredPtr->param2Ptr = param2Ptr;
+    deferredPtr->nextPtr = NULL;
+
+    pthread_mutex_lock(&QueueMutex);
+
+    if (QueueTailPtr != NULL)
+    {
+        QueueTailPtr->nextPtr = deferredPtr;
+    }
+    else
+    {
+        QueueHeadPtr = deferredPtr;
+    }
+
+    QueueTailPtr = deferredPtr;
+
+    pthread_mutex_unlock(&QueueMutex);
+}
+
+void le_event_RunLoop
+(
+    void
+)
+{
+    LE_FATAL("Event loops of threads are not run on the host");
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the functions queued so far
+ *
+ * @return:
+ *      - Number of functions run
+ */
+//--------------------------------------------------------------------------------------------------
+static int RunQueue
+(
+    void
+)
+{
+    deferred_t* deferredPtr;
+    int count = 0;
+
+    pthread_mutex_lock(&QueueMutex);
+    deferredPtr = QueueHeadPtr;
+    QueueHeadPtr = NULL;
+    QueueTailPtr = NULL;
+    pthread_mutex_unlock(&QueueMutex);
+
+    while (deferredPtr != NULL)
+    {
+        deferred_t* nextPtr = deferredPtr->nextPtr;
+
+        CurrentThread = deferredPtr->thread;
+        deferredPtr->func(deferredPtr->param1Ptr, deferredPtr->param2Ptr);
+        CurrentThread = NULL;
+        free(deferredPtr);
+        deferredPtr = nextPtr;
+        count++;
+    }
+
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timers
+ */
+//--------------------------------------------------------------------------------------------------
+le_timer_Ref_t le_timer_Create
+(
+    const char* nameStr
+)
+{
+    le_timer_Ref_t timerRef = calloc(1, sizeof(*timerRef));
+
+    LE_ASSERT(timerRef != NULL);
+
+    le_utf8_Copy(timerRef->name, nameStr, sizeof(timerRef->name), NULL);
+    timerRef->interval = 1;
+    timerRef->repeatCount = 1;
+    timerRef->nextPtr = TimerList;
+    TimerList = timerRef;
+
+    return timerRef;
+}
+
+void le_timer_Delete
+(
+    le_timer_Ref_t timerRef
+)
+{
+    // Freed by the loop, as the timer may be deleted by its own handler.
+    timerRef->isRunning = false;
+    timerRef->isDeleted = true;
+}
+
+le_result_t le_timer_SetHandler
+(
+    le_timer_Ref_t timerRef,
+    le_timer_ExpiryHandler_t handlerFunc
+)
+{
+    timerRef->handlerFunc = handlerFunc;
+    return LE_OK;
+}
+
+le_result_t le_timer_SetMsInterval
+(
+    le_timer_Ref_t timerRef,
+    uint32_t interval
+)
+{
+    timerRef->interval = interval / 1000.0;
+    return LE_OK;
+}
+
+le_result_t le_timer_SetInterval
+(
+    le_timer_Ref_t timerRef,
+    le_clk_Time_t interval
+)
+{
+    timerRef->interval = (double)interval.sec + (interval.usec / 1000000.0);
+    return LE_OK;
+}
+
+le_result_t le_timer_SetRepeat
+(
+    le_timer_Ref_t timerRef,
+    uint32_t repeatCount
+)
+{
+    timerRef->repeatCount = repeatCount;
+    return LE_OK;
+}
+
+le_result_t le_timer_SetContextPtr
+(
+    le_timer_Ref_t timerRef,
+    void* contextPtr
+)
+{
+    timerRef->contextPtr = contextPtr;
+    return LE_OK;
+}
+
+void* le_timer_GetContextPtr
+(
+    le_timer_Ref_t timerRef
+)
+{
+    return timerRef->contextPtr;
+}
+
+le_result_t le_timer_Start
+(
+    le_timer_Ref_t timerRef
+)
+{
+    if (timerRef->isRunning)
+    {
+        return LE_BUSY;
+    }
+
+    timerRef->isRunning = true;
+    timerRef->expiryCount = 0;
+    timerRef->expiry = host_GetTime() + timerRef->interval;
+
+    return LE_OK;
+}
+
+le_result_t le_timer_Stop
+(
+    le_timer_Ref_t timerRef
+)
+{
+    if (!timerRef->isRunning)
+    {
+        return LE_FAULT;
+    }
+
+    timerRef->isRunning = false;
+    return LE_OK;
+}
+
+le_result_t le_timer_Restart
+(
+    le_timer_Ref_t timerRef
+)
+{
+    timerRef->isRunning = false;
+    return le_timer_Start(timerRef);
+}
+
+bool le_timer_IsRunning
+(
+    le_timer_Ref_t timerRef
+)
+{
+    return timerRef->isRunning;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Free the deleted timers and find the running timer expiring first
+ *
+ * @return:
+ *      - Timer, NULL if none is running
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t GetNextTimer
+(
+    void
+)
+{
+    le_timer_Ref_t* timerRefPtr = &TimerList;
+    le_timer_Ref_t nextRef = NULL;
+
+    while (*timerRefPtr != NULL)
+    {
+        le_timer_Ref_t timerRef = *timerRefPtr;
+
+        if (timerRef->isDeleted)
+        {
+            *timerRefPtr = timerRef->nextPtr;
+            free(timerRef);
+            continue;
+        }
+
+        if (timerRef->isRunning && ((nextRef == NULL) || (timerRef->expiry < nextRef->expiry)))
+        {
+            nextRef = timerRef;
+        }
+
+        timerRefPtr = &timerRef->nextPtr;
+    }
+
+    return nextRef;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expire a timer. A repeating timer keeps its phase; expiries missed by a stalled loop are
+ * skipped.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ExpireTimer
+(
+    le_timer_Ref_t timerRef,
+    double now
+)
+{
+    timerRef->expiryCount++;
+
+    if ((timerRef->repeatCount != 0) && (timerRef->expiryCount >= timerRef->repeatCount))
+    {
+        timerRef->isRunning = false;
+    }
+    else if (timerRef->interval > 0)
+    {
+        do
+        {
+            timerRef->expiry += timerRef->interval;
+        }
+        while (timerRef->expiry <= now);
+    }
+    else
+    {
+        timerRef->expiry = now;
+    }
+
+    if (timerRef->handlerFunc != NULL)
+    {
+        timerRef->handlerFunc(timerRef);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * File descriptor monitors
+ */
+//--------------------------------------------------------------------------------------------------
+le_fdMonitor_Ref_t le_fdMonitor_Create
+(
+    const char* name,
+    int fd,
+    le_fdMonitor_HandlerFunc_t handlerFunc,
+    short events
+)
+{
+    int i;
+
+    for (i = 0; i < MAX_FD_MONITORS; i++)
+    {
+        if (Monitors[i] == NULL)
+        {
+            le_fdMonitor_Ref_t monitorRef = calloc(1, sizeof(*monitorRef));
+
+            LE_ASSERT(monitorRef != NULL);
+
+            monitorRef->fd = fd;
+            monitorRef->events = events;
+            monitorRef->handlerFunc = handlerFunc;
+            Monitors[i] = monitorRef;
+            return monitorRef;
+        }
+    }
+
+    LE_FATAL("Too many fd monitors, cannot monitor %s", name);
+}
+
+void le_fdMonitor_Delete
+(
+    le_fdMonitor_Ref_t monitorRef
+)
+{
+    int i;
+
+    for (i = 0; i < MAX_FD_MONITORS; i++)
+    {
+        if (Monitors[i] == monitorRef)
+        {
+            Monitors[i] = NULL;
+        }
+    }
+
+    if (CurrentMonitor == monitorRef)
+    {
+        CurrentMonitor = NULL;
+    }
+
+    free(monitorRef);
+}
+
+void le_fdMonitor_Enable
+(
+    le_fdMonitor_Ref_t monitorRef,
+    short events
+)
+{
+    monitorRef->events |= events;
+}
+
+void le_fdMonitor_Disable
+(
+    le_fdMonitor_Ref_t monitorRef,
+    short events
+)
+{
+    monitorRef->events &= ~events;
+}
+
+void le_fdMonitor_SetContextPtr
+(
+    le_fdMonitor_Ref_t monitorRef,
+    void* contextPtr
+)
+{
+    monitorRef->contextPtr = contextPtr;
+}
+
+void* le_fdMonitor_GetContextPtr
+(
+    void
+)
+{
+    return (CurrentMonitor != NULL) ? CurrentMonitor->contextPtr : NULL;
+}
+
+le_fdMonitor_Ref_t le_fdMonitor_GetMonitor
+(
+    void
+)
+{
+    return CurrentMonitor;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command line options, set by the program with le_arg_SetArgs() before the components scan them
+ */
+//--------------------------------------------------------------------------------------------------
+void le_arg_SetArgs
+(
+    const size_t argc,
+    char** argv
+)
+{
+    ArgCount = argc;
+    ArgValues = argv;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a command line option
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddArgOption
+(
+    const char* shortNamePtr,                   ///< [IN] Name after "-", NULL if none
+    const char* longNamePtr,                    ///< [IN] Name after "--", NULL if none
+    int* intVarPtr,                             ///< [IN] Variable set, NULL for a flag
+    le_arg_FlagCallbackFunc_t flagFunc          ///< [IN] Callback of a flag
+)
+{
+    LE_ASSERT(ArgOptionCount < MAX_ARG_OPTIONS);
+
+    ArgOptions[ArgOptionCount].shortNamePtr = shortNamePtr;
+    ArgOptions[ArgOptionCount].longNamePtr = longNamePtr;
+    ArgOptions[ArgOptionCount].intVarPtr = intVarPtr;
+    ArgOptions[ArgOptionCount].flagFunc = flagFunc;
+    ArgOptionCount++;
+}
+
+void le_arg_SetIntVar
+(
+    int* varPtr,
+    const char* shortName,
+    const char* longName
+)
+{
+    AddArgOption(shortName, longName, varPtr, NULL);
+}
+
+void le_arg_SetFlagCallback
+(
+    le_arg_FlagCallbackFunc_t func,
+    const char* shortName,
+    const char* longName
+)
+{
+    AddArgOption(shortName, longName, NULL, func);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the option named by a command line argument, "-x" or "--name" (with "=value" for a variable)
+ *
+ * @return:
+ *      - Option, NULL if unknown
+ */
+//--------------------------------------------------------------------------------------------------
+static argOption_t* FindArgOption
+(
+    const char* argPtr,                         ///< [IN]  Argument
+    const char** valuePtrPtr                    ///< [OUT] Value after "=", NULL if none
+)
+{
+    int i;
+
+    *valuePtrPtr = NULL;
+
+    if ((argPtr[0] != '-') || (argPtr[1] == '\0'))
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < ArgOptionCount; i++)
+    {
+        argOption_t* optionPtr = &ArgOptions[i];
+
+        if ((argPtr[1] != '-') && (optionPtr->shortNamePtr != NULL) &&
+            (strcmp(argPtr + 1, optionPtr->shortNamePtr) == 0))
+        {
+            return optionPtr;
+        }
+
+        if ((argPtr[1] == '-') && (optionPtr->longNamePtr != NULL))
+        {
+            size_t length = strlen(optionPtr->longNamePtr);
+
+            if ((strncmp(argPtr + 2, optionPtr->longNamePtr, length) == 0) &&
+                ((argPtr[2 + length] == '\0') || (argPtr[2 + length] == '=')))
+            {
+                if (argPtr[2 + length] == '=')
+                {
+                    *valuePtrPtr = argPtr + 3 + length;
+                }
+
+                return optionPtr;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scan the command line options. The program exits on an unknown option or a missing value, as
+ * with Legato.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_arg_Scan
+(
+    void
+)
+{
+    size_t i;
+
+    for (i = 1; i < ArgCount; i++)
+    {
+        const char* valuePtr;
+        argOption_t* optionPtr = FindArgOption(ArgValues[i], &valuePtr);
+
+        if (optionPtr == NULL)
+        {
+            fprintf(stderr, "Unexpected argument '%s'\n", ArgValues[i]);
+            exit(EXIT_FAILURE);
+        }
+
+        if (optionPtr->intVarPtr == NULL)
+        {
+            optionPtr->flagFunc();
+            continue;
+        }
+
+        if ((valuePtr == NULL) && (i + 1 < ArgCount))
+        {
+            valuePtr = ArgValues[++i];
+        }
+
+        if (valuePtr == NULL)
+        {
+            fprintf(stderr, "Missing value of '%s'\n", ArgValues[i]);
+            exit(EXIT_FAILURE);
+        }
+
+        *optionPtr->intVarPtr = atoi(valuePtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Poll the monitored file descriptors and call the handlers of the ready ones
+ *
+ * @return:
+ *      - Number of handlers called
+ */
+//--------------------------------------------------------------------------------------------------
+static int PollMonitors
+(
+    double timeout                              ///< [IN] Longest wait in seconds
+)
+{
+    struct pollfd fds[MAX_FD_MONITORS];
+    le_fdMonitor_Ref_t monitorRefs[MAX_FD_MONITORS];
+    nfds_t count = 0;
+    int timeoutMs = (timeout > 0) ? (int)(timeout * 1000.0 + 0.999) : 0;
+    int handled = 0;
+    nfds_t i;
+    int j;
+
+    for (j = 0; j < MAX_FD_MONITORS; j++)
+    {
+        if ((Monitors[j] != NULL) && (Monitors[j]->events != 0))
+        {
+            fds[count].fd = Monitors[j]->fd;
+            fds[count].events = Monitors[j]->events;
+            monitorRefs[count] = Monitors[j];
+            count++;
+        }
+    }
+
+    if (count == 0)
+    {
+        if (timeoutMs > 0)
+        {
+            poll(NULL, 0, timeoutMs);
+        }
+
+        return 0;
+    }
+
+    if (poll(fds, count, timeoutMs) <= 0)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (fds[i].revents == 0)
+        {
+            continue;
+        }
+
+        // The monitor may have been deleted by a previous handler.
+        for (j = 0; (j < MAX_FD_MONITORS) && (Monitors[j] != monitorRefs[i]); j++)
+        {
+        }
+
+        if (j == MAX_FD_MONITORS)
+        {
+            continue;
+        }
+
+        CurrentMonitor = monitorRefs[i];
+        CurrentMonitor->handlerFunc(fds[i].fd, fds[i].revents);
+        CurrentMonitor = NULL;
+        handled++;
+    }
+
+    return handled;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Let the event loop advance the clock over idle time instead of sleeping
+ */
+//--------------------------------------------------------------------------------------------------
+void host_SetAccelerated
+(
+    bool isAccelerated                          ///< [IN] Skip idle time?
+)
+{
+    IsAccelerated = isAccelerated;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove an entry of the temporary directory, called by nftw() children first
+ *
+ * @return:
+ *      - 0, to carry on with the next entry
+ */
+//--------------------------------------------------------------------------------------------------
+static int RemoveTempEntry
+(
+    const char* pathPtr,                        ///< [IN] Path of the entry
+    const struct stat* statPtr,                 ///< [IN] Status of the entry
+    int type,                                   ///< [IN] Type of the entry
+    struct FTW* ftwPtr                          ///< [IN] Depth of the entry
+)
+{
+    remove(pathPtr);
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the temporary directory when the process that created it exits
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveTempDir
+(
+    void
+)
+{
+    if (getpid() == TempDirOwner)
+    {
+        nftw(TempDir, RemoveTempEntry, 16, FTW_DEPTH | FTW_PHYS);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run in a new temporary directory, removed at exit. The host build gives sensorFw relative paths
+ * for its state and metrics socket, so that runs start cold and do not disturb one another.
+ */
+//--------------------------------------------------------------------------------------------------
+void host_UseTempDir
+(
+    void
+)
+{
+    const char* baseDirPtr = getenv("TMPDIR");
+
+    snprintf(TempDir, sizeof(TempDir), "%s/sensorFwHost.XXXXXX",
+             (baseDirPtr != NULL) ? baseDirPtr : "/tmp");
+
+    LE_FATAL_IF(mkdtemp(TempDir) == NULL, "Cannot create %s: %m", TempDir);
+    LE_FATAL_IF(chdir(TempDir) != 0, "Cannot enter %s: %m", TempDir);
+
+    TempDirOwner = getpid();
+    atexit(RemoveTempDir);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Block the calling thread, e.g. to stand for a slow call. With the accelerated clock, the time
+ * is only added to the clock.
+ */
+//--------------------------------------------------------------------------------------------------
+void host_Sleep
+(
+    double duration                             ///< [IN] Duration in seconds
+)
+{
+    if (duration <= 0)
+    {
+        return;
+    }
+
+    if (IsAccelerated)
+    {
+        ClockOffset += duration;
+        return;
+    }
+
+    struct timespec ts = { (time_t)duration, (long)((duration - (time_t)duration) * 1e9) };
+
+    while ((nanosleep(&ts, &ts) != 0) && (errno == EINTR))
+    {
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the event loop for some time
+ */
+//--------------------------------------------------------------------------------------------------
+void host_RunFor
+(
+    double duration                             ///< [IN] Duration in seconds
+)
+{
+    double end = host_GetTime() + duration;
+
+    for (;;)
+    {
+        int handled = RunQueue();
+        le_timer_Ref_t timerRef = GetNextTimer();
+        double now = host_GetTime();
+        double wakeUp = ((timerRef != NULL) && (timerRef->expiry < end)) ? timerRef->expiry : end;
+
+        if ((timerRef != NULL) && (timerRef->expiry <= now))
+        {
+            ExpireTimer(timerRef, now);
+            continue;
+        }
+
+        if (now >= end)
+        {
+            break;
+        }
+
+        handled += PollMonitors(((handled > 0) || IsAccelerated) ? 0 : wakeUp - now);
+
+        // Nothing to do until the next timer: skip the idle time.
+        if ((handled == 0) && IsAccelerated)
+        {
+            now = host_GetTime();
+
+            if (wakeUp > now)
+            {
+                ClockOffset += wakeUp - now;
+            }
+        }
+    }
+
+    RunQueue();
+}
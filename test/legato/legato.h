@@ -0,0 +1,341 @@
+//--------------------------------------------------------------------------------------------------
+/** @file legato.h
+ *
+ * Host stand-in for the parts of the Legato framework used by sensorFw and the plugins, so that
+ * they can be built and exercised on a development machine without a target.
+ *
+ * The event loop runs on a clock that can be accelerated: when nothing is ready, the clock jumps
+ * to the next timer instead of sleeping. Time spent computing still elapses, so the durations
+ * measured by sensorFw stay meaningful while days of sampling run in seconds.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_INCLUDE_GUARD
+#define LEGATO_HOST_INCLUDE_GUARD
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <poll.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build configuration of the framework
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_CONFIG_LINUX                     1
+#define LE_CONFIG_RTOS                      0
+#ifndef LE_CONFIG_REDUCE_FOOTPRINT
+#define LE_CONFIG_REDUCE_FOOTPRINT          0
+#endif
+
+#define LE_SHARED
+#define LE_UNUSED(v)                        ((void)(v))
+#define LE_STATIC_ASSERT(cond, msg)         _Static_assert(cond, msg)
+#define NUM_ARRAY_MEMBERS(array)            (sizeof(array) / sizeof((array)[0]))
+#define CONTAINER_OF(ptr, type, member)     ((type*)((char*)(ptr) - offsetof(type, member)))
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialization function of a component. Every component is built with its own
+ * COMPONENT_INIT_NAME so that several of them can be linked in the same executable.
+ */
+//--------------------------------------------------------------------------------------------------
+#define COMPONENT_INIT                      void COMPONENT_INIT_NAME(void)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Result codes
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    LE_OK = 0,
+    LE_NOT_FOUND = -1,
+    LE_NOT_POSSIBLE = -2,
+    LE_OUT_OF_RANGE = -3,
+    LE_NO_MEMORY = -4,
+    LE_NOT_PERMITTED = -5,
+    LE_FAULT = -6,
+    LE_COMM_ERROR = -7,
+    LE_TIMEOUT = -8,
+    LE_OVERFLOW = -9,
+    LE_UNDERFLOW = -10,
+    LE_WOULD_BLOCK = -11,
+    LE_DEADLOCK = -12,
+    LE_FORMAT_ERROR = -13,
+    LE_DUPLICATE = -14,
+    LE_BAD_PARAMETER = -15,
+    LE_CLOSED = -16,
+    LE_BUSY = -17,
+    LE_UNSUPPORTED = -18,
+    LE_IO_ERROR = -19,
+    LE_NOT_IMPLEMENTED = -20,
+    LE_UNAVAILABLE = -21,
+    LE_TERMINATED = -22
+}
+le_result_t;
+
+const char* le_result_ToString(le_result_t result);
+
+#define LE_RESULT_TXT(v)                    le_result_ToString(v)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logging, to stderr. Messages below the level set with host_SetLogLevel() are dropped.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    LE_LOG_DEBUG,
+    LE_LOG_INFO,
+    LE_LOG_WARN,
+    LE_LOG_ERR,
+    LE_LOG_CRIT,
+    LE_LOG_EMERG
+}
+le_log_Level_t;
+
+void host_Log(le_log_Level_t level, const char* filePtr, int line, const char* formatPtr, ...)
+    __attribute__((format(printf, 4, 5)));
+
+#define LE_DEBUG(...)           host_Log(LE_LOG_DEBUG, __FILE__, __LINE__, __VA_ARGS__)
+#define LE_INFO(...)            host_Log(LE_LOG_INFO, __FILE__, __LINE__, __VA_ARGS__)
+#define LE_WARN(...)            host_Log(LE_LOG_WARN, __FILE__, __LINE__, __VA_ARGS__)
+#define LE_ERROR(...)           host_Log(LE_LOG_ERR, __FILE__, __LINE__, __VA_ARGS__)
+#define LE_CRIT(...)            host_Log(LE_LOG_CRIT, __FILE__, __LINE__, __VA_ARGS__)
+#define LE_FATAL(...)           do { host_Log(LE_LOG_EMERG, __FILE__, __LINE__, __VA_ARGS__); \
+                                     abort(); } while (0)
+#define LE_FATAL_IF(c, ...)     do { if (c) { LE_FATAL(__VA_ARGS__); } } while (0)
+#define LE_ERROR_IF(c, ...)     do { if (c) { LE_ERROR(__VA_ARGS__); } } while (0)
+#define LE_WARN_IF(c, ...)      do { if (c) { LE_WARN(__VA_ARGS__); } } while (0)
+#define LE_ASSERT(c)            LE_FATAL_IF(!(c), "Assert Failed: '%s'", #c)
+#define LE_ASSERT_OK(c)         LE_FATAL_IF((c) != LE_OK, "Assert Failed: '%s' is LE_OK", #c)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clock
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    time_t sec;
+    long usec;
+}
+le_clk_Time_t;
+
+#define LE_CLK_STRING_FORMAT_DATE_TIME      "%c"
+
+le_clk_Time_t le_clk_GetRelativeTime(void);
+le_clk_Time_t le_clk_GetAbsoluteTime(void);
+le_clk_Time_t le_clk_Add(le_clk_Time_t timeA, le_clk_Time_t timeB);
+le_clk_Time_t le_clk_Sub(le_clk_Time_t timeA, le_clk_Time_t timeB);
+bool le_clk_GreaterThan(le_clk_Time_t timeA, le_clk_Time_t timeB);
+int le_clk_Compare(le_clk_Time_t timeA, le_clk_Time_t timeB);
+le_result_t le_clk_GetUTCDateTimeString(const char* formatSpecStrPtr, char* destStrPtr,
+                                        size_t destSize, size_t* numBytesPtr);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * UTF-8 strings
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_utf8_Copy(char* destStr, const char* srcStr, const size_t destSize,
+                         size_t* numBytesPtr);
+le_result_t le_utf8_Append(char* destStr, const char* srcStr, const size_t destSize,
+                           size_t* destStrLenPtr);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directories
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_dir_MakePath(const char* pathNamePtr, mode_t mode);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory pools. Pools are fixed; ForceAlloc() falls back to the heap once a pool is exhausted and
+ * counts an overflow.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_mem_Pool* le_mem_PoolRef_t;
+
+typedef struct
+{
+    size_t numBlocksInUse;
+    size_t maxNumBlocksUsed;
+    size_t numOverflows;
+    uint64_t numAllocs;
+    size_t numFree;
+}
+le_mem_PoolStats_t;
+
+#define LE_MEM_DEFINE_STATIC_POOL(name, num, size)  \
+    static const size_t _mem_##name##Count = (num)
+
+#define le_mem_InitStaticPool(name, num, size)      \
+    le_mem_CreateFixedPool(#name, _mem_##name##Count, (size))
+
+le_mem_PoolRef_t le_mem_CreateFixedPool(const char* namePtr, size_t count, size_t objSize);
+void* le_mem_TryAlloc(le_mem_PoolRef_t pool);
+void* le_mem_ForceAlloc(le_mem_PoolRef_t pool);
+void* le_mem_AssertAlloc(le_mem_PoolRef_t pool);
+void le_mem_AddRef(void* objPtr);
+void le_mem_Release(void* objPtr);
+void le_mem_GetStats(le_mem_PoolRef_t pool, le_mem_PoolStats_t* statsPtr);
+size_t le_mem_GetObjectCount(le_mem_PoolRef_t pool);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash maps
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_hashmap* le_hashmap_Ref_t;
+typedef size_t (*le_hashmap_HashFunc_t)(const void* keyToHashPtr);
+typedef bool (*le_hashmap_EqualsFunc_t)(const void* firstKeyPtr, const void* secondKeyPtr);
+
+#define LE_HASHMAP_DEFINE_STATIC(name, capacity)    \
+    static const size_t _hashmap_##name##Capacity = (capacity)
+
+#define le_hashmap_InitStatic(name, capacity, hashFunc, equalsFunc) \
+    le_hashmap_Create(#name, _hashmap_##name##Capacity, (hashFunc), (equalsFunc))
+
+le_hashmap_Ref_t le_hashmap_Create(const char* nameStr, size_t capacity,
+                                   le_hashmap_HashFunc_t hashFunc,
+                                   le_hashmap_EqualsFunc_t equalsFunc);
+void* le_hashmap_Put(le_hashmap_Ref_t mapRef, const void* keyPtr, const void* valuePtr);
+void* le_hashmap_Get(le_hashmap_Ref_t mapRef, const void* keyPtr);
+void* le_hashmap_Remove(le_hashmap_Ref_t mapRef, const void* keyPtr);
+size_t le_hashmap_Size(le_hashmap_Ref_t mapRef);
+size_t le_hashmap_HashString(const void* stringToHashPtr);
+bool le_hashmap_EqualsString(const void* firstStringPtr, const void* secondStringPtr);
+size_t le_hashmap_HashUInt32(const void* intToHashPtr);
+bool le_hashmap_EqualsUInt32(const void* firstIntPtr, const void* secondIntPtr);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Threads. The main function of a created thread is not run: the functions queued to the thread
+ * run on the host event loop, as the thread, as they would on the event loop of the thread.
+ * Threads looping on something else than their event loop are not simulated. Destructors are not
+ * run.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_thread* le_thread_Ref_t;
+typedef void (*le_thread_Destructor_t)(void* contextPtr);
+typedef void* (*le_thread_MainFunc_t)(void* contextPtr);
+
+le_thread_Ref_t le_thread_Create(const char* name, le_thread_MainFunc_t mainFunc,
+                                 void* contextPtr);
+void le_thread_SetJoinable(le_thread_Ref_t thread);
+void le_thread_Start(le_thread_Ref_t thread);
+le_result_t le_thread_Cancel(le_thread_Ref_t thread);
+le_result_t le_thread_Join(le_thread_Ref_t thread, void** resultValuePtr);
+le_thread_Ref_t le_thread_GetCurrent(void);
+void le_thread_AddDestructor(le_thread_Destructor_t destructor, void* contextPtr);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutexes
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_mutex* le_mutex_Ref_t;
+
+le_mutex_Ref_t le_mutex_CreateNonRecursive(const char* nameStr);
+le_mutex_Ref_t le_mutex_CreateRecursive(const char* nameStr);
+void le_mutex_Delete(le_mutex_Ref_t mutexRef);
+void le_mutex_Lock(le_mutex_Ref_t mutexRef);
+void le_mutex_Unlock(le_mutex_Ref_t mutexRef);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Event loop
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*le_event_DeferredFunc_t)(void* param1Ptr, void* param2Ptr);
+
+void le_event_QueueFunction(le_event_DeferredFunc_t func, void* param1Ptr, void* param2Ptr);
+void le_event_QueueFunctionToThread(le_thread_Ref_t thread, le_event_DeferredFunc_t func,
+                                    void* param1Ptr, void* param2Ptr);
+void le_event_RunLoop(void);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timers
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_timer* le_timer_Ref_t;
+typedef void (*le_timer_ExpiryHandler_t)(le_timer_Ref_t timerRef);
+
+le_timer_Ref_t le_timer_Create(const char* nameStr);
+void le_timer_Delete(le_timer_Ref_t timerRef);
+le_result_t le_timer_SetHandler(le_timer_Ref_t timerRef, le_timer_ExpiryHandler_t handlerFunc);
+le_result_t le_timer_SetMsInterval(le_timer_Ref_t timerRef, uint32_t interval);
+le_result_t le_timer_SetInterval(le_timer_Ref_t timerRef, le_clk_Time_t interval);
+le_result_t le_timer_SetRepeat(le_timer_Ref_t timerRef, uint32_t repeatCount);
+le_result_t le_timer_SetContextPtr(le_timer_Ref_t timerRef, void* contextPtr);
+void* le_timer_GetContextPtr(le_timer_Ref_t timerRef);
+le_result_t le_timer_Start(le_timer_Ref_t timerRef);
+le_result_t le_timer_Stop(le_timer_Ref_t timerRef);
+le_result_t le_timer_Restart(le_timer_Ref_t timerRef);
+bool le_timer_IsRunning(le_timer_Ref_t timerRef);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * File descriptor monitors
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_fdMonitor* le_fdMonitor_Ref_t;
+typedef void (*le_fdMonitor_HandlerFunc_t)(int fd, short events);
+
+le_fdMonitor_Ref_t le_fdMonitor_Create(const char* name, int fd,
+                                       le_fdMonitor_HandlerFunc_t handlerFunc, short events);
+void le_fdMonitor_Delete(le_fdMonitor_Ref_t monitorRef);
+void le_fdMonitor_Enable(le_fdMonitor_Ref_t monitorRef, short events);
+void le_fdMonitor_Disable(le_fdMonitor_Ref_t monitorRef, short events);
+void le_fdMonitor_SetContextPtr(le_fdMonitor_Ref_t monitorRef, void* contextPtr);
+void* le_fdMonitor_GetContextPtr(void);
+le_fdMonitor_Ref_t le_fdMonitor_GetMonitor(void);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command line options: integer variables and flags, as "-x value", "--name value" or
+ * "--name=value"
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*le_arg_FlagCallbackFunc_t)(void);
+
+void le_arg_SetArgs(const size_t argc, char** argv);
+void le_arg_SetIntVar(int* varPtr, const char* shortName, const char* longName);
+void le_arg_SetFlagCallback(le_arg_FlagCallbackFunc_t func, const char* shortName,
+                            const char* longName);
+void le_arg_Scan(void);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Control of the host event loop, for test and benchmark executables
+ */
+//--------------------------------------------------------------------------------------------------
+void host_SetLogLevel(le_log_Level_t level);
+void host_SetAccelerated(bool isAccelerated);
+void host_UseTempDir(void);
+void host_RunFor(double duration);
+void host_Sleep(double duration);
+double host_GetTime(void);
+
+#endif /* LEGATO_HOST_INCLUDE_GUARD */
@@ -0,0 +1,44 @@
+//--------------------------------------------------------------------------------------------------
+/** @file connectivity.h
+ *
+ * Host stand-in for the connectivity monitoring functions of LwM2MCore used by the dm plugin.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_LWM2MCORE_CONNECTIVITY_INCLUDE_GUARD
+#define LEGATO_HOST_LWM2MCORE_CONNECTIVITY_INCLUDE_GUARD
+
+#include "lwm2mcore/lwm2mcore.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Network bearer, as numbered by the LwM2M connectivity monitoring object
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    LWM2MCORE_NETWORK_BEARER_GSM            = 0,
+    LWM2MCORE_NETWORK_BEARER_TD_SCDMA       = 1,
+    LWM2MCORE_NETWORK_BEARER_WCDMA          = 2,
+    LWM2MCORE_NETWORK_BEARER_CDMA2000       = 3,
+    LWM2MCORE_NETWORK_BEARER_WIMAX          = 4,
+    LWM2MCORE_NETWORK_BEARER_LTE_TDD        = 5,
+    LWM2MCORE_NETWORK_BEARER_LTE_FDD        = 6,
+    LWM2MCORE_NETWORK_BEARER_WLAN           = 21,
+    LWM2MCORE_NETWORK_BEARER_BLUETOOTH      = 22,
+    LWM2MCORE_NETWORK_BEARER_IEEE_802_15_4  = 23,
+    LWM2MCORE_NETWORK_BEARER_ETHERNET       = 41,
+    LWM2MCORE_NETWORK_BEARER_DSL            = 42,
+    LWM2MCORE_NETWORK_BEARER_PLC            = 43
+}
+lwm2mcore_networkBearer_enum_t;
+
+lwm2mcore_Sid_t lwm2mcore_GetNetworkBearer(lwm2mcore_networkBearer_enum_t* valuePtr);
+lwm2mcore_Sid_t lwm2mcore_GetSignalStrength(int32_t* valuePtr);
+lwm2mcore_Sid_t lwm2mcore_GetCellId(uint32_t* valuePtr);
+lwm2mcore_Sid_t lwm2mcore_GetMncMcc(uint16_t* mncPtr, uint16_t* mccPtr);
+lwm2mcore_Sid_t lwm2mcore_GetRoamingIndicator(uint8_t* valuePtr);
+
+#endif /* LEGATO_HOST_LWM2MCORE_CONNECTIVITY_INCLUDE_GUARD */
@@ -0,0 +1,24 @@
+//--------------------------------------------------------------------------------------------------
+/** @file device.h
+ *
+ * Host stand-in for the device object functions of LwM2MCore used by the dm plugin. String
+ * values are copied with their terminating null character; *lenPtr is the size of the buffer on
+ * input and the length of the value on output.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_LWM2MCORE_DEVICE_INCLUDE_GUARD
+#define LEGATO_HOST_LWM2MCORE_DEVICE_INCLUDE_GUARD
+
+#include "lwm2mcore/lwm2mcore.h"
+
+lwm2mcore_Sid_t lwm2mcore_GetDeviceSerialNumber(char* bufferPtr, size_t* lenPtr);
+lwm2mcore_Sid_t lwm2mcore_GetDeviceImei(char* bufferPtr, size_t* lenPtr);
+lwm2mcore_Sid_t lwm2mcore_GetIccid(char* bufferPtr, size_t* lenPtr);
+lwm2mcore_Sid_t lwm2mcore_GetDeviceModelNumber(char* bufferPtr, size_t* lenPtr);
+lwm2mcore_Sid_t lwm2mcore_GetDeviceFirmwareVersion(char* bufferPtr, size_t* lenPtr);
+lwm2mcore_Sid_t lwm2mcore_GetDeviceTemperature(int32_t* valuePtr);
+
+#endif /* LEGATO_HOST_LWM2MCORE_DEVICE_INCLUDE_GUARD */
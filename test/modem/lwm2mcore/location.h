@@ -0,0 +1,24 @@
+//--------------------------------------------------------------------------------------------------
+/** @file location.h
+ *
+ * Host stand-in for the location object functions of LwM2MCore used by the dm plugin. Latitude,
+ * longitude and altitude are strings, as in the LwM2M location object.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_LWM2MCORE_LOCATION_INCLUDE_GUARD
+#define LEGATO_HOST_LWM2MCORE_LOCATION_INCLUDE_GUARD
+
+#include "lwm2mcore/lwm2mcore.h"
+
+lwm2mcore_Sid_t lwm2mcore_GetLatitude(char* bufferPtr, size_t* lenPtr);
+lwm2mcore_Sid_t lwm2mcore_GetLongitude(char* bufferPtr, size_t* lenPtr);
+lwm2mcore_Sid_t lwm2mcore_GetAltitude(char* bufferPtr, size_t* lenPtr);
+lwm2mcore_Sid_t lwm2mcore_GetDirection(uint32_t* valuePtr);
+lwm2mcore_Sid_t lwm2mcore_GetHorizontalSpeed(uint32_t* valuePtr);
+lwm2mcore_Sid_t lwm2mcore_GetVerticalSpeed(int32_t* valuePtr);
+lwm2mcore_Sid_t lwm2mcore_GetLocationTimestamp(uint64_t* valuePtr);
+
+#endif /* LEGATO_HOST_LWM2MCORE_LOCATION_INCLUDE_GUARD */
@@ -0,0 +1,35 @@
+//--------------------------------------------------------------------------------------------------
+/** @file lwm2mcore.h
+ *
+ * Host stand-in for the part of the LwM2MCore API used by the dm plugin, implemented by the
+ * simulated modem of modemSim.c. The declarations follow LwM2MCore.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_LWM2MCORE_INCLUDE_GUARD
+#define LEGATO_HOST_LWM2MCORE_INCLUDE_GUARD
+
+#include <stddef.h>
+#include <stdint.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Status of the LwM2MCore functions
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    LWM2MCORE_ERR_COMPLETED_OK          = 0,    ///< Success
+    LWM2MCORE_ERR_GENERAL_ERROR         = -1,   ///< General error
+    LWM2MCORE_ERR_INCORRECT_RANGE       = -2,   ///< Value out of range
+    LWM2MCORE_ERR_NOT_YET_IMPLEMENTED   = -3,   ///< Not implemented
+    LWM2MCORE_ERR_OP_NOT_SUPPORTED      = -4,   ///< Operation not supported
+    LWM2MCORE_ERR_INVALID_ARG           = -5,   ///< Invalid argument
+    LWM2MCORE_ERR_INVALID_STATE         = -6,   ///< Invalid state
+    LWM2MCORE_ERR_OVERFLOW              = -7    ///< Buffer too small
+}
+lwm2mcore_Sid_t;
+
+#endif /* LEGATO_HOST_LWM2MCORE_INCLUDE_GUARD */
@@ -0,0 +1,805 @@
+//--------------------------------------------------------------------------------------------------
+/** @file modemSim.c
+ *
+ * Simulated modem of the host tests, behind the LwM2MCore functions and the modem services used
+ * by the dm plugin.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <math.h>
+#include "interfaces.h"
+#include "lwm2mcore/connectivity.h"
+#include "lwm2mcore/device.h"
+#include "lwm2mcore/location.h"
+#include "modemSim.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Identity of the simulated device
+ */
+//--------------------------------------------------------------------------------------------------
+#define SERIAL_NUMBER           "VU0000000001"
+#define IMEI                    "359377060000001"
+#define ICCID                   "89302720000000000001"
+#define MODEL_NUMBER            "WP7702"
+#define FIRMWARE_VERSION        "SWI9X06Y_02.32.02.00"
+#define RESET_INFO              "Reset by user"
+#define MCC                     302
+#define MNC                     720
+#define CELL_ID_BASE            0x1A2B00
+#define CELL_DURATION           600             ///< Seconds spent in each cell
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Environment of the simulated device: a temperature, and a signal strength varying slowly
+ */
+//--------------------------------------------------------------------------------------------------
+#define TEMPERATURE             38              ///< deg C
+#define SIGNAL_STRENGTH         (-75)           ///< dBm
+#define SIGNAL_VARIATION        6               ///< dBm
+#define SIGNAL_PERIOD           300             ///< Seconds
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Motion of the simulated device: a straight line at a constant speed
+ */
+//--------------------------------------------------------------------------------------------------
+#define START_LATITUDE          49.1727         ///< Degrees
+#define START_LONGITUDE         (-123.0710)     ///< Degrees
+#define ALTITUDE                12.0            ///< Meters
+#define DIRECTION               45              ///< Degrees from the north
+#define SPEED                   10              ///< m/s
+#define METERS_PER_DEGREE       111320.0        ///< Along a meridian
+#define H_ACCURACY              500             ///< Centimeters
+#define V_ACCURACY              800             ///< Centimeters
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Limits
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_POSITION_HANDLERS   4
+#define FIX_INTERVAL_MS         1000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * GNSS fix and position handler
+ */
+//--------------------------------------------------------------------------------------------------
+struct le_gnss_Sample
+{
+    double time;                                ///< Relative time of the fix, in seconds
+    uint64_t epochTimeMs;                       ///< UTC time of the fix, in milliseconds
+};
+
+struct le_gnss_PositionHandler
+{
+    le_gnss_PositionHandlerFunc_t handlerPtr;   ///< Handler, NULL if the slot is free
+    void* contextPtr;                           ///< Context of the handler
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Settings and statistics of the modem calls
+ */
+//--------------------------------------------------------------------------------------------------
+static double Latency;
+static double Jitter;
+static int FailurePercent;
+static uint64_t CallCount;
+static uint64_t FailureCount;
+static double BusyTime;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of the GNSS engine
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsGnssEnabled;
+static bool IsGnssStarted;
+static le_timer_Ref_t FixTimer;
+static struct le_gnss_PositionHandler PositionHandlers[MAX_POSITION_HANDLERS];
+static struct le_gnss_Sample Fix;
+static int FixRefCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of the random generator (xorshift64*), fixed so that the runs can be compared
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t RandomState = 0x2545F4914F6CDD1DULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Draw a uniformly distributed number
+ *
+ * @return:
+ *      - Number in [0, 1)
+ */
+//--------------------------------------------------------------------------------------------------
+static double DrawUniform
+(
+    void
+)
+{
+    RandomState ^= RandomState >> 12;
+    RandomState ^= RandomState << 25;
+    RandomState ^= RandomState >> 27;
+
+    return ((RandomState * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call the modem: wait for its answer and draw a failure
+ *
+ * @return:
+ *      - true if the call succeeds
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CallModem
+(
+    void
+)
+{
+    double duration = Latency + Jitter * DrawUniform();
+
+    CallCount++;
+
+    if (duration > 0)
+    {
+        BusyTime += duration;
+        host_Sleep(duration);
+    }
+
+    if ((FailurePercent > 0) && (DrawUniform() * 100 < FailurePercent))
+    {
+        FailureCount++;
+        return false;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the position of the device at a time
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetPosition
+(
+    double time,                                ///< [IN]  Relative time in seconds
+    double* latitudePtr,                        ///< [OUT] Latitude in degrees
+    double* longitudePtr                        ///< [OUT] Longitude in degrees
+)
+{
+    double distance = SPEED * time;
+    double direction = DIRECTION * M_PI / 180;
+
+    *latitudePtr = START_LATITUDE + distance * cos(direction) / METERS_PER_DEGREE;
+    *longitudePtr = START_LONGITUDE + distance * sin(direction) /
+                    (METERS_PER_DEGREE * cos(START_LATITUDE * M_PI / 180));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a string value to the buffer of a LwM2MCore function
+ *
+ * @return:
+ *      - LWM2MCORE_ERR_COMPLETED_OK on success
+ *      - LWM2MCORE_ERR_OVERFLOW if the buffer is too small
+ */
+//--------------------------------------------------------------------------------------------------
+static lwm2mcore_Sid_t CopyString
+(
+    const char* valuePtr,                       ///< [IN]    Value
+    char* bufferPtr,                            ///< [OUT]   Buffer
+    size_t* lenPtr                              ///< [INOUT] Size of the buffer, length of the value
+)
+{
+    size_t length = strlen(valuePtr);
+
+    if (length >= *lenPtr)
+    {
+        return LWM2MCORE_ERR_OVERFLOW;
+    }
+
+    memcpy(bufferPtr, valuePtr, length + 1);
+    *lenPtr = length;
+
+    return LWM2MCORE_ERR_COMPLETED_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a string resource from the modem
+ *
+ * @return:
+ *      - LWM2MCORE_ERR_COMPLETED_OK on success
+ *      - LWM2MCORE_ERR_GENERAL_ERROR if the call fails
+ *      - LWM2MCORE_ERR_OVERFLOW if the buffer is too small
+ */
+//--------------------------------------------------------------------------------------------------
+static lwm2mcore_Sid_t ReadString
+(
+    const char* valuePtr,                       ///< [IN]    Value
+    char* bufferPtr,                            ///< [OUT]   Buffer
+    size_t* lenPtr                              ///< [INOUT] Size of the buffer, length of the value
+)
+{
+    if ((bufferPtr == NULL) || (lenPtr == NULL))
+    {
+        return LWM2MCORE_ERR_INVALID_ARG;
+    }
+
+    if (!CallModem())
+    {
+        return LWM2MCORE_ERR_GENERAL_ERROR;
+    }
+
+    return CopyString(valuePtr, bufferPtr, lenPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deliver a fix to the position handlers
+ */
+//--------------------------------------------------------------------------------------------------
+static void FixTimerHandler
+(
+    le_timer_Ref_t timerRef                     ///< [IN] Fix timer
+)
+{
+    le_clk_Time_t now = le_clk_GetAbsoluteTime();
+    int i;
+
+    Fix.time = host_GetTime();
+    Fix.epochTimeMs = (uint64_t)now.sec * 1000 + now.usec / 1000;
+
+    for (i = 0; i < MAX_POSITION_HANDLERS; i++)
+    {
+        if (PositionHandlers[i].handlerPtr != NULL)
+        {
+            FixRefCount++;
+            PositionHandlers[i].handlerPtr(&Fix, PositionHandlers[i].contextPtr);
+        }
+    }
+}
+
+void modemSim_SetLatency
+(
+    double latency,
+    double jitter
+)
+{
+    Latency = latency;
+    Jitter = jitter;
+}
+
+void modemSim_SetFailurePercent
+(
+    int failurePercent
+)
+{
+    FailurePercent = failurePercent;
+}
+
+uint64_t modemSim_GetCallCount
+(
+    void
+)
+{
+    return CallCount;
+}
+
+uint64_t modemSim_GetFailureCount
+(
+    void
+)
+{
+    return FailureCount;
+}
+
+double modemSim_GetBusyTime
+(
+    void
+)
+{
+    return BusyTime;
+}
+
+int modemSim_GetFixRefCount
+(
+    void
+)
+{
+    return FixRefCount;
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetDeviceSerialNumber
+(
+    char* bufferPtr,
+    size_t* lenPtr
+)
+{
+    return ReadString(SERIAL_NUMBER, bufferPtr, lenPtr);
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetDeviceImei
+(
+    char* bufferPtr,
+    size_t* lenPtr
+)
+{
+    return ReadString(IMEI, bufferPtr, lenPtr);
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetIccid
+(
+    char* bufferPtr,
+    size_t* lenPtr
+)
+{
+    return ReadString(ICCID, bufferPtr, lenPtr);
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetDeviceModelNumber
+(
+    char* bufferPtr,
+    size_t* lenPtr
+)
+{
+    return ReadString(MODEL_NUMBER, bufferPtr, lenPtr);
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetDeviceFirmwareVersion
+(
+    char* bufferPtr,
+    size_t* lenPtr
+)
+{
+    return ReadString(FIRMWARE_VERSION, bufferPtr, lenPtr);
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetDeviceTemperature
+(
+    int32_t* valuePtr
+)
+{
+    if (valuePtr == NULL)
+    {
+        return LWM2MCORE_ERR_INVALID_ARG;
+    }
+
+    if (!CallModem())
+    {
+        return LWM2MCORE_ERR_GENERAL_ERROR;
+    }
+
+    *valuePtr = TEMPERATURE;
+    return LWM2MCORE_ERR_COMPLETED_OK;
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetNetworkBearer
+(
+    lwm2mcore_networkBearer_enum_t* valuePtr
+)
+{
+    if (valuePtr == NULL)
+    {
+        return LWM2MCORE_ERR_INVALID_ARG;
+    }
+
+    if (!CallModem())
+    {
+        return LWM2MCORE_ERR_GENERAL_ERROR;
+    }
+
+    *valuePtr = LWM2MCORE_NETWORK_BEARER_LTE_FDD;
+    return LWM2MCORE_ERR_COMPLETED_OK;
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetSignalStrength
+(
+    int32_t* valuePtr
+)
+{
+    if (valuePtr == NULL)
+    {
+        return LWM2MCORE_ERR_INVALID_ARG;
+    }
+
+    if (!CallModem())
+    {
+        return LWM2MCORE_ERR_GENERAL_ERROR;
+    }
+
+    *valuePtr = SIGNAL_STRENGTH +
+                (int32_t)lround(SIGNAL_VARIATION * sin(2 * M_PI * host_GetTime() / SIGNAL_PERIOD));
+    return LWM2MCORE_ERR_COMPLETED_OK;
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetCellId
+(
+    uint32_t* valuePtr
+)
+{
+    if (valuePtr == NULL)
+    {
+        return LWM2MCORE_ERR_INVALID_ARG;
+    }
+
+    if (!CallModem())
+    {
+        return LWM2MCORE_ERR_GENERAL_ERROR;
+    }
+
+    *valuePtr = CELL_ID_BASE + (uint32_t)(host_GetTime() / CELL_DURATION);
+    return LWM2MCORE_ERR_COMPLETED_OK;
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetMncMcc
+(
+    uint16_t* mncPtr,
+    uint16_t* mccPtr
+)
+{
+    if ((mncPtr == NULL) && (mccPtr == NULL))
+    {
+        return LWM2MCORE_ERR_INVALID_ARG;
+    }
+
+    if (!CallModem())
+    {
+        return LWM2MCORE_ERR_GENERAL_ERROR;
+    }
+
+    if (mncPtr != NULL)
+    {
+        *mncPtr = MNC;
+    }
+
+    if (mccPtr != NULL)
+    {
+        *mccPtr = MCC;
+    }
+
+    return LWM2MCORE_ERR_COMPLETED_OK;
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetRoamingIndicator
+(
+    uint8_t* valuePtr
+)
+{
+    if (valuePtr == NULL)
+    {
+        return LWM2MCORE_ERR_INVALID_ARG;
+    }
+
+    if (!CallModem())
+    {
+        return LWM2MCORE_ERR_GENERAL_ERROR;
+    }
+
+    *valuePtr = 0;
+    return LWM2MCORE_ERR_COMPLETED_OK;
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetLatitude
+(
+    char* bufferPtr,
+    size_t* lenPtr
+)
+{
+    char value[32];
+    double latitude, longitude;
+
+    GetPosition(host_GetTime(), &latitude, &longitude);
+    snprintf(value, sizeof(value), "%.6f", latitude);
+
+    return ReadString(value, bufferPtr, lenPtr);
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetLongitude
+(
+    char* bufferPtr,
+    size_t* lenPtr
+)
+{
+    char value[32];
+    double latitude, longitude;
+
+    GetPosition(host_GetTime(), &latitude, &longitude);
+    snprintf(value, sizeof(value), "%.6f", longitude);
+
+    return ReadString(value, bufferPtr, lenPtr);
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetAltitude
+(
+    char* bufferPtr,
+    size_t* lenPtr
+)
+{
+    char value[32];
+
+    snprintf(value, sizeof(value), "%.3f", ALTITUDE);
+
+    return ReadString(value, bufferPtr, lenPtr);
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetDirection
+(
+    uint32_t* valuePtr
+)
+{
+    if (valuePtr == NULL)
+    {
+        return LWM2MCORE_ERR_INVALID_ARG;
+    }
+
+    if (!CallModem())
+    {
+        return LWM2MCORE_ERR_GENERAL_ERROR;
+    }
+
+    *valuePtr = DIRECTION;
+    return LWM2MCORE_ERR_COMPLETED_OK;
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetHorizontalSpeed
+(
+    uint32_t* valuePtr
+)
+{
+    if (valuePtr == NULL)
+    {
+        return LWM2MCORE_ERR_INVALID_ARG;
+    }
+
+    if (!CallModem())
+    {
+        return LWM2MCORE_ERR_GENERAL_ERROR;
+    }
+
+    *valuePtr = SPEED;
+    return LWM2MCORE_ERR_COMPLETED_OK;
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetVerticalSpeed
+(
+    int32_t* valuePtr
+)
+{
+    if (valuePtr == NULL)
+    {
+        return LWM2MCORE_ERR_INVALID_ARG;
+    }
+
+    if (!CallModem())
+    {
+        return LWM2MCORE_ERR_GENERAL_ERROR;
+    }
+
+    *valuePtr = 0;
+    return LWM2MCORE_ERR_COMPLETED_OK;
+}
+
+lwm2mcore_Sid_t lwm2mcore_GetLocationTimestamp
+(
+    uint64_t* valuePtr
+)
+{
+    if (valuePtr == NULL)
+    {
+        return LWM2MCORE_ERR_INVALID_ARG;
+    }
+
+    if (!CallModem())
+    {
+        return LWM2MCORE_ERR_GENERAL_ERROR;
+    }
+
+    *valuePtr = le_clk_GetAbsoluteTime().sec;
+    return LWM2MCORE_ERR_COMPLETED_OK;
+}
+
+le_result_t le_info_GetResetInformation
+(
+    le_info_Reset_t* resetPtr,
+    char* resetSpecificInfoStr,
+    size_t resetSpecificInfoStrSize
+)
+{
+    if (!CallModem())
+    {
+        return LE_FAULT;
+    }
+
+    *resetPtr = LE_INFO_RESET_USER;
+
+    return le_utf8_Copy(resetSpecificInfoStr, RESET_INFO, resetSpecificInfoStrSize, NULL);
+}
+
+bool le_bootReason_WasTimer
+(
+    void
+)
+{
+    // A failed call reads as "no", as the target does when the reason can not be read.
+    return CallModem();
+}
+
+bool le_bootReason_WasGpio
+(
+    uint32_t gpioNum
+)
+{
+    CallModem();
+    return false;
+}
+
+bool le_bootReason_WasAdc
+(
+    uint32_t adcNum
+)
+{
+    CallModem();
+    return false;
+}
+
+le_result_t le_gnss_Enable
+(
+    void
+)
+{
+    if (!CallModem())
+    {
+        return LE_FAULT;
+    }
+
+    if (IsGnssEnabled)
+    {
+        return LE_DUPLICATE;
+    }
+
+    IsGnssEnabled = true;
+    return LE_OK;
+}
+
+le_result_t le_gnss_Start
+(
+    void
+)
+{
+    if (!CallModem())
+    {
+        return LE_FAULT;
+    }
+
+    if (!IsGnssEnabled)
+    {
+        return LE_NOT_PERMITTED;
+    }
+
+    if (IsGnssStarted)
+    {
+        return LE_DUPLICATE;
+    }
+
+    if (FixTimer == NULL)
+    {
+        FixTimer = le_timer_Create("modemSimFix");
+        le_timer_SetHandler(FixTimer, FixTimerHandler);
+        le_timer_SetMsInterval(FixTimer, FIX_INTERVAL_MS);
+        le_timer_SetRepeat(FixTimer, 0);
+    }
+
+    le_timer_Start(FixTimer);
+    IsGnssStarted = true;
+    return LE_OK;
+}
+
+le_result_t le_gnss_Stop
+(
+    void
+)
+{
+    if (!CallModem())
+    {
+        return LE_FAULT;
+    }
+
+    if (!IsGnssStarted)
+    {
+        return LE_DUPLICATE;
+    }
+
+    le_timer_Stop(FixTimer);
+    IsGnssStarted = false;
+    return LE_OK;
+}
+
+le_gnss_PositionHandlerRef_t le_gnss_AddPositionHandler
+(
+    le_gnss_PositionHandlerFunc_t handlerPtr,
+    void* contextPtr
+)
+{
+    int i;
+
+    for (i = 0; i < MAX_POSITION_HANDLERS; i++)
+    {
+        if (PositionHandlers[i].handlerPtr == NULL)
+        {
+            PositionHandlers[i].handlerPtr = handlerPtr;
+            PositionHandlers[i].contextPtr = contextPtr;
+            return &PositionHandlers[i];
+        }
+    }
+
+    LE_FATAL("Too many position handlers");
+}
+
+void le_gnss_RemovePositionHandler
+(
+    le_gnss_PositionHandlerRef_t handlerRef
+)
+{
+    handlerRef->handlerPtr = NULL;
+}
+
+le_result_t le_gnss_GetLocation
+(
+    le_gnss_SampleRef_t positionSampleRef,
+    int32_t* latitudePtr,
+    int32_t* longitudePtr,
+    int32_t* hAccuracyPtr
+)
+{
+    double latitude, longitude;
+
+    GetPosition(positionSampleRef->time, &latitude, &longitude);
+
+    *latitudePtr = (int32_t)lround(latitude * 1000000);
+    *longitudePtr = (int32_t)lround(longitude * 1000000);
+    *hAccuracyPtr = H_ACCURACY;
+
+    return LE_OK;
+}
+
+le_result_t le_gnss_GetAltitude
+(
+    le_gnss_SampleRef_t positionSampleRef,
+    int32_t* altitudePtr,
+    int32_t* vAccuracyPtr
+)
+{
+    *altitudePtr = (int32_t)lround(ALTITUDE * 1000);
+    *vAccuracyPtr = V_ACCURACY;
+
+    return LE_OK;
+}
+
+le_result_t le_gnss_GetEpochTime
+(
+    le_gnss_SampleRef_t positionSampleRef,
+    uint64_t* millisecondsPtr
+)
+{
+    *millisecondsPtr = positionSampleRef->epochTimeMs;
+
+    return LE_OK;
+}
+
+void le_gnss_ReleaseSampleRef
+(
+    le_gnss_SampleRef_t positionSampleRef
+)
+{
+    FixRefCount--;
+}
@@ -0,0 +1,85 @@
+//--------------------------------------------------------------------------------------------------
+/** @file modemSim.h
+ *
+ * Simulated modem of the host tests, behind the LwM2MCore functions and the le_info,
+ * le_bootReason and le_gnss APIs used by the dm plugin.
+ *
+ * The modem reports fixed device identities and a device moving at a constant speed, whose
+ * position is also delivered as a GNSS fix per second once the engine is started. Every call to
+ * the modem takes the latency set with modemSim_SetLatency() and fails with the probability set
+ * with modemSim_SetFailurePercent(): the latency is a sleep of the calling thread, so that it
+ * advances the simulated clock when the host clock is accelerated. Reading the content of a GNSS
+ * fix is not a modem call.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_HOST_MODEM_SIM_INCLUDE_GUARD
+#define LEGATO_HOST_MODEM_SIM_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the duration of the modem calls, none by default
+ */
+//--------------------------------------------------------------------------------------------------
+void modemSim_SetLatency
+(
+    double latency,                     ///< [IN] Minimum duration of a call, in seconds
+    double jitter                       ///< [IN] Maximum random extra duration, in seconds
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the share of the modem calls that fail, none by default
+ */
+//--------------------------------------------------------------------------------------------------
+void modemSim_SetFailurePercent
+(
+    int failurePercent                  ///< [IN] Percentage of the calls that fail
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of modem calls
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t modemSim_GetCallCount
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of modem calls that failed
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t modemSim_GetFailureCount
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time spent in modem calls
+ *
+ * @return:
+ *      - Sum of the latencies of the calls, in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+double modemSim_GetBusyTime
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of GNSS fixes delivered to the position handlers and not released
+ */
+//--------------------------------------------------------------------------------------------------
+int modemSim_GetFixRefCount
+(
+    void
+);
+
+#endif /* LEGATO_HOST_MODEM_SIM_INCLUDE_GUARD */
@@ -0,0 +1,222 @@
+//--------------------------------------------------------------------------------------------------
+/** @file periodTest.c
+ *
+ * Check of the sampling period of the sensors on a period change pushed to the Data Hub, as an
+ * administrator or a cloud command would: a sensor timed by its plugin must be told the new
+ * period through its period callback, and a sensor timed by the framework must be sampled at it.
+ * The period must be stored, and disabling the sensor must report a period of 0.
+ *
+ * Usage: periodTest
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "sensorFw.h"
+#include "dataHub.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sensors under test
+ */
+//--------------------------------------------------------------------------------------------------
+#define TIMED_INFO      "{\"name\":\"timed\",\"path\":\"test/timed\",\"unit\":\"C\",\"period\":5}"
+#define TIMED_PATH      DATAHUB_APP_ROOT "/test/timed"
+#define POLLED_INFO     "{\"name\":\"polled\",\"path\":\"test/polled\",\"unit\":\"C\",\"period\":1}"
+#define POLLED_PATH     DATAHUB_APP_ROOT "/test/polled"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check a condition, counting the failures
+ */
+//--------------------------------------------------------------------------------------------------
+#define CHECK(cond)     Check((cond), #cond, __LINE__)
+
+void _sensorFw_COMPONENT_INIT(void);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Periods reported to the plugin
+ */
+//--------------------------------------------------------------------------------------------------
+static double LastPeriod = -1;
+static int PeriodCbCount;
+static int FailureCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report a failed check
+ */
+//--------------------------------------------------------------------------------------------------
+static void Check
+(
+    bool isPassed,                              ///< [IN] Result of the check
+    const char* condPtr,                        ///< [IN] Checked condition
+    int line                                    ///< [IN] Line of the check
+)
+{
+    if (!isPassed)
+    {
+        fprintf(stderr, "FAILED line %d: %s\n", line, condPtr);
+        FailureCount++;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample callback of the sensors
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SampleNumeric
+(
+    double* valuePtr,                           ///< [OUT] Sample
+    size_t* lengthPtr,                          ///< [IN]  Unused
+    void* contextPtr                            ///< [IN]  Unused
+)
+{
+    *valuePtr = 21.5;
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Period callback of the sensor timed by the plugin
+ */
+//--------------------------------------------------------------------------------------------------
+static void PeriodChanged
+(
+    double period,                              ///< [IN] Period in seconds, 0 if disabled
+    void* contextPtr                            ///< [IN] Unused
+)
+{
+    LastPeriod = period;
+    PeriodCbCount++;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the period of a sensor stored in the configuration tree
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetStoredPeriod
+(
+    const char* sensorPathPtr                   ///< [IN] Path of the sensor
+)
+{
+    char nodePath[128];
+
+    snprintf(nodePath, sizeof(nodePath), "sensors/%s", sensorPathPtr);
+
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateReadTxn(nodePath);
+    double period = le_cfg_GetFloat(iteratorRef, "period", 0);
+    le_cfg_CancelTxn(iteratorRef);
+
+    return period;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A sensor timed by its plugin is told the periods pushed to the Data Hub
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestTimedSensor
+(
+    void
+)
+{
+    sensorfwCallbacks_t callbacks = { 0 };
+
+    callbacks.sample.numericCb = SampleNumeric;
+    callbacks.periodCb = PeriodChanged;
+
+    CHECK(sensorFw_RegisterCallback(TIMED_INFO, SF_CB_NUMERIC, &callbacks, NULL, NULL) == LE_OK);
+    host_RunFor(1);
+    CHECK(LastPeriod == 5);
+
+    admin_PushNumeric(TIMED_PATH "/period", IO_NOW, 2);
+    host_RunFor(1);
+    CHECK(LastPeriod == 2);
+    CHECK(GetStoredPeriod("test/timed") == 2);
+
+    // Not a period: ignored.
+    int count = PeriodCbCount;
+
+    admin_PushNumeric(TIMED_PATH "/period", IO_NOW, 0);
+    host_RunFor(1);
+    CHECK(PeriodCbCount == count);
+    CHECK(LastPeriod == 2);
+
+    admin_PushBoolean(TIMED_PATH "/enable", IO_NOW, false);
+    host_RunFor(1);
+    CHECK(LastPeriod == 0);
+
+    // Changed while disabled: applied once enabled again.
+    admin_PushNumeric(TIMED_PATH "/period", IO_NOW, 3);
+    host_RunFor(1);
+    CHECK(LastPeriod == 0);
+
+    admin_PushBoolean(TIMED_PATH "/enable", IO_NOW, true);
+    host_RunFor(1);
+    CHECK(LastPeriod == 3);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A sensor timed by the framework is sampled at the period pushed to the Data Hub
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestPolledSensor
+(
+    void
+)
+{
+    sensorfwCallbacks_t callbacks = { 0 };
+    double value;
+
+    callbacks.sample.numericCb = SampleNumeric;
+
+    CHECK(sensorFw_RegisterCallback(POLLED_INFO, SF_CB_NUMERIC, &callbacks, NULL, NULL) == LE_OK);
+    host_RunFor(100.5);
+
+    uint32_t count = dataHub_GetPushCount(POLLED_PATH "/value");
+
+    CHECK((count >= 100) && (count <= 102));
+    CHECK((dataHub_GetNumeric(POLLED_PATH "/value", &value) == LE_OK) && (value == 21.5));
+
+    admin_PushNumeric(POLLED_PATH "/period", IO_NOW, 10);
+    host_RunFor(100);
+
+    count = dataHub_GetPushCount(POLLED_PATH "/value") - count;
+    CHECK((count >= 9) && (count <= 11));
+    CHECK(GetStoredPeriod("test/polled") == 10);
+}
+
+int main
+(
+    int argc,
+    char** argv
+)
+{
+    // The pressure of the host running the test must not throttle the sensors.
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateWriteTxn("pressure");
+    le_cfg_SetBool(iteratorRef, "enable", false);
+    le_cfg_CommitTxn(iteratorRef);
+
+    host_UseTempDir();
+    host_SetAccelerated(true);
+    _sensorFw_COMPONENT_INIT();
+
+    TestTimedSensor();
+    TestPolledSensor();
+
+    if (FailureCount > 0)
+    {
+        fprintf(stderr, "%d check(s) failed\n", FailureCount);
+        return EXIT_FAILURE;
+    }
+
+    printf("period changes: OK\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,510 @@
+//--------------------------------------------------------------------------------------------------
+/** @file soakTest.c
+ *
+ * Soak test of sensorFw and of the iio plugin on the mock Data Hub and the simulated IIO backend.
+ *
+ * Days of sampling are run on the accelerated clock, with configuration updates pushed to the
+ * Data Hub every few minutes as a cloud would: IIO channel attributes, orientation filter rates,
+ * sensor periods, and sensors disabled and enabled again. A remote iiod context is configured
+ * along with one that can not be reached.
+ *
+ * The heap allocations of every component are accounted by hostAlloc, and sampled every hour
+ * with the heap of the process. After a warm-up, the growth of each owner and of the heap is
+ * fitted over the remaining samples. The test fails when an owner keeps growing, or when iio
+ * contexts are leaked; the allocation churn of the owners and the fragmentation of the heap are
+ * reported, so that regressions can be compared from run to run.
+ *
+ * The orientation filters are run at low rates: their updates do not allocate (see fusionBench),
+ * and at their default rate they would take most of the run time.
+ *
+ * Usage: soakTest [days]
+ *
+ *  days        simulated duration, 2 by default, at most MAX_DAYS
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <math.h>
+#include "interfaces.h"
+#include "sensorFw.h"
+#include "heap.h"
+#include "metrics.h"
+#include "budget.h"
+#include "dataHub.h"
+#include "hostAlloc.h"
+#include "iioSim.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Settings of the run
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_DAYS            2
+#define MAX_DAYS                30
+#define CONFIG_PERIOD           600                     ///< Seconds between configuration updates
+#define HEAP_SAMPLE_PERIOD      3600                    ///< Seconds between heap samples
+#define WARMUP_TIME             (6 * 3600)              ///< Seconds before the growth is fitted
+#define MAX_SAMPLES             (MAX_DAYS * 24 + 1)
+#define MAX_OWNERS              16
+#define LEAK_LIMIT              1024                    ///< Growth of an owner, in bytes per day
+#define REMOTE_CONTEXT_COUNT    1                       ///< Remote contexts reachable
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sensors configured
+ */
+//--------------------------------------------------------------------------------------------------
+#define ACCEL_PATH              "imu0/accel_x"
+#define ORIENTATION_PATHS       { "imu0/orientation", "imu1/orientation" }
+#define PERIOD_PATH             "temp0/temp"
+#define TOGGLED_PATH            "imu1/accel_y"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check a condition, counting the failures
+ */
+//--------------------------------------------------------------------------------------------------
+#define CHECK(cond)     Check((cond), #cond, __LINE__)
+
+void _sensorFw_COMPONENT_INIT(void);
+void _iioChannel_COMPONENT_INIT(void);
+void _iioPlugin_COMPONENT_INIT(void);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Values cycled through by the configuration updates
+ */
+//--------------------------------------------------------------------------------------------------
+static const double SamplingFrequencies[] = { 12.5, 50, 100, 400 };
+static const double Scales[] = { 0.000598, 0.001197, 0.002394 };
+static const double FusionRates[] = { 1, 2, 5 };
+static const double FusionBetas[] = { 0.1, 0.05, 0.2 };
+static const double Periods[] = { 10, 60, 300 };
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hourly samples: live bytes of every owner and heap of the process
+ */
+//--------------------------------------------------------------------------------------------------
+static double SampleTimes[MAX_SAMPLES];
+static double OwnerBytes[MAX_OWNERS][MAX_SAMPLES];
+static double HeapBytes[MAX_SAMPLES];
+static double Fragmentation[MAX_SAMPLES];
+static int SampleCount;
+
+static int FailureCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report a failed check
+ */
+//--------------------------------------------------------------------------------------------------
+static void Check
+(
+    bool isPassed,                              ///< [IN] Result of the check
+    const char* condPtr,                        ///< [IN] Checked condition
+    int line                                    ///< [IN] Line of the check
+)
+{
+    if (!isPassed)
+    {
+        fprintf(stderr, "FAILED line %d: %s\n", line, condPtr);
+        FailureCount++;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a JSON configuration to a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushConfig
+(
+    const char* sensorPathPtr,                  ///< [IN] Path of the sensor
+    const char* formatPtr,                      ///< [IN] Format of the configuration
+    ...
+)
+{
+    char path[128];
+    char config[128];
+    va_list args;
+
+    va_start(args, formatPtr);
+    vsnprintf(config, sizeof(config), formatPtr, args);
+    va_end(args);
+
+    snprintf(path, sizeof(path), DATAHUB_APP_ROOT "/%s/config", sensorPathPtr);
+    admin_PushJson(path, IO_NOW, config);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push the next configuration update of the rotation
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateConfig
+(
+    uint32_t update                             ///< [IN] Number of the update
+)
+{
+    static const char* const orientationPaths[] = ORIENTATION_PATHS;
+    uint32_t round = update / 4;
+    size_t i;
+
+    switch (update % 4)
+    {
+        case 0:
+            PushConfig(ACCEL_PATH, "{\"sampling_frequency\":%g,\"scale\":%g}",
+                       SamplingFrequencies[round % NUM_ARRAY_MEMBERS(SamplingFrequencies)],
+                       Scales[round % NUM_ARRAY_MEMBERS(Scales)]);
+            break;
+
+        case 1:
+            for (i = 0; i < NUM_ARRAY_MEMBERS(orientationPaths); i++)
+            {
+                PushConfig(orientationPaths[i], "{\"rate\":%g,\"beta\":%g}",
+                           FusionRates[round % NUM_ARRAY_MEMBERS(FusionRates)],
+                           FusionBetas[round % NUM_ARRAY_MEMBERS(FusionBetas)]);
+            }
+            break;
+
+        case 2:
+            admin_PushNumeric(DATAHUB_APP_ROOT "/" PERIOD_PATH "/period", IO_NOW,
+                              Periods[round % NUM_ARRAY_MEMBERS(Periods)]);
+            break;
+
+        default:
+            admin_PushBoolean(DATAHUB_APP_ROOT "/" TOGGLED_PATH "/enable", IO_NOW,
+                              (round % 2) != 0);
+            break;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples taken by the framework from all the sensors
+ *
+ * @return:
+ *      - Number of calls of the sample callbacks
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetSampleCount
+(
+    void
+)
+{
+    double age;
+    uint32_t sampleCount, failureCount, callbackMaxUs, pushMaxUs;
+    uint64_t callbackTimeUs, pushTimeUs, bytesPushed;
+    uint64_t total = 0;
+    uint32_t i;
+
+    for (i = 0; i < sensorStats_GetCount(); i++)
+    {
+        if (sensorStats_GetStats(i, &age, &sampleCount, &failureCount, &callbackTimeUs,
+                                 &callbackMaxUs, &pushTimeUs, &pushMaxUs,
+                                 &bytesPushed) == LE_OK)
+        {
+            total += (uint64_t)sampleCount + failureCount;
+        }
+    }
+
+    return total;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sample the live bytes of the owners and the heap of the process
+ */
+//--------------------------------------------------------------------------------------------------
+static void SampleHeap
+(
+    void
+)
+{
+    hostAlloc_Stats_t ownerStats;
+    heap_Stats_t heapStats;
+    uint32_t i;
+
+    if (SampleCount == MAX_SAMPLES)
+    {
+        return;
+    }
+
+    for (i = 0; (i < MAX_OWNERS) && hostAlloc_GetStats(i, &ownerStats); i++)
+    {
+        OwnerBytes[i][SampleCount] = ownerStats.liveBytes;
+    }
+
+    heap_GetStats(&heapStats);
+
+    SampleTimes[SampleCount] = host_GetTime();
+    HeapBytes[SampleCount] = heapStats.heapUsedBytes;
+    Fragmentation[SampleCount] = heapStats.fragmentation;
+    SampleCount++;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fit the growth of a quantity over the samples taken after the warm-up
+ *
+ * @return:
+ *      - Growth in units per day, 0 if there are not enough samples
+ */
+//--------------------------------------------------------------------------------------------------
+static double FitGrowth
+(
+    const double values[],                      ///< [IN] Samples
+    double startTime                            ///< [IN] Time of the end of the warm-up
+)
+{
+    double meanTime = 0;
+    double meanValue = 0;
+    double covariance = 0;
+    double variance = 0;
+    int count = 0;
+    int i;
+
+    for (i = 0; i < SampleCount; i++)
+    {
+        if (SampleTimes[i] >= startTime)
+        {
+            meanTime += SampleTimes[i];
+            meanValue += values[i];
+            count++;
+        }
+    }
+
+    if (count < 2)
+    {
+        return 0;
+    }
+
+    meanTime /= count;
+    meanValue /= count;
+
+    for (i = 0; i < SampleCount; i++)
+    {
+        if (SampleTimes[i] >= startTime)
+        {
+            double dt = SampleTimes[i] - meanTime;
+
+            covariance += dt * (values[i] - meanValue);
+            variance += dt * dt;
+        }
+    }
+
+    return (variance > 0) ? (covariance / variance * 86400) : 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start sensorFw and the iio plugin, with a reachable and an unreachable remote context
+ */
+//--------------------------------------------------------------------------------------------------
+static void Start
+(
+    void
+)
+{
+    // The pressure of the host running the test must not throttle the sensors.
+    le_cfg_IteratorRef_t iteratorRef = le_cfg_CreateWriteTxn("pressure");
+    le_cfg_SetBool(iteratorRef, "enable", false);
+    le_cfg_CommitTxn(iteratorRef);
+
+    iteratorRef = le_cfg_CreateWriteTxn("iioPlugin/remotes");
+    le_cfg_SetString(iteratorRef, "lab/uri", "sim:lab");
+    le_cfg_SetString(iteratorRef, "offline/uri", "ip:192.0.2.1");
+    le_cfg_CommitTxn(iteratorRef);
+
+    host_UseTempDir();
+    host_SetLogLevel(LE_LOG_WARN);
+    host_SetAccelerated(true);
+
+    _sensorFw_COMPONENT_INIT();
+    _iioChannel_COMPONENT_INIT();
+    _iioPlugin_COMPONENT_INIT();
+
+    host_RunFor(1);
+
+    CHECK(dataHub_GetPushCount(DATAHUB_APP_ROOT "/" ACCEL_PATH "/value") > 0);
+    CHECK(dataHub_GetPushCount(DATAHUB_APP_ROOT "/" TOGGLED_PATH "/value") > 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report the allocations of the owners, and check that none keeps growing
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportOwners
+(
+    const hostAlloc_Stats_t startStats[],       ///< [IN] Allocations at the end of the warm-up
+    int startOwnerCount,                        ///< [IN] Number of owners then
+    double startTime,                           ///< [IN] Time of the end of the warm-up
+    uint64_t sampleCount                        ///< [IN] Samples taken since the warm-up
+)
+{
+    hostAlloc_Stats_t stats;
+    double hours = (host_GetTime() - startTime) / 3600;
+    uint32_t i;
+
+    printf("    %-12s %12s %14s %12s %12s %12s\n",
+           "owner", "allocs/hour", "allocs/sample", "live blocks", "live bytes", "bytes/day");
+
+    for (i = 0; (i < MAX_OWNERS) && hostAlloc_GetStats(i, &stats); i++)
+    {
+        uint64_t allocCount = stats.allocCount;
+        double growth = FitGrowth(OwnerBytes[i], startTime);
+
+        if ((int)i < startOwnerCount)
+        {
+            allocCount -= startStats[i].allocCount;
+        }
+
+        printf("    %-12s %12.1f %14.4f %12" PRIu64 " %12" PRIu64 " %12.0f\n",
+               stats.namePtr, allocCount / hours, (double)allocCount / sampleCount,
+               stats.liveBlocks, stats.liveBytes, growth);
+
+        if (growth > LEAK_LIMIT)
+        {
+            fprintf(stderr, "FAILED: %s grows by %.0f bytes/day\n", stats.namePtr, growth);
+            FailureCount++;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report the memory held by the framework for every plugin
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportBudgets
+(
+    void
+)
+{
+    metrics_Budget_t budget;
+    uint32_t i;
+
+    for (i = 0; budget_GetMetrics(i, &budget); i++)
+    {
+        printf("    framework memory of %s: %" PRId64 " bytes\n",
+               (budget.pluginPtr[0] != '\0') ? budget.pluginPtr : "(unknown)",
+               budget.memoryBytes);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report the heap of the process
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportHeap
+(
+    double startTime                            ///< [IN] Time of the end of the warm-up
+)
+{
+    heap_Stats_t heapStats;
+    double fragmentationSum = 0;
+    double fragmentationMax = 0;
+    int count = 0;
+    int i;
+
+    for (i = 0; i < SampleCount; i++)
+    {
+        if (SampleTimes[i] >= startTime)
+        {
+            fragmentationSum += Fragmentation[i];
+            fragmentationMax = fmax(fragmentationMax, Fragmentation[i]);
+            count++;
+        }
+    }
+
+    heap_GetStats(&heapStats);
+
+    printf("    heap: %" PRIu64 " bytes in use, %" PRIu64 " free, growth %.0f bytes/day\n",
+           heapStats.heapUsedBytes, heapStats.heapFreeBytes, FitGrowth(HeapBytes, startTime));
+    printf("    fragmentation: %.3f mean, %.3f max, %.3f at the end\n",
+           (count > 0) ? (fragmentationSum / count) : 0, fragmentationMax,
+           heapStats.fragmentation);
+    printf("    sensord heap metric: growth %.0f bytes/hour over the last %" PRIu32 " samples\n",
+           heapStats.growthPerHour, heapStats.sampleCount);
+}
+
+int main
+(
+    int argc,
+    char** argv
+)
+{
+    double days = (argc > 1) ? atof(argv[1]) : DEFAULT_DAYS;
+    hostAlloc_Stats_t startStats[MAX_OWNERS];
+    int startOwnerCount = 0;
+    bool isWarmedUp = false;
+    uint32_t update = 0;
+
+    if ((days <= 0) || (days > MAX_DAYS) || (days * 86400 <= WARMUP_TIME))
+    {
+        fprintf(stderr, "Usage: %s [days], more than the %d h of warm-up and at most %d days\n",
+                argv[0], WARMUP_TIME / 3600, MAX_DAYS);
+        return EXIT_FAILURE;
+    }
+
+    Start();
+
+    double startTime = host_GetTime();
+    double endTime = startTime + days * 86400;
+    double warmupEndTime = startTime + WARMUP_TIME;
+    double nextSampleTime = startTime;
+    uint64_t startSampleCount = 0;
+
+    while (host_GetTime() < endTime)
+    {
+        if (host_GetTime() >= nextSampleTime)
+        {
+            SampleHeap();
+            nextSampleTime += HEAP_SAMPLE_PERIOD;
+        }
+
+        if (!isWarmedUp && (host_GetTime() >= warmupEndTime))
+        {
+            while ((startOwnerCount < MAX_OWNERS) &&
+                   hostAlloc_GetStats(startOwnerCount, &startStats[startOwnerCount]))
+            {
+                startOwnerCount++;
+            }
+
+            startSampleCount = GetSampleCount();
+            isWarmedUp = true;
+        }
+
+        UpdateConfig(update++);
+        host_RunFor(CONFIG_PERIOD);
+    }
+
+    SampleHeap();
+
+    uint64_t sampleCount = GetSampleCount() - startSampleCount;
+
+    printf("soak: %.1f days, %" PRIu32 " configuration updates, %" PRIu64 " samples "
+           "after %d h of warm-up\n",
+           days, update, sampleCount, WARMUP_TIME / 3600);
+
+    ReportOwners(startStats, startOwnerCount, warmupEndTime, (sampleCount > 0) ? sampleCount : 1);
+    ReportBudgets();
+    ReportHeap(warmupEndTime);
+
+    printf("    iio contexts: %d\n", iioSim_GetContextCount());
+    CHECK(iioSim_GetContextCount() == 1 + REMOTE_CONTEXT_COUNT);
+
+    if (FailureCount > 0)
+    {
+        fprintf(stderr, "%d check(s) failed\n", FailureCount);
+        return EXIT_FAILURE;
+    }
+
+    printf("soak: OK\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+//--------------------------------------------------------------------------------------------------
+/** @file tracebenchHost.c
+ *
+ * Host run of the tracebench tool: sensorFw runs with tracing enabled and the sensors of the load
+ * plugin, and tracebench stands in for the upstream sink in the same process, as it would in the
+ * sensorFwBench app on a target. The clock is accelerated, so that the run takes far less than
+ * its simulated duration, and tracebench exits with its report at the end of the run.
+ *
+ * Usage: tracebench [-d <delivery delay in ms>] [-t <duration in s>]
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Settings of the run: traced fraction of the samples, and load
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACE_FRACTION          0.05
+#define LOAD_SENSOR_COUNT       100
+#define LOAD_PERIOD             0.1             ///< Seconds
+
+void _sensorFw_COMPONENT_INIT(void);
+void _loadPlugin_COMPONENT_INIT(void);
+void _tracebench_COMPONENT_INIT(void);
+
+int main
+(
+    int argc,
+    char** argv
+)
+{
+    le_cfg_IteratorRef_t iteratorRef;
+
+    le_arg_SetArgs(argc, argv);
+    host_UseTempDir();
+
+    iteratorRef = le_cfg_CreateWriteTxn("trace");
+    le_cfg_SetFloat(iteratorRef, "fraction", TRACE_FRACTION);
+    le_cfg_CommitTxn(iteratorRef);
+
+    // The pressure of the host running the benchmark must not throttle the sensors.
+    iteratorRef = le_cfg_CreateWriteTxn("pressure");
+    le_cfg_SetBool(iteratorRef, "enable", false);
+    le_cfg_CommitTxn(iteratorRef);
+
+    iteratorRef = le_cfg_CreateWriteTxn("loadPlugin");
+    le_cfg_SetBool(iteratorRef, "enable", true);
+    le_cfg_SetInt(iteratorRef, "numeric", LOAD_SENSOR_COUNT);
+    le_cfg_SetFloat(iteratorRef, "period", LOAD_PERIOD);
+    le_cfg_CommitTxn(iteratorRef);
+
+    host_SetAccelerated(true);
+
+    _sensorFw_COMPONENT_INIT();
+    _loadPlugin_COMPONENT_INIT();
+    _tracebench_COMPONENT_INIT();
+
+    // tracebench exits once it has printed its report.
+    for (;;)
+    {
+        host_RunFor(60);
+    }
+}
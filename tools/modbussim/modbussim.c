@@ -0,0 +1,584 @@
+//--------------------------------------------------------------------------------------------------
+/** @file modbussim.c
+ *
+ * Modbus TCP slave simulator, to benchmark the Modbus plugin of the Sensor Framework without
+ * meters. It answers the reads of coils, discrete inputs, holding and input registers of any unit
+ * and address: registers hold their own address, coils and discrete inputs are set at odd
+ * addresses. Each request can be made to take a service time, during which the following
+ * requests wait, like on a gateway to a serial bus, and each response delayed by the latency of a
+ * network. The requests and values served per second are printed every 10 seconds.
+ *
+ * Usage: modbussim [-p <port>] [-d <service time in ms>] [-l <latency in ms>]
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "interfaces.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default TCP port, above 1024 to run without privileges
+ */
+//--------------------------------------------------------------------------------------------------
+#define     DEFAULT_PORT                    1502
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of clients, and of responses waiting to be sent
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_CLIENTS                     8
+#define     MAX_PENDING                     64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of a frame, and of its header (MBAP) including the unit identifier
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_ADU_SIZE                    260
+#define     MBAP_SIZE                       7
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Period of the statistics in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+#define     STATS_PERIOD                    10
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Client
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int fd;                                     ///< Socket, -1 if not connected
+    le_fdMonitor_Ref_t monitorRef;              ///< Monitor of the socket
+    uint8_t rxBuffer[2 * MAX_ADU_SIZE];         ///< Bytes received, not yet parsed
+    size_t rxLength;                            ///< Number of bytes received
+}
+client_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Response waiting for the service time of its request and the latency
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    client_t* clientPtr;                        ///< Client
+    double sendTime;                            ///< Relative time at which it is sent
+    uint8_t frame[MAX_ADU_SIZE];                ///< Response
+    size_t length;                              ///< Length of the response
+}
+pending_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clients
+ */
+//--------------------------------------------------------------------------------------------------
+static client_t Clients[MAX_CLIENTS];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Responses waiting, in order of arrival of their requests, which is also the order in which they
+ * are sent
+ */
+//--------------------------------------------------------------------------------------------------
+static pending_t Pending[MAX_PENDING];
+static uint32_t PendingHead;
+static uint32_t PendingCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Relative time at which the last request waiting is served
+ */
+//--------------------------------------------------------------------------------------------------
+static double ServiceEnd;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer of the response at the head of the queue
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t SendTimer;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Statistics since the last print
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t RequestCount;
+static uint32_t ValueCount;
+static uint32_t ExceptionCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command line options
+ */
+//--------------------------------------------------------------------------------------------------
+static int Port = DEFAULT_PORT;
+static int Delay = 0;
+static int Latency = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetTime
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return (double)now.sec + ((double)now.usec / 1000000.0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a big endian 16-bit word
+ */
+//--------------------------------------------------------------------------------------------------
+static void PutWord
+(
+    uint8_t* bytesPtr,                          ///< [OUT] Word
+    uint16_t word                               ///< [IN]  Value
+)
+{
+    bytesPtr[0] = word >> 8;
+    bytesPtr[1] = word & 0xFF;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Disconnect a client
+ */
+//--------------------------------------------------------------------------------------------------
+static void Disconnect
+(
+    client_t* clientPtr                         ///< [IN] Client
+)
+{
+    uint32_t i;
+
+    le_fdMonitor_Delete(clientPtr->monitorRef);
+    close(clientPtr->fd);
+    clientPtr->fd = -1;
+
+    // Its responses still waiting are dropped when served.
+    for (i = 0; i < PendingCount; i++)
+    {
+        pending_t* pendingPtr = &Pending[(PendingHead + i) % MAX_PENDING];
+
+        if (pendingPtr->clientPtr == clientPtr)
+        {
+            pendingPtr->clientPtr = NULL;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a response to a client
+ */
+//--------------------------------------------------------------------------------------------------
+static void Send
+(
+    client_t* clientPtr,                        ///< [IN] Client
+    const uint8_t* framePtr,                    ///< [IN] Response
+    size_t length                               ///< [IN] Length of the response
+)
+{
+    if ((clientPtr == NULL) || (clientPtr->fd < 0))
+    {
+        return;
+    }
+
+    // A client that does not read its responses is not worth waiting for.
+    if (send(clientPtr->fd, framePtr, length, MSG_NOSIGNAL | MSG_DONTWAIT) != (ssize_t)length)
+    {
+        Disconnect(clientPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Arm the timer of the response at the head of the queue
+ */
+//--------------------------------------------------------------------------------------------------
+static void ArmSendTimer
+(
+    void
+)
+{
+    double wait = Pending[PendingHead].sendTime - GetTime();
+
+    le_timer_SetMsInterval(SendTimer, (wait > 0) ? (uint32_t)(wait * 1000) + 1 : 1);
+    le_timer_Start(SendTimer);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send the responses that are due
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendDue
+(
+    le_timer_Ref_t timerRef                     ///< [IN] Send timer
+)
+{
+    double now = GetTime();
+
+    while ((PendingCount > 0) && (Pending[PendingHead].sendTime <= now))
+    {
+        pending_t* pendingPtr = &Pending[PendingHead];
+
+        Send(pendingPtr->clientPtr, pendingPtr->frame, pendingPtr->length);
+
+        PendingHead = (PendingHead + 1) % MAX_PENDING;
+        PendingCount--;
+    }
+
+    if (PendingCount > 0)
+    {
+        ArmSendTimer();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the response to a request
+ *
+ * @return:
+ *      - Length of the response
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t BuildResponse
+(
+    const uint8_t* requestPtr,                  ///< [IN]  Request, from the MBAP header
+    size_t requestLength,                       ///< [IN]  Length of the request
+    uint8_t* responsePtr                        ///< [OUT] Response
+)
+{
+    uint8_t* pduPtr = responsePtr + MBAP_SIZE;
+    uint8_t function = requestPtr[MBAP_SIZE];
+    uint32_t address = (requestPtr[MBAP_SIZE + 1] << 8) | requestPtr[MBAP_SIZE + 2];
+    uint32_t count = (requestPtr[MBAP_SIZE + 3] << 8) | requestPtr[MBAP_SIZE + 4];
+    bool isBit = (function == 0x01) || (function == 0x02);
+    uint8_t exception = 0;
+    size_t pduLength;
+    uint32_t i;
+
+    // Transaction, protocol and unit identifiers are echoed.
+    memcpy(responsePtr, requestPtr, MBAP_SIZE);
+
+    if ((function < 0x01) || (function > 0x04) || (requestLength < MBAP_SIZE + 5))
+    {
+        exception = 0x01;
+    }
+    else if ((count == 0) || (count > (isBit ? 2000u : 125u)))
+    {
+        exception = 0x03;
+    }
+    else if (address + count > 0x10000)
+    {
+        exception = 0x02;
+    }
+
+    if (exception != 0)
+    {
+        pduPtr[0] = function | 0x80;
+        pduPtr[1] = exception;
+        pduLength = 2;
+        ExceptionCount++;
+    }
+    else if (isBit)
+    {
+        pduPtr[0] = function;
+        pduPtr[1] = (count + 7) / 8;
+        memset(&pduPtr[2], 0, pduPtr[1]);
+
+        for (i = 0; i < count; i++)
+        {
+            if ((address + i) & 1)
+            {
+                pduPtr[2 + i / 8] |= 1 << (i % 8);
+            }
+        }
+
+        pduLength = 2 + pduPtr[1];
+        ValueCount += count;
+    }
+    else
+    {
+        pduPtr[0] = function;
+        pduPtr[1] = count * 2;
+
+        for (i = 0; i < count; i++)
+        {
+            PutWord(&pduPtr[2 + 2 * i], address + i);
+        }
+
+        pduLength = 2 + pduPtr[1];
+        ValueCount += count;
+    }
+
+    PutWord(&responsePtr[4], pduLength + 1);
+    RequestCount++;
+
+    return MBAP_SIZE + pduLength;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle a request: answer at once, or once it and the requests before it were served and the
+ * latency elapsed
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleRequest
+(
+    client_t* clientPtr,                        ///< [IN] Client
+    const uint8_t* requestPtr,                  ///< [IN] Request
+    size_t length                               ///< [IN] Length of the request
+)
+{
+    uint8_t response[MAX_ADU_SIZE];
+    double now = GetTime();
+
+    if ((Delay == 0) && (Latency == 0))
+    {
+        Send(clientPtr, response, BuildResponse(requestPtr, length, response));
+        return;
+    }
+
+    if (PendingCount == MAX_PENDING)
+    {
+        LE_WARN("Too many requests waiting, request dropped");
+        return;
+    }
+
+    pending_t* pendingPtr = &Pending[(PendingHead + PendingCount) % MAX_PENDING];
+
+    // Requests are served one after the other, their responses are then on the wire together.
+    ServiceEnd = ((ServiceEnd > now) ? ServiceEnd : now) + Delay / 1000.0;
+
+    pendingPtr->clientPtr = clientPtr;
+    pendingPtr->sendTime = ServiceEnd + Latency / 1000.0;
+    pendingPtr->length = BuildResponse(requestPtr, length, pendingPtr->frame);
+
+    if (PendingCount++ == 0)
+    {
+        ArmSendTimer();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle events on a client socket
+ */
+//--------------------------------------------------------------------------------------------------
+static void ClientHandler
+(
+    int fd,                                     ///< [IN] Socket
+    short events                                ///< [IN] Events
+)
+{
+    client_t* clientPtr = le_fdMonitor_GetContextPtr();
+    const uint8_t* framePtr = clientPtr->rxBuffer;
+
+    ssize_t size = read(fd, clientPtr->rxBuffer + clientPtr->rxLength,
+                        sizeof(clientPtr->rxBuffer) - clientPtr->rxLength);
+
+    if ((size < 0) && ((errno == EAGAIN) || (errno == EINTR)))
+    {
+        return;
+    }
+
+    if (size <= 0)
+    {
+        Disconnect(clientPtr);
+        return;
+    }
+
+    size_t length = clientPtr->rxLength + size;
+
+    while (length >= MBAP_SIZE)
+    {
+        size_t frameLength = 6 + ((framePtr[4] << 8) | framePtr[5]);
+
+        if ((frameLength < MBAP_SIZE + 1) || (frameLength > MAX_ADU_SIZE))
+        {
+            Disconnect(clientPtr);
+            return;
+        }
+
+        if (length < frameLength)
+        {
+            break;
+        }
+
+        HandleRequest(clientPtr, framePtr, frameLength);
+
+        if (clientPtr->fd < 0)
+        {
+            return;
+        }
+
+        framePtr += frameLength;
+        length -= frameLength;
+    }
+
+    memmove(clientPtr->rxBuffer, framePtr, length);
+    clientPtr->rxLength = length;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Accept a client
+ */
+//--------------------------------------------------------------------------------------------------
+static void ListenHandler
+(
+    int fd,                                     ///< [IN] Listening socket
+    short events                                ///< [IN] Events
+)
+{
+    int clientFd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    int one = 1;
+    int i;
+
+    if (clientFd < 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < MAX_CLIENTS; i++)
+    {
+        if (Clients[i].fd < 0)
+        {
+            break;
+        }
+    }
+
+    if (i == MAX_CLIENTS)
+    {
+        LE_WARN("Too many clients");
+        close(clientFd);
+        return;
+    }
+
+    // Pipelined responses go out as soon as they are ready.
+    setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    Clients[i].fd = clientFd;
+    Clients[i].rxLength = 0;
+    Clients[i].monitorRef = le_fdMonitor_Create("modbussimClient", clientFd, ClientHandler,
+                                                POLLIN);
+    le_fdMonitor_SetContextPtr(Clients[i].monitorRef, &Clients[i]);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the statistics
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintStats
+(
+    le_timer_Ref_t timerRef                     ///< [IN] Statistics timer
+)
+{
+    printf("%8.1f requests/s %10.1f values/s %8" PRIu32 " exceptions\n",
+           (double)RequestCount / STATS_PERIOD, (double)ValueCount / STATS_PERIOD,
+           ExceptionCount);
+    fflush(stdout);
+
+    RequestCount = 0;
+    ValueCount = 0;
+    ExceptionCount = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the help and exit
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintHelp
+(
+    void
+)
+{
+    puts("Usage: modbussim [-p <port>] [-d <service time in ms>] [-l <latency in ms>]\n"
+         "\n"
+         "Modbus TCP slave answering the reads of any unit and address: registers hold their\n"
+         "address, coils and discrete inputs are set at odd addresses. Each request takes the\n"
+         "service time, in order, like on a gateway to a serial bus, and each response is\n"
+         "delayed by the latency, like over a network.");
+
+    exit(EXIT_SUCCESS);
+}
+
+COMPONENT_INIT
+{
+    struct sockaddr_in addr;
+    int one = 1;
+    int i;
+
+    le_arg_SetIntVar(&Port, "p", "port");
+    le_arg_SetIntVar(&Delay, "d", "delay");
+    le_arg_SetIntVar(&Latency, "l", "latency");
+    le_arg_SetFlagCallback(PrintHelp, "h", "help");
+    le_arg_Scan();
+
+    if (Delay < 0)
+    {
+        Delay = 0;
+    }
+
+    if (Latency < 0)
+    {
+        Latency = 0;
+    }
+
+    for (i = 0; i < MAX_CLIENTS; i++)
+    {
+        Clients[i].fd = -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    LE_FATAL_IF(fd < 0, "Cannot create socket: %m");
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(Port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    LE_FATAL_IF((bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) || (listen(fd, 8) != 0),
+                "Cannot listen on port %d: %m", Port);
+
+    le_fdMonitor_Create("modbussim", fd, ListenHandler, POLLIN);
+
+    SendTimer = le_timer_Create("modbussimSend");
+    le_timer_SetHandler(SendTimer, SendDue);
+
+    le_timer_Ref_t statsTimer = le_timer_Create("modbussimStats");
+    le_timer_SetMsInterval(statsTimer, STATS_PERIOD * 1000);
+    le_timer_SetRepeat(statsTimer, 0);
+    le_timer_SetHandler(statsTimer, PrintStats);
+    le_timer_Start(statsTimer);
+
+    printf("Modbus TCP simulator on port %d, service time %d ms, latency %d ms\n", Port, Delay,
+           Latency);
+    fflush(stdout);
+}
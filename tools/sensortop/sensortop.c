@@ -0,0 +1,336 @@
+//--------------------------------------------------------------------------------------------------
+/** @file sensortop.c
+ *
+ * Command line tool listing the sensors registered to the Sensor Framework with their sampling
+ * rate and cost, refreshed periodically like top.
+ *
+ * Usage: sensortop [-d <delay in s>] [-n <iterations>] [-s cpu|rate|push|fail|bytes|path]
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <inttypes.h>
+#include "interfaces.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of sensors displayed
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_SENSORS                     1000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default refresh period in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+#define     DEFAULT_DELAY_SEC               2
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counters of a sensor at the previous refresh
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    bool isValid;                               ///< Has the sensor been read before?
+    double age;                                 ///< Seconds since registration
+    uint32_t sampleCount;                       ///< Number of samples pushed
+    uint64_t busyTimeUs;                        ///< Time spent in callbacks and pushes
+    uint64_t bytesPushed;                       ///< Bytes pushed
+}
+counters_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Displayed line of a sensor
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char path[SENSORSTATS_MAX_PATH_LEN + 1];            ///< Path of the sensor
+    char plugin[SENSORSTATS_MAX_PLUGIN_NAME_LEN + 1];   ///< Name of the plugin
+    double period;                                      ///< Sampling period (0 if read once)
+    bool isEnabled;                                     ///< Is the sensor sampled?
+    double rate;                                        ///< Samples per second
+    double cpu;                                         ///< Percentage of time busy
+    double callbackMeanUs;                              ///< Mean callback time
+    uint32_t callbackMaxUs;                             ///< Longest callback
+    double pushMeanUs;                                  ///< Mean push time
+    uint32_t pushMaxUs;                                 ///< Longest push
+    uint32_t failureCount;                              ///< Failed callbacks
+    double byteRate;                                    ///< Bytes pushed per second
+    uint64_t bytesPushed;                               ///< Bytes pushed
+}
+line_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counters read at the previous refresh, by sensor index, and lines of the current refresh
+ */
+//--------------------------------------------------------------------------------------------------
+static counters_t Previous[MAX_SENSORS];
+static line_t Lines[MAX_SENSORS];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command line options
+ */
+//--------------------------------------------------------------------------------------------------
+static int Delay = DEFAULT_DELAY_SEC;
+static int Iterations = 0;
+static const char* SortKey = "cpu";
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare two lines according to the sort key, greatest first
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareLines
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    const line_t* a = aPtr;
+    const line_t* b = bPtr;
+    double diff;
+
+    if (strcmp(SortKey, "path") == 0)
+    {
+        return strcmp(a->path, b->path);
+    }
+    else if (strcmp(SortKey, "rate") == 0)
+    {
+        diff = b->rate - a->rate;
+    }
+    else if (strcmp(SortKey, "push") == 0)
+    {
+        diff = b->pushMeanUs - a->pushMeanUs;
+    }
+    else if (strcmp(SortKey, "fail") == 0)
+    {
+        diff = (double)b->failureCount - (double)a->failureCount;
+    }
+    else if (strcmp(SortKey, "bytes") == 0)
+    {
+        diff = b->byteRate - a->byteRate;
+    }
+    else
+    {
+        diff = b->cpu - a->cpu;
+    }
+
+    return (diff > 0) - (diff < 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the statistics of a sensor and compute its line
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OUT_OF_RANGE if the sensor does not exist
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadLine
+(
+    uint32_t index,                             ///< [IN]  Index of the sensor
+    line_t* linePtr                             ///< [OUT] Line
+)
+{
+    double age;
+    uint32_t sampleCount;
+    uint64_t callbackTimeUs;
+    uint64_t pushTimeUs;
+    le_result_t result;
+
+    result = sensorStats_GetInfo(index,
+                                 linePtr->path,
+                                 sizeof(linePtr->path),
+                                 linePtr->plugin,
+                                 sizeof(linePtr->plugin),
+                                 &linePtr->period,
+                                 &linePtr->isEnabled);
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    result = sensorStats_GetStats(index,
+                                  &age,
+                                  &sampleCount,
+                                  &linePtr->failureCount,
+                                  &callbackTimeUs,
+                                  &linePtr->callbackMaxUs,
+                                  &pushTimeUs,
+                                  &linePtr->pushMaxUs,
+                                  &linePtr->bytesPushed);
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    // Rates over the last refresh period, or since registration on the first one.
+    counters_t* previousPtr = &Previous[index];
+    counters_t current = { true, age, sampleCount, callbackTimeUs + pushTimeUs,
+                           linePtr->bytesPushed };
+
+    if (!previousPtr->isValid || (previousPtr->age > age))
+    {
+        memset(previousPtr, 0, sizeof(*previousPtr));
+    }
+
+    double interval = age - previousPtr->age;
+
+    if (interval > 0)
+    {
+        linePtr->rate = (sampleCount - previousPtr->sampleCount) / interval;
+        linePtr->cpu = (current.busyTimeUs - previousPtr->busyTimeUs) / (interval * 10000.0);
+        linePtr->byteRate = (current.bytesPushed - previousPtr->bytesPushed) / interval;
+    }
+    else
+    {
+        linePtr->rate = 0;
+        linePtr->cpu = 0;
+        linePtr->byteRate = 0;
+    }
+
+    uint32_t callCount = sampleCount + linePtr->failureCount;
+
+    linePtr->callbackMeanUs = (callCount > 0) ? ((double)callbackTimeUs / callCount) : 0;
+    linePtr->pushMeanUs = (sampleCount > 0) ? ((double)pushTimeUs / sampleCount) : 0;
+
+    *previousPtr = current;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read all the sensors and print them
+ */
+//--------------------------------------------------------------------------------------------------
+static void Refresh
+(
+    le_timer_Ref_t timerRef                     ///< [IN] Refresh timer
+)
+{
+    uint32_t count = sensorStats_GetCount();
+    uint32_t lineCount = 0;
+    uint32_t i;
+    double totalCpu = 0;
+
+    if (count > MAX_SENSORS)
+    {
+        count = MAX_SENSORS;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (ReadLine(i, &Lines[lineCount]) == LE_OK)
+        {
+            totalCpu += Lines[lineCount].cpu;
+            lineCount++;
+        }
+    }
+
+    qsort(Lines, lineCount, sizeof(line_t), CompareLines);
+
+    if (isatty(STDOUT_FILENO))
+    {
+        printf("\033[H\033[J");
+    }
+
+    printf("sensortop - %" PRIu32 " sensors, %.2f%% busy, refresh %d s, sorted by %s\n\n",
+           lineCount, totalCpu, Delay, SortKey);
+    printf("%-32s %-8s %8s %8s %6s %9s %9s %9s %9s %6s %9s\n",
+           "PATH", "PLUGIN", "PERIOD", "RATE/s", "CPU%", "CB(us)", "CBMAX", "PUSH(us)",
+           "PUSHMAX", "FAIL", "BYTES/s");
+
+    for (i = 0; i < lineCount; i++)
+    {
+        const line_t* linePtr = &Lines[i];
+        char period[16];
+
+        if (linePtr->period == 0)
+        {
+            snprintf(period, sizeof(period), "once");
+        }
+        else if (!linePtr->isEnabled)
+        {
+            snprintf(period, sizeof(period), "off");
+        }
+        else
+        {
+            snprintf(period, sizeof(period), "%.3g", linePtr->period);
+        }
+
+        printf("%-32.32s %-8.8s %8s %8.2f %6.2f %9.0f %9" PRIu32 " %9.0f %9" PRIu32
+               " %6" PRIu32 " %9.1f\n",
+               linePtr->path,
+               linePtr->plugin,
+               period,
+               linePtr->rate,
+               linePtr->cpu,
+               linePtr->callbackMeanUs,
+               linePtr->callbackMaxUs,
+               linePtr->pushMeanUs,
+               linePtr->pushMaxUs,
+               linePtr->failureCount,
+               linePtr->byteRate);
+    }
+
+    fflush(stdout);
+
+    if ((Iterations > 0) && (--Iterations == 0))
+    {
+        exit(EXIT_SUCCESS);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the help and exit
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintHelp
+(
+    void
+)
+{
+    puts("Usage: sensortop [-d <delay in s>] [-n <iterations>] "
+         "[-s cpu|rate|push|fail|bytes|path]\n"
+         "\n"
+         "Lists the sensors registered to the Sensor Framework with their sampling rate,\n"
+         "time spent in the plugin callbacks and in pushes to the Data Hub, failures and\n"
+         "volume of data. CPU% is the share of time spent sampling and pushing.");
+
+    exit(EXIT_SUCCESS);
+}
+
+COMPONENT_INIT
+{
+    le_arg_SetIntVar(&Delay, "d", "delay");
+    le_arg_SetIntVar(&Iterations, "n", "iterations");
+    le_arg_SetStringVar(&SortKey, "s", "sort");
+    le_arg_SetFlagCallback(PrintHelp, "h", "help");
+    le_arg_Scan();
+
+    if (Delay <= 0)
+    {
+        Delay = DEFAULT_DELAY_SEC;
+    }
+
+    le_timer_Ref_t timerRef = le_timer_Create("sensortop");
+    le_timer_SetMsInterval(timerRef, Delay * 1000);
+    le_timer_SetRepeat(timerRef, 0);
+    le_timer_SetHandler(timerRef, Refresh);
+    le_timer_Start(timerRef);
+
+    Refresh(timerRef);
+}
@@ -0,0 +1,369 @@
+//--------------------------------------------------------------------------------------------------
+/** @file tracebench.c
+ *
+ * Benchmark of the end-to-end latency of the samples of the Sensor Framework. The tool stands in
+ * for the upstream sink (e.g. the MQTT publisher and its broker): it receives the records of the
+ * traced samples from the Data Hub, holds each one for the configured delivery delay, then
+ * acknowledges it to sensorFw like a real sink would once the broker got the sample. After the
+ * run, the latency distribution of every stage is printed.
+ *
+ * Usage: tracebench [-d <delivery delay in ms>] [-t <duration in s>]
+ *
+ * Tracing must be enabled in sensorFw (trace/fraction) for samples to be received.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include <inttypes.h>
+#include <math.h>
+#include "interfaces.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resources of the traces in the Data Hub
+ */
+//--------------------------------------------------------------------------------------------------
+#define     TRACE_SAMPLES_PATH              "/app/sensorFw/trace/samples"
+#define     TRACE_ACK_PATH                  "/app/sensorFw/trace/ack"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of traces measured, and of traces waiting for their delivery
+ */
+//--------------------------------------------------------------------------------------------------
+#define     MAX_TRACES                      20000
+#define     MAX_IN_FLIGHT                   1024
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default delivery delay in milliseconds and duration of the run in seconds
+ */
+//--------------------------------------------------------------------------------------------------
+#define     DEFAULT_DELAY_MS                20
+#define     DEFAULT_DURATION_SEC            60
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stages measured
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    STAGE_READ,                                 ///< Plugin callback
+    STAGE_QUEUE,                                ///< Staged from a plugin thread
+    STAGE_PUSH,                                 ///< Push to the Data Hub
+    STAGE_HUB,                                  ///< Data Hub to the sink
+    STAGE_DELIVERY,                             ///< Sink to the broker
+    STAGE_TOTAL,                                ///< Capture to the broker
+    STAGE_COUNT
+}
+stage_t;
+
+static const char* const StageNames[STAGE_COUNT] =
+{
+    "read", "queue", "push", "hub", "delivery", "total"
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trace waiting for its delivery
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double id;                                  ///< Trace id
+    double capture;                             ///< Time of the capture
+    double received;                            ///< Time the record was received
+}
+inFlight_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Latencies measured in microseconds, by stage
+ */
+//--------------------------------------------------------------------------------------------------
+static double Latencies[STAGE_COUNT][MAX_TRACES];
+static uint32_t TraceCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Traces waiting for their delivery, in order of arrival
+ */
+//--------------------------------------------------------------------------------------------------
+static inFlight_t InFlight[MAX_IN_FLIGHT];
+static uint32_t InFlightHead;
+static uint32_t InFlightCount;
+static uint32_t DroppedCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer of the next delivery
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t DeliveryTimer;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command line options
+ */
+//--------------------------------------------------------------------------------------------------
+static int Delay = DEFAULT_DELAY_MS;
+static int Duration = DEFAULT_DURATION_SEC;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time in seconds since the Epoch, like the timestamps of the samples
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetTimestamp
+(
+    void
+)
+{
+    le_clk_Time_t now = le_clk_GetAbsoluteTime();
+
+    return (double)now.sec + ((double)now.usec / 1000000.0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a numeric member of a trace record
+ *
+ * @return:
+ *      - Value of the member, NAN if missing
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetMember
+(
+    const char* recordPtr,                      ///< [IN] Trace record
+    const char* namePtr                         ///< [IN] Quoted name of the member, with the colon
+)
+{
+    const char* valuePtr = strstr(recordPtr, namePtr);
+
+    if (valuePtr == NULL)
+    {
+        return NAN;
+    }
+
+    return strtod(valuePtr + strlen(namePtr), NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Schedule the delivery of the oldest trace in flight
+ */
+//--------------------------------------------------------------------------------------------------
+static void ScheduleDelivery
+(
+    void
+)
+{
+    double due = InFlight[InFlightHead].received + Delay / 1000.0;
+    double wait = due - GetTimestamp();
+
+    le_timer_SetMsInterval(DeliveryTimer, (wait > 0) ? (uint32_t)(wait * 1000) + 1 : 1);
+    le_timer_Start(DeliveryTimer);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deliver the traces that were held long enough, and acknowledge them to sensorFw
+ */
+//--------------------------------------------------------------------------------------------------
+static void Deliver
+(
+    le_timer_Ref_t timerRef                     ///< [IN] Delivery timer
+)
+{
+    double now = GetTimestamp();
+
+    while (InFlightCount > 0)
+    {
+        inFlight_t* tracePtr = &InFlight[InFlightHead];
+
+        if (tracePtr->received + Delay / 1000.0 > now)
+        {
+            ScheduleDelivery();
+            return;
+        }
+
+        if (TraceCount < MAX_TRACES)
+        {
+            Latencies[STAGE_DELIVERY][TraceCount] = (now - tracePtr->received) * 1000000.0;
+            Latencies[STAGE_TOTAL][TraceCount] = (now - tracePtr->capture) * 1000000.0;
+            TraceCount++;
+        }
+
+        admin_PushNumeric(TRACE_ACK_PATH, 0, tracePtr->id);
+
+        InFlightHead = (InFlightHead + 1) % MAX_IN_FLIGHT;
+        InFlightCount--;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive the record of a traced sample, as the upstream sink would receive the sample
+ */
+//--------------------------------------------------------------------------------------------------
+static void TraceHandler
+(
+    double timestamp,                           ///< [IN] Timestamp of the record
+    const char* recordPtr,                      ///< [IN] Trace record
+    void* contextPtr                            ///< [IN] Not used
+)
+{
+    double now = GetTimestamp();
+    double capture = GetMember(recordPtr, "\"capture\":");
+    double read = GetMember(recordPtr, "\"read\":");
+    double queue = GetMember(recordPtr, "\"queue\":");
+    double push = GetMember(recordPtr, "\"push\":");
+    double id = GetMember(recordPtr, "\"id\":");
+
+    if (isnan(capture) || isnan(read) || isnan(queue) || isnan(push) || isnan(id))
+    {
+        LE_WARN("Bad trace record '%s'", recordPtr);
+        return;
+    }
+
+    if ((InFlightCount == MAX_IN_FLIGHT) || (TraceCount + InFlightCount >= MAX_TRACES))
+    {
+        DroppedCount++;
+        return;
+    }
+
+    // Local stages are stored now, the delivery when the trace leaves the sink.
+    uint32_t index = TraceCount + InFlightCount;
+
+    Latencies[STAGE_READ][index] = read;
+    Latencies[STAGE_QUEUE][index] = queue;
+    Latencies[STAGE_PUSH][index] = push;
+    Latencies[STAGE_HUB][index] = (now - capture) * 1000000.0 - (read + queue + push);
+
+    inFlight_t* tracePtr = &InFlight[(InFlightHead + InFlightCount) % MAX_IN_FLIGHT];
+
+    tracePtr->id = id;
+    tracePtr->capture = capture;
+    tracePtr->received = now;
+
+    if (InFlightCount++ == 0)
+    {
+        ScheduleDelivery();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare two latencies
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareLatencies
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    double diff = *(const double*)aPtr - *(const double*)bPtr;
+
+    return (diff > 0) - (diff < 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the latency distribution of every stage and exit
+ */
+//--------------------------------------------------------------------------------------------------
+static void Report
+(
+    le_timer_Ref_t timerRef                     ///< [IN] Duration timer
+)
+{
+    int stage;
+
+    printf("tracebench - %" PRIu32 " traces in %d s, delivery delay %d ms, %" PRIu32
+           " in flight, %" PRIu32 " dropped\n\n",
+           TraceCount, Duration, Delay, InFlightCount, DroppedCount);
+
+    if (TraceCount == 0)
+    {
+        puts("No trace received, is trace/fraction set in the sensorFw configuration?");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-10s %10s %10s %10s %10s %10s\n", "STAGE", "MEAN(us)", "P50", "P90", "P99", "MAX");
+
+    for (stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        double* latenciesPtr = Latencies[stage];
+        double sum = 0;
+        uint32_t i;
+
+        qsort(latenciesPtr, TraceCount, sizeof(double), CompareLatencies);
+
+        for (i = 0; i < TraceCount; i++)
+        {
+            sum += latenciesPtr[i];
+        }
+
+        printf("%-10s %10.0f %10.0f %10.0f %10.0f %10.0f\n",
+               StageNames[stage],
+               sum / TraceCount,
+               latenciesPtr[TraceCount * 50 / 100],
+               latenciesPtr[TraceCount * 90 / 100],
+               latenciesPtr[TraceCount * 99 / 100],
+               latenciesPtr[TraceCount - 1]);
+    }
+
+    fflush(stdout);
+    exit(EXIT_SUCCESS);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the help and exit
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintHelp
+(
+    void
+)
+{
+    puts("Usage: tracebench [-d <delivery delay in ms>] [-t <duration in s>]\n"
+         "\n"
+         "Stands in for the upstream sink of the traced samples of the Sensor Framework:\n"
+         "each sample is acknowledged after the delivery delay, as if sent to a broker.\n"
+         "Prints the latency of every stage from the capture to the delivery at the end.");
+
+    exit(EXIT_SUCCESS);
+}
+
+COMPONENT_INIT
+{
+    le_arg_SetIntVar(&Delay, "d", "delay");
+    le_arg_SetIntVar(&Duration, "t", "time");
+    le_arg_SetFlagCallback(PrintHelp, "h", "help");
+    le_arg_Scan();
+
+    if (Delay < 0)
+    {
+        Delay = DEFAULT_DELAY_MS;
+    }
+
+    if (Duration <= 0)
+    {
+        Duration = DEFAULT_DURATION_SEC;
+    }
+
+    DeliveryTimer = le_timer_Create("tracebenchDelivery");
+    le_timer_SetHandler(DeliveryTimer, Deliver);
+
+    le_timer_Ref_t durationTimer = le_timer_Create("tracebench");
+    le_timer_SetMsInterval(durationTimer, Duration * 1000);
+    le_timer_SetHandler(durationTimer, Report);
+    le_timer_Start(durationTimer);
+
+    admin_AddJsonPushHandler(TRACE_SAMPLES_PATH, TraceHandler, NULL);
+}